@@ -1,9 +1,49 @@
 # Little convenience script to get an object dump
+# also lists the sections of the symbols in wled00/hot_profile.h, to verify the WLED_ENABLE_HOT_IRAM placement
 
 Import('env')
+import os
+import re
+import subprocess
+
+def hot_symbols():
+    path = os.path.join(env.subst("$PROJECT_DIR"), "wled00", "hot_profile.h")
+    if not os.path.isfile(path):
+        return []
+    entries = []
+    with open(path) as f:
+        for line in f:
+            m = re.match(r"\s*#define\s+WLED_HOT_\w+\s+(WLED_IRAM|WLED_DRAM)?\s*//\s*(\S+)", line)
+            if m:
+                entries.append((m.group(2), m.group(1) or "flash"))
+    return entries
 
 def obj_dump_after_elf(source, target, env):
+    objdump = env.subst("$CC").replace("gcc", "objdump")
     print("Create firmware.asm")
-    env.Execute("xtensa-lx106-elf-objdump "+ "-D " + str(target[0]) + " > "+ "${PROGNAME}.asm")
-    
+    env.Execute(objdump + " -D " + str(target[0]) + " > " + "${PROGNAME}.asm")
+
+    entries = hot_symbols()
+    if not entries:
+        return
+    table = subprocess.run([objdump, "-t", "-C", str(target[0])], capture_output=True, text=True).stdout.splitlines()
+    lines = []
+    for sym, want in entries:
+        found = False
+        for row in table:
+            # <addr> <flags> <section> <size> <name>
+            m = re.match(r"\S+\s+.{7}\s+(\S+)\s+\S+\s+(.*)$", row)
+            if not m:
+                continue
+            name = m.group(2)
+            if re.search(r"(^| )" + re.escape(sym) + r"(\(|$)", name):
+                lines.append("%-40s %-16s (profile: %s)" % (name, m.group(1), want))
+                found = True
+        if not found:
+            lines.append("%-40s %-16s (profile: %s)" % (sym, "not found", want))
+    report = env.subst("${PROGNAME}.hot.txt")
+    with open(report, "w") as f:
+        f.write("\n".join(lines) + "\n")
+    print("Create " + report)
+
 env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", [obj_dump_after_elf])
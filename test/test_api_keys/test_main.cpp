@@ -0,0 +1,60 @@
+// host unit tests of the HTTP API tokenizer in wled00/api_keys.h (pio test -e native)
+#include <unity.h>
+#include <stdlib.h>
+#include "api_keys.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// every key must be found in the perfect hash table
+void test_all_keys_found(void) {
+  for (uint8_t id = 0; id < API_KEY_COUNT; id++) {
+    const char *name = apiKeyNames[id];
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(id, apiKeyId(name, strlen(name)), name);
+  }
+}
+
+// unknown keys, prefixes and extensions of keys must not match
+void test_unknown_keys(void) {
+  const char *unknown[] = { "", "XX", "Q", "FXDD", "F", "FXE", "ABCD", "s", "fx" };
+  for (const char *k : unknown) TEST_ASSERT_EQUAL_UINT8_MESSAGE(API_KEY_COUNT, apiKeyId(k, strlen(k)), k);
+  TEST_ASSERT_EQUAL_UINT8(API_FX, apiKeyId("FXD", 2)); // length limits the key
+}
+
+void test_tokenize_values(void) {
+  const char *v[API_KEY_COUNT];
+  tokenizeApiRequest("/win&A=128&FX=5&SX=40&FX=9&T=2&SM=1", v);
+  TEST_ASSERT_NOT_NULL(v[API_A]);
+  TEST_ASSERT_EQUAL_INT(128, atoi(v[API_A]));
+  TEST_ASSERT_EQUAL_INT(5, atoi(v[API_FX])); // first occurrence counts
+  TEST_ASSERT_EQUAL_INT(40, atoi(v[API_SX]));
+  TEST_ASSERT_EQUAL_INT(2, atoi(v[API_T]));
+  TEST_ASSERT_EQUAL_INT(1, atoi(v[API_SM]));
+  TEST_ASSERT_NULL(v[API_IX]);
+}
+
+// single letter keys (and ND/NN) only count directly after '&', flags point behind the key
+void test_tokenize_amp_keys_and_flags(void) {
+  const char *v[API_KEY_COUNT];
+  tokenizeApiRequest("winA=5&FX=~&ND&RB", v);
+  TEST_ASSERT_NULL(v[API_A]);
+  TEST_ASSERT_EQUAL_STRING("~&ND&RB", v[API_FX]);
+  TEST_ASSERT_EQUAL_STRING("&RB", v[API_ND]);
+  TEST_ASSERT_EQUAL_STRING("", v[API_RB]);
+}
+
+void test_tokenize_no_win(void) {
+  const char *v[API_KEY_COUNT];
+  tokenizeApiRequest("/json&A=5", v);
+  for (uint8_t id = 0; id < API_KEY_COUNT; id++) TEST_ASSERT_NULL(v[id]);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_all_keys_found);
+  RUN_TEST(test_unknown_keys);
+  RUN_TEST(test_tokenize_values);
+  RUN_TEST(test_tokenize_amp_keys_and_flags);
+  RUN_TEST(test_tokenize_no_win);
+  return UNITY_END();
+}
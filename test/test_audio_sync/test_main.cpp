@@ -0,0 +1,87 @@
+// host unit tests of the v3 audio sync packet in usermods/audioreactive/audio_sync.h (pio test -e native)
+#include <unity.h>
+#include <stddef.h>
+#include "audio_sync.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static uint8_t fft[AUDIOSYNC_V3_CHANNELS];
+
+// wire format must stay the same for all senders and receivers
+void test_packet_layout(void) {
+  TEST_ASSERT_EQUAL(40, sizeof(audioSyncPacket_v3));
+  TEST_ASSERT_EQUAL(19, offsetof(audioSyncPacket_v3, flags));
+  TEST_ASSERT_EQUAL(24, offsetof(audioSyncPacket_v3, fftResult));
+}
+
+void test_roundtrip_full(void) {
+  for (int i = 0; i < AUDIOSYNC_V3_CHANNELS; i++) fft[i] = i * 17;
+  audioSyncPacket_v3 p = {};
+  p.seq  = 65535;
+  p.time = 123456;
+  TEST_ASSERT_EQUAL(sizeof(p), audioSyncEncode_v3(&p, 100, 12.5f, true, 1234.5f, 440.7f, fft, false));
+  audioSyncFrame_t f = {};
+  audioSyncDecode_v3(&p, &f);
+  TEST_ASSERT_TRUE(f.valid);
+  TEST_ASSERT_EQUAL_UINT16(65535, f.seq);
+  TEST_ASSERT_EQUAL_UINT32(123456, f.time);
+  TEST_ASSERT_EQUAL_FLOAT(100.0f, f.sampleRaw);
+  TEST_ASSERT_EQUAL_FLOAT(12.5f, f.sampleSmth); // 8.8 fixed point
+  TEST_ASSERT_TRUE(f.samplePeak);
+  TEST_ASSERT_EQUAL_FLOAT(1234.5f, f.magnitude);
+  TEST_ASSERT_EQUAL_FLOAT(440.0f, f.majorPeak);  // whole Hz
+  for (int i = 0; i < AUDIOSYNC_V3_CHANNELS; i++) TEST_ASSERT_EQUAL_UINT8(fft[i] < 254 ? fft[i] : 254, f.fftResult[i]);
+}
+
+void test_encode_limits(void) {
+  for (int i = 0; i < AUDIOSYNC_V3_CHANNELS; i++) fft[i] = 255;
+  audioSyncPacket_v3 p = {};
+  audioSyncFrame_t f = {};
+  audioSyncEncode_v3(&p, 300, 300.0f, false, 0.0f, 20000.0f, fft, false);
+  audioSyncDecode_v3(&p, &f);
+  TEST_ASSERT_EQUAL_FLOAT(255.0f, f.sampleRaw);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 255.99f, f.sampleSmth);
+  TEST_ASSERT_FALSE(f.samplePeak);
+  TEST_ASSERT_EQUAL_FLOAT(11025.0f, f.majorPeak);
+  TEST_ASSERT_EQUAL_UINT8(254, f.fftResult[0]); // 255 is not sent
+  audioSyncEncode_v3(&p, -5, -1.0f, false, 0.0f, 0.0f, fft, false);
+  audioSyncDecode_v3(&p, &f);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, f.sampleRaw);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, f.sampleSmth);
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, f.majorPeak);
+}
+
+// compact packets carry 4 bit channels, expanded to the full range on receive
+void test_roundtrip_compact(void) {
+  for (int i = 0; i < AUDIOSYNC_V3_CHANNELS; i++) fft[i] = (i << 4) | 0x0B;
+  audioSyncPacket_v3 p = {};
+  TEST_ASSERT_EQUAL(sizeof(p) - AUDIOSYNC_V3_CHANNELS/2, audioSyncEncode_v3(&p, 0, 0.0f, false, 0.0f, 1.0f, fft, true));
+  TEST_ASSERT_TRUE(p.flags & AUDIOSYNC_V3_COMPACT);
+  audioSyncFrame_t f = {};
+  audioSyncDecode_v3(&p, &f);
+  for (int i = 0; i < AUDIOSYNC_V3_CHANNELS; i++) TEST_ASSERT_EQUAL_UINT8((i << 4) | i, f.fftResult[i]);
+  audioSyncEncode_v3(&p, 0, 0.0f, false, 0.0f, 1.0f, fft, false); // flag is cleared again
+  TEST_ASSERT_FALSE(p.flags & AUDIOSYNC_V3_COMPACT);
+}
+
+// faster transit is taken at once, drift is followed by 1/64 rounded to nearest (not by 1 for any jitter)
+void test_follow_clock(void) {
+  TEST_ASSERT_EQUAL_INT32(90, audioSyncFollowClock(100, 90));
+  TEST_ASSERT_EQUAL_INT32(100, audioSyncFollowClock(100, 100));
+  TEST_ASSERT_EQUAL_INT32(100, audioSyncFollowClock(100, 101));
+  TEST_ASSERT_EQUAL_INT32(100, audioSyncFollowClock(100, 131));
+  TEST_ASSERT_EQUAL_INT32(101, audioSyncFollowClock(100, 132));
+  TEST_ASSERT_EQUAL_INT32(102, audioSyncFollowClock(100, 196));
+  TEST_ASSERT_EQUAL_INT32(-100, audioSyncFollowClock(-100, -99));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_packet_layout);
+  RUN_TEST(test_roundtrip_full);
+  RUN_TEST(test_encode_limits);
+  RUN_TEST(test_roundtrip_compact);
+  RUN_TEST(test_follow_clock);
+  return UNITY_END();
+}
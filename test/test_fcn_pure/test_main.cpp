@@ -0,0 +1,69 @@
+// host unit tests of wled00/fcn_pure.h (pio test -e native)
+#include <unity.h>
+#include <string.h>
+#include "fcn_pure.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// div255() must equal integer division for all products of two bytes
+void test_div255_exact(void) {
+  for (unsigned a = 0; a < 256; a++)
+    for (unsigned b = 0; b < 256; b++)
+      TEST_ASSERT_EQUAL_UINT8(a * b / 255, div255(a * b));
+}
+
+// scale8x4() must scale each byte like scalar scale8(): (v * (scale+1)) >> 8, without carries between lanes
+void test_scale8x4_lanes(void) {
+  for (unsigned scale = 0; scale < 256; scale++) {
+    for (unsigned v = 0; v < 256; v++) {
+      const uint8_t b[4] = { uint8_t(v), uint8_t(255 - v), uint8_t(v ^ 0x5A), 0xFF };
+      uint32_t w;
+      memcpy(&w, b, 4);
+      w = scale8x4(w, scale + 1);
+      uint8_t r[4];
+      memcpy(r, &w, 4);
+      for (int i = 0; i < 4; i++) TEST_ASSERT_EQUAL_UINT8((b[i] * (scale + 1)) >> 8, r[i]);
+    }
+  }
+}
+
+// published FNV-1a 32 bit test vectors, and hashing in pieces (as cache keys are built)
+void test_fnv1a_vectors(void) {
+  TEST_ASSERT_EQUAL_HEX32(0x811C9DC5, fnv1a("", 0));
+  TEST_ASSERT_EQUAL_HEX32(0xE40C292C, fnv1a("a", 1));
+  TEST_ASSERT_EQUAL_HEX32(0xBF9CF968, fnv1a("foobar", 6));
+  TEST_ASSERT_EQUAL_HEX32(fnv1a("foobar", 6), fnv1a("bar", 3, fnv1a("foo", 3)));
+}
+
+// keys of different inputs must differ (a 32 bit word hashed byte wise, little endian as on ESP)
+void test_fnv1a_keys(void) {
+  const uint32_t a[2] = { 1, 2 }, b[2] = { 2, 1 };
+  TEST_ASSERT_NOT_EQUAL(fnv1a(a, sizeof(a)), fnv1a(b, sizeof(b)));
+  const uint32_t v = 0x04030201;
+  const uint8_t bytes[4] = { 1, 2, 3, 4 };
+  TEST_ASSERT_EQUAL_HEX32(fnv1a(bytes, 4), fnv1a(&v, 4));
+}
+
+// CRC-32 check value, and a journal entry (header bytes, then content) checksummed in pieces
+void test_crc32(void) {
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32Update(0, (const uint8_t*)"123456789", 9));
+  TEST_ASSERT_EQUAL_HEX32(0, crc32Update(0, nullptr, 0));
+  const uint8_t entry[] = { 7, 12, 0, '{', '"', 'o', 'n', '"', ':', 't', 'r', 'u', 'e', '}', '\n' };
+  uint32_t crc = crc32Update(0, entry, 3);
+  for (size_t i = 3; i < sizeof(entry); i += 5) { // content read back in blocks
+    size_t block = sizeof(entry) - i < 5 ? sizeof(entry) - i : 5;
+    crc = crc32Update(crc, entry + i, block);
+  }
+  TEST_ASSERT_EQUAL_HEX32(crc32Update(0, entry, sizeof(entry)), crc);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_div255_exact);
+  RUN_TEST(test_scale8x4_lanes);
+  RUN_TEST(test_fnv1a_vectors);
+  RUN_TEST(test_fnv1a_keys);
+  RUN_TEST(test_crc32);
+  return UNITY_END();
+}
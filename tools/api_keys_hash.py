@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+# Generates the perfect hash table used by the HTTP API tokenizer (wled00/api_keys.h, used by handleSet()).
+# Keys are packed little endian into a 32 bit word (up to 3 characters), slot = (key * MUL) >> 24.
+# Run after adding a key to apiKeyNames[] (wled00/api_keys.h) and paste the output over API_KEY_HASH_MUL and apiKeySlot[].
+#
+# usage: api_keys_hash.py
+
+# same order as enum ApiKey / apiKeyNames[] in api_keys.h
+KEYS = ["S", "A", "R", "G", "B", "W", "K", "M", "T", "ND", "NN",  # only valid after '&'
+        "SM", "SS", "SV", "S2", "GP", "SP", "RV", "MI", "SB", "SW", "PS", "P1", "P2", "PL",
+        "R2", "G2", "B2", "W2", "LX", "LY", "HU", "SA", "H2", "K2", "CL", "C2", "C3", "SR", "SC",
+        "FX", "SX", "IX", "FP", "X1", "X2", "X3", "M1", "M2", "M3", "FXD", "OL", "SN", "RN", "RD",
+        "NL", "NT", "NF", "TT", "ST", "CT", "LO", "RB", "NM", "U0", "U1", "IN"]
+
+
+def pack(k):
+    v = 0
+    for i, c in enumerate(k.encode()):
+        v |= c << (8 * i)
+    return v
+
+
+def slot(k, mul):
+    return ((pack(k) * mul) & 0xFFFFFFFF) >> 24
+
+
+def main():
+    assert len(KEYS) < 255 and len(set(KEYS)) == len(KEYS)
+    mul = 2654435761  # Knuth's multiplicative constant as starting point
+    while len({slot(k, mul) for k in KEYS}) != len(KEYS):
+        mul = (mul + 2) & 0xFFFFFFFF
+    table = [0xFF] * 256
+    for i, k in enumerate(KEYS):
+        table[slot(k, mul)] = i
+    print("#define API_KEY_HASH_MUL %uU" % mul)
+    print("static const uint8_t apiKeySlot[256] PROGMEM = {")
+    for r in range(0, 256, 16):
+        print("  " + ",".join("%3d" % v for v in table[r:r+16]) + ",")
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
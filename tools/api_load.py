@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+# API load test: concurrent clients hammer the HTTP and WebSocket API of a WLED controller at configurable
+# rates while the device is monitored. Reports latency percentiles per endpoint, requests refused because
+# the JSON buffer was busy (HTTP 503 / {"error":3}), WebSocket disconnects (close code 1013: too many
+# clients or queue full) and the frame rate and loop timing reported by the device under load.
+#
+# usage: api_load.py <host> [--time 30] [--clients state=4,si=2,win=2,ws=4] [--rate 5] [--json out.json]
+#
+# --clients  number of concurrent clients per endpoint:
+#            state  POST /json/state (brightness/color changes)   si   GET /json/si
+#            win    GET /win (HTTP API brightness changes)         ws   WebSocket /ws, sends state changes
+# --rate     requests (WebSocket: messages) per second per client, 0: as fast as responses arrive
+#            (a WebSocket message without reply within 5s, e.g. dropped while JSON buffers were busy, is an error)
+#
+# Only uses the Python standard library. Do not run against a controller in use, it changes its state
+# (the state found at start is restored at the end).
+
+import argparse
+import base64
+import json
+import os
+import random
+import socket
+import struct
+import sys
+import threading
+import time
+import urllib.error
+
+from wled_api import http
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.lat = []        # ms of successful requests
+        self.busy = 0        # 503 or {"error":3}
+        self.errors = 0      # other failures (timeouts, connection errors, other HTTP errors)
+        self.disconnects = 0 # WebSocket closed by device
+        self.closeCodes = {}
+        self.rx = 0          # WebSocket messages received
+
+    def add(self, ms):
+        with self.lock:
+            self.lat.append(ms)
+
+    def count(self, attr, n=1):
+        with self.lock:
+            setattr(self, attr, getattr(self, attr) + n)
+
+
+def pct(values, p):
+    if not values:
+        return 0
+    v = sorted(values)
+    return v[min(len(v) - 1, int(len(v) * p / 100))]
+
+
+def state_change():
+    c = [random.randint(0, 255) for _ in range(3)]
+    return {"bri": random.randint(20, 255), "seg": [{"id": 0, "col": [c]}]}
+
+
+def http_client(host, kind, rate, stop, st):
+    while not stop.is_set():
+        t0 = time.time()
+        try:
+            if kind == "state":
+                body = http(host, "/json/state", state_change())
+            elif kind == "si":
+                body = http(host, "/json/si")
+            else:
+                body = http(host, "/win&A=%d" % random.randint(20, 255))
+            ms = (time.time() - t0) * 1000
+            if kind != "win" and b'"error":3' in body[:32]:
+                st.count("busy")
+            else:
+                st.add(ms)
+        except urllib.error.HTTPError as e:
+            st.count("busy" if e.code == 503 else "errors")
+        except Exception:
+            st.count("errors")
+        if rate > 0:
+            stop.wait(max(0.0, 1.0 / rate - (time.time() - t0)))
+
+
+# minimal WebSocket client (RFC 6455), text frames only
+class WebSocket:
+    def __init__(self, host, path="/ws", timeout=5):
+        h, _, p = host.partition(":")
+        self.sock = socket.create_connection((h, int(p or 80)), timeout=timeout)
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.sock.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                           "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n\r\n" % (path, host, key)).encode())
+        resp = b""
+        while b"\r\n\r\n" not in resp:
+            chunk = self.sock.recv(1024)
+            if not chunk:
+                raise ConnectionError("handshake failed")
+            resp += chunk
+        if b" 101 " not in resp.split(b"\r\n")[0]:
+            raise ConnectionError("handshake refused")
+        self.buf = resp.split(b"\r\n\r\n", 1)[1]
+
+    def send(self, text):
+        data = text.encode()
+        mask = os.urandom(4)
+        n = len(data)
+        hdr = struct.pack("!B", 0x81) + (struct.pack("!B", 0x80 | n) if n < 126 else struct.pack("!BH", 0x80 | 126, n))
+        self.sock.sendall(hdr + mask + bytes(b ^ mask[i & 3] for i, b in enumerate(data)))
+
+    def _read(self, n):
+        while len(self.buf) < n:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("closed")
+            self.buf += chunk
+        d, self.buf = self.buf[:n], self.buf[n:]
+        return d
+
+    # returns (opcode, payload)
+    def recv(self):
+        b0, b1 = self._read(2)
+        n = b1 & 0x7F
+        if n == 126:
+            n = struct.unpack("!H", self._read(2))[0]
+        elif n == 127:
+            n = struct.unpack("!Q", self._read(8))[0]
+        return b0 & 0x0F, self._read(n)
+
+    def close(self):
+        try:
+            self.sock.close()
+        except Exception:
+            pass
+
+
+def ws_client(host, rate, stop, st):
+    while not stop.is_set():
+        try:
+            ws = WebSocket(host)
+        except Exception:
+            st.count("errors")
+            stop.wait(1)
+            continue
+        ws.sock.settimeout(0.2)
+        pending = []  # send times of state changes waiting for the state echoed back
+        last = 0
+        try:
+            while not stop.is_set():
+                now = time.time()
+                if (rate <= 0 and not pending) or (rate > 0 and now - last >= 1.0 / rate):
+                    ws.send(json.dumps(state_change()))
+                    pending.append(now)
+                    last = now
+                try:
+                    op, payload = ws.recv()
+                except socket.timeout:
+                    if pending and now - pending[0] > 5:
+                        st.count("errors")
+                        pending.pop(0)
+                    continue
+                if op == 8:  # close
+                    code = struct.unpack("!H", payload[:2])[0] if len(payload) >= 2 else 0
+                    with st.lock:
+                        st.closeCodes[code] = st.closeCodes.get(code, 0) + 1
+                    st.count("disconnects")
+                    break
+                if op == 9:  # ping
+                    continue
+                st.count("rx")
+                if payload.startswith(b'{"error":3'):
+                    st.count("busy")
+                    if pending:
+                        pending.pop(0)
+                elif (payload.startswith(b'{"success"') or payload.startswith(b'{"state"')) and pending:  # reply or broadcast
+                    st.add((time.time() - pending.pop(0)) * 1000)
+        except (ConnectionError, OSError):
+            st.count("disconnects")
+        ws.close()
+
+
+def monitor(host, stop, samples):
+    while not stop.is_set():
+        try:
+            info = json.loads(http(host, "/json/info", timeout=3))
+            lp = info.get("loop", {})
+            samples.append({"fps": info["leds"].get("fps", 0), "heap": info.get("freeheap", 0),
+                            "lps": lp.get("lps", 0), "loopMax": lp.get("max", 0), "ws": info.get("ws", -1),
+                            "jbuf": info.get("jbuf", {}).get("use", 0)})
+        except Exception:
+            samples.append(None)
+        stop.wait(1)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="WLED API load test")
+    ap.add_argument("host")
+    ap.add_argument("--time", type=float, default=30)
+    ap.add_argument("--clients", default="state=4,si=2,win=2,ws=4")
+    ap.add_argument("--rate", type=float, default=5)
+    ap.add_argument("--json", default="")
+    args = ap.parse_args()
+
+    clients = {}
+    for part in args.clients.split(","):
+        k, _, n = part.partition("=")
+        if k not in ("state", "si", "win", "ws"):
+            sys.exit("unknown endpoint %s" % k)
+        clients[k] = int(n or 1)
+
+    saved = json.loads(http(args.host, "/json/state"))
+    idle = []
+    stop = threading.Event()
+    mon = threading.Thread(target=monitor, args=(args.host, stop, idle), daemon=True)
+    mon.start()
+    stop.wait(3)  # baseline without load
+    stop.set(); mon.join()
+
+    stats = {k: Stats() for k in clients}
+    samples = []
+    stop = threading.Event()
+    threads = [threading.Thread(target=monitor, args=(args.host, stop, samples), daemon=True)]
+    for k, n in clients.items():
+        for _ in range(n):
+            if k == "ws":
+                threads.append(threading.Thread(target=ws_client, args=(args.host, args.rate, stop, stats[k]), daemon=True))
+            else:
+                threads.append(threading.Thread(target=http_client, args=(args.host, k, args.rate, stop, stats[k]), daemon=True))
+    print("%d clients for %gs ..." % (len(threads) - 1, args.time))
+    for t in threads:
+        t.start()
+    time.sleep(args.time)
+    stop.set()
+    for t in threads:
+        t.join(10)
+    try:
+        http(args.host, "/json/state", saved)
+    except Exception:
+        pass
+
+    report = {"endpoints": {}, "device": {}}
+    print("\n%-6s %7s %6s %6s %7s %7s %7s %7s %6s" % ("api", "ok", "busy", "err", "p50ms", "p90ms", "p99ms", "maxms", "disc"))
+    for k, s in stats.items():
+        total = len(s.lat) + s.busy + s.errors
+        e = {"ok": len(s.lat), "busy": s.busy, "errors": s.errors, "busyRate": s.busy / total if total else 0,
+             "p50": pct(s.lat, 50), "p90": pct(s.lat, 90), "p99": pct(s.lat, 99), "max": max(s.lat) if s.lat else 0,
+             "rps": len(s.lat) / args.time}
+        if k == "ws":
+            e.update({"disconnects": s.disconnects, "closeCodes": s.closeCodes, "rx": s.rx})
+        report["endpoints"][k] = e
+        print("%-6s %7d %6d %6d %7.0f %7.0f %7.0f %7.0f %6s" % (k, e["ok"], e["busy"], e["errors"], e["p50"], e["p90"], e["p99"], e["max"],
+                                                           s.disconnects if k == "ws" else "-"))
+    if stats.get("ws") and stats["ws"].closeCodes:
+        print("ws close codes: %s" % ", ".join("%d: %d" % kv for kv in sorted(stats["ws"].closeCodes.items())))
+
+    def summary(ss):
+        ss = [x for x in ss if x]
+        if not ss:
+            return {}
+        return {"fps": min(x["fps"] for x in ss), "fpsAvg": sum(x["fps"] for x in ss) / len(ss),
+                "lps": min(x["lps"] for x in ss), "loopMax": max(x["loopMax"] for x in ss),
+                "heap": min(x["heap"] for x in ss), "jbuf": max(x["jbuf"] for x in ss)}
+    report["device"] = {"idle": summary(idle), "load": summary(samples), "infoFailed": samples.count(None)}
+    for k in ("idle", "load"):
+        d = report["device"][k]
+        if d:
+            print("device %-4s fps min %d avg %.0f, loops/s min %d, loop max %dus, free heap min %d, JSON buffers in use max %d"
+                  % (k, d["fps"], d["fpsAvg"], d["lps"], d["loopMax"], d["heap"], d["jbuf"]))
+    if report["device"]["infoFailed"]:
+        print("/json/info failed %d time(s) under load" % report["device"]["infoFailed"])
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+# Effect benchmark: runs every effect on a WLED test controller for a number of segment sizes
+# and layouts and reports render time per frame and per pixel, as measured by the firmware
+# itself (/json/perf, render time of the effect function only, excluding output to LEDs).
+#
+# usage: fx_bench.py <host> [--sizes 30,150,600] [--2d] [--time 2] [--fx 0-10,42] [--csv out.csv] [--baseline old.csv]
+#
+# --2d        run on whole matrix (segment sizes are ignored), requires 2D configuration on controller
+# --time      seconds each effect runs while being measured
+# --baseline  CSV of an earlier run; effects that became slower by more than --tolerance (%) are listed at the end
+#
+# Use the same controller, LED configuration and firmware build type for runs that are compared.
+#
+# This is the on-device runner only. A host-native build of the effect code (FX.cpp, FX_fcn.cpp, ... against
+# Arduino/FastLED shims) with a benchmark suite is still open, see test/README.
+
+import argparse
+import csv
+import sys
+import time
+
+from wled_api import parse_ids, req
+
+
+def measure(host, seg, fx, dwell):
+    req(host, "/json/state", {"on": True, "tt": 0, "seg": [dict(seg, id=0, fx=fx, sx=128, ix=128, frz=False)]})
+    time.sleep(0.3)  # let first frames (allocation) pass
+    req(host, "/json/perf?reset")
+    time.sleep(dwell)
+    perf = req(host, "/json/perf")
+    for s in perf.get("perf", perf).get("seg", []):
+        if s.get("id") == 0 and s.get("fx") == fx:
+            return s
+    return None
+
+
+def main():
+    ap = argparse.ArgumentParser(description="WLED effect benchmark")
+    ap.add_argument("host")
+    ap.add_argument("--sizes", default="30,150,600")
+    ap.add_argument("--2d", dest="matrix", action="store_true")
+    ap.add_argument("--time", type=float, default=2.0)
+    ap.add_argument("--fx", default="")
+    ap.add_argument("--csv", default="")
+    ap.add_argument("--baseline", default="")
+    ap.add_argument("--tolerance", type=float, default=10.0)
+    args = ap.parse_args()
+
+    info = req(args.host, "/json/info")
+    names = req(args.host, "/json/effects")
+    total = info["leds"]["count"]
+    layouts = []
+    if args.matrix:
+        mx = info["leds"].get("matrix")
+        if not mx:
+            sys.exit("controller has no 2D configuration")
+        layouts.append(("2d", mx["w"] * mx["h"], {"start": 0, "stop": mx["w"], "startY": 0, "stopY": mx["h"]}))
+    else:
+        for n in [int(s) for s in args.sizes.split(",")]:
+            if n <= total:
+                layouts.append(("1d", n, {"start": 0, "stop": n}))
+    if not layouts:
+        sys.exit("no usable segment size (controller has %d LEDs)" % total)
+
+    rows = []
+    print("%-4s %-24s %-3s %6s %10s %9s %6s" % ("fx", "name", "dim", "len", "ns/frame", "ns/pixel", "fps"))
+    for dim, length, seg in layouts:
+        for fx in parse_ids(args.fx, len(names)):
+            name = names[fx]
+            if name.startswith("RSVD") or name == "-":
+                continue
+            s = measure(args.host, seg, fx, args.time)
+            if not s or not s.get("n"):
+                continue
+            ns = s["avg"] * 1000
+            rows.append({"fx": fx, "name": name, "dim": dim, "len": length, "ns_frame": ns, "ns_pixel": ns / length, "fps": s.get("fps", 0)})
+            print("%-4d %-24.24s %-3s %6d %10d %9.1f %6d" % (fx, name, dim, length, ns, ns / length, s.get("fps", 0)))
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            w = csv.DictWriter(f, fieldnames=list(rows[0].keys()) if rows else ["fx"])
+            w.writeheader()
+            w.writerows(rows)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            base = {(int(r["fx"]), r["dim"], int(r["len"])): float(r["ns_frame"]) for r in csv.DictReader(f)}
+        slower = [(r, base[(r["fx"], r["dim"], r["len"])]) for r in rows
+                  if (r["fx"], r["dim"], r["len"]) in base and r["ns_frame"] > base[(r["fx"], r["dim"], r["len"])] * (1 + args.tolerance / 100)]
+        print("\n%d effect(s) slower than baseline by more than %g%%" % (len(slower), args.tolerance))
+        for r, b in slower:
+            print("  %-24s %s %5d: %d -> %d ns/frame (%+.0f%%)" % (r["name"], r["dim"], r["len"], b, r["ns_frame"], (r["ns_frame"] / b - 1) * 100))
+        if slower:
+            sys.exit(2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+# Golden-frame check: renders every effect deterministically on a WLED test controller for a number of
+# segment layouts and compares hashes of the output against stored goldens, to catch visual changes
+# made by optimizations (mapping, buffers, fixed point math, blending, ...).
+# The firmware does the rendering (/json/bench?golden=<frames>): all segments start from a fixed random
+# seed, cleared buffers and time 0, time advances by one frame per frame, and the composited output of
+# all frames is hashed per effect (nothing is sent to the LEDs meanwhile).
+#
+# usage: fx_golden.py <host> [--frames 100] [--layouts 1d,rev,mirror,group,2d,arc] [--fx 0-10,42]
+#                     [--save golden.json] [--compare golden.json] [--stable]
+#
+# --save     write hashes to file (goldens)
+# --compare  compare hashes with goldens, effects that differ are listed and exit code is 2
+# --stable   render everything twice; effects that differ between runs (using millis() or beat functions
+#            instead of effect time) are reported as unstable and not compared (and marked so when saved)
+#
+# Use the same controller, LED configuration and build type for goldens and comparison.
+#
+# This is the on-device check only: it compares output hashes, not reference frames. Host-side rendering of
+# reference frames (PNG strips with a diff report) needs the host-native effect build, still open, see test/README.
+
+import argparse
+import json
+import sys
+import time
+
+from wled_api import parse_ids, req
+
+
+def layouts(info, names):
+    total = info["leds"]["count"]
+    mx = info["leds"].get("matrix")
+    n = min(total, 60)
+    out = {
+        "1d":     {"start": 0, "stop": n},
+        "rev":    {"start": 0, "stop": n, "rev": True},
+        "mirror": {"start": 0, "stop": n, "mi": True},
+        "group":  {"start": 0, "stop": n, "grp": 2, "spc": 1},
+    }
+    if mx:
+        m = {"start": 0, "stop": mx["w"], "startY": 0, "stopY": mx["h"]}
+        out["2d"] = dict(m, m12=0)
+        out["arc"] = dict(m, m12=2)  # 1D effects expanded as arcs
+    return {k: v for k, v in out.items() if k in names}
+
+
+def golden_run(host, seg, frames, segs):
+    # fixed segment settings, other segments are removed
+    s = dict(seg, id=0, on=True, bri=255, sx=128, ix=128, c1=128, c2=128, c3=16, o1=False, o2=False, o3=False,
+             pal=0, col=[[255, 160, 0], [0, 32, 255], [0, 255, 64]], frz=False)
+    s.setdefault("rev", False); s.setdefault("mi", False); s.setdefault("grp", 1); s.setdefault("spc", 0)
+    req(host, "/json/state", {"on": True, "bri": 128, "tt": 0, "seg": [s] + [{"id": i, "stop": 0} for i in segs if i != 0]})
+    time.sleep(0.3)
+    req(host, "/json/bench?golden=%d" % frames)
+    time.sleep(0.5)
+    while True:
+        b = req(host, "/json/bench")
+        if not b.get("run"):
+            break
+        time.sleep(1)
+    return {e["id"]: e["h"] for e in b.get("fx", []) if "h" in e}
+
+
+def main():
+    ap = argparse.ArgumentParser(description="WLED golden-frame check")
+    ap.add_argument("host")
+    ap.add_argument("--frames", type=int, default=100)
+    ap.add_argument("--layouts", default="1d,rev,mirror,group,2d,arc")
+    ap.add_argument("--fx", default="")
+    ap.add_argument("--save", default="")
+    ap.add_argument("--compare", default="")
+    ap.add_argument("--stable", action="store_true")
+    args = ap.parse_args()
+
+    info = req(args.host, "/json/info")
+    names = req(args.host, "/json/effects")
+    saved = req(args.host, "/json/state")
+    ids = set(parse_ids(args.fx, len(names)))
+    lay = layouts(info, args.layouts.split(","))
+    if not lay:
+        sys.exit("no usable layout (2d and arc require 2D configuration on controller)")
+
+    result = {"frames": args.frames, "leds": info["leds"]["count"], "ver": info.get("ver"), "layouts": {}}
+    segs = [s["id"] for s in saved.get("seg", [])]
+    try:
+        for name, seg in lay.items():
+            print("layout %s ..." % name)
+            h = golden_run(args.host, seg, args.frames, segs)
+            unstable = []
+            if args.stable:
+                h2 = golden_run(args.host, seg, args.frames, segs)
+                unstable = sorted(i for i in h if h2.get(i) != h[i])
+            result["layouts"][name] = {"fx": {str(i): "%08x" % v for i, v in h.items() if i in ids}, "unstable": [i for i in unstable if i in ids]}
+    finally:
+        req(args.host, "/json/state", saved)
+
+    if args.save:
+        with open(args.save, "w") as f:
+            json.dump(result, f, indent=1, sort_keys=True)
+
+    if args.compare:
+        with open(args.compare) as f:
+            gold = json.load(f)
+        if gold.get("frames") != args.frames or gold.get("leds") != result["leds"]:
+            sys.exit("goldens were made with %s frames on %s LEDs" % (gold.get("frames"), gold.get("leds")))
+        changed = []
+        for name, cur in result["layouts"].items():
+            ref = gold.get("layouts", {}).get(name)
+            if not ref:
+                print("layout %s: no goldens" % name)
+                continue
+            skip = set(ref.get("unstable", [])) | set(cur["unstable"])
+            for fx, h in sorted(cur["fx"].items(), key=lambda e: int(e[0])):
+                if int(fx) in skip or fx not in ref["fx"]:
+                    continue
+                if ref["fx"][fx] != h:
+                    changed.append((name, int(fx)))
+            if skip:
+                print("layout %s: %d unstable effect(s) not compared: %s" % (name, len(skip), ",".join(str(i) for i in sorted(skip))))
+        print("\n%d effect/layout combination(s) differ from goldens" % len(changed))
+        for name, fx in changed:
+            print("  %-6s %3d %s" % (name, fx, names[fx].split("@")[0] if fx < len(names) else ""))
+        if changed:
+            sys.exit(2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+# Converts a WLED ledmap.json into the binary ledmap format (ledmap.bin) which is
+# streamed directly into the mapping table on boot without using the JSON buffer.
+# Upload the resulting file instead of (or in addition to, .bin takes precedence) the .json one.
+#
+# usage: ledmap2bin.py ledmap1.json [ledmap1.bin] [--raw]
+#
+# format (little endian):
+#   "WMAP", uint8 version (1), uint8 flags (bit 0: RLE), uint16 number of entries, uint8 name length, name
+#   raw: uint16 per entry (0xFFFF = no LED)
+#   RLE: records of uint16 value and uint16 run (bits 0-13 length, bits 14-15: 0 same value, 1 ascending, 2 descending)
+
+import json
+import struct
+import sys
+
+MAX_RUN = 0x3FFF
+
+
+def rle_encode(values):
+    out = []
+    i = 0
+    while i < len(values):
+        start = values[i]
+        mode, n = 0, 1
+        if i + 1 < len(values):
+            d = (values[i+1] - start) & 0xFFFF
+            mode = {0: 0, 1: 1, 0xFFFF: 2}.get(d, 0)
+            step = {0: 0, 1: 1, 2: -1}[mode]
+            while i + n < len(values) and n < MAX_RUN and values[i+n] == (start + n*step) & 0xFFFF:
+                n += 1
+        out.append(struct.pack("<HH", start, n | (mode << 14)))
+        i += n
+    return b"".join(out)
+
+
+def convert(src, dst, raw=False):
+    with open(src, "r") as f:
+        doc = json.load(f)
+    values = [0xFFFF if v < 0 else v & 0xFFFF for v in doc.get("map", [])]
+    if len(values) > 0xFFFF:
+        raise ValueError("ledmap too large")
+    name = doc.get("n", "").encode("utf-8")[:32]
+    rle = rle_encode(values)
+    data = struct.pack("<%dH" % len(values), *values)
+    use_rle = not raw and len(rle) < len(data)
+    with open(dst, "wb") as f:
+        f.write(b"WMAP" + struct.pack("<BBHB", 1, 1 if use_rle else 0, len(values), len(name)) + name)
+        f.write(rle if use_rle else data)
+    print("%s: %d entries, %d bytes (%s)" % (dst, len(values), 9 + len(name) + len(rle if use_rle else data), "RLE" if use_rle else "raw"))
+
+
+if __name__ == "__main__":
+    args = [a for a in sys.argv[1:] if not a.startswith("--")]
+    if not args:
+        print(__doc__ if __doc__ else "usage: ledmap2bin.py ledmap.json [ledmap.bin] [--raw]")
+        sys.exit(1)
+    src = args[0]
+    dst = args[1] if len(args) > 1 else (src[:-5] if src.endswith(".json") else src) + ".bin"
+    convert(src, dst, "--raw" in sys.argv)
@@ -0,0 +1,33 @@
+# Shared helpers for the test tools talking to a WLED controller (fx_bench.py, fx_golden.py, api_load.py).
+# Only uses the Python standard library.
+
+import json
+import urllib.request
+
+
+def http(host, path, data=None, timeout=5):
+    """GET path (POST data as JSON if given), returns the raw response body"""
+    body = json.dumps(data).encode() if data is not None else None
+    r = urllib.request.Request("http://%s%s" % (host, path), data=body,
+                               headers={"Content-Type": "application/json"} if body else {})
+    with urllib.request.urlopen(r, timeout=timeout) as f:
+        return f.read()
+
+
+def req(host, path, data=None, timeout=10):
+    """like http() but decodes the JSON response (None if empty)"""
+    return json.loads(http(host, path, data, timeout).decode() or "null")
+
+
+def parse_ids(spec, count):
+    """IDs from a spec like "0-10,42" (all if empty), sorted and limited to count"""
+    if not spec:
+        return list(range(count))
+    ids = set()
+    for part in spec.split(","):
+        if "-" in part:
+            a, b = part.split("-")
+            ids.update(range(int(a), int(b) + 1))
+        else:
+            ids.add(int(part))
+    return sorted(i for i in ids if i < count)
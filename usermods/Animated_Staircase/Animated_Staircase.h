@@ -10,6 +10,10 @@
 #pragma once
 #include "wled.h"
 
+#ifndef STAIRCASE_DEBOUNCE_MS
+  #define STAIRCASE_DEBOUNCE_MS 20 // PIR/trigger pin changes closer than this are folded into one
+#endif
+
 class Animated_Staircase : public Usermod {
   private:
 
@@ -33,6 +37,12 @@ class Animated_Staircase : public Usermod {
     // Time between checking of the sensors
     const unsigned int scanDelay = 100;
 
+    // PIR/trigger pins delivering changes as pin events (not polled) and their last levels
+    bool topEvents    = false;
+    bool bottomEvents = false;
+    bool topLevel     = false;
+    bool bottomLevel  = false;
+
     // Lights on or off.
     // Flipping this will start a transition.
     bool on = false;
@@ -157,20 +167,20 @@ class Animated_Staircase : public Usermod {
       return pulseIn(echoPin, HIGH, maxTimeUs) > 0;
     }
 
-    bool checkSensors() {
+    bool checkSensors(bool force = false) {
       bool sensorChanged = false;
 
-      if ((millis() - lastScanTime) > scanDelay) {
+      if (force || (millis() - lastScanTime) > scanDelay) {
         lastScanTime = millis();
 
         bottomSensorRead = bottomSensorWrite ||
           (!useUSSensorBottom ?
-            (bottomPIRorTriggerPin<0 ? false : digitalRead(bottomPIRorTriggerPin)) :
+            (bottomPIRorTriggerPin<0 ? false : bottomEvents ? bottomLevel : digitalRead(bottomPIRorTriggerPin)) :
             ultrasoundRead(bottomPIRorTriggerPin, bottomEchoPin, bottomMaxDist*59)  // cm to us
           );
         topSensorRead = topSensorWrite ||
           (!useUSSensorTop ?
-            (topPIRorTriggerPin<0 ? false : digitalRead(topPIRorTriggerPin)) :
+            (topPIRorTriggerPin<0 ? false : topEvents ? topLevel : digitalRead(topPIRorTriggerPin)) :
             ultrasoundRead(topPIRorTriggerPin, topEchoPin, topMaxDist*59)   // cm to us
           );
 
@@ -221,6 +231,31 @@ class Animated_Staircase : public Usermod {
       return sensorChanged;
     }
 
+    // PIR/trigger pin changed (called from main loop by pinManager), react right away instead of on next scan
+    static void onPinEvent(uint8_t gpio, bool level, uint32_t us, void *arg) {
+      Animated_Staircase *self = static_cast<Animated_Staircase*>(arg);
+      if (gpio == self->topPIRorTriggerPin) self->topLevel = level;
+      else                                  self->bottomLevel = level;
+      if (!self->enabled) return;
+      self->checkSensors(true);
+      self->updateSwipe();
+    }
+
+    void attachPinEvents() {
+      topEvents    = !useUSSensorTop    && topPIRorTriggerPin >= 0 &&
+                     pinManager.attachEvent(topPIRorTriggerPin, PinOwner::UM_AnimatedStaircase, onPinEvent, this, STAIRCASE_DEBOUNCE_MS);
+      bottomEvents = !useUSSensorBottom && bottomPIRorTriggerPin >= 0 &&
+                     pinManager.attachEvent(bottomPIRorTriggerPin, PinOwner::UM_AnimatedStaircase, onPinEvent, this, STAIRCASE_DEBOUNCE_MS);
+      if (topEvents)    topLevel    = digitalRead(topPIRorTriggerPin);
+      if (bottomEvents) bottomLevel = digitalRead(bottomPIRorTriggerPin);
+    }
+
+    void detachPinEvents() {
+      if (topEvents)    pinManager.detachEvent(topPIRorTriggerPin, PinOwner::UM_AnimatedStaircase);
+      if (bottomEvents) pinManager.detachEvent(bottomPIRorTriggerPin, PinOwner::UM_AnimatedStaircase);
+      topEvents = bottomEvents = false;
+    }
+
     void autoPowerOff() {
       if ((millis() - lastSwitchTime) > on_time_ms) {
         // if sensors are still on, do nothing
@@ -293,6 +328,7 @@ class Animated_Staircase : public Usermod {
           pinMode(topPIRorTriggerPin, OUTPUT);
           pinMode(topEchoPin, INPUT);
         }
+        attachPinEvents();
         onIndex  = minSegmentId = strip.getMainSegmentId(); // it may not be the best idea to start with main segment as it may not be the first one
         offIndex = maxSegmentId = strip.getLastActiveSegmentId() + 1;
 
@@ -301,6 +337,7 @@ class Animated_Staircase : public Usermod {
         strip.setTransition(segment_delay_ms);
         strip.trigger();
       } else {
+        detachPinEvents();
         if (togglePower && !on && offMode) toggleOnOff(); // toggle power on if off
         // Restore segment options
         for (int i = 0; i <= strip.getLastActiveSegmentId(); i++) {
@@ -513,6 +550,7 @@ class Animated_Staircase : public Usermod {
             (oldBottomAPin != bottomPIRorTriggerPin) ||
             (oldBottomBPin != bottomEchoPin)) {
           changed = true;
+          topEvents = bottomEvents = false; // detached by deallocatePin()
           pinManager.deallocatePin(oldTopAPin, PinOwner::UM_AnimatedStaircase);
           pinManager.deallocatePin(oldTopBPin, PinOwner::UM_AnimatedStaircase);
           pinManager.deallocatePin(oldBottomAPin, PinOwner::UM_AnimatedStaircase);
@@ -299,6 +299,8 @@ class MyExampleUsermod : public Usermod {
      * handleOverlayDraw() is called just before every show() (LED strip update frame) after effects have set the colors.
      * Use this to blank out some LEDs or set them to a different color regardless of the set effect mode.
      * Commonly used for custom clocks (Cronixie, 7 segment)
+     * Content that does not change every frame is cheaper in the overlay layer: set it from loop() when it changes
+     * with strip.setOverlayPixel(i, color, alpha, getId()) / strip.clearOverlay(getId()), it is drawn over each frame.
      */
     void handleOverlayDraw()
     {
@@ -380,6 +382,28 @@ class MyExampleUsermod : public Usermod {
       return USERMOD_ID_EXAMPLE;
     }
 
+
+    /*
+     * getLoopInterval() lets the usermod manager call loop() only every so many milliseconds
+     * instead of on every main loop iteration (no need for your own millis() gating then).
+     * Time spent in loop() is reported per usermod in /json/perf ("um").
+     * getLoopCore() (ESP32 dual core only) runs loop() in a separate task pinned to the given core,
+     * loop() then runs concurrently with WLED and must not touch anything that is not thread safe.
+     */
+    //uint16_t getLoopInterval() { return 1000; }
+    //int8_t getLoopCore() { return 0; }
+
+
+    /*
+     * getEventMask()/onEvent() deliver changes instead of having to poll bri, segments, currentPreset etc. in loop().
+     * Combined with getLoopInterval() returning UM_LOOP_ON_EVENT, loop() is only called after an event
+     * (or once every ~65s).
+     */
+    //uint32_t getEventMask() { return UM_EVENT_MASK(UM_EVENT_BRIGHTNESS) | UM_EVENT_MASK(UM_EVENT_PRESET); }
+    //void onEvent(const um_event_t &ev) {
+    //  if (ev.type == UM_EVENT_PRESET) DEBUG_PRINTF("Preset %d applied.\n", ev.preset.id);
+    //}
+
    //More methods can be added in the future, this example will then be extended.
    //Your usermod will remain compatible as it does not need to implement all methods from the Usermod base class!
 };
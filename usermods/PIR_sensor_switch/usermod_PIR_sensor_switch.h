@@ -15,6 +15,10 @@
   #define PIR_SENSOR_OFF_SEC 600
 #endif
 
+#ifndef PIR_SENSOR_DEBOUNCE_MS
+  #define PIR_SENSOR_DEBOUNCE_MS 50 // sensor edges are delivered by pinManager, bouncing within this time is ignored
+#endif
+
 
 /*
  * This usermod handles PIR sensor states.
@@ -53,6 +57,7 @@ private:
   byte NotifyUpdateMode  = CALL_MODE_NO_NOTIFY; // notification mode for stateUpdated(): CALL_MODE_NO_NOTIFY or CALL_MODE_DIRECT_CHANGE
   byte sensorPinState    = LOW;                 // current PIR sensor pin state
   bool initDone          = false;               // status of initialization
+  bool pinEvents         = false;               // sensor changes are delivered as pin events (else pin is polled)
   unsigned long lastLoop = 0;
 
   // configurable parameters
@@ -103,7 +108,12 @@ private:
    * Read and update PIR sensor state.
    * Initialize/reset switch off timer
    */
-  bool updatePIRsensorState();
+  bool updatePIRsensorState(bool pinState);
+
+  /**
+   * pin event callback (called from main loop)
+   */
+  static void onPinEvent(uint8_t gpio, bool level, uint32_t us, void *arg);
 
   /**
    * switch off the strip if the delay has elapsed 
@@ -313,9 +323,8 @@ void PIRsensorSwitch::publishHomeAssistantAutodiscovery()
 #endif
 }
 
-bool PIRsensorSwitch::updatePIRsensorState()
+bool PIRsensorSwitch::updatePIRsensorState(bool pinState)
 {
-  bool pinState = digitalRead(PIRsensorPin);
   if (pinState != sensorPinState) {
     sensorPinState = pinState; // change previous state
 
@@ -348,6 +357,12 @@ bool PIRsensorSwitch::handleOffTimer()
   return false;
 }
 
+void PIRsensorSwitch::onPinEvent(uint8_t gpio, bool level, uint32_t us, void *arg)
+{
+  PIRsensorSwitch *self = static_cast<PIRsensorSwitch*>(arg);
+  if (self->enabled) self->updatePIRsensorState(level);
+}
+
 //Functions called by WLED
 
 void PIRsensorSwitch::setup()
@@ -358,6 +373,7 @@ void PIRsensorSwitch::setup()
       // PIR Sensor mode INPUT_PULLUP
       pinMode(PIRsensorPin, INPUT_PULLUP);
       sensorPinState = digitalRead(PIRsensorPin);
+      pinEvents = pinManager.attachEvent(PIRsensorPin, PinOwner::UM_PIR, onPinEvent, this, PIR_SENSOR_DEBOUNCE_MS);
     } else {
       if (PIRsensorPin >= 0) {
         DEBUG_PRINTLN(F("PIRSensorSwitch pin allocation failed."));
@@ -378,11 +394,11 @@ void PIRsensorSwitch::onMqttConnect(bool sessionPresent)
 
 void PIRsensorSwitch::loop()
 {
-  // only check sensors 4x/s
+  // only check sensors 4x/s (sensor changes arrive as pin events if available)
   if (!enabled || millis() - lastLoop < 250 || strip.isUpdating()) return;
   lastLoop = millis();
 
-  if (!updatePIRsensorState()) {
+  if (pinEvents || !updatePIRsensorState(digitalRead(PIRsensorPin))) {
     handleOffTimer();
   }
 }
@@ -544,6 +560,7 @@ bool PIRsensorSwitch::readFromConfig(JsonObject &root)
       }
       if (enabled) {
         sensorPinState = digitalRead(PIRsensorPin);
+        pinEvents = pinManager.attachEvent(PIRsensorPin, PinOwner::UM_PIR, onPinEvent, this, PIR_SENSOR_DEBOUNCE_MS);
       }
     }
     DEBUG_PRINTLN(F(" config (re)loaded."));
@@ -17,12 +17,21 @@
 #define USERMOD_DALLASTEMPERATURE_MEASUREMENT_INTERVAL 60000
 #endif
 
+// 1-Wire transfers are split into short steps (one per loop pass, never while LEDs are being updated)
+// so that interrupts are only held off for single bit slots and LED output timing is not disturbed
+#define TEMP_STATE_OFF      0 // no sensor (or disabled)
+#define TEMP_STATE_DETECT   1 // reset pulse & READ ROM sent, reading sensor address
+#define TEMP_STATE_IDLE     2 // waiting for next measurement
+#define TEMP_STATE_CONVERT  3 // conversion requested, waiting for it to complete
+#define TEMP_STATE_READ     4 // READ SCRATCHPAD sent, reading data
+#define TEMP_BYTES_PER_STEP 3 // ~0.2ms per byte
+
 class UsermodTemperature : public Usermod {
 
   private:
 
     bool initDone = false;
-    OneWire *oneWire;
+    OneWire *oneWire = nullptr;
     // GPIO pin used for sensor (with a default compile-time fallback)
     int8_t temperaturePin = TEMPERATURE_PIN;
     // measurement unit (true==°C, false==°F)
@@ -39,9 +48,14 @@ class UsermodTemperature : public Usermod {
     // we have to wait at least 93.75 ms after requestTemperatures() is called
     unsigned long lastTemperaturesRequest;
     float temperature;
-    // indicates requestTemperatures has been called but the sensor measurement is not complete
-    bool waitingForConversion = false;
-    // flag set at startup if DS18B20 sensor not found, avoids trying to keep getting
+    // sensor state machine (TEMP_STATE_*)
+    uint8_t sensorState = TEMP_STATE_OFF;
+    uint8_t retries = 0;          // sensor detection attempts left
+    uint8_t errorCount = 0;       // consecutive failed readings
+    unsigned long lastStep = 0;   // time of last detection attempt or conversion poll
+    uint8_t data[9];              // sensor address or scratchpad being read
+    uint8_t dataLen = 0;
+    // sensor family, 0 if DS18B20 sensor not found, avoids trying to keep getting
     // temperature if flashed to a board without a sensor attached
     byte sensorFound;
 
@@ -57,10 +71,12 @@ class UsermodTemperature : public Usermod {
     static const char _parasitePin[];
 
     //Dallas sensor quick (& dirty) reading. Credit to - Author: Peter Scargill, August 17th, 2013
-    float readDallas();
-    void requestTemperatures();
+    float decodeDallas();
+    bool requestTemperatures();
     void readTemperature();
     bool findSensor();
+    bool readBytes(uint8_t len);
+    void publishTemperature();
 #ifndef WLED_DISABLE_MQTT
     void publishHomeAssistantAutodiscovery();
 #endif
@@ -97,87 +113,101 @@ class UsermodTemperature : public Usermod {
 };
 
 //Dallas sensor quick (& dirty) reading. Credit to - Author: Peter Scargill, August 17th, 2013
-float UsermodTemperature::readDallas() {
-  byte data[9];
+float UsermodTemperature::decodeDallas() {
   int16_t result;                         // raw data from sensor
   float retVal = -127.0f;
-  if (oneWire->reset()) {                 // if reset() fails there are no OneWire devices
-    oneWire->skip();                      // skip ROM
-    oneWire->write(0xBE);                 // read (temperature) from EEPROM
-    oneWire->read_bytes(data, 9);         // first 2 bytes contain temperature
-    #ifdef WLED_DEBUG
-    if (OneWire::crc8(data,8) != data[8]) {
-      DEBUG_PRINTLN(F("CRC error reading temperature."));
-      for (byte i=0; i < 9; i++) DEBUG_PRINTF("0x%02X ", data[i]);
-      DEBUG_PRINT(F(" => "));
-      DEBUG_PRINTF("0x%02X\n", OneWire::crc8(data,8));
-    }
-    #endif
-    switch(sensorFound) {
-      case 0x10:  // DS18S20 has 9-bit precision
-        result = (data[1] << 8) | data[0];
-        retVal = float(result) * 0.5f;
-        break;
-      case 0x22:  // DS18B20
-      case 0x28:  // DS1822
-      case 0x3B:  // DS1825
-      case 0x42:  // DS28EA00
-        result = (data[1]<<4) | (data[0]>>4);   // we only need whole part, we will add fraction when returning
-        if (data[1] & 0x80) result |= 0xF000;   // fix negative value
-        retVal = float(result) + ((data[0] & 0x08) ? 0.5f : 0.0f);
-        break;
-    }
+  #ifdef WLED_DEBUG
+  if (OneWire::crc8(data,8) != data[8]) {
+    DEBUG_PRINTLN(F("CRC error reading temperature."));
+    for (byte i=0; i < 9; i++) DEBUG_PRINTF("0x%02X ", data[i]);
+    DEBUG_PRINT(F(" => "));
+    DEBUG_PRINTF("0x%02X\n", OneWire::crc8(data,8));
   }
-  for (byte i=1; i<9; i++) data[0] &= data[i];
-  return data[0]==0xFF ? -127.0f : retVal;
+  #endif
+  switch(sensorFound) {
+    case 0x10:  // DS18S20 has 9-bit precision
+      result = (data[1] << 8) | data[0];
+      retVal = float(result) * 0.5f;
+      break;
+    case 0x22:  // DS18B20
+    case 0x28:  // DS1822
+    case 0x3B:  // DS1825
+    case 0x42:  // DS28EA00
+      result = (data[1]<<4) | (data[0]>>4);   // we only need whole part, we will add fraction when returning
+      if (data[1] & 0x80) result |= 0xF000;   // fix negative value
+      retVal = float(result) + ((data[0] & 0x08) ? 0.5f : 0.0f);
+      break;
+  }
+  uint8_t all = data[0];
+  for (byte i=1; i<9; i++) all &= data[i];
+  return all==0xFF ? -127.0f : retVal;
 }
 
-void UsermodTemperature::requestTemperatures() {
+// reads up to TEMP_BYTES_PER_STEP bytes into data[], returns true once len bytes are read
+bool UsermodTemperature::readBytes(uint8_t len) {
+  for (uint8_t i = 0; i < TEMP_BYTES_PER_STEP && dataLen < len; i++) data[dataLen++] = oneWire->read();
+  return dataLen >= len;
+}
+
+bool UsermodTemperature::requestTemperatures() {
   DEBUG_PRINTLN(F("Requesting temperature."));
-  oneWire->reset();
+  if (!oneWire->reset()) return false;    // no presence pulse
   oneWire->skip();                        // skip ROM
   oneWire->write(0x44,parasite);          // request new temperature reading
   if (parasite && parasitePin >=0 ) digitalWrite(parasitePin, HIGH); // has to happen within 10us (open MOSFET)
-  lastTemperaturesRequest = millis();
-  waitingForConversion = true;
+  lastTemperaturesRequest = lastStep = millis();
+  sensorState = TEMP_STATE_CONVERT;
+  return true;
 }
 
 void UsermodTemperature::readTemperature() {
-  if (parasite && parasitePin >=0 ) digitalWrite(parasitePin, LOW); // deactivate power (close MOSFET)
-  temperature = readDallas();
+  temperature = decodeDallas();
   lastMeasurement = millis();
-  waitingForConversion = false;
+  sensorState = TEMP_STATE_IDLE;
   //DEBUG_PRINTF("Read temperature %2.1f.\n", temperature); // does not work properly on 8266
   DEBUG_PRINT(F("Read temperature "));
   DEBUG_PRINTLN(temperature);
 }
 
+// checks the address read with READ ROM (single sensor on the bus)
 bool UsermodTemperature::findSensor() {
-  DEBUG_PRINTLN(F("Searching for sensor..."));
-  uint8_t deviceAddress[8] = {0,0,0,0,0,0,0,0};
-  // find out if we have DS18xxx sensor attached
-  oneWire->reset_search();
-  delay(10);
-  while (oneWire->search(deviceAddress)) {
-    DEBUG_PRINTLN(F("Found something..."));
-    if (oneWire->crc8(deviceAddress, 7) == deviceAddress[7]) {
-      switch (deviceAddress[0]) {
-        case 0x10:  // DS18S20
-        case 0x22:  // DS18B20
-        case 0x28:  // DS1822
-        case 0x3B:  // DS1825
-        case 0x42:  // DS28EA00
-          DEBUG_PRINTLN(F("Sensor found."));
-          sensorFound = deviceAddress[0];
-          DEBUG_PRINTF("0x%02X\n", sensorFound);
-          return true;
-      }
+  if (OneWire::crc8(data, 7) == data[7]) {
+    switch (data[0]) {
+      case 0x10:  // DS18S20
+      case 0x22:  // DS18B20
+      case 0x28:  // DS1822
+      case 0x3B:  // DS1825
+      case 0x42:  // DS28EA00
+        DEBUG_PRINTLN(F("Sensor found."));
+        sensorFound = data[0];
+        DEBUG_PRINTF("0x%02X\n", sensorFound);
+        return true;
     }
   }
   DEBUG_PRINTLN(F("Sensor NOT found."));
   return false;
 }
 
+void UsermodTemperature::publishTemperature() {
+#ifndef WLED_DISABLE_MQTT
+  if (WLED_MQTT_CONNECTED) {
+    char subuf[64];
+    strcpy(subuf, mqttDeviceTopic);
+    if (temperature > -100.0f) {
+      // dont publish super low temperature as the graph will get messed up
+      // the DallasTemperature library returns -127C or -196.6F when problem
+      // reading the sensor
+      strcat_P(subuf, PSTR("/temperature"));
+      mqtt->publish(subuf, 0, false, String(getTemperatureC()).c_str());
+      strcat_P(subuf, PSTR("_f"));
+      mqtt->publish(subuf, 0, false, String(getTemperatureF()).c_str());
+    } else {
+      // publish something else to indicate status?
+    }
+  }
+#endif
+}
+
 #ifndef WLED_DISABLE_MQTT
 void UsermodTemperature::publishHomeAssistantAutodiscovery() {
   if (!WLED_MQTT_CONNECTED) return;
@@ -203,8 +233,8 @@ void UsermodTemperature::publishHomeAssistantAutodiscovery() {
 #endif
 
 void UsermodTemperature::setup() {
-  int retries = 10;
   sensorFound = 0;
+  sensorState = TEMP_STATE_OFF;
   temperature = -127.0f; // default to -127, DS18B20 only goes down to -50C
   if (enabled) {
     // config says we are enabled
@@ -212,11 +242,12 @@ void UsermodTemperature::setup() {
     // pin retrieved from cfg.json (readFromConfig()) prior to running setup()
     if (temperaturePin >= 0 && pinManager.allocatePin(temperaturePin, true, PinOwner::UM_Temperature)) {
       oneWire = new OneWire(temperaturePin);
-      if (oneWire->reset()) {
-        while (!findSensor() && retries--) {
-          delay(25); // try to find sensor
-        }
-      }
+      // sensor is searched for from loop()
+      DEBUG_PRINTLN(F("Searching for sensor..."));
+      sensorState = TEMP_STATE_DETECT;
+      retries = 10;
+      dataLen = 0;
+      lastStep = millis() - 25;
       if (parasite && pinManager.allocatePin(parasitePin, true, PinOwner::UM_Temperature)) {
         pinMode(parasitePin, OUTPUT);
         digitalWrite(parasitePin, LOW); // deactivate power (close MOSFET)
@@ -235,51 +266,71 @@ void UsermodTemperature::setup() {
 }
 
 void UsermodTemperature::loop() {
-  if (!enabled || !sensorFound || strip.isUpdating()) return;
+  if (!enabled || sensorState == TEMP_STATE_OFF || strip.isUpdating()) return;
 
-  static uint8_t errorCount = 0;
   unsigned long now = millis();
 
-  // check to see if we are due for taking a measurement
-  // lastMeasurement will not be updated until the conversion
-  // is complete the the reading is finished
-  if (now - lastMeasurement < readingInterval) return;
-
-  // we are due for a measurement, if we are not already waiting
-  // for a conversion to complete, then make a new request for temps
-  if (!waitingForConversion) {
-    requestTemperatures();
-    return;
-  }
-
-  // we were waiting for a conversion to complete, have we waited log enough?
-  if (now - lastTemperaturesRequest >= 750 /* 93.75ms per the datasheet but can be up to 750ms */) {
-    readTemperature();
-    if (getTemperatureC() < -100.0f) {
-      if (++errorCount > 10) sensorFound = 0;
-      lastMeasurement = now - readingInterval + 300; // force new measurement in 300ms
+  switch (sensorState) {
+    case TEMP_STATE_DETECT:
+      // a new attempt every 25ms: reset & READ ROM, then the 8 address bytes in steps
+      if (!dataLen) {
+        if (now - lastStep < 25) return;
+        lastStep = now;
+        if (oneWire->reset()) {
+          oneWire->write(0x33);          // READ ROM
+          readBytes(8);
+          return;
+        }
+      } else if (!readBytes(8)) return;
+      else if (findSensor()) sensorState = TEMP_STATE_IDLE;
+      dataLen = 0;
+      if (sensorState == TEMP_STATE_DETECT && !retries--) sensorState = TEMP_STATE_OFF;
       return;
-    }
-    errorCount = 0;
 
-#ifndef WLED_DISABLE_MQTT
-    if (WLED_MQTT_CONNECTED) {
-      char subuf[64];
-      strcpy(subuf, mqttDeviceTopic);
-      if (temperature > -100.0f) {
-        // dont publish super low temperature as the graph will get messed up
-        // the DallasTemperature library returns -127C or -196.6F when problem
-        // reading the sensor
-        strcat_P(subuf, PSTR("/temperature"));
-        mqtt->publish(subuf, 0, false, String(getTemperatureC()).c_str());
-        strcat_P(subuf, PSTR("_f"));
-        mqtt->publish(subuf, 0, false, String(getTemperatureF()).c_str());
-      } else {
-        // publish something else to indicate status?
+    case TEMP_STATE_IDLE:
+      // check to see if we are due for taking a measurement
+      // lastMeasurement will not be updated until the conversion
+      // is complete the the reading is finished
+      if (now - lastMeasurement < readingInterval || requestTemperatures()) return;
+      memset(data, 0xFF, sizeof(data));   // reported as error
+      readTemperature();
+      break;
+
+    case TEMP_STATE_CONVERT:
+      // have we waited long enough? 93.75ms per the datasheet but can be up to 750ms
+      // without parasite power the sensor reports (polled every 10ms) when it is done
+      if (now - lastTemperaturesRequest < 94 || now - lastStep < 10) return;
+      lastStep = now;
+      if (now - lastTemperaturesRequest < 750 && (parasite || !oneWire->read_bit())) return;
+      if (parasite && parasitePin >=0 ) digitalWrite(parasitePin, LOW); // deactivate power (close MOSFET)
+      dataLen = 0;
+      if (oneWire->reset()) {             // if reset() fails there are no OneWire devices
+        oneWire->skip();                  // skip ROM
+        oneWire->write(0xBE);             // read scratchpad (temperature is in first 2 bytes)
+        sensorState = TEMP_STATE_READ;
+        return;
       }
+      memset(data, 0xFF, sizeof(data));   // reported as error
+      readTemperature();
+      break;
+
+    case TEMP_STATE_READ:
+      if (!readBytes(9)) return;
+      readTemperature();
+      break;
+  }
+
+  // a reading has completed
+  if (getTemperatureC() < -100.0f) {
+    if (++errorCount > 10) {
+      sensorFound = 0;
+      sensorState = TEMP_STATE_OFF;
     }
-#endif
+    lastMeasurement = now - readingInterval + 300; // force new measurement in 300ms
+    return;
   }
+  errorCount = 0;
+  publishTemperature();
 }
 
 /**
@@ -398,6 +449,7 @@ bool UsermodTemperature::readFromConfig(JsonObject &root) {
       DEBUG_PRINTLN(F("Re-init temperature."));
       // deallocate pin and release memory
       delete oneWire;
+      oneWire = nullptr;
       pinManager.deallocatePin(temperaturePin, PinOwner::UM_Temperature);
       temperaturePin = newTemperaturePin;
       pinManager.deallocatePin(parasitePin, PinOwner::UM_Temperature);
@@ -53,6 +53,7 @@
 
 // use audio source class (ESP32 specific)
 #include "audio_source.h"
+#include "audio_sync.h"
 constexpr i2s_port_t I2S_PORT = I2S_NUM_0;       // I2S port to use (do not change !)
 constexpr int BLOCK_SIZE = 128;                  // I2S buffer size (samples)
 
@@ -82,6 +83,7 @@ static uint16_t attackTime =  80;             // int: attack time in millisecond
 static uint16_t decayTime = 1400;             // int: decay time in milliseconds.  Default 1.40sec
 // user settable options for FFTResult scaling
 static uint8_t FFTScalingMode = 3;            // 0 none; 1 optimized logarithmic; 2 optimized linear; 3 optimized square root
+static uint8_t FFTAnalysisMode = 0;           // 0 full FFT; 1 GEQ only (Goertzel filter bank, much less CPU but no fine grained frequency results)
 
 // 
 // AGC presets
@@ -129,21 +131,51 @@ static void autoResetPeak(void);     // peak auto-reset function
 // some prototypes, to ensure consistent interfaces
 static float mapf(float x, float in_min, float in_max, float out_min, float out_max); // map function for float
 static float fftAddAvg(int from, int to);   // average of several FFT result bins
+static void geqAnalysis(float &majorPeak, float &magnitude); // GEQ only alternative to FFT
 void FFTcode(void * parameter);      // audio processing task: read samples, run FFT, fill GEQ channels from FFT results
 static void runMicFilter(uint16_t numSamples, float *sampleBuffer);          // pre-filtering of raw samples (band-pass)
 static void postProcessFFTResults(bool noiseGateOpen, int numberOfChannels); // post-processing and post-amp of GEQ channels
 
+// fixed point post-FFT chain (band-pass, channel mapping, post-processing, peak detection), default on targets without FPU
+#if !defined(UM_AUDIOREACTIVE_FIXEDPOINT) && !defined(UM_AUDIOREACTIVE_FLOATPOINT) && (defined(CONFIG_IDF_TARGET_ESP32C3) || defined(CONFIG_IDF_TARGET_ESP32S2))
+  #define UM_AUDIOREACTIVE_FIXEDPOINT
+#endif
+#ifdef UM_AUDIOREACTIVE_FIXEDPOINT
+static void runMicFilterQ8(uint16_t numSamples, float *sampleBuffer);       // integer version of runMicFilter()
+static void mapFFTChannelsQ8(bool noiseGateOpen);                          // FFT bins to GEQ channels
+static void postProcessFFTResultsQ8(bool noiseGateOpen, int numberOfChannels);
+#endif
+
 #define NUM_GEQ_CHANNELS 16                                           // number of frequency channels. Don't change !!
+static_assert(NUM_GEQ_CHANNELS == AUDIOSYNC_V3_CHANNELS, "audio sync packets carry 16 GEQ channels");
 
 static TaskHandle_t FFT_Task = nullptr;
 
 // Table of multiplication factors so that we can even out the frequency response.
 static float fftResultPink[NUM_GEQ_CHANNELS] = { 1.70f, 1.71f, 1.73f, 1.78f, 1.68f, 1.56f, 1.55f, 1.63f, 1.79f, 1.62f, 1.80f, 2.06f, 2.47f, 3.35f, 6.83f, 9.55f };
 
-// globals and FFT Output variables shared with animations
+// globals and FFT Output variables shared with animations (owned by loop task, updated from FFT task results in loop())
 static float FFT_MajorPeak = 1.0f;              // FFT: strongest (peak) frequency
 static float FFT_Magnitude = 0.0f;              // FFT: volume (magnitude) of peak frequency
 static uint8_t fftResult[NUM_GEQ_CHANNELS]= {0};// Our calculated freq. channel result table to be used by effects
+
+// complete FFT result handed over from FFT task (single writer) to loop task (single reader) using a sequence lock:
+// sequence is odd while writer updates the frame, reader retries if sequence changed while copying
+typedef struct AudioFrame {
+  uint32_t time;                                // millis() when FFT result was produced
+  float    majorPeak;
+  float    magnitude;
+  uint8_t  fftResult[NUM_GEQ_CHANNELS];
+} audioFrame_t;
+static audioFrame_t fftFrame;                  // published by FFT task
+static volatile uint32_t fftFrameSeq = 0;      // sequence (even: frame is stable)
+static uint32_t fftFrameSeqRead = 0;           // last sequence consumed by loop task
+static uint32_t fftFrameTime = 0;              // time stamp of last consumed frame
+
+// FFT task working results (only accessed by FFT task)
+static float   fftTaskPeak = 1.0f;
+static float   fftTaskMagnitude = 0.0f;
+static uint8_t fftTaskResult[NUM_GEQ_CHANNELS] = {0};
 #if defined(WLED_DEBUG) || defined(SR_DEBUG)
 static uint64_t fftTime = 0;
 static uint64_t sampleTime = 0;
@@ -169,6 +201,17 @@ constexpr SRate_t SAMPLE_RATE = 22050;        // Base sample rate in Hz - 22Khz
 // FFT Constants
 constexpr uint16_t samplesFFT = 512;            // Samples in an FFT batch - This value MUST ALWAYS be a power of 2
 constexpr uint16_t samplesFFT_2 = 256;          // meaningfull part of FFT results - only the "lower half" contains useful information.
+#ifdef UM_AUDIOREACTIVE_FFT_OVERLAP
+// 50% overlapping windows: each FFT uses samplesHop new samples and the newest half of the previous window,
+// results come twice as often (FFT runs twice as often, results respond faster to beats with the same window size)
+constexpr uint16_t samplesHop = samplesFFT / 2;
+static float sampleRing[samplesFFT] = {0.0f};   // last samplesFFT samples, newest at the end
+#else
+constexpr uint16_t samplesHop = samplesFFT;     // new samples per FFT
+#endif
+static_assert(samplesHop % BLOCK_SIZE == 0, "samples per FFT must be a multiple of the I2S DMA block size");
+static_assert(I2S_DMA_BUF_COUNT * BLOCK_SIZE >= 2 * samplesHop, "I2S DMA ring must hold two batches of samples");
+#define FFT_CYCLE_BUDGET (FFT_MIN_CYCLE * samplesHop / samplesFFT) // ms until next batch of samples is complete
 // the following are observed values, supported by a bit of "educated guessing"
 //#define FFT_DOWNSCALE 0.65f                             // 20kHz - downscaling factor for FFT results - "Flat-Top" window @20Khz, old freq channels 
 #define FFT_DOWNSCALE 0.46f                             // downscaling factor for FFT results - for "Flat-Top" window @22Khz, new freq channels
@@ -179,31 +222,112 @@ static float vReal[samplesFFT] = {0.0f};       // FFT sample inputs / freq outpu
 static float vImag[samplesFFT] = {0.0f};       // imaginary parts
 
 // Create FFT object
-#ifdef UM_AUDIOREACTIVE_USE_NEW_FFT
-  // lib_deps += https://github.com/kosme/arduinoFFT#develop @ 1.9.2
-  // these options actually cause slow-downs on all esp32 processors, don't use them.
-  // #define FFT_SPEED_OVER_PRECISION     // enables use of reciprocals (1/x etc) - not faster on ESP32
-  // #define FFT_SQRT_APPROXIMATION       // enables "quake3" style inverse sqrt  - slower on ESP32
-  // Below options are forcing ArduinoFFT to use sqrtf() instead of sqrt()
-  #define sqrt(x) sqrtf(x)             // little hack that reduces FFT time by 10-50% on ESP32
-  #define sqrt_internal sqrtf          // see https://github.com/kosme/arduinoFFT/pull/83
-#else
-  // around 40% slower on -S2
-  // lib_deps += https://github.com/blazoncek/arduinoFFT.git
-#endif
+#ifdef UM_AUDIOREACTIVE_USE_ESPDSP
+  // ESP-DSP FFT backend (esp-dsp is part of arduino-esp32 2.x), uses assembly optimized radix-2 FFT on ESP32 and ESP32-S3
+  #include <esp_dsp.h>
+  #if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32C3)
+    #define SR_DSP_FIXED  // no FPU: use 16 bit fixed point FFT
+  #endif
+
+  // Flat Top window coefficients (same as arduinoFFT, so FFT_DOWNSCALE and channel mapping remain valid)
+  static double flatTop(int i) {
+    return 0.2810639 - 0.5208972 * cos(2.0*M_PI*i/(samplesFFT-1)) + 0.1980399 * cos(4.0*M_PI*i/(samplesFFT-1));
+  }
+  #ifdef SR_DSP_FIXED
+  static int16_t dspWindow[samplesFFT];                                   // window in Q15
+  static int16_t dspData[samplesFFT*2] __attribute__((aligned(16)));    // interleaved complex samples
+  #else
+  static float dspWindow[samplesFFT];
+  static float dspData[samplesFFT*2] __attribute__((aligned(16)));      // interleaved complex samples
+  #endif
+
+  static bool dspFFTinit(void) {
+    static bool done = false;
+    if (done) return true;
+    #ifdef SR_DSP_FIXED
+    if (dsps_fft2r_init_sc16(NULL, samplesFFT) != ESP_OK) return false;
+    for (int i = 0; i < samplesFFT; i++) dspWindow[i] = flatTop(i) * 32767.0;
+    #else
+    if (dsps_fft2r_init_fc32(NULL, samplesFFT) != ESP_OK) return false;
+    for (int i = 0; i < samplesFFT; i++) dspWindow[i] = flatTop(i);
+    #endif
+    done = true;
+    return true;
+  }
 
-#include <arduinoFFT.h>
+  // removes DC, applies window, computes FFT and puts magnitudes into vReal[]; replaces arduinoFFT calls
+  static void dspFFT(float &majorPeak, float &magnitude) {
+    float mean = 0.0f;
+    for (int i = 0; i < samplesFFT; i++) mean += vReal[i];
+    mean /= samplesFFT;
+
+    #ifdef SR_DSP_FIXED
+    // scale input to use most of 16 bit range, sc16 FFT scales result down by 1/samplesFFT to avoid overflow
+    float maxAbs = 1.0f;
+    for (int i = 0; i < samplesFFT; i++) maxAbs = fmaxf(maxAbs, fabsf(vReal[i] - mean));
+    int shift = 0;
+    while (shift < 14 && maxAbs * (1 << (shift+1)) < 32767.0f) shift++;
+    while (shift > -16 && maxAbs / (1 << -shift) > 32767.0f) shift--;
+    const float inScale = shift >= 0 ? float(1 << shift) : 1.0f / float(1 << -shift);
+    for (int i = 0; i < samplesFFT; i++) {
+      const int32_t s = (vReal[i] - mean) * inScale;
+      dspData[i*2]   = (s * dspWindow[i]) >> 15;
+      dspData[i*2+1] = 0;
+    }
+    dsps_fft2r_sc16(dspData, samplesFFT);
+    dsps_bit_rev_sc16_ansi(dspData, samplesFFT);
+    const float outScale = float(samplesFFT) / inScale;
+    for (int i = 0; i < samplesFFT; i++) {
+      const int32_t re = dspData[i*2], im = dspData[i*2+1];
+      const uint32_t mag2 = uint32_t(re*re) + uint32_t(im*im); // each square fits int32 (<= 2^30), their sum needs unsigned
+      vReal[i] = sqrtf(float(mag2)) * outScale;
+    }
+    #else
+    for (int i = 0; i < samplesFFT; i++) {
+      dspData[i*2]   = (vReal[i] - mean) * dspWindow[i];
+      dspData[i*2+1] = 0.0f;
+    }
+    dsps_fft2r_fc32(dspData, samplesFFT);
+    dsps_bit_rev_fc32(dspData, samplesFFT);
+    for (int i = 0; i < samplesFFT; i++) vReal[i] = sqrtf(dspData[i*2]*dspData[i*2] + dspData[i*2+1]*dspData[i*2+1]);
+    #endif
 
-#ifdef UM_AUDIOREACTIVE_USE_NEW_FFT
-#if defined(FFT_LIB_REV) && FFT_LIB_REV > 0x19
-  // arduinoFFT 2.x has a slightly different API
-  static ArduinoFFT<float> FFT = ArduinoFFT<float>( vReal, vImag, samplesFFT, SAMPLE_RATE, true);
-#else
-  static float windowWeighingFactors[samplesFFT] = {0.0f}; // cache for FFT windowing factors
-  static ArduinoFFT<float> FFT = ArduinoFFT<float>( vReal, vImag, samplesFFT, SAMPLE_RATE, windowWeighingFactors);
-#endif
+    // strongest frequency with parabolic interpolation (as arduinoFFT majorPeak())
+    int peak = 1;
+    for (int i = 2; i < samplesFFT_2; i++) if (vReal[i] > vReal[peak]) peak = i;
+    const float a = vReal[peak-1], b = vReal[peak], c = vReal[peak+1];
+    const float d = a - 2.0f*b + c;
+    const float delta = d != 0.0f ? 0.5f * (a - c) / d : 0.0f;
+    majorPeak = ((peak + delta) * SAMPLE_RATE) / (samplesFFT - 1);
+    magnitude = b;
+  }
 #else
-  static arduinoFFT FFT = arduinoFFT(vReal, vImag, samplesFFT, SAMPLE_RATE);
+  #ifdef UM_AUDIOREACTIVE_USE_NEW_FFT
+    // lib_deps += https://github.com/kosme/arduinoFFT#develop @ 1.9.2
+    // these options actually cause slow-downs on all esp32 processors, don't use them.
+    // #define FFT_SPEED_OVER_PRECISION     // enables use of reciprocals (1/x etc) - not faster on ESP32
+    // #define FFT_SQRT_APPROXIMATION       // enables "quake3" style inverse sqrt  - slower on ESP32
+    // Below options are forcing ArduinoFFT to use sqrtf() instead of sqrt()
+    #define sqrt(x) sqrtf(x)             // little hack that reduces FFT time by 10-50% on ESP32
+    #define sqrt_internal sqrtf          // see https://github.com/kosme/arduinoFFT/pull/83
+  #else
+    // around 40% slower on -S2
+    // lib_deps += https://github.com/blazoncek/arduinoFFT.git
+  #endif
+
+  #include <arduinoFFT.h>
+
+  #ifdef UM_AUDIOREACTIVE_USE_NEW_FFT
+  #if defined(FFT_LIB_REV) && FFT_LIB_REV > 0x19
+    // arduinoFFT 2.x has a slightly different API
+    static ArduinoFFT<float> FFT = ArduinoFFT<float>( vReal, vImag, samplesFFT, SAMPLE_RATE, true);
+  #else
+    static float windowWeighingFactors[samplesFFT] = {0.0f}; // cache for FFT windowing factors
+    static ArduinoFFT<float> FFT = ArduinoFFT<float>( vReal, vImag, samplesFFT, SAMPLE_RATE, windowWeighingFactors);
+  #endif
+  #else
+    static arduinoFFT FFT = arduinoFFT(vReal, vImag, samplesFFT, SAMPLE_RATE);
+  #endif
 #endif
 
 // Helper functions
@@ -222,6 +346,46 @@ static float fftAddAvg(int from, int to) {
   return result / float(to - from + 1);
 }
 
+// GEQ channel boundaries in FFT bins (as used by channel mapping in FFTcode()), without and with band pass filter
+// GEQ only analysis: channel b covers bins [geqBands[b], geqBands[b+1]), each bin belongs to exactly one channel
+static const uint8_t geqBands[2][NUM_GEQ_CHANNELS+1] = {
+  { 1, 2, 3, 5, 7, 10, 13, 19, 26, 33, 44, 56, 70, 86, 104, 165, 215 },
+  { 3, 4, 5, 6, 7, 10, 13, 19, 26, 33, 44, 56, 70, 86, 104, 165, 205 }
+};
+
+// GEQ only analysis: one Goertzel filter per GEQ channel, centered on the channel and running over the most recent
+// samplesFFT/bins samples so that its bandwidth roughly matches the channel width (constant Q filter bank).
+// Channel values are written into the bins of vReal[] so that channel mapping and peak detection work as with FFT.
+static void geqAnalysis(float &majorPeak, float &magnitude) {
+  float mean = 0.0f;
+  for (int i = 0; i < samplesFFT; i++) mean += vReal[i];
+  mean /= samplesFFT;
+
+  const uint8_t *band = geqBands[useBandPassFilter];
+  float result[NUM_GEQ_CHANNELS];
+  int peak = 0;
+  for (int b = 0; b < NUM_GEQ_CHANNELS; b++) {
+    const int bins = band[b+1] - band[b];
+    const int len  = max(8, samplesFFT / bins);
+    const float coeff = 2.0f * cosf(float(M_PI) * (band[b] + band[b+1]) / samplesFFT); // 2*cos(2*pi*center/N)
+    float s1 = 0.0f, s2 = 0.0f;
+    for (int i = samplesFFT - len; i < samplesFFT; i++) {
+      const float s0 = (vReal[i] - mean) + coeff * s1 - s2;
+      s2 = s1;
+      s1 = s0;
+    }
+    const float power = fmaxf(s1*s1 + s2*s2 - coeff*s1*s2, 0.0f);
+    // tone of amplitude A gives A*len/2 here, while flat top FFT gives ~A*samplesFFT/2 spread over the bins of a channel
+    result[b] = sqrtf(power) * float(samplesFFT) / float(len * bins);
+    if (result[b] > result[peak]) peak = b;
+  }
+
+  memset(vReal, 0, sizeof(vReal));
+  for (int b = 0; b < NUM_GEQ_CHANNELS; b++) for (int i = band[b]; i < band[b+1]; i++) vReal[i] = result[b];
+  majorPeak = float(band[peak] + band[peak+1]) * 0.5f * SAMPLE_RATE / samplesFFT;
+  magnitude = result[peak] * (band[peak+1] - band[peak]) * 0.281f; // approx. flat top FFT peak bin magnitude (A*samplesFFT/2*a0)
+}
+
 //
 // FFT main task
 //
@@ -248,8 +412,24 @@ void FFTcode(void * parameter)
     bool haveDoneFFT = false; // indicates if second measurement (FFT time) is valid
 #endif
 
-    // get a fresh batch of samples from I2S
-    if (audioSource) audioSource->getSamples(vReal, samplesFFT);
+    // get a fresh batch of samples from I2S, directly into the FFT input unless windows overlap
+    // waits at most twice as long as the batch takes to arrive; an incomplete batch is completed in the next cycle
+    if (audioSource) {
+      static uint16_t sampleFill = 0;
+      static const TickType_t sampleWait = max(TickType_t(1), TickType_t(pdMS_TO_TICKS(2000UL * samplesHop / SAMPLE_RATE)));
+#ifdef UM_AUDIOREACTIVE_FFT_OVERLAP
+      float *batch = sampleRing + (samplesFFT - samplesHop);
+#else
+      float *batch = vReal;
+#endif
+      sampleFill += audioSource->getSamples(batch + sampleFill, samplesHop - sampleFill, sampleWait);
+      if (sampleFill < samplesHop) continue;
+      sampleFill = 0;
+#ifdef UM_AUDIOREACTIVE_FFT_OVERLAP
+      memcpy(vReal, sampleRing, sizeof(vReal)); // FFT works in place
+      memmove(sampleRing, sampleRing + samplesHop, (samplesFFT - samplesHop) * sizeof(float));
+#endif
+    }
 
 #if defined(WLED_DEBUG) || defined(SR_DEBUG)
     if (start < esp_timer_get_time()) { // filter out overflows
@@ -263,7 +443,11 @@ void FFTcode(void * parameter)
 
     // band pass filter - can reduce noise floor by a factor of 50
     // downside: frequencies below 100Hz will be ignored
+#ifdef UM_AUDIOREACTIVE_FIXEDPOINT
+    if (useBandPassFilter) runMicFilterQ8(samplesFFT, vReal);
+#else
     if (useBandPassFilter) runMicFilter(samplesFFT, vReal);
+#endif
 
     // find highest sample in the batch
     float maxSample = 0.0f;                         // max sample from FFT batch
@@ -284,8 +468,13 @@ void FFTcode(void * parameter)
     if (sampleAvg > 0.25f) { // noise gate open means that FFT results will be used. Don't run FFT if results are not needed.
 #endif
 
+      if (FFTAnalysisMode == 1) {
+      geqAnalysis(fftTaskPeak, fftTaskMagnitude);                 // GEQ channels only (Goertzel filters)
+      } else {
       // run FFT (takes 3-5ms on ESP32, ~12ms on ESP32-S2)
-#ifdef UM_AUDIOREACTIVE_USE_NEW_FFT
+#if defined(UM_AUDIOREACTIVE_USE_ESPDSP)
+      dspFFT(fftTaskPeak, fftTaskMagnitude);                       // DC removal, windowing, FFT, magnitudes and major peak
+#elif defined(UM_AUDIOREACTIVE_USE_NEW_FFT)
       FFT.dcRemoval();                                            // remove DC offset
       FFT.windowing( FFTWindow::Flat_top, FFTDirection::Forward); // Weigh data using "Flat Top" function - better amplitude accuracy
       //FFT.windowing(FFTWindow::Blackman_Harris, FFTDirection::Forward);  // Weigh data using "Blackman- Harris" window - sharp peaks due to excellent sideband rejection
@@ -302,17 +491,20 @@ void FFTcode(void * parameter)
       FFT.ComplexToMagnitude();                               // Compute magnitudes
 #endif
 
-#ifdef UM_AUDIOREACTIVE_USE_NEW_FFT
+#if defined(UM_AUDIOREACTIVE_USE_ESPDSP)
+      // major peak already computed
+#elif defined(UM_AUDIOREACTIVE_USE_NEW_FFT)
     #if defined(FFT_LIB_REV) && FFT_LIB_REV > 0x19
       // arduinoFFT 2.x has a slightly different API
-      FFT.majorPeak(&FFT_MajorPeak, &FFT_Magnitude);                // let the effects know which freq was most dominant
+      FFT.majorPeak(&fftTaskPeak, &fftTaskMagnitude);                // let the effects know which freq was most dominant
     #else
-      FFT.majorPeak(FFT_MajorPeak, FFT_Magnitude);                // let the effects know which freq was most dominant
+      FFT.majorPeak(fftTaskPeak, fftTaskMagnitude);                // let the effects know which freq was most dominant
     #endif
 #else
-      FFT.MajorPeak(&FFT_MajorPeak, &FFT_Magnitude);              // let the effects know which freq was most dominant
+      FFT.MajorPeak(&fftTaskPeak, &fftTaskMagnitude);              // let the effects know which freq was most dominant
 #endif
-      FFT_MajorPeak = constrain(FFT_MajorPeak, 1.0f, 11025.0f);   // restrict value to range expected by effects
+      }
+      fftTaskPeak = constrain(fftTaskPeak, 1.0f, 11025.0f);   // restrict value to range expected by effects
 
 #if defined(WLED_DEBUG) || defined(SR_DEBUG)
       haveDoneFFT = true;
@@ -320,10 +512,15 @@ void FFTcode(void * parameter)
 
     } else { // noise gate closed - only clear results as FFT was skipped. MIC samples are still valid when we do this.
       memset(vReal, 0, sizeof(vReal));
-      FFT_MajorPeak = 1;
-      FFT_Magnitude = 0.001;
+      fftTaskPeak = 1;
+      fftTaskMagnitude = 0.001;
     }
 
+#ifdef UM_AUDIOREACTIVE_FIXEDPOINT
+    // the only float to integer conversion of the chain: one per bin, everything after this is Q8 integer math
+    mapFFTChannelsQ8(fabsf(sampleAvg) > 0.5f);
+    postProcessFFTResultsQ8(fabsf(sampleAvg) > 0.25f, NUM_GEQ_CHANNELS);
+#else
     for (int i = 0; i < samplesFFT; i++) {
       float t = fabsf(vReal[i]);                      // just to be sure - values in fft bins should be positive any way
       vReal[i] = t / 16.0f;                           // Reduce magnitude. Want end result to be scaled linear and ~4096 max.
@@ -358,6 +555,14 @@ void FFTcode(void * parameter)
       fftCalc[14] = fftAddAvg(147,194);   // 2940 - 3900
       fftCalc[15] = fftAddAvg(194,250);   // 3880 - 5000 // avoid the last 5 bins, which are usually inaccurate
 #else
+      if (FFTAnalysisMode == 1) {
+        // GEQ only: each channel from its own bins, the FFT mapping below also averages the first bin of the next channel
+        const uint8_t *band = geqBands[useBandPassFilter];
+        for (int b = 0; b < NUM_GEQ_CHANNELS; b++) fftCalc[b] = fftAddAvg(band[b], band[b+1] - 1);
+        if (useBandPassFilter) { fftCalc[0] *= 0.8f; fftCalc[1] *= 0.9f; fftCalc[15] *= 0.75f; } // same damping as below
+        else                   fftCalc[15] *= 0.70f;
+        fftCalc[14] *= 0.88f;
+      } else {
       /* new mapping, optimized for 22050 Hz by softhack007 */
                                                     // bins frequency  range
       if (useBandPassFilter) {
@@ -387,6 +592,7 @@ void FFTcode(void * parameter)
       fftCalc[12] = fftAddAvg(70,86);               // 16 3015 - 3704 high mid
       fftCalc[13] = fftAddAvg(86,104);              // 18 3704 - 4479 high mid
       fftCalc[14] = fftAddAvg(104,165) * 0.88f;     // 61 4479 - 7106 high mid + high  -- with slight damping
+      }
 #endif
     } else {  // noise gate closed - just decay old values
       for (int i=0; i < NUM_GEQ_CHANNELS; i++) {
@@ -397,6 +603,17 @@ void FFTcode(void * parameter)
 
     // post-processing of frequency channels (pink noise adjustment, AGC, smoothing, scaling)
     postProcessFFTResults((fabsf(sampleAvg) > 0.25f)? true : false , NUM_GEQ_CHANNELS);
+#endif
+
+    // hand over complete result to loop task
+    fftFrameSeq = fftFrameSeq + 1;             // odd: update in progress
+    __sync_synchronize();
+    fftFrame.time      = millis();
+    fftFrame.majorPeak = fftTaskPeak;
+    fftFrame.magnitude = fftTaskMagnitude;
+    memcpy(fftFrame.fftResult, fftTaskResult, sizeof(fftFrame.fftResult));
+    __sync_synchronize();
+    fftFrameSeq = fftFrameSeq + 1;             // even: frame complete
 
 #if defined(WLED_DEBUG) || defined(SR_DEBUG)
     if (haveDoneFFT && (start < esp_timer_get_time())) { // filter out overflows
@@ -518,15 +735,152 @@ static void postProcessFFTResults(bool noiseGateOpen, int numberOfChannels) // p
         break;
       }
 
-      // Now, let's dump it all into fftResult. Need to do this, otherwise other routines might grab fftResult values prematurely.
+      // Now, let's dump it all into fftTaskResult (published to fftResult once complete).
       if (soundAgc > 0) {  // apply extra "GEQ Gain" if set by user
         float post_gain = (float)inputLevel/128.0f;
         if (post_gain < 1.0f) post_gain = ((post_gain -1.0f) * 0.8f) +1.0f;
         currentResult *= post_gain;
       }
-      fftResult[i] = constrain((int)currentResult, 0, 255);
+      fftTaskResult[i] = constrain((int)currentResult, 0, 255);
+    }
+}
+#ifdef UM_AUDIOREACTIVE_FIXEDPOINT
+//////////////////////////////////
+// Fixed point post-processing  //
+//////////////////////////////////
+// Integer versions of the float chain above for ESP32-C3/S2 (no FPU), where soft float alone exceeds FFT_MIN_CYCLE.
+// Values are Q8 (8 fractional bits) like the float values they replace (bins are already divided by 16). Coefficients
+// are the float ones rounded, log and sqrt are approximated; GEQ results stay within one step of the float chain.
+// AGC (agcAvg()) runs once per loop() and not per bin, it stays float; its gain enters here as one Q16 factor per cycle.
+#define AR_Q8(x)  uint32_t((x) * 256.0f + 0.5f)
+#define AR_Q16(x) int32_t((x) * 65536.0f + 0.5f)
+static uint32_t fftBinQ8[samplesFFT_2] = {0};                         // FFT magnitudes / 16 (vReal[] is not scaled in this mode)
+static uint32_t fftCalcQ8[NUM_GEQ_CHANNELS] = {0};                    // same as fftCalc[]
+static uint32_t fftAvgQ8[NUM_GEQ_CHANNELS] = {0};                     // same as fftAvg[]
+static const uint16_t fftResultPinkQ8[NUM_GEQ_CHANNELS] = {           // same as fftResultPink[]
+  AR_Q8(1.70f), AR_Q8(1.71f), AR_Q8(1.73f), AR_Q8(1.78f), AR_Q8(1.68f), AR_Q8(1.56f), AR_Q8(1.55f), AR_Q8(1.63f),
+  AR_Q8(1.79f), AR_Q8(1.62f), AR_Q8(1.80f), AR_Q8(2.06f), AR_Q8(2.47f), AR_Q8(3.35f), AR_Q8(6.83f), AR_Q8(9.55f) };
+
+static inline uint32_t mulQ8(uint32_t v, uint32_t k)  { return (uint64_t(v) * k) >> 8; }
+static inline int32_t  mulQ16(int32_t v, int32_t k)   { return (int64_t(v) * k) >> 16; }
+
+static uint32_t isqrt32(uint32_t v) {
+  uint32_t r = 0, b = 1UL << 30;
+  while (b > v) b >>= 2;
+  while (b) {
+    if (v >= r + b) { v -= r + b; r = (r >> 1) + b; }
+    else r >>= 1;
+    b >>= 2;
+  }
+  return r;
+}
+
+// natural log of x (Q8, x > 1.0) in Q8: exponent from leading zeros, log2(1+f) ~ f + 0.3466*f*(1-f) (error < 0.005)
+static int32_t lnQ8(uint32_t x) {
+  const int e = 31 - __builtin_clz(x);
+  const uint32_t f = ((x << (31 - e)) >> 15) & 0xFFFF;                // mantissa fraction, Q16
+  const int32_t log2Q16 = ((e - 8) << 16) + f + ((((f * (65536 - f)) >> 16) * 22714) >> 16);
+  return (int64_t(log2Q16) * AR_Q16(0.69314718f)) >> 24;
+}
+
+static void runMicFilterQ8(uint16_t numSamples, float *sampleBuffer)
+{
+  constexpr int32_t alpha = AR_Q16(0.0225f);  // 80Hz, see runMicFilter()
+  constexpr int32_t beta1 = AR_Q16(0.85f);    // 20kHz
+  constexpr int32_t beta2 = (65536 - beta1) / 2;
+  static int32_t last_vals[2] = { 0 };        // FIR high freq cutoff filter (Q8)
+  static int64_t lowfilt = 0;                 // IIR low frequency cutoff filter (Q24)
+
+  int32_t next = int32_t(sampleBuffer[0] * 256.0f);
+  for (int i=0; i < numSamples; i++) {
+    const int32_t cur = next;
+    int64_t acc = int64_t(beta1) * cur + int64_t(beta2) * last_vals[0];
+    if (i < (numSamples-1)) { next = int32_t(sampleBuffer[i+1] * 256.0f); acc += int64_t(beta2) * next; }
+    else acc += int64_t(beta2) * last_vals[1];
+    last_vals[1] = last_vals[0];
+    last_vals[0] = cur;
+    const int32_t high = acc >> 16;
+    lowfilt += (int64_t(alpha) * ((int64_t(high) << 16) - lowfilt)) >> 16;
+    sampleBuffer[i] = float(high - int32_t(lowfilt >> 16)) * (1.0f/256.0f);
+  }
+}
+
+// same channels and damping as the mapping in FFTcode() (geqBands[] holds its bin boundaries)
+static void mapFFTChannelsQ8(bool noiseGateOpen)
+{
+  for (int i = 0; i < samplesFFT_2; i++) {
+    const float t = fabsf(vReal[i]) * 16.0f;                          // / 16 as Q8
+    fftBinQ8[i] = t < float(1UL << 28) ? uint32_t(t) : (1UL << 28);   // headroom for sums
+  }
+  if (!noiseGateOpen) {                                               // just decay old values
+    for (int i=0; i < NUM_GEQ_CHANNELS; i++) {
+      fftCalcQ8[i] = mulQ8(fftCalcQ8[i], AR_Q8(0.85f));
+      if (fftCalcQ8[i] < AR_Q8(4.0f)) fftCalcQ8[i] = 0;
+    }
+    return;
+  }
+  static const uint16_t damping[2][NUM_GEQ_CHANNELS] = {
+    { 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, AR_Q8(0.88f), AR_Q8(0.70f) },
+    { AR_Q8(0.8f), AR_Q8(0.9f), 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, 256, AR_Q8(0.88f), AR_Q8(0.75f) }
+  };
+  const uint8_t *band = geqBands[useBandPassFilter];
+  const int shared = FFTAnalysisMode == 1 ? 0 : 1; // GEQ only: channel bins are [band[b], band[b+1]), FFT includes band[b+1]
+  for (int b = 0; b < NUM_GEQ_CHANNELS; b++) {
+    uint64_t sum = 0;
+    for (int i = band[b]; i < band[b+1] + shared; i++) sum += fftBinQ8[i];
+    fftCalcQ8[b] = mulQ8(sum / (band[b+1] - band[b] + shared), damping[useBandPassFilter][b]);
+  }
+}
+
+static void postProcessFFTResultsQ8(bool noiseGateOpen, int numberOfChannels)
+{
+  // pink noise adjustment, FFT downscale and gain combined into one factor per channel
+  const uint64_t gainQ16 = soundAgc ? uint64_t(multAgc * 65536.0f) : (uint32_t(sampleGain) * inputLevel * 64U) / 5U + 4096U; // sampleGain/40 * inputLevel/128 + 1/16
+  const uint32_t downQ8  = FFTScalingMode > 0 ? AR_Q8(FFT_DOWNSCALE) : 256;
+  const uint32_t attack  = AR_Q16(0.75f);
+  const uint32_t decay   = decayTime < 1000 ? AR_Q16(0.22f) : decayTime < 2000 ? AR_Q16(0.17f) : decayTime < 3000 ? AR_Q16(0.14f) : AR_Q16(0.1f);
+  int32_t postGain = int32_t(inputLevel) << 9;                        // Q16 inputLevel/128
+  if (postGain < 65536) postGain = 65536 - mulQ16(65536 - postGain, AR_Q16(0.8f));
+
+  for (int i=0; i < numberOfChannels; i++) {
+    if (noiseGateOpen) fftCalcQ8[i] = (uint64_t(fftCalcQ8[i]) * ((fftResultPinkQ8[i] * downQ8 * gainQ16) >> 8)) >> 24;
+
+    // smooth results - rise fast, fall slower
+    const uint32_t k = fftCalcQ8[i] > fftAvgQ8[i] ? attack : decay;
+    fftAvgQ8[i] = (uint64_t(fftCalcQ8[i]) * k + uint64_t(fftAvgQ8[i]) * (65536 - k) + 32768) >> 16;
+    fftCalcQ8[i] = MIN(fftCalcQ8[i], 1023U << 8);
+    fftAvgQ8[i]  = MIN(fftAvgQ8[i],  1023U << 8);
+
+    int32_t currentResult = limiterOn ? fftAvgQ8[i] : fftCalcQ8[i];
+    switch (FFTScalingMode) {
+      case 1: // logarithmic
+        currentResult = mulQ16(currentResult, AR_Q16(0.42f)) - (8 << 8);
+        currentResult = currentResult > 256 ? lnQ8(currentResult) : 0;
+        currentResult = mulQ16(currentResult, AR_Q16(0.85f) + i * 65536 / 18);
+        currentResult = (int64_t(currentResult) * AR_Q16(255.0f / LOG_256)) >> 16;
+      break;
+      case 2: // linear
+        currentResult = mulQ16(currentResult, AR_Q16(0.30f)) - (4 << 8);
+        if (currentResult < 256) currentResult = 0;
+        currentResult = mulQ16(currentResult, AR_Q16(0.85f) + i * 65536 * 10 / 18);
+      break;
+      case 3: // square root
+        currentResult = mulQ16(currentResult, AR_Q16(0.38f)) - (6 << 8);
+        currentResult = currentResult > 256 ? isqrt32(uint32_t(currentResult) << 8) : 0;
+        currentResult = mulQ16(currentResult, AR_Q16(0.85f) + i * 65536 * 10 / 45);
+        currentResult = currentResult * 255 / 16;
+      break;
+      case 0:
+      default:
+        currentResult -= 4 << 8;
+      break;
     }
+    if (soundAgc > 0) currentResult = mulQ16(currentResult, postGain); // extra "GEQ Gain"
+    fftTaskResult[i] = constrain(currentResult >> 8, 0, 255);
+  }
 }
+#endif
+
 ////////////////////
 // Peak detection //
 ////////////////////
@@ -538,7 +892,11 @@ static void detectSamplePeak(void) {
   // Poor man's beat detection by seeing if sample > Average + some value.
   // This goes through ALL of the 255 bins - but ignores stupid settings
   // Then we got a peak, else we don't. The peak has to time out on its own in order to support UDP sound sync.
+#ifdef UM_AUDIOREACTIVE_FIXEDPOINT
+  if ((sampleAvg > 1) && (maxVol > 0) && (binNum > 4) && (fftBinQ8[binNum] > (uint32_t(maxVol) << 8)) && ((millis() - timeOfPeak) > 100)) {
+#else
   if ((sampleAvg > 1) && (maxVol > 0) && (binNum > 4) && (vReal[binNum] > maxVol) && ((millis() - timeOfPeak) > 100)) {
+#endif
     havePeak = true;
   }
 
@@ -549,6 +907,25 @@ static void detectSamplePeak(void) {
   }
 }
 
+// copies latest complete FFT task result into variables used by effects, returns true if there was a new one
+static bool consumeFFTFrame(void) {
+  uint32_t seq;
+  audioFrame_t frame;
+  do {
+    seq = fftFrameSeq;
+    if (seq == fftFrameSeqRead) return false;  // nothing new
+    __sync_synchronize();
+    memcpy(&frame, &fftFrame, sizeof(frame));
+    __sync_synchronize();
+  } while ((seq & 1) || seq != fftFrameSeq);    // writer was active, retry
+  fftFrameSeqRead = seq;
+  fftFrameTime    = frame.time;
+  FFT_MajorPeak   = frame.majorPeak;
+  FFT_Magnitude   = frame.magnitude;
+  memcpy(fftResult, frame.fftResult, sizeof(fftResult));
+  return true;
+}
+
 static void autoResetPeak(void) {
   uint16_t MinShowDelay = MAX(50, strip.getMinShowDelay());  // Fixes private class variable compiler error. Unsure if this is the correct way of fixing the root problem. -THATDONFC
   if (millis() - timeOfPeak > MinShowDelay) {          // Auto-reset of samplePeak after a complete frame has passed.
@@ -610,6 +987,8 @@ class AudioReactive : public Usermod {
       float  FFT_MajorPeak;   //  04 Bytes
     };
 
+    // "V3" audiosync struct and jitter buffer frames: see audio_sync.h
+
     // old "V1" audiosync struct - 83 Bytes - for backwards compatibility
     struct audioSyncPacket_v1 {
       char header[6];         //  06 Bytes
@@ -631,12 +1010,22 @@ class AudioReactive : public Usermod {
     #endif
 
     bool     initDone = false;
+    um_handle_t *umHandle = nullptr;  // published um_data, version is bumped on every new sample
 
     // variables  for UDP sound sync
     WiFiUDP fftUdp;               // UDP object for sound sync (from WiFi UDP, not Async UDP!) 
     unsigned long lastTime = 0;   // last time of running UDP Microphone Sync
     const uint16_t delayMs = 10;  // I don't want to sample too often and overload WLED
     uint16_t audioSyncPort= 11988;// default port for UDP sound sync
+    uint8_t  audioSyncFormat = 2; // transmitted sync format: 2 (0.14 compatible) or 3 (sequenced, time stamped)
+    bool     audioSyncCompact = false; // v3: quantize GEQ channels to 4 bits
+    uint8_t  audioSyncGroup = 1;  // multicast group 239.0.0.x
+    uint16_t audioSyncDelay = 40; // receiver play out delay (ms) for v3 packets, 0 plays out immediately
+    uint16_t audioSyncSeq = 0;    // v3: transmit sequence
+    audioSyncFrame_t syncFrames[AUDIOSYNC_JITTER_FRAMES] = {}; // v3: receiver jitter buffer
+    int32_t  syncClockOffset = 0; // v3: local time minus sender time (smallest transit seen, slowly following drift)
+    bool     syncClockValid = false;
+    uint16_t syncLastSeq = 0;     // v3: sequence of last frame played out
 
     // used for AGC
     int      last_soundAgc = -1;   // used to detect AGC mode change (for resetting AGC internal error buffers)
@@ -658,7 +1047,7 @@ class AudioReactive : public Usermod {
 
     // used to feed "Info" Page
     unsigned long last_UDPTime = 0;    // time of last valid UDP sound sync datapacket
-    int receivedFormat = 0;            // last received UDP sound sync format - 0=none, 1=v1 (0.13.x), 2=v2 (0.14.x)
+    int receivedFormat = 0;            // last received UDP sound sync format - 0=none, 1=v1 (0.13.x), 2=v2 (0.14.x), 3=v3
     float maxSample5sec = 0.0f;        // max sample (after AGC) in last 5 seconds 
     unsigned long sampleMaxTimer = 0;  // last time maxSample5sec was reset
     #define CYCLE_SAMPLEMAX 3500       // time window for merasuring
@@ -671,6 +1060,7 @@ class AudioReactive : public Usermod {
     static const char _digitalmic[];
     static const char UDP_SYNC_HEADER[];
     static const char UDP_SYNC_HEADER_v1[];
+    static const char UDP_SYNC_HEADER_v3[];
 
     // private methods
 
@@ -971,10 +1361,32 @@ class AudioReactive : public Usermod {
       connected(); // try to start UDP
     }
 
+    void transmitAudioData_v3()
+    {
+      audioSyncPacket_v3 transmitData;
+      memset(reinterpret_cast<void *>(&transmitData), 0, sizeof(transmitData));
+
+      strncpy_P(transmitData.header, PSTR(UDP_SYNC_HEADER_v3), 6);
+      transmitData.seq        = audioSyncSeq++;
+      transmitData.time       = fftFrameSeqRead ? fftFrameTime : millis(); // time when FFT result was produced
+      size_t len = audioSyncEncode_v3(&transmitData, (soundAgc) ? rawSampleAgc : sampleRaw, (soundAgc) ? sampleAgc : sampleAvg,
+                                      udpSamplePeak, my_magnitude, FFT_MajorPeak, fftResult, audioSyncCompact);
+      udpSamplePeak = false; // Reset udpSamplePeak after we've transmitted it
+
+      if (fftUdp.beginMulticastPacket() != 0) { // beginMulticastPacket returns 0 in case of error
+        fftUdp.write(reinterpret_cast<uint8_t *>(&transmitData), len);
+        fftUdp.endPacket();
+      }
+    } // transmitAudioData_v3()
+
     void transmitAudioData()
     {
       if (!udpSyncConnected) return;
       //DEBUGSR_PRINTLN("Transmitting UDP Mic Packet");
+      if (audioSyncFormat == 3) {
+        transmitAudioData_v3();
+        return;
+      }
 
       audioSyncPacket transmitData;
       memset(reinterpret_cast<void *>(&transmitData), 0, sizeof(transmitData)); // make sure that the packet - including "invisible" padding bytes added by the compiler - is fully initialized
@@ -1007,12 +1419,20 @@ class AudioReactive : public Usermod {
     static bool isValidUdpSyncVersion_v1(const char *header) {
       return strncmp_P(header, PSTR(UDP_SYNC_HEADER_v1), 6) == 0;
     }
+    static bool isValidUdpSyncVersion_v3(const char *header) {
+      return strncmp_P(header, PSTR(UDP_SYNC_HEADER_v3), 6) == 0;
+    }
 
     void decodeAudioData(int packetSize, uint8_t *fftBuff) {
       audioSyncPacket *receivedPacket = reinterpret_cast<audioSyncPacket*>(fftBuff);
+      applyAudioData(receivedPacket->sampleRaw, receivedPacket->sampleSmth, receivedPacket->samplePeak, receivedPacket->fftResult, receivedPacket->FFT_Magnitude, receivedPacket->FFT_MajorPeak);
+    }
+
+    // update samples and FFT results from received v2/v3 data
+    void applyAudioData(float raw, float smth, bool peak, const uint8_t *fft, float magnitude, float majorPeak) {
       // update samples for effects
-      volumeSmth   = fmaxf(receivedPacket->sampleSmth, 0.0f);
-      volumeRaw    = fmaxf(receivedPacket->sampleRaw, 0.0f);
+      volumeSmth   = fmaxf(smth, 0.0f);
+      volumeRaw    = fmaxf(raw, 0.0f);
       // update internal samples
       sampleRaw    = volumeRaw;
       sampleAvg    = volumeSmth;
@@ -1023,15 +1443,52 @@ class AudioReactive : public Usermod {
       // If it's true already, then the animation still needs to respond.
       autoResetPeak();
       if (!samplePeak) {
-            samplePeak = receivedPacket->samplePeak >0 ? true:false;
+            samplePeak = peak;
             if (samplePeak) timeOfPeak = millis();
             //userVar1 = samplePeak;
       }
       //These values are only available on the ESP32
-      for (int i = 0; i < NUM_GEQ_CHANNELS; i++) fftResult[i] = receivedPacket->fftResult[i];
-      my_magnitude  = fmaxf(receivedPacket->FFT_Magnitude, 0.0f);
+      for (int i = 0; i < NUM_GEQ_CHANNELS; i++) fftResult[i] = fft[i];
+      my_magnitude  = fmaxf(magnitude, 0.0f);
       FFT_Magnitude = my_magnitude;
-      FFT_MajorPeak = constrain(receivedPacket->FFT_MajorPeak, 1.0f, 11025.0f);  // restrict value to range expected by effects
+      FFT_MajorPeak = constrain(majorPeak, 1.0f, 11025.0f);  // restrict value to range expected by effects
+    }
+
+    // put received v3 packet into jitter buffer
+    void decodeAudioData_v3(int packetSize, uint8_t *fftBuff) {
+      audioSyncPacket_v3 *receivedPacket = reinterpret_cast<audioSyncPacket_v3*>(fftBuff);
+      const uint32_t now = millis();
+      const int32_t offset = int32_t(now - receivedPacket->time);
+      if (!syncClockValid || abs(offset - syncClockOffset) > 1000) { // new or restarted sender: resync
+        syncClockValid  = true;
+        syncClockOffset = offset;
+        syncLastSeq     = receivedPacket->seq - 1;
+        for (auto &f : syncFrames) f.valid = false;
+      } else syncClockOffset = audioSyncFollowClock(syncClockOffset, offset); // faster transit or slow clock drift
+      if (int16_t(receivedPacket->seq - syncLastSeq) <= 0) return;     // late or duplicate
+
+      // use free slot or replace oldest frame
+      audioSyncFrame_t *f = &syncFrames[0];
+      for (auto &slot : syncFrames) {
+        if (!slot.valid) { f = &slot; break; }
+        if (int16_t(slot.seq - f->seq) < 0) f = &slot;
+      }
+      audioSyncDecode_v3(receivedPacket, f);
+    }
+
+    // play out newest buffered v3 frame that is due (sender time + transit + delay), returns true if a frame was applied
+    bool playoutAudioData() {
+      const uint32_t now = millis();
+      audioSyncFrame_t *due = nullptr;
+      for (auto &f : syncFrames) {
+        if (!f.valid || int32_t(now - (f.time + syncClockOffset + audioSyncDelay)) < 0) continue;
+        if (!due || int16_t(f.seq - due->seq) > 0) due = &f;
+      }
+      if (!due) return false;
+      applyAudioData(due->sampleRaw, due->sampleSmth, due->samplePeak, due->fftResult, due->magnitude, due->majorPeak);
+      syncLastSeq = due->seq;
+      for (auto &f : syncFrames) if (f.valid && int16_t(f.seq - syncLastSeq) <= 0) f.valid = false; // drop played and skipped
+      return true;
     }
 
     void decodeAudioData_v1(int packetSize, uint8_t *fftBuff) {
@@ -1072,6 +1529,12 @@ class AudioReactive : public Usermod {
         fftUdp.read(fftBuff, packetSize);
 
         // VERIFY THAT THIS IS A COMPATIBLE PACKET
+        if ((packetSize == sizeof(audioSyncPacket_v3) || packetSize == sizeof(audioSyncPacket_v3) - NUM_GEQ_CHANNELS/2) && isValidUdpSyncVersion_v3((const char *)fftBuff)
+            && ((packetSize == sizeof(audioSyncPacket_v3)) == !(fftBuff[offsetof(audioSyncPacket_v3, flags)] & AUDIOSYNC_V3_COMPACT))) {
+          decodeAudioData_v3(packetSize, fftBuff);
+          haveFreshData = true;
+          receivedFormat = 3;
+        } else
         if (packetSize == sizeof(audioSyncPacket) && (isValidUdpSyncVersion((const char *)fftBuff))) {
           decodeAudioData(packetSize, fftBuff);
           //DEBUGSR_PRINTLN("Finished parsing UDP Sync Packet v2");
@@ -1128,6 +1591,7 @@ class AudioReactive : public Usermod {
         um_data->u_type[6] = UMT_BYTE;
         um_data->u_data[7] = &binNum;          // assigned in effect function from UI element!!! (Puddlepeak, Ripplepeak, Waterfall)
         um_data->u_type[7] = UMT_BYTE;
+        umHandle = usermods.publishUMData(USERMOD_ID_AUDIOREACTIVE, nullptr); // data is provided in loop() while enabled
       }
 
       // Reset I2S peripheral for good measure
@@ -1202,6 +1666,9 @@ class AudioReactive : public Usermod {
       delay(250); // give microphone enough time to initialise
 
       if (!audioSource) enabled = false;                 // audio failed to initialise
+#ifdef UM_AUDIOREACTIVE_USE_ESPDSP
+      if (enabled && !dspFFTinit()) enabled = false;     // ESP-DSP FFT tables could not be allocated
+#endif
       if (enabled) onUpdateBegin(false);                 // create FFT task
       if (FFT_Task == nullptr) enabled = false;          // FFT task creation failed
       if (enabled) disableSoundProcessing = false;       // all good - enable audio processing
@@ -1233,9 +1700,9 @@ class AudioReactive : public Usermod {
       
       if (audioSyncPort > 0 && (audioSyncEnabled & 0x03)) {
       #ifndef ESP8266
-        udpSyncConnected = fftUdp.beginMulticast(IPAddress(239, 0, 0, 1), audioSyncPort);
+        udpSyncConnected = fftUdp.beginMulticast(IPAddress(239, 0, 0, audioSyncGroup), audioSyncPort);
       #else
-        udpSyncConnected = fftUdp.beginMulticast(WiFi.localIP(), IPAddress(239, 0, 0, 1), audioSyncPort);
+        udpSyncConnected = fftUdp.beginMulticast(WiFi.localIP(), IPAddress(239, 0, 0, audioSyncGroup), audioSyncPort);
       #endif
       }
     }
@@ -1255,6 +1722,7 @@ class AudioReactive : public Usermod {
     {
       static unsigned long lastUMRun = millis();
 
+      if (umHandle) umHandle->data = enabled ? um_data : nullptr; // effects use simulated sound while disabled
       if (!enabled) {
         disableSoundProcessing = true;   // keep processing suspended (FFT task)
         lastUMRun = millis();            // update time keeping
@@ -1320,6 +1788,8 @@ class AudioReactive : public Usermod {
         } while (userloopDelay > 0);
         lastUMRun = t_now;                    // update time keeping
 
+        consumeFFTFrame();                    // fetch latest complete FFT result
+
         // update samples for effects (raw, smooth) 
         volumeSmth = (soundAgc) ? sampleAgc   : sampleAvg;
         volumeRaw  = (soundAgc) ? rawSampleAgc: sampleRaw;
@@ -1329,6 +1799,7 @@ class AudioReactive : public Usermod {
         if (volumeSmth < 1 ) my_magnitude = 0.001f;  // noise gate closed - mute
 
         limitSampleDynamics();
+        if (umHandle) umHandle->version++;
       }  // if (!disableSoundProcessing)
 
       autoResetPeak();          // auto-reset sample peak after strip minShowDelay
@@ -1348,10 +1819,13 @@ class AudioReactive : public Usermod {
             else fftUdp.flush(); // Flush udp input buffers if we haven't read it - avoids hickups in receive mode. Does not work on 8266.
 #endif
             lastTime = millis();
+            if (receivedFormat == 3) have_new_sample = false; // v3 frames are applied by jitter buffer
           }
+          if (receivedFormat == 3 && playoutAudioData()) have_new_sample = true;
           if (have_new_sample) syncVolumeSmth = volumeSmth;   // remember received sample
           else volumeSmth = syncVolumeSmth;                   // restore originally received sample for next run of dynamics limiter
           limitSampleDynamics();                              // run dynamics limiter on received volumeSmth, to hide jumps and hickups
+          if (have_new_sample && umHandle) umHandle->version++;
       }
 
       #if defined(MIC_LOGGER) || defined(MIC_SAMPLING_LOG) || defined(FFT_SAMPLING_LOG)
@@ -1407,6 +1881,10 @@ class AudioReactive : public Usermod {
       // reset FFT data
       memset(fftCalc, 0, sizeof(fftCalc)); 
       memset(fftAvg, 0, sizeof(fftAvg)); 
+      #ifdef UM_AUDIOREACTIVE_FIXEDPOINT
+      memset(fftCalcQ8, 0, sizeof(fftCalcQ8));
+      memset(fftAvgQ8, 0, sizeof(fftAvgQ8));
+      #endif
       memset(fftResult, 0, sizeof(fftResult)); 
       for(int i=(init?0:1); i<NUM_GEQ_CHANNELS; i+=2) fftResult[i] = 16; // make a tiny pattern
       inputLevel = 128;                                    // reset level slider to default
@@ -1579,6 +2057,7 @@ class AudioReactive : public Usermod {
         if (audioSyncEnabled && udpSyncConnected && (millis() - last_UDPTime < 2500)) {
             if (receivedFormat == 1) infoArr.add(F(" v1"));
             if (receivedFormat == 2) infoArr.add(F(" v2"));
+            if (receivedFormat == 3) infoArr.add(F(" v3"));
         }
 
         #if defined(WLED_DEBUG) || defined(SR_DEBUG)
@@ -1588,13 +2067,20 @@ class AudioReactive : public Usermod {
 
         infoArr = user.createNestedArray(F("FFT time"));
         infoArr.add(float(fftTime)/100.0f);
-        if ((fftTime/100) >= FFT_MIN_CYCLE) // FFT time over budget -> I2S buffer will overflow 
+        if ((fftTime/100) >= FFT_CYCLE_BUDGET) // FFT time over budget -> I2S buffer will overflow 
           infoArr.add("<b style=\"color:red;\">! ms</b>");
-        else if ((fftTime/80 + sampleTime/80) >= FFT_MIN_CYCLE) // FFT time >75% of budget -> risk of instability
+        else if ((fftTime/80 + sampleTime/80) >= FFT_CYCLE_BUDGET) // FFT time >75% of budget -> risk of instability
           infoArr.add("<b style=\"color:orange;\"> ms!</b>");
         else
           infoArr.add(" ms");
 
+        infoArr = user.createNestedArray(F("Sample overruns"));
+        infoArr.add(audioSource ? audioSource->getOverruns() : 0);
+
+        infoArr = user.createNestedArray(F("FFT result age"));
+        infoArr.add(fftFrameSeqRead ? millis() - fftFrameTime : 0);
+        infoArr.add(" ms");
+
         DEBUGSR_PRINTF("AR Sampling time: %5.2f ms\n", float(sampleTime)/100.0f);
         DEBUGSR_PRINTF("AR FFT time     : %5.2f ms\n", float(fftTime)/100.0f);
         #endif
@@ -1703,10 +2189,15 @@ class AudioReactive : public Usermod {
 
       JsonObject freqScale = top.createNestedObject("frequency");
       freqScale[F("scale")] = FFTScalingMode;
+      freqScale[F("mode")] = FFTAnalysisMode;
 
       JsonObject sync = top.createNestedObject("sync");
       sync[F("port")] = audioSyncPort;
       sync[F("mode")] = audioSyncEnabled;
+      sync[F("format")] = audioSyncFormat;
+      sync[F("compact")] = audioSyncCompact;
+      sync[F("group")] = audioSyncGroup;
+      sync[F("delay")] = audioSyncDelay;
     }
 
 
@@ -1760,9 +2251,15 @@ class AudioReactive : public Usermod {
       configComplete &= getJsonValue(top["dynamics"][F("fall")],  decayTime);
 
       configComplete &= getJsonValue(top["frequency"][F("scale")], FFTScalingMode);
+      configComplete &= getJsonValue(top["frequency"][F("mode")], FFTAnalysisMode);
 
       configComplete &= getJsonValue(top["sync"][F("port")], audioSyncPort);
       configComplete &= getJsonValue(top["sync"][F("mode")], audioSyncEnabled);
+      configComplete &= getJsonValue(top["sync"][F("format")], audioSyncFormat);
+      configComplete &= getJsonValue(top["sync"][F("compact")], audioSyncCompact);
+      configComplete &= getJsonValue(top["sync"][F("group")], audioSyncGroup);
+      configComplete &= getJsonValue(top["sync"][F("delay")], audioSyncDelay);
+      if (audioSyncGroup == 0) audioSyncGroup = 1;
 
       return configComplete;
     }
@@ -1802,10 +2299,19 @@ class AudioReactive : public Usermod {
       oappend(SET_F("addOption(dd,'Square Root (Energy)',3);"));
       oappend(SET_F("addOption(dd,'Logarithmic (Loudness)',1);"));
 
+      oappend(SET_F("dd=addDropdown('AudioReactive','frequency:mode');"));
+      oappend(SET_F("addOption(dd,'Full FFT',0);"));
+      oappend(SET_F("addOption(dd,'GEQ only (low CPU)',1);"));
+
       oappend(SET_F("dd=addDropdown('AudioReactive','sync:mode');"));
       oappend(SET_F("addOption(dd,'Off',0);"));
       oappend(SET_F("addOption(dd,'Send',1);"));
       oappend(SET_F("addOption(dd,'Receive',2);"));
+      oappend(SET_F("dd=addDropdown('AudioReactive','sync:format');"));
+      oappend(SET_F("addOption(dd,'v2 (0.14)',2);"));
+      oappend(SET_F("addOption(dd,'v3 (sequenced)',3);"));
+      oappend(SET_F("addInfo('AudioReactive:sync:group',1,'239.0.0.x');"));
+      oappend(SET_F("addInfo('AudioReactive:sync:delay',1,'ms <i>(v3 receive jitter buffer)</i>');"));
       oappend(SET_F("addInfo('AudioReactive:digitalmic:type',1,'<i>requires reboot!</i>');"));  // 0 is field type, 1 is actual field
       oappend(SET_F("addInfo('AudioReactive:digitalmic:pin[]',0,'<i>sd/data/dout</i>','I2S SD');"));
       oappend(SET_F("addInfo('AudioReactive:digitalmic:pin[]',1,'<i>ws/clk/lrck</i>','I2S WS');"));
@@ -1849,3 +2355,4 @@ const char AudioReactive::_analogmic[]  PROGMEM = "analogmic";
 const char AudioReactive::_digitalmic[] PROGMEM = "digitalmic";
 const char AudioReactive::UDP_SYNC_HEADER[]    PROGMEM = "00002"; // new sync header version, as format no longer compatible with previous structure
 const char AudioReactive::UDP_SYNC_HEADER_v1[] PROGMEM = "00001"; // old sync header version - need to add backwards-compatibility feature
+const char AudioReactive::UDP_SYNC_HEADER_v3[] PROGMEM = "00003"; // sequenced and time stamped sync
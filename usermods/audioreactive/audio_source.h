@@ -64,6 +64,9 @@
 #define I2S_SAMPLE_DOWNSCALE_TO_16BIT
 #endif
 
+// I2S DMA ring: I2S_DMA_BUF_COUNT buffers of blockSize samples each (8 x 128 = two FFT windows of 512 samples)
+#define I2S_DMA_BUF_COUNT 8
+
 /* There are several (confusing) options  in IDF 4.4.x:
  * I2S_CHANNEL_FMT_RIGHT_LEFT, I2S_CHANNEL_FMT_ALL_RIGHT and I2S_CHANNEL_FMT_ALL_LEFT stands for stereo mode, which means two channels will transport different data.
  * I2S_CHANNEL_FMT_ONLY_RIGHT and I2S_CHANNEL_FMT_ONLY_LEFT they are mono mode, both channels will only transport same data.
@@ -131,10 +134,13 @@ class AudioSource {
     virtual void deinitialize() = 0;
 
     /* getSamples
-       Read num_samples from the microphone, and store them in the provided
-       buffer
+       Read up to num_samples from the microphone, and store them in the provided
+       buffer. Waits at most timeout ticks, returns the number of samples stored
     */
-    virtual void getSamples(float *buffer, uint16_t num_samples) = 0;
+    virtual uint16_t getSamples(float *buffer, uint16_t num_samples, TickType_t timeout = portMAX_DELAY) = 0;
+
+    /* number of times samples were dropped because they were not read before the DMA ring was full */
+    uint32_t getOverruns(void) {return(_overruns);}
 
     /* check if the audio source driver was initialized successfully */
     virtual bool isInitialized(void) {return(_initialized);}
@@ -152,13 +158,17 @@ class AudioSource {
       _sampleRate(sampleRate),
       _blockSize(blockSize),
       _initialized(false),
-      _sampleScale(sampleScale)
+      _sampleScale(sampleScale),
+      _overruns(0),
+      _lastReadUs(0)
     {};
 
     SRate_t _sampleRate;            // Microphone sampling rate
     int _blockSize;                 // I2S block size
     bool _initialized;              // Gets set to true if initialization is successful
     float _sampleScale;             // pre-scaling factor for I2S samples
+    uint32_t _overruns;             // DMA ring overruns detected by getSamples()
+    int64_t _lastReadUs;            // end of last read
 };
 
 /* Basic I2S microphone source
@@ -177,14 +187,14 @@ class I2SSource : public AudioSource {
         .communication_format = i2s_comm_format_t(I2S_COMM_FORMAT_STAND_I2S),
         //.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL2,
-        .dma_buf_count = 8,
+        .dma_buf_count = I2S_DMA_BUF_COUNT,
         .dma_buf_len = _blockSize,
         .use_apll = 0,
         .bits_per_chan = I2S_data_size,
 #else
         .communication_format = i2s_comm_format_t(I2S_COMM_FORMAT_I2S | I2S_COMM_FORMAT_I2S_MSB),
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-        .dma_buf_count = 8,
+        .dma_buf_count = I2S_DMA_BUF_COUNT,
         .dma_buf_len = _blockSize,
         .use_apll = false
 #endif
@@ -314,39 +324,40 @@ class I2SSource : public AudioSource {
       if (_mclkPin != I2S_PIN_NO_CHANGE) pinManager.deallocatePin(_mclkPin, PinOwner::UM_Audioreactive);
     }
 
-    virtual void getSamples(float *buffer, uint16_t num_samples) {
-      if (_initialized) {
-        esp_err_t err;
-        size_t bytes_read = 0;        /* Counter variable to check if we actually got enough data */
-        I2S_datatype newSamples[num_samples]; /* Intermediary sample storage */
+    virtual uint16_t getSamples(float *buffer, uint16_t num_samples, TickType_t timeout = portMAX_DELAY) {
+      if (!_initialized) return 0;
+      // samples are read straight into the float buffer and converted in place (no intermediate copy):
+      // 32bit samples have the size of a float, 16bit samples occupy the lower half of the buffer
+      static_assert(sizeof(I2S_datatype) <= sizeof(float), "I2S samples must fit into float buffer");
+      I2S_datatype *raw = reinterpret_cast<I2S_datatype *>(buffer);
+      size_t bytes_read = 0;        /* Counter variable to check if we actually got enough data */
 
-        err = i2s_read(I2S_NUM_0, (void *)newSamples, sizeof(newSamples), &bytes_read, portMAX_DELAY);
-        if (err != ESP_OK) {
-          DEBUGSR_PRINTF("Failed to get samples: %d\n", err);
-          return;
-        }
+      // DMA ring holds I2S_DMA_BUF_COUNT blocks, if reads are further apart than the ring takes to fill samples were dropped
+      int64_t start = esp_timer_get_time();
+      if (_lastReadUs && start - _lastReadUs > int64_t(I2S_DMA_BUF_COUNT * _blockSize) * 1000000LL / _sampleRate) _overruns++;
 
-        // For correct operation, we need to read exactly sizeof(samples) bytes from i2s
-        if (bytes_read != sizeof(newSamples)) {
-          DEBUGSR_PRINTF("Failed to get enough samples: wanted: %d read: %d\n", sizeof(newSamples), bytes_read);
-          return;
-        }
+      esp_err_t err = i2s_read(I2S_NUM_0, (void *)raw, num_samples * sizeof(I2S_datatype), &bytes_read, timeout);
+      _lastReadUs = esp_timer_get_time();
+      if (err != ESP_OK) {
+        DEBUGSR_PRINTF("Failed to get samples: %d\n", err);
+        return 0;
+      }
+      uint16_t n = bytes_read / sizeof(I2S_datatype);
 
-        // Store samples in sample buffer and update DC offset
-        for (int i = 0; i < num_samples; i++) {
+      // perform postprocessing in sample order (needed for ADC samples, its correction depends on previous samples)
+      for (int i = 0; i < n; i++) raw[i] = postProcessSample(raw[i]);
 
-          newSamples[i] = postProcessSample(newSamples[i]);  // perform postprocessing (needed for ADC samples)
-          
-          float currSample = 0.0f;
+      // convert from the end, so 16bit samples are not overwritten before they are converted
+      for (int i = n - 1; i >= 0; i--) {
+        float currSample = 0.0f;
 #ifdef I2S_SAMPLE_DOWNSCALE_TO_16BIT
-              currSample = (float) newSamples[i] / 65536.0f;      // 32bit input -> 16bit; keeping lower 16bits as decimal places
+            currSample = (float) raw[i] / 65536.0f;      // 32bit input -> 16bit; keeping lower 16bits as decimal places
 #else
-              currSample = (float) newSamples[i];                 // 16bit input -> use as-is
+            currSample = (float) raw[i];                 // 16bit input -> use as-is
 #endif
-          buffer[i] = currSample;
-          buffer[i] *= _sampleScale;                              // scale samples
-        }
+        buffer[i] = currSample * _sampleScale;           // scale samples
       }
+      return n;
     }
 
   protected:
@@ -575,7 +586,7 @@ class I2SAdcSource : public I2SSource {
         .communication_format = i2s_comm_format_t(I2S_COMM_FORMAT_I2S | I2S_COMM_FORMAT_I2S_MSB),
 #endif
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-        .dma_buf_count = 8,
+        .dma_buf_count = I2S_DMA_BUF_COUNT,
         .dma_buf_len = _blockSize,
         .use_apll = false,
         .tx_desc_auto_clear = false,
@@ -687,10 +698,11 @@ class I2SAdcSource : public I2SSource {
     }
 
 
-    void getSamples(float *buffer, uint16_t num_samples) {
+    uint16_t getSamples(float *buffer, uint16_t num_samples, TickType_t timeout = portMAX_DELAY) {
       /* Enable ADC. This has to be enabled and disabled directly before and
        * after sampling, otherwise Wifi dies
        */
+      uint16_t n = 0;
       if (_initialized) {
         #if !defined(I2S_GRAB_ADC1_COMPLETELY)
           // old code - works for me without enable/disable, at least on ESP32.
@@ -698,22 +710,24 @@ class I2SAdcSource : public I2SSource {
           esp_err_t err = i2s_adc_enable(I2S_NUM_0);
           if (err != ESP_OK) {
             DEBUGSR_PRINTF("Failed to enable i2s adc: %d\n", err);
-            return;
+            return 0;
           }
         #endif
 
-        I2SSource::getSamples(buffer, num_samples);
+        n = I2SSource::getSamples(buffer, num_samples, timeout);
 
         #if !defined(I2S_GRAB_ADC1_COMPLETELY)
+          _lastReadUs = 0; // ADC does not sample while disabled, so there are no overruns between reads
           // old code - works for me without enable/disable, at least on ESP32.
           err = i2s_adc_disable(I2S_NUM_0);  //i2s_adc_disable() may cause crash with IDF 4.4 (https://github.com/espressif/arduino-esp32/issues/6832)
           //err = i2s_stop(I2S_NUM_0);
           if (err != ESP_OK) {
             DEBUGSR_PRINTF("Failed to disable i2s adc: %d\n", err);
-            return;
+            return n;
           }
         #endif
       }
+      return n;
     }
 
     void deinitialize() {
@@ -0,0 +1,84 @@
+#pragma once
+
+/*
+ * "V3" audio sync packet encoding and decoding, and receiver clock following
+ * No Arduino dependencies, also built on the host by the native unit tests in test/ (pio test -e native)
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+// "V3" audiosync struct - 40 Bytes, 32 Bytes with quantized GEQ channels (compact)
+// adds sequence number and sender time stamp so that receivers can reorder and play out frames at a steady rate
+struct audioSyncPacket_v3 {
+  char     header[6];     //  06 Bytes
+  uint16_t seq;           //  02 Bytes  - sequence number
+  uint32_t time;          //  04 Bytes  - sender time (millis()) when audio frame was produced
+  uint16_t sampleRaw;     //  02 Bytes  - 8.8 fixed point
+  uint16_t sampleSmth;    //  02 Bytes  - 8.8 fixed point
+  uint16_t majorPeak;     //  02 Bytes  - Hz
+  uint8_t  samplePeak;    //  01 Bytes
+  uint8_t  flags;         //  01 Bytes  - bit 0: fftResult is quantized to 4 bits (two channels per byte)
+  float    magnitude;     //  04 Bytes
+  uint8_t  fftResult[16]; //  16 Bytes  - only 8 are sent if quantized
+};
+#define AUDIOSYNC_V3_COMPACT 0x01
+#define AUDIOSYNC_V3_CHANNELS 16  // GEQ channels (NUM_GEQ_CHANNELS)
+#define AUDIOSYNC_JITTER_FRAMES 4 // size of receiver jitter buffer
+
+// received audio frame (decoded v3 packet) waiting in jitter buffer
+typedef struct AudioSyncFrame {
+  bool     valid;
+  uint16_t seq;
+  uint32_t time;
+  float    sampleRaw, sampleSmth, magnitude, majorPeak;
+  bool     samplePeak;
+  uint8_t  fftResult[AUDIOSYNC_V3_CHANNELS];
+} audioSyncFrame_t;
+
+// fills audio values of a v3 packet (header, seq and time are set by caller), returns number of bytes to send
+static size_t audioSyncEncode_v3(audioSyncPacket_v3 *p, int sampleRaw, float sampleSmth, bool samplePeak,
+                                 float magnitude, float majorPeak, const uint8_t *fftResult, bool compact) {
+  p->sampleRaw  = (sampleRaw < 0 ? 0 : sampleRaw > 255 ? 255 : sampleRaw) << 8;
+  p->sampleSmth = (sampleSmth < 0.0f ? 0.0f : sampleSmth > 255.99f ? 255.99f : sampleSmth) * 256.0f;
+  p->majorPeak  = majorPeak < 1.0f ? 1.0f : majorPeak > 11025.0f ? 11025.0f : majorPeak;
+  p->samplePeak = samplePeak ? 1:0;
+  p->magnitude  = magnitude;
+  size_t len = sizeof(audioSyncPacket_v3);
+  if (compact) {
+    p->flags |= AUDIOSYNC_V3_COMPACT;
+    for (int i = 0; i < AUDIOSYNC_V3_CHANNELS/2; i++) p->fftResult[i] = (fftResult[2*i] >> 4) | (fftResult[2*i+1] & 0xF0);
+    len -= AUDIOSYNC_V3_CHANNELS/2;
+  } else {
+    p->flags &= ~AUDIOSYNC_V3_COMPACT;
+    for (int i = 0; i < AUDIOSYNC_V3_CHANNELS; i++) p->fftResult[i] = fftResult[i] < 254 ? fftResult[i] : 254;
+  }
+  return len;
+}
+
+// decodes a received v3 packet into a jitter buffer frame (quantized channels are expanded to 0x00..0xFF)
+static void audioSyncDecode_v3(const audioSyncPacket_v3 *p, audioSyncFrame_t *f) {
+  f->valid      = true;
+  f->seq        = p->seq;
+  f->time       = p->time;
+  f->sampleRaw  = p->sampleRaw / 256.0f;
+  f->sampleSmth = p->sampleSmth / 256.0f;
+  f->samplePeak = p->samplePeak > 0;
+  f->magnitude  = p->magnitude;
+  f->majorPeak  = p->majorPeak;
+  if (p->flags & AUDIOSYNC_V3_COMPACT)
+    for (int i = 0; i < AUDIOSYNC_V3_CHANNELS; i++) {
+      uint8_t q = (i & 1) ? p->fftResult[i/2] >> 4 : p->fftResult[i/2] & 0x0F;
+      f->fftResult[i] = q << 4 | q;
+    }
+  else
+    memcpy(f->fftResult, p->fftResult, AUDIOSYNC_V3_CHANNELS);
+}
+
+// receiver clock offset (local time minus sender time) after a packet with transit offset was received:
+// takes faster transits immediately and follows clock drift slowly (1/64, rounded to nearest)
+static int32_t audioSyncFollowClock(int32_t clockOffset, int32_t offset) {
+  if (offset < clockOffset) return offset;
+  const int32_t drift = offset - clockOffset;
+  return clockOffset + (drift + (drift < 0 ? -32 : 32)) / 64;
+}
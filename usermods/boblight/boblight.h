@@ -12,6 +12,12 @@
   #define BOB_PORT 19333       // Default boblightd port
 #endif
 
+#ifndef BOB_RXBUF
+  #define BOB_RXBUF 256        // receive buffer, also the longest accepted command line
+#endif
+
+#define BOB_BINARY 0xB0        // starts a binary frame: 0xB0, first light (uint16 BE), light count (uint16 BE), RGB per light
+
 class BobLightUsermod : public Usermod {
   typedef struct _LIGHT {
     char lightname[5];
@@ -28,6 +34,13 @@ class BobLightUsermod : public Usermod {
     uint16_t numLights = 0;  // 16 + 9 + 16 + 9
     uint16_t top, bottom, left, right;  // will be filled in readFromConfig()
     uint16_t pct;
+    uint16_t sides[4] = {0};            // bottom, left, top, right as used by fillBobLights()
+
+    uint8_t *frame = nullptr;           // RGB of all lights, written to the strip once per received batch
+    int      dirtyLo = UINT16_MAX, dirtyHi = -1;
+    char     rxBuf[BOB_RXBUF];
+    uint16_t rxLen = 0;
+    uint16_t binStart = 0, binLeft = 0; // binary frame being received: next light, lights still to come
 
     WiFiClient bobClient;
     WiFiServer *bob;
@@ -171,6 +184,7 @@ class BobLightUsermod : public Usermod {
       }
 
       numLights = lightcount;
+      sides[0] = bottom; sides[1] = left; sides[2] = top; sides[3] = right;
 
       #if WLED_DEBUG
       DEBUG_PRINTLN(F("Fill light data: "));
@@ -181,8 +195,51 @@ class BobLightUsermod : public Usermod {
       #endif
     }
 
-    void BobSync()  { yield(); } // allow other tasks, should also be used to force pixel redraw (not with WLED)
-    void BobClear() { for (size_t i=0; i<numLights; i++) setRealtimePixel(i, 0, 0, 0, 0); }
+    // index of light b<n>, l<n>, t<n> or r<n> (order of fillBobLights()), -1 if unknown
+    int lightIndex(const char *name, size_t len) {
+      if (len < 2 || len > 4) return -1;
+      int n = 0;
+      for (size_t i = 1; i < len; i++) {
+        if (name[i] < '0' || name[i] > '9') return -1;
+        n = n*10 + name[i] - '0';
+      }
+      const int half = sides[0]/2;
+      int idx;
+      switch (name[0]) {
+        case 'b': if (n > sides[0]) return -1; idx = n <= half ? n-1 : half + sides[1] + sides[2] + sides[3] + n-half-1; break;
+        case 'l': if (n > sides[1]) return -1; idx = half + n-1;                       break;
+        case 't': if (n > sides[2]) return -1; idx = half + sides[1] + n-1;            break;
+        case 'r': if (n > sides[3]) return -1; idx = half + sides[1] + sides[2] + n-1; break;
+        default: return -1;
+      }
+      return (n > 0 && idx < numLights) ? idx : -1;
+    }
+
+    void setLight(int i, float r, float g, float b) {
+      uint8_t *c = frame + 3*i;
+      c[0] = 255.0f * constrain(r, 0.0f, 1.0f);
+      c[1] = 255.0f * constrain(g, 0.0f, 1.0f);
+      c[2] = 255.0f * constrain(b, 0.0f, 1.0f);
+      if (i < dirtyLo) dirtyLo = i;
+      if (i > dirtyHi) dirtyHi = i;
+    }
+
+    // writes all lights changed since last flush in one go
+    void flushFrame() {
+      if (dirtyHi < dirtyLo) return;
+      setRealtimePixels(dirtyLo, dirtyHi - dirtyLo + 1, frame + 3*dirtyLo, 3);
+      dirtyLo = UINT16_MAX; dirtyHi = -1;
+    }
+
+    void BobSync()  { flushFrame(); yield(); } // allow other tasks, should also be used to force pixel redraw (not with WLED)
+    void BobClear() {
+      if (!frame) return;
+      memset(frame, 0, 3*numLights);
+      dirtyLo = 0; dirtyHi = numLights - 1;
+      flushFrame();
+    }
+    bool handleCommand(char *input);
+    bool parseBob();
     void pollBob();
 
   public:
@@ -197,8 +254,11 @@ class BobLightUsermod : public Usermod {
         left = right = (uint16_t) roundf((float)totalLights *  9.0f / 50.0f);
       }
       lights = new light_t[totalLights];
-      if (lights) fillBobLights(bottom, left, top, right, float(pct)); // will fill numLights
-      else        enable(false);
+      if (frame) delete[] frame;
+      frame  = new uint8_t[3*totalLights];
+      if (lights && frame) fillBobLights(bottom, left, top, right, float(pct)); // will fill numLights
+      else                 enable(false);
+      dirtyLo = UINT16_MAX; dirtyHi = -1;
       initDone = true;
     }
 
@@ -367,6 +427,90 @@ class BobLightUsermod : public Usermod {
 const char BobLightUsermod::_name[]    PROGMEM = "BobLight";
 const char BobLightUsermod::_enabled[] PROGMEM = "enabled";
 
+// handles one command line, false if it is not understood
+bool BobLightUsermod::handleCommand(char *input) {
+  // DEBUG_PRINT("Client: "); DEBUG_PRINTLN(input); // may be to stressful on Serial
+  if (!strncmp_P(input, PSTR("hello"), 5)) {
+    DEBUG_PRINTLN(F("hello"));
+    bobClient.print(F("hello\n"));
+  } else if (!strncmp_P(input, PSTR("ping"), 4)) {
+    DEBUG_PRINTLN(F("ping 1"));
+    bobClient.print(F("ping 1\n"));
+  } else if (!strncmp_P(input, PSTR("get version"), 11)) {
+    DEBUG_PRINTLN(F("version 5"));
+    bobClient.print(F("version 5\n"));
+  } else if (!strncmp_P(input, PSTR("get binary"), 10)) { // WLED extension: client may send binary frames
+    bobClient.print(F("binary 1\n"));
+  } else if (!strncmp_P(input, PSTR("get lights"), 10)) {
+    char tmp[64];
+    String answer = "";
+    sprintf_P(tmp, PSTR("lights %d\n"), numLights);
+    DEBUG_PRINT(tmp);
+    answer.concat(tmp);
+    for (int i=0; i<numLights; i++) {
+      sprintf_P(tmp, PSTR("light %s scan %2.1f %2.1f %2.1f %2.1f\n"), lights[i].lightname, lights[i].vscan[0], lights[i].vscan[1], lights[i].hscan[0], lights[i].hscan[1]);
+      DEBUG_PRINT(tmp);
+      answer.concat(tmp);
+    }
+    bobClient.print(answer);
+  } else if (!strncmp_P(input, PSTR("set priority"), 12)) {
+    DEBUG_PRINTLN(F("set priority not implemented"));
+    // not implemented
+  } else if (!strncmp_P(input, PSTR("set light "), 10)) { // <id> <cmd in rgb, speed, interpolation> <value> ...
+    char *name = input + 10;
+    char *cmd  = strchr(name, ' ');
+    int light_id = cmd ? lightIndex(name, cmd - name) : -1;
+    if (light_id < 0) return true; // unknown light, ignore
+    cmd++;
+    if (!strncmp_P(cmd, PSTR("rgb "), 4)) {
+      char *v = cmd + 4;
+      float red   = strtof(v, &v);
+      float green = strtof(v, &v);
+      float blue  = strtof(v, &v);
+      setLight(light_id, red, green, blue);
+    } // currently no support for interpolation or speed, we just ignore this
+  } else if (!strncmp_P(input, PSTR("sync"), 4)) {
+    BobSync();
+  } else {
+    return false; // Client sent gibberish
+  }
+  return true;
+}
+
+// processes all complete commands and binary frames in rxBuf, false if the client has to be dropped
+bool BobLightUsermod::parseBob() {
+  size_t p = 0;
+  while (p < rxLen) {
+    if (binLeft) { // binary frame data goes directly to the strip
+      size_t n = MIN((size_t)(rxLen - p) / 3, (size_t)binLeft);
+      if (!n) break;
+      flushFrame(); // keep order with preceding text commands
+      setRealtimePixels(binStart, n, (const uint8_t*)rxBuf + p, 3);
+      binStart += n;
+      binLeft  -= n;
+      p += 3*n;
+      continue;
+    }
+    if ((uint8_t)rxBuf[p] == BOB_BINARY) {
+      if (rxLen - p < 5) break;
+      const uint8_t *h = (const uint8_t*)rxBuf + p;
+      binStart = (h[1] << 8) | h[2];
+      binLeft  = (h[3] << 8) | h[4];
+      p += 5;
+      continue;
+    }
+    char *eol = (char*)memchr(rxBuf + p, '\n', rxLen - p);
+    if (!eol) break;
+    *eol = 0;
+    if (eol > rxBuf + p && eol[-1] == '\r') eol[-1] = 0;
+    if (!handleCommand(rxBuf + p)) return false;
+    p = eol - rxBuf + 1;
+  }
+  rxLen -= p;
+  memmove(rxBuf, rxBuf + p, rxLen); // keep incomplete command for the next read
+  return rxLen < sizeof(rxBuf);     // a full buffer without a complete command is gibberish too
+}
+
 // main boblight handling (definition here prevents inlining)
 void BobLightUsermod::pollBob() {
   
@@ -376,6 +520,7 @@ void BobLightUsermod::pollBob() {
     if (!bobClient || !bobClient.connected()) {
       if (bobClient) bobClient.stop();
       bobClient = bob->available();
+      rxLen = binLeft = 0;
       DEBUG_PRINTLN(F("Boblight: Client connected."));
     }
     //no free/disconnected spot so reject
@@ -389,71 +534,21 @@ void BobLightUsermod::pollBob() {
   if (bobClient && bobClient.connected()) {
     realtimeLock(realtimeTimeoutMs); // lock strip as we have a client connected
 
-    //get data from the client
-    while (bobClient.available()) {
-      String input = bobClient.readStringUntil('\n');
-      // DEBUG_PRINT("Client: "); DEBUG_PRINTLN(input); // may be to stressful on Serial
-      if (input.startsWith(F("hello"))) {
-        DEBUG_PRINTLN(F("hello"));
-        bobClient.print(F("hello\n"));
-      } else if (input.startsWith(F("ping"))) {
-        DEBUG_PRINTLN(F("ping 1"));
-        bobClient.print(F("ping 1\n"));
-      } else if (input.startsWith(F("get version"))) {
-        DEBUG_PRINTLN(F("version 5"));
-        bobClient.print(F("version 5\n"));
-      } else if (input.startsWith(F("get lights"))) {
-        char tmp[64];
-        String answer = "";
-        sprintf_P(tmp, PSTR("lights %d\n"), numLights);
-        DEBUG_PRINT(tmp);
-        answer.concat(tmp);
-        for (int i=0; i<numLights; i++) {
-          sprintf_P(tmp, PSTR("light %s scan %2.1f %2.1f %2.1f %2.1f\n"), lights[i].lightname, lights[i].vscan[0], lights[i].vscan[1], lights[i].hscan[0], lights[i].hscan[1]);
-          DEBUG_PRINT(tmp);
-          answer.concat(tmp);
-        }
-        bobClient.print(answer);
-      } else if (input.startsWith(F("set priority"))) {
-        DEBUG_PRINTLN(F("set priority not implemented"));
-        // not implemented
-      } else if (input.startsWith(F("set light "))) { // <id> <cmd in rgb, speed, interpolation> <value> ...
-        input.remove(0,10);
-        String tmp = input.substring(0,input.indexOf(' '));
-        
-        int light_id = -1;
-        for (uint16_t i=0; i<numLights; i++) {
-          if (strncmp(lights[i].lightname, tmp.c_str(), 4) == 0) {
-            light_id = i;
-            break;
-          }
-        }
-        if (light_id == -1) return;
-
-        input.remove(0,input.indexOf(' ')+1);
-        if (input.startsWith(F("rgb "))) {
-          input.remove(0,4);
-          tmp = input.substring(0,input.indexOf(' '));
-          uint8_t red = (uint8_t)(255.0f*tmp.toFloat());
-          input.remove(0,input.indexOf(' ')+1);        // remove first float value
-          tmp = input.substring(0,input.indexOf(' '));
-          uint8_t green = (uint8_t)(255.0f*tmp.toFloat());
-          input.remove(0,input.indexOf(' ')+1);        // remove second float value
-          tmp = input.substring(0,input.indexOf(' '));
-          uint8_t blue = (uint8_t)(255.0f*tmp.toFloat());
-
-          //strip.setPixelColor(light_id, RGBW32(red, green, blue, 0));
-          setRealtimePixel(light_id, red, green, blue, 0);
-        } // currently no support for interpolation or speed, we just ignore this
-      } else if (input.startsWith(F("sync"))) {
-        BobSync();
-      } else {
-        // Client sent gibberish
+    //get data from the client, everything that arrived is parsed in place and written to the strip at once
+    int avail;
+    while ((avail = bobClient.available()) > 0) {
+      size_t n = bobClient.read((uint8_t*)rxBuf + rxLen, MIN((size_t)avail, sizeof(rxBuf) - rxLen));
+      if (!n) break;
+      rxLen += n;
+      if (!parseBob()) {
         DEBUG_PRINTLN(F("Client sent gibberish."));
         bobClient.stop();
         bobClient = bob->available();
+        rxLen = binLeft = 0;
         BobClear();
+        break;
       }
     }
+    flushFrame();
   }
 }
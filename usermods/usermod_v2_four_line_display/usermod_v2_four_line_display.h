@@ -76,6 +76,31 @@
 // Extra char (+1) for null
 #define LINE_BUFFER_SIZE            16+1
 
+// Drawing goes to a RAM copy of the display (8x8 pixel tiles), only tiles that changed are sent to the display.
+// On ESP32 the transfers run in a low priority task fed by a message queue, so a slow I2C bus does not delay
+// the main loop; define FLD_NO_TASK if other code uses the same I2C bus from the main loop without locking.
+// Elsewhere at most FLD_TILES_PER_LOOP tiles (~250us each at 400kHz I2C) are sent per loop pass.
+#if defined(ARDUINO_ARCH_ESP32) && !defined(FLD_NO_TASK)
+  #define FLD_USE_TASK
+#endif
+#ifndef FLD_TILES_PER_LOOP
+  #define FLD_TILES_PER_LOOP 8
+#endif
+#define FLD_MAX_RUN 16  // tiles sent in one transfer (one row of a 128 pixel wide display)
+
+typedef enum {
+  FLD_CMD_FLUSH = 0,    // send dirty tiles
+  FLD_CMD_POWERSAVE,
+  FLD_CMD_CONTRAST,
+  FLD_CMD_FLIP,
+  FLD_CMD_BUSCLOCK
+} DisplayCommand;
+
+typedef struct {
+  uint8_t  cmd;
+  uint32_t arg;
+} DisplayMessage;
+
 typedef enum {
   FLD_LINE_BRIGHTNESS = 0,
   FLD_LINE_EFFECT_SPEED,
@@ -105,6 +130,18 @@ class FourLineDisplayUsermod : public Usermod {
 
     // HW interface & configuration
     U8X8 *u8x8 = nullptr;           // pointer to U8X8 display object
+
+    // RAM copy of the display and tiles not yet sent (one bit per tile)
+    uint8_t *tiles = nullptr;
+    uint8_t *dirty = nullptr;
+    uint8_t tileCols = 0, tileRows = 0;
+    uint16_t dirtyCount = 0;
+    #ifdef FLD_USE_TASK
+    TaskHandle_t displayTask = nullptr;
+    QueueHandle_t displayQueue = nullptr;
+    SemaphoreHandle_t tileMutex = nullptr; // tiles[] and dirty[], held briefly
+    SemaphoreHandle_t busMutex = nullptr;  // u8x8 (display bus), held during transfers
+    #endif
     #ifndef FLD_SPI_DEFAULT
     int8_t ioPin[5] = {FLD_PIN_SCL, FLD_PIN_SDA, -1, -1, -1};        // I2C pins: SCL, SDA
     uint32_t ioFrequency = 400000;  // in Hz (minimum is 100000, baseline is 400000 and maximum should be 3400000)
@@ -232,6 +269,23 @@ class FourLineDisplayUsermod : public Usermod {
       DEBUG_PRINTLN(F("Starting display."));
       /*if (!(type == SSD1306_SPI || type == SSD1306_SPI64))*/ u8x8->setBusClock(ioFrequency);  // can be used for SPI too
       u8x8->begin();
+      if (!allocateTiles()) {
+        DEBUG_PRINTLN(F("Display buffer allocation failed."));
+        delete u8x8; u8x8 = nullptr;
+        pinManager.deallocateMultiplePins((const uint8_t*)ioPin, (type == SSD1306_SPI || type == SSD1306_SPI64) ? 5 : 2, po);
+        type = NONE;
+        return;
+      }
+      #ifdef FLD_USE_TASK
+      if (!displayTask) {
+        if (!tileMutex)    tileMutex    = xSemaphoreCreateMutex();
+        if (!busMutex)     busMutex     = xSemaphoreCreateMutex();
+        if (!displayQueue) displayQueue = xQueueCreate(8, sizeof(DisplayMessage));
+        if (tileMutex && busMutex && displayQueue)
+          xTaskCreatePinnedToCore(displayTaskCode, "4LineDisplay", 2048, this, 1, &displayTask, 0); // low priority, core of network stack
+        DEBUG_PRINTF("Display task %s.\n", displayTask ? "started" : "failed");
+      }
+      #endif
       setFlipMode(flip);
       setContrast(contrast); //Contrast setup will help to preserve OLED lifetime. In case OLED need to be brighter increase number up to 255
       setPowerSave(0);
@@ -246,51 +300,189 @@ class FourLineDisplayUsermod : public Usermod {
      * Da loop.
      */
     void loop() {
-      if (!enabled || millis() - lastUpdate < (clockMode?1000:refreshRate) || strip.isUpdating()) return;
+      if (!enabled || type == NONE) return;
+      #ifndef FLD_USE_TASK
+      if (dirtyCount && !strip.isUpdating()) flushTiles(FLD_TILES_PER_LOOP); // rest is sent in following passes
+      #endif
+      if (millis() - lastUpdate < (clockMode?1000:refreshRate)) return;
       lastUpdate = millis();
 
       redraw(false);
+      sendCommand(FLD_CMD_FLUSH);
+    }
+
+    /**
+     * Display RAM copy (tiles of 8 bytes, one per column of 8 pixels, row major)
+     */
+    bool allocateTiles() {
+      uint8_t cols = u8x8->getCols(), rows = u8x8->getRows();
+      lockTiles();
+      if (!tiles || cols != tileCols || rows != tileRows) {
+        free(tiles); free(dirty);
+        tiles = (uint8_t*) malloc(cols * rows * 8);
+        dirty = (uint8_t*) malloc((cols * rows + 7) / 8);
+        if (!tiles || !dirty) { free(tiles); free(dirty); tiles = dirty = nullptr; cols = rows = 0; }
+        tileCols = cols;
+        tileRows = rows;
+      }
+      if (tiles) markAllDirty(0); // display RAM content is unknown after begin()
+      unlockTiles();
+      return tiles;
+    }
+    // needs tiles locked
+    void markAllDirty(int fill = -1) {
+      if (fill >= 0) memset(tiles, fill, tileCols * tileRows * 8);
+      memset(dirty, 0xFF, (tileCols * tileRows + 7) / 8);
+      dirtyCount = tileCols * tileRows;
+    }
+    void putTile(uint8_t col, uint8_t row, const uint8_t *tile) {
+      if (col >= tileCols || row >= tileRows) return;
+      uint16_t i = row * tileCols + col;
+      uint8_t *t = tiles + i * 8;
+      lockTiles();
+      if (memcmp(t, tile, 8)) {
+        memcpy(t, tile, 8);
+        if (!(dirty[i>>3] & (1 << (i&7)))) { dirty[i>>3] |= 1 << (i&7); dirtyCount++; }
+      }
+      unlockTiles();
+    }
+    // sends up to maxTiles dirty tiles (adjacent ones in one transfer), returns true if none are left
+    bool flushTiles(uint16_t maxTiles) {
+      uint8_t buf[FLD_MAX_RUN*8];
+      while (maxTiles) {
+        lockTiles();
+        uint16_t n = tileCols * tileRows, i = 0;
+        if (dirtyCount) while (i < n && !(dirty[i>>3] & (1 << (i&7)))) i++;
+        if (!dirtyCount || i >= n) { dirtyCount = 0; unlockTiles(); return true; }
+        uint8_t col = i % tileCols, row = i / tileCols, len = 0;
+        while (len < FLD_MAX_RUN && len < maxTiles && col + len < tileCols && (dirty[i>>3] & (1 << (i&7)))) {
+          memcpy(buf + len*8, tiles + i*8, 8);
+          dirty[i>>3] &= ~(1 << (i&7));
+          dirtyCount--;
+          len++; i++;
+        }
+        unlockTiles();
+        lockBus();
+        if (u8x8) u8x8->drawTile(col, row, len, buf);
+        unlockBus();
+        maxTiles -= len;
+      }
+      return !dirtyCount;
+    }
+    #ifdef FLD_USE_TASK
+    inline void lockTiles()   { if (tileMutex) xSemaphoreTake(tileMutex, portMAX_DELAY); }
+    inline void unlockTiles() { if (tileMutex) xSemaphoreGive(tileMutex); }
+    inline void lockBus()     { if (busMutex) xSemaphoreTake(busMutex, portMAX_DELAY); }
+    inline void unlockBus()   { if (busMutex) xSemaphoreGive(busMutex); }
+    #else
+    inline void lockTiles()   {}
+    inline void unlockTiles() {}
+    inline void lockBus()     {}
+    inline void unlockBus()   {}
+    #endif
+
+    /**
+     * Display bus operations: queued for the display task on ESP32, executed right away elsewhere
+     */
+    void sendCommand(uint8_t cmd, uint32_t arg = 0) {
+      if (type == NONE || !enabled) return;
+      #ifdef FLD_USE_TASK
+      if (displayQueue) {
+        DisplayMessage msg = {cmd, arg};
+        if (cmd == FLD_CMD_FLUSH) xQueueSend(displayQueue, &msg, 0); // dirty tiles are also flushed periodically
+        else                      xQueueSend(displayQueue, &msg, pdMS_TO_TICKS(50));
+        return;
+      }
+      #endif
+      execCommand(cmd, arg);
+    }
+    void execCommand(uint8_t cmd, uint32_t arg) {
+      if (cmd == FLD_CMD_FLUSH) {
+        #ifdef FLD_USE_TASK
+        flushTiles(UINT16_MAX);
+        #endif
+        return;
+      }
+      lockBus();
+      if (u8x8) switch (cmd) {
+        case FLD_CMD_POWERSAVE: u8x8->setPowerSave(arg); break;
+        case FLD_CMD_CONTRAST:  u8x8->setContrast(arg); break;
+        case FLD_CMD_FLIP:      u8x8->setFlipMode(arg); break;
+        case FLD_CMD_BUSCLOCK:  u8x8->setBusClock(arg); break;
+      }
+      unlockBus();
+      if (cmd == FLD_CMD_FLIP && tiles) { lockTiles(); markAllDirty(); unlockTiles(); } // content has to be re-sent
+    }
+    #ifdef FLD_USE_TASK
+    static void displayTaskCode(void *parameter) {
+      FourLineDisplayUsermod *um = (FourLineDisplayUsermod*) parameter;
+      DisplayMessage msg;
+      for (;;) {
+        if (xQueueReceive(um->displayQueue, &msg, pdMS_TO_TICKS(50)) == pdTRUE) um->execCommand(msg.cmd, msg.arg);
+        else if (um->dirtyCount) um->flushTiles(UINT16_MAX); // drawing outside of loop() (overlays from other usermods)
+      }
+    }
+    #endif
+
+    /**
+     * Glyph rendering into the RAM copy (u8x8 font: first and last code, width and height in tiles, glyph tiles)
+     */
+    // expands 4 bits of a tile column to 8 (vertical double size)
+    static uint8_t stretch(uint8_t b) {
+      uint8_t r = 0;
+      for (uint8_t i = 0; i < 4; i++) if (b & (1 << i)) r |= 3 << (2*i);
+      return r;
+    }
+    void renderGlyph(uint8_t col, uint8_t row, uint8_t glyph, const uint8_t *font, uint8_t scaleX, uint8_t scaleY) {
+      uint8_t first = pgm_read_byte(font), last = pgm_read_byte(font+1);
+      uint8_t tw = pgm_read_byte(font+2), th = pgm_read_byte(font+3);
+      uint8_t src[8], tile[8];
+      for (uint8_t ty = 0; ty < th; ty++) for (uint8_t tx = 0; tx < tw; tx++) {
+        if (glyph < first || glyph > last) memset(src, 0, 8);
+        else memcpy_P(src, font + 4 + ((glyph - first) * tw * th + ty * tw + tx) * 8, 8);
+        for (uint8_t sy = 0; sy < scaleY; sy++) for (uint8_t sx = 0; sx < scaleX; sx++) {
+          for (uint8_t x = 0; x < 8; x++) {
+            uint8_t b = src[scaleX == 2 ? (sx*8 + x) / 2 : x];
+            tile[x] = scaleY == 2 ? stretch(sy ? b >> 4 : b) : b;
+          }
+          putTile(col + tx*scaleX + sx, row + ty*scaleY + sy, tile);
+        }
+      }
     }
 
     /**
      * Wrappers for screen drawing
      */
     void setFlipMode(uint8_t mode) {
-      if (type == NONE || !enabled) return;
-      u8x8->setFlipMode(mode);
+      sendCommand(FLD_CMD_FLIP, mode);
     }
     void setContrast(uint8_t contrast) {
-      if (type == NONE || !enabled) return;
-      u8x8->setContrast(contrast);
+      sendCommand(FLD_CMD_CONTRAST, contrast);
     }
     void drawString(uint8_t col, uint8_t row, const char *string, bool ignoreLH=false) {
       if (type == NONE || !enabled) return;
-      u8x8->setFont(u8x8_font_chroma48medium8_r);
-      if (!ignoreLH && lineHeight==2) u8x8->draw1x2String(col, row, string);
-      else                            u8x8->drawString(col, row, string);
+      for (; *string && col < tileCols; string++, col++)
+        renderGlyph(col, row, *string, u8x8_font_chroma48medium8_r, 1, (!ignoreLH && lineHeight==2) ? 2 : 1);
     }
     void draw2x2String(uint8_t col, uint8_t row, const char *string) {
       if (type == NONE || !enabled) return;
-      u8x8->setFont(u8x8_font_chroma48medium8_r);
-      u8x8->draw2x2String(col, row, string);
+      for (; *string && col < tileCols; string++, col += 2) renderGlyph(col, row, *string, u8x8_font_chroma48medium8_r, 2, 2);
     }
     void drawGlyph(uint8_t col, uint8_t row, char glyph, const uint8_t *font, bool ignoreLH=false) {
       if (type == NONE || !enabled) return;
-      u8x8->setFont(font);
-      if (!ignoreLH && lineHeight==2) u8x8->draw1x2Glyph(col, row, glyph);
-      else                            u8x8->drawGlyph(col, row, glyph);
+      renderGlyph(col, row, glyph, font, 1, (!ignoreLH && lineHeight==2) ? 2 : 1);
     }
     uint8_t getCols() {
       if (type==NONE || !enabled) return 0;
-      return u8x8->getCols();
+      return tileCols;
     }
     void clear() {
       if (type == NONE || !enabled) return;
-      u8x8->clear();
+      static const uint8_t blank[8] = {0};
+      for (uint8_t row = 0; row < tileRows; row++) for (uint8_t col = 0; col < tileCols; col++) putTile(col, row, blank);
     }
     void setPowerSave(uint8_t save) {
-      if (type == NONE || !enabled) return;
-      u8x8->setPowerSave(save);
+      sendCommand(FLD_CMD_POWERSAVE, save);
     }
 
     void center(String &line, uint8_t width) {
@@ -496,6 +688,7 @@ class FourLineDisplayUsermod : public Usermod {
         drawString(0, 2*lineHeight, buf.c_str());
       }
       overlayUntil = millis() + showHowLong;
+      sendCommand(FLD_CMD_FLUSH);
     }
 
     void setLineType(byte lT) {
@@ -694,7 +887,8 @@ class FourLineDisplayUsermod : public Usermod {
         bool pinsChanged = false;
         for (byte i=0; i<5; i++) if (ioPin[i] != newPin[i]) { pinsChanged = true; break; }
         if (pinsChanged || type!=newType) {
-          if (type != NONE) delete u8x8;
+          lockBus(); // display task must not use the display while it is re-created
+          if (type != NONE) { delete u8x8; u8x8 = nullptr; }
           PinOwner po = PinOwner::UM_FourLineDisplay;
           bool isSPI = (type == SSD1306_SPI || type == SSD1306_SPI64);
           if (isSPI) {
@@ -707,12 +901,14 @@ class FourLineDisplayUsermod : public Usermod {
           for (byte i=0; i<5; i++) ioPin[i] = newPin[i];
           if (ioPin[0]<0 || ioPin[1]<0) { // data & clock must be > -1
             type = NONE;
+            unlockBus();
             return true;
           } else type = newType;
           setup();
+          unlockBus();
           needsRedraw |= true;
         }
-        if (!(type == SSD1306_SPI || type == SSD1306_SPI64)) u8x8->setBusClock(ioFrequency); // can be used for SPI too
+        if (!(type == SSD1306_SPI || type == SSD1306_SPI64)) sendCommand(FLD_CMD_BUSCLOCK, ioFrequency); // can be used for SPI too
         setContrast(contrast);
         setFlipMode(flip);
         if (needsRedraw && !wakeDisplay()) redraw(true);
@@ -49,6 +49,27 @@
 #define ENCODER_MAX_DELAY_MS 8  // 8 milliseconds => max 120 change impulses in 1 second, for full turn of a 30/30 encoder (4 changes per segment, 30 segments for one turn)
 #endif
 
+#ifndef ENCODER_ACCEL_MS        // steps closer than this speed up brightness, speed, intensity, color & custom changes (x2, x4 below half of it)
+#define ENCODER_ACCEL_MS 40
+#endif
+
+// encoder steps are counted in the background (GPIO pins only, PCF8574 pins are polled):
+// ESP32 uses a PCNT hardware counter, other MCUs an interrupt on DT pin
+// both count both edges of DT against the level of CLK, so contact bounce cancels itself out
+#define ENC_BACKEND_POLL 0
+#define ENC_BACKEND_ISR  1
+#define ENC_BACKEND_PCNT 2
+#if defined(ARDUINO_ARCH_ESP32) && !defined(ENCODER_NO_PCNT)
+  #include "soc/soc_caps.h"
+  #if SOC_PCNT_SUPPORTED
+    #include "driver/pcnt.h"
+    #define ENCODER_USE_PCNT
+    #ifndef ENCODER_PCNT_UNIT
+      #define ENCODER_PCNT_UNIT PCNT_UNIT_0
+    #endif
+  #endif
+#endif
+
 #ifndef USERMOD_USE_PCF8574
   #undef USE_PCF8574
   #define USE_PCF8574 false
@@ -147,13 +168,30 @@ static void IRAM_ATTR i2cReadingISR() {
   }
 }
 
+// encoder half steps counted by encoderISR() (positive: increase), 2 per step
+static volatile int16_t encCount = 0;
+static volatile bool    encLevelA = false;
+static int8_t encPinA = -1, encPinB = -1;
+
+static void IRAM_ATTR encoderISR() {
+  bool a = digitalRead(encPinA);
+  if (a == encLevelA) return; // missed an edge while bouncing, net change is 0
+  encLevelA = a;
+  if (a != (bool)digitalRead(encPinB)) encCount++; else encCount--;
+}
+
 
 class RotaryEncoderUIUsermod : public Usermod {
 
   private:
 
-    const int8_t fadeAmount;    // Amount to change every step (brightness)
+    int16_t fadeAmount;         // Amount to change every step (brightness), multiplied by steps and acceleration
     unsigned long loopTime;
+    unsigned long lastTurnTime; // time of last encoder steps (acceleration)
+    uint8_t encBackend;         // ENC_BACKEND_*
+    int16_t pcntLast;           // PCNT counter value already consumed
+    bool    deferUpdate;        // coalesce lampUdated() calls of several steps
+    bool    updatePending;
 
     unsigned long buttonPressedTime;
     unsigned long buttonWaitTime;
@@ -229,6 +267,18 @@ class RotaryEncoderUIUsermod : public Usermod {
      */
     byte readPin(uint8_t pin);
 
+    /**
+     * startCounter()/stopCounter() - background step counting, readSteps() - steps since last call
+     */
+    void startCounter();
+    void stopCounter();
+    int16_t readSteps();
+
+    /**
+     * changeValue() - change the value selected by select_state (steps: number of steps, >0: increase)
+     */
+    void changeValue(int16_t steps, uint8_t accel);
+
     /**
      * Sort the modes and palettes to the index arrays
      * modes_alpha_indexes and palettes_alpha_indexes.
@@ -251,6 +301,11 @@ class RotaryEncoderUIUsermod : public Usermod {
 
     RotaryEncoderUIUsermod()
       : fadeAmount(5)
+      , lastTurnTime(0)
+      , encBackend(ENC_BACKEND_POLL)
+      , pcntLast(0)
+      , deferUpdate(false)
+      , updatePending(false)
       , buttonPressedTime(0)
       , buttonWaitTime(0)
       , buttonPressedBefore(false)
@@ -387,6 +442,116 @@ byte RotaryEncoderUIUsermod::readPin(uint8_t pin) {
   }
 }
 
+void RotaryEncoderUIUsermod::startCounter() {
+  encBackend = ENC_BACKEND_POLL;
+  if (usePcf8574) return;
+#ifdef ENCODER_USE_PCNT
+  pcnt_config_t cfg = {};
+  cfg.pulse_gpio_num = pinA;
+  cfg.ctrl_gpio_num  = pinB;
+  cfg.channel        = PCNT_CHANNEL_0;
+  cfg.unit           = ENCODER_PCNT_UNIT;
+  cfg.pos_mode       = PCNT_COUNT_INC;    // DT rising while CLK low: increase
+  cfg.neg_mode       = PCNT_COUNT_DEC;
+  cfg.lctrl_mode     = PCNT_MODE_KEEP;
+  cfg.hctrl_mode     = PCNT_MODE_REVERSE;
+  cfg.counter_h_lim  = INT16_MAX;
+  cfg.counter_l_lim  = INT16_MIN;
+  if (pcnt_unit_config(&cfg) == ESP_OK) {
+    pcnt_set_filter_value(ENCODER_PCNT_UNIT, 1023); // ignore glitches shorter than ~12us
+    pcnt_filter_enable(ENCODER_PCNT_UNIT);
+    pcnt_counter_pause(ENCODER_PCNT_UNIT);
+    pcnt_counter_clear(ENCODER_PCNT_UNIT);
+    pcnt_counter_resume(ENCODER_PCNT_UNIT);
+    pcntLast = 0;
+    encBackend = ENC_BACKEND_PCNT;
+    DEBUG_PRINTLN(F("Rotary encoder uses PCNT."));
+    return;
+  }
+#endif
+  encPinA = pinA;
+  encPinB = pinB;
+  encLevelA = digitalRead(pinA);
+  encCount = 0;
+  attachInterrupt(digitalPinToInterrupt(pinA), encoderISR, CHANGE);
+  encBackend = ENC_BACKEND_ISR;
+}
+
+void RotaryEncoderUIUsermod::stopCounter() {
+#ifdef ENCODER_USE_PCNT
+  if (encBackend == ENC_BACKEND_PCNT) pcnt_counter_pause(ENCODER_PCNT_UNIT);
+#endif
+  if (encBackend == ENC_BACKEND_ISR) detachInterrupt(digitalPinToInterrupt(pinA));
+  encBackend = ENC_BACKEND_POLL;
+}
+
+int16_t RotaryEncoderUIUsermod::readSteps() {
+  int16_t steps = 0;
+  switch (encBackend) {
+#ifdef ENCODER_USE_PCNT
+    case ENC_BACKEND_PCNT: {
+      int16_t count = 0;
+      pcnt_get_counter_value(ENCODER_PCNT_UNIT, &count);
+      steps = (count - pcntLast) / 2; // a half step stays for next time
+      pcntLast += steps * 2;
+      if (abs(pcntLast) > 16000) { pcnt_counter_clear(ENCODER_PCNT_UNIT); pcntLast = 0; } // long before h_lim/l_lim
+      break;
+    }
+#endif
+    case ENC_BACKEND_ISR:
+      noInterrupts();
+      steps = encCount / 2;
+      encCount -= steps * 2;
+      interrupts();
+      break;
+    default: // polled every 2ms
+      Enc_A = readPin(pinA); // Read encoder pins
+      Enc_B = readPin(pinB);
+      if ((Enc_A) && (!Enc_A_prev)) { // A has gone from low to high
+        steps = (Enc_B == LOW) ? 1 : -1; //changes to LOW so that then encoder registers a change at the very end of a pulse
+      }
+      Enc_A_prev = Enc_A;     // Store value of A for next time
+      break;
+  }
+  return steps;
+}
+
+// applies all steps accumulated since the last loop at once; values are changed by a multiple of fadeAmount,
+// lists (effects, palettes, presets) move step by step, interfaces are updated once
+void RotaryEncoderUIUsermod::changeValue(int16_t steps, uint8_t accel) {
+  bool increase = steps > 0;
+  uint16_t n = abs(steps);
+  switch (select_state) {
+    case 3: case 4: case 8: break;          // lists
+    default:
+      fadeAmount = min((unsigned)(5 * n * accel), 255U); // sliders & colors
+      n = 1;
+      break;
+  }
+  deferUpdate = true;
+  updatePending = false;
+  for (uint16_t i = 0; i < n; i++) {
+    switch(select_state) {
+      case  0: changeBrightness(increase);      break;
+      case  1: changeEffectSpeed(increase);     break;
+      case  2: changeEffectIntensity(increase); break;
+      case  3: changePalette(increase);         break;
+      case  4: changeEffect(increase);          break;
+      case  5: changeHue(increase);             break;
+      case  6: changeSat(increase);             break;
+      case  7: changeCCT(increase);             break;
+      case  8: changePreset(increase);          break;
+      case  9: changeCustom(1,increase);        break;
+      case 10: changeCustom(2,increase);        break;
+      case 11: changeCustom(3,increase);        break;
+    }
+    if (!updatePending) break; // input was used to wake the display (or nothing to change)
+  }
+  deferUpdate = false;
+  fadeAmount = 5;
+  if (updatePending) lampUdated();
+}
+
 /**
  * Sort the modes and palettes to the index arrays
  * modes_alpha_indexes and palettes_alpha_indexes.
@@ -394,7 +559,8 @@ byte RotaryEncoderUIUsermod::readPin(uint8_t pin) {
 void RotaryEncoderUIUsermod::sortModesAndPalettes() {
   DEBUG_PRINTLN(F("Sorting modes and palettes."));
   //modes_qstrings = re_findModeStrings(JSON_mode_names, strip.getModeCount());
-  modes_qstrings = strip.getModeDataSrc();
+  modes_qstrings = (const char **)malloc(sizeof(const char *) * strip.getModeCount());
+  for (int i = 0; i < strip.getModeCount(); i++) modes_qstrings[i] = strip.getModeData(i);
   modes_alpha_indexes = re_initIndexArray(strip.getModeCount());
   re_sortModes(modes_qstrings, modes_alpha_indexes, strip.getModeCount(), MODE_SORT_SKIP_COUNT);
 
@@ -535,6 +701,7 @@ void RotaryEncoderUIUsermod::setup()
   Enc_A = readPin(pinA); // Read encoder pins
   Enc_B = readPin(pinB);
   Enc_A_prev = Enc_A;
+  startCounter();
 }
 
 /*
@@ -635,48 +802,22 @@ void RotaryEncoderUIUsermod::loop()
       if (changedState) select_state = newState;
     }
 
-    Enc_A = readPin(pinA); // Read encoder pins
-    Enc_B = readPin(pinB);
-    if ((Enc_A) && (!Enc_A_prev))
-    { // A has gone from high to low
-      if (Enc_B == LOW)    //changes to LOW so that then encoder registers a change at the very end of a pulse
-      { // B is high so clockwise
-        switch(select_state) {
-          case  0: changeBrightness(true);      break;
-          case  1: changeEffectSpeed(true);     break;
-          case  2: changeEffectIntensity(true); break;
-          case  3: changePalette(true);         break;
-          case  4: changeEffect(true);          break;
-          case  5: changeHue(true);             break;
-          case  6: changeSat(true);             break;
-          case  7: changeCCT(true);             break;
-          case  8: changePreset(true);          break;
-          case  9: changeCustom(1,true);        break;
-          case 10: changeCustom(2,true);        break;
-          case 11: changeCustom(3,true);        break;
-        }
-      }
-      else if (Enc_B == HIGH)
-      { // B is low so counter-clockwise
-        switch(select_state) {
-          case  0: changeBrightness(false);      break;
-          case  1: changeEffectSpeed(false);     break;
-          case  2: changeEffectIntensity(false); break;
-          case  3: changePalette(false);         break;
-          case  4: changeEffect(false);          break;
-          case  5: changeHue(false);             break;
-          case  6: changeSat(false);             break;
-          case  7: changeCCT(false);             break;
-          case  8: changePreset(false);          break;
-          case  9: changeCustom(1,false);        break;
-          case 10: changeCustom(2,false);        break;
-          case 11: changeCustom(3,false);        break;
-        }
-      }
+    if (encBackend == ENC_BACKEND_POLL) {
+      int16_t steps = readSteps();
+      if (steps) changeValue(steps, 1);
     }
-    Enc_A_prev = Enc_A;     // Store value of A for next time
     loopTime = currentTime; // Updates loopTime
   }
+
+  // steps counted in the background are applied at once (one state update per loop)
+  if (encBackend != ENC_BACKEND_POLL) {
+    int16_t steps = readSteps();
+    if (steps) {
+      uint16_t interval = min(currentTime - lastTurnTime, 60000UL) / abs(steps); // ms per step
+      changeValue(steps, interval < ENCODER_ACCEL_MS/2 ? 4 : interval < ENCODER_ACCEL_MS ? 2 : 1);
+      lastTurnTime = currentTime;
+    }
+  }
 }
 
 void RotaryEncoderUIUsermod::displayNetworkInfo() {
@@ -725,6 +866,7 @@ bool RotaryEncoderUIUsermod::changeState(const char *stateName, byte markedLine,
 }
 
 void RotaryEncoderUIUsermod::lampUdated() {
+  if (deferUpdate) { updatePending = true; return; }
   //call for notifier -> 0: init 1: direct change 2: button 3: notification 4: nightlight 5: other (No notification)
   // 6: fx changed 7: hue 8: preset cycle 9: blynk 10: alexa
   //setValuesFromFirstSelectedSeg(); //to make transition work on main segment (should no longer be required)
@@ -1143,6 +1285,7 @@ bool RotaryEncoderUIUsermod::readFromConfig(JsonObject &root) {
         }
         pinIRQ = newIRQpin<100 ? newIRQpin : -1; // ignore PCF8574 pins
       } else {
+        stopCounter();
         pinManager.deallocatePin(pinA, PinOwner::UM_RotaryEncoderUI);
         pinManager.deallocatePin(pinB, PinOwner::UM_RotaryEncoderUI);
         pinManager.deallocatePin(pinC, PinOwner::UM_RotaryEncoderUI);
@@ -30,6 +30,37 @@
 
 #define IBN 5100
 
+// Random numbers of effects come from the stream of the segment being rendered (Segment::rng, seeded when the effect
+// starts, see Segment::resetIfRequired()) instead of the global FastLED state, so an effect's "randomness" is the same
+// on every node with the same seed and does not depend on other segments. Effects keep using the FastLED/Arduino names.
+// xorshift16 (7,9,8) has a 16 bit state like FastLED's generator, so effects saving and restoring the seed still work.
+static uint16_t fxRngGlobal = 1; // helpers called outside of effect functions
+
+static inline uint16_t &fxRngState() {
+  uint16_t *s = strip._renderCtx[RENDER_CTX()].rng;
+  return s ? *s : fxRngGlobal;
+}
+static inline uint16_t fx_random16() {
+  uint16_t &s = fxRngState();
+  uint16_t x = s ? s : 1; // 0 is no xorshift state
+  x ^= x << 7; x ^= x >> 9; x ^= x << 8;
+  return s = x;
+}
+static inline uint16_t fx_random16(uint16_t lim)               { return (uint32_t(fx_random16()) * lim) >> 16; }
+static inline uint16_t fx_random16(uint16_t min, uint16_t lim) { return min + fx_random16(lim - min); }
+static inline uint8_t  fx_random8()                            { uint16_t r = fx_random16(); return uint8_t(r ^ (r >> 8)); }
+static inline uint8_t  fx_random8(uint8_t lim)                 { return (fx_random8() * lim) >> 8; }
+static inline uint8_t  fx_random8(uint8_t min, uint8_t lim)    { return min + fx_random8(lim - min); }
+static inline long     fx_random(long howbig)                  { return howbig > 0 ? ((uint32_t(fx_random16()) << 16) | fx_random16()) % uint32_t(howbig) : 0; }
+static inline long     fx_random(long howsmall, long howbig)   { return howsmall < howbig ? howsmall + fx_random(howbig - howsmall) : howsmall; }
+static inline uint16_t fx_random16_get_seed()                  { return fxRngState(); }
+static inline void     fx_random16_set_seed(uint16_t seed)     { fxRngState() = seed; }
+#define random8              fx_random8
+#define random16             fx_random16
+#define random               fx_random
+#define random16_get_seed    fx_random16_get_seed
+#define random16_set_seed    fx_random16_set_seed
+
 // paletteBlend: 0 - wrap when moving, 1 - always wrap, 2 - never wrap, 3 - none (undefined)
 #define PALETTE_SOLID_WRAP   (strip.paletteBlend == 1 || strip.paletteBlend == 3)
 #define PALETTE_MOVING_WRAP !(strip.paletteBlend == 2 || (strip.paletteBlend == 0 && SEGMENT.speed == 0))
@@ -73,6 +104,92 @@ int8_t tristate_square8(uint8_t x, uint8_t pulsewidth, uint8_t attdec) {
   return 0;
 }
 
+// noise field quality: 0 evaluates noise for every pixel, 1-3 allow interpolating from a lattice of up to 2, 4 or 8 pixels
+#ifndef WLED_NOISE_QUALITY
+  #if defined(ESP8266) || defined(CONFIG_IDF_TARGET_ESP32C3)
+    #define WLED_NOISE_QUALITY 2
+  #else
+    #define WLED_NOISE_QUALITY 1
+  #endif
+#endif
+#define NOISE_LATTICE_MAX_DIST 64 // max. lattice spacing in noise coordinates (1/4 of noise cell) to keep interpolation smooth
+
+/*
+ * Noise field for 2D effects: inoise8(x0 + x*xstep, y0 + y*ystep[, z]) of every segment pixel (steps in 1/256)
+ * is evaluated on a coarse lattice once per frame and bilinearly interpolated.
+ * Lattice is stored in effect data (header + lattice); segments running the same effect with identical
+ * dimensions and noise parameters reuse lattice of the first one computed in the same frame.
+ */
+typedef struct NoiseField {
+  uint32_t key;
+  uint32_t frame;
+  uint16_t lw, lh;       // lattice size
+  uint8_t  sx, sy;       // lattice spacing as power of 2
+  uint8_t  lattice[];
+
+  static uint8_t spacing(uint32_t step) {
+    uint8_t s = 0;
+    while (s < WLED_NOISE_QUALITY && (step << (s+1)) <= (NOISE_LATTICE_MAX_DIST << 8)) s++;
+    return s;
+  }
+  static size_t bytes(uint16_t cols, uint16_t rows, uint32_t xstep, uint32_t ystep) {
+    return sizeof(NoiseField) + (((cols-1) >> spacing(xstep)) + 2) * (((rows-1) >> spacing(ystep)) + 2);
+  }
+
+  // interpolated noise value of pixel x,y
+  inline uint8_t at(int x, int y) const {
+    const int gx = x >> sx, gy = y >> sy;
+    const int wx = (x & ((1<<sx)-1)) << (8-sx);
+    const int wy = (y & ((1<<sy)-1)) << (8-sy);
+    const uint8_t *r0 = lattice + gy * lw;
+    const uint8_t *r1 = r0 + lw;
+    const int top = (r0[gx] << 8) + (r0[gx+1] - r0[gx]) * wx;
+    const int bot = (r1[gx] << 8) + (r1[gx+1] - r1[gx]) * wx;
+    return ((top << 8) + (bot - top) * wy) >> 16;
+  }
+} noiseField;
+
+// returns noise field of the current segment (or nullptr if effect data could not be allocated), z (0-65535) <0 uses 2D noise
+static const noiseField *getNoiseField(uint32_t x0, uint32_t xstep, uint32_t y0, uint32_t ystep, int32_t z = -1) {
+  const uint16_t cols = SEGMENT.virtualWidth();
+  const uint16_t rows = SEGMENT.virtualHeight();
+  const size_t len = noiseField::bytes(cols, rows, xstep, ystep);
+  if (!SEGENV.allocateData(len)) return nullptr;
+  noiseField *nf = reinterpret_cast<noiseField*>(SEGENV.data);
+
+  const uint32_t params[] = { cols, rows, x0, xstep, y0, ystep, (uint32_t)z };
+  uint32_t key = fnv1a(params, sizeof(params));
+  key |= 1; // cleared data never matches
+  if (nf->key == key && nf->frame == strip.now) return nf; // already done this frame
+
+  // reuse lattice of other segment running same effect with same parameters
+  for (unsigned i = 0; i < strip.getSegmentsNum(); i++) {
+    Segment &seg = strip.getSegment(i);
+    if (&seg == &SEGMENT || !seg.isActive() || seg.mode != SEGMENT.mode || !seg.data || seg.dataSize() < len) continue;
+    const noiseField *other = reinterpret_cast<const noiseField*>(seg.data);
+    if (other->key == key && other->frame == strip.now) {
+      memcpy(nf, other, len);
+      return nf;
+    }
+  }
+
+  nf->sx    = noiseField::spacing(xstep);
+  nf->sy    = noiseField::spacing(ystep);
+  nf->lw    = ((cols-1) >> nf->sx) + 2;
+  nf->lh    = ((rows-1) >> nf->sy) + 2;
+  for (int gy = 0; gy < nf->lh; gy++) {
+    const uint32_t ny = y0 + ((uint32_t(gy << nf->sy) * ystep) >> 8);
+    for (int gx = 0; gx < nf->lw; gx++) {
+      const uint32_t nx = x0 + ((uint32_t(gx << nf->sx) * xstep) >> 8);
+      nf->lattice[gy * nf->lw + gx] = z < 0 ? inoise8(nx, ny) : inoise8(nx, ny, z);
+    }
+  }
+  // mark as done only now, segment on other core (parallel rendering) may be looking for a lattice to reuse
+  nf->key   = key;
+  nf->frame = strip.now;
+  return nf;
+}
+
 // effect functions
 
 /*
@@ -1696,29 +1813,22 @@ uint16_t mode_multi_comet(void) {
   uint32_t cycleTime = 10 + (uint32_t)(255 - SEGMENT.speed);
   uint32_t it = strip.now / cycleTime;
   if (SEGENV.step == it) return FRAMETIME;
-  if (!SEGENV.allocateData(sizeof(uint16_t) * 8)) return mode_static(); //allocation failed
+  ParticleSystem comets; // comets move one pixel per step
+  if (!comets.setup(8)) return mode_static(); //allocation failed
 
   SEGMENT.fade_out(SEGMENT.intensity);
 
-  uint16_t* comets = reinterpret_cast<uint16_t*>(SEGENV.data);
-
+  comets.move();
   for (int i=0; i < 8; i++) {
-    if(comets[i] < SEGLEN) {
-      uint16_t index = comets[i];
-      if (SEGCOLOR(2) != 0)
-      {
-        SEGMENT.setPixelColor(index, i % 2 ? SEGMENT.color_from_palette(index, true, PALETTE_SOLID_WRAP, 0) : SEGCOLOR(2));
-      } else
-      {
-        SEGMENT.setPixelColor(index, SEGMENT.color_from_palette(index, true, PALETTE_SOLID_WRAP, 0));
-      }
-      comets[i]++;
-    } else {
-      if(!random(SEGLEN)) {
-        comets[i] = 0;
-      }
+    if (comets.life[i] && comets.x[i] >= SEGLEN * PS_ONE) comets.life[i] = 0;
+    if (!comets.life[i]) {
+      if (random(SEGLEN)) continue;
+      comets.spawn(i, 0, PS_ONE, 0);
     }
+    uint16_t index = comets.x[i] >> PS_SHIFT;
+    comets.color[i] = (SEGCOLOR(2) != 0 && !(i % 2)) ? SEGCOLOR(2) : SEGMENT.color_from_palette(index, true, PALETTE_SOLID_WRAP, 0);
   }
+  SEGMENT.drawParticles(comets);
 
   SEGENV.step = it;
   return FRAMETIME;
@@ -2773,25 +2883,18 @@ uint16_t mode_spots_fade()
 static const char _data_FX_MODE_SPOTS_FADE[] PROGMEM = "Spots Fade@Spread,Width,,,,,Overlay;!,!;!";
 
 
-//each needs 12 bytes
-typedef struct Ball {
-  unsigned long lastBounceTime;
-  float impactVelocity;
-  float height;
-} ball;
-
 /*
 *  Bouncing Balls Effect
+*  balls are particles: x is height (PS_ONE = top of strip), vx impact velocity (strip heights per second),
+*  extra holds the time of the last bounce of each ball and life is set if a ball is drawn this frame
 */
 uint16_t mode_bouncing_balls(void) {
   if (SEGLEN == 1) return mode_static();
   //allocate segment data
   const uint16_t strips = SEGMENT.nrOfVStrips(); // adapt for 2D
   const size_t maxNumBalls = 16;
-  uint16_t dataSize = sizeof(ball) * maxNumBalls;
-  if (!SEGENV.allocateData(dataSize * strips)) return mode_static(); //allocation failed
-
-  Ball* balls = reinterpret_cast<Ball*>(SEGENV.data);
+  ParticleSystem balls;
+  if (!balls.setup(maxNumBalls * strips, false, sizeof(uint32_t) * maxNumBalls * strips)) return mode_static(); //allocation failed
 
   if (!SEGMENT.check2) SEGMENT.fill(SEGCOLOR(2) ? BLACK : SEGCOLOR(1));
 
@@ -2799,35 +2902,38 @@ uint16_t mode_bouncing_balls(void) {
   // requires virtual strip # to be embedded into upper 16 bits of index in setPixelColor()
   // the following functions will not work on virtual strips: fill(), fade_out(), fadeToBlack(), blur()
   struct virtualStrip {
-    static void runStrip(size_t stripNr, Ball* balls) {
+    static void runStrip(size_t stripNr, ParticleSystem &balls) {
       // number of balls based on intensity setting to max of 7 (cycles colors)
       // non-chosen color is a random color
       uint16_t numBalls = (SEGMENT.intensity * (maxNumBalls - 1)) / 255 + 1; // minimum 1 ball
-      const float gravity = -9.81f; // standard value of gravity
+      const int32_t halfGravity = 321454; // 0.5 * 9.81 (standard value of gravity) in fixed point
       const bool hasCol2 = SEGCOLOR(2);
-      const unsigned long time = millis();
+      const uint32_t time = millis();
+      const size_t first = stripNr * maxNumBalls;
+      uint32_t *lastBounceTime = reinterpret_cast<uint32_t*>(balls.extra) + first;
 
-      if (SEGENV.call == 0) {
-        for (size_t i = 0; i < maxNumBalls; i++) balls[i].lastBounceTime = time;
+      if (balls.fresh) {
+        for (size_t i = 0; i < maxNumBalls; i++) lastBounceTime[i] = time;
       }
 
       for (size_t i = 0; i < numBalls; i++) {
-        float timeSinceLastBounce = (time - balls[i].lastBounceTime)/((255-SEGMENT.speed)/64 +1);
-        float timeSec = timeSinceLastBounce/1000.0f;
-        balls[i].height = (0.5f * gravity * timeSec + balls[i].impactVelocity) * timeSec; // avoid use pow(x, 2) - its extremely slow !
-
-        if (balls[i].height <= 0.0f) {
-          balls[i].height = 0.0f;
+        const size_t b = first + i;
+        uint32_t timeSinceLastBounce = MIN((time - lastBounceTime[i])/((255-SEGMENT.speed)/64 +1), 60000U); // balls not in use may not have bounced for ages
+        int64_t timeSec = (int64_t(timeSinceLastBounce) << PS_SHIFT) / 1000;
+        int32_t height = (balls.vx[b] * timeSec - ((halfGravity * timeSec * timeSec) >> PS_SHIFT)) >> PS_SHIFT; // height = (0.5 * gravity * t + v) * t
+        balls.life[b] = 0;
+
+        if (height <= 0) {
+          height = 0;
           //damping for better effect using multiple balls
-          float dampening = 0.9f - float(i)/float(numBalls * numBalls); // avoid use pow(x, 2) - its extremely slow !
-          balls[i].impactVelocity = dampening * balls[i].impactVelocity;
-          balls[i].lastBounceTime = time;
+          int32_t dampening = 58982 - (int32_t(i) << PS_SHIFT) / int32_t(numBalls * numBalls); // 0.9 - i/numBalls^2
+          balls.vx[b] = (int64_t(dampening) * balls.vx[b]) >> PS_SHIFT;
+          lastBounceTime[i] = time;
 
-          if (balls[i].impactVelocity < 0.015f) {
-            float impactVelocityStart = sqrtf(-2.0f * gravity) * random8(5,11)/10.0f; // randomize impact velocity
-            balls[i].impactVelocity = impactVelocityStart;
+          if (balls.vx[b] < 983) { // 0.015
+            balls.vx[b] = 290289 * random8(5,11) / 10; // randomize impact velocity, sqrt(2 * 9.81) * 0.5 .. 1
           }
-        } else if (balls[i].height > 1.0f) {
+        } else if (height > PS_ONE) {
           continue; // do not draw OOB ball
         }
 
@@ -2838,15 +2944,18 @@ uint16_t mode_bouncing_balls(void) {
           color = SEGCOLOR(i % NUM_COLORS);
         }
 
-        int pos = roundf(balls[i].height * (SEGLEN - 1));
-        if (SEGLEN<32) SEGMENT.setPixelColor(indexToVStrip(pos, stripNr), color); // encode virtual strip into index
-        else           SEGMENT.setPixelColor(balls[i].height + (stripNr+1)*10.0f, color);
+        balls.x[b]     = height * (SEGLEN - 1);
+        balls.color[b] = color;
+        balls.life[b]  = 1;
       }
+      // short strips show whole pixels (rounded), longer ones smooth positions
+      if (SEGLEN < 32) for (size_t i = 0; i < numBalls; i++) balls.x[first + i] += PS_ONE/2;
+      SEGMENT.drawParticles(balls, first, numBalls, stripNr+1, SEGLEN < 32 ? 0 : PS_AA);
     }
   };
 
   for (int stripNr=0; stripNr<strips; stripNr++)
-    virtualStrip::runStrip(stripNr, &balls[stripNr * maxNumBalls]);
+    virtualStrip::runStrip(stripNr, balls);
 
   return FRAMETIME;
 }
@@ -3042,77 +3151,62 @@ static const char _data_FX_MODE_SOLID_GLITTER[] PROGMEM = "Solid Glitter@,!;Bg,,
 
 
 //each needs 19 bytes
-//Spark type is used for popcorn, 1D fireworks, and drip
-typedef struct Spark {
-  float pos, posX;
-  float vel, velX;
-  uint16_t col;
-  uint8_t colIndex;
-} spark;
-
 #define maxNumPopcorn 21 // max 21 on 16 segment ESP8266
 /*
 *  POPCORN
 *  modified from https://github.com/kitesurfer1404/WS2812FX/blob/master/src/custom/Popcorn.h
+*  kernels are particles, user holds the color index
 */
 uint16_t mode_popcorn(void) {
   if (SEGLEN == 1) return mode_static();
   //allocate segment data
   uint16_t strips = SEGMENT.nrOfVStrips();
-  uint16_t dataSize = sizeof(spark) * maxNumPopcorn;
-  if (!SEGENV.allocateData(dataSize * strips)) return mode_static(); //allocation failed
-
-  Spark* popcorn = reinterpret_cast<Spark*>(SEGENV.data);
+  ParticleSystem popcorn;
+  if (!popcorn.setup(maxNumPopcorn * strips)) return mode_static(); //allocation failed
 
   bool hasCol2 = SEGCOLOR(2);
   if (!SEGMENT.check2) SEGMENT.fill(hasCol2 ? BLACK : SEGCOLOR(1));
 
   struct virtualStrip {
-    static void runStrip(uint16_t stripNr, Spark* popcorn) {
-      float gravity = -0.0001 - (SEGMENT.speed/200000.0); // m/s/s
-      gravity *= SEGLEN;
+    static void runStrip(uint16_t stripNr, ParticleSystem &popcorn) {
+      const int32_t gravity = -int32_t((655U + SEGMENT.speed * 33U) * SEGLEN / 100U); // (0.0001 + speed/200000) * SEGLEN pixels per frame^2
+      const uint16_t first = stripNr * maxNumPopcorn;
 
       uint8_t numPopcorn = SEGMENT.intensity*maxNumPopcorn/255;
       if (numPopcorn == 0) numPopcorn = 1;
 
-      for(int i = 0; i < numPopcorn; i++) {
-        if (popcorn[i].pos >= 0.0f) { // if kernel is active, update its position
-          popcorn[i].pos += popcorn[i].vel;
-          popcorn[i].vel += gravity;
-        } else { // if kernel is inactive, randomly pop it
-          if (random8() < 2) { // POP!!!
-            popcorn[i].pos = 0.01f;
-
-            uint16_t peakHeight = 128 + random8(128); //0-255
-            peakHeight = (peakHeight * (SEGLEN -1)) >> 8;
-            popcorn[i].vel = sqrtf(-2.0f * gravity * peakHeight);
-
-            if (SEGMENT.palette)
-            {
-              popcorn[i].colIndex = random8();
-            } else {
-              byte col = random8(0, NUM_COLORS);
-              if (!SEGCOLOR(2) || !SEGCOLOR(col)) col = 0;
-              popcorn[i].colIndex = col;
-            }
+      popcorn.move(gravity, 0, first, numPopcorn); // update position of active kernels
+      for (int i = first; i < first + numPopcorn; i++) {
+        if (popcorn.x[i] < 0) popcorn.life[i] = 0; // fell back down
+        if (!popcorn.life[i]) { // if kernel is inactive, randomly pop it
+          if (random8() >= 2) continue;
+          // POP!!!
+          uint16_t peakHeight = 128 + random8(128); //0-255
+          peakHeight = (peakHeight * (SEGLEN -1)) >> 8;
+          popcorn.spawn(i, PS_ONE/100, ParticleSystem::launchVelocity(gravity, peakHeight), 0);
+
+          if (SEGMENT.palette)
+          {
+            popcorn.user[i] = random8();
+          } else {
+            byte col = random8(0, NUM_COLORS);
+            if (!SEGCOLOR(2) || !SEGCOLOR(col)) col = 0;
+            popcorn.user[i] = col;
           }
         }
-        if (popcorn[i].pos >= 0.0f) { // draw now active popcorn (either active before or just popped)
-          uint32_t col = SEGMENT.color_wheel(popcorn[i].colIndex);
-          if (!SEGMENT.palette && popcorn[i].colIndex < NUM_COLORS) col = SEGCOLOR(popcorn[i].colIndex);
-          uint16_t ledIndex = popcorn[i].pos;
-          if (ledIndex < SEGLEN) SEGMENT.setPixelColor(indexToVStrip(ledIndex, stripNr), col);
-        }
+        // color of now active popcorn (either active before or just popped)
+        popcorn.color[i] = (!SEGMENT.palette && popcorn.user[i] < NUM_COLORS) ? SEGCOLOR(popcorn.user[i]) : SEGMENT.color_wheel(popcorn.user[i]);
       }
+      SEGMENT.drawParticles(popcorn, first, numPopcorn, stripNr+1, SEGMENT.check1 ? PS_AA : 0);
     }
   };
 
   for (int stripNr=0; stripNr<strips; stripNr++)
-    virtualStrip::runStrip(stripNr, &popcorn[stripNr * maxNumPopcorn]);
+    virtualStrip::runStrip(stripNr, popcorn);
 
   return FRAMETIME;
 }
-static const char _data_FX_MODE_POPCORN[] PROGMEM = "Popcorn@!,!,,,,,Overlay;!,!,!;!;;m12=1"; //bar
+static const char _data_FX_MODE_POPCORN[] PROGMEM = "Popcorn@!,!,,,,Smooth,Overlay;!,!,!;!;;m12=1"; //bar
 
 
 //values close to 100 produce 5Hz flicker, which looks very candle-y
@@ -3218,14 +3312,15 @@ static const char _data_FX_MODE_CANDLE_MULTI[] PROGMEM = "Candle Multi@!,!;!,!;!
 #else
   #define STARBURST_MAX_FRAG  10 //60 bytes / star
 #endif
-//each needs 20+STARBURST_MAX_FRAG*4 bytes
+//each needs 24 bytes, fragments are not stored: fragment pair i moves dist*i/3 from the start position (both directions)
 typedef struct particle {
-  CRGB     color;
-  uint32_t birth  =0;
-  uint32_t last   =0;
-  float    vel    =0;
-  uint16_t pos    =-1;
-  float    fragment[STARBURST_MAX_FRAG];
+  uint32_t color;
+  uint32_t birth;
+  uint32_t last;
+  int32_t  vel;    // pixels per second (fixed point)
+  int32_t  dist;   // distance travelled (fixed point)
+  uint16_t pos;
+  uint8_t  frags;
 } star;
 
 uint16_t mode_starburst(void) {
@@ -3234,7 +3329,7 @@ uint16_t mode_starburst(void) {
   uint8_t segs = strip.getActiveSegmentsNum();
   if (segs <= (strip.getMaxSegments() /2)) maxData *= 2; //ESP8266: 512 if <= 8 segs ESP32: 1280 if <= 16 segs
   if (segs <= (strip.getMaxSegments() /4)) maxData *= 2; //ESP8266: 1024 if <= 4 segs ESP32: 2560 if <= 8 segs
-  uint16_t maxStars = maxData / sizeof(star); //ESP8266: max. 4/9/19 stars/seg, ESP32: max. 10/21/42 stars/seg
+  uint16_t maxStars = maxData / sizeof(star); //ESP8266: max. 10/21/42 stars/seg, ESP32: max. 26/53/106 stars/seg
 
   uint8_t numStars = 1 + (SEGLEN >> 3);
   if (numStars > maxStars) numStars = maxStars;
@@ -3246,9 +3341,9 @@ uint16_t mode_starburst(void) {
 
   star* stars = reinterpret_cast<star*>(SEGENV.data);
 
-  float          maxSpeed                = 375.0f;  // Max velocity
-  float          particleIgnition        = 250.0f;  // How long to "flash"
-  float          particleFadeTime        = 1500.0f; // Fade out time
+  const uint32_t maxSpeed         = 375;  // Max velocity
+  const uint32_t particleIgnition = 250;  // How long to "flash"
+  const uint32_t particleFadeTime = 1500; // Fade out time
 
   for (int j = 0; j < numStars; j++)
   {
@@ -3257,20 +3352,16 @@ uint16_t mode_starburst(void) {
     {
       // Pick a random color and location.
       uint16_t startPos = (SEGLEN > 1) ? random16(SEGLEN-1) : 0;
-      float multiplier = (float)(random8())/255.0 * 1.0;
+      uint8_t multiplier = random8();
 
-      stars[j].color = CRGB(SEGMENT.color_wheel(random8()));
+      stars[j].color = SEGMENT.color_wheel(random8());
       stars[j].pos = startPos;
-      stars[j].vel = maxSpeed * (float)(random8())/255.0 * multiplier;
+      stars[j].vel = (uint64_t(maxSpeed * PS_ONE) * random8() * multiplier) / (255*255);
+      stars[j].dist = 0;
       stars[j].birth = it;
       stars[j].last = it;
       // more fragments means larger burst effect
-      int num = random8(3,6 + (SEGMENT.intensity >> 5));
-
-      for (int i=0; i < STARBURST_MAX_FRAG; i++) {
-        if (i < num) stars[j].fragment[i] = startPos;
-        else stars[j].fragment[i] = -1;
-      }
+      stars[j].frags = MIN(random8(3,6 + (SEGMENT.intensity >> 5)), STARBURST_MAX_FRAG);
     }
   }
 
@@ -3278,68 +3369,47 @@ uint16_t mode_starburst(void) {
 
   for (int j=0; j<numStars; j++)
   {
-    if (stars[j].birth != 0) {
-      float dt = (it-stars[j].last)/1000.0;
+    if (stars[j].birth == 0) continue;
 
-      for (int i=0; i < STARBURST_MAX_FRAG; i++) {
-        int var = i >> 1;
+    uint32_t dt = it - stars[j].last; // ms
+    //all fragments travel right, will be mirrored on other side
+    stars[j].dist += (int64_t(stars[j].vel) * dt) / 1000;
+    stars[j].vel   = (int64_t(stars[j].vel) * (1000 - MIN(3*dt, 1000U))) / 1000;
+    stars[j].last  = it;
 
-        if (stars[j].fragment[i] > 0) {
-          //all fragments travel right, will be mirrored on other side
-          stars[j].fragment[i] += stars[j].vel * dt * (float)var/3.0;
-        }
-      }
-      stars[j].last = it;
-      stars[j].vel -= 3*stars[j].vel*dt;
-    }
-
-    CRGB c = stars[j].color;
+    uint32_t c = stars[j].color;
 
     // If the star is brand new, it flashes white briefly.
-    // Otherwise it just fades over time.
-    float fade = 0.0f;
-    float age = it-stars[j].birth;
+    // Otherwise it just fades over time (fragments are added to the background so fade to black).
+    uint32_t age = it - stars[j].birth;
+    uint32_t fadeAge = 0;
 
     if (age < particleIgnition) {
-      c = CRGB(color_blend(WHITE, RGBW32(c.r,c.g,c.b,0), 254.5f*((age / particleIgnition))));
+      c = color_blend(WHITE, c, age * 509 / (2*particleIgnition)); // 254.5 * age / particleIgnition
     } else {
       // Figure out how much to fade and shrink the star based on
       // its age relative to its lifetime
-      if (age > particleIgnition + particleFadeTime) {
-        fade = 1.0f;                  // Black hole, all faded out
-        stars[j].birth = 0;
-        c = CRGB(SEGCOLOR(1));
-      } else {
-        age -= particleIgnition;
-        fade = (age / particleFadeTime);  // Fading star
-        byte f = 254.5f*fade;
-        c = CRGB(color_blend(RGBW32(c.r,c.g,c.b,0), SEGCOLOR(1), f));
+      fadeAge = age - particleIgnition;
+      if (fadeAge > particleFadeTime) {
+        stars[j].birth = 0;           // Black hole, all faded out
+        continue;
       }
+      c = color_fade(c, 255 - fadeAge * 509 / (2*particleFadeTime)); // Fading star
     }
 
-    float particleSize = (1.0f - fade) * 2.0f;
-
-    for (size_t index=0; index < STARBURST_MAX_FRAG*2; index++) {
-      bool mirrored = index & 0x1;
-      uint8_t i = index >> 1;
-      if (stars[j].fragment[i] > 0) {
-        float loc = stars[j].fragment[i];
-        if (mirrored) loc -= (loc-stars[j].pos)*2;
-        int start = loc - particleSize;
-        int end = loc + particleSize;
-        if (start < 0) start = 0;
-        if (start == end) end++;
-        if (end > SEGLEN) end = SEGLEN;
-        for (int p = start; p < end; p++) {
-          SEGMENT.setPixelColor(p, c.r, c.g, c.b);
-        }
-      }
+    const int32_t particleSize = (particleFadeTime - fadeAge) * 2 * PS_ONE / particleFadeTime;
+    const int32_t center = stars[j].pos * PS_ONE;
+
+    for (int var = 0; var <= (stars[j].frags - 1) >> 1; var++) {
+      int32_t offset = stars[j].dist * var / 3;
+      SEGMENT.drawParticle(center + offset, c, 0, SEGMENT.check1 ? PS_AA : 0, particleSize);
+      if (offset) SEGMENT.drawParticle(center - offset, c, 0, SEGMENT.check1 ? PS_AA : 0, particleSize); // mirrored
     }
   }
   return FRAMETIME;
 }
 #undef STARBURST_MAX_FRAG
-static const char _data_FX_MODE_STARBURST[] PROGMEM = "Fireworks Starburst@Chance,Fragments,,,,,Overlay;,!;!;;pal=11,m12=0";
+static const char _data_FX_MODE_STARBURST[] PROGMEM = "Fireworks Starburst@Chance,Fragments,,,,Smooth,Overlay;,!;!;;pal=11,m12=0";
 
 
 /*
@@ -3358,50 +3428,46 @@ uint16_t mode_exploding_fireworks(void)
   uint8_t segs = strip.getActiveSegmentsNum();
   if (segs <= (strip.getMaxSegments() /2)) maxData *= 2; //ESP8266: 512 if <= 8 segs ESP32: 1280 if <= 16 segs
   if (segs <= (strip.getMaxSegments() /4)) maxData *= 2; //ESP8266: 1024 if <= 4 segs ESP32: 2560 if <= 8 segs
-  int maxSparks = maxData / sizeof(spark); //ESP8266: max. 21/42/85 sparks/seg, ESP32: max. 53/106/213 sparks/seg
+  const size_t baseSize  = ParticleSystem::dataSize(0, strip.isMatrix, sizeof(int32_t));
+  const size_t sparkSize = ParticleSystem::dataSize(1, strip.isMatrix, sizeof(int32_t)) - baseSize;
+  int maxSparks = (maxData - baseSize) / sparkSize; //ESP8266: max. 16/33/67 (1D) 10/21/44 (2D) sparks/seg, ESP32: max. 42/84/170 (1D) 27/55/110 (2D) sparks/seg
 
   uint16_t numSparks = min(2 + ((rows*cols) >> 1), maxSparks);
-  uint16_t dataSize = sizeof(spark) * numSparks;
-  if (!SEGENV.allocateData(dataSize + sizeof(float))) return mode_static(); //allocation failed
-  float *dying_gravity = reinterpret_cast<float*>(SEGENV.data + dataSize);
+  // first particle is the flare, height is y on 2D (x drifts sideways), x on 1D (user of the flare is the firing side)
+  ParticleSystem sparks;
+  if (!sparks.setup(numSparks, strip.isMatrix, sizeof(int32_t))) return mode_static(); //allocation failed
+  int32_t *dying_gravity = reinterpret_cast<int32_t*>(sparks.extra);
+  int32_t *pos = strip.isMatrix ? sparks.y  : sparks.x;
+  int32_t *vel = strip.isMatrix ? sparks.vy : sparks.vx;
 
-  if (dataSize != SEGENV.aux1) { //reset to flare if sparks were reallocated (it may be good idea to reset segment if bounds change)
-    *dying_gravity = 0.0f;
-    SEGENV.aux0 = 0;
-    SEGENV.aux1 = dataSize;
-  }
+  if (sparks.fresh) SEGENV.aux0 = 0; //reset to flare if sparks were reallocated (it may be good idea to reset segment if bounds change)
 
   SEGMENT.fade_out(252);
 
-  Spark* sparks = reinterpret_cast<Spark*>(SEGENV.data);
-  Spark* flare = sparks; //first spark is flare data
-
-  float gravity = -0.0004f - (SEGMENT.speed/800000.0f); // m/s/s
-  gravity *= rows;
+  const int32_t gravity = -int32_t((26214U + SEGMENT.speed * 82U) * rows / 1000U); // (0.0004 + speed/800000) * rows pixels per frame^2
+  const uint8_t flags = (strip.isMatrix || sparks.user[0] ? PS_FLIP : 0) | (SEGMENT.check1 ? PS_AA : 0); // fire from the bottom (2D) or the chosen side
 
   if (SEGENV.aux0 < 2) { //FLARE
     if (SEGENV.aux0 == 0) { //init flare
-      flare->pos = 0;
-      flare->posX = strip.isMatrix ? random16(2,cols-3) : (SEGMENT.intensity > random8()); // will enable random firing side on 1D
       uint16_t peakHeight = 75 + random8(180); //0-255
       peakHeight = (peakHeight * (rows -1)) >> 8;
-      flare->vel = sqrtf(-2.0f * gravity * peakHeight);
-      flare->velX = strip.isMatrix ? (random8(9)-4)/32.f : 0; // no X velocity on 1D
-      flare->col = 255; //brightness
+      if (strip.isMatrix) sparks.spawn(0, random16(2,cols-3) * PS_ONE, 0, (random8(9)-4) * (PS_ONE/32), ParticleSystem::launchVelocity(gravity, peakHeight), 0, 255);
+      else                sparks.spawn(0, 0, ParticleSystem::launchVelocity(gravity, peakHeight), 0, 255);
+      sparks.user[0] = !strip.isMatrix && (SEGMENT.intensity > random8()); // will enable random firing side on 1D
       SEGENV.aux0 = 1;
     }
 
     // launch
-    if (flare->vel > 12 * gravity) {
-      // flare
-      if (strip.isMatrix) SEGMENT.setPixelColorXY(int(flare->posX), rows - uint16_t(flare->pos) - 1, flare->col, flare->col, flare->col);
-      else                SEGMENT.setPixelColor(int(flare->posX) ? rows - int(flare->pos) - 1 : int(flare->pos), flare->col, flare->col, flare->col);
-      flare->pos  += flare->vel;
-      flare->posX += flare->velX;
-      flare->pos  = constrain(flare->pos, 0, rows-1);
-      flare->posX = constrain(flare->posX, 0, cols-strip.isMatrix);
-      flare->vel  += gravity;
-      flare->col  -= 2;
+    if (vel[0] > 12 * gravity) {
+      // flare, brightness is kept in life
+      const uint8_t col = sparks.life[0];
+      sparks.color[0] = RGBW32(col, col, col, 0);
+      SEGMENT.drawParticles(sparks, 0, 1, 0, flags);
+      sparks.move(0, 0, 0, 1);
+      vel[0] += gravity;
+      pos[0] = constrain(pos[0], 0, (rows-1) * PS_ONE);
+      if (strip.isMatrix) sparks.x[0] = constrain(sparks.x[0], 0, (cols-1) * PS_ONE);
+      sparks.life[0] = MAX(int(sparks.life[0]) - 2, 1);
     } else {
       SEGENV.aux0 = 2;  // ready to explode
     }
@@ -3412,56 +3478,50 @@ uint16_t mode_exploding_fireworks(void)
      * Explosion happens where the flare ended.
      * Size is proportional to the height.
      */
-    int nSparks = flare->pos + random8(4);
+    int nSparks = (pos[0] >> PS_SHIFT) + random8(4);
     nSparks = constrain(nSparks, 4, numSparks);
 
     // initialize sparks
     if (SEGENV.aux0 == 2) {
       for (int i = 1; i < nSparks; i++) {
-        sparks[i].pos  = flare->pos;
-        sparks[i].posX = flare->posX;
-        sparks[i].vel  = (float(random16(20001)) / 10000.0f) - 0.9f; // from -0.9 to 1.1
-        sparks[i].vel *= rows<32 ? 0.5f : 1; // reduce velocity for smaller strips
-        sparks[i].velX = strip.isMatrix ? (float(random16(10001)) / 10000.0f) - 0.5f : 0; // from -0.5 to 0.5
-        sparks[i].col  = 345;//abs(sparks[i].vel * 750.0); // set colors before scaling velocity to keep them bright
-        //sparks[i].col = constrain(sparks[i].col, 0, 345);
-        sparks[i].colIndex = random8();
-        sparks[i].vel  *= flare->pos/rows; // proportional to height
-        sparks[i].velX *= strip.isMatrix ? flare->posX/cols : 0; // proportional to width
-        sparks[i].vel  *= -gravity *50;
+        int32_t v  = random16(20001) * 6553 / 1000 - 58982; // from -0.9 to 1.1
+        if (rows < 32) v /= 2; // reduce velocity for smaller strips
+        v = int64_t(v) * pos[0] / (rows * PS_ONE); // proportional to height
+        v = (int64_t(v) * (-gravity * 50)) >> PS_SHIFT;
+        if (strip.isMatrix) {
+          int32_t vX = random16(10001) * 6553 / 1000 - 32768; // from -0.5 to 0.5
+          vX = int64_t(vX) * sparks.x[0] / (cols * PS_ONE); // proportional to width
+          sparks.spawn(i, sparks.x[0], pos[0], vX, v, 0, 345);
+        } else {
+          sparks.spawn(i, pos[0], v, 0, 345); // life is the "temperature" (set before scaling velocity to keep them bright)
+        }
+        sparks.user[i] = random8(); // color index
       }
-      //sparks[1].col = 345; // this will be our known spark
+      sparks.life[0] = 0; // flare is gone
       *dying_gravity = gravity/2;
       SEGENV.aux0 = 3;
     }
 
-    if (sparks[1].col > 4) {//&& sparks[1].pos > 0) { // as long as our known spark is lit, work with all the sparks
+    if (sparks.life[1] > 4) { // as long as our known spark is lit, work with all the sparks
+      sparks.move(*dying_gravity, *dying_gravity, 1, nSparks - 1); // on 2D dying gravity is added to sideways velocity too
       for (int i = 1; i < nSparks; i++) {
-        sparks[i].pos  += sparks[i].vel;
-        sparks[i].posX += sparks[i].velX;
-        sparks[i].vel  += *dying_gravity;
-        sparks[i].velX += strip.isMatrix ? *dying_gravity : 0;
-        if (sparks[i].col > 3) sparks[i].col -= 4;
-
-        if (sparks[i].pos > 0 && sparks[i].pos < rows) {
-          if (strip.isMatrix && !(sparks[i].posX >= 0 && sparks[i].posX < cols)) continue;
-          uint16_t prog = sparks[i].col;
-          uint32_t spColor = (SEGMENT.palette) ? SEGMENT.color_wheel(sparks[i].colIndex) : SEGCOLOR(0);
-          CRGB c = CRGB::Black; //HeatColor(sparks[i].col);
-          if (prog > 300) { //fade from white to spark color
-            c = CRGB(color_blend(spColor, WHITE, (prog - 300)*5));
-          } else if (prog > 45) { //fade from spark color to black
-            c = CRGB(color_blend(BLACK, spColor, prog - 45));
-            uint8_t cooling = (300 - prog) >> 5;
-            c.g = qsub8(c.g, cooling);
-            c.b = qsub8(c.b, cooling * 2);
-          }
-          if (strip.isMatrix) SEGMENT.setPixelColorXY(int(sparks[i].posX), rows - int(sparks[i].pos) - 1, c.red, c.green, c.blue);
-          else                SEGMENT.setPixelColor(int(sparks[i].posX) ? rows - int(sparks[i].pos) - 1 : int(sparks[i].pos), c.red, c.green, c.blue);
+        if (sparks.life[i] > 3) sparks.life[i] -= 4;
+        uint16_t prog = sparks.life[i];
+        uint32_t spColor = (SEGMENT.palette) ? SEGMENT.color_wheel(sparks.user[i]) : SEGCOLOR(0);
+        CRGB c = CRGB::Black; //HeatColor(sparks[i].col);
+        if (prog > 300) { //fade from white to spark color
+          c = CRGB(color_blend(spColor, WHITE, (prog - 300)*5));
+        } else if (prog > 45) { //fade from spark color to black
+          c = CRGB(color_blend(BLACK, spColor, prog - 45));
+          uint8_t cooling = (300 - prog) >> 5;
+          c.g = qsub8(c.g, cooling);
+          c.b = qsub8(c.b, cooling * 2);
         }
+        sparks.color[i] = RGBW32(c.red, c.green, c.blue, 0);
       }
+      SEGMENT.drawParticles(sparks, 1, nSparks - 1, 0, flags); // off-segment sparks are skipped
       SEGMENT.blur(16);
-      *dying_gravity *= .8f; // as sparks burn out they fall slower
+      *dying_gravity = *dying_gravity * 4 / 5; // as sparks burn out they fall slower
     } else {
       SEGENV.aux0 = 6 + random8(10); //wait for this many frames
     }
@@ -3475,7 +3535,7 @@ uint16_t mode_exploding_fireworks(void)
   return FRAMETIME;
 }
 #undef MAX_SPARKS
-static const char _data_FX_MODE_EXPLODING_FIREWORKS[] PROGMEM = "Fireworks 1D@Gravity,Firing side;!,!;!;12;pal=11,ix=128";
+static const char _data_FX_MODE_EXPLODING_FIREWORKS[] PROGMEM = "Fireworks 1D@Gravity,Firing side,,,,Smooth;!,!;!;12;pal=11,ix=128";
 
 
 /*
@@ -3488,68 +3548,64 @@ uint16_t mode_drip(void)
   //allocate segment data
   uint16_t strips = SEGMENT.nrOfVStrips();
   const int maxNumDrops = 4;
-  uint16_t dataSize = sizeof(spark) * maxNumDrops;
-  if (!SEGENV.allocateData(dataSize * strips)) return mode_static(); //allocation failed
-  Spark* drops = reinterpret_cast<Spark*>(SEGENV.data);
+  ParticleSystem drops; // life is brightness, user is drop state (0 init, 1 forming, 2 falling, 5 bouncing)
+  if (!drops.setup(maxNumDrops * strips)) return mode_static(); //allocation failed
 
   if (!SEGMENT.check2) SEGMENT.fill(SEGCOLOR(1));
 
   struct virtualStrip {
-    static void runStrip(uint16_t stripNr, Spark* drops) {
+    static void runStrip(uint16_t stripNr, ParticleSystem &drops) {
 
       uint8_t numDrops = 1 + (SEGMENT.intensity >> 6); // 255>>6 = 3
 
-      float gravity = -0.0005 - (SEGMENT.speed/50000.0);
-      gravity *= max(1, SEGLEN-1);
+      const int32_t gravity = -int32_t((3277U + SEGMENT.speed * 131U) * max(1, SEGLEN-1) / 100U); // (0.0005 + speed/50000) * SEGLEN pixels per frame^2
       int sourcedrop = 12;
 
-      for (int j=0;j<numDrops;j++) {
-        if (drops[j].colIndex == 0) { //init
-          drops[j].pos = SEGLEN-1;    // start at end
-          drops[j].vel = 0;           // speed
-          drops[j].col = sourcedrop;  // brightness
-          drops[j].colIndex = 1;      // drop state (0 init, 1 forming, 2 falling, 5 bouncing)
+      for (int j = stripNr * maxNumDrops; j < stripNr * maxNumDrops + numDrops; j++) {
+        if (drops.user[j] == 0) { //init
+          drops.spawn(j, (SEGLEN-1) * PS_ONE, 0, 0, sourcedrop); // start at end, not moving
+          drops.user[j] = 1;          // forming
         }
 
         SEGMENT.setPixelColor(indexToVStrip(SEGLEN-1, stripNr), color_blend(BLACK,SEGCOLOR(0), sourcedrop));// water source
-        if (drops[j].colIndex==1) {
-          if (drops[j].col>255) drops[j].col=255;
-          SEGMENT.setPixelColor(indexToVStrip(uint16_t(drops[j].pos), stripNr), color_blend(BLACK,SEGCOLOR(0),drops[j].col));
+        if (drops.user[j]==1) {
+          if (drops.life[j]>255) drops.life[j]=255;
+          SEGMENT.setPixelColor(indexToVStrip(drops.x[j] >> PS_SHIFT, stripNr), color_blend(BLACK,SEGCOLOR(0),drops.life[j]));
 
-          drops[j].col += map(SEGMENT.speed, 0, 255, 1, 6); // swelling
+          drops.life[j] += map(SEGMENT.speed, 0, 255, 1, 6); // swelling
 
-          if (random8() < drops[j].col/10) {               // random drop
-            drops[j].colIndex=2;               //fall
-            drops[j].col=255;
+          if (random8() < drops.life[j]/10) {  // random drop
+            drops.user[j]=2;                   //fall
+            drops.life[j]=255;
           }
         }
-        if (drops[j].colIndex > 1) {           // falling
-          if (drops[j].pos > 0) {              // fall until end of segment
-            drops[j].pos += drops[j].vel;
-            if (drops[j].pos < 0) drops[j].pos = 0;
-            drops[j].vel += gravity;           // gravity is negative
-
-            for (int i=1;i<7-drops[j].colIndex;i++) { // some minor math so we don't expand bouncing droplets
-              uint16_t pos = constrain(uint16_t(drops[j].pos) +i, 0, SEGLEN-1); //this is BAD, returns a pos >= SEGLEN occasionally
-              SEGMENT.setPixelColor(indexToVStrip(pos, stripNr), color_blend(BLACK,SEGCOLOR(0),drops[j].col/i)); //spread pixel with fade while falling
+        if (drops.user[j] > 1) {               // falling
+          if (drops.x[j] > 0) {                // fall until end of segment
+            drops.x[j] += drops.vx[j];
+            if (drops.x[j] < 0) drops.x[j] = 0;
+            drops.vx[j] += gravity;            // gravity is negative
+
+            for (int i=1;i<7-drops.user[j];i++) { // some minor math so we don't expand bouncing droplets
+              int pos = constrain((drops.x[j] >> PS_SHIFT) + i, 0, SEGLEN-1);
+              SEGMENT.setPixelColor(indexToVStrip(pos, stripNr), color_blend(BLACK,SEGCOLOR(0),drops.life[j]/i)); //spread pixel with fade while falling
             }
 
-            if (drops[j].colIndex > 2) {       // during bounce, some water is on the floor
-              SEGMENT.setPixelColor(indexToVStrip(0, stripNr), color_blend(SEGCOLOR(0),BLACK,drops[j].col));
+            if (drops.user[j] > 2) {           // during bounce, some water is on the floor
+              SEGMENT.setPixelColor(indexToVStrip(0, stripNr), color_blend(SEGCOLOR(0),BLACK,drops.life[j]));
             }
           } else {                             // we hit bottom
-            if (drops[j].colIndex > 2) {       // already hit once, so back to forming
-              drops[j].colIndex = 0;
-              drops[j].col = sourcedrop;
+            if (drops.user[j] > 2) {           // already hit once, so back to forming
+              drops.user[j] = 0;
+              drops.life[j] = sourcedrop;
 
             } else {
 
-              if (drops[j].colIndex==2) {      // init bounce
-                drops[j].vel = -drops[j].vel/4;// reverse velocity with damping
-                drops[j].pos += drops[j].vel;
+              if (drops.user[j]==2) {          // init bounce
+                drops.vx[j] = -drops.vx[j]/4;  // reverse velocity with damping
+                drops.x[j] += drops.vx[j];
               }
-              drops[j].col = sourcedrop*2;
-              drops[j].colIndex = 5;           // bouncing
+              drops.life[j] = sourcedrop*2;
+              drops.user[j] = 5;               // bouncing
             }
           }
         }
@@ -3558,7 +3614,7 @@ uint16_t mode_drip(void)
   };
 
   for (int stripNr=0; stripNr<strips; stripNr++)
-    virtualStrip::runStrip(stripNr, &drops[stripNr*maxNumDrops]);
+    virtualStrip::runStrip(stripNr, drops);
 
   return FRAMETIME;
 }
@@ -4872,9 +4928,12 @@ uint16_t mode_2Dfirenoise(void) {               // firenoise2d. By Andrew Tuline
                                                                   CRGB::DarkOrange,CRGB::DarkOrange, CRGB::Orange, CRGB::Orange,
                                                                   CRGB::Yellow,    CRGB::Orange,     CRGB::Yellow, CRGB::Yellow);
 
+  const noiseField *nf = getNoiseField(0, yscale*rows*256/255, strip.now/4, xscale<<8);
+  if (!nf) return mode_static(); //allocation failed
+
   for (int j=0; j < cols; j++) {
     for (int i=0; i < rows; i++) {
-      indexx = inoise8(j*yscale*rows/255, i*xscale+strip.now/4);                                               // We're moving along our Perlin map.
+      indexx = nf->at(j, i);                                                                                   // We're moving along our Perlin map.
       SEGMENT.setPixelColorXY(j, i, ColorFromPalette(pal, min(i*(indexx)>>4, 255U), i*255/cols, LINEARBLEND)); // With that value, look up the 8 bit colour palette value and assign it to the current LED.
     } // for i
   } // for j
@@ -4909,24 +4968,67 @@ static const char _data_FX_MODE_2DFRIZZLES[] PROGMEM = "Frizzles@X frequency,Y f
 ///////////////////////////////////////////
 //   2D Cellular Automata Game of life   //
 ///////////////////////////////////////////
-typedef struct ColorCount {
-  CRGB color;
-  int8_t count;
-} colorCount;
+// packed bit grid for cellular automata, 1 bit per cell, rows padded to 32 bit words
+// neighbours of 32 cells are summed at once using bit sliced counters (toroidal wrap)
+typedef struct BitGrid {
+  uint32_t *w;
+  uint16_t cols, rows, stride; // stride: words per row
+
+  BitGrid(uint32_t *words, uint16_t c, uint16_t r) : w(words), cols(c), rows(r), stride((c+31)>>5) {}
+  static size_t bytes(uint16_t c, uint16_t r) { return ((c+31)>>5) * r * sizeof(uint32_t); }
+
+  inline bool get(int x, int y) const { return (w[y*stride + (x>>5)] >> (x&31)) & 1; }
+  inline void set(int x, int y, bool v) { uint32_t &d = w[y*stride + (x>>5)]; uint32_t m = 1U<<(x&31); d = v ? d|m : d&~m; }
+  inline uint32_t *row(int y) const { return w + y*stride; }
+  inline uint32_t lastMask() const { return (cols&31) ? (1U<<(cols&31))-1 : 0xFFFFFFFF; } // valid bits of last word in a row
+  void clear() { memset(w, 0, bytes(cols, rows)); }
+  void copyFrom(const BitGrid &g) { memcpy(w, g.w, bytes(cols, rows)); }
+  bool aliveAt(int x, int y) const { // wrapped neighbour read
+    if (x < 0) x += cols; else if (x >= cols) x -= cols;
+    if (y < 0) y += rows; else if (y >= rows) y -= rows;
+    return get(x, y);
+  }
+
+  // cells at x-1 (dir=-1), x (0) or x+1 (1) for the 32 cells of word k in row r (padding bits are 0)
+  uint32_t shifted(const uint32_t *r, int k, int dir) const {
+    if (dir == 0) return r[k];
+    const bool last = (k == stride-1);
+    if (dir < 0) { // bit i takes cell left of it
+      uint32_t carry = k ? r[k-1]>>31 : (r[stride-1] >> ((cols-1)&31)) & 1;
+      return ((r[k] << 1) | carry) & (last ? lastMask() : 0xFFFFFFFF);
+    }
+    uint32_t carry = (last ? r[0] : r[k+1]) & 1; // bit i takes cell right of it
+    return last ? (r[k] >> 1) | (carry << ((cols-1)&31)) : (r[k] >> 1) | (carry << 31);
+  }
+
+  // bit sliced neighbour count of word k in row y: c0,c1 are count bits 0 and 1, c4 is set for 4 or more
+  void neighbours(int y, int k, uint32_t &c0, uint32_t &c1, uint32_t &c4) const {
+    const uint32_t *r[3] = { row(y ? y-1 : rows-1), row(y), row(y < rows-1 ? y+1 : 0) };
+    c0 = c1 = c4 = 0;
+    for (int j = 0; j < 3; j++) for (int d = -1; d <= 1; d++) {
+      if (j == 1 && d == 0) continue; // ignore cell itself
+      uint32_t p = shifted(r[j], k, d);
+      uint32_t carry0 = c0 & p; c0 ^= p;
+      uint32_t carry1 = c1 & carry0; c1 ^= carry0;
+      c4 |= carry1;
+    }
+  }
+} bitGrid;
 
 uint16_t mode_2Dgameoflife(void) { // Written by Ewoud Wijma, inspired by https://natureofcode.com/book/chapter-7-cellular-automata/ and https://github.com/DougHaber/nlife-color
   if (!strip.isMatrix) return mode_static(); // not a 2D set-up
 
   const uint16_t cols = SEGMENT.virtualWidth();
   const uint16_t rows = SEGMENT.virtualHeight();
-  const uint16_t dataSize = sizeof(CRGB) * SEGMENT.length();  // using width*height prevents reallocation if mirroring is enabled
+  const size_t   gridSize = bitGrid::bytes(cols, rows); // cell colors live in segment's pixel buffer, data only holds alive bits
   const uint16_t crcBufferLen = 2; //(SEGMENT.width() + SEGMENT.height())*71/100; // roughly sqrt(2)/2 for better repetition detection (Ewowi)
 
-  if (!SEGENV.allocateData(dataSize + sizeof(uint16_t)*crcBufferLen)) return mode_static(); //allocation failed
-  CRGB *prevLeds = reinterpret_cast<CRGB*>(SEGENV.data);
-  uint16_t *crcBuffer = reinterpret_cast<uint16_t*>(SEGENV.data + dataSize); 
+  if (!SEGENV.allocateData(2*gridSize + sizeof(uint16_t)*crcBufferLen, SEG_DATA_COLD)) return mode_static(); //allocation failed
+  bitGrid cells(reinterpret_cast<uint32_t*>(SEGENV.data), cols, rows);
+  bitGrid next(reinterpret_cast<uint32_t*>(SEGENV.data + gridSize), cols, rows);
+  uint16_t *crcBuffer = reinterpret_cast<uint16_t*>(SEGENV.data + 2*gridSize);
 
-  CRGB backgroundColor = SEGCOLOR(1);
+  const uint32_t backgroundColor = SEGCOLOR(1);
 
   if (SEGENV.call == 0 || strip.now - SEGMENT.step > 3000) {
     SEGENV.step = strip.now;
@@ -4934,75 +5036,62 @@ uint16_t mode_2Dgameoflife(void) { // Written by Ewoud Wijma, inspired by https:
     random16_set_seed(millis()>>2); //seed the random generator
 
     //give the leds random state and colors (based on intensity, colors from palette or all posible colors are chosen)
+    cells.clear();
     for (int x = 0; x < cols; x++) for (int y = 0; y < rows; y++) {
       uint8_t state = random8()%2;
       if (state == 0)
         SEGMENT.setPixelColorXY(x,y, backgroundColor);
-      else
+      else {
         SEGMENT.setPixelColorXY(x,y, SEGMENT.color_from_palette(random8(), false, PALETTE_SOLID_WRAP, 255));
+        cells.set(x, y, true);
+      }
     }
-
-    for (int y = 0; y < rows; y++) for (int x = 0; x < cols; x++) prevLeds[XY(x,y)] = CRGB::Black;
     memset(crcBuffer, 0, sizeof(uint16_t)*crcBufferLen);
   } else if (strip.now - SEGENV.step < FRAMETIME_FIXED * (uint32_t)map(SEGMENT.speed,0,255,64,4)) {
     // update only when appropriate time passes (in 42 FPS slots)
     return FRAMETIME;
   }
 
-  //copy previous leds (save previous generation)
-  //NOTE: using lossy getPixelColor() is a benefit as endlessly repeating patterns will eventually fade out causing a reset
-  for (int x = 0; x < cols; x++) for (int y = 0; y < rows; y++) prevLeds[XY(x,y)] = SEGMENT.getPixelColorXY(x,y);
-
-  //calculate new leds
-  for (int x = 0; x < cols; x++) for (int y = 0; y < rows; y++) {
-
-    colorCount colorsCount[9]; // count the different colors in the 3*3 matrix
-    for (int i=0; i<9; i++) colorsCount[i] = {backgroundColor, 0}; // init colorsCount
-
-    // iterate through neighbors and count them and their different colors
-    int neighbors = 0;
-    for (int i = -1; i <= 1; i++) for (int j = -1; j <= 1; j++) { // iterate through 3*3 matrix
-      if (i==0 && j==0) continue; // ignore itself
-      // wrap around segment
-      int16_t xx = x+i, yy = y+j;
-      if (x+i < 0) xx = cols-1; else if (x+i >= cols) xx = 0;
-      if (y+j < 0) yy = rows-1; else if (y+j >= rows) yy = 0;
-
-      uint16_t xy = XY(xx, yy); // previous cell xy to check
-      // count different neighbours and colors
-      if (prevLeds[xy] != backgroundColor) {
-        neighbors++;
-        bool colorFound = false;
-        int k;
-        for (k=0; k<9 && colorsCount[i].count != 0; k++)
-          if (colorsCount[k].color == prevLeds[xy]) {
-            colorsCount[k].count++;
-            colorFound = true;
-          }
-        if (!colorFound) colorsCount[k] = {prevLeds[xy], 1}; //add new color found in the array
+  // calculate CRC16 of current generation
+  uint16_t crc = crc16((const unsigned char*)cells.w, gridSize);
+
+  // Rules of Life, 32 cells at a time
+  // births are applied first as they only need colors of cells alive in this generation (which are not overwritten)
+  for (int y = 0; y < rows; y++) for (int k = 0; k < cells.stride; k++) {
+    uint32_t c0, c1, c4;
+    cells.neighbours(y, k, c0, c1, c4);
+    const uint32_t alive  = cells.row(y)[k];
+    const uint32_t three  = c0 & c1 & ~c4;
+    const uint32_t two    = ~c0 & c1 & ~c4;
+    uint32_t born   = three & ~alive;          // Reproduction
+    uint32_t mutate = two & ~alive;            // Mutation candidates
+    uint32_t live   = (three | two) & alive;   // survivors, Loneliness & Overpopulation die
+
+    for (uint32_t b = born | mutate; b; b &= b-1) {
+      const int bit = __builtin_ctz(b);
+      const int x = (k<<5) + bit;
+      const uint32_t m = 1U << bit;
+      if (born & m) {
+        // find dominant color of 3 alive neighbours and assign it w/ a bit of randomness to avoid "gliders"
+        if (!random8(128)) continue;
+        uint32_t nc[3]; int n = 0;
+        for (int i = -1; i <= 1; i++) for (int j = -1; j <= 1; j++)
+          if ((i || j) && n < 3 && cells.aliveAt(x+i, y+j)) nc[n++] = SEGMENT.getPixelColorXY((x+i+cols)%cols, (y+j+rows)%rows);
+        SEGMENT.setPixelColorXY(x, y, (n > 2 && nc[1] == nc[2]) ? nc[1] : nc[0]);
+      } else {
+        if (random8(128)) continue;
+        SEGMENT.setPixelColorXY(x, y, SEGMENT.color_from_palette(random8(), false, PALETTE_SOLID_WRAP, 255));
       }
-    } // i,j
-
-    // Rules of Life
-    uint32_t col = uint32_t(prevLeds[XY(x,y)]) & 0x00FFFFFF;  // uint32_t operator returns RGBA, we want RGBW -> cut off "alpha" byte
-    uint32_t bgc = RGBW32(backgroundColor.r, backgroundColor.g, backgroundColor.b, 0);
-    if      ((col != bgc) && (neighbors <  2)) SEGMENT.setPixelColorXY(x,y, bgc); // Loneliness
-    else if ((col != bgc) && (neighbors >  3)) SEGMENT.setPixelColorXY(x,y, bgc); // Overpopulation
-    else if ((col == bgc) && (neighbors == 3)) {                                  // Reproduction
-      // find dominant color and assign it to a cell
-      colorCount dominantColorCount = {backgroundColor, 0};
-      for (int i=0; i<9 && colorsCount[i].count != 0; i++)
-        if (colorsCount[i].count > dominantColorCount.count) dominantColorCount = colorsCount[i];
-      // assign the dominant color w/ a bit of randomness to avoid "gliders"
-      if (dominantColorCount.count > 0 && random8(128)) SEGMENT.setPixelColorXY(x,y, dominantColorCount.color);
-    } else if ((col == bgc) && (neighbors == 2) && !random8(128)) {               // Mutation
-      SEGMENT.setPixelColorXY(x,y, SEGMENT.color_from_palette(random8(), false, PALETTE_SOLID_WRAP, 255));
-    }
-    // else do nothing!
-  } //x,y
-
-  // calculate CRC16 of leds
-  uint16_t crc = crc16((const unsigned char*)prevLeds, dataSize);
+      live |= m;
+    }
+    next.row(y)[k] = live;
+  } //y,k
+
+  // clear cells that died
+  for (int y = 0; y < rows; y++) for (int k = 0; k < cells.stride; k++)
+    for (uint32_t d = cells.row(y)[k] & ~next.row(y)[k]; d; d &= d-1) SEGMENT.setPixelColorXY((k<<5) + __builtin_ctz(d), y, backgroundColor);
+  cells.copyFrom(next);
+
   // check if we had same CRC and reset if needed
   bool repetition = false;
   for (int i=0; i<crcBufferLen && !repetition; i++) repetition = (crc == crcBuffer[i]); // (Ewowi)
@@ -5327,10 +5416,12 @@ uint16_t mode_2Dnoise(void) {                  // By Andrew Tuline
   const uint16_t rows = SEGMENT.virtualHeight();
 
   const uint16_t scale  = SEGMENT.intensity+2;
+  const noiseField *nf = getNoiseField(0, scale<<8, 0, scale<<8, uint16_t(strip.now / (16 - SEGMENT.speed/16)));
+  if (!nf) return mode_static(); //allocation failed
 
   for (int y = 0; y < rows; y++) {
     for (int x = 0; x < cols; x++) {
-      uint8_t pixelHue8 = inoise8(x * scale, y * scale, millis() / (16 - SEGMENT.speed/16));
+      uint8_t pixelHue8 = nf->at(x, y);
       SEGMENT.setPixelColorXY(x, y, ColorFromPalette(SEGPALETTE, pixelHue8));
     }
   }
@@ -5416,12 +5507,16 @@ uint16_t mode_2DPolarLights(void) {        // By: Kostyantyn Matviyevskyy  https
   uint16_t _scale = map(SEGMENT.intensity, 0, 255, 30, adjScale);
   byte _speed = map(SEGMENT.speed, 0, 255, 128, 16);
 
+  // noise is sampled at start of frame (per pixel step offsets are well below noise resolution)
+  const noiseField *nf = getNoiseField(SEGENV.step%2, _scale<<8, SEGENV.step%16, 16<<8, uint16_t(SEGENV.step / _speed));
+  if (!nf) return mode_static(); //allocation failed
+  SEGENV.step += cols * rows;
+
   for (int x = 0; x < cols; x++) {
     for (int y = 0; y < rows; y++) {
-      SEGENV.step++;
       SEGMENT.setPixelColorXY(x, y, ColorFromPalette(auroraPalette,
                                       qsub8(
-                                        inoise8((SEGENV.step%2) + x * _scale, y * 16 + SEGENV.step % 16, SEGENV.step / _speed),
+                                        nf->at(x, y),
                                         fabsf((float)rows / 2.0f - (float)y) * adjustHeight)));
     }
   }
@@ -5527,7 +5622,7 @@ uint16_t mode_2DSunradiation(void) {                   // By: ldirko https://edi
   const uint16_t cols = SEGMENT.virtualWidth();
   const uint16_t rows = SEGMENT.virtualHeight();
 
-  if (!SEGENV.allocateData(sizeof(byte)*(cols+2)*(rows+2))) return mode_static(); //allocation failed
+  if (!SEGENV.allocateData(sizeof(byte)*(cols+2)*(rows+2), SEG_DATA_COLD)) return mode_static(); //allocation failed
   byte *bump = reinterpret_cast<byte*>(SEGENV.data);
 
   if (SEGENV.call == 0) {
@@ -5731,38 +5826,34 @@ uint16_t mode_2Dghostrider(void) {
   const uint16_t cols = SEGMENT.virtualWidth();
   const uint16_t rows = SEGMENT.virtualHeight();
 
-  typedef struct Lighter {
-    int16_t  gPosX;
-    int16_t  gPosY;
-    uint16_t gAngle;
+  typedef struct Rider {
+    int32_t  gPosX;     // fixed point pixels
+    int32_t  gPosY;
+    uint16_t gAngle;    // 65536 is a full turn
     int8_t   angleSpeed;
-    uint16_t lightersPosX[LIGHTERS_AM];
-    uint16_t lightersPosY[LIGHTERS_AM];
-    uint16_t Angle[LIGHTERS_AM];
-    uint16_t time[LIGHTERS_AM];
-    bool     reg[LIGHTERS_AM];
-    int8_t   Vspeed;
-  } lighter_t;
+  } rider_t;
 
-  if (!SEGENV.allocateData(sizeof(lighter_t))) return mode_static(); //allocation failed
-  lighter_t *lighter = reinterpret_cast<lighter_t*>(SEGENV.data);
+  // lighters are particles (life is time + 1), the rider itself is the last particle
+  ParticleSystem lighters;
+  if (!lighters.setup(LIGHTERS_AM + 1, true, sizeof(rider_t))) return mode_static(); //allocation failed
+  rider_t *rider = reinterpret_cast<rider_t*>(lighters.extra);
 
   const size_t maxLighters = min(cols + rows, LIGHTERS_AM);
+  const int32_t riderSpeed   = PS_ONE / 2;
+  const int32_t lighterSpeed = PS_ONE * 7 / 10;
+  const int16_t deg = 182; // 65536 / 360
 
-  if (SEGENV.aux0 != cols || SEGENV.aux1 != rows) {
+  if (SEGENV.aux0 != cols || SEGENV.aux1 != rows || lighters.fresh) {
     SEGENV.aux0 = cols;
     SEGENV.aux1 = rows;
     random16_set_seed(strip.now);
-    lighter->angleSpeed = random8(0,20) - 10;
-    lighter->gAngle = random16();
-    lighter->Vspeed = 5;
-    lighter->gPosX = (cols/2) * 10;
-    lighter->gPosY = (rows/2) * 10;
-    for (size_t i = 0; i < maxLighters; i++) {
-      lighter->lightersPosX[i] = lighter->gPosX;
-      lighter->lightersPosY[i] = lighter->gPosY + i;
-      lighter->time[i] = i * 2;
-      lighter->reg[i] = false;
+    rider->angleSpeed = random8(0,20) - 10;
+    rider->gAngle = random16();
+    rider->gPosX = (cols/2) * PS_ONE;
+    rider->gPosY = (rows/2) * PS_ONE;
+    lighters.spawn(LIGHTERS_AM, 0, 0, 0, 0, WHITE);
+    for (size_t i = 0; i < LIGHTERS_AM; i++) {
+      lighters.spawn(i, rider->gPosX, rider->gPosY + i * (PS_ONE/10), 0, 0, 0, i * 2 + 1);
     }
   }
 
@@ -5771,37 +5862,35 @@ uint16_t mode_2Dghostrider(void) {
 
     SEGMENT.fadeToBlackBy((SEGMENT.speed>>2)+64);
 
-    CRGB color = CRGB::White;
-    SEGMENT.wu_pixel(lighter->gPosX * 256 / 10, lighter->gPosY * 256 / 10, color);
+    lighters.x[LIGHTERS_AM] = rider->gPosX;
+    lighters.y[LIGHTERS_AM] = rider->gPosY;
 
-    lighter->gPosX += lighter->Vspeed * sin_t(radians(lighter->gAngle));
-    lighter->gPosY += lighter->Vspeed * cos_t(radians(lighter->gAngle));
-    lighter->gAngle += lighter->angleSpeed;
-    if (lighter->gPosX < 0)               lighter->gPosX = (cols - 1) * 10;
-    if (lighter->gPosX > (cols - 1) * 10) lighter->gPosX = 0;
-    if (lighter->gPosY < 0)               lighter->gPosY = (rows - 1) * 10;
-    if (lighter->gPosY > (rows - 1) * 10) lighter->gPosY = 0;
+    rider->gPosX += (int32_t(sin16_t(rider->gAngle)) * riderSpeed) >> 15;
+    rider->gPosY += (int32_t(cos16_t(rider->gAngle)) * riderSpeed) >> 15;
+    rider->gAngle += rider->angleSpeed * deg;
+    if (rider->gPosX < 0)                   rider->gPosX = (cols - 1) * PS_ONE;
+    if (rider->gPosX > (cols - 1) * PS_ONE) rider->gPosX = 0;
+    if (rider->gPosY < 0)                   rider->gPosY = (rows - 1) * PS_ONE;
+    if (rider->gPosY > (rows - 1) * PS_ONE) rider->gPosY = 0;
     for (size_t i = 0; i < maxLighters; i++) {
-      lighter->time[i] += random8(5, 20);
-      if (lighter->time[i] >= 255 ||
-        (lighter->lightersPosX[i] <= 0) ||
-          (lighter->lightersPosX[i] >= (cols - 1) * 10) ||
-          (lighter->lightersPosY[i] <= 0) ||
-          (lighter->lightersPosY[i] >= (rows - 1) * 10)) {
-        lighter->reg[i] = true;
-      }
-      if (lighter->reg[i]) {
-        lighter->lightersPosY[i] = lighter->gPosY;
-        lighter->lightersPosX[i] = lighter->gPosX;
-        lighter->Angle[i] = lighter->gAngle + random(-10, 10);
-        lighter->time[i] = 0;
-        lighter->reg[i] = false;
+      lighters.life[i] += random8(5, 20);
+      if (lighters.life[i] > 255 ||
+          (lighters.x[i] <= 0) ||
+          (lighters.x[i] >= (cols - 1) * PS_ONE) ||
+          (lighters.y[i] <= 0) ||
+          (lighters.y[i] >= (rows - 1) * PS_ONE)) {
+        // respawn at the rider heading away from it
+        const uint16_t angle = rider->gAngle + random(-10, 10) * deg;
+        lighters.spawn(i, rider->gPosX, rider->gPosY, -((int32_t(sin16_t(angle)) * lighterSpeed) >> 15), -((int32_t(cos16_t(angle)) * lighterSpeed) >> 15), 0, 1);
       } else {
-        lighter->lightersPosX[i] += -7 * sin_t(radians(lighter->Angle[i]));
-        lighter->lightersPosY[i] += -7 * cos_t(radians(lighter->Angle[i]));
+        lighters.x[i] += lighters.vx[i];
+        lighters.y[i] += lighters.vy[i];
       }
-      SEGMENT.wu_pixel(lighter->lightersPosX[i] * 256 / 10, lighter->lightersPosY[i] * 256 / 10, ColorFromPalette(SEGPALETTE, (256 - lighter->time[i])));
+      CRGB c = ColorFromPalette(SEGPALETTE, (256 - (lighters.life[i] - 1)));
+      lighters.color[i] = RGBW32(c.r, c.g, c.b, 0);
     }
+    SEGMENT.drawParticles(lighters, 0, maxLighters, 0, PS_AA);
+    SEGMENT.drawParticles(lighters, LIGHTERS_AM, 1, 0, PS_AA);
     SEGMENT.blur(SEGMENT.intensity>>3);
   }
 
@@ -5929,8 +6018,9 @@ uint16_t mode_2Dscrollingtext(void) {
     case 4: letterWidth = 7; letterHeight =  9; break;
     case 5: letterWidth = 5; letterHeight = 12; break;
   }
+  const int8_t rotate = map(SEGMENT.custom3, 0, 31, -2, 2);
   // letters are rotated
-  if (((SEGMENT.custom3+1)>>3) % 2) {
+  if (rotate == 1 || rotate == -1) {
     rotLH = letterWidth;
     rotLW = letterHeight;
   } else {
@@ -5994,16 +6084,54 @@ uint16_t mode_2Dscrollingtext(void) {
 
   if (!SEGMENT.check2) SEGMENT.fade_out(255 - (SEGMENT.custom1>>4));  // trail
 
-  for (int i = 0; i < numberOfLetters; i++) {
-    int xoffset = int(cols) - int(SEGENV.aux0) + rotLW*i;
-    if (xoffset + rotLW < 0) continue; // don't draw characters off-screen
-    uint32_t col1 = SEGMENT.color_from_palette(SEGENV.aux1, false, PALETTE_SOLID_WRAP, 0);
-    uint32_t col2 = BLACK;
-    if (SEGMENT.check1 && SEGMENT.palette == 0) {
-      col1 = SEGCOLOR(0);
-      col2 = SEGCOLOR(2);
+  // text is rendered into a 1 bit strip bitmap only when text, font or rotation change, scrolling just blits it
+  // (letterWidth*letterHeight identifies font, data is allocated for longest possible text to avoid reallocation)
+  const size_t maxColumns = WLED_MAX_SEGNAME_LEN * 12;
+  if (!SEGENV.allocateData(sizeof(uint32_t) + maxColumns * sizeof(uint16_t))) return mode_static(); //allocation failed
+  uint32_t *textKey = reinterpret_cast<uint32_t*>(SEGENV.data);
+  uint16_t *bitmap  = reinterpret_cast<uint16_t*>(SEGENV.data + sizeof(uint32_t));
+  const uint8_t font[2] = { uint8_t(letterWidth<<4 | letterHeight), uint8_t(rotate+3) };
+  uint32_t key = fnv1a(font, sizeof(font), fnv1a(text, numberOfLetters)); // never 0 (cleared data)
+  if (*textKey != key) {
+    Segment::rasterizeText(text, letterWidth, letterHeight, rotate, bitmap, maxColumns);
+    *textKey = key;
+  }
+
+  uint32_t col1 = SEGMENT.color_from_palette(SEGENV.aux1, false, PALETTE_SOLID_WRAP, 0);
+  uint32_t col2 = BLACK;
+  if (SEGMENT.check1 && SEGMENT.palette == 0) {
+    col1 = SEGCOLOR(0);
+    col2 = SEGCOLOR(2);
+  }
+  // gradient runs along character rows (as drawCharacter() does)
+  CRGBPalette16 grad = CRGBPalette16(CRGB(col1), col2 ? CRGB(col2) : CRGB(col1));
+  uint32_t rowColor[12];
+  for (int i = 0; i < letterHeight; i++) {
+    CRGB c = ColorFromPalette(grad, (i+1)*255/letterHeight, 255, NOBLEND);
+    rowColor[i] = RGBW32(c.r, c.g, c.b, 0);
+  }
+
+  const int xstart = int(cols) - int(SEGENV.aux0); // bitmap column 0 on screen
+  const int xend   = min((int)cols, xstart + min(width, (int)maxColumns));
+  for (int x = max(0, xstart); x < xend; x++) {
+    const int bx = x - xstart;
+    uint16_t bits = bitmap[bx];
+    if (!bits) continue;
+    const int lx = bx % rotLW; // column within character cell
+    for (int r = 0; bits; r++, bits >>= 1) {
+      if (!(bits & 1)) continue;
+      const int y = yoffset + r;
+      if (y < 0 || y >= rows) continue; // drawing off-screen
+      int i; // character row for gradient
+      switch (rotate) {
+        case -1: i = (letterHeight-1) - lx; break;
+        case -2:
+        case  2: i = (letterHeight-1) - r;  break;
+        case  1: i = lx;                    break;
+        default: i = r;                     break;
+      }
+      SEGMENT.setPixelColorXY(x, y, rowColor[i]);
     }
-    SEGMENT.drawCharacter(text[i], xoffset, yoffset, letterWidth, letterHeight, col1, col2, map(SEGMENT.custom3, 0, 31, -2, 2));
   }
 
   return FRAMETIME;
@@ -6067,6 +6195,8 @@ static const char _data_FX_MODE_2DDRIFTROSE[] PROGMEM = "Drift Rose@Fade,Blur;;;
     // add support for no audio data
     um_data = simulateSound(SEGMENT.soundSim);
   }
+
+  effects below use getAudioData() which does the same using a cached handle
 */
 
 
@@ -6084,6 +6214,24 @@ static const char _data_FX_MODE_2DDRIFTROSE[] PROGMEM = "Drift Rose@Fade,Blur;;;
 //#define MAX_FREQUENCY   5120
 //#define MAX_FREQ_LOG10  3.71f
 
+// AudioReactive data (or simulated sound if not available) without polling all usermods every frame
+// version (if requested) changes whenever new audio data is available
+static um_data_t* getAudioData(uint8_t simulationId, uint32_t *version = nullptr) {
+  static um_handle_t *handle = usermods.getUMHandle(USERMOD_ID_AUDIOREACTIVE); // resolved on first use, stays valid
+  static uint32_t simVersion = 0;
+  um_data_t *um_data;
+  if (handle && handle->data) {
+    if (version) *version = handle->version;
+    return handle->data;
+  }
+  if ((!handle || !handle->published) && usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
+    if (version) *version = ++simVersion; // a provider that does not publish may change on every call
+    return um_data;
+  }
+  if (version) *version = strip.getFrameCount(); // simulation changes once per frame
+  return simulateSound(simulationId);
+}
+
 
 /////////////////////////////////
 //     * Ripple Peak           //
@@ -6097,11 +6245,7 @@ uint16_t mode_ripplepeak(void) {                // * Ripple peak. By Andrew Tuli
   if (!SEGENV.allocateData(dataSize)) return mode_static(); //allocation failed
   Ripple* ripples = reinterpret_cast<Ripple*>(SEGENV.data);
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   uint8_t samplePeak    = *(uint8_t*)um_data->u_data[3];
   #ifdef ESP32
   float   FFT_MajorPeak = *(float*)  um_data->u_data[4];
@@ -6189,11 +6333,7 @@ uint16_t mode_2DSwirl(void) {
   uint8_t nj = (cols - 1) - j;
   uint16_t ms = millis();
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   volumeSmth  = *(float*)   um_data->u_data[0]; //ewowi: use instead of sampleAvg???
   int16_t volumeRaw   = *(int16_t*) um_data->u_data[1];
 
@@ -6219,11 +6359,7 @@ uint16_t mode_2DWaverly(void) {
   const uint16_t cols = SEGMENT.virtualWidth();
   const uint16_t rows = SEGMENT.virtualHeight();
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   volumeSmth  = *(float*)   um_data->u_data[0];
 
   SEGMENT.fadeToBlackBy(SEGMENT.speed);
@@ -6272,11 +6408,7 @@ uint16_t mode_gravcenter(void) {                // Gravcenter. By Andrew Tuline.
   if (!SEGENV.allocateData(dataSize)) return mode_static(); //allocation failed
   Gravity* gravcen = reinterpret_cast<Gravity*>(SEGENV.data);
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   volumeSmth  = *(float*)  um_data->u_data[0];
 
   //SEGMENT.fade_out(240);
@@ -6321,11 +6453,7 @@ uint16_t mode_gravcentric(void) {                     // Gravcentric. By Andrew
   if (!SEGENV.allocateData(dataSize)) return mode_static();     //allocation failed
   Gravity* gravcen = reinterpret_cast<Gravity*>(SEGENV.data);
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   volumeSmth  = *(float*)  um_data->u_data[0];
 
   // printUmData();
@@ -6373,11 +6501,7 @@ uint16_t mode_gravimeter(void) {                // Gravmeter. By Andrew Tuline.
   if (!SEGENV.allocateData(dataSize)) return mode_static(); //allocation failed
   Gravity* gravcen = reinterpret_cast<Gravity*>(SEGENV.data);
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   volumeSmth  = *(float*)  um_data->u_data[0];
 
   //SEGMENT.fade_out(240);
@@ -6415,11 +6539,7 @@ static const char _data_FX_MODE_GRAVIMETER[] PROGMEM = "Gravimeter@Rate of fall,
 //////////////////////
 uint16_t mode_juggles(void) {                   // Juggles. By Andrew Tuline.
   if (SEGLEN == 1) return mode_static();
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   volumeSmth   = *(float*)  um_data->u_data[0];
 
   SEGMENT.fade_out(224); // 6.25%
@@ -6441,11 +6561,7 @@ uint16_t mode_matripix(void) {                  // Matripix. By Andrew Tuline.
   if (SEGLEN == 1) return mode_static();
   // even with 1D effect we have to take logic for 2D segments for allocation as fill_solid() fills whole segment
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   int16_t volumeRaw    = *(int16_t*)um_data->u_data[1];
 
   if (SEGENV.call == 0) {
@@ -6473,11 +6589,7 @@ uint16_t mode_midnoise(void) {                  // Midnoise. By Andrew Tuline.
   if (SEGLEN == 1) return mode_static();
 // Changing xdist to SEGENV.aux0 and ydist to SEGENV.aux1.
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   volumeSmth   = *(float*)  um_data->u_data[0];
 
   SEGMENT.fade_out(SEGMENT.speed);
@@ -6512,11 +6624,7 @@ uint16_t mode_noisefire(void) {                 // Noisefire. By Andrew Tuline.
                                       CRGB::DarkOrange, CRGB::DarkOrange, CRGB::Orange,  CRGB::Orange,
                                       CRGB::Yellow,     CRGB::Orange,     CRGB::Yellow,  CRGB::Yellow);
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   volumeSmth   = *(float*)  um_data->u_data[0];
 
   if (SEGENV.call == 0) SEGMENT.fill(BLACK);
@@ -6540,11 +6648,7 @@ static const char _data_FX_MODE_NOISEFIRE[] PROGMEM = "Noisefire@!,!;;;1v;m12=2,
 ///////////////////////
 uint16_t mode_noisemeter(void) {                // Noisemeter. By Andrew Tuline.
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   volumeSmth   = *(float*)  um_data->u_data[0];
   int16_t volumeRaw    = *(int16_t*)um_data->u_data[1];
 
@@ -6581,11 +6685,7 @@ uint16_t mode_pixelwave(void) {                 // Pixelwave. By Andrew Tuline.
     SEGMENT.fill(BLACK);
   }
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   int16_t volumeRaw    = *(int16_t*)um_data->u_data[1];
 
   uint8_t secondHand = micros()/(256-SEGMENT.speed)/500+1 % 16;
@@ -6617,11 +6717,7 @@ uint16_t mode_plasmoid(void) {                  // Plasmoid. By Andrew Tuline.
   if (!SEGENV.allocateData(sizeof(plasphase))) return mode_static(); //allocation failed
   Plasphase* plasmoip = reinterpret_cast<Plasphase*>(SEGENV.data);
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   volumeSmth   = *(float*)  um_data->u_data[0];
 
   SEGMENT.fadeToBlackBy(32);
@@ -6656,11 +6752,7 @@ uint16_t mode_puddlepeak(void) {                // Puddlepeak. By Andrew Tuline.
   uint8_t fadeVal = map(SEGMENT.speed,0,255, 224, 254);
   uint16_t pos = random(SEGLEN);                          // Set a random starting position.
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   uint8_t samplePeak = *(uint8_t*)um_data->u_data[3];
   uint8_t *maxVol    =  (uint8_t*)um_data->u_data[6];
   uint8_t *binNum    =  (uint8_t*)um_data->u_data[7];
@@ -6701,11 +6793,7 @@ uint16_t mode_puddles(void) {                   // Puddles. By Andrew Tuline.
 
   SEGMENT.fade_out(fadeVal);
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   int16_t volumeRaw    = *(int16_t*)um_data->u_data[1];
 
   if (volumeRaw > 1) {
@@ -6731,13 +6819,14 @@ uint16_t mode_pixels(void) {                    // Pixels. By Andrew Tuline.
   if (!SEGENV.allocateData(32*sizeof(uint8_t))) return mode_static(); //allocation failed
   uint8_t *myVals = reinterpret_cast<uint8_t*>(SEGENV.data); // Used to store a pile of samples because WLED frame rate and WLED sample rate are not synchronized. Frame rate is too low.
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  uint32_t audioVersion;
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim, &audioVersion);
   float   volumeSmth   = *(float*)  um_data->u_data[0];
 
-  myVals[millis()%32] = volumeSmth;    // filling values semi randomly
+  if (SEGENV.aux1 != (uint16_t)audioVersion) { // only store new samples
+    SEGENV.aux1 = audioVersion;
+    myVals[millis()%32] = volumeSmth;  // filling values semi randomly
+  }
 
   SEGMENT.fade_out(64+(SEGMENT.speed>>1));
 
@@ -6763,11 +6852,7 @@ uint16_t mode_blurz(void) {                    // Blurz. By Andrew Tuline.
   if (SEGLEN == 1) return mode_static();
   // even with 1D effect we have to take logic for 2D segments for allocation as fill_solid() fills whole segment
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   uint8_t *fftResult = (uint8_t*)um_data->u_data[2];
 
   if (SEGENV.call == 0) {
@@ -6800,11 +6885,7 @@ uint16_t mode_DJLight(void) {                   // Written by ??? Adapted by Wil
   if (SEGLEN == 1) return mode_static();
   const int mid = SEGLEN / 2;
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   uint8_t *fftResult = (uint8_t*)um_data->u_data[2];
 
   if (SEGENV.call == 0) {
@@ -6835,11 +6916,7 @@ uint16_t mode_freqmap(void) {                   // Map FFT_MajorPeak to SEGLEN.
   // Start frequency = 60 Hz and log10(60) = 1.78
   // End frequency = MAX_FREQUENCY in Hz and lo10(MAX_FREQUENCY) = MAX_FREQ_LOG10
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float FFT_MajorPeak = *(float*)um_data->u_data[4];
   float my_magnitude  = *(float*)um_data->u_data[5] / 4.0f;
   if (FFT_MajorPeak < 1) FFT_MajorPeak = 1;                                         // log10(0) is "forbidden" (throws exception)
@@ -6869,11 +6946,7 @@ static const char _data_FX_MODE_FREQMAP[] PROGMEM = "Freqmap@Fade rate,Starting
 ///////////////////////
 uint16_t mode_freqmatrix(void) {                // Freqmatrix. By Andreas Pleschung.
   if (SEGLEN == 1) return mode_static();
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float FFT_MajorPeak = *(float*)um_data->u_data[4];
   float volumeSmth    = *(float*)um_data->u_data[0];
 
@@ -6927,11 +7000,7 @@ static const char _data_FX_MODE_FREQMATRIX[] PROGMEM = "Freqmatrix@Speed,Sound e
 //  SEGMENT.speed select faderate
 //  SEGMENT.intensity select colour index
 uint16_t mode_freqpixels(void) {                // Freqpixel. By Andrew Tuline.
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float FFT_MajorPeak = *(float*)um_data->u_data[4];
   float my_magnitude  = *(float*)um_data->u_data[5] / 16.0f;
   if (FFT_MajorPeak < 1) FFT_MajorPeak = 1.0f; // log10(0) is "forbidden" (throws exception)
@@ -6974,11 +7043,7 @@ static const char _data_FX_MODE_FREQPIXELS[] PROGMEM = "Freqpixels@Fade rate,Sta
 // Depending on the music stream you have you might find it useful to change the frequency mapping.
 uint16_t mode_freqwave(void) {                  // Freqwave. By Andreas Pleschung.
   if (SEGLEN == 1) return mode_static();
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float FFT_MajorPeak = *(float*)um_data->u_data[4];
   float volumeSmth    = *(float*)um_data->u_data[0];
 
@@ -7035,11 +7100,7 @@ uint16_t mode_gravfreq(void) {                  // Gravfreq. By Andrew Tuline.
   if (!SEGENV.allocateData(dataSize)) return mode_static(); //allocation failed
   Gravity* gravcen = reinterpret_cast<Gravity*>(SEGENV.data);
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   FFT_MajorPeak = *(float*)um_data->u_data[4];
   float   volumeSmth    = *(float*)um_data->u_data[0];
   if (FFT_MajorPeak < 1) FFT_MajorPeak = 1;                                         // log10(0) is "forbidden" (throws exception)
@@ -7083,11 +7144,7 @@ static const char _data_FX_MODE_GRAVFREQ[] PROGMEM = "Gravfreq@Rate of fall,Sens
 //////////////////////
 uint16_t mode_noisemove(void) {                 // Noisemove.    By: Andrew Tuline
   if (SEGLEN == 1) return mode_static();
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   uint8_t *fftResult = (uint8_t*)um_data->u_data[2];
 
   int fadeoutDelay = (256 - SEGMENT.speed) / 96;
@@ -7110,11 +7167,7 @@ static const char _data_FX_MODE_NOISEMOVE[] PROGMEM = "Noisemove@Speed of perlin
 //////////////////////
 uint16_t mode_rocktaves(void) {                 // Rocktaves. Same note from each octave is same colour.    By: Andrew Tuline
   if (SEGLEN == 1) return mode_static();
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   float   FFT_MajorPeak = *(float*)  um_data->u_data[4];
   float   my_magnitude  = *(float*)   um_data->u_data[5] / 16.0f;
 
@@ -7152,11 +7205,7 @@ static const char _data_FX_MODE_ROCKTAVES[] PROGMEM = "Rocktaves@;!,!;!;1f;m12=1
 uint16_t mode_waterfall(void) {                   // Waterfall. By: Andrew Tuline
   if (SEGLEN == 1) return mode_static();
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   uint8_t samplePeak    = *(uint8_t*)um_data->u_data[3];
   float   FFT_MajorPeak = *(float*)  um_data->u_data[4];
   uint8_t *maxVol       =  (uint8_t*)um_data->u_data[6];
@@ -7210,11 +7259,7 @@ uint16_t mode_2DGEQ(void) { // By Will Tatam. Code reduction by Ewoud Wijma.
   if (!SEGENV.allocateData(cols*sizeof(uint16_t))) return mode_static(); //allocation failed
   uint16_t *previousBarHeight = reinterpret_cast<uint16_t*>(SEGENV.data); //array of previous bar heights per frequency band
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   uint8_t *fftResult = (uint8_t*)um_data->u_data[2];
 
   if (SEGENV.call == 0) for (int i=0; i<cols; i++) previousBarHeight[i] = 0;
@@ -7273,11 +7318,7 @@ uint16_t mode_2DFunkyPlank(void) {              // Written by ??? Adapted by Wil
     bandInc = (NUMB_BANDS / cols);
   }
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    // add support for no audio
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   uint8_t *fftResult = (uint8_t*)um_data->u_data[2];
 
   if (SEGENV.call == 0) {
@@ -7362,10 +7403,7 @@ uint16_t mode_2DAkemi(void) {
   const float lightFactor  = 0.15f;
   const float normalFactor = 0.4f;
 
-  um_data_t *um_data;
-  if (!usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
-    um_data = simulateSound(SEGMENT.soundSim);
-  }
+  um_data_t *um_data = getAudioData(SEGMENT.soundSim);
   uint8_t *fftResult = (uint8_t*)um_data->u_data[2];
   float base = fftResult[0]/255.0f;
 
@@ -7480,7 +7518,7 @@ uint16_t mode_2Dsoap() {
   const uint16_t rows = SEGMENT.virtualHeight();
 
   const size_t dataSize = SEGMENT.width() * SEGMENT.height() * sizeof(uint8_t); // prevent reallocation if mirrored or grouped
-  if (!SEGENV.allocateData(dataSize + sizeof(uint32_t)*3)) return mode_static(); //allocation failed
+  if (!SEGENV.allocateData(dataSize + sizeof(uint32_t)*3, SEG_DATA_COLD)) return mode_static(); //allocation failed
 
   uint8_t  *noise3d   = reinterpret_cast<uint8_t*>(SEGENV.data);
   uint32_t *noise32_x = reinterpret_cast<uint32_t*>(SEGENV.data + dataSize);
@@ -7598,7 +7636,7 @@ uint16_t mode_2Doctopus() {
   } map_t;
 
   const size_t dataSize = SEGMENT.width() * SEGMENT.height() * sizeof(map_t); // prevent reallocation if mirrored or grouped
-  if (!SEGENV.allocateData(dataSize + 2)) return mode_static(); //allocation failed
+  if (!SEGENV.allocateData(dataSize + 2, SEG_DATA_COLD)) return mode_static(); //allocation failed
 
   map_t *rMap = reinterpret_cast<map_t*>(SEGENV.data);
   uint8_t *offsX = reinterpret_cast<uint8_t*>(SEGENV.data + dataSize);
@@ -7664,240 +7702,268 @@ static const char _data_FX_MODE_2DWAVINGCELL[] PROGMEM = "Waving Cell@!,,Amplitu
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // mode data
+
+// effect registry: all built-in effects ordered by id, each one is
+// FX(id, function, data), FX_2D(), FX_AUDIO() or FX_2D_AUDIO() (included depending on build flags) or RSVD(id) (unused id)
+#define WLED_EFFECT_LIST(FX, FX_2D, FX_AUDIO, FX_2D_AUDIO, RSVD) \
+  FX(FX_MODE_STATIC, mode_static, _data_FX_MODE_STATIC)                                              \
+  FX(FX_MODE_BLINK, mode_blink, _data_FX_MODE_BLINK)                                                 \
+  FX(FX_MODE_BREATH, mode_breath, _data_FX_MODE_BREATH)                                              \
+  FX(FX_MODE_COLOR_WIPE, mode_color_wipe, _data_FX_MODE_COLOR_WIPE)                                  \
+  FX(FX_MODE_COLOR_WIPE_RANDOM, mode_color_wipe_random, _data_FX_MODE_COLOR_WIPE_RANDOM)             \
+  FX(FX_MODE_RANDOM_COLOR, mode_random_color, _data_FX_MODE_RANDOM_COLOR)                            \
+  FX(FX_MODE_COLOR_SWEEP, mode_color_sweep, _data_FX_MODE_COLOR_SWEEP)                               \
+  FX(FX_MODE_DYNAMIC, mode_dynamic, _data_FX_MODE_DYNAMIC)                                           \
+  FX(FX_MODE_RAINBOW, mode_rainbow, _data_FX_MODE_RAINBOW)                                           \
+  FX(FX_MODE_RAINBOW_CYCLE, mode_rainbow_cycle, _data_FX_MODE_RAINBOW_CYCLE)                         \
+  FX(FX_MODE_SCAN, mode_scan, _data_FX_MODE_SCAN)                                                    \
+  FX(FX_MODE_DUAL_SCAN, mode_dual_scan, _data_FX_MODE_DUAL_SCAN)                                     \
+  FX(FX_MODE_FADE, mode_fade, _data_FX_MODE_FADE)                                                    \
+  FX(FX_MODE_THEATER_CHASE, mode_theater_chase, _data_FX_MODE_THEATER_CHASE)                         \
+  FX(FX_MODE_THEATER_CHASE_RAINBOW, mode_theater_chase_rainbow, _data_FX_MODE_THEATER_CHASE_RAINBOW) \
+  FX(FX_MODE_RUNNING_LIGHTS, mode_running_lights, _data_FX_MODE_RUNNING_LIGHTS)                      \
+  FX(FX_MODE_SAW, mode_saw, _data_FX_MODE_SAW)                                                       \
+  FX(FX_MODE_TWINKLE, mode_twinkle, _data_FX_MODE_TWINKLE)                                           \
+  FX(FX_MODE_DISSOLVE, mode_dissolve, _data_FX_MODE_DISSOLVE)                                        \
+  FX(FX_MODE_DISSOLVE_RANDOM, mode_dissolve_random, _data_FX_MODE_DISSOLVE_RANDOM)                   \
+  FX(FX_MODE_SPARKLE, mode_sparkle, _data_FX_MODE_SPARKLE)                                           \
+  FX(FX_MODE_FLASH_SPARKLE, mode_flash_sparkle, _data_FX_MODE_FLASH_SPARKLE)                         \
+  FX(FX_MODE_HYPER_SPARKLE, mode_hyper_sparkle, _data_FX_MODE_HYPER_SPARKLE)                         \
+  FX(FX_MODE_STROBE, mode_strobe, _data_FX_MODE_STROBE)                                              \
+  FX(FX_MODE_STROBE_RAINBOW, mode_strobe_rainbow, _data_FX_MODE_STROBE_RAINBOW)                      \
+  FX(FX_MODE_MULTI_STROBE, mode_multi_strobe, _data_FX_MODE_MULTI_STROBE)                            \
+  FX(FX_MODE_BLINK_RAINBOW, mode_blink_rainbow, _data_FX_MODE_BLINK_RAINBOW)                         \
+  FX(FX_MODE_ANDROID, mode_android, _data_FX_MODE_ANDROID)                                           \
+  FX(FX_MODE_CHASE_COLOR, mode_chase_color, _data_FX_MODE_CHASE_COLOR)                               \
+  FX(FX_MODE_CHASE_RANDOM, mode_chase_random, _data_FX_MODE_CHASE_RANDOM)                            \
+  FX(FX_MODE_CHASE_RAINBOW, mode_chase_rainbow, _data_FX_MODE_CHASE_RAINBOW)                         \
+  FX(FX_MODE_CHASE_FLASH, mode_chase_flash, _data_FX_MODE_CHASE_FLASH)                               \
+  FX(FX_MODE_CHASE_FLASH_RANDOM, mode_chase_flash_random, _data_FX_MODE_CHASE_FLASH_RANDOM)          \
+  FX(FX_MODE_CHASE_RAINBOW_WHITE, mode_chase_rainbow_white, _data_FX_MODE_CHASE_RAINBOW_WHITE)       \
+  FX(FX_MODE_COLORFUL, mode_colorful, _data_FX_MODE_COLORFUL)                                        \
+  FX(FX_MODE_TRAFFIC_LIGHT, mode_traffic_light, _data_FX_MODE_TRAFFIC_LIGHT)                         \
+  FX(FX_MODE_COLOR_SWEEP_RANDOM, mode_color_sweep_random, _data_FX_MODE_COLOR_SWEEP_RANDOM)          \
+  FX(FX_MODE_RUNNING_COLOR, mode_running_color, _data_FX_MODE_RUNNING_COLOR)                         \
+  FX(FX_MODE_AURORA, mode_aurora, _data_FX_MODE_AURORA)                                              \
+  FX(FX_MODE_RUNNING_RANDOM, mode_running_random, _data_FX_MODE_RUNNING_RANDOM)                      \
+  FX(FX_MODE_LARSON_SCANNER, mode_larson_scanner, _data_FX_MODE_LARSON_SCANNER)                      \
+  FX(FX_MODE_COMET, mode_comet, _data_FX_MODE_COMET)                                                 \
+  FX(FX_MODE_FIREWORKS, mode_fireworks, _data_FX_MODE_FIREWORKS)                                     \
+  FX(FX_MODE_RAIN, mode_rain, _data_FX_MODE_RAIN)                                                    \
+  FX(FX_MODE_TETRIX, mode_tetrix, _data_FX_MODE_TETRIX)                                              \
+  FX(FX_MODE_FIRE_FLICKER, mode_fire_flicker, _data_FX_MODE_FIRE_FLICKER)                            \
+  FX(FX_MODE_GRADIENT, mode_gradient, _data_FX_MODE_GRADIENT)                                        \
+  FX(FX_MODE_LOADING, mode_loading, _data_FX_MODE_LOADING)                                           \
+  FX(FX_MODE_ROLLINGBALLS, rolling_balls, _data_FX_MODE_ROLLINGBALLS)                                \
+  FX(FX_MODE_FAIRY, mode_fairy, _data_FX_MODE_FAIRY)                                                 \
+  FX(FX_MODE_TWO_DOTS, mode_two_dots, _data_FX_MODE_TWO_DOTS)                                        \
+  FX(FX_MODE_FAIRYTWINKLE, mode_fairytwinkle, _data_FX_MODE_FAIRYTWINKLE)                            \
+  FX(FX_MODE_RUNNING_DUAL, mode_running_dual, _data_FX_MODE_RUNNING_DUAL)                            \
+  RSVD(53)                                                                                           \
+  FX(FX_MODE_TRICOLOR_CHASE, mode_tricolor_chase, _data_FX_MODE_TRICOLOR_CHASE)                      \
+  FX(FX_MODE_TRICOLOR_WIPE, mode_tricolor_wipe, _data_FX_MODE_TRICOLOR_WIPE)                         \
+  FX(FX_MODE_TRICOLOR_FADE, mode_tricolor_fade, _data_FX_MODE_TRICOLOR_FADE)                         \
+  FX(FX_MODE_LIGHTNING, mode_lightning, _data_FX_MODE_LIGHTNING)                                     \
+  FX(FX_MODE_ICU, mode_icu, _data_FX_MODE_ICU)                                                       \
+  FX(FX_MODE_MULTI_COMET, mode_multi_comet, _data_FX_MODE_MULTI_COMET)                               \
+  FX(FX_MODE_DUAL_LARSON_SCANNER, mode_dual_larson_scanner, _data_FX_MODE_DUAL_LARSON_SCANNER)       \
+  FX(FX_MODE_RANDOM_CHASE, mode_random_chase, _data_FX_MODE_RANDOM_CHASE)                            \
+  FX(FX_MODE_OSCILLATE, mode_oscillate, _data_FX_MODE_OSCILLATE)                                     \
+  FX(FX_MODE_PRIDE_2015, mode_pride_2015, _data_FX_MODE_PRIDE_2015)                                  \
+  FX(FX_MODE_JUGGLE, mode_juggle, _data_FX_MODE_JUGGLE)                                              \
+  FX(FX_MODE_PALETTE, mode_palette, _data_FX_MODE_PALETTE)                                           \
+  FX(FX_MODE_FIRE_2012, mode_fire_2012, _data_FX_MODE_FIRE_2012)                                     \
+  FX(FX_MODE_COLORWAVES, mode_colorwaves, _data_FX_MODE_COLORWAVES)                                  \
+  FX(FX_MODE_BPM, mode_bpm, _data_FX_MODE_BPM)                                                       \
+  FX(FX_MODE_FILLNOISE8, mode_fillnoise8, _data_FX_MODE_FILLNOISE8)                                  \
+  FX(FX_MODE_NOISE16_1, mode_noise16_1, _data_FX_MODE_NOISE16_1)                                     \
+  FX(FX_MODE_NOISE16_2, mode_noise16_2, _data_FX_MODE_NOISE16_2)                                     \
+  FX(FX_MODE_NOISE16_3, mode_noise16_3, _data_FX_MODE_NOISE16_3)                                     \
+  FX(FX_MODE_NOISE16_4, mode_noise16_4, _data_FX_MODE_NOISE16_4)                                     \
+  FX(FX_MODE_COLORTWINKLE, mode_colortwinkle, _data_FX_MODE_COLORTWINKLE)                            \
+  FX(FX_MODE_LAKE, mode_lake, _data_FX_MODE_LAKE)                                                    \
+  FX(FX_MODE_METEOR, mode_meteor, _data_FX_MODE_METEOR)                                              \
+  FX(FX_MODE_METEOR_SMOOTH, mode_meteor_smooth, _data_FX_MODE_METEOR_SMOOTH)                         \
+  FX(FX_MODE_RAILWAY, mode_railway, _data_FX_MODE_RAILWAY)                                           \
+  FX(FX_MODE_RIPPLE, mode_ripple, _data_FX_MODE_RIPPLE)                                              \
+  FX(FX_MODE_TWINKLEFOX, mode_twinklefox, _data_FX_MODE_TWINKLEFOX)                                  \
+  FX(FX_MODE_TWINKLECAT, mode_twinklecat, _data_FX_MODE_TWINKLECAT)                                  \
+  FX(FX_MODE_HALLOWEEN_EYES, mode_halloween_eyes, _data_FX_MODE_HALLOWEEN_EYES)                      \
+  FX(FX_MODE_STATIC_PATTERN, mode_static_pattern, _data_FX_MODE_STATIC_PATTERN)                      \
+  FX(FX_MODE_TRI_STATIC_PATTERN, mode_tri_static_pattern, _data_FX_MODE_TRI_STATIC_PATTERN)          \
+  FX(FX_MODE_SPOTS, mode_spots, _data_FX_MODE_SPOTS)                                                 \
+  FX(FX_MODE_SPOTS_FADE, mode_spots_fade, _data_FX_MODE_SPOTS_FADE)                                  \
+  FX(FX_MODE_GLITTER, mode_glitter, _data_FX_MODE_GLITTER)                                           \
+  FX(FX_MODE_CANDLE, mode_candle, _data_FX_MODE_CANDLE)                                              \
+  FX(FX_MODE_STARBURST, mode_starburst, _data_FX_MODE_STARBURST)                                     \
+  FX(FX_MODE_EXPLODING_FIREWORKS, mode_exploding_fireworks, _data_FX_MODE_EXPLODING_FIREWORKS)       \
+  FX(FX_MODE_BOUNCINGBALLS, mode_bouncing_balls, _data_FX_MODE_BOUNCINGBALLS)                        \
+  FX(FX_MODE_SINELON, mode_sinelon, _data_FX_MODE_SINELON)                                           \
+  FX(FX_MODE_SINELON_DUAL, mode_sinelon_dual, _data_FX_MODE_SINELON_DUAL)                            \
+  FX(FX_MODE_SINELON_RAINBOW, mode_sinelon_rainbow, _data_FX_MODE_SINELON_RAINBOW)                   \
+  FX(FX_MODE_POPCORN, mode_popcorn, _data_FX_MODE_POPCORN)                                           \
+  FX(FX_MODE_DRIP, mode_drip, _data_FX_MODE_DRIP)                                                    \
+  FX(FX_MODE_PLASMA, mode_plasma, _data_FX_MODE_PLASMA)                                              \
+  FX(FX_MODE_PERCENT, mode_percent, _data_FX_MODE_PERCENT)                                           \
+  FX(FX_MODE_RIPPLE_RAINBOW, mode_ripple_rainbow, _data_FX_MODE_RIPPLE_RAINBOW)                      \
+  FX(FX_MODE_HEARTBEAT, mode_heartbeat, _data_FX_MODE_HEARTBEAT)                                     \
+  FX(FX_MODE_PACIFICA, mode_pacifica, _data_FX_MODE_PACIFICA)                                        \
+  FX(FX_MODE_CANDLE_MULTI, mode_candle_multi, _data_FX_MODE_CANDLE_MULTI)                            \
+  FX(FX_MODE_SOLID_GLITTER, mode_solid_glitter, _data_FX_MODE_SOLID_GLITTER)                         \
+  FX(FX_MODE_SUNRISE, mode_sunrise, _data_FX_MODE_SUNRISE)                                           \
+  FX(FX_MODE_PHASED, mode_phased, _data_FX_MODE_PHASED)                                              \
+  FX(FX_MODE_TWINKLEUP, mode_twinkleup, _data_FX_MODE_TWINKLEUP)                                     \
+  FX(FX_MODE_NOISEPAL, mode_noisepal, _data_FX_MODE_NOISEPAL)                                        \
+  FX(FX_MODE_SINEWAVE, mode_sinewave, _data_FX_MODE_SINEWAVE)                                        \
+  FX(FX_MODE_PHASEDNOISE, mode_phased_noise, _data_FX_MODE_PHASEDNOISE)                              \
+  FX(FX_MODE_FLOW, mode_flow, _data_FX_MODE_FLOW)                                                    \
+  FX(FX_MODE_CHUNCHUN, mode_chunchun, _data_FX_MODE_CHUNCHUN)                                        \
+  FX(FX_MODE_DANCING_SHADOWS, mode_dancing_shadows, _data_FX_MODE_DANCING_SHADOWS)                   \
+  FX(FX_MODE_WASHING_MACHINE, mode_washing_machine, _data_FX_MODE_WASHING_MACHINE)                   \
+  RSVD(114)                                                                                          \
+  FX(FX_MODE_BLENDS, mode_blends, _data_FX_MODE_BLENDS)                                              \
+  FX(FX_MODE_TV_SIMULATOR, mode_tv_simulator, _data_FX_MODE_TV_SIMULATOR)                            \
+  FX(FX_MODE_DYNAMIC_SMOOTH, mode_dynamic_smooth, _data_FX_MODE_DYNAMIC_SMOOTH)                      \
+  FX_2D(FX_MODE_2DSPACESHIPS, mode_2Dspaceships, _data_FX_MODE_2DSPACESHIPS)                         \
+  FX_2D(FX_MODE_2DCRAZYBEES, mode_2Dcrazybees, _data_FX_MODE_2DCRAZYBEES)                            \
+  FX_2D(FX_MODE_2DGHOSTRIDER, mode_2Dghostrider, _data_FX_MODE_2DGHOSTRIDER)                         \
+  FX_2D(FX_MODE_2DBLOBS, mode_2Dfloatingblobs, _data_FX_MODE_2DBLOBS)                                \
+  FX_2D(FX_MODE_2DSCROLLTEXT, mode_2Dscrollingtext, _data_FX_MODE_2DSCROLLTEXT)                      \
+  FX_2D(FX_MODE_2DDRIFTROSE, mode_2Ddriftrose, _data_FX_MODE_2DDRIFTROSE)                            \
+  FX_2D(FX_MODE_2DDISTORTIONWAVES, mode_2Ddistortionwaves, _data_FX_MODE_2DDISTORTIONWAVES)          \
+  FX_2D(FX_MODE_2DSOAP, mode_2Dsoap, _data_FX_MODE_2DSOAP)                                           \
+  FX_2D(FX_MODE_2DOCTOPUS, mode_2Doctopus, _data_FX_MODE_2DOCTOPUS)                                  \
+  FX_2D(FX_MODE_2DWAVINGCELL, mode_2Dwavingcell, _data_FX_MODE_2DWAVINGCELL)                         \
+  FX_AUDIO(FX_MODE_PIXELS, mode_pixels, _data_FX_MODE_PIXELS)                                        \
+  FX_AUDIO(FX_MODE_PIXELWAVE, mode_pixelwave, _data_FX_MODE_PIXELWAVE)                               \
+  FX_AUDIO(FX_MODE_JUGGLES, mode_juggles, _data_FX_MODE_JUGGLES)                                     \
+  FX_AUDIO(FX_MODE_MATRIPIX, mode_matripix, _data_FX_MODE_MATRIPIX)                                  \
+  FX_AUDIO(FX_MODE_GRAVIMETER, mode_gravimeter, _data_FX_MODE_GRAVIMETER)                            \
+  FX_AUDIO(FX_MODE_PLASMOID, mode_plasmoid, _data_FX_MODE_PLASMOID)                                  \
+  FX_AUDIO(FX_MODE_PUDDLES, mode_puddles, _data_FX_MODE_PUDDLES)                                     \
+  FX_AUDIO(FX_MODE_MIDNOISE, mode_midnoise, _data_FX_MODE_MIDNOISE)                                  \
+  FX_AUDIO(FX_MODE_NOISEMETER, mode_noisemeter, _data_FX_MODE_NOISEMETER)                            \
+  FX_AUDIO(FX_MODE_FREQWAVE, mode_freqwave, _data_FX_MODE_FREQWAVE)                                  \
+  FX_AUDIO(FX_MODE_FREQMATRIX, mode_freqmatrix, _data_FX_MODE_FREQMATRIX)                            \
+  FX_2D_AUDIO(FX_MODE_2DGEQ, mode_2DGEQ, _data_FX_MODE_2DGEQ)                                        \
+  FX_AUDIO(FX_MODE_WATERFALL, mode_waterfall, _data_FX_MODE_WATERFALL)                               \
+  FX_AUDIO(FX_MODE_FREQPIXELS, mode_freqpixels, _data_FX_MODE_FREQPIXELS)                            \
+  RSVD(142)                                                                                          \
+  FX_AUDIO(FX_MODE_NOISEFIRE, mode_noisefire, _data_FX_MODE_NOISEFIRE)                               \
+  FX_AUDIO(FX_MODE_PUDDLEPEAK, mode_puddlepeak, _data_FX_MODE_PUDDLEPEAK)                            \
+  FX_AUDIO(FX_MODE_NOISEMOVE, mode_noisemove, _data_FX_MODE_NOISEMOVE)                               \
+  FX_2D(FX_MODE_2DNOISE, mode_2Dnoise, _data_FX_MODE_2DNOISE)                                        \
+  FX(FX_MODE_PERLINMOVE, mode_perlinmove, _data_FX_MODE_PERLINMOVE)                                  \
+  FX_AUDIO(FX_MODE_RIPPLEPEAK, mode_ripplepeak, _data_FX_MODE_RIPPLEPEAK)                            \
+  FX_2D(FX_MODE_2DFIRENOISE, mode_2Dfirenoise, _data_FX_MODE_2DFIRENOISE)                            \
+  FX_2D(FX_MODE_2DSQUAREDSWIRL, mode_2Dsquaredswirl, _data_FX_MODE_2DSQUAREDSWIRL)                   \
+  RSVD(151)                                                                                          \
+  FX_2D(FX_MODE_2DDNA, mode_2Ddna, _data_FX_MODE_2DDNA)                                              \
+  FX_2D(FX_MODE_2DMATRIX, mode_2Dmatrix, _data_FX_MODE_2DMATRIX)                                     \
+  FX_2D(FX_MODE_2DMETABALLS, mode_2Dmetaballs, _data_FX_MODE_2DMETABALLS)                            \
+  FX_AUDIO(FX_MODE_FREQMAP, mode_freqmap, _data_FX_MODE_FREQMAP)                                     \
+  FX_AUDIO(FX_MODE_GRAVCENTER, mode_gravcenter, _data_FX_MODE_GRAVCENTER)                            \
+  FX_AUDIO(FX_MODE_GRAVCENTRIC, mode_gravcentric, _data_FX_MODE_GRAVCENTRIC)                         \
+  FX_AUDIO(FX_MODE_GRAVFREQ, mode_gravfreq, _data_FX_MODE_GRAVFREQ)                                  \
+  FX_AUDIO(FX_MODE_DJLIGHT, mode_DJLight, _data_FX_MODE_DJLIGHT)                                     \
+  FX_2D_AUDIO(FX_MODE_2DFUNKYPLANK, mode_2DFunkyPlank, _data_FX_MODE_2DFUNKYPLANK)                   \
+  RSVD(161)                                                                                          \
+  FX_2D(FX_MODE_2DPULSER, mode_2DPulser, _data_FX_MODE_2DPULSER)                                     \
+  FX_AUDIO(FX_MODE_BLURZ, mode_blurz, _data_FX_MODE_BLURZ)                                           \
+  FX_2D(FX_MODE_2DDRIFT, mode_2DDrift, _data_FX_MODE_2DDRIFT)                                        \
+  FX_2D_AUDIO(FX_MODE_2DWAVERLY, mode_2DWaverly, _data_FX_MODE_2DWAVERLY)                            \
+  FX_2D(FX_MODE_2DSUNRADIATION, mode_2DSunradiation, _data_FX_MODE_2DSUNRADIATION)                   \
+  FX_2D(FX_MODE_2DCOLOREDBURSTS, mode_2DColoredBursts, _data_FX_MODE_2DCOLOREDBURSTS)                \
+  FX_2D(FX_MODE_2DJULIA, mode_2DJulia, _data_FX_MODE_2DJULIA)                                        \
+  RSVD(169)                                                                                          \
+  RSVD(170)                                                                                          \
+  RSVD(171)                                                                                          \
+  FX_2D(FX_MODE_2DGAMEOFLIFE, mode_2Dgameoflife, _data_FX_MODE_2DGAMEOFLIFE)                         \
+  FX_2D(FX_MODE_2DTARTAN, mode_2Dtartan, _data_FX_MODE_2DTARTAN)                                     \
+  FX_2D(FX_MODE_2DPOLARLIGHTS, mode_2DPolarLights, _data_FX_MODE_2DPOLARLIGHTS)                      \
+  FX_2D_AUDIO(FX_MODE_2DSWIRL, mode_2DSwirl, _data_FX_MODE_2DSWIRL)                                  \
+  FX_2D(FX_MODE_2DLISSAJOUS, mode_2DLissajous, _data_FX_MODE_2DLISSAJOUS)                            \
+  FX_2D(FX_MODE_2DFRIZZLES, mode_2DFrizzles, _data_FX_MODE_2DFRIZZLES)                               \
+  FX_2D(FX_MODE_2DPLASMABALL, mode_2DPlasmaball, _data_FX_MODE_2DPLASMABALL)                         \
+  FX(FX_MODE_FLOWSTRIPE, mode_FlowStripe, _data_FX_MODE_FLOWSTRIPE)                                  \
+  FX_2D(FX_MODE_2DHIPHOTIC, mode_2DHiphotic, _data_FX_MODE_2DHIPHOTIC)                               \
+  FX_2D(FX_MODE_2DSINDOTS, mode_2DSindots, _data_FX_MODE_2DSINDOTS)                                  \
+  FX_2D(FX_MODE_2DDNASPIRAL, mode_2DDNASpiral, _data_FX_MODE_2DDNASPIRAL)                            \
+  FX_2D(FX_MODE_2DBLACKHOLE, mode_2DBlackHole, _data_FX_MODE_2DBLACKHOLE)                            \
+  FX(FX_MODE_WAVESINS, mode_wavesins, _data_FX_MODE_WAVESINS)                                        \
+  FX_AUDIO(FX_MODE_ROCKTAVES, mode_rocktaves, _data_FX_MODE_ROCKTAVES)                               \
+  FX_2D_AUDIO(FX_MODE_2DAKEMI, mode_2DAkemi, _data_FX_MODE_2DAKEMI)
+
+// table entries (in flash): effects excluded by build flags become reserved ids, their functions are not linked
+#define FX_ENTRY(id, fn, data) { &fn, data },
+#define FX_NONE(id, ...)       { nullptr, nullptr },
+#ifndef WLED_DISABLE_2D
+  #define FX_ENTRY_2D FX_ENTRY
+#else
+  #define FX_ENTRY_2D FX_NONE
+#endif
+#ifndef WLED_DISABLE_AUDIO_EFFECTS
+  #define FX_ENTRY_AUDIO    FX_ENTRY
+  #define FX_ENTRY_2D_AUDIO FX_ENTRY_2D
+#else
+  #define FX_ENTRY_AUDIO    FX_NONE
+  #define FX_ENTRY_2D_AUDIO FX_NONE
+#endif
+static const effect_t effectTable[] PROGMEM = {
+  WLED_EFFECT_LIST(FX_ENTRY, FX_ENTRY_2D, FX_ENTRY_AUDIO, FX_ENTRY_2D_AUDIO, FX_NONE)
+};
+
+// the table is indexed by id, so make sure the list is in order and complete
+#define FX_ID(id, ...) id,
+static constexpr uint8_t effectIds[] = { WLED_EFFECT_LIST(FX_ID, FX_ID, FX_ID, FX_ID, FX_ID) };
+static constexpr bool effectIdsInOrder(unsigned i = 0) { return i >= MODE_COUNT || (effectIds[i] == i && effectIdsInOrder(i+1)); }
+static_assert(sizeof(effectIds) == MODE_COUNT && effectIdsInOrder(), "WLED_EFFECT_LIST must contain all ids up to MODE_COUNT in order");
+#undef FX_ID
+#undef FX_ENTRY
+#undef FX_NONE
+#undef FX_ENTRY_2D
+#undef FX_ENTRY_AUDIO
+#undef FX_ENTRY_2D_AUDIO
+
 static const char _data_RESERVED[] PROGMEM = "RSVD";
 
-// add (or replace reserved) effect mode and data into vector
+// effect added by usermod (or replacing a reserved id of the built-in table)
+const WS2812FX::mode_data_t *WS2812FX::findModeExt(uint8_t id) {
+  for (const mode_data_t &e : _modeExt) if (e._id == id) return &e;
+  return nullptr;
+}
+
+WS2812FX::mode_ptr WS2812FX::getModeFn(uint8_t id) {
+  if (id < MODE_COUNT) {
+    mode_ptr fn = (mode_ptr) pgm_read_ptr(&effectTable[id].fn);
+    if (fn) return fn;
+  }
+  const mode_data_t *e = findModeExt(id);
+  return e ? e->_fcn : &mode_static;
+}
+
+const char *WS2812FX::getModeData(uint8_t id) {
+  if (!id || id >= _modeCount) return _data_FX_MODE_STATIC;
+  if (id < MODE_COUNT) {
+    const char *data = (const char *) pgm_read_ptr(&effectTable[id].data);
+    if (data) return data;
+  }
+  const mode_data_t *e = findModeExt(id);
+  return e ? e->_data : _data_RESERVED;
+}
+
+// add effect to extension table (RAM), only reserved or new ids can be used
 // use id==255 to find unallocated gaps (with "Reserved" data string)
-// if vector size() is smaller than id (single) data is appended at the end (regardless of id)
+// if id is beyond current count (single) effect is appended at the end (regardless of id)
 void WS2812FX::addEffect(uint8_t id, mode_ptr mode_fn, const char *mode_name) {
   if (id == 255) { // find empty slot
-    for (size_t i=1; i<_mode.size(); i++) if (_modeData[i] == _data_RESERVED) { id = i; break; }
+    for (size_t i=1; i<_modeCount; i++) if (getModeData(i) == _data_RESERVED) { id = i; break; }
   }
-  if (id < _mode.size()) {
-    if (_modeData[id] != _data_RESERVED) return; // do not overwrite alerady added effect
-    _mode[id]     = mode_fn;
-    _modeData[id] = mode_name;
+  if (id < _modeCount) {
+    if (getModeData(id) != _data_RESERVED) return; // do not overwrite alerady added effect
   } else {
-    _mode.push_back(mode_fn);
-    _modeData.push_back(mode_name);
-    if (_modeCount < _mode.size()) _modeCount++;
-  }
-}
-
-void WS2812FX::setupEffectData() {
-  // Solid must be first! (assuming vector is empty upon call to setup)
-  _mode.push_back(&mode_static);
-  _modeData.push_back(_data_FX_MODE_STATIC);
-  // fill reserved word in case there will be any gaps in the array
-  for (size_t i=1; i<_modeCount; i++) {
-    _mode.push_back(&mode_static);
-    _modeData.push_back(_data_RESERVED);
-  }
-  // now replace all pre-allocated effects
-  // --- 1D non-audio effects ---
-  addEffect(FX_MODE_BLINK, &mode_blink, _data_FX_MODE_BLINK);
-  addEffect(FX_MODE_BREATH, &mode_breath, _data_FX_MODE_BREATH);
-  addEffect(FX_MODE_COLOR_WIPE, &mode_color_wipe, _data_FX_MODE_COLOR_WIPE);
-  addEffect(FX_MODE_COLOR_WIPE_RANDOM, &mode_color_wipe_random, _data_FX_MODE_COLOR_WIPE_RANDOM);
-  addEffect(FX_MODE_RANDOM_COLOR, &mode_random_color, _data_FX_MODE_RANDOM_COLOR);
-  addEffect(FX_MODE_COLOR_SWEEP, &mode_color_sweep, _data_FX_MODE_COLOR_SWEEP);
-  addEffect(FX_MODE_DYNAMIC, &mode_dynamic, _data_FX_MODE_DYNAMIC);
-  addEffect(FX_MODE_RAINBOW, &mode_rainbow, _data_FX_MODE_RAINBOW);
-  addEffect(FX_MODE_RAINBOW_CYCLE, &mode_rainbow_cycle, _data_FX_MODE_RAINBOW_CYCLE);
-  addEffect(FX_MODE_SCAN, &mode_scan, _data_FX_MODE_SCAN);
-  addEffect(FX_MODE_DUAL_SCAN, &mode_dual_scan, _data_FX_MODE_DUAL_SCAN);
-  addEffect(FX_MODE_FADE, &mode_fade, _data_FX_MODE_FADE);
-  addEffect(FX_MODE_THEATER_CHASE, &mode_theater_chase, _data_FX_MODE_THEATER_CHASE);
-  addEffect(FX_MODE_THEATER_CHASE_RAINBOW, &mode_theater_chase_rainbow, _data_FX_MODE_THEATER_CHASE_RAINBOW);
-  addEffect(FX_MODE_RUNNING_LIGHTS, &mode_running_lights, _data_FX_MODE_RUNNING_LIGHTS);
-  addEffect(FX_MODE_SAW, &mode_saw, _data_FX_MODE_SAW);
-  addEffect(FX_MODE_TWINKLE, &mode_twinkle, _data_FX_MODE_TWINKLE);
-  addEffect(FX_MODE_DISSOLVE, &mode_dissolve, _data_FX_MODE_DISSOLVE);
-  addEffect(FX_MODE_DISSOLVE_RANDOM, &mode_dissolve_random, _data_FX_MODE_DISSOLVE_RANDOM);
-  addEffect(FX_MODE_SPARKLE, &mode_sparkle, _data_FX_MODE_SPARKLE);
-  addEffect(FX_MODE_FLASH_SPARKLE, &mode_flash_sparkle, _data_FX_MODE_FLASH_SPARKLE);
-  addEffect(FX_MODE_HYPER_SPARKLE, &mode_hyper_sparkle, _data_FX_MODE_HYPER_SPARKLE);
-  addEffect(FX_MODE_STROBE, &mode_strobe, _data_FX_MODE_STROBE);
-  addEffect(FX_MODE_STROBE_RAINBOW, &mode_strobe_rainbow, _data_FX_MODE_STROBE_RAINBOW);
-  addEffect(FX_MODE_MULTI_STROBE, &mode_multi_strobe, _data_FX_MODE_MULTI_STROBE);
-  addEffect(FX_MODE_BLINK_RAINBOW, &mode_blink_rainbow, _data_FX_MODE_BLINK_RAINBOW);
-  addEffect(FX_MODE_ANDROID, &mode_android, _data_FX_MODE_ANDROID);
-  addEffect(FX_MODE_CHASE_COLOR, &mode_chase_color, _data_FX_MODE_CHASE_COLOR);
-  addEffect(FX_MODE_CHASE_RANDOM, &mode_chase_random, _data_FX_MODE_CHASE_RANDOM);
-  addEffect(FX_MODE_CHASE_RAINBOW, &mode_chase_rainbow, _data_FX_MODE_CHASE_RAINBOW);
-  addEffect(FX_MODE_CHASE_FLASH, &mode_chase_flash, _data_FX_MODE_CHASE_FLASH);
-  addEffect(FX_MODE_CHASE_FLASH_RANDOM, &mode_chase_flash_random, _data_FX_MODE_CHASE_FLASH_RANDOM);
-  addEffect(FX_MODE_CHASE_RAINBOW_WHITE, &mode_chase_rainbow_white, _data_FX_MODE_CHASE_RAINBOW_WHITE);
-  addEffect(FX_MODE_COLORFUL, &mode_colorful, _data_FX_MODE_COLORFUL);
-  addEffect(FX_MODE_TRAFFIC_LIGHT, &mode_traffic_light, _data_FX_MODE_TRAFFIC_LIGHT);
-  addEffect(FX_MODE_COLOR_SWEEP_RANDOM, &mode_color_sweep_random, _data_FX_MODE_COLOR_SWEEP_RANDOM);
-  addEffect(FX_MODE_RUNNING_COLOR, &mode_running_color, _data_FX_MODE_RUNNING_COLOR);
-  addEffect(FX_MODE_AURORA, &mode_aurora, _data_FX_MODE_AURORA);
-  addEffect(FX_MODE_RUNNING_RANDOM, &mode_running_random, _data_FX_MODE_RUNNING_RANDOM);
-  addEffect(FX_MODE_LARSON_SCANNER, &mode_larson_scanner, _data_FX_MODE_LARSON_SCANNER);
-  addEffect(FX_MODE_COMET, &mode_comet, _data_FX_MODE_COMET);
-  addEffect(FX_MODE_FIREWORKS, &mode_fireworks, _data_FX_MODE_FIREWORKS);
-  addEffect(FX_MODE_RAIN, &mode_rain, _data_FX_MODE_RAIN);
-  addEffect(FX_MODE_TETRIX, &mode_tetrix, _data_FX_MODE_TETRIX);
-  addEffect(FX_MODE_FIRE_FLICKER, &mode_fire_flicker, _data_FX_MODE_FIRE_FLICKER);
-  addEffect(FX_MODE_GRADIENT, &mode_gradient, _data_FX_MODE_GRADIENT);
-  addEffect(FX_MODE_LOADING, &mode_loading, _data_FX_MODE_LOADING);
-  addEffect(FX_MODE_ROLLINGBALLS, &rolling_balls, _data_FX_MODE_ROLLINGBALLS);
-
-  addEffect(FX_MODE_FAIRY, &mode_fairy, _data_FX_MODE_FAIRY);
-  addEffect(FX_MODE_TWO_DOTS, &mode_two_dots, _data_FX_MODE_TWO_DOTS);
-  addEffect(FX_MODE_FAIRYTWINKLE, &mode_fairytwinkle, _data_FX_MODE_FAIRYTWINKLE);
-  addEffect(FX_MODE_RUNNING_DUAL, &mode_running_dual, _data_FX_MODE_RUNNING_DUAL);
-
-  addEffect(FX_MODE_TRICOLOR_CHASE, &mode_tricolor_chase, _data_FX_MODE_TRICOLOR_CHASE);
-  addEffect(FX_MODE_TRICOLOR_WIPE, &mode_tricolor_wipe, _data_FX_MODE_TRICOLOR_WIPE);
-  addEffect(FX_MODE_TRICOLOR_FADE, &mode_tricolor_fade, _data_FX_MODE_TRICOLOR_FADE);
-  addEffect(FX_MODE_LIGHTNING, &mode_lightning, _data_FX_MODE_LIGHTNING);
-  addEffect(FX_MODE_ICU, &mode_icu, _data_FX_MODE_ICU);
-  addEffect(FX_MODE_MULTI_COMET, &mode_multi_comet, _data_FX_MODE_MULTI_COMET);
-  addEffect(FX_MODE_DUAL_LARSON_SCANNER, &mode_dual_larson_scanner, _data_FX_MODE_DUAL_LARSON_SCANNER);
-  addEffect(FX_MODE_RANDOM_CHASE, &mode_random_chase, _data_FX_MODE_RANDOM_CHASE);
-  addEffect(FX_MODE_OSCILLATE, &mode_oscillate, _data_FX_MODE_OSCILLATE);
-  addEffect(FX_MODE_PRIDE_2015, &mode_pride_2015, _data_FX_MODE_PRIDE_2015);
-  addEffect(FX_MODE_JUGGLE, &mode_juggle, _data_FX_MODE_JUGGLE);
-  addEffect(FX_MODE_PALETTE, &mode_palette, _data_FX_MODE_PALETTE);
-  addEffect(FX_MODE_FIRE_2012, &mode_fire_2012, _data_FX_MODE_FIRE_2012);
-  addEffect(FX_MODE_COLORWAVES, &mode_colorwaves, _data_FX_MODE_COLORWAVES);
-  addEffect(FX_MODE_BPM, &mode_bpm, _data_FX_MODE_BPM);
-  addEffect(FX_MODE_FILLNOISE8, &mode_fillnoise8, _data_FX_MODE_FILLNOISE8);
-  addEffect(FX_MODE_NOISE16_1, &mode_noise16_1, _data_FX_MODE_NOISE16_1);
-  addEffect(FX_MODE_NOISE16_2, &mode_noise16_2, _data_FX_MODE_NOISE16_2);
-  addEffect(FX_MODE_NOISE16_3, &mode_noise16_3, _data_FX_MODE_NOISE16_3);
-  addEffect(FX_MODE_NOISE16_4, &mode_noise16_4, _data_FX_MODE_NOISE16_4);
-  addEffect(FX_MODE_COLORTWINKLE, &mode_colortwinkle, _data_FX_MODE_COLORTWINKLE);
-  addEffect(FX_MODE_LAKE, &mode_lake, _data_FX_MODE_LAKE);
-  addEffect(FX_MODE_METEOR, &mode_meteor, _data_FX_MODE_METEOR);
-  addEffect(FX_MODE_METEOR_SMOOTH, &mode_meteor_smooth, _data_FX_MODE_METEOR_SMOOTH);
-  addEffect(FX_MODE_RAILWAY, &mode_railway, _data_FX_MODE_RAILWAY);
-  addEffect(FX_MODE_RIPPLE, &mode_ripple, _data_FX_MODE_RIPPLE);
-  addEffect(FX_MODE_TWINKLEFOX, &mode_twinklefox, _data_FX_MODE_TWINKLEFOX);
-  addEffect(FX_MODE_TWINKLECAT, &mode_twinklecat, _data_FX_MODE_TWINKLECAT);
-  addEffect(FX_MODE_HALLOWEEN_EYES, &mode_halloween_eyes, _data_FX_MODE_HALLOWEEN_EYES);
-  addEffect(FX_MODE_STATIC_PATTERN, &mode_static_pattern, _data_FX_MODE_STATIC_PATTERN);
-  addEffect(FX_MODE_TRI_STATIC_PATTERN, &mode_tri_static_pattern, _data_FX_MODE_TRI_STATIC_PATTERN);
-  addEffect(FX_MODE_SPOTS, &mode_spots, _data_FX_MODE_SPOTS);
-  addEffect(FX_MODE_SPOTS_FADE, &mode_spots_fade, _data_FX_MODE_SPOTS_FADE);
-  addEffect(FX_MODE_GLITTER, &mode_glitter, _data_FX_MODE_GLITTER);
-  addEffect(FX_MODE_CANDLE, &mode_candle, _data_FX_MODE_CANDLE);
-  addEffect(FX_MODE_STARBURST, &mode_starburst, _data_FX_MODE_STARBURST);
-  addEffect(FX_MODE_EXPLODING_FIREWORKS, &mode_exploding_fireworks, _data_FX_MODE_EXPLODING_FIREWORKS);
-  addEffect(FX_MODE_BOUNCINGBALLS, &mode_bouncing_balls, _data_FX_MODE_BOUNCINGBALLS);
-  addEffect(FX_MODE_SINELON, &mode_sinelon, _data_FX_MODE_SINELON);
-  addEffect(FX_MODE_SINELON_DUAL, &mode_sinelon_dual, _data_FX_MODE_SINELON_DUAL);
-  addEffect(FX_MODE_SINELON_RAINBOW, &mode_sinelon_rainbow, _data_FX_MODE_SINELON_RAINBOW);
-  addEffect(FX_MODE_POPCORN, &mode_popcorn, _data_FX_MODE_POPCORN);
-  addEffect(FX_MODE_DRIP, &mode_drip, _data_FX_MODE_DRIP);
-  addEffect(FX_MODE_PLASMA, &mode_plasma, _data_FX_MODE_PLASMA);
-  addEffect(FX_MODE_PERCENT, &mode_percent, _data_FX_MODE_PERCENT);
-  addEffect(FX_MODE_RIPPLE_RAINBOW, &mode_ripple_rainbow, _data_FX_MODE_RIPPLE_RAINBOW);
-  addEffect(FX_MODE_HEARTBEAT, &mode_heartbeat, _data_FX_MODE_HEARTBEAT);
-  addEffect(FX_MODE_PACIFICA, &mode_pacifica, _data_FX_MODE_PACIFICA);
-  addEffect(FX_MODE_CANDLE_MULTI, &mode_candle_multi, _data_FX_MODE_CANDLE_MULTI);
-  addEffect(FX_MODE_SOLID_GLITTER, &mode_solid_glitter, _data_FX_MODE_SOLID_GLITTER);
-  addEffect(FX_MODE_SUNRISE, &mode_sunrise, _data_FX_MODE_SUNRISE);
-  addEffect(FX_MODE_PHASED, &mode_phased, _data_FX_MODE_PHASED);
-  addEffect(FX_MODE_TWINKLEUP, &mode_twinkleup, _data_FX_MODE_TWINKLEUP);
-  addEffect(FX_MODE_NOISEPAL, &mode_noisepal, _data_FX_MODE_NOISEPAL);
-  addEffect(FX_MODE_SINEWAVE, &mode_sinewave, _data_FX_MODE_SINEWAVE);
-  addEffect(FX_MODE_PHASEDNOISE, &mode_phased_noise, _data_FX_MODE_PHASEDNOISE);
-  addEffect(FX_MODE_FLOW, &mode_flow, _data_FX_MODE_FLOW);
-  addEffect(FX_MODE_CHUNCHUN, &mode_chunchun, _data_FX_MODE_CHUNCHUN);
-  addEffect(FX_MODE_DANCING_SHADOWS, &mode_dancing_shadows, _data_FX_MODE_DANCING_SHADOWS);
-  addEffect(FX_MODE_WASHING_MACHINE, &mode_washing_machine, _data_FX_MODE_WASHING_MACHINE);
-
-  addEffect(FX_MODE_BLENDS, &mode_blends, _data_FX_MODE_BLENDS);
-  addEffect(FX_MODE_TV_SIMULATOR, &mode_tv_simulator, _data_FX_MODE_TV_SIMULATOR);
-  addEffect(FX_MODE_DYNAMIC_SMOOTH, &mode_dynamic_smooth, _data_FX_MODE_DYNAMIC_SMOOTH);
-
-  // --- 1D audio effects ---
-  addEffect(FX_MODE_PIXELS, &mode_pixels, _data_FX_MODE_PIXELS);
-  addEffect(FX_MODE_PIXELWAVE, &mode_pixelwave, _data_FX_MODE_PIXELWAVE);
-  addEffect(FX_MODE_JUGGLES, &mode_juggles, _data_FX_MODE_JUGGLES);
-  addEffect(FX_MODE_MATRIPIX, &mode_matripix, _data_FX_MODE_MATRIPIX);
-  addEffect(FX_MODE_GRAVIMETER, &mode_gravimeter, _data_FX_MODE_GRAVIMETER);
-  addEffect(FX_MODE_PLASMOID, &mode_plasmoid, _data_FX_MODE_PLASMOID);
-  addEffect(FX_MODE_PUDDLES, &mode_puddles, _data_FX_MODE_PUDDLES);
-  addEffect(FX_MODE_MIDNOISE, &mode_midnoise, _data_FX_MODE_MIDNOISE);
-  addEffect(FX_MODE_NOISEMETER, &mode_noisemeter, _data_FX_MODE_NOISEMETER);
-  addEffect(FX_MODE_FREQWAVE, &mode_freqwave, _data_FX_MODE_FREQWAVE);
-  addEffect(FX_MODE_FREQMATRIX, &mode_freqmatrix, _data_FX_MODE_FREQMATRIX);
-
-  addEffect(FX_MODE_WATERFALL, &mode_waterfall, _data_FX_MODE_WATERFALL);
-  addEffect(FX_MODE_FREQPIXELS, &mode_freqpixels, _data_FX_MODE_FREQPIXELS);
-
-  addEffect(FX_MODE_NOISEFIRE, &mode_noisefire, _data_FX_MODE_NOISEFIRE);
-  addEffect(FX_MODE_PUDDLEPEAK, &mode_puddlepeak, _data_FX_MODE_PUDDLEPEAK);
-  addEffect(FX_MODE_NOISEMOVE, &mode_noisemove, _data_FX_MODE_NOISEMOVE);
-
-  addEffect(FX_MODE_PERLINMOVE, &mode_perlinmove, _data_FX_MODE_PERLINMOVE);
-  addEffect(FX_MODE_RIPPLEPEAK, &mode_ripplepeak, _data_FX_MODE_RIPPLEPEAK);
-
-  addEffect(FX_MODE_FREQMAP, &mode_freqmap, _data_FX_MODE_FREQMAP);
-  addEffect(FX_MODE_GRAVCENTER, &mode_gravcenter, _data_FX_MODE_GRAVCENTER);
-  addEffect(FX_MODE_GRAVCENTRIC, &mode_gravcentric, _data_FX_MODE_GRAVCENTRIC);
-  addEffect(FX_MODE_GRAVFREQ, &mode_gravfreq, _data_FX_MODE_GRAVFREQ);
-  addEffect(FX_MODE_DJLIGHT, &mode_DJLight, _data_FX_MODE_DJLIGHT);
-
-  addEffect(FX_MODE_BLURZ, &mode_blurz, _data_FX_MODE_BLURZ);
-
-  addEffect(FX_MODE_FLOWSTRIPE, &mode_FlowStripe, _data_FX_MODE_FLOWSTRIPE);
-
-  addEffect(FX_MODE_WAVESINS, &mode_wavesins, _data_FX_MODE_WAVESINS);
-  addEffect(FX_MODE_ROCKTAVES, &mode_rocktaves, _data_FX_MODE_ROCKTAVES);
-
-  // --- 2D  effects ---
-#ifndef WLED_DISABLE_2D
-  addEffect(FX_MODE_2DSPACESHIPS, &mode_2Dspaceships, _data_FX_MODE_2DSPACESHIPS);
-  addEffect(FX_MODE_2DCRAZYBEES, &mode_2Dcrazybees, _data_FX_MODE_2DCRAZYBEES);
-  addEffect(FX_MODE_2DGHOSTRIDER, &mode_2Dghostrider, _data_FX_MODE_2DGHOSTRIDER);
-  addEffect(FX_MODE_2DBLOBS, &mode_2Dfloatingblobs, _data_FX_MODE_2DBLOBS);
-  addEffect(FX_MODE_2DSCROLLTEXT, &mode_2Dscrollingtext, _data_FX_MODE_2DSCROLLTEXT);
-  addEffect(FX_MODE_2DDRIFTROSE, &mode_2Ddriftrose, _data_FX_MODE_2DDRIFTROSE);
-  addEffect(FX_MODE_2DDISTORTIONWAVES, &mode_2Ddistortionwaves, _data_FX_MODE_2DDISTORTIONWAVES);
-
-  addEffect(FX_MODE_2DGEQ, &mode_2DGEQ, _data_FX_MODE_2DGEQ); // audio
-
-  addEffect(FX_MODE_2DNOISE, &mode_2Dnoise, _data_FX_MODE_2DNOISE);
-
-  addEffect(FX_MODE_2DFIRENOISE, &mode_2Dfirenoise, _data_FX_MODE_2DFIRENOISE);
-  addEffect(FX_MODE_2DSQUAREDSWIRL, &mode_2Dsquaredswirl, _data_FX_MODE_2DSQUAREDSWIRL);
-
-  //non audio
-  addEffect(FX_MODE_2DDNA, &mode_2Ddna, _data_FX_MODE_2DDNA);
-  addEffect(FX_MODE_2DMATRIX, &mode_2Dmatrix, _data_FX_MODE_2DMATRIX);
-  addEffect(FX_MODE_2DMETABALLS, &mode_2Dmetaballs, _data_FX_MODE_2DMETABALLS);
-  addEffect(FX_MODE_2DFUNKYPLANK, &mode_2DFunkyPlank, _data_FX_MODE_2DFUNKYPLANK); // audio
-
-  addEffect(FX_MODE_2DPULSER, &mode_2DPulser, _data_FX_MODE_2DPULSER);
-
-  addEffect(FX_MODE_2DDRIFT, &mode_2DDrift, _data_FX_MODE_2DDRIFT);
-  addEffect(FX_MODE_2DWAVERLY, &mode_2DWaverly, _data_FX_MODE_2DWAVERLY); // audio
-  addEffect(FX_MODE_2DSUNRADIATION, &mode_2DSunradiation, _data_FX_MODE_2DSUNRADIATION);
-  addEffect(FX_MODE_2DCOLOREDBURSTS, &mode_2DColoredBursts, _data_FX_MODE_2DCOLOREDBURSTS);
-  addEffect(FX_MODE_2DJULIA, &mode_2DJulia, _data_FX_MODE_2DJULIA);
-
-  addEffect(FX_MODE_2DGAMEOFLIFE, &mode_2Dgameoflife, _data_FX_MODE_2DGAMEOFLIFE);
-  addEffect(FX_MODE_2DTARTAN, &mode_2Dtartan, _data_FX_MODE_2DTARTAN);
-  addEffect(FX_MODE_2DPOLARLIGHTS, &mode_2DPolarLights, _data_FX_MODE_2DPOLARLIGHTS);
-  addEffect(FX_MODE_2DSWIRL, &mode_2DSwirl, _data_FX_MODE_2DSWIRL); // audio
-  addEffect(FX_MODE_2DLISSAJOUS, &mode_2DLissajous, _data_FX_MODE_2DLISSAJOUS);
-  addEffect(FX_MODE_2DFRIZZLES, &mode_2DFrizzles, _data_FX_MODE_2DFRIZZLES);
-  addEffect(FX_MODE_2DPLASMABALL, &mode_2DPlasmaball, _data_FX_MODE_2DPLASMABALL);
-
-  addEffect(FX_MODE_2DHIPHOTIC, &mode_2DHiphotic, _data_FX_MODE_2DHIPHOTIC);
-  addEffect(FX_MODE_2DSINDOTS, &mode_2DSindots, _data_FX_MODE_2DSINDOTS);
-  addEffect(FX_MODE_2DDNASPIRAL, &mode_2DDNASpiral, _data_FX_MODE_2DDNASPIRAL);
-  addEffect(FX_MODE_2DBLACKHOLE, &mode_2DBlackHole, _data_FX_MODE_2DBLACKHOLE);
-  addEffect(FX_MODE_2DSOAP, &mode_2Dsoap, _data_FX_MODE_2DSOAP);
-  addEffect(FX_MODE_2DOCTOPUS, &mode_2Doctopus, _data_FX_MODE_2DOCTOPUS);
-  addEffect(FX_MODE_2DWAVINGCELL, &mode_2Dwavingcell, _data_FX_MODE_2DWAVINGCELL);
-
-  addEffect(FX_MODE_2DAKEMI, &mode_2DAkemi, _data_FX_MODE_2DAKEMI); // audio
-#endif // WLED_DISABLE_2D
-
+    if (_modeCount == 255) return; // 255 is used as "find empty slot"
+    id = _modeCount++;
+  }
+  _modeExt.emplace_back(id, mode_fn, mode_name);
 }
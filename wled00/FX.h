@@ -35,6 +35,37 @@
 #define USE_GET_MILLISECOND_TIMER
 #include "FastLED.h"
 
+// pipelined output: busses are updated by a dedicated task running on the other core (dual core ESP32 only)
+#if defined(WLED_ENABLE_PIPELINED_OUTPUT) && (!defined(ARDUINO_ARCH_ESP32) || defined(CONFIG_FREERTOS_UNICORE))
+  #undef WLED_ENABLE_PIPELINED_OUTPUT
+#endif
+
+// frame clock: frames start on ticks of a periodic esp_timer and are rendered for their scheduled time (ESP32 only)
+#if defined(WLED_ENABLE_FRAME_CLOCK) && defined(ARDUINO_ARCH_ESP32)
+  #define WLED_FRAME_CLOCK
+  #include "esp_timer.h"
+#endif
+
+// parallel rendering: due segments are rendered by loop() and a render task on the other core at the same time
+// (dual core ESP32 only); state used by effect functions (SEGMENT, SEGLEN, SEGCOLOR(), palette cache) is kept per core
+#if defined(WLED_ENABLE_PARALLEL_RENDER) && (!defined(ARDUINO_ARCH_ESP32) || defined(CONFIG_FREERTOS_UNICORE))
+  #undef WLED_ENABLE_PARALLEL_RENDER
+#endif
+#ifdef WLED_ENABLE_PARALLEL_RENDER
+  #define WLED_RENDER_CTX 2                 // number of render contexts
+  #define RENDER_CTX()    xPortGetCoreID()  // render context of calling task
+#else
+  #define WLED_RENDER_CTX 1
+  #define RENDER_CTX()    0
+#endif
+#ifndef WLED_PALETTE_CACHE_SLOTS            // expanded palettes kept per render context (1kB each), segments with different palettes each get one
+  #ifdef ESP8266
+    #define WLED_PALETTE_CACHE_SLOTS 2
+  #else
+    #define WLED_PALETTE_CACHE_SLOTS 4
+  #endif
+#endif
+
 #define DEFAULT_BRIGHTNESS (uint8_t)127
 #define DEFAULT_MODE       (uint8_t)0
 #define DEFAULT_SPEED      (uint8_t)128
@@ -67,32 +98,53 @@
 #ifdef ESP8266
   #define MAX_NUM_SEGMENTS    16
   /* How much data bytes all segments combined may allocate */
-  #define MAX_SEGMENT_DATA  5120
+  #ifndef MAX_SEGMENT_DATA
+    #define MAX_SEGMENT_DATA  5120
+  #endif
 #else
   #ifndef MAX_NUM_SEGMENTS
     #define MAX_NUM_SEGMENTS  32
   #endif
-  #if defined(ARDUINO_ARCH_ESP32S2)
-    #define MAX_SEGMENT_DATA  24576
-  #else
-    #define MAX_SEGMENT_DATA  32767
+  #ifndef MAX_SEGMENT_DATA
+    #if defined(ARDUINO_ARCH_ESP32S2)
+      #define MAX_SEGMENT_DATA  24576
+    #else
+      #define MAX_SEGMENT_DATA  32767
+    #endif
   #endif
 #endif
 
+/* Effect data placement hints: small state that is accessed randomly every frame stays in internal RAM (arena),
+  large buffers scanned sequentially (per pixel grids) may go to PSRAM (if used) where there is plenty of room */
+#define SEG_DATA_HOT   0
+#define SEG_DATA_COLD  1
+#if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM) && defined(WLED_USE_PSRAM)
+  #define WLED_PSRAM_SEGMENT_DATA // effect data tier in PSRAM
+#endif
+
 /* How much data bytes each segment should max allocate to leave enough space for other segments,
   assuming each segment uses the same amount of data. 256 for ESP8266, 640 for ESP32. */
 #define FAIR_DATA_PER_SEG (MAX_SEGMENT_DATA / strip.getMaxSegments())
 
 #define MIN_SHOW_DELAY   (_frametime < 16 ? 8 : 15)
 
+// random palette (palette 1) fades to the next one in this time (ms), at most randomPaletteChangeTime
+#define RANDOM_PALETTE_FADE 2000
+
+/* service() renders due segments for at most this long (us) per loop pass, remaining ones are rendered
+  in the following passes and the frame is shown once all are done (0: always render the whole frame at once) */
+#ifndef WLED_RENDER_SLICE_US
+  #define WLED_RENDER_SLICE_US 8000
+#endif
+
 #define NUM_COLORS       3 /* number of colors per segment */
 #define SEGMENT          strip._segments[strip.getCurrSegmentId()]
 #define SEGENV           strip._segments[strip.getCurrSegmentId()]
 //#define SEGCOLOR(x)      strip._segments[strip.getCurrSegmentId()].currentColor(x, strip._segments[strip.getCurrSegmentId()].colors[x])
 //#define SEGLEN           strip._segments[strip.getCurrSegmentId()].virtualLength()
 #define SEGCOLOR(x)      strip.segColor(x) /* saves us a few kbytes of code */
-#define SEGPALETTE       Segment::getCurrentPalette()
-#define SEGLEN           strip._virtualSegmentLength /* saves us a few kbytes of code */
+#define SEGPALETTE       SEGMENT.getCurrentPalette()
+#define SEGLEN           strip._renderCtx[RENDER_CTX()].vLength /* saves us a few kbytes of code */
 #define SPEED_FORMULA_L  (5U + (50U*(255U - SEGMENT.speed))/SEGLEN)
 
 // some common colors
@@ -324,16 +376,18 @@ typedef enum mapping1D2D {
   M12_pCorner = 3
 } mapping1D2D_t;
 
+struct ParticleSystem;
+
 // segment, 80 bytes
 typedef struct Segment {
   public:
+    // geometry and runtime state, used for every rendered frame (kept together at the start of the segment)
     uint16_t start; // start index / start X coordinate 2D (left)
     uint16_t stop;  // stop index / stop X coordinate 2D (right); segment is invalid if stop == 0
+    uint16_t startY; // start Y coodrinate 2D (top)
+    uint16_t stopY;  // stop Y coordinate 2D (bottom)
     uint16_t offset;
-    uint8_t  speed;
-    uint8_t  intensity;
-    uint8_t  palette;
-    uint8_t  mode;
+    uint8_t  grouping, spacing;
     union {
       uint16_t options; //bit pattern: msb first: [transposed mirrorY reverseY] transitional (tbd) paused needspixelstate mirrored on reverse selected
       struct {
@@ -351,20 +405,18 @@ typedef struct Segment {
         uint8_t set         : 2;  // 14-15 : 0-3 UI segment sets/groups
       };
     };
-    uint8_t  grouping, spacing;
+    uint8_t  mode;
     uint8_t  opacity;
-    uint32_t colors[NUM_COLORS];
-    uint8_t  cct;                 //0==1900K, 255==10091K
-    uint8_t  custom1, custom2;    // custom FX parameters/sliders
+    uint8_t blendMode;    // SEG_BLEND_* used to composite segment over the ones below
+    uint8_t layerOpacity; // 255: opaque layer (unlike opacity, which dims the segment)
+    int8_t  zIndex;       // compositing order, segments with equal zIndex are composited in list order
+    uint8_t liveAlpha;    // runtime: fade of realtime data in this segment, scales layerOpacity (255: not fading)
+    uint8_t canvasIdx;    // 2D canvas (WS2812FX::canvas) start/stop/startY/stopY refer to
     struct {
-      uint8_t custom3 : 5;        // reduced range slider (0-31)
-      bool    check1  : 1;        // checkmark 1
-      bool    check2  : 1;        // checkmark 2
-      bool    check3  : 1;        // checkmark 3
+      uint8_t renderScale  : 2; // 2D: effect renders to a canvas reduced by 2^renderScale in each dimension (0-2), upscaled in renderToStrip()
+      bool    renderSmooth : 1; // bilinear upscaling (nearest otherwise)
+      bool    interpolate  : 1; // output frames between effect updates are blended from the last two (keyframes)
     };
-    uint8_t startY;  // start Y coodrinate 2D (top); there should be no more than 255 rows
-    uint8_t stopY;   // stop Y coordinate 2D (bottom); there should be no more than 255 rows
-    char    *name;
 
     // runtime data
     unsigned long next_time;  // millis() of next update
@@ -372,8 +424,26 @@ typedef struct Segment {
     uint32_t call;  // call counter
     uint16_t aux0;  // custom var
     uint16_t aux1;  // custom var
+    uint16_t rng;   // state of the effect's random number stream (random8() etc. in FX.cpp), seeded on reset
     byte     *data; // effect data pointer
-    static uint16_t maxWidth, maxHeight;  // these define matrix width & height (max. segment dimensions)
+
+    // effect parameters and UI attributes, changed from UI/API (effects read some of them)
+    uint8_t  speed;
+    uint8_t  intensity;
+    uint8_t  palette;
+    uint8_t  cct;                 //0==1900K, 255==10091K
+    uint8_t  custom1, custom2;    // custom FX parameters/sliders
+    struct {
+      uint8_t custom3 : 5;        // reduced range slider (0-31)
+      bool    check1  : 1;        // checkmark 1
+      bool    check2  : 1;        // checkmark 2
+      bool    check3  : 1;        // checkmark 3
+    };
+    uint32_t colors[NUM_COLORS];
+    char    *name;
+
+    static uint16_t maxWidth, maxHeight;  // these define primary (first) canvas width & height (max. segment dimensions)
+    static uint16_t matrixArea;           // logical pixels of all canvases (equals maxWidth for 1D), trailing 1D strips follow
 
     typedef struct TemporarySegmentData {
       uint16_t _optionsT;
@@ -393,12 +463,25 @@ typedef struct Segment {
       uint32_t _callT;
       uint8_t *_dataT;
       uint16_t _dataLenT;
+      uint32_t *_pixelsT;
+      uint16_t _pixelsLenT;
       TemporarySegmentData()
         : _dataT(nullptr) // just in case...
         , _dataLenT(0)
+        , _pixelsT(nullptr)
+        , _pixelsLenT(0)
       {}
     } tmpsegd_t;
 
+    // settings compared by differs(): snapshot of a segment without name, effect data and pixel buffers
+    typedef struct SegmentSettings {
+      uint16_t start, stop, startY, stopY, offset, options;
+      uint8_t  grouping, spacing, opacity, mode, speed, intensity, palette, custom1, custom2, custom3;
+      uint8_t  blendMode, layerOpacity, renderScale, renderSmooth, interpolate;
+      int8_t   zIndex;
+      uint32_t colors[NUM_COLORS];
+    } settings_t;
+
   private:
     union {
       uint8_t  _capabilities;
@@ -412,12 +495,45 @@ typedef struct Segment {
     };
     uint16_t        _dataLen;
     static uint16_t _usedSegmentData;
-
-    // perhaps this should be per segment, not static
-    static CRGBPalette16 _currentPalette;     // palette used for current effect (includes transition, used in color_from_palette())
-    static CRGBPalette16 _randomPalette;      // actual random palette
-    static CRGBPalette16 _newRandomPalette;   // target random palette
-    static unsigned long _lastPaletteChange;  // last random palette change time in millis()
+    static uint32_t _usedSegmentDataPSRAM; // cold effect data placed in PSRAM, not part of arena
+    static uint8_t *_arena;             // effect data arena (MAX_SEGMENT_DATA bytes)
+    static uint16_t _arenaTop;          // first free byte in arena
+    static tmpsegd_t *_arenaTmpSeg;     // segment environment temporarily holding data while blending modes
+
+    // segment pixel buffer: logical (virtual) pixels as written by effects, mapped to physical pixels once per frame
+    uint32_t       *_pixels;
+    uint16_t        _pixelsLen;   // number of logical pixels in _pixels[]
+    uint32_t       *_pixelsSpare; // previous mode buffer of last mode transition kept for the next one (_pixelsLen pixels)
+    uint32_t       *_pixelsKey;   // previous keyframe when interpolating between effect updates (_pixelsLen pixels)
+    unsigned long   _keyTime;     // millis() current keyframe was rendered at
+    uint16_t        _keyLen;      // ms until next keyframe, 0 if not interpolating
+    // physical pixel lookup for 1D segments: _indexMap[physical pixel - start] = logical pixel (UINT16_MAX if not lit)
+    // 2D segments in arc mode: _indexMap[0..vLen] are offsets of each arc's buffer indices which follow
+    uint16_t       *_indexMap;
+    uint16_t        _indexMapLen; // number of entries in _indexMap[]
+    uint64_t        _indexMapKey; // layout (grouping, spacing, offset, ...) _indexMap was built for
+    // setPixelColor() variant matching segment shape, chosen once per frame by selectPixelWriter()
+    typedef void (Segment::*pixel_writer_t)(int, uint32_t);
+    pixel_writer_t  _writer;
+    uint16_t        _writerLen;   // number of 1D pixels _writer accepts
+    uint16_t        _writerW;     // virtual width/height _writer was chosen for (2D)
+    uint16_t        _writerH;
+    // virtual geometry resolved by updateGeometry() (options, grouping/spacing or bounds changed and once per frame)
+    uint16_t        _vWidth, _vHeight, _vLength, _vStrips;
+    uint16_t        _rWidth, _rHeight; // virtual width/height rendered to the strip (differ from _vWidth/_vHeight if renderScale is set)
+
+    // palette state, each segment owns its resolved and random palette
+    CRGBPalette16 _currentPalette;     // palette used for current effect (includes transition, used in color_from_palette())
+    CRGBPalette16 _randomPalette;      // previous random palette (fading from)
+    CRGBPalette16 _newRandomPalette;   // target random palette (fading to since _lastPaletteChange)
+    unsigned long _lastPaletteChange;  // last random palette change time in millis()
+    uint32_t      _paletteKey;         // inputs (palette, mode, colors) _currentPalette was loaded from, 0 forces reload
+    static uint8_t       _customPaletteGen;   // incremented each time custom palettes are (re)loaded
+    static uint32_t      _paletteCache[WLED_RENDER_CTX][WLED_PALETTE_CACHE_SLOTS][256]; // palettes expanded to 256 colors (used in color_from_palette())
+    static CRGBPalette16 _paletteCacheSrc[WLED_RENDER_CTX][WLED_PALETTE_CACHE_SLOTS];   // palette each slot was built from
+    static uint8_t       _paletteCacheBlend[WLED_RENDER_CTX][WLED_PALETTE_CACHE_SLOTS]; // blend type each slot was built with
+    static uint8_t       _paletteCacheSlot[WLED_RENDER_CTX];  // slot holding _currentPalette of the segment being rendered
+    static uint8_t       _paletteCacheNext[WLED_RENDER_CTX];  // slot replaced next (round robin)
     #ifndef WLED_DISABLE_MODE_BLEND
     static bool          _modeBlend;          // mode/effect blending semaphore
     #endif
@@ -432,33 +548,57 @@ typedef struct Segment {
       #endif
       uint8_t       _briT;        // temporary brightness
       uint8_t       _cctT;        // temporary CCT
-      CRGBPalette16 _palT;        // temporary palette
-      uint8_t       _prevPaletteBlends; // number of previous palette blends (there are max 255 blends possible)
+      CRGBPalette16 _palT;        // palette at start of transition
       unsigned long _start;       // must accommodate millis()
       uint16_t      _dur;
+      // snapshot taken once per frame by updateTransition(), so all of a frame uses the same values
+      uint16_t      _prog;        // progress 0-65535
+      uint8_t       _briCur;      // current brightness (opacity)
+      uint8_t       _cctCur;      // current CCT
+      uint32_t      _colorCur[NUM_COLORS];
       Transition(uint16_t dur=750)
         : _palT(CRGBPalette16(CRGB::Black))
-        , _prevPaletteBlends(0)
         , _start(millis())
         , _dur(dur)
+        , _prog(0)
       {}
     } *_t;
+    static Transition _tPool[MAX_NUM_SEGMENTS]; // preallocated transitions (one per possible segment)
+    static bool       _tPoolUsed[MAX_NUM_SEGMENTS];
+    static Transition *getTransition(uint16_t dur);
+    static void        releaseTransition(Transition *t);
 
   public:
 
     Segment(uint16_t sStart=0, uint16_t sStop=30) :
       start(sStart),
       stop(sStop),
+      startY(0),
+      stopY(1),
       offset(0),
-      speed(DEFAULT_SPEED),
-      intensity(DEFAULT_INTENSITY),
-      palette(0),
-      mode(DEFAULT_MODE),
-      options(SELECTED | SEGMENT_ON),
       grouping(1),
       spacing(0),
+      options(SELECTED | SEGMENT_ON),
+      mode(DEFAULT_MODE),
       opacity(255),
-      colors{DEFAULT_COLOR,BLACK,BLACK},
+      blendMode(SEG_BLEND_NORMAL),
+      layerOpacity(255),
+      zIndex(0),
+      liveAlpha(255),
+      canvasIdx(0),
+      renderScale(0),
+      renderSmooth(false),
+      interpolate(false),
+      next_time(0),
+      step(0),
+      call(0),
+      aux0(0),
+      aux1(0),
+      rng(1),
+      data(nullptr),
+      speed(DEFAULT_SPEED),
+      intensity(DEFAULT_INTENSITY),
+      palette(0),
       cct(127),
       custom1(DEFAULT_C1),
       custom2(DEFAULT_C2),
@@ -466,27 +606,46 @@ typedef struct Segment {
       check1(false),
       check2(false),
       check3(false),
-      startY(0),
-      stopY(1),
+      colors{DEFAULT_COLOR,BLACK,BLACK},
       name(nullptr),
-      next_time(0),
-      step(0),
-      call(0),
-      aux0(0),
-      aux1(0),
-      data(nullptr),
       _capabilities(0),
       _dataLen(0),
+      _pixels(nullptr),
+      _pixelsLen(0),
+      _pixelsSpare(nullptr),
+      _pixelsKey(nullptr),
+      _keyTime(0),
+      _keyLen(0),
+      _indexMap(nullptr),
+      _indexMapLen(0),
+      _indexMapKey(0),
+      _writer(&Segment::writePixelAuto),
+      _writerLen(0),
+      _writerW(0),
+      _writerH(0),
+      _vWidth(0),
+      _vHeight(0),
+      _vLength(0),
+      _vStrips(1),
+      _rWidth(0),
+      _rHeight(0),
+      _currentPalette(CRGBPalette16(CRGB::Black)),
+      _randomPalette(CRGBPalette16(DEFAULT_COLOR)),
+      _newRandomPalette(CRGBPalette16(DEFAULT_COLOR)),
+      _lastPaletteChange(0),
+      _paletteKey(0),
       _t(nullptr)
     {
       #ifdef WLED_DEBUG
       //Serial.printf("-- Creating segment: %p\n", this);
       #endif
+      updateGeometry();
     }
 
     Segment(uint16_t sStartX, uint16_t sStopX, uint16_t sStartY, uint16_t sStopY) : Segment(sStartX, sStopX) {
       startY = sStartY;
       stopY  = sStopY;
+      updateGeometry();
     }
 
     Segment(const Segment &orig); // copy constructor
@@ -502,19 +661,21 @@ typedef struct Segment {
       if (name) { delete[] name; name = nullptr; }
       stopTransition();
       deallocateData();
+      deallocatePixels();
     }
 
     Segment& operator= (const Segment &orig); // copy assignment
     Segment& operator= (Segment &&orig) noexcept; // move assignment
 
 #ifdef WLED_DEBUG
-    size_t getSize() const { return sizeof(Segment) + (data?_dataLen:0) + (name?strlen(name):0) + (_t?sizeof(Transition):0); }
+    size_t getSize() const { return sizeof(Segment) + (data?_dataLen:0) + (name?strlen(name):0) + (_t?sizeof(Transition):0) + (_pixels?_pixelsLen*sizeof(uint32_t):0) + (_pixelsSpare?_pixelsLen*sizeof(uint32_t):0) + (_pixelsKey?_pixelsLen*sizeof(uint32_t):0) + (_indexMap?_indexMapLen*sizeof(uint16_t):0); }
 #endif
 
     inline bool     getOption(uint8_t n) const { return ((options >> n) & 0x01); }
     inline bool     isSelected(void)     const { return selected; }
     inline bool     isInTransition(void) const { return _t != nullptr; }
     inline bool     isActive(void)       const { return stop > start; }
+    inline bool     isLayered(void)      const { return blendMode != SEG_BLEND_NORMAL || layerOpacity < 255 || liveAlpha < 255; } // blends with segments below
     inline bool     is2D(void)           const { return (width()>1 && height()>1); }
     inline bool     hasRGB(void)         const { return _isRGB; }
     inline bool     hasWhite(void)       const { return _hasW; }
@@ -526,27 +687,31 @@ typedef struct Segment {
     inline uint8_t  getLightCapabilities(void) const { return _capabilities; }
 
     static uint16_t getUsedSegmentData(void)    { return _usedSegmentData; }
-    static void     addUsedSegmentData(int len) { _usedSegmentData += len; }
+    static uint32_t getUsedSegmentDataPSRAM(void) { return _usedSegmentDataPSRAM; }
+    static uint32_t getMaxSegmentDataPSRAM(void); // scales with PSRAM size, 0 without PSRAM
+    static void     addUsedSegmentData(int len); // effect data may be allocated by render task
     #ifndef WLED_DISABLE_MODE_BLEND
     static void     modeBlend(bool blend)       { _modeBlend = blend; }
     #endif
-    static void     handleRandomPalette();
-    inline static const CRGBPalette16 &getCurrentPalette(void) { return Segment::_currentPalette; }
+    inline const CRGBPalette16 &getCurrentPalette(void) const { return _currentPalette; }
+    inline static void invalidatePalettes(void) { _customPaletteGen++; } // custom palettes changed
 
-    void    setUp(uint16_t i1, uint16_t i2, uint8_t grp=1, uint8_t spc=0, uint16_t ofs=UINT16_MAX, uint16_t i1Y=0, uint16_t i2Y=1, uint8_t segId = 255);
+    void    setUp(uint16_t i1, uint16_t i2, uint8_t grp=1, uint8_t spc=0, uint16_t ofs=UINT16_MAX, uint16_t i1Y=0, uint16_t i2Y=1, uint8_t cv=255, uint8_t segId = 255); // cv: canvas (255 keeps current)
     bool    setColor(uint8_t slot, uint32_t c); //returns true if changed
     void    setCCT(uint16_t k);
     void    setOpacity(uint8_t o);
     void    setOption(uint8_t n, bool val);
     void    setMode(uint8_t fx, bool loadDefaults = false);
     void    setPalette(uint8_t pal);
-    uint8_t differs(Segment& b) const;
+    settings_t settings(void) const;
+    uint8_t differs(const settings_t &b) const;
     void    refreshLightCapabilities(void);
 
     // runtime data functions
     inline uint16_t dataSize(void) const { return _dataLen; }
-    bool allocateData(size_t len);
+    bool allocateData(size_t len, uint8_t hint = SEG_DATA_HOT); // hint: SEG_DATA_*
     void deallocateData(void);
+    void copyData(const uint8_t *src, uint16_t len);
     void resetIfRequired(void);
     /**
       * Flags that before the next effect is calculated,
@@ -556,33 +721,55 @@ typedef struct Segment {
       */
     inline void markForReset(void) { reset = true; }  // setOption(SEG_OPTION_RESET, true)
 
+    // pixel buffer functions
+    uint16_t bufferLength(void) const;  // number of logical pixels the segment needs to store
+    bool allocatePixels(void);          // (re)allocates pixel buffer and lookup table if geometry changed; do not call from network callback
+    void deallocatePixels(void);
+    void selectPixelWriter(void);       // picks setPixelColor() variant for current geometry; called before effect runs
+    void renderToStrip(void);           // maps pixel buffer onto physical pixels (applying opacity, grouping, spacing, mirroring, ...)
+    // keyframe interpolation: effect output is kept before each effect call and output frames until the next one are blended
+    inline void saveKeyframe(void)      { if (_pixelsKey && _pixels) memcpy(_pixelsKey, _pixels, _pixelsLen * sizeof(uint32_t)); }
+    inline void setKeyframe(unsigned long t, uint16_t len) { _keyTime = t; _keyLen = _pixelsKey ? len : 0; }
+    inline bool isInterpolating(unsigned long t) const { return _keyLen && t - _keyTime < _keyLen; }
+
     // transition functions
     void     startTransition(uint16_t dur); // transition has to start before actual segment values change
     void     stopTransition(void);
-    void     handleTransition(void);
+    void     handleTransition(unsigned long t); // takes frame snapshot, stops finished transition
+    void     updateTransition(unsigned long t); // snapshot of progress, brightness and colors at time t
     #ifndef WLED_DISABLE_MODE_BLEND
     void     swapSegenv(tmpsegd_t &tmpSegD);
     void     restoreSegenv(tmpsegd_t &tmpSegD);
     #endif
-    uint16_t progress(void); //transition progression between 0-65535
+    inline uint16_t progress(void) const { return isInTransition() ? _t->_prog : 0xFFFFU; } //transition progression between 0-65535 (of current frame)
     uint8_t  currentBri(bool useCct = false);
     uint8_t  currentMode(void);
     uint32_t currentColor(uint8_t slot);
     CRGBPalette16 &loadPalette(CRGBPalette16 &tgt, uint8_t pal);
     void     setCurrentPalette(void);
+    uint32_t paletteKey(void) const;
+    void     updatePaletteCache(TBlendType blend);
 
+    void     updateGeometry(void);   // resolves virtual width/height/length, call after changing bounds, grouping, spacing or options directly
     // 1D strip
-    uint16_t virtualLength(void) const;
-    void setPixelColor(int n, uint32_t c); // set relative pixel within segment with color
+    inline uint16_t virtualLength(void) const { return _vLength; }
+    void setPixelColor(int n, uint32_t c) { (this->*_writer)(n, c); } // set relative pixel within segment with color
     void setPixelColor(unsigned n, uint32_t c)                    { setPixelColor(int(n), c); }
     void setPixelColor(int n, byte r, byte g, byte b, byte w = 0) { setPixelColor(n, RGBW32(r,g,b,w)); } // automatically inline
     void setPixelColor(int n, CRGB c)                             { setPixelColor(n, RGBW32(c.r,c.g,c.b,0)); } // automatically inline
     void setPixelColor(float i, uint32_t c, bool aa = true);
     void setPixelColor(float i, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0, bool aa = true) { setPixelColor(i, RGBW32(r,g,b,w), aa); }
     void setPixelColor(float i, CRGB c, bool aa = true)                                         { setPixelColor(i, RGBW32(c.r,c.g,c.b,0), aa); }
+    void setPixelColorQ16(uint32_t i, uint32_t c, bool aa = true); // fixed point: 65535 = 1.0 (upper 16 bits select virtual strip)
+    void setPixelColorQ16(uint32_t i, CRGB c, bool aa = true)         { setPixelColorQ16(i, RGBW32(c.r,c.g,c.b,0), aa); }
+    void setPixelColors(int start, uint16_t count, const uint32_t *c); // set contiguous run of relative pixels
+    void setPixelsRaw(int start, uint16_t count, const uint32_t *c);   // copy run into pixel buffer (2D: row by row), no 1D to 2D expansion
+    void drawParticle(int32_t pos, uint32_t c, uint16_t vStrip = 0, uint8_t flags = 0, int32_t radius = 0); // additive, fixed point position (PS_ONE = 1 pixel)
+    void drawParticles(const ParticleSystem &ps, uint16_t first = 0, uint16_t n = UINT16_MAX, uint16_t vStrip = 0, uint8_t flags = 0, int32_t radius = 0);
     uint32_t getPixelColor(int i);
     // 1D support functions (some implement 2D as well)
     void blur(uint8_t);
+    void clear(void);
     void fill(uint32_t c);
     void fade_out(uint8_t r);
     void fadeToBlackBy(uint8_t fadeBy);
@@ -596,9 +783,9 @@ typedef struct Segment {
     uint32_t color_wheel(uint8_t pos);
 
     // 2D matrix
-    uint16_t virtualWidth(void)  const;
-    uint16_t virtualHeight(void) const;
-    uint16_t nrOfVStrips(void) const;
+    inline uint16_t virtualWidth(void)  const { return _vWidth; }
+    inline uint16_t virtualHeight(void) const { return _vHeight; }
+    inline uint16_t nrOfVStrips(void)   const { return _vStrips; }
   #ifndef WLED_DISABLE_2D
     uint16_t XY(uint16_t x, uint16_t y); // support function to get relative index within segment
     void setPixelColorXY(int x, int y, uint32_t c); // set relative pixel within segment with color
@@ -608,6 +795,8 @@ typedef struct Segment {
     void setPixelColorXY(float x, float y, uint32_t c, bool aa = true);
     void setPixelColorXY(float x, float y, byte r, byte g, byte b, byte w = 0, bool aa = true) { setPixelColorXY(x, y, RGBW32(r,g,b,w), aa); }
     void setPixelColorXY(float x, float y, CRGB c, bool aa = true)                             { setPixelColorXY(x, y, RGBW32(c.r,c.g,c.b,0), aa); }
+    void setPixelColorXYQ16(uint16_t x, uint16_t y, uint32_t c, bool aa = true); // fixed point: 65535 = 1.0
+    void setPixelColorXYQ16(uint16_t x, uint16_t y, CRGB c, bool aa = true)                    { setPixelColorXYQ16(x, y, RGBW32(c.r,c.g,c.b,0), aa); }
     uint32_t getPixelColorXY(uint16_t x, uint16_t y);
     // 2D support functions
     void blendPixelColorXY(uint16_t x, uint16_t y, uint32_t color, uint8_t blend);
@@ -619,6 +808,7 @@ typedef struct Segment {
     void box_blur(uint16_t i, bool vertical, fract8 blur_amount); // 1D box blur (with weight)
     void blurRow(uint16_t row, fract8 blur_amount);
     void blurCol(uint16_t col, fract8 blur_amount);
+    void blur2D(fract8 blur_amount, uint8_t radius); // separable box blur with radius
     void moveX(int8_t delta, bool wrap = false);
     void moveY(int8_t delta, bool wrap = false);
     void move(uint8_t dir, uint8_t delta, bool wrap = false);
@@ -629,6 +819,7 @@ typedef struct Segment {
     void drawCharacter(unsigned char chr, int16_t x, int16_t y, uint8_t w, uint8_t h, uint32_t color, uint32_t col2 = 0, int8_t rotate = 0);
     void drawCharacter(unsigned char chr, int16_t x, int16_t y, uint8_t w, uint8_t h, CRGB c) { drawCharacter(chr, x, y, w, h, RGBW32(c.r,c.g,c.b,0)); } // automatic inline
     void drawCharacter(unsigned char chr, int16_t x, int16_t y, uint8_t w, uint8_t h, CRGB c, CRGB c2, int8_t rotate = 0) { drawCharacter(chr, x, y, w, h, RGBW32(c.r,c.g,c.b,0), RGBW32(c2.r,c2.g,c2.b,0), rotate); } // automatic inline
+    static uint16_t rasterizeText(const char *text, uint8_t w, uint8_t h, int8_t rotate, uint16_t *columns, size_t maxColumns); // 1 bit per pixel text bitmap
     void wu_pixel(uint32_t x, uint32_t y, CRGB c);
     void blur1d(fract8 blur_amount); // blur all rows in 1 dimension
     void blur2d(fract8 blur_amount) { blur(blur_amount); }
@@ -642,6 +833,8 @@ typedef struct Segment {
     void setPixelColorXY(float x, float y, uint32_t c, bool aa = true)     { setPixelColor(x, c, aa); }
     void setPixelColorXY(float x, float y, byte r, byte g, byte b, byte w = 0, bool aa = true) { setPixelColor(x, RGBW32(r,g,b,w), aa); }
     void setPixelColorXY(float x, float y, CRGB c, bool aa = true)         { setPixelColor(x, RGBW32(c.r,c.g,c.b,0), aa); }
+    void setPixelColorXYQ16(uint16_t x, uint16_t y, uint32_t c, bool aa = true) { setPixelColorQ16(x, c, aa); }
+    void setPixelColorXYQ16(uint16_t x, uint16_t y, CRGB c, bool aa = true)     { setPixelColorQ16(x, RGBW32(c.r,c.g,c.b,0), aa); }
     uint32_t getPixelColorXY(uint16_t x, uint16_t y)                       { return getPixelColor(x); }
     void blendPixelColorXY(uint16_t x, uint16_t y, uint32_t c, uint8_t blend) { blendPixelColor(x, c, blend); }
     void blendPixelColorXY(uint16_t x, uint16_t y, CRGB c, uint8_t blend)  { blendPixelColor(x, RGBW32(c.r,c.g,c.b,0), blend); }
@@ -652,6 +845,7 @@ typedef struct Segment {
     void box_blur(uint16_t i, bool vertical, fract8 blur_amount) {}
     void blurRow(uint16_t row, fract8 blur_amount) {}
     void blurCol(uint16_t col, fract8 blur_amount) {}
+    void blur2D(fract8 blur_amount, uint8_t radius) {}
     void moveX(int8_t delta, bool wrap = false) {}
     void moveY(int8_t delta, bool wrap = false) {}
     void move(uint8_t dir, uint8_t delta, bool wrap = false) {}
@@ -661,16 +855,131 @@ typedef struct Segment {
     void drawCharacter(unsigned char chr, int16_t x, int16_t y, uint8_t w, uint8_t h, uint32_t color, uint32_t = 0, int8_t = 0) {}
     void drawCharacter(unsigned char chr, int16_t x, int16_t y, uint8_t w, uint8_t h, CRGB color) {}
     void drawCharacter(unsigned char chr, int16_t x, int16_t y, uint8_t w, uint8_t h, CRGB c, CRGB c2, int8_t rotate = 0) {}
+    static uint16_t rasterizeText(const char *text, uint8_t w, uint8_t h, int8_t rotate, uint16_t *columns, size_t maxColumns) { return 0; }
     void wu_pixel(uint32_t x, uint32_t y, CRGB c) {}
   #endif
+
+  private:
+    unsigned pixelCount(void) const;    // number of valid pixels in _pixels[]
+    static uint8_t *arenaAlloc(size_t len, const uint8_t *src, bool compact);
+    static void     arenaFree(uint8_t *block, size_t len, uint8_t tag = HEAP_TAG_SEGDATA);
+    static void     compactArena(void);
+    static inline bool inArena(const uint8_t *p) { return _arena && p >= _arena && p < _arena + MAX_SEGMENT_DATA; }
+    static bool inPSRAM(const uint8_t *p);
+    inline bool isMatrixStrip(void) const { return Segment::maxHeight > 1 && (width() == 1 || height() == 1) && start < Segment::matrixArea; } // 1D segment within 2D matrix
+    inline uint64_t indexMapKey(void) const { return uint64_t(offset) | (uint64_t(grouping) << 16) | (uint64_t(spacing) << 24) | (uint64_t(length()) << 32) | (uint64_t(reverse) << 48) | (uint64_t(mirror) << 49); }
+    bool updateIndexMap(void);                         // (re)builds physical to logical pixel lookup table (1D)
+    void writePixelAuto(int i, uint32_t col);          // selects writer on first use
+    void writePixelNone(int i, uint32_t col) {}        // inactive or no pixel buffer
+    void writePixelLinear(int i, uint32_t col);        // 1D, 1D within matrix and 2D in pixels mode
+  #ifndef WLED_DISABLE_2D
+    template<uint8_t map1D2D> void writePixel2D(int i, uint32_t col); // 1D effect expanded onto 2D segment (bar, arc, corner)
+  #endif
+    void deallocateIndexMap(void);
+  #ifndef WLED_DISABLE_2D
+    static inline uint64_t arcMapKey(uint16_t vW, uint16_t vH) { return uint64_t(vW) | (uint64_t(vH) << 16) | (1ULL << 63); } // never collides with indexMapKey()
+    bool updateArcMap(void);                           // (re)builds 1D to 2D arc expansion table
+    void renderPixelXY(int x, int y, uint32_t col);    // expands logical pixel to physical pixel(s) (2D)
+    void renderScaled(const uint32_t *key, uint16_t kProg, const uint32_t *prev, uint16_t prog, uint8_t bri); // renderToStrip() of reduced resolution canvas
+    // pixel buffer for primitives writing to it directly (virtualWidth() x virtualHeight(), clipped once per primitive)
+    inline uint32_t *canvas(void) const { return isActive() && _pixels && _pixelsLen >= unsigned(_vWidth) * _vHeight ? _pixels : nullptr; }
+  #endif
 } segment;
 //static int segSize = sizeof(Segment);
 
+/*
+ * Particle system shared by particle effects: fixed point positions and velocities (PS_ONE = 1 pixel, velocities
+ * in pixels per frame) stored as arrays (SoA) in segment data, integrated without floating point and rendered in
+ * one pass with additive (saturating) blending, optionally anti-aliased (a particle covers the two/four pixels
+ * under its fractional position, 1D particles may have a radius).
+ * Usage (effect function): ParticleSystem ps; if (!ps.setup(n)) return mode_static(); ... ps.move(g); SEGMENT.drawParticles(ps);
+ * Pointers are only valid during the current call, segment data may be moved between frames.
+ */
+#define PS_SHIFT 16
+#define PS_ONE   (int32_t(1) << PS_SHIFT)
+// drawParticle(s)() flags
+#define PS_AA    0x01 // anti-aliased
+#define PS_FLIP  0x02 // positions are mirrored (1D: counted from the end, 2D: y counted from the bottom)
+
+typedef struct ParticleSystem {
+  uint16_t  count;      // number of particles
+  bool      is2D;
+  bool      fresh;      // data was (re)initialised, all particles are inactive
+  int32_t  *x, *vx;     // position and velocity
+  int32_t  *y, *vy;     // 2D only (nullptr in 1D)
+  uint32_t *color;      // rendered color
+  uint16_t *life;       // 0: inactive (not moved or rendered), other values are up to the effect (e.g. age)
+  uint8_t  *user;       // per particle effect state
+  uint8_t  *extra;      // effect state of the whole system (extraLen bytes given to setup(), 32 bit aligned)
+
+  static size_t dataSize(uint16_t n, bool is2D = false, size_t extraLen = 0);
+  // binds to (and allocates) current segment data, returns false if allocation failed
+  bool setup(uint16_t n, bool is2D = false, size_t extraLen = 0);
+  void spawn(uint16_t i, int32_t px, int32_t pvx, uint32_t c, uint16_t l = 1);
+  void spawn(uint16_t i, int32_t px, int32_t py, int32_t pvx, int32_t pvy, uint32_t c, uint16_t l = 1);
+  // moves active particles [first, first+n) by their velocity, then accelerates them (e.g. gravity)
+  void move(int32_t ax = 0, int32_t ay = 0, uint16_t first = 0, uint16_t n = UINT16_MAX);
+  // velocity needed to reach height h (pixels) against deceleration g (PS_ONE per frame per frame)
+  static int32_t launchVelocity(int32_t g, uint32_t h);
+} particle_system_t;
+
+// effect render time statistics (in microseconds), collected by WS2812FX::service()
+#define FX_STATS_BUCKETS 6   // histogram buckets: <0.5ms, <1ms, <2ms, <5ms, <10ms, >=10ms
+#ifdef ESP8266
+  #define FX_STATS_SLOTS 16  // number of effects tracked at the same time (least used is replaced)
+#else
+  #define FX_STATS_SLOTS 32
+#endif
+typedef struct EffectStats {
+  uint32_t sum;                     // total render time
+  uint16_t count;                   // number of calls (all values are halved when it would overflow)
+  uint16_t min, max;                // saturated at 65535us
+  uint16_t hist[FX_STATS_BUCKETS];
+  uint8_t  id;                      // effect (mode) id
+  EffectStats() { reset(); }
+  void reset(uint8_t fx = 0) { memset((void*)this, 0, sizeof(EffectStats)); min = UINT16_MAX; id = fx; }
+  void add(uint32_t us);
+  inline uint16_t avg() const { return count ? sum / count : 0; }
+} fx_stats_t;
+
+// result of on-device effect benchmark (WS2812FX::startBenchmark())
+typedef struct BenchResult {
+  uint32_t us;      // average time to render one frame of all active segments
+  uint32_t heap;    // lowest free heap seen while effect was running
+  uint16_t frames;  // number of frames rendered
+  uint16_t data;    // highest segment data usage (all segments)
+  uint32_t hash;    // golden run: hash of composited output of all frames
+} bench_result_t;
+
+// pixel of the overlay layer (see WS2812FX::setOverlayPixel())
+typedef struct OverlayPixel {
+  uint16_t idx;    // strip pixel (ledmap is applied when composited)
+  uint8_t  owner;  // 0: built-in overlays (overlay.cpp), usermods use their USERMOD_ID
+  uint8_t  alpha;  // 255: opaque
+  uint32_t color;
+  uint32_t under;  // frame color below a translucent pixel
+  uint32_t shown;  // composited color as read back from the bus (frame was not rendered again if unchanged)
+} overlay_px_t;
+
+// run of the compressed ledmap: logical pixels start..start+len-1 map to value, value+step, value+2*step...
+typedef struct MapRun {
+  uint16_t start;
+  uint16_t len;
+  uint16_t value;  // physical pixel of start (0xFFFF with step 0: run of missing pixels)
+  int16_t  step;
+} map_run_t;
+
+// built-in effect, the registry (indexed by effect id) is a table in flash (see WLED_EFFECT_LIST in FX.cpp)
+typedef struct Effect {
+  uint16_t  (*fn)(void); // mode (effect) function, nullptr if id is reserved (or excluded by build flags)
+  const char *data;      // mode (effect) name and its UI control data
+} effect_t;
+
 // main "strip" class
 class WS2812FX {  // 96 bytes
   typedef uint16_t (*mode_ptr)(void); // pointer to mode function
   typedef void (*show_callback)(void); // pre show callback
-  typedef struct ModeData {
+  typedef struct ModeData { // effect added at runtime (usermods)
     uint8_t     _id;   // mode (effect) id
     mode_ptr    _fcn;  // mode (effect) function
     const char *_data; // mode (effect) name and its UI control data
@@ -695,25 +1004,33 @@ class WS2812FX {  // 96 bytes
       panels(1),
 #endif
       // semi-private (just obscured) used in effect functions through macros
-      _colors_t{0,0,0},
-      _virtualSegmentLength(0),
+      _renderCtx{},
       // true private variables
       _length(DEFAULT_LED_COUNT),
       _brightness(DEFAULT_BRIGHTNESS),
       _transitionDur(750),
       _targetFps(WLED_FPS),
       _frametime(FRAMETIME_FIXED),
+      _wireFps(0),
+      _wireBus(-1),
+      _fpsLimit(0),
       _cumulativeFps(2),
       _isServicing(false),
       _isOffRefreshRequired(false),
       _hasWhiteChannel(false),
       _triggered(false),
+      _briDeferred(false),
       _modeCount(MODE_COUNT),
       _callback(nullptr),
       customMappingTable(nullptr),
       customMappingSize(0),
+      _mapRuns(nullptr),
+      _mapRunCount(0),
+      _mapRunHit(0),
       _lastShow(0),
-      _segment_index(0),
+      _frameCount(0),
+      _rngSeed(0),
+      _rngBoot(1),
       _mainSegment(0),
       _queuedChangesSegId(255),
       _qStart(0),
@@ -722,19 +1039,64 @@ class WS2812FX {  // 96 bytes
       _qStopY(0),
       _qGrouping(0),
       _qSpacing(0),
-      _qOffset(0)
+      _qCanvas(255),
+      _qOffset(0),
+      _segFrames{0},
+      _segFps{0},
+      _segFpsTime(0),
+      _numDue(0),
+      _dueNext(0),
+      _frameUs(0),
+      _frameShow(false),
+      _frameStartUs(0),
+      _leadUs(0),
+      _dueRun(0),
+      _dueYield(false),
+      _renderNow(0),
+      _sliceStart(0),
+      _bench(nullptr),
+      _benchReq(0),
+      _benchGoldenReq(0),
+      _benchGolden(0),
+      _benchMs(0),
+      _benchFx(255),
+      _benchSegs(0),
+      _overlay(nullptr),
+      _overlayLen(0),
+      _overlayCap(0),
+      _layerMode(SEG_BLEND_NORMAL),
+      _layerAlpha(255)
+#ifdef WLED_ENABLE_PIPELINED_OUTPUT
+      , _outputBusy(false)
+      , _outputTask(nullptr)
+      , _outputDone(nullptr)
+#endif
+#ifdef WLED_ENABLE_PARALLEL_RENDER
+      , _renderParallel(false)
+      , _renderTask(nullptr)
+      , _renderDone(nullptr)
+#endif
+#ifdef WLED_FRAME_CLOCK
+      , _clockTimer(nullptr)
+      , _clockTicks(0)
+      , _clockSeen(0)
+      , _clockEpoch(0)
+      , _clockFrame(0)
+      , _clockOverruns(0)
+      , _clockPeriod(0)
+#endif
     {
-      WS2812FX::instance = this;
-      _mode.reserve(_modeCount);     // allocate memory to prevent initial fragmentation (does not increase size())
-      _modeData.reserve(_modeCount); // allocate memory to prevent initial fragmentation (does not increase size())
-      if (_mode.capacity() <= 1 || _modeData.capacity() <= 1) _modeCount = 1; // memory allocation failed only show Solid
-      else setupEffectData();
+      WS2812FX::instance = this; // built-in effects need no setup, they are a table in flash
+      #ifdef ARDUINO_ARCH_ESP32
+      _segments.reserve(MAX_NUM_SEGMENTS); // segments are never reallocated, so they stay in place while JSON/UDP callbacks add or remove them
+      #endif
     }
 
     ~WS2812FX() {
-      if (customMappingTable) delete[] customMappingTable;
-      _mode.clear();
-      _modeData.clear();
+      freeMapping();
+      if (_bench) free(_bench);
+      clearOverlay(255);
+      _modeExt.clear();
       _segments.clear();
 #ifndef WLED_DISABLE_2D
       panel.clear();
@@ -754,10 +1116,11 @@ class WS2812FX {  // 96 bytes
       setColor(uint8_t slot, uint32_t c),
       setCCT(uint16_t k),
       setBrightness(uint8_t b, bool direct = false),
+      setFrameBrightness(uint8_t b),
       setRange(uint16_t i, uint16_t i2, uint32_t col),
       setTransitionMode(bool t),
       purgeSegments(bool force = false),
-      setSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t grouping = 1, uint8_t spacing = 0, uint16_t offset = UINT16_MAX, uint16_t startY=0, uint16_t stopY=1),
+      setSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t grouping = 1, uint8_t spacing = 0, uint16_t offset = UINT16_MAX, uint16_t startY=0, uint16_t stopY=1, uint8_t canvas=255),
       setMainSegmentId(uint8_t n),
       restartRuntime(),
       resetSegments(),
@@ -765,20 +1128,29 @@ class WS2812FX {  // 96 bytes
       fixInvalidSegments(),
       setPixelColor(int n, uint32_t c),
       show(void),
-      setTargetFps(uint8_t fps);
+      setTargetFps(uint8_t fps),
+      setFpsLimit(uint8_t fps),
+      updateWireLimit(void);
 
     void setColor(uint8_t slot, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) { setColor(slot, RGBW32(r,g,b,w)); }
     void fill(uint32_t c) { for (int i = 0; i < getLengthTotal(); i++) setPixelColor(i, c); } // fill whole strip with color (inline)
+    void writeRange(uint16_t start, uint16_t count, const uint32_t *c); // set contiguous run of pixels (bulk version of setPixelColor())
     void addEffect(uint8_t id, mode_ptr mode_fn, const char *mode_name); // add effect to the list; defined in FX.cpp
-    void setupEffectData(void); // add default effects to the list; defined in FX.cpp
 
     // outsmart the compiler :) by correctly overloading
     inline void setPixelColor(int n, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) { setPixelColor(n, RGBW32(r,g,b,w)); }
     inline void setPixelColor(int n, CRGB c) { setPixelColor(n, c.red, c.green, c.blue); }
     inline void trigger(void) { _triggered = true; } // Forces the next frame to be computed on all active segments.
     inline void setShowCallback(show_callback cb) { _callback = cb; }
+
+    // overlay layer: sparse pixels composited over every frame in show(), so overlays neither have to be drawn
+    // again for each frame nor end up in pixels effects read back; owners redraw their pixels only on change
+    void setOverlayPixel(uint16_t i, uint32_t c, uint8_t alpha = 255, uint8_t owner = 0);
+    void setOverlayRange(uint16_t i, uint16_t i2, uint32_t c, uint8_t alpha = 255, uint8_t owner = 0);
+    void clearOverlay(uint8_t owner = 0); // removes pixels of owner (255: all pixels)
+    inline uint16_t getOverlayPixels(void) { return _overlayLen; }
     inline void setTransition(uint16_t t) { _transitionDur = t; }
-    inline void appendSegment(const Segment &seg = Segment()) { if (_segments.size() < getMaxSegments()) _segments.push_back(seg); }
+    inline void appendSegment(const Segment &seg = Segment()) { if (_segments.size() < getMaxSegments()) _segments.emplace_back(seg); }
 
     bool
       checkSegmentAlignment(void),
@@ -788,7 +1160,22 @@ class WS2812FX {  // 96 bytes
       isUpdating(void),
       deserializeMap(uint8_t n=0);
 
+    uint32_t timeToNextRender(void); // ms until a segment is due (idle power management)
     inline bool isServicing(void) { return _isServicing; }
+    inline bool isRendering(void) { return _numDue; } // frame is being rendered in slices over several loop passes
+#ifdef WLED_ENABLE_PARALLEL_RENDER
+    inline bool isRenderingParallel(void) { return _renderParallel; } // render task is running effect functions
+#else
+    inline bool isRenderingParallel(void) { return false; }
+#endif
+#ifdef WLED_FRAME_CLOCK
+    inline uint32_t getClockOverruns(void) { return _clockOverruns; } // frame clock ticks that passed without a frame
+#endif
+#ifdef WLED_ENABLE_PIPELINED_OUTPUT
+    void waitForOutput(void); // blocks until output task has finished sending previous frame
+#else
+    inline void waitForOutput(void) {}
+#endif
     inline bool hasWhiteChannel(void) {return _hasWhiteChannel;}
     inline bool isOffRefreshRequired(void) {return _isOffRefreshRequired;}
 
@@ -806,10 +1193,12 @@ class WS2812FX {  // 96 bytes
     inline uint8_t getBrightness(void) { return _brightness; }
     inline uint8_t getMaxSegments(void) { return MAX_NUM_SEGMENTS; }  // returns maximum number of supported segments (fixed value)
     inline uint8_t getSegmentsNum(void) { return _segments.size(); }  // returns currently present segments
-    inline uint8_t getCurrSegmentId(void) { return _segment_index; }
+    inline uint8_t getCurrSegmentId(void) { return _renderCtx[RENDER_CTX()].segIndex; }
     inline uint8_t getMainSegmentId(void) { return _mainSegment; }
     inline uint8_t getPaletteCount() { return 13 + GRADIENT_PALETTE_COUNT; }  // will only return built-in palette count
     inline uint8_t getTargetFps() { return _targetFps; }
+    inline uint16_t getWireFps() { return _wireFps; }  // highest frame rate all busses can show (0 = not limited by output)
+    inline int8_t  getWireBus() { return _wireBus; }   // bus with longest wire time (-1 none)
     inline uint8_t getModeCount() { return _modeCount; }
 
     uint16_t
@@ -823,6 +1212,8 @@ class WS2812FX {  // 96 bytes
     inline uint16_t getMinShowDelay(void) { return MIN_SHOW_DELAY; }
     inline uint16_t getLength(void) { return _length; } // 2D matrix may have less pixels than W*H
     inline uint16_t getTransition(void) { return _transitionDur; }
+    // logical to physical pixel (ledmap), either dense table or runs (see compactMapping())
+    inline uint16_t getMappedPixelIndex(uint16_t i) { return i < customMappingSize ? (customMappingTable ? customMappingTable[i] : mapRunIndex(i)) : i; }
 
     uint32_t
       now,
@@ -830,13 +1221,26 @@ class WS2812FX {  // 96 bytes
       getPixelColor(uint16_t);
 
     inline uint32_t getLastShow(void) { return _lastShow; }
-    inline uint32_t segColor(uint8_t i) { return _colors_t[i]; }
-
-    const char *
-      getModeData(uint8_t id = 0) { return (id && id<_modeCount) ? _modeData[id] : PSTR("Solid"); }
-
-    const char **
-      getModeDataSrc(void) { return &(_modeData[0]); } // vectors use arrays for underlying data
+    inline uint32_t getRandomSeed(void) { return _rngSeed; }
+    void setRandomSeed(uint32_t seed); // restarts all effects
+    inline uint32_t getFrameCount(void) { return _frameCount; }
+    inline const fx_stats_t* getEffectStats(void)  { return _fxStats; }  // FX_STATS_SLOTS entries
+    inline const fx_stats_t* getSegmentStats(void) { return _segStats; } // MAX_NUM_SEGMENTS entries (by segment index)
+    inline const fx_stats_t& getOutputStats(void)  { return _outStats; }  // time spent in busses.show() (conversion, starting transfer)
+    inline const fx_stats_t& getWaitStats(void)    { return _waitStats; } // time blocked waiting for previous frame to be sent
+    static uint32_t getStatsBucketLimit(uint8_t b);                      // upper limit of histogram bucket (us)
+    inline uint8_t getSegmentFps(uint8_t id) { return id < MAX_NUM_SEGMENTS ? _segFps[id] : 0; }
+    void resetEffectStats(void);
+    inline void startBenchmark(uint16_t msPerFx) { _benchGoldenReq = 0; _benchReq = msPerFx; } // runs from service(), LEDs are not updated meanwhile
+    inline void startGoldenRun(uint16_t frames) { _benchGoldenReq = frames; _benchReq = 1; } // renders each effect deterministically, hashes output
+    inline bool isBenchmarking(void) { return _benchReq || _benchFx != 255; }
+    inline uint16_t getGoldenFrames(void) { return _benchGolden; }       // frames per effect of last golden run (0: timed benchmark)
+    inline uint8_t getBenchmarkProgress(void) { return _benchFx; }        // effect currently measured (255 if idle)
+    inline const bench_result_t* getBenchmarkResults(void) { return _bench; } // getModeCount() entries (or nullptr)
+    inline uint32_t segColor(uint8_t i) { return _renderCtx[RENDER_CTX()].colors[i]; }
+
+    const char *getModeData(uint8_t id = 0); // mode (effect) name and its UI control data (PROGMEM); defined in FX.cpp
+    mode_ptr    getModeFn(uint8_t id);        // mode (effect) function (Solid if id is reserved); defined in FX.cpp
 
     Segment&        getSegment(uint8_t id);
     inline Segment& getFirstSelectedSeg(void) { return _segments[getFirstSelectedSegId()]; }
@@ -866,21 +1270,41 @@ class WS2812FX {  // 96 bytes
           bool serpentine  : 1; // is serpentine?
         };
       };
+      uint8_t  ip[4];   // follower receiving this panel from a DDP tiles bus (0.0.0.0 if none)
+      uint8_t  canvas;  // canvas the panel is part of (offsets are relative to its top left)
       panel_t()
         : xOffset(0)
         , yOffset(0)
         , width(8)
         , height(8)
         , options(0)
+        , ip{0,0,0,0}
+        , canvas(0)
       {}
     } Panel;
     std::vector<Panel> panel;
+
+    // independent matrix built from the panels bound to it; logical pixels of the canvases follow one
+    // another (row-major each), so mapping holds no holes between differently shaped matrices
+    #define WLED_MAX_CANVASES 4
+    typedef struct canvas_t {
+      uint16_t offset; // first logical pixel
+      uint16_t width;
+      uint16_t height;
+    } Canvas;
+    std::vector<Canvas> canvas;
+    inline Canvas getCanvas(uint8_t c) const { return c < canvas.size() ? canvas[c] : Canvas{0, Segment::maxWidth, Segment::maxHeight}; }
+    inline uint8_t getCanvasCount(void) const { return canvas.size(); }
 #endif
 
     void setUpMatrix();
 
     // outsmart the compiler :) by correctly overloading
-    inline void setPixelColorXY(int x, int y, uint32_t c)   { setPixelColor(y * Segment::maxWidth + x, c); }
+#ifndef WLED_DISABLE_2D
+    inline void setPixelColorXY(const Canvas &cv, int x, int y, uint32_t c) { setPixelColor(cv.offset + y * cv.width + x, c); }
+    inline uint32_t getPixelColorXY(const Canvas &cv, int x, int y) { return getPixelColor(cv.offset + y * cv.width + x); }
+#endif
+    inline void setPixelColorXY(int x, int y, uint32_t c)   { setPixelColor(y * Segment::maxWidth + x, c); } // primary canvas
     inline void setPixelColorXY(int x, int y, byte r, byte g, byte b, byte w = 0) { setPixelColorXY(x, y, RGBW32(r,g,b,w)); }
     inline void setPixelColorXY(int x, int y, CRGB c)       { setPixelColorXY(x, y, RGBW32(c.r,c.g,c.b,0)); }
 
@@ -888,24 +1312,35 @@ class WS2812FX {  // 96 bytes
 
   // end 2D support
 
-    void loadCustomPalettes(void); // loads custom palettes from JSON
+    void loadCustomPalettes(bool reparse = false); // loads custom palettes from binary cache or JSON
     std::vector<CRGBPalette16> customPalettes; // TODO: move custom palettes out of WS2812FX class
 
     // using public variables to reduce code size increase due to inline function getSegment() (with bounds checking)
     // and color transitions
-    uint32_t _colors_t[3]; // color used for effect (includes transition)
-    uint16_t _virtualSegmentLength;
+    // state of the effect function being run (one context per core with parallel rendering)
+    struct {
+      uint32_t colors[3]; // color used for effect (includes transition)
+      uint16_t vLength;   // SEGLEN
+      uint8_t  segIndex;  // SEGMENT
+      uint16_t *rng;      // random number stream of SEGMENT
+    } _renderCtx[WLED_RENDER_CTX];
 
-    std::vector<segment> _segments;
+    std::vector<segment> _segments; // storage is reserved for MAX_NUM_SEGMENTS on ESP32 (see constructor)
     friend class Segment;
 
   private:
+    bool loadPaletteCache(uint32_t srcHash);
+    void savePaletteCache(uint32_t srcHash);
+
     uint16_t _length;
     uint8_t  _brightness;
     uint16_t _transitionDur;
 
     uint8_t  _targetFps;
     uint16_t _frametime;
+    uint16_t _wireFps;    // caps _targetFps
+    int8_t   _wireBus;
+    uint8_t  _fpsLimit;   // temporary cap (i.e. during OTA), not saved
     uint16_t _cumulativeFps;
 
     // will require only 1 byte
@@ -914,31 +1349,116 @@ class WS2812FX {  // 96 bytes
       bool _isOffRefreshRequired : 1; //periodic refresh is required for the strip to remain off.
       bool _hasWhiteChannel      : 1;
       bool _triggered            : 1;
+      bool _briDeferred          : 1; //brightness is handed to the busses when the next frame is composited
     };
 
     uint8_t                  _modeCount;
-    std::vector<mode_ptr>    _mode;     // SRAM footprint: 4 bytes per element
-    std::vector<const char*> _modeData; // mode (effect) name and its slider control data array
+    std::vector<mode_data_t> _modeExt;  // effects added by usermods (built-in ones are in flash)
+    const mode_data_t *findModeExt(uint8_t id);
 
     show_callback _callback;
 
     uint16_t* customMappingTable;
-    uint16_t  customMappingSize;
+    uint16_t  customMappingSize;  // logical pixels mapped (by customMappingTable or _mapRuns)
+    map_run_t* _mapRuns;          // replaces customMappingTable if that is smaller
+    uint16_t  _mapRunCount;
+    uint16_t  _mapRunHit;         // run of last lookup, consecutive pixels are mostly in the same run
 
     unsigned long _lastShow;
+    volatile uint32_t _frameCount; // frames shown (incremented once output of a frame was started)
+    uint32_t _rngSeed;            // seed of effect random number streams (0: _rngBoot)
+    uint32_t _rngBoot;            // random seed chosen at boot
 
-    uint8_t _segment_index;
     uint8_t _mainSegment;
     uint8_t _queuedChangesSegId;
     uint16_t _qStart, _qStop, _qStartY, _qStopY;
-    uint8_t _qGrouping, _qSpacing;
+    uint8_t _qGrouping, _qSpacing, _qCanvas;
     uint16_t _qOffset;
 
-    uint8_t
-      estimateCurrentAndLimitBri(void);
+    fx_stats_t _fxStats[FX_STATS_SLOTS];
+    fx_stats_t _segStats[MAX_NUM_SEGMENTS];
+    fx_stats_t _outStats;
+    fx_stats_t _waitStats;
+    uint16_t   _segFrames[MAX_NUM_SEGMENTS]; // frames rendered per segment since _segFpsTime
+    uint8_t    _segFps[MAX_NUM_SEGMENTS];    // achieved frame rate per segment (updated every second)
+    unsigned long _segFpsTime;
+
+    // frame in progress (rendered in slices of WLED_RENDER_SLICE_US)
+    uint8_t    _due[MAX_NUM_SEGMENTS];       // segments due in this frame, by deadline (255: deferred to next frame)
+    uint32_t   _dueSpent[MAX_NUM_SEGMENTS];  // render time of each (us)
+    uint8_t    _numDue, _dueNext;            // _numDue > 0 while frame is in progress, _dueNext is the resume cursor
+    uint32_t   _frameUs;                     // render time of this frame so far (us)
+    bool       _frameShow;
+    uint32_t   _frameStartUs;                // micros() when frame was started
+    uint32_t   _leadUs;                      // smoothed time from start of frame to show() (us), frames start this early
+    uint8_t    _dueRun;                      // segments taken for rendering in this pass
+    bool       _dueYield;                    // render slice expired, no more segments are taken in this pass
+    unsigned long _renderNow;                // millis() of this pass
+    unsigned long _sliceStart;               // micros() at start of this pass
+
+    bench_result_t   *_bench;
+    volatile uint16_t _benchReq;   // benchmark requested (ms per effect), may be set from network callback
+    volatile uint16_t _benchGoldenReq; // golden run requested (frames per effect)
+    uint16_t          _benchGolden;    // frames per effect of golden run, 0 for timed benchmark
+    uint16_t          _benchMs;
+    uint8_t           _benchFx;    // effect being measured
+    uint8_t           _benchSaved[MAX_NUM_SEGMENTS]; // segment modes before benchmark
+    uint8_t           _benchSegs;  // number of entries in _benchSaved[]
+
+    overlay_px_t *_overlay;        // in order of drawing
+    uint16_t      _overlayLen, _overlayCap;
+
+    uint8_t _layerMode, _layerAlpha; // blend mode & opacity applied by setPixelColor()/writeRange() while a segment is composited
+
+    uint16_t mapRunIndex(uint16_t i);
+    void writeBusRange(uint16_t start, uint16_t count, const uint32_t *c);
 
     void
+      freeMapping(void),
+      compactMapping(void),
+      compositeOverlay(void),
+      compositeSegments(void),
+      serviceBenchmark(void),
+      serviceGolden(uint8_t fx),
+      estimateCurrentAndLimitBri(void),
+      showNow(void), // limit current and send pixel data to busses
+      renderDue(bool main), // renders due segments of current pass (called from loop() and render task)
+      recordEffectTime(uint8_t segId, uint8_t fx, uint32_t us),
       setUpSegmentFromQueuedChanges(void);
+
+    bool storeBrightness(uint8_t b);
+
+#ifndef WLED_DISABLE_2D
+    void     appendCanvasSegments(void);                             // one segment per canvas
+    uint32_t matrixMapKey(void);                                     // hash of panel layout and gaps file
+    bool     loadMatrixMap(uint32_t key, uint16_t *table, uint16_t len); // matrix mapping cached on FS
+    void     saveMatrixMap(uint32_t key, const uint16_t *table, uint16_t len);
+#endif
+
+#ifdef WLED_ENABLE_PIPELINED_OUTPUT
+    volatile bool     _outputBusy; // output task is sending a frame, do not touch bus buffers
+    TaskHandle_t      _outputTask;
+    SemaphoreHandle_t _outputDone;
+    static void outputTask(void *parameter);
+#endif
+#ifdef WLED_FRAME_CLOCK
+    esp_timer_handle_t _clockTimer;
+    volatile uint32_t  _clockTicks;    // incremented by timer every _clockPeriod ms
+    uint32_t           _clockSeen;     // tick the current frame belongs to
+    unsigned long      _clockEpoch;    // millis() at tick 0
+    unsigned long      _clockFrame;    // scheduled time of current frame (millis() time base)
+    uint32_t           _clockOverruns;
+    uint16_t           _clockPeriod;   // _frametime the timer runs at
+    void startFrameClock(void);
+    bool frameClockTick(void);
+    static void clockTick(void *parameter);
+#endif
+#ifdef WLED_ENABLE_PARALLEL_RENDER
+    volatile bool     _renderParallel; // render task takes due segments in this pass
+    TaskHandle_t      _renderTask;
+    SemaphoreHandle_t _renderDone;
+    static void renderTask(void *parameter);
+#endif
 };
 
 extern const char JSON_mode_names[];
@@ -26,127 +26,204 @@
 #include "FX.h"
 #include "palettes.h"
 
+#ifndef WLED_DISABLE_2D
+// binary cache of matrix mapping "/2d-map.bin": "WM2D", uint32 key, uint16 number of entries, uint16 entries (little endian)
+static const char matrixMapFile[] PROGMEM = "/2d-map.bin";
+#define MATRIX_MAP_VERSION 1 // bump when the mapping algorithm or the cache format changes (invalidates stored maps)
+
+// hash of everything mapping depends on: map version, canvas sizes, panels and contents of gaps file
+uint32_t WS2812FX::matrixMapKey() {
+  const uint8_t version = MATRIX_MAP_VERSION;
+  uint32_t h = fnv1a(&version, 1);
+  for (const Canvas &c : canvas) {
+    uint16_t d[3] = { c.offset, c.width, c.height };
+    h = fnv1a(d, sizeof(d), h);
+  }
+  for (const Panel &p : panel) {
+    uint8_t d[8] = { uint8_t(p.xOffset), uint8_t(p.xOffset >> 8), uint8_t(p.yOffset), uint8_t(p.yOffset >> 8), p.width, p.height, p.options, p.canvas };
+    h = fnv1a(d, sizeof(d), h);
+  }
+  char fileName[16]; strcpy_P(fileName, PSTR("/2d-gaps.json"));
+  File f = WLED_FS.open(fileName, "r");
+  if (f) {
+    uint8_t buf[64];
+    size_t r;
+    while ((r = f.read(buf, sizeof(buf))) > 0) h = fnv1a(buf, r, h);
+    f.close();
+  }
+  return h;
+}
+
+bool WS2812FX::loadMatrixMap(uint32_t key, uint16_t *table, uint16_t len) {
+  char fileName[16]; strcpy_P(fileName, matrixMapFile);
+  File f = WLED_FS.open(fileName, "r");
+  if (!f) return false;
+  uint8_t hdr[10];
+  bool ok = f.read(hdr, sizeof(hdr)) == sizeof(hdr) && !strncmp_P((const char*)hdr, PSTR("WM2D"), 4)
+         && (hdr[4] | (hdr[5] << 8) | (hdr[6] << 16) | (uint32_t(hdr[7]) << 24)) == key
+         && (hdr[8] | (hdr[9] << 8)) == len
+         && f.read((uint8_t*)table, len * sizeof(uint16_t)) == len * sizeof(uint16_t); // stored as-is (little endian like ESP)
+  f.close();
+  if (ok) DEBUG_PRINTLN(F("Matrix ledmap loaded from cache."));
+  else    memset(table, 0xFF, len * sizeof(uint16_t)); // may have been partially overwritten
+  return ok;
+}
+
+void WS2812FX::saveMatrixMap(uint32_t key, const uint16_t *table, uint16_t len) {
+  char fileName[16]; strcpy_P(fileName, matrixMapFile);
+  File f = WLED_FS.open(fileName, "w");
+  if (!f) return;
+  uint8_t hdr[10] = { 'W', 'M', '2', 'D', uint8_t(key), uint8_t(key >> 8), uint8_t(key >> 16), uint8_t(key >> 24), uint8_t(len), uint8_t(len >> 8) };
+  f.write(hdr, sizeof(hdr));
+  f.write((const uint8_t*)table, len * sizeof(uint16_t));
+  f.close();
+  DEBUG_PRINTLN(F("Matrix ledmap cached."));
+}
+#endif
+
 // setUpMatrix() - constructs ledmap array from matrix of panels with WxH pixels
 // this converts physical (possibly irregular) LED arrangement into well defined
 // array of logical pixels: fist entry corresponds to left-topmost logical pixel
-// followed by horizontal pixels, when Segment::maxWidth logical pixels are added they
-// are followed by next row (down) of Segment::maxWidth pixels (and so forth)
+// followed by horizontal pixels, when canvas width logical pixels are added they
+// are followed by next row (down) of canvas width pixels (and so forth)
+// panels are grouped into canvases (Panel::canvas), each canvas is sized to its own
+// panels and its logical pixels follow those of the previous canvas
 // note: matrix may be comprised of multiple panels each with different orientation
 // but ledmap takes care of that. ledmap is constructed upon initialization
 // so matrix should disable regular ledmap processing
 void WS2812FX::setUpMatrix() {
 #ifndef WLED_DISABLE_2D
   // erase old ledmap, just in case.
-  if (customMappingTable != nullptr) delete[] customMappingTable;
-  customMappingTable = nullptr;
-  customMappingSize = 0;
+  freeMapping();
+  canvas.clear();
 
   // isMatrix is set in cfg.cpp or set.cpp
   if (isMatrix) {
-    // calculate width dynamically because it will have gaps
-    Segment::maxWidth = 1;
-    Segment::maxHeight = 1;
-    for (size_t i = 0; i < panel.size(); i++) {
-      Panel &p = panel[i];
-      if (p.xOffset + p.width > Segment::maxWidth) {
-        Segment::maxWidth = p.xOffset + p.width;
-      }
-      if (p.yOffset + p.height > Segment::maxHeight) {
-        Segment::maxHeight = p.yOffset + p.height;
-      }
+    // calculate canvas sizes dynamically because they will have gaps
+    unsigned canvases = 1;
+    for (const Panel &p : panel) if (p.canvas >= canvases) canvases = MIN(p.canvas + 1, WLED_MAX_CANVASES);
+    canvas.resize(canvases, Canvas{0, 1, 1});
+    for (Panel &p : panel) {
+      if (p.canvas >= canvases) p.canvas = canvases - 1;
+      Canvas &c = canvas[p.canvas];
+      if (p.xOffset + p.width  > c.width)  c.width  = p.xOffset + p.width;
+      if (p.yOffset + p.height > c.height) c.height = p.yOffset + p.height;
+    }
+    unsigned area = 0;
+    bool valid = true;
+    for (Canvas &c : canvas) {
+      c.offset = area;
+      area += c.width * c.height;
+      valid &= c.width > 1 && c.height > 1; // also catches canvases without panels
     }
+    Segment::maxWidth  = canvas[0].width;
+    Segment::maxHeight = canvas[0].height;
 
     // safety check
-    if (Segment::maxWidth * Segment::maxHeight > MAX_LEDS || Segment::maxWidth <= 1 || Segment::maxHeight <= 1) {
+    if (area > MAX_LEDS || !valid) {
       DEBUG_PRINTLN(F("2D Bounds error."));
       isMatrix = false;
       Segment::maxWidth = _length;
       Segment::maxHeight = 1;
+      Segment::matrixArea = _length;
       panels = 0;
       panel.clear(); // release memory allocated by panels
+      canvas.clear();
       resetSegments();
       return;
     }
+    Segment::matrixArea = area;
 
-    customMappingTable = new uint16_t[Segment::maxWidth * Segment::maxHeight];
+    customMappingTable = (uint16_t*) callocLarge(area, sizeof(uint16_t)); // PSRAM for large canvases
 
     if (customMappingTable != nullptr) {
-      customMappingSize = Segment::maxWidth * Segment::maxHeight;
+      customMappingSize = area;
 
       // fill with empty in case we don't fill the entire matrix
       for (size_t i = 0; i< customMappingSize; i++) {
         customMappingTable[i] = (uint16_t)-1;
       }
 
-      // we will try to load a "gap" array (a JSON file)
-      // the array has to have the same amount of values as mapping array (or larger)
-      // "gap" array is used while building ledmap (mapping array)
-      // and discarded afterwards as it has no meaning after the process
-      // content of the file is just raw JSON array in the form of [val1,val2,val3,...]
-      // there are no other "key":"value" pairs in it
-      // allowed values are: -1 (missing pixel/no LED attached), 0 (inactive/unused pixel), 1 (active/used pixel)
-      char    fileName[32]; strcpy_P(fileName, PSTR("/2d-gaps.json")); // reduce flash footprint
-      bool    isFile = WLED_FS.exists(fileName);
-      size_t  gapSize = 0;
-      int8_t *gapTable = nullptr;
-
-      if (isFile && requestJSONBufferLock(20)) {
-        DEBUG_PRINT(F("Reading LED gap from "));
-        DEBUG_PRINTLN(fileName);
-        // read the array into global JSON buffer
-        if (readObjectFromFile(fileName, nullptr, &doc)) {
-          // the array is similar to ledmap, except it has only 3 values:
-          // -1 ... missing pixel (do not increase pixel count)
-          //  0 ... inactive pixel (it does count, but should be mapped out (-1))
-          //  1 ... active pixel (it will count and will be mapped)
-          JsonArray map = doc.as<JsonArray>();
-          gapSize = map.size();
-          if (!map.isNull() && gapSize >= customMappingSize) { // not an empty map
-            gapTable = new int8_t[gapSize];
-            if (gapTable) for (size_t i = 0; i < gapSize; i++) {
-              gapTable[i] = constrain(map[i], -1, 1);
+      // mapping only depends on panel layout and gaps file, reuse table built on previous boot if those did not change
+      const uint32_t mapKey = matrixMapKey();
+      if (!loadMatrixMap(mapKey, customMappingTable, customMappingSize)) {
+        // we will try to load a "gap" array (a JSON file)
+        // the array has to have the same amount of values as mapping array (or larger)
+        // "gap" array is used while building ledmap (mapping array)
+        // and discarded afterwards as it has no meaning after the process
+        // content of the file is just raw JSON array in the form of [val1,val2,val3,...]
+        // there are no other "key":"value" pairs in it
+        // allowed values are: -1 (missing pixel/no LED attached), 0 (inactive/unused pixel), 1 (active/used pixel)
+        char    fileName[32]; strcpy_P(fileName, PSTR("/2d-gaps.json")); // reduce flash footprint
+        bool    isFile = WLED_FS.exists(fileName);
+        size_t  gapSize = 0;
+        int8_t *gapTable = nullptr;
+        bool    gapsRead = !isFile; // do not cache mapping built without gaps because JSON buffer was busy
+
+        if (isFile && requestJSONBufferLock(JSON_LOCK_2D_GAPS)) {
+          gapsRead = true;
+          DEBUG_PRINT(F("Reading LED gap from "));
+          DEBUG_PRINTLN(fileName);
+          // read the array into global JSON buffer
+          if (readObjectFromFile(fileName, nullptr, &doc)) {
+            // the array is similar to ledmap, except it has only 3 values:
+            // -1 ... missing pixel (do not increase pixel count)
+            //  0 ... inactive pixel (it does count, but should be mapped out (-1))
+            //  1 ... active pixel (it will count and will be mapped)
+            JsonArray map = doc.as<JsonArray>();
+            gapSize = map.size();
+            if (!map.isNull() && gapSize >= customMappingSize) { // not an empty map
+              gapTable = new int8_t[gapSize];
+              if (gapTable) for (size_t i = 0; i < gapSize; i++) {
+                gapTable[i] = constrain(map[i], -1, 1);
+              }
             }
           }
+          DEBUG_PRINTLN(F("Gaps loaded."));
+          releaseJSONBufferLock();
         }
-        DEBUG_PRINTLN(F("Gaps loaded."));
-        releaseJSONBufferLock();
-      }
 
-      uint16_t x, y, pix=0; //pixel
-      for (size_t pan = 0; pan < panel.size(); pan++) {
-        Panel &p = panel[pan];
-        uint16_t h = p.vertical ? p.height : p.width;
-        uint16_t v = p.vertical ? p.width  : p.height;
-        for (size_t j = 0; j < v; j++){
-          for(size_t i = 0; i < h; i++) {
-            y = (p.vertical?p.rightStart:p.bottomStart) ? v-j-1 : j;
-            x = (p.vertical?p.bottomStart:p.rightStart) ? h-i-1 : i;
-            x = p.serpentine && j%2 ? h-x-1 : x;
-            size_t index = (p.yOffset + (p.vertical?x:y)) * Segment::maxWidth + p.xOffset + (p.vertical?y:x);
-            if (!gapTable || (gapTable && gapTable[index] >  0)) customMappingTable[index] = pix; // a useful pixel (otherwise -1 is retained)
-            if (!gapTable || (gapTable && gapTable[index] >= 0)) pix++; // not a missing pixel
+        uint16_t x, y, pix=0; //pixel
+        for (size_t pan = 0; pan < panel.size(); pan++) {
+          Panel &p = panel[pan];
+          const Canvas &c = canvas[p.canvas];
+          uint16_t h = p.vertical ? p.height : p.width;
+          uint16_t v = p.vertical ? p.width  : p.height;
+          for (size_t j = 0; j < v; j++){
+            for(size_t i = 0; i < h; i++) {
+              y = (p.vertical?p.rightStart:p.bottomStart) ? v-j-1 : j;
+              x = (p.vertical?p.bottomStart:p.rightStart) ? h-i-1 : i;
+              x = p.serpentine && j%2 ? h-x-1 : x;
+              size_t index = c.offset + (p.yOffset + (p.vertical?x:y)) * c.width + p.xOffset + (p.vertical?y:x);
+              if (!gapTable || (gapTable && gapTable[index] >  0)) customMappingTable[index] = pix; // a useful pixel (otherwise -1 is retained)
+              if (!gapTable || (gapTable && gapTable[index] >= 0)) pix++; // not a missing pixel
+            }
           }
         }
-      }
 
-      // delete gap array as we no longer need it
-      if (gapTable) delete[] gapTable;
+        // delete gap array as we no longer need it
+        if (gapTable) delete[] gapTable;
+        if (gapsRead) saveMatrixMap(mapKey, customMappingTable, customMappingSize);
+      }
 
       #ifdef WLED_DEBUG
       DEBUG_PRINT(F("Matrix ledmap:"));
-      for (unsigned i=0; i<customMappingSize; i++) {
-        if (!(i%Segment::maxWidth)) DEBUG_PRINTLN();
-        DEBUG_PRINTF("%4d,", customMappingTable[i]);
+      for (const Canvas &c : canvas) for (unsigned i=0; i<unsigned(c.width*c.height); i++) {
+        if (!(i%c.width)) DEBUG_PRINTLN();
+        DEBUG_PRINTF("%4d,", customMappingTable[c.offset + i]);
       }
       DEBUG_PRINTLN();
       #endif
+      compactMapping(); // serpentine and plain panels compress to a run per row
     } else { // memory allocation error
       DEBUG_PRINTLN(F("Ledmap alloc error."));
       isMatrix = false;
       panels = 0;
       panel.clear();
+      canvas.clear();
       Segment::maxWidth = _length;
       Segment::maxHeight = 1;
+      Segment::matrixArea = _length;
       resetSegments();
     }
   }
@@ -172,109 +249,105 @@ uint16_t IRAM_ATTR Segment::XY(uint16_t x, uint16_t y)
 
 void IRAM_ATTR Segment::setPixelColorXY(int x, int y, uint32_t col)
 {
-  if (!isActive()) return; // not active
-  if (x >= virtualWidth() || y >= virtualHeight() || x<0 || y<0) return;  // if pixel would fall out of virtual segment just exit
-
-  uint8_t _bri_t = currentBri();
-  if (_bri_t < 255) {
-    byte r = scale8(R(col), _bri_t);
-    byte g = scale8(G(col), _bri_t);
-    byte b = scale8(B(col), _bri_t);
-    byte w = scale8(W(col), _bri_t);
-    col = RGBW32(r, g, b, w);
-  }
+  if (!isActive() || !_pixels) return; // not active or no pixel buffer
+  const int vW = virtualWidth();
+  if (x >= vW || y >= virtualHeight() || x<0 || y<0) return;  // if pixel would fall out of virtual segment just exit
+  const unsigned i = x + y * vW;
+  if (i >= _pixelsLen) return; // geometry changed but buffer not yet reallocated
+  _pixels[i] = col; // when blending modes each mode has its own buffer, they are crossfaded in renderToStrip()
+}
 
-  if (reverse  ) x = virtualWidth()  - x - 1;
-  if (reverse_y) y = virtualHeight() - y - 1;
+// expand logical pixel (taking into account reverse, transpose, grouping and mirroring) and write it to strip
+void IRAM_ATTR Segment::renderPixelXY(int x, int y, uint32_t col)
+{
+  if (reverse  ) x = _rWidth  - x - 1; // rendered size (effect canvas may be smaller, see renderScale)
+  if (reverse_y) y = _rHeight - y - 1;
   if (transpose) { uint16_t t = x; x = y; y = t; } // swap X & Y if segment transposed
 
   x *= groupLength(); // expand to physical pixels
   y *= groupLength(); // expand to physical pixels
   if (x >= width() || y >= height()) return;  // if pixel would fall out of segment just exit
+  const WS2812FX::Canvas cv = strip.getCanvas(canvasIdx);
 
-  uint32_t tmpCol = col;
   for (int j = 0; j < grouping; j++) {   // groupping vertically
     for (int g = 0; g < grouping; g++) { // groupping horizontally
       uint16_t xX = (x+g), yY = (y+j);
       if (xX >= width() || yY >= height()) continue; // we have reached one dimension's end
 
-#ifndef WLED_DISABLE_MODE_BLEND
-      // if blending modes, blend with underlying pixel
-      if (_modeBlend) tmpCol = color_blend(strip.getPixelColorXY(start + xX, startY + yY), col, 0xFFFFU - progress(), true);
-#endif
-
-      strip.setPixelColorXY(start + xX, startY + yY, tmpCol);
+      strip.setPixelColorXY(cv, start + xX, startY + yY, col);
 
       if (mirror) { //set the corresponding horizontally mirrored pixel
-        if (transpose) strip.setPixelColorXY(start + xX, startY + height() - yY - 1, tmpCol);
-        else           strip.setPixelColorXY(start + width() - xX - 1, startY + yY, tmpCol);
+        if (transpose) strip.setPixelColorXY(cv, start + xX, startY + height() - yY - 1, col);
+        else           strip.setPixelColorXY(cv, start + width() - xX - 1, startY + yY, col);
       }
       if (mirror_y) { //set the corresponding vertically mirrored pixel
-        if (transpose) strip.setPixelColorXY(start + width() - xX - 1, startY + yY, tmpCol);
-        else           strip.setPixelColorXY(start + xX, startY + height() - yY - 1, tmpCol);
+        if (transpose) strip.setPixelColorXY(cv, start + width() - xX - 1, startY + yY, col);
+        else           strip.setPixelColorXY(cv, start + xX, startY + height() - yY - 1, col);
       }
       if (mirror_y && mirror) { //set the corresponding vertically AND horizontally mirrored pixel
-        strip.setPixelColorXY(width() - xX - 1, height() - yY - 1, tmpCol);
+        strip.setPixelColorXY(cv, start + width() - xX - 1, startY + height() - yY - 1, col);
       }
     }
   }
 }
 
-// anti-aliased version of setPixelColorXY()
+// anti-aliased version of setPixelColorXY(), uses fixed point version
 void Segment::setPixelColorXY(float x, float y, uint32_t col, bool aa)
 {
-  if (!isActive()) return; // not active
   if (x<0.0f || x>1.0f || y<0.0f || y>1.0f) return; // not normalized
+  setPixelColorXYQ16(uint16_t(x * 65535.0f + 0.5f), uint16_t(y * 65535.0f + 0.5f), col, aa);
+}
 
-  const uint16_t cols = virtualWidth();
-  const uint16_t rows = virtualHeight();
-
-  float fX = x * (cols-1);
-  float fY = y * (rows-1);
-  if (aa) {
-    uint16_t xL = roundf(fX-0.49f);
-    uint16_t xR = roundf(fX+0.49f);
-    uint16_t yT = roundf(fY-0.49f);
-    uint16_t yB = roundf(fY+0.49f);
-    float    dL = (fX - xL)*(fX - xL);
-    float    dR = (xR - fX)*(xR - fX);
-    float    dT = (fY - yT)*(fY - yT);
-    float    dB = (yB - fY)*(yB - fY);
-    uint32_t cXLYT = getPixelColorXY(xL, yT);
-    uint32_t cXRYT = getPixelColorXY(xR, yT);
-    uint32_t cXLYB = getPixelColorXY(xL, yB);
-    uint32_t cXRYB = getPixelColorXY(xR, yB);
-
-    if (xL!=xR && yT!=yB) {
-      setPixelColorXY(xL, yT, color_blend(col, cXLYT, uint8_t(sqrtf(dL*dT)*255.0f))); // blend TL pixel
-      setPixelColorXY(xR, yT, color_blend(col, cXRYT, uint8_t(sqrtf(dR*dT)*255.0f))); // blend TR pixel
-      setPixelColorXY(xL, yB, color_blend(col, cXLYB, uint8_t(sqrtf(dL*dB)*255.0f))); // blend BL pixel
-      setPixelColorXY(xR, yB, color_blend(col, cXRYB, uint8_t(sqrtf(dR*dB)*255.0f))); // blend BR pixel
-    } else if (xR!=xL && yT==yB) {
-      setPixelColorXY(xR, yT, color_blend(col, cXLYT, uint8_t(dL*255.0f))); // blend L pixel
-      setPixelColorXY(xR, yT, color_blend(col, cXRYT, uint8_t(dR*255.0f))); // blend R pixel
-    } else if (xR==xL && yT!=yB) {
-      setPixelColorXY(xR, yT, color_blend(col, cXLYT, uint8_t(dT*255.0f))); // blend T pixel
-      setPixelColorXY(xL, yB, color_blend(col, cXLYB, uint8_t(dB*255.0f))); // blend B pixel
-    } else {
-      setPixelColorXY(xL, yT, col); // exact match (x & y land on a pixel)
-    }
+// anti-aliased setPixelColorXY(), x & y are normalized positions (65535 = 1.0)
+void Segment::setPixelColorXYQ16(uint16_t x, uint16_t y, uint32_t col, bool aa)
+{
+  uint32_t *buf = canvas();
+  if (!buf) return; // not active or no pixel buffer
+  const unsigned cols = virtualWidth();
+  const unsigned rows = virtualHeight();
+
+  uint32_t fX = x * uint32_t(cols-1);
+  uint32_t fY = y * uint32_t(rows-1);
+  fX += fX >> 16; // pixel position in Q16 (* 65536/65535)
+  fY += fY >> 16;
+  const unsigned nX = fX >> 16, nY = fY >> 16;
+  const uint32_t dX = fX & 0xFFFF, dY = fY & 0xFFFF; // distance to left/top pixel
+  if (!aa) {
+    const unsigned pX = MIN(dX >= 32768 ? nX+1 : nX, cols-1), pY = MIN(dY >= 32768 ? nY+1 : nY, rows-1);
+    buf[pX + pY * cols] = col;
+    return;
+  }
+  // neighbours closer than 0.01 are not blended (same limits as 1D version), positions are within canvas as x,y <= 1.0
+  const unsigned xL = dX >= 64881 ? nX+1 : nX, xR = MIN(dX >= 655 ? nX+1 : nX, cols-1);
+  const unsigned yT = dY >= 64881 ? nY+1 : nY, yB = MIN(dY >= 655 ? nY+1 : nY, rows-1);
+  const uint32_t dL = dX, dR = 65536 - dX, dT = dY, dB = 65536 - dY;
+  // blend amounts: distance products (are smaller the closer the pixel is) and squared distances scaled to 0-255
+  auto w2 = [](uint32_t a, uint32_t b) -> uint8_t { return (((a * b) >> 16) * 255) >> 16; };
+  uint32_t *rowT = buf + yT * cols, *rowB = buf + yB * cols;
+
+  if (xL!=xR && yT!=yB) {
+    rowT[xL] = color_blend(col, rowT[xL], w2(dL, dT)); // blend TL pixel
+    rowT[xR] = color_blend(col, rowT[xR], w2(dR, dT)); // blend TR pixel
+    rowB[xL] = color_blend(col, rowB[xL], w2(dL, dB)); // blend BL pixel
+    rowB[xR] = color_blend(col, rowB[xR], w2(dR, dB)); // blend BR pixel
+  } else if (xR!=xL) {
+    rowT[xL] = color_blend(col, rowT[xL], w2(dL, dL)); // blend L pixel
+    rowT[xR] = color_blend(col, rowT[xR], w2(dR, dR)); // blend R pixel
+  } else if (yT!=yB) {
+    rowT[xL] = color_blend(col, rowT[xL], w2(dT, dT)); // blend T pixel
+    rowB[xL] = color_blend(col, rowB[xL], w2(dB, dB)); // blend B pixel
   } else {
-    setPixelColorXY(uint16_t(roundf(fX)), uint16_t(roundf(fY)), col);
+    rowT[xL] = col; // exact match (x & y land on a pixel)
   }
 }
 
-// returns RGBW values of pixel
-uint32_t Segment::getPixelColorXY(uint16_t x, uint16_t y) {
-  if (!isActive()) return 0; // not active
-  if (x >= virtualWidth() || y >= virtualHeight() || x<0 || y<0) return 0;  // if pixel would fall out of virtual segment just exit
-  if (reverse  ) x = virtualWidth()  - x - 1;
-  if (reverse_y) y = virtualHeight() - y - 1;
-  if (transpose) { uint16_t t = x; x = y; y = t; } // swap X & Y if segment transposed
-  x *= groupLength(); // expand to physical pixels
-  y *= groupLength(); // expand to physical pixels
-  if (x >= width() || y >= height()) return 0;
-  return strip.getPixelColorXY(start + x, startY + y);
+// returns RGBW values of pixel (as set by effect, without brightness/opacity applied)
+uint32_t WLED_HOT(Segment_getPixelColorXY) Segment::getPixelColorXY(uint16_t x, uint16_t y) {
+  if (!isActive() || !_pixels) return 0; // not active or no pixel buffer
+  const unsigned vW = virtualWidth();
+  if (x >= vW || y >= virtualHeight()) return 0;  // if pixel would fall out of virtual segment just exit
+  const unsigned i = x + y * vW;
+  return i < _pixelsLen ? _pixels[i] : 0;
 }
 
 // Blends the specified color with the existing pixel color.
@@ -294,95 +367,97 @@ void Segment::fadePixelColorXY(uint16_t x, uint16_t y, uint8_t fade) {
   setPixelColorXY(x, y, color_fade(getPixelColorXY(x,y), fade, true));
 }
 
+// blur operators work on pixel buffer directly (row-major, virtualWidth() x virtualHeight()),
+// a row is a line with stride 1 and a column is a line with stride virtualWidth()
+
+// FastLED blur1d() on a line of pixels (like CRGB operations it drops white)
+static void blurLine(uint32_t *p, unsigned n, unsigned stride, fract8 blur_amount) {
+  const uint8_t keep = 255 - blur_amount;
+  const uint8_t seep = blur_amount >> 1;
+  uint32_t carryover = BLACK;
+  for (unsigned i = 0; i < n; i++, p += stride) {
+    const uint32_t before = *p & 0x00FFFFFF; // remember color before blur
+    const uint32_t part = color_fade(before, seep);
+    const uint32_t cur  = color_add(color_fade(before, keep), carryover, true);
+    if (i > 0) *(p - stride) = color_add(*(p - stride) & 0x00FFFFFF, part, true);
+    if (before != cur) *p = cur; // optimization: only set pixel if color has changed
+    carryover = part;
+  }
+}
+
+// weighted 3 pixel box blur on a line of pixels (white is dropped), uses scratch line of n pixels
+static void boxBlurLine(uint32_t *p, unsigned n, unsigned stride, fract8 blur_amount, uint32_t *line) {
+  const unsigned seep = blur_amount;
+  const unsigned keep = 3*255 - 2*seep; // all weights are scaled by 255
+  for (unsigned j = 0; j < n; j++) line[j] = p[j*stride];
+  for (unsigned j = 0; j < n; j++) {
+    const uint32_t curr = line[j];
+    const uint32_t prev = j > 0   ? line[j-1] : BLACK;
+    const uint32_t next = j < n-1 ? line[j+1] : BLACK;
+    const unsigned r = (R(curr)*keep + (R(prev) + R(next))*seep) / (3*255);
+    const unsigned g = (G(curr)*keep + (G(prev) + G(next))*seep) / (3*255);
+    const unsigned b = (B(curr)*keep + (B(prev) + B(next))*seep) / (3*255);
+    p[j*stride] = RGBW32(r, g, b, 0);
+  }
+}
+
+// box blur of given radius on a line of pixels (integer sliding window), result is blended with original by blur_amount
+static void radiusBlurLine(uint32_t *p, unsigned n, unsigned stride, unsigned radius, fract8 blur_amount, uint32_t *line) {
+  const unsigned window = 2*radius + 1;
+  const uint32_t recip = (65536U + window - 1) / window; // sum * recip >> 16 == sum / window (sum is max 255 * window)
+  for (unsigned j = 0; j < n; j++) line[j] = p[j*stride];
+  unsigned r = 0, g = 0, b = 0, w = 0; // window sums, pixels outside line are black
+  for (unsigned j = 0; j < radius && j < n; j++) { r += R(line[j]); g += G(line[j]); b += B(line[j]); w += W(line[j]); }
+  for (unsigned j = 0; j < n; j++) {
+    if (j + radius < n) { const uint32_t c = line[j+radius]; r += R(c); g += G(c); b += B(c); w += W(c); }
+    const uint32_t avg = RGBW32((r*recip)>>16, (g*recip)>>16, (b*recip)>>16, (w*recip)>>16);
+    p[j*stride] = color_blend(line[j], avg, blur_amount);
+    if (j >= radius) { const uint32_t c = line[j-radius]; r -= R(c); g -= G(c); b -= B(c); w -= W(c); }
+  }
+}
+
 // blurRow: perform a blur on a row of a rectangular matrix
 void Segment::blurRow(uint16_t row, fract8 blur_amount) {
   if (!isActive() || blur_amount == 0) return; // not active
-  const uint_fast16_t cols = virtualWidth();
-  const uint_fast16_t rows = virtualHeight();
-
-  if (row >= rows) return;
-  // blur one row
-  uint8_t keep = 255 - blur_amount;
-  uint8_t seep = blur_amount >> 1;
-  CRGB carryover = CRGB::Black;
-  for (unsigned x = 0; x < cols; x++) {
-    CRGB cur = getPixelColorXY(x, row);
-    CRGB before = cur;     // remember color before blur
-    CRGB part = cur;
-    part.nscale8(seep);
-    cur.nscale8(keep);
-    cur += carryover;
-    if (x>0) {
-      CRGB prev = CRGB(getPixelColorXY(x-1, row)) + part;
-      setPixelColorXY(x-1, row, prev);
-    }
-    if (before != cur)         // optimization: only set pixel if color has changed
-      setPixelColorXY(x, row, cur);
-    carryover = part;
-  }
+  const unsigned cols = virtualWidth();
+  const unsigned rows = virtualHeight();
+  if (row >= rows || cols * rows > pixelCount()) return;
+  blurLine(_pixels + row * cols, cols, 1, blur_amount);
 }
 
 // blurCol: perform a blur on a column of a rectangular matrix
 void Segment::blurCol(uint16_t col, fract8 blur_amount) {
   if (!isActive() || blur_amount == 0) return; // not active
-  const uint_fast16_t cols = virtualWidth();
-  const uint_fast16_t rows = virtualHeight();
-
-  if (col >= cols) return;
-  // blur one column
-  uint8_t keep = 255 - blur_amount;
-  uint8_t seep = blur_amount >> 1;
-  CRGB carryover = CRGB::Black;
-  for (unsigned y = 0; y < rows; y++) {
-    CRGB cur = getPixelColorXY(col, y);
-    CRGB part = cur;
-    CRGB before = cur;     // remember color before blur
-    part.nscale8(seep);
-    cur.nscale8(keep);
-    cur += carryover;
-    if (y>0) {
-      CRGB prev = CRGB(getPixelColorXY(col, y-1)) + part;
-      setPixelColorXY(col, y-1, prev);
-    }
-    if (before != cur)         // optimization: only set pixel if color has changed
-      setPixelColorXY(col, y, cur);
-    carryover = part;
-  }
+  const unsigned cols = virtualWidth();
+  const unsigned rows = virtualHeight();
+  if (col >= cols || cols * rows > pixelCount()) return;
+  blurLine(_pixels + col, rows, cols, blur_amount);
 }
 
 // 1D Box blur (with added weight - blur_amount: [0=no blur, 255=max blur])
 void Segment::box_blur(uint16_t i, bool vertical, fract8 blur_amount) {
   if (!isActive() || blur_amount == 0) return; // not active
-  const uint16_t cols = virtualWidth();
-  const uint16_t rows = virtualHeight();
-  const uint16_t dim1 = vertical ? rows : cols;
-  const uint16_t dim2 = vertical ? cols : rows;
-  if (i >= dim2) return;
-  const float seep = blur_amount/255.f;
-  const float keep = 3.f - 2.f*seep;
-  // 1D box blur
-  CRGB tmp[dim1];
-  for (int j = 0; j < dim1; j++) {
-    uint16_t x = vertical ? i : j;
-    uint16_t y = vertical ? j : i;
-    int16_t xp = vertical ? x : x-1;  // "signed" to prevent underflow
-    int16_t yp = vertical ? y-1 : y;  // "signed" to prevent underflow
-    uint16_t xn = vertical ? x : x+1;
-    uint16_t yn = vertical ? y+1 : y;
-    CRGB curr = getPixelColorXY(x,y);
-    CRGB prev = (xp<0 || yp<0) ? CRGB::Black : getPixelColorXY(xp,yp);
-    CRGB next = ((vertical && yn>=dim1) || (!vertical && xn>=dim1)) ? CRGB::Black : getPixelColorXY(xn,yn);
-    uint16_t r, g, b;
-    r = (curr.r*keep + (prev.r + next.r)*seep) / 3;
-    g = (curr.g*keep + (prev.g + next.g)*seep) / 3;
-    b = (curr.b*keep + (prev.b + next.b)*seep) / 3;
-    tmp[j] = CRGB(r,g,b);
-  }
-  for (int j = 0; j < dim1; j++) {
-    uint16_t x = vertical ? i : j;
-    uint16_t y = vertical ? j : i;
-    setPixelColorXY(x, y, tmp[j]);
-  }
+  const unsigned cols = virtualWidth();
+  const unsigned rows = virtualHeight();
+  const unsigned dim1 = vertical ? rows : cols;
+  const unsigned dim2 = vertical ? cols : rows;
+  if (i >= dim2 || cols * rows > pixelCount()) return;
+  uint32_t line[dim1];
+  if (vertical) boxBlurLine(_pixels + i, rows, cols, blur_amount, line);
+  else          boxBlurLine(_pixels + i * cols, cols, 1, blur_amount, line);
+}
+
+// separable 2D box blur with radius (1-16): horizontal pass over all rows followed by vertical pass over all columns
+// blur_amount blends blurred image with the original [0=no blur, 255=only blurred]
+void Segment::blur2D(fract8 blur_amount, uint8_t radius) {
+  if (!isActive() || blur_amount == 0 || radius == 0) return; // not active
+  const unsigned cols = virtualWidth();
+  const unsigned rows = virtualHeight();
+  if (cols * rows > pixelCount()) return;
+  if (radius > 16) radius = 16; // keeps window sums (and scratch line) small
+  uint32_t line[MAX(cols, rows)];
+  for (unsigned y = 0; y < rows; y++) radiusBlurLine(_pixels + y * cols, cols, 1, radius, blur_amount, line);
+  for (unsigned x = 0; x < cols; x++) radiusBlurLine(_pixels + x, rows, cols, radius, blur_amount, line);
 }
 
 // blur1d: one-dimensional blur filter. Spreads light to 2 line neighbors.
@@ -458,20 +533,31 @@ void Segment::move(uint8_t dir, uint8_t delta, bool wrap) {
   }
 }
 
+// 2D primitives below write to pixel buffer directly, they are clipped once (or per span) instead of bounds checking each pixel
+
 void Segment::draw_circle(uint16_t cx, uint16_t cy, uint8_t radius, CRGB col) {
-  if (!isActive() || radius == 0) return; // not active
+  uint32_t *buf = canvas();
+  if (!buf || radius == 0) return; // not active
+  const int cols = virtualWidth();
+  const int rows = virtualHeight();
+  const uint32_t c = RGBW32(col.r, col.g, col.b, 0);
+  // circle entirely on canvas needs no clipping at all
+  const bool inside = cx >= radius && cy >= radius && cx + radius < cols && cy + radius < rows;
+  auto plot = [&](int x, int y) {
+    if (inside || (unsigned(x) < unsigned(cols) && unsigned(y) < unsigned(rows))) buf[x + y * cols] = c;
+  };
   // Bresenham’s Algorithm
   int d = 3 - (2*radius);
   int y = radius, x = 0;
   while (y >= x) {
-    setPixelColorXY(cx+x, cy+y, col);
-    setPixelColorXY(cx-x, cy+y, col);
-    setPixelColorXY(cx+x, cy-y, col);
-    setPixelColorXY(cx-x, cy-y, col);
-    setPixelColorXY(cx+y, cy+x, col);
-    setPixelColorXY(cx-y, cy+x, col);
-    setPixelColorXY(cx+y, cy-x, col);
-    setPixelColorXY(cx-y, cy-x, col);
+    plot(cx+x, cy+y);
+    plot(cx-x, cy+y);
+    plot(cx+x, cy-y);
+    plot(cx-x, cy-y);
+    plot(cx+y, cy+x);
+    plot(cx-y, cy+x);
+    plot(cx+y, cy-x);
+    plot(cx-y, cy-x);
     x++;
     if (d > 0) {
       y--;
@@ -482,45 +568,51 @@ void Segment::draw_circle(uint16_t cx, uint16_t cy, uint8_t radius, CRGB col) {
   }
 }
 
-// by stepko, taken from https://editor.soulmatelights.com/gallery/573-blobs
+// filled as horizontal spans (same pixels as testing x*x + y*y <= radius*radius for each one)
 void Segment::fill_circle(uint16_t cx, uint16_t cy, uint8_t radius, CRGB col) {
-  if (!isActive() || radius == 0) return; // not active
-  const uint16_t cols = virtualWidth();
-  const uint16_t rows = virtualHeight();
-  for (int16_t y = -radius; y <= radius; y++) {
-    for (int16_t x = -radius; x <= radius; x++) {
-      if (x * x + y * y <= radius * radius &&
-          int16_t(cx)+x>=0 && int16_t(cy)+y>=0 &&
-          int16_t(cx)+x<cols && int16_t(cy)+y<rows)
-        setPixelColorXY(cx + x, cy + y, col);
-    }
+  uint32_t *buf = canvas();
+  if (!buf || radius == 0) return; // not active
+  const int cols = virtualWidth();
+  const int rows = virtualHeight();
+  const uint32_t c = RGBW32(col.r, col.g, col.b, 0);
+  const int r2 = radius * radius;
+  int w = 0; // half width of span, grows towards center row
+  for (int y = -radius; y <= radius; y++) {
+    const int py = int16_t(cy) + y;
+    if (y <= 0) while (w < radius && (w+1) * (w+1) + y * y <= r2) w++;
+    else        while (w * w + y * y > r2) w--;
+    if (py < 0 || py >= rows) continue;
+    const int x0 = MAX(int16_t(cx) - w, 0);
+    const int x1 = MIN(int16_t(cx) + w, cols - 1);
+    uint32_t *row = buf + py * cols;
+    for (int x = x0; x <= x1; x++) row[x] = c;
   }
 }
 
 void Segment::nscale8(uint8_t scale) {
   if (!isActive()) return; // not active
-  const uint16_t cols = virtualWidth();
-  const uint16_t rows = virtualHeight();
-  for (int y = 0; y < rows; y++) for (int x = 0; x < cols; x++) {
-    setPixelColorXY(x, y, CRGB(getPixelColorXY(x, y)).nscale8(scale));
-  }
+  const unsigned len = pixelCount();
+  for (unsigned i = 0; i < len; i++) _pixels[i] = color_fade(_pixels[i] & 0x00FFFFFF, scale); // same as CRGB::nscale8() (drops white)
 }
 
-//line function
+//line function, end points must be on canvas so the whole line is
 void Segment::drawLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint32_t c) {
-  if (!isActive()) return; // not active
+  uint32_t *buf = canvas();
+  if (!buf) return; // not active
   const uint16_t cols = virtualWidth();
   const uint16_t rows = virtualHeight();
   if (x0 >= cols || x1 >= cols || y0 >= rows || y1 >= rows) return;
-  const int16_t dx = abs(x1-x0), sx = x0<x1 ? 1 : -1;
-  const int16_t dy = abs(y1-y0), sy = y0<y1 ? 1 : -1;
-  int16_t err = (dx>dy ? dx : -dy)/2, e2;
+  const int dx = abs(x1-x0), sx = x0<x1 ? 1 : -1;
+  const int dy = abs(y1-y0), sy = y0<y1 ? cols : -cols; // step through buffer
+  uint32_t *p = buf + x0 + y0 * cols;
+  uint32_t *end = buf + x1 + y1 * cols;
+  int err = (dx>dy ? dx : -dy)/2, e2;
   for (;;) {
-    setPixelColorXY(x0,y0,c);
-    if (x0==x1 && y0==y1) break;
+    *p = c;
+    if (p == end) break;
     e2 = err;
-    if (e2 >-dx) { err -= dy; x0 += sx; }
-    if (e2 < dy) { err += dx; y0 += sy; }
+    if (e2 >-dx) { err -= dy; p += sx; }
+    if (e2 < dy) { err += dx; p += sy; }
   }
 }
 
@@ -530,15 +622,38 @@ void Segment::drawLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint3
 #include "src/font/console_font_6x8.h"
 #include "src/font/console_font_7x9.h"
 
-// draws a raster font character on canvas
+// returns bits of a font row (MSB aligned, bit 8-w is leftmost pixel), chr is aligned with font table entries
 // only supports: 4x6=24, 5x8=40, 5x12=60, 6x8=48 and 7x9=63 fonts ATM
+static bool fontRow(unsigned char chr, uint8_t w, uint8_t h, int i, uint8_t &bits) {
+  switch (w*h) {
+    case 24: bits = pgm_read_byte_near(&console_font_4x6[(chr * h) + i]); break;  // 5x8 font
+    case 40: bits = pgm_read_byte_near(&console_font_5x8[(chr * h) + i]); break;  // 5x8 font
+    case 48: bits = pgm_read_byte_near(&console_font_6x8[(chr * h) + i]); break;  // 6x8 font
+    case 63: bits = pgm_read_byte_near(&console_font_7x9[(chr * h) + i]); break;  // 7x9 font
+    case 60: bits = pgm_read_byte_near(&console_font_5x12[(chr * h) + i]); break; // 5x12 font
+    default: return false;
+  }
+  return true;
+}
+
+// position of font pixel (j,i) within character cell for given rotation
+static inline void fontPixelPos(int8_t rotate, uint8_t w, uint8_t h, int i, int j, int &x0, int &y0) {
+  switch (rotate) {
+    case -1: x0 = (h-1) - i; y0 = (w-1) - j; break; // -90 deg
+    case -2:
+    case  2: x0 = j;         y0 = (h-1) - i; break; // 180 deg
+    case  1: x0 = i;         y0 = j;         break; // +90 deg
+    default: x0 = (w-1) - j; y0 = i;         break; // no rotation
+  }
+}
+
+// draws a raster font character on canvas
 void Segment::drawCharacter(unsigned char chr, int16_t x, int16_t y, uint8_t w, uint8_t h, uint32_t color, uint32_t col2, int8_t rotate) {
   if (!isActive()) return; // not active
   if (chr < 32 || chr > 126) return; // only ASCII 32-126 supported
   chr -= 32; // align with font table entries
   const uint16_t cols = virtualWidth();
   const uint16_t rows = virtualHeight();
-  const int font = w*h;
 
   CRGB col = CRGB(color);
   CRGBPalette16 grad = CRGBPalette16(col, col2 ? CRGB(col2) : col);
@@ -546,24 +661,12 @@ void Segment::drawCharacter(unsigned char chr, int16_t x, int16_t y, uint8_t w,
   //if (w<5 || w>6 || h!=8) return;
   for (int i = 0; i<h; i++) { // character height
     uint8_t bits = 0;
-    switch (font) {
-      case 24: bits = pgm_read_byte_near(&console_font_4x6[(chr * h) + i]); break;  // 5x8 font
-      case 40: bits = pgm_read_byte_near(&console_font_5x8[(chr * h) + i]); break;  // 5x8 font
-      case 48: bits = pgm_read_byte_near(&console_font_6x8[(chr * h) + i]); break;  // 6x8 font
-      case 63: bits = pgm_read_byte_near(&console_font_7x9[(chr * h) + i]); break;  // 7x9 font
-      case 60: bits = pgm_read_byte_near(&console_font_5x12[(chr * h) + i]); break; // 5x12 font
-      default: return;
-    }
+    if (!fontRow(chr, w, h, i, bits)) return;
     col = ColorFromPalette(grad, (i+1)*255/h, 255, NOBLEND);
     for (int j = 0; j<w; j++) { // character width
       int x0, y0;
-      switch (rotate) {
-        case -1: x0 = x + (h-1) - i; y0 = y + (w-1) - j; break; // -90 deg
-        case -2:
-        case  2: x0 = x + j;         y0 = y + (h-1) - i; break; // 180 deg
-        case  1: x0 = x + i;         y0 = y + j;         break; // +90 deg
-        default: x0 = x + (w-1) - j; y0 = y + i;         break; // no rotation
-      }
+      fontPixelPos(rotate, w, h, i, j, x0, y0);
+      x0 += x; y0 += y;
       if (x0 < 0 || x0 >= cols || y0 < 0 || y0 >= rows) continue; // drawing off-screen
       if (((bits>>(j+(8-w))) & 0x01)) { // bit set
         setPixelColorXY(x0, y0, col);
@@ -572,21 +675,48 @@ void Segment::drawCharacter(unsigned char chr, int16_t x, int16_t y, uint8_t w,
   }
 }
 
+// renders text into a 1 bit per pixel strip bitmap (one uint16_t per column, bit n is row n) so that
+// scrolling effects can blit it instead of drawing characters each frame; returns number of columns used
+// characters are (rotated) w x h cells placed side by side, unsupported characters leave an empty cell
+uint16_t Segment::rasterizeText(const char *text, uint8_t w, uint8_t h, int8_t rotate, uint16_t *columns, size_t maxColumns) {
+  const int cellW = (rotate == 1 || rotate == -1) ? h : w;
+  size_t len = strlen(text);
+  if (len * cellW > maxColumns) len = maxColumns / cellW;
+  memset(columns, 0, len * cellW * sizeof(uint16_t));
+  for (size_t n = 0; n < len; n++) {
+    unsigned char chr = text[n];
+    if (chr < 32 || chr > 126) continue; // only ASCII 32-126 supported
+    chr -= 32;
+    for (int i = 0; i<h; i++) {
+      uint8_t bits = 0;
+      if (!fontRow(chr, w, h, i, bits)) return 0;
+      for (int j = 0; j<w; j++) if ((bits>>(j+(8-w))) & 0x01) {
+        int x0, y0;
+        fontPixelPos(rotate, w, h, i, j, x0, y0);
+        columns[n*cellW + x0] |= 1U << y0;
+      }
+    }
+  }
+  return len * cellW;
+}
+
 #define WU_WEIGHT(a,b) ((uint8_t) (((a)*(b)+(a)+(b))>>8))
 void Segment::wu_pixel(uint32_t x, uint32_t y, CRGB c) {      //awesome wu_pixel procedure by reddit u/sutaburosu
-  if (!isActive()) return; // not active
+  uint32_t *buf = canvas();
+  if (!buf) return; // not active
+  const unsigned cols = virtualWidth();
+  const unsigned rows = virtualHeight();
   // extract the fractional parts and derive their inverses
   uint8_t xx = x & 0xff, yy = y & 0xff, ix = 255 - xx, iy = 255 - yy;
   // calculate the intensities for each affected pixel
   uint8_t wu[4] = {WU_WEIGHT(ix, iy), WU_WEIGHT(xx, iy),
                    WU_WEIGHT(ix, yy), WU_WEIGHT(xx, yy)};
-  // multiply the intensities by the colour, and saturating-add them to the pixels
+  // multiply the intensities by the colour, and saturating-add them to the pixels (white is dropped like with CRGB)
   for (int i = 0; i < 4; i++) {
-    CRGB led = getPixelColorXY((x >> 8) + (i & 1), (y >> 8) + ((i >> 1) & 1));
-    led.r = qadd8(led.r, c.r * wu[i] >> 8);
-    led.g = qadd8(led.g, c.g * wu[i] >> 8);
-    led.b = qadd8(led.b, c.b * wu[i] >> 8);
-    setPixelColorXY(int((x >> 8) + (i & 1)), int((y >> 8) + ((i >> 1) & 1)), led);
+    const unsigned px = (x >> 8) + (i & 1), py = (y >> 8) + ((i >> 1) & 1);
+    if (px >= cols || py >= rows) continue;
+    uint32_t &led = buf[px + py * cols];
+    led = RGBW32(qadd8(R(led), c.r * wu[i] >> 8), qadd8(G(led), c.g * wu[i] >> 8), qadd8(B(led), c.b * wu[i] >> 8), 0);
   }
 }
 #undef WU_WEIGHT
@@ -26,11 +26,15 @@
 #include "wled.h"
 #include "FX.h"
 #include "palettes.h"
+#ifdef WLED_PSRAM_SEGMENT_DATA
+#include "soc/soc_memory_layout.h" // esp_ptr_external_ram()
+#endif
 
 /*
   Custom per-LED mapping has moved!
 
   Create a file "ledmap.json" using the edit page.
+  Large maps load much faster as "ledmap.bin" (convert with tools/ledmap2bin.py), which is used instead if present.
 
   this is just an example (30 LEDs). It will first set all even, then all uneven LEDs.
   {"map":[
@@ -74,13 +78,22 @@
 // Segment class implementation
 ///////////////////////////////////////////////////////////////////////////////
 uint16_t Segment::_usedSegmentData = 0U; // amount of RAM all segments use for their data[]
+uint32_t Segment::_usedSegmentDataPSRAM = 0U;
+uint8_t *Segment::_arena = nullptr;
+uint16_t Segment::_arenaTop = 0U;
+Segment::tmpsegd_t *Segment::_arenaTmpSeg = nullptr;
+Segment::Transition Segment::_tPool[MAX_NUM_SEGMENTS];
+bool Segment::_tPoolUsed[MAX_NUM_SEGMENTS] = {false};
 uint16_t Segment::maxWidth = DEFAULT_LED_COUNT;
 uint16_t Segment::maxHeight = 1;
+uint16_t Segment::matrixArea = DEFAULT_LED_COUNT;
 
-CRGBPalette16 Segment::_currentPalette    = CRGBPalette16(CRGB::Black);
-CRGBPalette16 Segment::_randomPalette = CRGBPalette16(DEFAULT_COLOR);
-CRGBPalette16 Segment::_newRandomPalette = CRGBPalette16(DEFAULT_COLOR);
-unsigned long Segment::_lastPaletteChange = 0; // perhaps it should be per segment
+uint8_t       Segment::_customPaletteGen = 0;
+uint32_t      Segment::_paletteCache[WLED_RENDER_CTX][WLED_PALETTE_CACHE_SLOTS][256]; // all black, which matches the (black) source palettes
+CRGBPalette16 Segment::_paletteCacheSrc[WLED_RENDER_CTX][WLED_PALETTE_CACHE_SLOTS];
+uint8_t       Segment::_paletteCacheBlend[WLED_RENDER_CTX][WLED_PALETTE_CACHE_SLOTS];
+uint8_t       Segment::_paletteCacheSlot[WLED_RENDER_CTX];
+uint8_t       Segment::_paletteCacheNext[WLED_RENDER_CTX];
 
 #ifndef WLED_DISABLE_MODE_BLEND
 bool Segment::_modeBlend = false;
@@ -94,8 +107,20 @@ Segment::Segment(const Segment &orig) {
   name = nullptr;
   data = nullptr;
   _dataLen = 0;
+  _pixels = nullptr;
+  _pixelsLen = 0;
+  _pixelsSpare = nullptr;
+  _pixelsKey = nullptr;
+  _keyLen = 0;
+  _indexMap = nullptr; // lookup table will be rebuilt on next frame
+  _indexMapLen = 0;
+  _writer = &Segment::writePixelAuto;
   if (orig.name) { name = new char[strlen(orig.name)+1]; if (name) strcpy(name, orig.name); }
-  if (orig.data) { if (allocateData(orig._dataLen)) memcpy(data, orig.data, orig._dataLen); }
+  if (orig.data) copyData(orig.data, orig._dataLen);
+  if (orig._pixels) {
+    _pixels = (uint32_t*) heapMallocLarge(HEAP_TAG_PIXELS, orig._pixelsLen * sizeof(uint32_t));
+    if (_pixels) { memcpy(_pixels, orig._pixels, orig._pixelsLen * sizeof(uint32_t)); _pixelsLen = orig._pixelsLen; }
+  }
 }
 
 // move constructor
@@ -106,6 +131,14 @@ Segment::Segment(Segment &&orig) noexcept {
   orig.name = nullptr;
   orig.data = nullptr;
   orig._dataLen = 0;
+  orig._pixels = nullptr;
+  orig._pixelsLen = 0;
+  orig._pixelsSpare = nullptr;
+  orig._pixelsKey = nullptr;
+  orig._keyLen = 0;
+  orig._indexMap = nullptr;
+  orig._indexMapLen = 0;
+  orig._writer = &Segment::writePixelAuto;
 }
 
 // copy assignment
@@ -116,14 +149,27 @@ Segment& Segment::operator= (const Segment &orig) {
     if (name) { delete[] name; name = nullptr; }
     stopTransition();
     deallocateData();
+    deallocatePixels();
     // copy source
     memcpy((void*)this, (void*)&orig, sizeof(Segment));
     // erase pointers to allocated data
     data = nullptr;
     _dataLen = 0;
+    _pixels = nullptr;
+    _pixelsLen = 0;
+    _pixelsSpare = nullptr;
+    _pixelsKey = nullptr;
+    _keyLen = 0;
+    _indexMap = nullptr; // lookup table will be rebuilt on next frame
+    _indexMapLen = 0;
+    _writer = &Segment::writePixelAuto;
     // copy source data
     if (orig.name) { name = new char[strlen(orig.name)+1]; if (name) strcpy(name, orig.name); }
-    if (orig.data) { if (allocateData(orig._dataLen)) memcpy(data, orig.data, orig._dataLen); }
+    if (orig.data) copyData(orig.data, orig._dataLen);
+    if (orig._pixels) {
+      _pixels = (uint32_t*) heapMallocLarge(HEAP_TAG_PIXELS, orig._pixelsLen * sizeof(uint32_t));
+      if (_pixels) { memcpy(_pixels, orig._pixels, orig._pixelsLen * sizeof(uint32_t)); _pixelsLen = orig._pixelsLen; }
+    }
   }
   return *this;
 }
@@ -135,44 +181,219 @@ Segment& Segment::operator= (Segment &&orig) noexcept {
     if (name) { delete[] name; name = nullptr; } // free old name
     stopTransition();
     deallocateData(); // free old runtime data
+    deallocatePixels(); // free old pixel buffer
     memcpy((void*)this, (void*)&orig, sizeof(Segment));
     orig.name = nullptr;
     orig.data = nullptr;
     orig._dataLen = 0;
     orig._t   = nullptr; // old segment cannot be in transition
+    orig._pixels = nullptr;
+    orig._pixelsLen = 0;
+    orig._pixelsSpare = nullptr;
+    orig._pixelsKey = nullptr;
+    orig._keyLen = 0;
+    orig._indexMap = nullptr;
+    orig._indexMapLen = 0;
+    orig._writer = &Segment::writePixelAuto;
   }
   return *this;
 }
 
-bool Segment::allocateData(size_t len) {
+// effect data arena: all segment data (and transition copies of it) live in a single block of MAX_SEGMENT_DATA bytes
+// blocks are allocated from the top and freed blocks are reclaimed by compaction, which moves live blocks down and
+// updates their owners (segment data pointers), so effects must not keep data pointers across frames
+#ifdef ARDUINO_ARCH_ESP32
+static portMUX_TYPE arenaMux = portMUX_INITIALIZER_UNLOCKED; // arena top (loop and render task) and data counters (also network callbacks)
+#define ARENA_LOCK()   portENTER_CRITICAL(&arenaMux)
+#define ARENA_UNLOCK() portEXIT_CRITICAL(&arenaMux)
+static SemaphoreHandle_t arenaMoveLock = nullptr; // held while blocks are moved (compaction) or read by another task (copies)
+#define ARENA_MOVE_LOCK()   do { if (arenaMoveLock) xSemaphoreTake(arenaMoveLock, portMAX_DELAY); } while (0)
+#define ARENA_MOVE_UNLOCK() do { if (arenaMoveLock) xSemaphoreGive(arenaMoveLock); } while (0)
+#else
+#define ARENA_LOCK()
+#define ARENA_UNLOCK()
+#define ARENA_MOVE_LOCK()
+#define ARENA_MOVE_UNLOCK()
+#endif
+#define ARENA_ALIGN(n) (((n) + 3) & ~3) // keep blocks 32 bit aligned
+
+// allocates arena block initialised from src (or cleared), compaction is only allowed from main loop (no effect function may hold another data pointer)
+// arena blocks are only owned by segments and their transitions (copies of segments use heap), so only effects allocate from it
+uint8_t *Segment::arenaAlloc(size_t len, const uint8_t *src, bool compact) {
+  if (!_arena) {
+    _arena = (uint8_t*) heapMalloc(HEAP_TAG_SEGDATA, MAX_SEGMENT_DATA); // hot data, SPI RAM is slow for random access (cold data has its own tier)
+    if (!_arena) { DEBUG_PRINTLN(F("!!! Arena allocation failed. !!!")); return nullptr; }
+    #ifdef ARDUINO_ARCH_ESP32
+    if (!arenaMoveLock) arenaMoveLock = xSemaphoreCreateMutex();
+    #endif
+  }
+  size_t size = ARENA_ALIGN(len);
+  if (compact && _arenaTop + size > MAX_SEGMENT_DATA) compactArena(); // not in critical section, moves up to MAX_SEGMENT_DATA bytes
+  uint8_t *block = nullptr;
+  ARENA_LOCK();
+  if (_arenaTop + size <= MAX_SEGMENT_DATA) {
+    block = _arena + _arenaTop;
+    _arenaTop += size;
+  }
+  ARENA_UNLOCK();
+  if (block) {
+    if (src) memcpy(block, src, len);
+    else     memset(block, 0, len);
+  }
+  return block;
+}
+
+// blocks outside arena were allocated from heap when arena was full
+void Segment::arenaFree(uint8_t *block, size_t len, uint8_t tag) {
+  if (block && !inArena(block)) heapFree(tag, block, len);
+  // arena blocks are reclaimed by next compaction
+}
+
+// called from loop() inside an effect function while no other effect is rendering (see allocateData()), so no other
+// owner can allocate or hand over arena blocks meanwhile; copies reading segment data from other tasks are held off
+void Segment::compactArena() {
+  ARENA_MOVE_LOCK();
+  // collect all references to arena blocks: segment data, transition copies and temporary mode blending data
+  struct { uint8_t **ptr; uint16_t len; } refs[2*MAX_NUM_SEGMENTS+1];
+  unsigned n = 0;
+  auto addRef = [&](uint8_t **ptr, uint16_t len) {
+    if (!inArena(*ptr) || n >= sizeof(refs)/sizeof(refs[0])) return;
+    unsigned j = n++;
+    for (; j > 0 && *refs[j-1].ptr > *ptr; j--) refs[j] = refs[j-1]; // keep sorted by address
+    refs[j].ptr = ptr;
+    refs[j].len = len;
+  };
+  for (segment &seg : strip._segments) {
+    addRef(&seg.data, seg._dataLen);
+    #ifndef WLED_DISABLE_MODE_BLEND
+    if (seg._t) addRef(&seg._t->_segT._dataT, seg._t->_segT._dataLenT);
+    #endif
+  }
+  if (_arenaTmpSeg) addRef(&_arenaTmpSeg->_dataT, _arenaTmpSeg->_dataLenT);
+
+  // move blocks down in address order (references to the same block are updated together)
+  uint16_t top = 0;
+  uint8_t *lastOld = nullptr, *lastNew = nullptr;
+  for (unsigned i = 0; i < n; i++) {
+    uint8_t *old = *refs[i].ptr;
+    if (old == lastOld) { *refs[i].ptr = lastNew; continue; }
+    uint8_t *dst = _arena + top;
+    if (dst != old) memmove(dst, old, refs[i].len);
+    *refs[i].ptr = dst;
+    lastOld = old;
+    lastNew = dst;
+    top += ARENA_ALIGN(refs[i].len);
+  }
+  ARENA_LOCK();
+  const uint16_t oldTop = _arenaTop;
+  _arenaTop = top;
+  ARENA_UNLOCK();
+  ARENA_MOVE_UNLOCK();
+  DEBUG_PRINTF("Arena compacted: %u -> %u\n", oldTop, top);
+}
+
+#ifdef WLED_PSRAM_SEGMENT_DATA
+#ifndef WLED_PSRAM_SEGMENT_DATA_DIV
+  #define WLED_PSRAM_SEGMENT_DATA_DIV 4 // share of PSRAM cold effect data may use
+#endif
+
+bool Segment::inPSRAM(const uint8_t *p) { return p && esp_ptr_external_ram(p); }
+
+uint32_t Segment::getMaxSegmentDataPSRAM(void) {
+  static uint32_t maxData = UINT32_MAX;
+  if (maxData == UINT32_MAX) maxData = psramFound() ? ESP.getPsramSize() / WLED_PSRAM_SEGMENT_DATA_DIV : 0;
+  return maxData;
+}
+#else
+bool Segment::inPSRAM(const uint8_t *p) { return false; }
+uint32_t Segment::getMaxSegmentDataPSRAM(void) { return 0; }
+#endif
+
+bool Segment::allocateData(size_t len, uint8_t hint) {
   if (data && _dataLen >= len) {          // already allocated enough (reduce fragmentation)
     if (call == 0) memset(data, 0, len);  // erase buffer if called during effect initialisation
     return true;
   }
   //DEBUG_PRINTF("--   Allocating data (%d): %p\n", len, this);
   deallocateData();
-  if (len == 0) return false; // nothing to do
+  if (len == 0 || len > UINT16_MAX) return false; // nothing to do
+#ifdef WLED_PSRAM_SEGMENT_DATA
+  // large cold buffers go to PSRAM first (tier has its own budget), falling back to arena
+  if (hint == SEG_DATA_COLD && len >= WLED_PSRAM_MIN_ALLOC && _usedSegmentDataPSRAM + len <= getMaxSegmentDataPSRAM()) {
+    data = (byte*) heapCallocLarge(HEAP_TAG_SEGDATA, 1, len);
+    if (inPSRAM(data)) {
+      ARENA_LOCK();
+      _usedSegmentDataPSRAM += len;
+      ARENA_UNLOCK();
+      _dataLen = len;
+      return true;
+    }
+    heapFree(HEAP_TAG_SEGDATA, data, len); // PSRAM full, internal heap is reserved for hot data
+    data = nullptr;
+  }
+#endif
   if (Segment::getUsedSegmentData() + len > MAX_SEGMENT_DATA) {
     // not enough memory
     DEBUG_PRINT(F("!!! Effect RAM depleted: "));
     DEBUG_PRINTF("%d/%d !!!\n", len, Segment::getUsedSegmentData());
     return false;
   }
-  // do not use SPI RAM on ESP32 since it is slow
-  data = (byte*) malloc(len);
+  data = arenaAlloc(len, nullptr, strip.isServicing() && !strip.isRenderingParallel()); // only compact when called from effect function (and no other one is running)
   if (!data) { DEBUG_PRINTLN(F("!!! Allocation failed. !!!")); return false; } //allocation failed
   Segment::addUsedSegmentData(len);
   //DEBUG_PRINTF("---  Allocated data (%p): %d/%d -> %p\n", this, len, Segment::getUsedSegmentData(), data);
   _dataLen = len;
-  memset(data, 0, len);
   return true;
 }
 
+void Segment::addUsedSegmentData(int len) {
+  ARENA_LOCK();
+  _usedSegmentData += len;
+  ARENA_UNLOCK();
+}
+
+// duplicates data of another segment (copy constructor/assignment, may be called from network callback)
+void Segment::copyData(const uint8_t *src, uint16_t len) {
+#ifdef WLED_PSRAM_SEGMENT_DATA
+  if (inPSRAM(src) && _usedSegmentDataPSRAM + len <= getMaxSegmentDataPSRAM()) { // copy stays in tier of source
+    data = (byte*) heapMallocLarge(HEAP_TAG_SEGDATA, len);
+    if (inPSRAM(data)) {
+      memcpy(data, src, len);
+      ARENA_LOCK();
+      _usedSegmentDataPSRAM += len;
+      ARENA_UNLOCK();
+      _dataLen = len;
+      return;
+    }
+    heapFree(HEAP_TAG_SEGDATA, data, len);
+    data = nullptr;
+  }
+#endif
+  if (Segment::getUsedSegmentData() + len > MAX_SEGMENT_DATA) return;
+  // copies never get arena blocks: compaction only knows blocks of segments in strip, a copy's block would be overwritten
+  data = (byte*) heapMalloc(HEAP_TAG_SEGDATA, len); // until segment data is re-allocated (by the effect, into arena)
+  if (!data) return;
+  ARENA_MOVE_LOCK(); // source block must not be moved while it is read
+  memcpy(data, src, len);
+  ARENA_MOVE_UNLOCK();
+  Segment::addUsedSegmentData(len);
+  _dataLen = len;
+}
+
 void Segment::deallocateData() {
   if (!data) { _dataLen = 0; return; }
+  if (inPSRAM(data)) {
+    heapFree(HEAP_TAG_SEGDATA, data, _dataLen);
+    ARENA_LOCK();
+    _usedSegmentDataPSRAM -= MIN(_usedSegmentDataPSRAM, (uint32_t)_dataLen);
+    ARENA_UNLOCK();
+    data = nullptr;
+    _dataLen = 0;
+    return;
+  }
   //DEBUG_PRINTF("---  Released data (%p): %d/%d -> %p\n", this, _dataLen, Segment::getUsedSegmentData(), data);
   if ((Segment::getUsedSegmentData() > 0) && (_dataLen > 0)) { // check that we don't have a dangling / inconsistent data pointer
-    free(data);
+    arenaFree(data, _dataLen);
   } else {
     DEBUG_PRINT(F("---- Released data "));
     DEBUG_PRINTF("(%p): ", this);
@@ -185,6 +406,171 @@ void Segment::deallocateData() {
   _dataLen = 0;
 }
 
+// number of logical pixels effects can address; 2D segments (and 1D segments within matrix) use virtual width*height
+uint16_t Segment::bufferLength() const {
+  if (!isActive()) return 0;
+#ifndef WLED_DISABLE_2D
+  if (is2D() || isMatrixStrip()) return virtualWidth() * virtualHeight();
+#endif
+  return virtualLength();
+}
+
+// (re)allocates pixel buffer if segment geometry changed, buffer content is cleared on reallocation
+// must only be called from main loop context as effect functions may be using the buffer
+bool Segment::allocatePixels() {
+  uint16_t len = bufferLength();
+  if (!_pixels || _pixelsLen != len) {
+    heapFree(HEAP_TAG_TRANS, _pixelsSpare, _pixelsLen * sizeof(uint32_t));
+    _pixelsSpare = nullptr;
+    heapFree(HEAP_TAG_PIXELS, _pixelsKey, _pixelsLen * sizeof(uint32_t));
+    _pixelsKey = nullptr;
+    _keyLen = 0;
+    heapFree(HEAP_TAG_PIXELS, _pixels, _pixelsLen * sizeof(uint32_t));
+    _pixels = nullptr;
+    _pixelsLen = 0;
+    _writer = &Segment::writePixelAuto;
+    if (len == 0) { deallocateIndexMap(); return false; } // nothing to do
+    _pixels = (uint32_t*) heapCallocLarge(HEAP_TAG_PIXELS, len, sizeof(uint32_t));
+    if (!_pixels) { DEBUG_PRINTLN(F("!!! Pixel buffer allocation failed. !!!")); deallocateIndexMap(); return false; }
+    _pixelsLen = len;
+  }
+  // keyframe interpolation keeps previous effect output (allocated here as effects may run in render task)
+  if (interpolate && !_pixelsKey) {
+    _pixelsKey = (uint32_t*) heapMallocLarge(HEAP_TAG_PIXELS, len * sizeof(uint32_t));
+    if (_pixelsKey) memcpy(_pixelsKey, _pixels, len * sizeof(uint32_t));
+  } else if (!interpolate && _pixelsKey) {
+    heapFree(HEAP_TAG_PIXELS, _pixelsKey, _pixelsLen * sizeof(uint32_t));
+    _pixelsKey = nullptr;
+    _keyLen = 0;
+  }
+#ifndef WLED_DISABLE_MODE_BLEND
+  // while blending modes, previous mode renders into its own buffer (starting with what was last shown)
+  if (modeBlending && isInTransition() && _t->_modeT != mode && _t->_segT._pixelsLenT != len) {
+    heapFree(HEAP_TAG_TRANS, _t->_segT._pixelsT, _t->_segT._pixelsLenT * sizeof(uint32_t));
+    _t->_segT._pixelsLenT = 0;
+    if (_pixelsSpare) { _t->_segT._pixelsT = _pixelsSpare; _pixelsSpare = nullptr; } // reuse buffer of last transition
+    else _t->_segT._pixelsT = (uint32_t*) heapMallocLarge(HEAP_TAG_TRANS, len * sizeof(uint32_t));
+    if (_t->_segT._pixelsT) {
+      memcpy(_t->_segT._pixelsT, _pixels, len * sizeof(uint32_t));
+      _t->_segT._pixelsLenT = len;
+    }
+  }
+#endif
+#ifndef WLED_DISABLE_2D
+  if (is2D() && map1D2D == M12_pArc) { updateArcMap(); return true; } // setPixelColor() falls back to trigonometry if table is missing
+  if (is2D() || isMatrixStrip()) { deallocateIndexMap(); return true; } // 2D segments are expanded directly
+#endif
+  return updateIndexMap();
+}
+
+void Segment::deallocatePixels() {
+  heapFree(HEAP_TAG_TRANS, _pixelsSpare, _pixelsLen * sizeof(uint32_t));
+  _pixelsSpare = nullptr;
+  heapFree(HEAP_TAG_PIXELS, _pixelsKey, _pixelsLen * sizeof(uint32_t));
+  _pixelsKey = nullptr;
+  _keyLen = 0;
+  heapFree(HEAP_TAG_PIXELS, _pixels, _pixelsLen * sizeof(uint32_t));
+  _pixels = nullptr;
+  _pixelsLen = 0;
+  _writer = &Segment::writePixelAuto;
+  deallocateIndexMap();
+}
+
+// builds physical to logical pixel lookup table taking into account grouping, spacing, reverse, mirror and offset
+// table is relative to segment start so it only needs rebuilding if layout of segment changes
+bool Segment::updateIndexMap() {
+  const uint64_t key = indexMapKey();
+  if (_indexMap && _indexMapKey == key) return true;
+  const int len = length();
+  if (!_indexMap || _indexMapLen != len) {
+    deallocateIndexMap();
+    if (len == 0) return false;
+    _indexMap = (uint16_t*) heapMallocLarge(HEAP_TAG_PIXELS, len * sizeof(uint16_t));
+    if (!_indexMap) { DEBUG_PRINTLN(F("!!! Index map allocation failed. !!!")); return false; }
+    _indexMapLen = len;
+  }
+  memset(_indexMap, 0xFF, len * sizeof(uint16_t)); // pixels not covered by any logical pixel (spacing) remain UINT16_MAX
+
+  // later logical pixels overwrite earlier ones if they overlap (mirrored groups)
+  const int vLen = virtualLength();
+  for (int v = 0; v < vLen; v++) {
+    int i = v * groupLength();
+    if (reverse) { // is segment reversed?
+      if (mirror) i = (len - 1) / 2 - i; //only need to index half the pixels
+      else        i = (len - 1) - i;
+    }
+    // map all the pixels in the group
+    for (int j = 0; j < grouping; j++) {
+      int indexSet = i + (reverse ? -j : j);
+      if (indexSet < 0 || indexSet >= len) continue;
+      if (mirror) { // map the corresponding mirrored pixel
+        int indexMir = len - indexSet - 1 + offset; // offset/phase
+        if (indexMir >= len) indexMir -= len; // wrap
+        if (indexMir < len) _indexMap[indexMir] = v;
+      }
+      indexSet += offset; // offset/phase
+      if (indexSet >= len) indexSet -= len; // wrap
+      if (indexSet < len) _indexMap[indexSet] = v;
+    }
+  }
+  _indexMapKey = key;
+  return true;
+}
+
+void Segment::deallocateIndexMap() {
+  heapFree(HEAP_TAG_PIXELS, _indexMap, _indexMapLen * sizeof(uint16_t));
+  _indexMap = nullptr;
+  _indexMapLen = 0;
+}
+
+#ifndef WLED_DISABLE_2D
+// calls emit(x,y) for each point of quarter circle with radius i (1D pixel i in arc mode), points are ordered along the arc
+template<typename F> static void arcPoints(int i, F emit) {
+  if (i == 0) { emit(0, 0); return; }
+  float step = HALF_PI / (2.85f*i);
+  for (float rad = 0.0f; rad <= HALF_PI+step/2; rad += step) {
+    // may want to try float version as well (with or without antialiasing)
+    emit(int(roundf(sin_t(rad) * i)), int(roundf(cos_t(rad) * i)));
+  }
+}
+
+// precomputes buffer indices lit by each 1D pixel in arc mode so setPixelColor() needs no trigonometry
+// layout: _indexMap[i] is offset of first index of arc i, _indexMap[vLen] is total length (duplicate and out of bounds points omitted)
+bool Segment::updateArcMap() {
+  const int vW = virtualWidth();
+  const int vH = virtualHeight();
+  const uint64_t key = arcMapKey(vW, vH);
+  if (_indexMap && _indexMapKey == key) return true;
+  deallocateIndexMap();
+  const int vLen = virtualLength();
+  if (vLen == 0) return false;
+  unsigned len = vLen + 1;
+  for (int i = 0; i < vLen; i++) arcPoints(i, [&](int x, int y) { if (x >= 0 && y >= 0 && x < vW && y < vH) len++; }); // upper bound
+  if (len > UINT16_MAX) return false; // too large, use trigonometry
+  _indexMap = (uint16_t*) heapMallocLarge(HEAP_TAG_PIXELS, len * sizeof(uint16_t));
+  if (!_indexMap) { DEBUG_PRINTLN(F("!!! Arc map allocation failed. !!!")); return false; }
+  unsigned n = vLen + 1;
+  for (int i = 0; i < vLen; i++) {
+    const unsigned first = n;
+    _indexMap[i] = first;
+    arcPoints(i, [&](int x, int y) {
+      if (x < 0 || y < 0 || x >= vW || y >= vH) return;
+      const uint16_t idx = x + y * vW;
+      if (n > first && _indexMap[n-1] == idx) return; // neighbouring angles often round to the same pixel
+      _indexMap[n++] = idx;
+    });
+  }
+  _indexMap[vLen] = n;
+  if (n < len) { // release unused tail
+    uint16_t *shrunk = (uint16_t*) realloc(_indexMap, n * sizeof(uint16_t));
+    if (shrunk) { _indexMap = shrunk; heapTrackFree(HEAP_TAG_PIXELS, (len - n) * sizeof(uint16_t)); }
+  }
+  _indexMapLen = n;
+  _indexMapKey = key;
+  return true;
+}
+#endif
+
 /**
   * If reset of this segment was requested, clears runtime
   * settings of this segment.
@@ -195,14 +581,40 @@ void Segment::deallocateData() {
 void Segment::resetIfRequired() {
   if (!reset) return;
   //DEBUG_PRINTF("-- Segment reset: %p\n", this);
+#ifndef WLED_DISABLE_MODE_BLEND
+  if (modeBlending && isInTransition() && _t->_modeT != mode && !_t->_segT._dataT && data) {
+    // previous mode keeps running from its own data during mode transition, hand it over instead of copying
+    _t->_segT._dataT    = data;
+    _t->_segT._dataLenT = _dataLen;
+    _t->_segT._aux0T    = aux0;
+    _t->_segT._aux1T    = aux1;
+    _t->_segT._stepT    = step;
+    _t->_segT._callT    = call;
+    if (inPSRAM(data)) { ARENA_LOCK(); _usedSegmentDataPSRAM -= MIN(_usedSegmentDataPSRAM, (uint32_t)_dataLen); ARENA_UNLOCK(); }
+    else Segment::addUsedSegmentData(_dataLen <= Segment::getUsedSegmentData() ? -_dataLen : -Segment::getUsedSegmentData()); // as deallocateData()
+    data = nullptr;
+    _dataLen = 0;
+  } else
+#endif
   deallocateData();
   next_time = 0; step = 0; call = 0; aux0 = 0; aux1 = 0;
+  // random numbers of the effect start over as well, the stream only depends on seed, segment id and effect
+  // so segments (and nodes) with the same seed and settings restarted together show the same "randomness"
+  uint32_t h = (strip._rngSeed ? strip._rngSeed : strip._rngBoot) ^ (uint32_t(uint8_t(this - strip._segments.data())) << 24) ^ (uint32_t(mode) << 8);
+  h *= 0x9E3779B1U;
+  rng = (h >> 16) ^ h;
+  if (!rng) rng = 1;
   reset = false;
 }
 
+// palette between a and b (amount 255: b) in a single pass, so a fade only depends on its progress
+static void blendPalettes(CRGBPalette16 &out, const CRGBPalette16 &a, const CRGBPalette16 &b, uint8_t amount) {
+  for (unsigned i = 0; i < 16; i++) out[i] = blend(a[i], b[i], amount);
+}
+
 CRGBPalette16 &Segment::loadPalette(CRGBPalette16 &targetPalette, uint8_t pal) {
-  if (pal < 245 && pal > GRADIENT_PALETTE_COUNT+13) pal = 0;
-  if (pal > 245 && (strip.customPalettes.size() == 0 || 255U-pal > strip.customPalettes.size()-1)) pal = 0; // TODO remove strip dependency by moving customPalettes out of strip
+  if (pal < WLED_CUSTOM_PALETTES_START && pal > GRADIENT_PALETTE_COUNT+13) pal = 0;
+  if (pal > WLED_CUSTOM_PALETTES_START && (strip.customPalettes.size() == 0 || 255U-pal > strip.customPalettes.size()-1)) pal = 0; // TODO remove strip dependency by moving customPalettes out of strip
   //default palette. Differs depending on effect
   if (pal == 0) switch (mode) {
     case FX_MODE_FIRE_2012  : pal = 35; break; // heat palette
@@ -223,16 +635,17 @@ CRGBPalette16 &Segment::loadPalette(CRGBPalette16 &targetPalette, uint8_t pal) {
     case 1: {//periodically replace palette with a random one
       unsigned long timeSinceLastChange = millis() - _lastPaletteChange;
       if (timeSinceLastChange > randomPaletteChangeTime * 1000U) {
-        _randomPalette = _newRandomPalette;
+        _randomPalette = _newRandomPalette; // fade is shorter than change time so it is complete
         _newRandomPalette = CRGBPalette16(
                         CHSV(random8(), random8(160, 255), random8(128, 255)),
                         CHSV(random8(), random8(160, 255), random8(128, 255)),
                         CHSV(random8(), random8(160, 255), random8(128, 255)),
                         CHSV(random8(), random8(160, 255), random8(128, 255)));
         _lastPaletteChange = millis();
-        handleRandomPalette(); // do a 1st pass of blend
+        timeSinceLastChange = 0;
       }
-      targetPalette = _randomPalette;
+      unsigned fade = MIN(RANDOM_PALETTE_FADE, randomPaletteChangeTime * 1000U);
+      blendPalettes(targetPalette, _randomPalette, _newRandomPalette, timeSinceLastChange >= fade ? 255 : timeSinceLastChange * 255 / fade);
       break;}
     case 2: {//primary color only
       CRGB prim = gamma32(colors[0]);
@@ -271,7 +684,7 @@ CRGBPalette16 &Segment::loadPalette(CRGBPalette16 &targetPalette, uint8_t pal) {
     case 12: //Rainbow stripe colors
       targetPalette = RainbowStripeColors_p; break;
     default: //progmem palettes
-      if (pal>245) {
+      if (pal>WLED_CUSTOM_PALETTES_START) {
         targetPalette = strip.customPalettes[255-pal]; // we checked bounds above
       } else {
         byte tcp[72];
@@ -283,6 +696,31 @@ CRGBPalette16 &Segment::loadPalette(CRGBPalette16 &targetPalette, uint8_t pal) {
   return targetPalette;
 }
 
+// transitions are taken from a fixed pool to avoid heap churn on every color/brightness/effect change
+#ifdef ARDUINO_ARCH_ESP32
+static portMUX_TYPE transitionMux = portMUX_INITIALIZER_UNLOCKED; // transitions may be started from network callbacks
+#endif
+
+Segment::Transition *Segment::getTransition(uint16_t dur) {
+  Transition *t = nullptr;
+  #ifdef ARDUINO_ARCH_ESP32
+  portENTER_CRITICAL(&transitionMux);
+  #endif
+  for (size_t i = 0; i < MAX_NUM_SEGMENTS; i++) {
+    if (!_tPoolUsed[i]) { _tPoolUsed[i] = true; t = &_tPool[i]; break; }
+  }
+  #ifdef ARDUINO_ARCH_ESP32
+  portEXIT_CRITICAL(&transitionMux);
+  #endif
+  if (t) *t = Transition(dur);
+  return t;
+}
+
+void Segment::releaseTransition(Transition *t) {
+  size_t i = t - _tPool;
+  if (i < MAX_NUM_SEGMENTS) _tPoolUsed[i] = false; // single byte store, no lock needed
+}
+
 void Segment::startTransition(uint16_t dur) {
   if (dur == 0) {
     if (isInTransition()) _t->_dur = dur; // this will stop transition in next handleTransition()
@@ -291,8 +729,8 @@ void Segment::startTransition(uint16_t dur) {
   if (isInTransition()) return; // already in transition no need to store anything
 
   // starting a transition has to occur before change so we get current values 1st
-  _t = new Transition(dur); // no previous transition running
-  if (!_t) return; // failed to allocate data
+  _t = getTransition(dur); // no previous transition running
+  if (!_t) { DEBUG_PRINTLN(F("!!! Transition pool exhausted. !!!")); return; } // change will be instant
 
   //DEBUG_PRINTF("-- Started transition: %p\n", this);
   loadPalette(_t->_palT, palette);
@@ -304,20 +742,16 @@ void Segment::startTransition(uint16_t dur) {
     _t->_modeT          = mode;
     _t->_segT._dataLenT = 0;
     _t->_segT._dataT    = nullptr;
-    if (_dataLen > 0 && data) {
-      _t->_segT._dataT = (byte *)malloc(_dataLen);
-      if (_t->_segT._dataT) {
-        //DEBUG_PRINTF("--  Allocated duplicate data (%d): %p\n", _dataLen, _t->_segT._dataT);
-        memcpy(_t->_segT._dataT, data, _dataLen);
-        _t->_segT._dataLenT = _dataLen;
-      }
-    }
+    _t->_segT._pixelsT  = nullptr; // allocated in allocatePixels() (main loop) if mode actually changes
+    _t->_segT._pixelsLenT = 0;
+    // data is handed over in resetIfRequired() (main loop) if mode actually changes
   } else {
     for (size_t i=0; i<NUM_COLORS; i++) _t->_segT._colorT[i] = colors[i];
   }
 #else
   for (size_t i=0; i<NUM_COLORS; i++) _t->_colorT[i] = colors[i];
 #endif
+  updateTransition(_t->_start); // values before the change until next frame
 }
 
 void Segment::stopTransition() {
@@ -326,28 +760,42 @@ void Segment::stopTransition() {
     #ifndef WLED_DISABLE_MODE_BLEND
     if (_t->_segT._dataT && _t->_segT._dataLenT > 0) {
       //DEBUG_PRINTF("--  Released duplicate data (%d): %p\n", _t->_segT._dataLenT, _t->_segT._dataT);
-      free(_t->_segT._dataT);
+      arenaFree(_t->_segT._dataT, _t->_segT._dataLenT, HEAP_TAG_SEGDATA); // handed over by resetIfRequired()
       _t->_segT._dataT = nullptr;
       _t->_segT._dataLenT = 0;
     }
+    if (_t->_segT._pixelsT && _t->_segT._pixelsLenT == _pixelsLen && !_pixelsSpare && getHeapStats().warn == HEAP_WARN_OK)
+      _pixelsSpare = _t->_segT._pixelsT; // keep for next mode transition (released with pixel buffer)
+    else
+      heapFree(HEAP_TAG_TRANS, _t->_segT._pixelsT, _t->_segT._pixelsLenT * sizeof(uint32_t));
+    _t->_segT._pixelsT = nullptr;
+    _t->_segT._pixelsLenT = 0;
     #endif
-    delete _t;
+    releaseTransition(_t);
     _t = nullptr;
   }
 }
 
-void Segment::handleTransition() {
-  uint16_t _progress = progress();
-  if (_progress == 0xFFFFU) stopTransition();
+void Segment::handleTransition(unsigned long t) {
+  updateTransition(t);
+  if (progress() == 0xFFFFU) stopTransition();
 }
 
-// transition progression between 0-65535
-uint16_t Segment::progress() {
-  if (isInTransition()) {
-    unsigned diff = millis() - _t->_start;
-    if (_t->_dur > 0 && diff < _t->_dur) return diff * 0xFFFFU / _t->_dur;
-  }
-  return 0xFFFFU;
+// called at the start of each frame (and when a transition starts): progress, brightness and colors are
+// computed once instead of on every progress()/currentBri()/currentColor() call
+void Segment::updateTransition(unsigned long t) {
+  if (!isInTransition()) return;
+  unsigned diff = t - _t->_start;
+  uint32_t prog = (_t->_dur > 0 && diff < _t->_dur) ? diff * 0xFFFFU / _t->_dur : 0xFFFFU;
+  _t->_prog   = prog;
+  _t->_briCur = ((on ? opacity : 0) * prog + _t->_briT * (0xFFFFU - prog)) / 0xFFFFU;
+  _t->_cctCur = (cct * prog + _t->_cctT * (0xFFFFU - prog)) / 0xFFFFU;
+  for (size_t i = 0; i < NUM_COLORS; i++)
+#ifndef WLED_DISABLE_MODE_BLEND
+    _t->_colorCur[i] = color_blend(_t->_segT._colorT[i], colors[i], prog, true);
+#else
+    _t->_colorCur[i] = color_blend(_t->_colorT[i], colors[i], prog, true);
+#endif
 }
 
 #ifndef WLED_DISABLE_MODE_BLEND
@@ -369,7 +817,10 @@ void Segment::swapSegenv(tmpsegd_t &tmpSeg) {
   tmpSeg._callT      = call;
   tmpSeg._dataT      = data;
   tmpSeg._dataLenT   = _dataLen;
+  tmpSeg._pixelsT    = _pixels;
+  tmpSeg._pixelsLenT = _pixelsLen;
   if (_t && &tmpSeg != &(_t->_segT)) {
+    _arenaTmpSeg = &tmpSeg; // data of current mode is held in tmpSeg while previous mode runs
     // swap SEGENV with transitional data
     options   = _t->_segT._optionsT;
     for (size_t i=0; i<NUM_COLORS; i++) colors[i] = _t->_segT._colorT[i];
@@ -387,6 +838,9 @@ void Segment::swapSegenv(tmpsegd_t &tmpSeg) {
     call      = _t->_segT._callT;
     data      = _t->_segT._dataT;
     _dataLen  = _t->_segT._dataLenT;
+    _pixels   = _t->_segT._pixelsT;
+    _pixelsLen = _t->_segT._pixelsLenT;
+    selectPixelWriter(); // old mode may use different mapping and buffer
   }
   //DEBUG_PRINTF("--   temp seg data: %p (%d,%p)\n", this, _dataLen, data);
 }
@@ -402,6 +856,8 @@ void Segment::restoreSegenv(tmpsegd_t &tmpSeg) {
     //if (_t->_segT._dataT != data) DEBUG_PRINTF("---  data re-allocated: (%p) %p -> %p\n", this, _t->_segT._dataT, data);
     _t->_segT._dataT = data;
     _t->_segT._dataLenT = _dataLen;
+    _t->_segT._pixelsT = _pixels;
+    _t->_segT._pixelsLenT = _pixelsLen;
   }
   options   = tmpSeg._optionsT;
   for (size_t i=0; i<NUM_COLORS; i++) colors[i] = tmpSeg._colorT[i];
@@ -419,17 +875,16 @@ void Segment::restoreSegenv(tmpsegd_t &tmpSeg) {
   call      = tmpSeg._callT;
   data      = tmpSeg._dataT;
   _dataLen  = tmpSeg._dataLenT;
+  _pixels   = tmpSeg._pixelsT;
+  _pixelsLen = tmpSeg._pixelsLenT;
+  selectPixelWriter();
+  if (_arenaTmpSeg == &tmpSeg) _arenaTmpSeg = nullptr;
   //DEBUG_PRINTF("--   temp seg data: %p (%d,%p)\n", this, _dataLen, data);
 }
 #endif
 
 uint8_t Segment::currentBri(bool useCct) {
-  uint32_t prog = progress();
-  if (prog < 0xFFFFU) {
-    uint32_t curBri = (useCct ? cct : (on ? opacity : 0)) * prog;
-    curBri += (useCct ? _t->_cctT : _t->_briT) * (0xFFFFU - prog);
-    return curBri / 0xFFFFU;
-  }
+  if (progress() < 0xFFFFU) return useCct ? _t->_cctCur : _t->_briCur;
   return (useCct ? cct : (on ? opacity : 0));
 }
 
@@ -441,40 +896,61 @@ uint8_t Segment::currentMode() {
   return mode;
 }
 
-uint32_t Segment::currentColor(uint8_t slot) {
-#ifndef WLED_DISABLE_MODE_BLEND
-  return isInTransition() ? color_blend(_t->_segT._colorT[slot], colors[slot], progress(), true) : colors[slot];
-#else
-  return isInTransition() ? color_blend(_t->_colorT[slot], colors[slot], progress(), true) : colors[slot];
-#endif
+uint32_t WLED_HOT(Segment_currentColor) Segment::currentColor(uint8_t slot) {
+  return isInTransition() ? _t->_colorCur[slot] : colors[slot];
 }
 
+// loading a palette decodes gradient from flash so only do it if any of its inputs changed
 void Segment::setCurrentPalette() {
-  loadPalette(_currentPalette, palette);
   unsigned prog = progress();
-  if (strip.paletteFade && prog < 0xFFFFU) {
-    // blend palettes
-    // there are about 255 blend passes of 48 "blends" to completely blend two palettes (in _dur time)
-    // minimum blend time is 100ms maximum is 65535ms
-    unsigned noOfBlends = ((255U * prog) / 0xFFFFU) - _t->_prevPaletteBlends;
-    for (unsigned i = 0; i < noOfBlends; i++, _t->_prevPaletteBlends++) nblendPaletteTowardPalette(_t->_palT, _currentPalette, 48);
-    _currentPalette = _t->_palT; // copy transitioning/temporary palette
+  bool fading = strip.paletteFade && prog < 0xFFFFU;
+  // random palette is blending towards new one and transition needs target palette, reload both every frame
+  uint32_t key = (palette == 1 || fading) ? 0 : paletteKey();
+  if (key == 0 || key != _paletteKey) loadPalette(_currentPalette, palette);
+  _paletteKey = key;
+  if (fading) blendPalettes(_currentPalette, _t->_palT, _currentPalette, prog >> 8); // from palette at start of transition to target
+  updatePaletteCache((strip.paletteBlend == 3) ? NOBLEND : LINEARBLEND);
+}
+
+// expand _currentPalette into 256 colors, only if no cache slot holds it already
+// (comparing 48 bytes per slot is much cheaper than interpolating palette for every pixel)
+// segments rendered in turn with different palettes each keep their slot, as long as there are enough slots
+void Segment::updatePaletteCache(TBlendType blend) {
+  const unsigned ctx = RENDER_CTX();
+  for (unsigned s = 0; s < WLED_PALETTE_CACHE_SLOTS; s++) {
+    if (_paletteCacheBlend[ctx][s] == blend && _paletteCacheSrc[ctx][s] == _currentPalette) {
+      _paletteCacheSlot[ctx] = s;
+      return;
+    }
+  }
+  const unsigned s = _paletteCacheNext[ctx];
+  _paletteCacheNext[ctx] = (s + 1) % WLED_PALETTE_CACHE_SLOTS;
+  for (unsigned i = 0; i < 256; i++) {
+    CRGB c = ColorFromPalette(_currentPalette, i, 255, blend);
+    _paletteCache[ctx][s][i] = RGBW32(c.r, c.g, c.b, 0);
   }
+  _paletteCacheSrc[ctx][s]   = _currentPalette;
+  _paletteCacheBlend[ctx][s] = blend;
+  _paletteCacheSlot[ctx]     = s;
 }
 
-// relies on WS2812FX::service() to call it max every 8ms or more (MIN_SHOW_DELAY)
-void Segment::handleRandomPalette() {
-  // just do a blend; if the palettes are identical it will just compare 48 bytes (same as _randomPalette == _newRandomPalette)
-  // this will slowly blend _newRandomPalette into _randomPalette every 15ms or 8ms (depending on MIN_SHOW_DELAY)
-  nblendPaletteTowardPalette(_randomPalette, _newRandomPalette, 48);
+// hash of everything loadPalette() depends on (never 0)
+uint32_t Segment::paletteKey() const {
+  uint8_t pal = palette;
+  if (pal < WLED_CUSTOM_PALETTES_START && pal > GRADIENT_PALETTE_COUNT+13) pal = 0;
+  const uint8_t d[3] = { pal, _customPaletteGen, mode };
+  uint32_t key = fnv1a(d, pal == 0 ? 3 : 2);                         // default palette depends on effect
+  if (pal >= 2 && pal <= 5) key = fnv1a(colors, sizeof(colors), key); // color palettes
+  return key | 1;
 }
 
 // segId is given when called from network callback, changes are queued if that segment is currently in its effect function
-void Segment::setUp(uint16_t i1, uint16_t i2, uint8_t grp, uint8_t spc, uint16_t ofs, uint16_t i1Y, uint16_t i2Y, uint8_t segId) {
+void Segment::setUp(uint16_t i1, uint16_t i2, uint8_t grp, uint8_t spc, uint16_t ofs, uint16_t i1Y, uint16_t i2Y, uint8_t cv, uint8_t segId) {
   // return if neither bounds nor grouping have changed
   bool boundsUnchanged = (start == i1 && stop == i2);
   #ifndef WLED_DISABLE_2D
   if (Segment::maxHeight>1) boundsUnchanged &= (startY == i1Y && stopY == i2Y); // 2D
+  if (cv < strip.getCanvasCount()) boundsUnchanged &= (cv == canvasIdx);
   #endif
   if (boundsUnchanged
       && (!grp || (grouping == grp && spacing == spc))
@@ -482,7 +958,7 @@ void Segment::setUp(uint16_t i1, uint16_t i2, uint8_t grp, uint8_t spc, uint16_t
 
   stateChanged = true; // send UDP/WS broadcast
 
-  if (stop) fill(BLACK); // turn old segment range off (clears pixels if changing spacing)
+  if (stop) clear(); // turn old segment range off (clears pixels if changing spacing)
   if (grp) { // prevent assignment of 0
     grouping = grp;
     spacing = spc;
@@ -497,28 +973,36 @@ void Segment::setUp(uint16_t i1, uint16_t i2, uint8_t grp, uint8_t spc, uint16_t
   DEBUG_PRINT(F(" -> ")); DEBUG_PRINT(i1Y);
   DEBUG_PRINT(','); DEBUG_PRINTLN(i2Y);
   markForReset();
+  updateGeometry();
   if (boundsUnchanged) return;
 
   // apply change immediately
   if (i2 <= i1) { //disable segment
     stop = 0;
+    updateGeometry();
     return;
   }
-  if (i1 < Segment::maxWidth || (i1 >= Segment::maxWidth*Segment::maxHeight && i1 < strip.getLengthTotal())) start = i1; // Segment::maxWidth equals strip.getLengthTotal() for 1D
-  stop = i2 > Segment::maxWidth*Segment::maxHeight ? MIN(i2,strip.getLengthTotal()) : (i2 > Segment::maxWidth ? Segment::maxWidth : MAX(1,i2));
+  #ifndef WLED_DISABLE_2D
+  if (cv < strip.getCanvasCount()) canvasIdx = cv;
+  const WS2812FX::Canvas c = strip.getCanvas(canvasIdx); // bounds are relative to segment's canvas
+  const uint16_t cW = c.width, cH = c.height;
+  #else
+  const uint16_t cW = Segment::maxWidth, cH = Segment::maxHeight;
+  #endif
+  if (i1 < cW || (i1 >= Segment::matrixArea && i1 < strip.getLengthTotal())) start = i1; // Segment::maxWidth equals strip.getLengthTotal() for 1D
+  stop = i2 > Segment::matrixArea ? MIN(i2,strip.getLengthTotal()) : (i2 > cW ? cW : MAX(1,i2));
   startY = 0;
   stopY  = 1;
   #ifndef WLED_DISABLE_2D
-  if (Segment::maxHeight>1) { // 2D
-    if (i1Y < Segment::maxHeight) startY = i1Y;
-    stopY = i2Y > Segment::maxHeight ? Segment::maxHeight : MAX(1,i2Y);
+  if (cH>1 && start < Segment::matrixArea) { // 2D
+    if (i1Y < cH) startY = i1Y;
+    stopY = i2Y > cH ? cH : MAX(1,i2Y);
   }
   #endif
   // safety check
-  if (start >= stop || startY >= stopY) {
-    stop = 0;
-    return;
-  }
+  if (start >= stop || startY >= stopY) stop = 0;
+  updateGeometry();
+  if (!stop) return;
   refreshLightCapabilities();
 }
 
@@ -559,6 +1043,7 @@ void Segment::setOption(uint8_t n, bool val) {
   if (fadeTransition && n == SEG_OPTION_ON && val != prevOn) startTransition(strip.getTransition()); // start transition prior to change
   if (val) options |=   0x01 << n;
   else     options &= ~(0x01 << n);
+  updateGeometry(); // mirror, transpose, ...
   if (!(n == SEG_OPTION_SELECTED || n == SEG_OPTION_RESET)) stateChanged = true; // send UDP/WS broadcast
 }
 
@@ -596,8 +1081,8 @@ void Segment::setMode(uint8_t fx, bool loadDefaults) {
 }
 
 void Segment::setPalette(uint8_t pal) {
-  if (pal < 245 && pal > GRADIENT_PALETTE_COUNT+13) pal = 0; // built in palettes
-  if (pal > 245 && (strip.customPalettes.size() == 0 || 255U-pal > strip.customPalettes.size()-1)) pal = 0; // custom palettes
+  if (pal < WLED_CUSTOM_PALETTES_START && pal > GRADIENT_PALETTE_COUNT+13) pal = 0; // built in palettes
+  if (pal > WLED_CUSTOM_PALETTES_START && (strip.customPalettes.size() == 0 || 255U-pal > strip.customPalettes.size()-1)) pal = 0; // custom palettes
   if (pal != palette) {
     if (strip.paletteFade) startTransition(strip.getTransition());
     palette = pal;
@@ -606,174 +1091,236 @@ void Segment::setPalette(uint8_t pal) {
 }
 
 // 2D matrix
-uint16_t Segment::virtualWidth() const {
-  uint16_t groupLen = groupLength();
-  uint16_t vWidth = ((transpose ? height() : width()) + groupLen - 1) / groupLen;
-  if (mirror) vWidth = (vWidth + 1) /2;  // divide by 2 if mirror, leave at least a single LED
-  return vWidth;
-}
-
-uint16_t Segment::virtualHeight() const {
-  uint16_t groupLen = groupLength();
+// virtualWidth(), virtualHeight(), virtualLength() and nrOfVStrips() are used by every 2D pixel access and bounds
+// check, so they are resolved here (once per frame from service() and whenever geometry or options change) and
+// only read elsewhere
+void Segment::updateGeometry() {
+  const uint16_t groupLen = groupLength(); // is always >= 1
+  uint16_t vWidth  = ((transpose ? height() : width()) + groupLen - 1) / groupLen;
   uint16_t vHeight = ((transpose ? width() : height()) + groupLen - 1) / groupLen;
-  if (mirror_y) vHeight = (vHeight + 1) /2;  // divide by 2 if mirror, leave at least a single LED
-  return vHeight;
-}
-
-uint16_t Segment::nrOfVStrips() const {
-  uint16_t vLen = 1;
+  if (mirror)   vWidth  = (vWidth + 1) /2;  // divide by 2 if mirror, leave at least a single LED
+  if (mirror_y) vHeight = (vHeight + 1) /2;
+  _rWidth  = vWidth;
+  _rHeight = vHeight;
 #ifndef WLED_DISABLE_2D
-  if (is2D()) {
-    switch (map1D2D) {
-      case M12_pBar:
-        vLen = virtualWidth();
-        break;
-    }
+  if (is2D() && renderScale) { // effect sees a smaller canvas
+    vWidth  = (vWidth  + (1U << renderScale) - 1) >> renderScale;
+    vHeight = (vHeight + (1U << renderScale) - 1) >> renderScale;
   }
 #endif
-  return vLen;
-}
-
-// 1D strip
-uint16_t Segment::virtualLength() const {
+  _vWidth  = vWidth;
+  _vHeight = vHeight;
+  _vStrips = 1;
 #ifndef WLED_DISABLE_2D
   if (is2D()) {
-    uint16_t vW = virtualWidth();
-    uint16_t vH = virtualHeight();
-    uint16_t vLen = vW * vH; // use all pixels from segment
+    uint16_t vLen = vWidth * vHeight; // use all pixels from segment
     switch (map1D2D) {
       case M12_pBar:
-        vLen = vH;
+        vLen = vHeight;
+        _vStrips = vWidth;
         break;
       case M12_pCorner:
       case M12_pArc:
-        vLen = max(vW,vH); // get the longest dimension
+        vLen = max(vWidth,vHeight); // get the longest dimension
         break;
     }
-    return vLen;
+    _vLength = vLen;
+    return;
   }
 #endif
-  uint16_t groupLen = groupLength(); // is always >= 1
   uint16_t vLength = (length() + groupLen - 1) / groupLen;
   if (mirror) vLength = (vLength + 1) /2;  // divide by 2 if mirror, leave at least a single LED
-  return vLength;
+  _vLength = vLength;
 }
 
-void IRAM_ATTR Segment::setPixelColor(int i, uint32_t col)
-{
-  if (!isActive()) return; // not active
+// chooses setPixelColor() variant so effects do not re-evaluate segment shape for every pixel
+// must be called whenever geometry, mapping or pixel buffer changes (before effect runs and when swapping mode state)
+void Segment::selectPixelWriter() {
+  updateGeometry(); // options may have been swapped (mode blending) or changed directly
+  _writer = &Segment::writePixelNone;
+  _writerLen = _writerW = _writerH = 0;
+  if (!isActive() || !_pixels) return;
+  const unsigned vLen = virtualLength();
 #ifndef WLED_DISABLE_2D
-  int vStrip = i>>16; // hack to allow running on virtual strips (2D segment columns/rows)
-#endif
-  i &= 0xFFFF;
-
-  if (i >= virtualLength() || i<0) return;  // if pixel would fall out of segment just exit
-
-#ifndef WLED_DISABLE_2D
-  if (is2D()) {
-    uint16_t vH = virtualHeight();  // segment height in logical pixels
-    uint16_t vW = virtualWidth();
+  if (is2D() && map1D2D != M12_Pixels) {
+    const unsigned vW = virtualWidth();
+    const unsigned vH = virtualHeight();
+    if (vW * vH != _pixelsLen) return; // geometry changed but buffer not yet reallocated
+    _writerLen = vLen;
+    _writerW = vW;
+    _writerH = vH;
     switch (map1D2D) {
-      case M12_Pixels:
-        // use all available pixels as a long strip
-        setPixelColorXY(i % vW, i / vW, col);
-        break;
-      case M12_pBar:
-        // expand 1D effect vertically or have it play on virtual strips
-        if (vStrip>0) setPixelColorXY(vStrip - 1, vH - i - 1, col);
-        else          for (int x = 0; x < vW; x++) setPixelColorXY(x, vH - i - 1, col);
-        break;
-      case M12_pArc:
-        // expand in circular fashion from center
-        if (i==0)
-          setPixelColorXY(0, 0, col);
-        else {
-          float step = HALF_PI / (2.85f*i);
-          for (float rad = 0.0f; rad <= HALF_PI+step/2; rad += step) {
-            // may want to try float version as well (with or without antialiasing)
-            int x = roundf(sin_t(rad) * i);
-            int y = roundf(cos_t(rad) * i);
-            setPixelColorXY(x, y, col);
-          }
-          // Bresenham’s Algorithm (may not fill every pixel)
-          //int d = 3 - (2*i);
-          //int y = i, x = 0;
-          //while (y >= x) {
-          //  setPixelColorXY(x, y, col);
-          //  setPixelColorXY(y, x, col);
-          //  x++;
-          //  if (d > 0) {
-          //    y--;
-          //    d += 4 * (x - y) + 10;
-          //  } else {
-          //    d += 4 * x + 6;
-          //  }
-          //}
-        }
-        break;
-      case M12_pCorner:
-        for (int x = 0; x <= i; x++) setPixelColorXY(x, i, col);
-        for (int y = 0; y <  i; y++) setPixelColorXY(i, y, col);
-        break;
+      case M12_pBar:    _writer = &Segment::writePixel2D<M12_pBar>;    break;
+      case M12_pArc:    _writer = &Segment::writePixel2D<M12_pArc>;    break;
+      case M12_pCorner: _writer = &Segment::writePixel2D<M12_pCorner>; break;
     }
     return;
-  } else if (Segment::maxHeight!=1 && (width()==1 || height()==1)) {
-    if (start < Segment::maxWidth*Segment::maxHeight) {
-      // we have a vertical or horizontal 1D segment (WARNING: virtual...() may be transposed)
-      int x = 0, y = 0;
-      if (virtualHeight()>1) y = i;
-      if (virtualWidth() >1) x = i;
-      setPixelColorXY(x, y, col);
-      return;
-    }
   }
+  // 2D pixels mode and 1D segments within matrix address row-major buffer linearly
+  if (is2D() || isMatrixStrip()) { _writerLen = MIN(unsigned(virtualWidth() * virtualHeight()), _pixelsLen); _writer = &Segment::writePixelLinear; return; }
 #endif
+  _writerLen = MIN(vLen, _pixelsLen);
+  _writer = &Segment::writePixelLinear;
+}
+
+void Segment::writePixelAuto(int i, uint32_t col) {
+  selectPixelWriter(); // never selects writePixelAuto()
+  (this->*_writer)(i, col);
+}
 
-  uint16_t len = length();
-  uint8_t _bri_t = currentBri();
-  if (_bri_t < 255) {
-    byte r = scale8(R(col), _bri_t);
-    byte g = scale8(G(col), _bri_t);
-    byte b = scale8(B(col), _bri_t);
-    byte w = scale8(W(col), _bri_t);
-    col = RGBW32(r, g, b, w);
-  }
-
-  // expand pixel (taking into account start, grouping, spacing [and offset])
-  i = i * groupLength();
-  if (reverse) { // is segment reversed?
-    if (mirror) { // is segment mirrored?
-      i = (len - 1) / 2 - i;  //only need to index half the pixels
+void IRAM_ATTR Segment::writePixelLinear(int i, uint32_t col) {
+  i &= 0xFFFF; // virtual strip index is irrelevant
+  if (unsigned(i) < _writerLen) _pixels[i] = col; // when blending modes each mode has its own buffer, they are crossfaded in renderToStrip()
+}
+
+#ifndef WLED_DISABLE_2D
+template<uint8_t M> void IRAM_ATTR Segment::writePixel2D(int i, uint32_t col) {
+  const int vStrip = i>>16; // hack to allow running on virtual strips (2D segment columns/rows)
+  i &= 0xFFFF;
+  if (i >= _writerLen) return; // if pixel would fall out of segment just exit
+  const int vW = _writerW;
+  const int vH = _writerH;
+  if (M == M12_pBar) {
+    // expand 1D effect vertically or have it play on virtual strips
+    uint32_t *row = _pixels + (vH - i - 1) * vW;
+    if (vStrip>0) { if (vStrip <= vW) row[vStrip - 1] = col; }
+    else          for (int x = 0; x < vW; x++) row[x] = col;
+  } else if (M == M12_pArc) {
+    // expand in circular fashion from center
+    if (_indexMap && _indexMapKey == arcMapKey(vW, vH)) {
+      for (unsigned p = _indexMap[i]; p < _indexMap[i+1]; p++) _pixels[_indexMap[p]] = col;
     } else {
-      i = (len - 1) - i;
+      arcPoints(i, [&](int x, int y) { setPixelColorXY(x, y, col); }); // no table (yet)
     }
+  } else if (M == M12_pCorner) {
+    if (i < vH) for (int x = 0; x <= i && x < vW; x++) _pixels[x + i * vW] = col;
+    if (i < vW) for (int y = 0; y <  i && y < vH; y++) _pixels[i + y * vW] = col;
   }
-  i += start; // starting pixel in a group
-
-  uint32_t tmpCol = col;
-  // set all the pixels in the group
-  for (int j = 0; j < grouping; j++) {
-    uint16_t indexSet = i + ((reverse) ? -j : j);
-    if (indexSet >= start && indexSet < stop) {
-      if (mirror) { //set the corresponding mirrored pixel
-        uint16_t indexMir = stop - indexSet + start - 1;
-        indexMir += offset; // offset/phase
-        if (indexMir >= stop) indexMir -= len; // wrap
-#ifndef WLED_DISABLE_MODE_BLEND
-        if (_modeBlend) tmpCol = color_blend(strip.getPixelColor(indexMir), col, 0xFFFFU - progress(), true);
+}
 #endif
-        strip.setPixelColor(indexMir, tmpCol);
-      }
-      indexSet += offset; // offset/phase
-      if (indexSet >= stop) indexSet -= len; // wrap
+
+// bulk version of setPixelColor() for a run of logical pixels, copies directly into pixel buffer if possible
+void Segment::setPixelColors(int start, uint16_t count, const uint32_t *c)
+{
+  if (!isActive() || !_pixels || start < 0) return;
+  if (is2D() || isMatrixStrip()) { // 1D to 2D mapping needs per pixel expansion
+    for (unsigned i = 0; i < count; i++) setPixelColor(start + int(i), c[i]);
+    return;
+  }
+  const int vLen = MIN(virtualLength(), _pixelsLen);
+  if (start >= vLen) return;
+  if (start + count > vLen) count = vLen - start;
+  memcpy(_pixels + start, c, count * sizeof(uint32_t));
+}
+
+// realtime routes write the buffer in its own order, for 2D segments row by row of the virtual
+// (reversed/transposed) matrix, orientation is applied when the buffer is rendered
+void Segment::setPixelsRaw(int start, uint16_t count, const uint32_t *c)
+{
+  if (!isActive() || !_pixels || start < 0) return;
+  const int vLen = MIN((is2D() || isMatrixStrip()) ? virtualWidth() * virtualHeight() : virtualLength(), _pixelsLen);
+  if (start >= vLen) return;
+  if (start + count > vLen) count = vLen - start;
+  memcpy(_pixels + start, c, count * sizeof(uint32_t));
+}
+
+// maps pixel buffer onto physical pixels, called once per frame from WS2812FX::service()
+void Segment::renderToStrip()
+{
+  if (!isActive() || !_pixels) return; // not active or nothing rendered yet
+  const uint8_t _bri_t = currentBri();
+  // crossfade from previous mode's buffer if modes are being blended
+  const uint32_t *prev = nullptr;
+  uint16_t prog = 0xFFFFU;
 #ifndef WLED_DISABLE_MODE_BLEND
-      if (_modeBlend) tmpCol = color_blend(strip.getPixelColor(indexSet), col, 0xFFFFU - progress(), true);
+  if (isInTransition() && currentMode() != mode && _t->_segT._pixelsLenT == _pixelsLen) {
+    prev = _t->_segT._pixelsT;
+    prog = progress();
+  }
 #endif
-      strip.setPixelColor(indexSet, tmpCol);
+  // in between keyframes: blend from previous effect output to the current one
+  const uint32_t *key = nullptr;
+  uint16_t kProg = 0xFFFFU;
+  const unsigned long t = millis();
+  if (isInterpolating(t)) {
+    key   = _pixelsKey;
+    kProg = ((t - _keyTime) << 16) / _keyLen;
+  }
+#ifndef WLED_DISABLE_2D
+  if (is2D() || isMatrixStrip()) {
+    const int vW = virtualWidth();
+    const int vH = virtualHeight();
+    if (vW * vH > _pixelsLen) return; // geometry changed but buffer not yet reallocated
+    if (vW != _rWidth || vH != _rHeight) { renderScaled(key, kProg, prev, prog, _bri_t); return; }
+    for (int y = 0; y < vH; y++) for (int x = 0; x < vW; x++) {
+      uint32_t col = _pixels[x + y * vW];
+      if (key)  col = color_blend(key[x + y * vW], col, kProg, true);
+      if (prev) col = color_blend(prev[x + y * vW], col, prog, true);
+      if (_bri_t < 255) col = color_fade(col, _bri_t);
+      renderPixelXY(x, y, col);
+    }
+    return;
+  }
+#endif
+  const unsigned vLen = virtualLength();
+  if (!_indexMap || vLen > _pixelsLen || _indexMapLen != length()) return; // geometry changed but buffers not yet reallocated
+  // collect contiguous physical pixels and write them as a run
+  uint32_t run[32];
+  unsigned runLen = 0;
+  for (unsigned p = 0; p < _indexMapLen; p++) {
+    const unsigned i = _indexMap[p];
+    if (i < vLen) {
+      uint32_t col = _pixels[i];
+      if (key)  col = color_blend(key[i], col, kProg, true);
+      if (prev) col = color_blend(prev[i], col, prog, true);
+      if (_bri_t < 255) col = color_fade(col, _bri_t);
+      run[runLen++] = col;
+    }
+    if (runLen && (i >= vLen || runLen == sizeof(run)/sizeof(run[0]) || p == _indexMapLen - 1)) {
+      unsigned end = (i < vLen) ? p + 1 : p; // pixel p is a gap (spacing) if not lit
+      strip.writeRange(start + end - runLen, runLen, run);
+      runLen = 0;
     }
   }
 }
 
+#ifndef WLED_DISABLE_2D
+// upscales reduced resolution canvas (renderScale) to rendered size, nearest or bilinear (sampled at pixel centers)
+void Segment::renderScaled(const uint32_t *key, uint16_t kProg, const uint32_t *prev, uint16_t prog, uint8_t bri)
+{
+  const int vW = virtualWidth();
+  const int vH = virtualHeight();
+  const unsigned s = renderScale;
+  const int maxU = (vW - 1) << 8, maxV = (vH - 1) << 8;
+  for (int y = 0; y < _rHeight; y++) {
+    const int v  = renderSmooth ? constrain((((2*y + 1) << 7) >> s) - 128, 0, maxV) : (y >> s) << 8; // source row in 1/256 pixel
+    const int y0 = (v >> 8) * vW;
+    const int y1 = (v >= maxV) ? y0 : y0 + vW;
+    const uint8_t fy = v & 0xFF;
+    for (int x = 0; x < _rWidth; x++) {
+      const int u  = renderSmooth ? constrain((((2*x + 1) << 7) >> s) - 128, 0, maxU) : (x >> s) << 8;
+      const int x0 = u >> 8;
+      const int x1 = (u >= maxU) ? x0 : x0 + 1;
+      const uint8_t fx = u & 0xFF;
+      uint32_t col = _pixels[x0 + y0];
+      if (fx || fy) col = color_blend(color_blend(col, _pixels[x1 + y0], fx), color_blend(_pixels[x0 + y1], _pixels[x1 + y1], fx), fy);
+      if (key) {
+        uint32_t k = key[x0 + y0];
+        if (fx || fy) k = color_blend(color_blend(k, key[x1 + y0], fx), color_blend(key[x0 + y1], key[x1 + y1], fx), fy);
+        col = color_blend(k, col, kProg, true);
+      }
+      if (prev) {
+        uint32_t old = prev[x0 + y0];
+        if (fx || fy) old = color_blend(color_blend(old, prev[x1 + y0], fx), color_blend(prev[x0 + y1], prev[x1 + y1], fx), fy);
+        col = color_blend(old, col, prog, true);
+      }
+      if (bri < 255) col = color_fade(col, bri);
+      renderPixelXY(x, y, col);
+    }
+  }
+}
+#endif
+
 // anti-aliased normalized version of setPixelColor()
 void Segment::setPixelColor(float i, uint32_t col, bool aa)
 {
@@ -807,9 +1354,36 @@ void Segment::setPixelColor(float i, uint32_t col, bool aa)
   }
 }
 
-uint32_t Segment::getPixelColor(int i)
+// fixed point version of anti-aliased setPixelColor(float), i is normalized position (65535 = 1.0) in lower 16 bits
+void Segment::setPixelColorQ16(uint32_t i, uint32_t col, bool aa)
+{
+  if (!isActive()) return; // not active
+  const int vStrip = i & 0xFFFF0000; // hack to allow running on virtual strips (2D segment columns/rows)
+  const uint32_t fC = (i & 0xFFFF) * (virtualLength()-1);
+  const uint32_t pos = fC + (fC >> 16); // pixel position in Q16 (fC * 65536/65535)
+  const uint16_t n = pos >> 16;
+  const uint32_t frac = pos & 0xFFFF;
+  if (aa) {
+    uint16_t iL = frac >= 64881 ? n+1 : n;  // same limits as float version (0.99)
+    uint16_t iR = frac >= 655   ? n+1 : n;  // (0.01)
+    if (iR!=iL) {
+      const uint32_t rFrac = 65536 - frac;
+      // blend L pixel
+      setPixelColor(iL | vStrip, color_blend(col, getPixelColor(iL | vStrip), (((frac * frac) >> 16) * 255) >> 16));
+      // blend R pixel
+      setPixelColor(iR | vStrip, color_blend(col, getPixelColor(iR | vStrip), (((rFrac * rFrac) >> 16) * 255) >> 16));
+    } else {
+      // exact match (x & y land on a pixel)
+      setPixelColor(iL | vStrip, col);
+    }
+  } else {
+    setPixelColor((frac >= 32768 ? n+1 : n) | vStrip, col);
+  }
+}
+
+uint32_t WLED_HOT(Segment_getPixelColor) Segment::getPixelColor(int i)
 {
-  if (!isActive()) return 0; // not active
+  if (!isActive() || !_pixels) return 0; // not active or no pixel buffer
 #ifndef WLED_DISABLE_2D
   int vStrip = i>>16;
 #endif
@@ -837,16 +1411,22 @@ uint32_t Segment::getPixelColor(int i)
   }
 #endif
 
-  if (reverse) i = virtualLength() - i - 1;
-  i *= groupLength();
-  i += start;
-  /* offset/phase */
-  i += offset;
-  if ((i >= stop) && (stop>0)) i -= length(); // avoids negative pixel index (stop = 0 is a possible value)
-  return strip.getPixelColor(i);
+  // 1D segments within matrix store pixels linearly as well (either width or height is 1)
+  return unsigned(i) < _pixelsLen ? _pixels[i] : 0;
+}
+
+Segment::settings_t Segment::settings() const {
+  settings_t s;
+  s.start = start; s.stop = stop; s.startY = startY; s.stopY = stopY; s.offset = offset; s.options = options;
+  s.grouping = grouping; s.spacing = spacing; s.opacity = opacity; s.mode = mode;
+  s.speed = speed; s.intensity = intensity; s.palette = palette; s.custom1 = custom1; s.custom2 = custom2; s.custom3 = custom3;
+  s.blendMode = blendMode; s.layerOpacity = layerOpacity; s.zIndex = zIndex;
+  s.renderScale = renderScale; s.renderSmooth = renderSmooth; s.interpolate = interpolate;
+  for (unsigned i = 0; i < NUM_COLORS; i++) s.colors[i] = colors[i];
+  return s;
 }
 
-uint8_t Segment::differs(Segment& b) const {
+uint8_t Segment::differs(const settings_t &b) const {
   uint8_t d = 0;
   if (start != b.start)         d |= SEG_DIFFERS_BOUNDS;
   if (stop != b.stop)           d |= SEG_DIFFERS_BOUNDS;
@@ -863,6 +1443,8 @@ uint8_t Segment::differs(Segment& b) const {
   if (custom3 != b.custom3)     d |= SEG_DIFFERS_FX;
   if (startY != b.startY)       d |= SEG_DIFFERS_BOUNDS;
   if (stopY != b.stopY)         d |= SEG_DIFFERS_BOUNDS;
+  if (blendMode != b.blendMode || layerOpacity != b.layerOpacity || zIndex != b.zIndex) d |= SEG_DIFFERS_OPT;
+  if (renderScale != b.renderScale || renderSmooth != b.renderSmooth || interpolate != b.interpolate) d |= SEG_DIFFERS_OPT;
 
   //bit pattern: (msb first)
   // set:2, sound:2, mapping:3, transposed, mirrorY, reverseY, [reset,] paused, mirrored, on, reverse, [selected]
@@ -883,11 +1465,16 @@ void Segment::refreshLightCapabilities() {
     return;
   }
 
-  if (start < Segment::maxWidth * Segment::maxHeight) {
+  if (start < Segment::matrixArea) {
     // we are withing 2D matrix (includes 1D segments)
+    #ifndef WLED_DISABLE_2D
+    const WS2812FX::Canvas c = strip.getCanvas(canvasIdx);
+    #else
+    const struct { uint16_t offset, width; } c = { 0, Segment::maxWidth };
+    #endif
     for (int y = startY; y < stopY; y++) for (int x = start; x < stop; x++) {
-      uint16_t index = x + Segment::maxWidth * y;
-      if (index < strip.customMappingSize) index = strip.customMappingTable[index]; // convert logical address to physical
+      uint16_t index = c.offset + x + c.width * y;
+      index = strip.getMappedPixelIndex(index); // convert logical address to physical
       if (index < 0xFFFFU) {
         if (segStartIdx > index) segStartIdx = index;
         if (segStopIdx  < index) segStopIdx  = index;
@@ -923,17 +1510,35 @@ void Segment::refreshLightCapabilities() {
   _capabilities = capabilities;
 }
 
+/*
+ * Clears pixel buffer and turns off all physical pixels within segment bounds (including spacing gaps)
+ */
+void Segment::clear() {
+  if (!isActive()) return; // not active
+  if (_pixels) memset(_pixels, 0, _pixelsLen * sizeof(uint32_t));
+  #ifndef WLED_DISABLE_2D
+  if (start < Segment::matrixArea) {
+    const WS2812FX::Canvas c = strip.getCanvas(canvasIdx);
+    for (int y = startY; y < stopY; y++) for (int x = start; x < stop; x++) strip.setPixelColorXY(c, x, y, BLACK);
+    return;
+  }
+  #endif
+  for (int i = start; i < stop; i++) strip.setPixelColor(i, BLACK);
+}
+
 /*
  * Fills segment with color
  */
+// number of valid pixels in pixel buffer (which is contiguous: row-major for 2D, linear for 1D, even within a matrix)
+unsigned Segment::pixelCount() const {
+  if (!_pixels) return 0;
+  return MIN(bufferLength(), _pixelsLen); // geometry changed but buffer not yet reallocated
+}
+
 void Segment::fill(uint32_t c) {
   if (!isActive()) return; // not active
-  const uint16_t cols = is2D() ? virtualWidth() : virtualLength();
-  const uint16_t rows = virtualHeight(); // will be 1 for 1D
-  for (int y = 0; y < rows; y++) for (int x = 0; x < cols; x++) {
-    if (is2D()) setPixelColorXY(x, y, c);
-    else        setPixelColor(x, c);
-  }
+  const unsigned len = pixelCount();
+  for (unsigned i = 0; i < len; i++) _pixels[i] = c;
 }
 
 // Blends the specified color with the existing pixel color.
@@ -957,11 +1562,10 @@ void Segment::fadePixelColor(uint16_t n, uint8_t fade) {
  */
 void Segment::fade_out(uint8_t rate) {
   if (!isActive()) return; // not active
-  const uint16_t cols = is2D() ? virtualWidth() : virtualLength();
-  const uint16_t rows = virtualHeight(); // will be 1 for 1D
+  const unsigned len = pixelCount();
 
   rate = (255-rate) >> 1;
-  float mappedRate = float(rate) +1.1f;
+  const int mappedRate10 = 10 * rate + 11; // (rate + 1.1) * 10, integer division truncates like the float version
 
   uint32_t color = colors[1]; // SEGCOLOR(1); // target color
   int w2 = W(color);
@@ -969,17 +1573,18 @@ void Segment::fade_out(uint8_t rate) {
   int g2 = G(color);
   int b2 = B(color);
 
-  for (int y = 0; y < rows; y++) for (int x = 0; x < cols; x++) {
-    color = is2D() ? getPixelColorXY(x, y) : getPixelColor(x);
+  for (unsigned i = 0; i < len; i++) {
+    color = _pixels[i];
+    if (color == colors[1]) continue; // fade complete
     int w1 = W(color);
     int r1 = R(color);
     int g1 = G(color);
     int b1 = B(color);
 
-    int wdelta = (w2 - w1) / mappedRate;
-    int rdelta = (r2 - r1) / mappedRate;
-    int gdelta = (g2 - g1) / mappedRate;
-    int bdelta = (b2 - b1) / mappedRate;
+    int wdelta = (w2 - w1) * 10 / mappedRate10;
+    int rdelta = (r2 - r1) * 10 / mappedRate10;
+    int gdelta = (g2 - g1) * 10 / mappedRate10;
+    int bdelta = (b2 - b1) * 10 / mappedRate10;
 
     // if fade isn't complete, make sure delta is at least 1 (fixes rounding issues)
     wdelta += (w2 == w1) ? 0 : (w2 > w1) ? 1 : -1;
@@ -987,21 +1592,14 @@ void Segment::fade_out(uint8_t rate) {
     gdelta += (g2 == g1) ? 0 : (g2 > g1) ? 1 : -1;
     bdelta += (b2 == b1) ? 0 : (b2 > b1) ? 1 : -1;
 
-    if (is2D()) setPixelColorXY(x, y, r1 + rdelta, g1 + gdelta, b1 + bdelta, w1 + wdelta);
-    else        setPixelColor(x, r1 + rdelta, g1 + gdelta, b1 + bdelta, w1 + wdelta);
+    _pixels[i] = RGBW32(r1 + rdelta, g1 + gdelta, b1 + bdelta, w1 + wdelta);
   }
 }
 
 // fades all pixels to black using nscale8()
 void Segment::fadeToBlackBy(uint8_t fadeBy) {
   if (!isActive() || fadeBy == 0) return;   // optimization - no scaling to apply
-  const uint16_t cols = is2D() ? virtualWidth() : virtualLength();
-  const uint16_t rows = virtualHeight(); // will be 1 for 1D
-
-  for (int y = 0; y < rows; y++) for (int x = 0; x < cols; x++) {
-    if (is2D()) setPixelColorXY(x, y, color_fade(getPixelColorXY(x,y), 255-fadeBy));
-    else        setPixelColor(x, color_fade(getPixelColor(x), 255-fadeBy));
-  }
+  color_fade_n(_pixels, pixelCount(), 255-fadeBy); // operates on pixel buffer directly (single pass, no mapping)
 }
 
 /*
@@ -1058,14 +1656,14 @@ uint32_t Segment::color_wheel(uint8_t pos) {
 
 /*
  * Gets a single color from the currently selected palette.
- * @param i Palette Index (if mapping is true, the full palette will be _virtualSegmentLength long, if false, 255). Will wrap around automatically.
+ * @param i Palette Index (if mapping is true, the full palette will be SEGLEN long, if false, 255). Will wrap around automatically.
  * @param mapping if true, LED position in segment is considered for color
  * @param wrap FastLED palettes will usually wrap back to the start smoothly. Set false to get a hard edge
  * @param mcol If the default palette 0 is selected, return the standard color 0, 1 or 2 instead. If >2, Party palette is used instead
  * @param pbri Value to scale the brightness of the returned color by. Default is 255. (no scaling)
  * @returns Single color from palette
  */
-uint32_t Segment::color_from_palette(uint16_t i, bool mapping, bool wrap, uint8_t mcol, uint8_t pbri)
+uint32_t WLED_HOT(Segment_color_from_palette) Segment::color_from_palette(uint16_t i, bool mapping, bool wrap, uint8_t mcol, uint8_t pbri)
 {
   // default palette or no RGB support on segment
   if ((palette == 0 && mcol < NUM_COLORS) || !_isRGB) {
@@ -1078,9 +1676,11 @@ uint32_t Segment::color_from_palette(uint16_t i, bool mapping, bool wrap, uint8_
   uint8_t paletteIndex = i;
   if (mapping && virtualLength() > 1) paletteIndex = (i*255)/(virtualLength() -1);
   if (!wrap && strip.paletteBlend != 3) paletteIndex = scale8(paletteIndex, 240); //cut off blend at palette "end"
-  CRGB fastled_col = ColorFromPalette(_currentPalette, paletteIndex, pbri, (strip.paletteBlend == 3)? NOBLEND:LINEARBLEND); // NOTE: paletteBlend should be global
-
-  return RGBW32(fastled_col.r, fastled_col.g, fastled_col.b, 0);
+  const unsigned ctx = RENDER_CTX();
+  uint32_t color = _paletteCache[ctx][_paletteCacheSlot[ctx]][paletteIndex]; // expanded in setCurrentPalette()
+  if (pbri == 255) return color;
+  if (pbri == 0) return BLACK;
+  return color_fade(color, pbri+1); // same rounding as ColorFromPalette()
 }
 
 
@@ -1091,6 +1691,7 @@ uint32_t Segment::color_from_palette(uint16_t i, bool mapping, bool wrap, uint8_
 //do not call this method from system context (network callback)
 void WS2812FX::finalizeInit(void)
 {
+  if (_rngBoot == 1) _rngBoot = random(2, INT32_MAX); // hardware RNG, effects differ between boots unless a seed is set
   //reset segment runtimes
   for (segment &seg : _segments) {
     seg.markForReset();
@@ -1146,7 +1747,40 @@ void WS2812FX::finalizeInit(void)
   else {
     Segment::maxWidth  = _length;
     Segment::maxHeight = 1;
+    Segment::matrixArea = _length;
+  }
+  updateWireLimit(); // after matrix setup, DDP tiles depend on panels
+
+#ifdef WLED_ENABLE_PIPELINED_OUTPUT
+  if (!_outputTask) {
+    _outputDone = xSemaphoreCreateBinary();
+    if (_outputDone) xTaskCreatePinnedToCore(
+      outputTask,               // Function to implement the task
+      "LEDout",                 // Name of the task
+      3072,                     // Stack size in words
+      this,                     // Task input parameter
+      2,                        // Priority of the task (above loop())
+      &_outputTask,             // Task handle
+      xPortGetCoreID() ? 0 : 1  // Core where the task should run (the one not running loop())
+    );
+    DEBUG_PRINTF("Output task %s.\n", _outputTask ? "started" : "failed");
+  }
+#endif
+#ifdef WLED_ENABLE_PARALLEL_RENDER
+  if (!_renderTask) {
+    _renderDone = xSemaphoreCreateBinary();
+    if (_renderDone) xTaskCreatePinnedToCore(
+      renderTask,               // Function to implement the task
+      "FXrender",               // Name of the task
+      8192,                     // Stack size (same as loop(), effects keep line buffers on stack)
+      this,                     // Task input parameter
+      1,                        // Priority of the task (same as loop())
+      &_renderTask,             // Task handle
+      xPortGetCoreID() ? 0 : 1  // Core where the task should run (the one not running loop())
+    );
+    DEBUG_PRINTF("Render task %s.\n", _renderTask ? "started" : "failed");
   }
+#endif
 
   //segments are created in makeAutoSegments();
   DEBUG_PRINTLN(F("Loading custom palettes"));
@@ -1155,77 +1789,241 @@ void WS2812FX::finalizeInit(void)
   deserializeMap();     // (re)load default ledmap
 }
 
+#ifdef WLED_ENABLE_PARALLEL_RENDER
+static portMUX_TYPE renderMux = portMUX_INITIALIZER_UNLOCKED; // due list and effect statistics are shared by loop() and render task
+#define RENDER_LOCK()   portENTER_CRITICAL(&renderMux)
+#define RENDER_UNLOCK() portEXIT_CRITICAL(&renderMux)
+#else
+#define RENDER_LOCK()
+#define RENDER_UNLOCK()
+#endif
+
+// frame budget is derived from target FPS; once it is used up remaining segments are deferred to next frame
+// (they keep their deadline so they will be first then), a segment more than a frame late is never deferred
+// independent of that rendering yields to the main loop after WLED_RENDER_SLICE_US (at least one segment per pass)
+// so network input is handled in between, the frame is shown once all due segments are rendered
+// with parallel rendering loop() (main) and render task both take the next due segment until none is left
+void WS2812FX::renderDue(bool main) {
+  const unsigned long budget = _frametime * 1000UL; // in us
+  const unsigned long nowUp = _renderNow;
+  auto &ctx = _renderCtx[RENDER_CTX()];
+  for (;;) {
+    unsigned long t0 = micros();
+    RENDER_LOCK();
+    if (main && WLED_RENDER_SLICE_US && _dueRun && t0 - _sliceStart > WLED_RENDER_SLICE_US) _dueYield = true; // resume in next pass
+    if (_dueYield || _dueNext >= _numDue) { RENDER_UNLOCK(); break; }
+    const unsigned d = _dueNext++;
+    _dueRun++;
+    RENDER_UNLOCK();
+    if (_due[d] >= _segments.size() || !_segments[_due[d]].isActive()) { _due[d] = 255; continue; } // removed in the meantime
+    segment &seg = _segments[_due[d]];
+    if (_frameShow && !_triggered && _frameUs + (t0 - _sliceStart) > budget && nowUp - seg.next_time < _frametime) { _due[d] = 255; continue; }
+
+    ctx.segIndex = _due[d];
+    ctx.rng = &seg.rng;
+    _frameShow = true;
+    uint16_t delay = FRAMETIME;
+
+    if (!seg.freeze) { //only run effect function if not frozen
+      seg.saveKeyframe();                   // interpolating: effect renders over its last output, which is kept for blending
+      ctx.vLength = seg.virtualLength();
+      for (int c = 0; c < NUM_COLORS; c++) ctx.colors[c] = gamma32(seg.currentColor(c));
+      seg.setCurrentPalette();              // load actual palette
+
+      // Effect blending
+      // When two effects are being blended, each may have different segment data, this
+      // data needs to be saved first and then restored before running previous mode.
+      // Each effect renders into its own pixel buffer (previous mode's buffer is swapped in
+      // together with its segment data) and both are crossfaded in renderToStrip().
+      [[maybe_unused]] uint8_t tmpMode = seg.currentMode();  // this will return old mode while in transition
+      unsigned long tFx = micros();
+      delay = (*getModeFn(seg.mode))();     // run new/current mode
+      recordEffectTime(ctx.segIndex, seg.mode, micros() - tFx);
+      traceEvent(TRACE_FX, ctx.segIndex, seg.mode | (RENDER_CTX() << 8), tFx, micros() - tFx);
+#ifndef WLED_DISABLE_MODE_BLEND
+      if (modeBlending && seg.mode != tmpMode) {
+        Segment::tmpsegd_t _tmpSegData;
+        Segment::modeBlend(true);           // set semaphore
+        seg.swapSegenv(_tmpSegData);        // temporarily store new mode state (and swap it with transitional state)
+        ctx.vLength = seg.virtualLength();  // update SEGLEN (mapping may have changed)
+        tFx = micros();
+        uint16_t d2 = (*getModeFn(tmpMode))(); // run old mode
+        recordEffectTime(255, tmpMode, micros() - tFx); // segment statistics only track current mode
+        traceEvent(TRACE_FX, ctx.segIndex, tmpMode | (RENDER_CTX() << 8), tFx, micros() - tFx);
+        seg.restoreSegenv(_tmpSegData);     // restore mode state (will also update transitional state)
+        delay = MIN(delay,d2);              // use shortest delay
+        Segment::modeBlend(false);          // unset semaphore
+      }
+#endif
+      if (seg.mode != FX_MODE_HALLOWEEN_EYES) seg.call++;
+      if (seg.isInTransition() && delay > FRAMETIME) delay = FRAMETIME; // force faster updates during transition
+    }
+
+    seg.next_time = nowUp + delay;
+    seg.setKeyframe(nowUp, !seg.freeze && delay > _frametime ? delay : 0); // no in-between frames if effect updates every frame
+    _dueSpent[d] = micros() - t0;
+    if (_segFrames[ctx.segIndex] < UINT16_MAX) _segFrames[ctx.segIndex]++;
+    if (main && ctx.segIndex == _queuedChangesSegId) setUpSegmentFromQueuedChanges(); // render task leaves it to service()
+  }
+}
+
+#ifdef WLED_FRAME_CLOCK
+void IRAM_ATTR WS2812FX::clockTick(void *parameter) {
+  static_cast<WS2812FX*>(parameter)->_clockTicks++;
+}
+
+// (re)starts the timer with current frame time, tick 0 is now
+void WS2812FX::startFrameClock() {
+  if (_clockTimer) esp_timer_stop(_clockTimer);
+  else {
+    esp_timer_create_args_t args = {};
+    args.callback = clockTick;
+    args.arg      = this;
+    args.name     = "frameclk";
+    if (esp_timer_create(&args, &_clockTimer) != ESP_OK) _clockTimer = nullptr;
+    DEBUG_PRINTF("Frame clock %s.\n", _clockTimer ? "created" : "failed");
+  }
+  _clockPeriod = _frametime;
+  _clockTicks  = _clockSeen = 0;
+  _clockEpoch  = millis();
+  if (_clockTimer) esp_timer_start_periodic(_clockTimer, _clockPeriod * 1000ULL);
+}
+
+// true if a new tick arrived, _clockFrame is set to its scheduled time; without timer every call is a tick at millis()
+bool WS2812FX::frameClockTick() {
+  if (_clockPeriod != _frametime) startFrameClock(); // target FPS changed
+  if (!_clockTimer) { _clockFrame = millis(); return true; }
+  const uint32_t ticks = _clockTicks;
+  if (ticks == _clockSeen) return false;
+  if (ticks - _clockSeen > 1) _clockOverruns += ticks - _clockSeen - 1; // loop (or last frame) took too long, frames were dropped
+  _clockSeen  = ticks;
+  _clockFrame = _clockEpoch + ticks * _clockPeriod;
+  return true;
+}
+#endif
+
 void WS2812FX::service() {
   unsigned long nowUp = millis(); // Be aware, millis() rolls over every 49 days
   now = nowUp + timebase;
-  if (nowUp - _lastShow < MIN_SHOW_DELAY) return;
-  bool doShow = false;
+  if (isBenchmarking()) { _numDue = 0; serviceBenchmark(); return; }
+  const bool resumed = _numDue; // continue frame started in a previous loop pass
+  // new frame is started just in time to be ready when busses finished sending the previous one
+  if (!resumed && busses.getBusyTime() > _leadUs) return;
+#ifdef WLED_FRAME_CLOCK
+  // frames start on clock ticks and effects see the scheduled time of the frame instead of the (jittery) time
+  // loop() got here, so motion stays even; a frame rendered over several passes keeps its time
+  if (!resumed && !frameClockTick()) return;
+  nowUp = _clockFrame;
+  now = nowUp + timebase;
+#endif
 
   _isServicing = true;
-  _segment_index = 0;
-  Segment::handleRandomPalette(); // move it into for loop when each segment has individual random palette
-  for (segment &seg : _segments) {
-    // process transition (mode changes in the middle of transition)
-    seg.handleTransition();
-    // reset the segment runtime data if needed
-    seg.resetIfRequired();
-
-    if (!seg.isActive()) continue;
 
-    // last condition ensures all solid segments are updated at the same time
-    if (nowUp > seg.next_time || _triggered || (doShow && seg.mode == FX_MODE_STATIC))
-    {
-      doShow = true;
-      uint16_t delay = FRAMETIME;
-
-      if (!seg.freeze) { //only run effect function if not frozen
-        _virtualSegmentLength = seg.virtualLength();
-        _colors_t[0] = seg.currentColor(0);
-        _colors_t[1] = seg.currentColor(1);
-        _colors_t[2] = seg.currentColor(2);
-        seg.setCurrentPalette();              // load actual palette
-
-        if (!cctFromRgb || correctWB) busses.setSegmentCCT(seg.currentBri(true), correctWB);
-        for (int c = 0; c < NUM_COLORS; c++) _colors_t[c] = gamma32(_colors_t[c]);
-
-        // Effect blending
-        // When two effects are being blended, each may have different segment data, this
-        // data needs to be saved first and then restored before running previous mode.
-        // The blending will largely depend on the effect behaviour since actual output (LEDs) may be
-        // overwritten by later effect. To enable seamless blending for every effect, additional LED buffer
-        // would need to be allocated for each effect and then blended together for each pixel.
-        [[maybe_unused]] uint8_t tmpMode = seg.currentMode();  // this will return old mode while in transition
-        delay = (*_mode[seg.mode])();         // run new/current mode
-#ifndef WLED_DISABLE_MODE_BLEND
-        if (modeBlending && seg.mode != tmpMode) {
-          Segment::tmpsegd_t _tmpSegData;
-          Segment::modeBlend(true);           // set semaphore
-          seg.swapSegenv(_tmpSegData);        // temporarily store new mode state (and swap it with transitional state)
-          _virtualSegmentLength = seg.virtualLength(); // update SEGLEN (mapping may have changed)
-          uint16_t d2 = (*_mode[tmpMode])();  // run old mode
-          seg.restoreSegenv(_tmpSegData);     // restore mode state (will also update transitional state)
-          delay = MIN(delay,d2);              // use shortest delay
-          Segment::modeBlend(false);          // unset semaphore
-        }
+  if (!resumed) {
+    // collect segments that are due and order them by deadline (most overdue first)
+    // segments keep their pixel buffers so segments that are not due (i.e. static ones) need not be rendered again
+    _frameUs = 0;
+    _frameShow = false;
+    _frameStartUs = micros();
+    _dueNext = 0;
+    // global brightness transition is evaluated with the segment transitions, once per shown frame
+    if (nowUp - _lastShow >= _frametime) {
+      updateTransitionBri(nowUp);
+      if (_briDeferred) _frameShow = true;
+    }
+    for (size_t i = 0; i < _segments.size() && i < MAX_NUM_SEGMENTS; i++) {
+      segment &seg = _segments[i];
+      // process transition (mode changes in the middle of transition)
+      seg.handleTransition(nowUp);
+      // reset the segment runtime data if needed
+      seg.resetIfRequired();
+
+      if (!seg.isActive()) { seg.deallocatePixels(); continue; }
+      seg.updateGeometry(); // bounds or options may have been changed directly (JSON, UDP sync)
+      seg.allocatePixels(); // make sure pixel buffer matches segment geometry (it will be erased if geometry changed)
+      seg.selectPixelWriter();
+      if (seg.isInterpolating(nowUp) && nowUp - _lastShow >= _frametime) _frameShow = true; // in-between frame, not rendered
+
+#ifdef WLED_FRAME_CLOCK
+      const bool due = nowUp >= seg.next_time; // frame times are on the tick grid, a delay of one frame is due on next tick
+#else
+      const bool due = nowUp > seg.next_time;
 #endif
-        if (seg.mode != FX_MODE_HALLOWEEN_EYES) seg.call++;
-        if (seg.isInTransition() && delay > FRAMETIME) delay = FRAMETIME; // force faster updates during transition
+      if (due || _triggered) {
+        unsigned j = _numDue++;
+        for (; j > 0 && _segments[_due[j-1]].next_time > seg.next_time; j--) _due[j] = _due[j-1];
+        _due[j] = i;
       }
+    }
+  }
 
-      seg.next_time = nowUp + delay;
+  if (resumed) { // segments may have been changed between passes (pixel buffers must be reallocated from here)
+    for (unsigned d = _dueNext; d < _numDue; d++) {
+      if (_due[d] >= _segments.size() || !_segments[_due[d]].isActive()) continue;
+      segment &seg = _segments[_due[d]];
+      seg.resetIfRequired();
+      seg.updateGeometry();
+      seg.allocatePixels();
+      seg.selectPixelWriter();
     }
-    if (_segment_index == _queuedChangesSegId) setUpSegmentFromQueuedChanges();
-    _segment_index++;
   }
-  _virtualSegmentLength = 0;
-  busses.setSegmentCCT(-1);
+
+  _renderNow  = nowUp;
+  _sliceStart = micros();
+  _dueRun     = 0;
+  _dueYield   = false;
+#ifdef WLED_ENABLE_PARALLEL_RENDER
+  // render task takes segments from the same list; each segment renders into its own buffer, so the only join needed is before compositing
+  _renderParallel = _renderTask && _numDue - _dueNext > 1;
+  if (_renderParallel) xTaskNotifyGive(_renderTask);
+  renderDue(true);
+  if (_renderParallel) {
+    xSemaphoreTake(_renderDone, portMAX_DELAY);
+    _renderParallel = false;
+  }
+#else
+  renderDue(true);
+#endif
+  _renderCtx[RENDER_CTX()].segIndex = 0;
+  _renderCtx[RENDER_CTX()].rng = nullptr;
+  _frameUs += micros() - _sliceStart;
+
+  if (_queuedChangesSegId < 255) setUpSegmentFromQueuedChanges(); // segment was not rendered this pass
+  _renderCtx[RENDER_CTX()].vLength = 0;
   _isServicing = false;
+  if (_dueNext < _numDue) return; // frame not complete yet
+
+  // budget exceeded: slow down segments that took more than their fair share of the frame by their excess
+  const unsigned long budget = _frametime * 1000UL; // in us
+  unsigned numRendered = 0;
+  for (unsigned d = 0; d < _numDue; d++) if (_due[d] != 255) numRendered++;
+  if (numRendered > 1 && _frameUs > budget) {
+    const uint32_t fair = budget / numRendered;
+    for (unsigned d = 0; d < _numDue; d++) {
+      if (_due[d] == 255 || _due[d] >= _segments.size() || _dueSpent[d] <= fair) continue;
+      _segments[_due[d]].next_time += (_dueSpent[d] - fair) / 1000;
+    }
+  }
+  _numDue = 0;
   _triggered = false;
 
+  // achieved per segment frame rate
+  if (nowUp - _segFpsTime >= 1000) {
+    for (unsigned i = 0; i < MAX_NUM_SEGMENTS; i++) {
+      _segFps[i] = MIN(255UL, (_segFrames[i] * 1000UL + 500) / (nowUp - _segFpsTime));
+      _segFrames[i] = 0;
+    }
+    _segFpsTime = nowUp;
+  }
+
   #ifdef WLED_DEBUG
-  if (millis() - nowUp > _frametime) DEBUG_PRINTLN(F("Slow effects."));
+  if (_frameUs > budget) DEBUG_PRINTLN(F("Slow effects."));
   #endif
-  if (doShow) {
+  if (_frameShow) {
+    waitForOutput(); // bus buffers are still used by output task (effects above only touched segment buffers)
+    compositeSegments();
+    uint32_t lead = MIN(micros() - _frameStartUs, _frametime * 1000UL);
+    _leadUs = (3 * _leadUs + lead) >> 2;
     yield();
     show();
   }
@@ -1234,17 +2032,102 @@ void WS2812FX::service() {
   #endif
 }
 
+// map segment buffers onto physical pixels, ordered by zIndex (segments later in list are drawn over previous
+// ones); layered segments are blended with what is below them, starting from black
+void WS2812FX::compositeSegments() {
+  uint8_t order[MAX_NUM_SEGMENTS];
+  unsigned numSegs = 0;
+  bool layered = false;
+  for (size_t i = 0; i < _segments.size() && i < MAX_NUM_SEGMENTS; i++) {
+    if (!_segments[i].isActive()) continue;
+    layered |= _segments[i].isLayered();
+    unsigned j = numSegs++;
+    for (; j > 0 && _segments[order[j-1]].zIndex > _segments[i].zIndex; j--) order[j] = order[j-1];
+    order[j] = i;
+  }
+  if (_briDeferred) busses.setBrightness(_brightness, false); // all pixels are written below with the new brightness
+  if (layered || _briDeferred) { // with new brightness pixels outside segments would keep the old one
+    static const uint32_t black[32] = {0};
+    for (unsigned i = 0; i < _length; i += 32) busses.setPixelColors(i, MIN(32U, _length - i), black);
+  }
+  for (unsigned j = 0; j < numSegs; j++) {
+    segment &seg = _segments[order[j]];
+    if (!cctFromRgb || correctWB) busses.setSegmentCCT(seg.currentBri(true), correctWB); // bus applies CCT as pixels are written
+    _layerMode  = seg.blendMode;
+    _layerAlpha = seg.liveAlpha == 255 ? seg.layerOpacity : scale8(seg.layerOpacity, seg.liveAlpha);
+    seg.renderToStrip();
+  }
+  _layerMode  = SEG_BLEND_NORMAL;
+  _layerAlpha = 255;
+  busses.setSegmentCCT(-1);
+  _briDeferred = false;
+}
+
 void IRAM_ATTR WS2812FX::setPixelColor(int i, uint32_t col)
 {
-  if (i < customMappingSize) i = customMappingTable[i];
+  if (i < customMappingSize) i = customMappingTable ? customMappingTable[i] : mapRunIndex(i);
   if (i >= _length) return;
+#ifdef WLED_ENABLE_PIPELINED_OUTPUT
+  if (_outputBusy) waitForOutput();
+#endif
+  if (_layerMode != SEG_BLEND_NORMAL || _layerAlpha < 255) { // compositing a layered segment
+    uint32_t c = busses.getPixelColor(i);
+    color_layer_n(&c, &col, 1, _layerMode, _layerAlpha);
+    col = c;
+  }
   busses.setPixelColor(i, col);
 }
 
-uint32_t WS2812FX::getPixelColor(uint16_t i)
+// bulk version of setPixelColor(), contiguous runs are handed to busses at once
+void IRAM_ATTR WS2812FX::writeRange(uint16_t start, uint16_t count, const uint32_t *c)
 {
-  if (i < customMappingSize) i = customMappingTable[i];
+  if (start < customMappingSize) { // ledmap may scatter pixels
+    if (customMappingTable) {
+      for (unsigned i = 0; i < count; i++) setPixelColor(start + i, c[i]);
+      return;
+    }
+    // compressed ledmap: ascending runs are still contiguous on busses
+    while (count && start < customMappingSize) {
+      mapRunIndex(start);
+      const map_run_t &r = _mapRuns[_mapRunHit];
+      unsigned n = MIN((unsigned)count, (unsigned)(r.start + r.len - start));
+      if (r.step == 1) writeBusRange(r.value + (start - r.start), n, c);
+      else for (unsigned i = 0; i < n; i++) setPixelColor(start + i, c[i]);
+      start += n; count -= n; c += n;
+    }
+    if (!count) return;
+  }
+  writeBusRange(start, count, c);
+}
+
+// writes physical pixels start..start+count-1 (ledmap already applied)
+void IRAM_ATTR WS2812FX::writeBusRange(uint16_t start, uint16_t count, const uint32_t *c)
+{
+  if (start >= _length) return;
+  if (count > _length - start) count = _length - start;
+#ifdef WLED_ENABLE_PIPELINED_OUTPUT
+  if (_outputBusy) waitForOutput();
+#endif
+  if (_layerMode != SEG_BLEND_NORMAL || _layerAlpha < 255) { // compositing a layered segment: blend with pixels below
+    uint32_t below[32];
+    for (unsigned k = 0; k < count; k += 32) {
+      unsigned m = MIN(32U, count - k);
+      for (unsigned j = 0; j < m; j++) below[j] = busses.getPixelColor(start + k + j);
+      color_layer_n(below, c + k, m, _layerMode, _layerAlpha);
+      busses.setPixelColors(start + k, m, below);
+    }
+    return;
+  }
+  busses.setPixelColors(start, count, c);
+}
+
+uint32_t WLED_HOT(WS2812FX_getPixelColor) WS2812FX::getPixelColor(uint16_t i)
+{
+  i = getMappedPixelIndex(i);
   if (i >= _length) return 0;
+#ifdef WLED_ENABLE_PIPELINED_OUTPUT
+  if (_outputBusy) waitForOutput();
+#endif
   return busses.getPixelColor(i);
 }
 
@@ -1260,98 +2143,354 @@ uint32_t WS2812FX::getPixelColor(uint16_t i)
 #define MA_FOR_ESP        100 //how much mA does the ESP use (Wemos D1 about 80mA, ESP32 about 120mA)
                               //you can set it to 0 if the ESP is powered by USB and the LEDs by external
 
-uint8_t WS2812FX::estimateCurrentAndLimitBri() {
+// scales brightness down so that estimated current (at full brightness) stays within budget
+static uint8_t limitBri(uint8_t bri, size_t powerSum, size_t powerBudget) {
+  if (powerSum * bri / 255 <= powerBudget) return bri;
+  float scale = (float)(powerBudget * 255) / (float)(powerSum * bri);
+  uint16_t scaleI = scale * 255;
+  uint8_t scaleB = (scaleI > 255) ? 255 : scaleI;
+  return scale8(bri, scaleB) + 1;
+}
+
+// estimate is quantized (and based on lossy restored colors for busses not tracking power), so ignore a single step
+// increase while limiting to avoid repainting every frame (a decrease is always applied to stay within power budget)
+static void setLimitedBri(Bus *bus, uint8_t newBri, uint8_t fullBri) {
+  uint8_t busBri = bus->getBrightness();
+  if (newBri < fullBri && newBri > busBri && newBri - busBri < 2) return;
+  bus->setBrightness(newBri); // "repaints" all pixels if brightness changed
+}
+
+// sets (limited) brightness of each bus, the only place output brightness is chosen while ABL is enabled
+// a power domain is either a bus with its own power supply (PSU limit in LED settings) or all other busses sharing ablMilliampsMax
+void WS2812FX::estimateCurrentAndLimitBri() {
   //power limit calculation
   //each LED can draw up 195075 "power units" (approx. 53mA)
   //one PU is the power it takes to have 1 channel 1 step brighter per brightness step
   //so A=2,R=255,G=0,B=0 would use 510 PU per LED (1mA is about 3700 PU)
-  bool useWackyWS2815PowerModel = false;
   byte actualMilliampsPerLed = milliampsPerLed;
 
   if (ablMilliampsMax < 150 || actualMilliampsPerLed == 0) { //0 mA per LED and too low numbers turn off calculation
     currentMilliamps = 0;
-    return _brightness;
+    busses.setBrightness(_brightness);
+    return;
   }
 
   if (milliampsPerLed == 255) {
-    useWackyWS2815PowerModel = true;
     actualMilliampsPerLed = 12; // from testing an actual strip
   }
+  Bus::setPowerModelMaxRGB(milliampsPerLed == 255); //ignore white component on WS2815 power calculation
 
-  size_t powerBudget = (ablMilliampsMax - MA_FOR_ESP); //100mA for ESP power
-
+  // pass 1: current (at full brightness) of each digital bus, shared ones summed up
+  uint32_t busCurrent[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES];
   size_t pLen = 0; //getLengthPhysical();
   size_t powerSum = 0;
   for (uint_fast8_t bNum = 0; bNum < busses.getNumBusses(); bNum++) {
     Bus *bus = busses.getBus(bNum);
+    busCurrent[bNum] = 0;
     if (!IS_DIGITAL(bus->getType())) continue; //exclude non-digital network busses
-    uint16_t len = bus->getLength();
-    pLen += len;
-    uint32_t busPowerSum = 0;
-    for (uint_fast16_t i = 0; i < len; i++) { //sum up the usage of each LED
-      uint32_t c = bus->getPixelColor(i); // always returns original or restored color without brightness scaling
-      byte r = R(c), g = G(c), b = B(c), w = W(c);
-
-      if(useWackyWS2815PowerModel) { //ignore white component on WS2815 power calculation
-        busPowerSum += (MAX(MAX(r,g),b)) * 3;
-      } else {
-        busPowerSum += (r + g + b + w);
-      }
-    }
+    uint32_t busPowerSum = bus->getPowerUnits(); // maintained as pixels are written (original colors without brightness scaling)
 
     if (bus->hasWhite()) { //RGBW led total output with white LEDs enabled is still 50mA, so each channel uses less
       busPowerSum *= 3;
       busPowerSum >>= 2; //same as /= 4
     }
-    powerSum += busPowerSum;
+    // busPowerSum has all the values of channels summed (max would be len*765 as white is excluded) so convert to milliAmps
+    busCurrent[bNum] = (busPowerSum * actualMilliampsPerLed) / 765;
+    if (bus->getMaxCurrent()) continue; // bus has its own power supply
+    pLen += bus->getLength();
+    powerSum += busCurrent[bNum];
   }
 
-  if (powerBudget > pLen) { //each LED uses about 1mA in standby, exclude that from power budget
-    powerBudget -= pLen;
-  } else {
-    powerBudget = 0;
-  }
-
-  // powerSum has all the values of channels summed (max would be pLen*765 as white is excluded) so convert to milliAmps
-  powerSum = (powerSum * actualMilliampsPerLed) / 765;
+  size_t powerBudget = (ablMilliampsMax - MA_FOR_ESP); //100mA for ESP power
+  powerBudget = powerBudget > pLen ? powerBudget - pLen : 0; //each LED uses about 1mA in standby, exclude that from power budget
+  const uint8_t sharedBri = limitBri(_brightness, powerSum, powerBudget);
 
-  uint8_t newBri = _brightness;
-  if (powerSum * _brightness / 255 > powerBudget) { //scale brightness down to stay in current limit
-    float scale = (float)(powerBudget * 255) / (float)(powerSum * _brightness);
-    uint16_t scaleI = scale * 255;
-    uint8_t scaleB = (scaleI > 255) ? 255 : scaleI;
-    newBri = scale8(_brightness, scaleB) + 1;
+  // pass 2: brightness of each bus, limited by the budget of its power domain
+  size_t current = MA_FOR_ESP + pLen + (powerSum * sharedBri) / 255; //ESP and standby power (1mA/LED) are part of estimate
+  for (uint_fast8_t bNum = 0; bNum < busses.getNumBusses(); bNum++) {
+    Bus *bus = busses.getBus(bNum);
+    if (!IS_DIGITAL(bus->getType())) { bus->setBrightness(sharedBri); continue; }
+    uint16_t busBudget = bus->getMaxCurrent();
+    if (!busBudget) { setLimitedBri(bus, sharedBri, _brightness); continue; }
+    uint16_t len = bus->getLength();
+    busBudget = busBudget > len ? busBudget - len : 0;
+    setLimitedBri(bus, limitBri(_brightness, busCurrent[bNum], busBudget), _brightness);
+    current += (busCurrent[bNum] * bus->getBrightness()) / 255 + len;
   }
-  currentMilliamps = (powerSum * newBri) / 255;
-  currentMilliamps += MA_FOR_ESP; //add power of ESP back to estimate
-  currentMilliamps += pLen; //add standby power (1mA/LED) back to estimate
-  return newBri;
+  currentMilliamps = current;
 }
 
 void WS2812FX::show(void) {
+#ifdef WLED_ENABLE_PIPELINED_OUTPUT
+  uint32_t waitStart = micros();
+#endif
+  waitForOutput(); // previous frame must be sent before overlays are drawn
+
   // avoid race condition, capture _callback value
   show_callback callback = _callback;
   if (callback) callback();
+  if (_overlayLen) compositeOverlay();
+
+#ifdef WLED_ENABLE_PIPELINED_OUTPUT
+  if (_outputTask) {
+    // hand the frame over to output task; effects for next frame are calculated while this one is sent
+    _waitStats.add(micros() - waitStart); // loop() only ever waits here, waiting for busses happens in output task
+    _outputBusy = true;
+    xTaskNotifyGive(_outputTask);
+    return;
+  }
+#endif
+  showNow();
+}
 
-  uint8_t newBri = estimateCurrentAndLimitBri();
-  busses.setBrightness(newBri); // "repaints" all pixels if brightness changed
+void WS2812FX::showNow(void) {
+  estimateCurrentAndLimitBri(); // sets (limited) brightness of busses, "repaints" pixels of busses whose brightness changed
 
   // some buses send asynchronously and this method will return before
   // all of the data has been sent.
   // See https://github.com/Makuna/NeoPixelBus/wiki/ESP32-NeoMethods#neoesp32rmt-methods
-  busses.show();
+  uint32_t showStart = micros();
+  busses.show(); // returns once transfers are started, waits only for busses still sending previous frame
+  uint32_t wait = busses.getWaitTime();
+  _outStats.add(micros() - showStart - wait);
+  traceEvent(TRACE_SHOW, 0, 0, showStart, micros() - showStart);
+  #ifdef WLED_ENABLE_PIPELINED_OUTPUT
+  if (!_outputTask)
+  #endif
+  _waitStats.add(wait);
 
-  // restore bus brightness to its original value
-  // this is done right after show, so this is only OK if LED updates are completed before show() returns
-  // or async show has a separate buffer (ESP32 RMT and I2S are ok)
-  if (newBri < _brightness) busses.setBrightness(_brightness);
+  // busses keep limited brightness: next frame is rendered with it already applied (as pixels are written)
+  // and getPixelColor() restores colors using it, so no repaint back to full brightness is needed
 
-  unsigned long showNow = millis();
-  size_t diff = showNow - _lastShow;
+  unsigned long showTime = millis();
+  size_t diff = showTime - _lastShow;
   size_t fpsCurr = 200;
   if (diff > 0) fpsCurr = 1000 / diff;
   _cumulativeFps = (3 * _cumulativeFps + fpsCurr +2) >> 2;   // "+2" for proper rounding (2/4 = 0.5)
-  _lastShow = showNow;
+  _lastShow = showTime;
+  _frameCount++;
+}
+
+#ifdef WLED_ENABLE_PIPELINED_OUTPUT
+// output task runs on the core not used by loop() and sends frames handed over by show()
+void WS2812FX::outputTask(void *parameter) {
+  WS2812FX *fx = static_cast<WS2812FX*>(parameter);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // wait for next frame
+    fx->showNow();
+    fx->_outputBusy = false;
+    xSemaphoreGive(fx->_outputDone);
+  }
+}
+
+// may be called from any task; there may be more than one waiting task, hence short timeout
+void WS2812FX::waitForOutput(void) {
+  while (_outputBusy) xSemaphoreTake(_outputDone, 1);
+}
+#endif
+
+#ifdef WLED_ENABLE_PARALLEL_RENDER
+// render task runs on the core not used by loop() and helps rendering due segments while service() does the same
+void WS2812FX::renderTask(void *parameter) {
+  WS2812FX *fx = static_cast<WS2812FX*>(parameter);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // wait for next pass
+    fx->renderDue(false);
+    fx->_renderCtx[RENDER_CTX()].segIndex = 0;
+    fx->_renderCtx[RENDER_CTX()].rng = nullptr;
+    xSemaphoreGive(fx->_renderDone);
+  }
+}
+#endif
+
+static const uint16_t fxStatsBuckets[FX_STATS_BUCKETS-1] = {500, 1000, 2000, 5000, 10000};
+
+uint32_t WS2812FX::getStatsBucketLimit(uint8_t b) {
+  return b < FX_STATS_BUCKETS-1 ? fxStatsBuckets[b] : UINT32_MAX;
+}
+
+void EffectStats::add(uint32_t us) {
+  if (count == UINT16_MAX) { // keep statistics representative of recent behaviour
+    sum >>= 1;
+    count >>= 1;
+    for (unsigned b = 0; b < FX_STATS_BUCKETS; b++) hist[b] >>= 1;
+  }
+  uint16_t t = us > UINT16_MAX ? UINT16_MAX : us;
+  sum += t;
+  count++;
+  if (t < min) min = t;
+  if (t > max) max = t;
+  unsigned b = 0;
+  while (b < FX_STATS_BUCKETS-1 && t >= fxStatsBuckets[b]) b++;
+  hist[b]++;
+}
+
+// segment statistics are restarted if effect changes, a slot for an untracked effect replaces the least used one
+void WS2812FX::recordEffectTime(uint8_t segId, uint8_t fx, uint32_t us) {
+  RENDER_LOCK();
+  if (segId < MAX_NUM_SEGMENTS) {
+    if (_segStats[segId].id != fx) _segStats[segId].reset(fx);
+    _segStats[segId].add(us);
+  }
+  unsigned slot = 0;
+  for (unsigned i = 0; i < FX_STATS_SLOTS; i++) {
+    if (_fxStats[i].count && _fxStats[i].id == fx) { slot = i; break; }
+    if (_fxStats[i].count < _fxStats[slot].count) slot = i;
+  }
+  if (_fxStats[slot].id != fx || !_fxStats[slot].count) _fxStats[slot].reset(fx);
+  _fxStats[slot].add(us);
+  RENDER_UNLOCK();
+}
+
+void WS2812FX::resetEffectStats() {
+  for (unsigned i = 0; i < FX_STATS_SLOTS; i++) _fxStats[i].reset();
+  for (unsigned i = 0; i < MAX_NUM_SEGMENTS; i++) _segStats[i].reset();
+  _outStats.reset();
+  _waitStats.reset();
+}
+
+// on-device benchmark: each call measures one effect for _benchMs running it on all active segments (without output
+// to LEDs), segments get their original effects back once all effects were measured
+void WS2812FX::serviceBenchmark() {
+  if (_benchReq) { // (re)start
+    if (_benchFx == 255) {
+      _benchSegs = MIN(_segments.size(), size_t(MAX_NUM_SEGMENTS));
+      for (size_t i = 0; i < _benchSegs; i++) _benchSaved[i] = _segments[i].mode;
+    }
+    _benchMs = _benchReq;
+    _benchGolden = _benchGoldenReq;
+    _benchReq = 0;
+    if (!_bench) _bench = (bench_result_t*) malloc(_modeCount * sizeof(bench_result_t));
+    if (!_bench) { DEBUG_PRINTLN(F("Benchmark alloc error.")); _benchFx = 255; return; }
+    memset((void*)_bench, 0, _modeCount * sizeof(bench_result_t));
+    _benchFx = 0;
+    waitForOutput();
+    DEBUG_PRINTLN(F("Benchmark started."));
+  }
+
+  bench_result_t &res = _bench[_benchFx];
+  if (_benchGolden) {
+    if (strncmp_P("RSVD", getModeData(_benchFx), 4)) serviceGolden(_benchFx);
+  } else if (strncmp_P("RSVD", getModeData(_benchFx), 4)) {
+    for (segment &seg : _segments) {
+      if (!seg.isActive()) continue;
+      seg.stopTransition();
+      seg.mode = _benchFx;
+      seg.markForReset();
+      seg.resetIfRequired();
+      seg.updateGeometry();
+      seg.allocatePixels();
+      seg.selectPixelWriter();
+    }
+    uint32_t busy = 0;
+    uint32_t minHeap = ESP.getFreeHeap();
+    uint16_t maxData = 0;
+    _isServicing = true;
+    unsigned long start = millis();
+    do {
+      now = millis() + timebase;
+      unsigned long t0 = micros();
+      for (size_t i = 0; i < _segments.size() && i < MAX_NUM_SEGMENTS; i++) {
+        segment &seg = _segments[i];
+        if (!seg.isActive()) continue;
+        _renderCtx[RENDER_CTX()].segIndex = i;
+        _renderCtx[RENDER_CTX()].rng      = &seg.rng;
+        _renderCtx[RENDER_CTX()].vLength  = seg.virtualLength();
+        for (int c = 0; c < NUM_COLORS; c++) _renderCtx[RENDER_CTX()].colors[c] = gamma32(seg.currentColor(c));
+        seg.setCurrentPalette();
+        (*getModeFn(_benchFx))();
+        seg.call++;
+      }
+      busy += micros() - t0;
+      res.frames++;
+      maxData = MAX(maxData, Segment::getUsedSegmentData());
+      minHeap = MIN(minHeap, ESP.getFreeHeap());
+      yield();
+    } while (millis() - start < _benchMs && res.frames < UINT16_MAX);
+    _isServicing = false;
+    _renderCtx[RENDER_CTX()].segIndex = 0;
+    _renderCtx[RENDER_CTX()].rng = nullptr;
+    _renderCtx[RENDER_CTX()].vLength  = 0;
+    res.us   = busy / res.frames;
+    res.heap = minHeap;
+    res.data = maxData;
+  }
+
+  if (++_benchFx < _modeCount) return;
+  // done, restore effects
+  for (size_t i = 0; i < _segments.size() && i < _benchSegs; i++) {
+    _segments[i].mode = _benchSaved[i];
+    _segments[i].markForReset();
+  }
+  _benchFx = 255;
+  DEBUG_PRINTLN(F("Benchmark finished."));
+  trigger();
+}
+
+// golden run of one effect: all active segments start from a fixed random seed, cleared buffers and effect time 0,
+// effect time advances by one frame time per frame (effect calls follow the returned delays as in service());
+// segments are composited onto busses each frame (not shown) and the output is hashed (FNV-1a), so the hash covers
+// effect, segment mapping (grouping, mirroring, 1D expansion, ...) and compositing; a change in any of them changes it
+// effects using millis()/micros() or beat functions directly (i.e. not strip.now) do not render the same on each run
+#define GOLDEN_SEED 0x9E37U
+void WS2812FX::serviceGolden(uint8_t fx) {
+  bench_result_t &res = _bench[fx];
+  const uint32_t savedSeed = _rngSeed;
+  _rngSeed = GOLDEN_SEED;
+  for (segment &seg : _segments) {
+    if (!seg.isActive()) continue;
+    seg.stopTransition();
+    seg.mode = fx;
+    seg.markForReset();
+    seg.resetIfRequired();
+    seg.updateGeometry();
+    seg.allocatePixels();
+    seg.selectPixelWriter();
+    seg.setKeyframe(0, 0); // no interpolation between effect updates
+    seg.clear();
+  }
+  _rngSeed = savedSeed;
+  uint32_t hash = FNV1A_SEED;
+  uint32_t busy = 0;
+  uint32_t minHeap = ESP.getFreeHeap();
+  uint16_t maxData = 0;
+  _isServicing = true;
+  for (unsigned f = 0; f < _benchGolden; f++) {
+    const unsigned long t = f * _frametime;
+    now = t;
+    unsigned long t0 = micros();
+    for (size_t i = 0; i < _segments.size() && i < MAX_NUM_SEGMENTS; i++) {
+      segment &seg = _segments[i];
+      if (!seg.isActive() || t < seg.next_time) continue;
+      _renderCtx[RENDER_CTX()].segIndex = i;
+      _renderCtx[RENDER_CTX()].rng      = &seg.rng;
+      _renderCtx[RENDER_CTX()].vLength  = seg.virtualLength();
+      for (int c = 0; c < NUM_COLORS; c++) _renderCtx[RENDER_CTX()].colors[c] = gamma32(seg.currentColor(c));
+      seg.setCurrentPalette();
+      seg.next_time = t + (*getModeFn(fx))();
+      seg.call++;
+    }
+    busy += micros() - t0;
+    compositeSegments();
+    for (unsigned i = 0; i < _length; i++) {
+      const uint32_t c = busses.getPixelColor(i);
+      const uint8_t b[4] = { uint8_t(c), uint8_t(c >> 8), uint8_t(c >> 16), uint8_t(c >> 24) };
+      hash = fnv1a(b, sizeof(b), hash);
+    }
+    maxData = MAX(maxData, Segment::getUsedSegmentData());
+    minHeap = MIN(minHeap, ESP.getFreeHeap());
+    if ((f & 15) == 15) yield();
+  }
+  _isServicing = false;
+  _renderCtx[RENDER_CTX()].segIndex = 0;
+  _renderCtx[RENDER_CTX()].rng = nullptr;
+  _renderCtx[RENDER_CTX()].vLength  = 0;
+  now = millis() + timebase;
+  res.frames = _benchGolden;
+  res.us   = busy / _benchGolden;
+  res.heap = minHeap;
+  res.data = maxData;
+  res.hash = hash;
 }
 
 /**
@@ -1359,9 +2498,32 @@ void WS2812FX::show(void) {
  * On some hardware (ESP32), strip updates are done asynchronously.
  */
 bool WS2812FX::isUpdating() {
+#ifdef WLED_ENABLE_PIPELINED_OUTPUT
+  if (_outputBusy) return true;
+#endif
   return !busses.canAllShow();
 }
 
+/**
+ * Returns ms until the next segment is due for an effect update (0 if a frame is in progress or
+ * any segment is in transition or interpolating, i.e. needs output every frame).
+ * Used by idle power management.
+ */
+uint32_t WS2812FX::timeToNextRender() {
+  if (_triggered || _numDue) return 0;
+  unsigned long nowUp = millis();
+  uint32_t next = UINT32_MAX;
+  for (size_t i = 0; i < _segments.size() && i < MAX_NUM_SEGMENTS; i++) {
+    segment &seg = _segments[i];
+    if (!seg.isActive()) continue;
+    if (seg.isInTransition() || seg.isInterpolating(nowUp)) return 0;
+    long d = (long)(seg.next_time - nowUp);
+    if (d <= 0) return 0;
+    next = MIN(next, (uint32_t)d);
+  }
+  return next;
+}
+
 /**
  * Returns the refresh rate of the LED strip. Useful for finding out whether a given setup is fast enough.
  * Only updates on show() or is set to 0 fps if last show is more than 2 secs ago, so accuracy varies
@@ -1371,9 +2533,39 @@ uint16_t WS2812FX::getFps() {
   return _cumulativeFps +1;
 }
 
+// effect random numbers become reproducible (same seed, same streams), 0 returns to the seed chosen at boot
+void WS2812FX::setRandomSeed(uint32_t seed) {
+  _rngSeed = seed;
+  for (segment &seg : _segments) seg.markForReset();
+}
+
+// frame time follows target FPS unless busses cannot show frames that fast (rendering more would only wait for output)
 void WS2812FX::setTargetFps(uint8_t fps) {
   if (fps > 0 && fps <= 120) _targetFps = fps;
-  _frametime = 1000 / _targetFps;
+  uint16_t f = _targetFps;
+  if (_wireFps && _wireFps < f) f = _wireFps;
+  if (_fpsLimit && _fpsLimit < f) f = _fpsLimit;
+  _frametime = 1000 / f;
+}
+
+// caps frame rate without changing (saved) target FPS, 0 removes the cap
+void WS2812FX::setFpsLimit(uint8_t fps) {
+  _fpsLimit = fps;
+  setTargetFps(0);
+}
+
+// busses send in parallel, so the one needing most time per frame determines the achievable frame rate
+void WS2812FX::updateWireLimit(void) {
+  uint32_t wireUs = 0;
+  _wireBus = -1;
+  for (int i=0; i<busses.getNumBusses(); i++) {
+    Bus *bus = busses.getBus(i);
+    uint32_t t = bus ? bus->getWireTime() : 0;
+    if (t > wireUs) { wireUs = t; _wireBus = i; }
+  }
+  _wireFps = wireUs ? MAX(1, MIN(1000, 1000000 / wireUs)) : 0;
+  setTargetFps(0); // NOP for target, applies limit
+  DEBUG_PRINTF("Busses allow %u FPS (bus %d).\n", _wireFps, _wireBus);
 }
 
 void WS2812FX::setMode(uint8_t segid, uint8_t m) {
@@ -1405,26 +2597,40 @@ void WS2812FX::setCCT(uint16_t k) {
   }
 }
 
-// direct=true either expects the caller to call show() themselves (realtime modes) or be ok waiting for the next frame for the change to apply
-// direct=false immediately triggers an effect redraw
-void WS2812FX::setBrightness(uint8_t b, bool direct) {
-  if (gammaCorrectBri) b = gamma8(b);
-  if (_brightness == b) return;
+// stores new (gamma corrected) brightness, returns false if unchanged
+bool WS2812FX::storeBrightness(uint8_t b) {
+  if (gammaCorrectBri) b = NeoGammaWLEDMethod::rawGamma8(b); // brightness gamma is applied here also with WLED_ENABLE_OUTPUT_GAMMA
+  if (_brightness == b) return false;
   _brightness = b;
   if (_brightness == 0) { //unfreeze all segments on power off
     for (segment &seg : _segments) {
       seg.freeze = false;
     }
   }
+  return true;
+}
+
+// direct=true either expects the caller to call show() themselves (realtime modes) or be ok waiting for the next frame for the change to apply
+// direct=false immediately triggers an effect redraw
+void WS2812FX::setBrightness(uint8_t b, bool direct) {
+  if (!storeBrightness(b)) return;
   // setting brightness with NeoPixelBusLg has no effect on already painted pixels,
   // so we need to force an update to existing buffer
-  busses.setBrightness(b);
+  waitForOutput();
+  busses.setBrightness(_brightness);
+  _briDeferred = false;
   if (!direct) {
     unsigned long t = millis();
     if (_segments[0].next_time > t + 22 && t - _lastShow > MIN_SHOW_DELAY) trigger(); //apply brightness change immediately if no refresh soon
   }
 }
 
+// brightness of the frame about to be rendered (global brightness transition, called from service())
+// busses take it when the frame is composited, so pixels already painted need no repaint
+void WS2812FX::setFrameBrightness(uint8_t b) {
+  if (storeBrightness(b)) _briDeferred = true;
+}
+
 uint8_t WS2812FX::getActiveSegsLightCapabilities(bool selectedOnly) {
   uint8_t totalLC = 0;
   for (segment &seg : _segments) {
@@ -1468,7 +2674,7 @@ uint8_t WS2812FX::getActiveSegmentsNum(void) {
 }
 
 uint16_t WS2812FX::getLengthTotal(void) {
-  uint16_t len = Segment::maxWidth * Segment::maxHeight; // will be _length for 1D (see finalizeInit()) but should cover whole matrix for 2D
+  uint16_t len = Segment::matrixArea; // will be _length for 1D (see finalizeInit()) but should cover all canvases for 2D
   if (isMatrix && _length > len) len = _length; // for 2D with trailing strip
   return len;
 }
@@ -1512,14 +2718,16 @@ bool WS2812FX::hasCCTBus(void) {
 void WS2812FX::purgeSegments(bool force) {
   // remove all inactive segments (from the back)
   int deleted = 0;
-  if (_segments.size() <= 1) return;
+  if (_segments.size() <= 1 || isRendering()) return; // frame in progress refers to segments by index
   for (size_t i = _segments.size()-1; i > 0; i--)
     if (_segments[i].stop == 0 || force) {
       deleted++;
       _segments.erase(_segments.begin() + i);
     }
   if (deleted) {
-    _segments.shrink_to_fit();
+    #ifndef ARDUINO_ARCH_ESP32
+    _segments.shrink_to_fit(); // ESP32 keeps storage reserved
+    #endif
     /*if (_mainSegment >= _segments.size())*/ setMainSegmentId(0);
   }
 }
@@ -1529,7 +2737,7 @@ Segment& WS2812FX::getSegment(uint8_t id) {
 }
 
 // sets new segment bounds, queues if that segment is currently running
-void WS2812FX::setSegment(uint8_t segId, uint16_t i1, uint16_t i2, uint8_t grouping, uint8_t spacing, uint16_t offset, uint16_t startY, uint16_t stopY) {
+void WS2812FX::setSegment(uint8_t segId, uint16_t i1, uint16_t i2, uint8_t grouping, uint8_t spacing, uint16_t offset, uint16_t startY, uint16_t stopY, uint8_t canvas) {
   if (segId >= getSegmentsNum()) {
     if (i2 <= i1) return; // do not append empty/inactive segments
     appendSegment(Segment(0, strip.getLengthTotal()));
@@ -1538,23 +2746,25 @@ void WS2812FX::setSegment(uint8_t segId, uint16_t i1, uint16_t i2, uint8_t group
 
   if (_queuedChangesSegId == segId) _queuedChangesSegId = 255; // cancel queued change if already queued for this segment
 
-  if (segId < getMaxSegments() && segId == getCurrSegmentId() && isServicing()) { // queue change to prevent concurrent access
+  bool inUse = false; // segment may be rendered by loop() or render task
+  for (unsigned c = 0; c < WLED_RENDER_CTX; c++) inUse |= segId == _renderCtx[c].segIndex;
+  if (segId < getMaxSegments() && inUse && isServicing()) { // queue change to prevent concurrent access
     // queuing a change for a second segment will lead to the loss of the first change if not yet applied
     // however this is not a problem as the queued change is applied immediately after the effect function in that segment returns
     _qStart  = i1; _qStop   = i2; _qStartY = startY; _qStopY  = stopY;
-    _qGrouping = grouping; _qSpacing  = spacing; _qOffset   = offset;
+    _qGrouping = grouping; _qSpacing  = spacing; _qOffset   = offset; _qCanvas = canvas;
     _queuedChangesSegId = segId;
     DEBUG_PRINT(F("Segment queued: ")); DEBUG_PRINTLN(segId);
     return; // queued changes are applied immediately after effect function returns
   }
   
-  _segments[segId].setUp(i1, i2, grouping, spacing, offset, startY, stopY);
+  _segments[segId].setUp(i1, i2, grouping, spacing, offset, startY, stopY, canvas);
   if (segId > 0 && segId == getSegmentsNum()-1 && i2 <= i1) _segments.pop_back(); // if last segment was deleted remove it from vector
 }
 
 void WS2812FX::setUpSegmentFromQueuedChanges() {
   if (_queuedChangesSegId >= getSegmentsNum()) return;
-  getSegment(_queuedChangesSegId).setUp(_qStart, _qStop, _qGrouping, _qSpacing, _qOffset, _qStartY, _qStopY);
+  getSegment(_queuedChangesSegId).setUp(_qStart, _qStop, _qGrouping, _qSpacing, _qOffset, _qStartY, _qStopY, _qCanvas);
   _queuedChangesSegId = 255;
 }
 
@@ -1565,14 +2775,24 @@ void WS2812FX::restartRuntime() {
 void WS2812FX::resetSegments() {
   _segments.clear(); // destructs all Segment as part of clearing
   #ifndef WLED_DISABLE_2D
-  segment seg = isMatrix ? Segment(0, Segment::maxWidth, 0, Segment::maxHeight) : Segment(0, _length);
-  #else
-  segment seg = Segment(0, _length);
+  if (isMatrix) appendCanvasSegments();
+  else
   #endif
-  _segments.push_back(seg);
+    _segments.emplace_back(0, _length);
   _mainSegment = 0;
 }
 
+#ifndef WLED_DISABLE_2D
+// one segment covering each canvas
+void WS2812FX::appendCanvasSegments() {
+  for (size_t c = 0; c < canvas.size() && _segments.size() < getMaxSegments(); c++) {
+    _segments.emplace_back(0, canvas[c].width, 0, canvas[c].height);
+    _segments.back().canvasIdx = c;
+  }
+  if (_segments.empty()) _segments.emplace_back(0, Segment::maxWidth, 0, Segment::maxHeight);
+}
+#endif
+
 void WS2812FX::makeAutoSegments(bool forceReset) {
   if (autoSegments) { //make one segment per bus
     uint16_t segStarts[MAX_NUM_SEGMENTS] = {0};
@@ -1580,10 +2800,10 @@ void WS2812FX::makeAutoSegments(bool forceReset) {
     size_t s = 0;
 
     #ifndef WLED_DISABLE_2D
-    // 2D segment is the 1st one using entire matrix
+    // 2D segment is the 1st one using all canvases (one segment per canvas is created below)
     if (isMatrix) {
       segStarts[0] = 0;
-      segStops[0]  = Segment::maxWidth*Segment::maxHeight;
+      segStops[0]  = Segment::matrixArea;
       s++;
     }
     #endif
@@ -1595,8 +2815,8 @@ void WS2812FX::makeAutoSegments(bool forceReset) {
       segStops[s]  = segStarts[s] + b->getLength();
 
       #ifndef WLED_DISABLE_2D
-      if (isMatrix && segStops[s] < Segment::maxWidth*Segment::maxHeight) continue; // ignore buses comprising matrix
-      if (isMatrix && segStarts[s] < Segment::maxWidth*Segment::maxHeight) segStarts[s] = Segment::maxWidth*Segment::maxHeight;
+      if (isMatrix && segStops[s] < Segment::matrixArea) continue; // ignore buses comprising matrix
+      if (isMatrix && segStarts[s] < Segment::matrixArea) segStarts[s] = Segment::matrixArea;
       #endif
 
       //check for overlap with previous segments
@@ -1616,12 +2836,12 @@ void WS2812FX::makeAutoSegments(bool forceReset) {
     // there is always at least one segment (but we need to differentiate between 1D and 2D)
     #ifndef WLED_DISABLE_2D
     if (isMatrix)
-      _segments.push_back(Segment(0, Segment::maxWidth, 0, Segment::maxHeight));
+      appendCanvasSegments();
     else
     #endif
-      _segments.push_back(Segment(segStarts[0], segStops[0]));
-    for (size_t i = 1; i < s; i++) {
-      _segments.push_back(Segment(segStarts[i], segStops[i]));
+      _segments.emplace_back(segStarts[0], segStops[0]);
+    for (size_t i = 1; i < s && _segments.size() < getMaxSegments(); i++) {
+      _segments.emplace_back(segStarts[i], segStops[i]);
     }
 
   } else {
@@ -1631,10 +2851,11 @@ void WS2812FX::makeAutoSegments(bool forceReset) {
     else if (getActiveSegmentsNum() == 1) {
       size_t i = getLastActiveSegmentId();
       #ifndef WLED_DISABLE_2D
+      const Canvas c = getCanvas(_segments[i].canvasIdx);
       _segments[i].start  = 0;
-      _segments[i].stop   = Segment::maxWidth;
+      _segments[i].stop   = c.width;
       _segments[i].startY = 0;
-      _segments[i].stopY  = Segment::maxHeight;
+      _segments[i].stopY  = c.height;
       _segments[i].grouping = 1;
       _segments[i].spacing  = 0;
       #else
@@ -1653,15 +2874,17 @@ void WS2812FX::fixInvalidSegments() {
   for (size_t i = getSegmentsNum()-1; i > 0; i--) {
     if (isMatrix) {
     #ifndef WLED_DISABLE_2D
-      if (_segments[i].start >= Segment::maxWidth * Segment::maxHeight) {
+      if (_segments[i].start >= Segment::matrixArea) {
         // 1D segment at the end of matrix
         if (_segments[i].start >= _length || _segments[i].startY > 0 || _segments[i].stopY > 1) { _segments.erase(_segments.begin()+i); continue; }
         if (_segments[i].stop  >  _length) _segments[i].stop = _length;
         continue;
       }
-      if (_segments[i].start >= Segment::maxWidth || _segments[i].startY >= Segment::maxHeight) { _segments.erase(_segments.begin()+i); continue; }
-      if (_segments[i].stop  >  Segment::maxWidth)  _segments[i].stop  = Segment::maxWidth;
-      if (_segments[i].stopY >  Segment::maxHeight) _segments[i].stopY = Segment::maxHeight;
+      if (_segments[i].canvasIdx >= canvas.size()) { _segments.erase(_segments.begin()+i); continue; } // canvas was removed
+      const Canvas c = canvas[_segments[i].canvasIdx];
+      if (_segments[i].start >= c.width || _segments[i].startY >= c.height) { _segments.erase(_segments.begin()+i); continue; }
+      if (_segments[i].stop  >  c.width)  _segments[i].stop  = c.width;
+      if (_segments[i].stopY >  c.height) _segments[i].stopY = c.height;
     #endif
     } else {
       if (_segments[i].start >= _length) { _segments.erase(_segments.begin()+i); continue; }
@@ -1669,8 +2892,10 @@ void WS2812FX::fixInvalidSegments() {
     }
   }
   // this is always called as the last step after finalizeInit(), update covered bus types
-  for (segment &seg : _segments)
+  for (segment &seg : _segments) {
+    seg.updateGeometry();
     seg.refreshLightCapabilities();
+  }
 }
 
 //true if all segments align with a bus, or if a segment covers the total length
@@ -1690,12 +2915,13 @@ bool WS2812FX::checkSegmentAlignment() {
 
 //After this function is called, setPixelColor() will use that segment (offsets, grouping, ... will apply)
 //Note: If called in an interrupt (e.g. JSON API), original segment must be restored,
-//otherwise it can lead to a crash on ESP32 because _segment_index is modified while in use by the main thread
+//otherwise it can lead to a crash on ESP32 because the segment index is modified while in use by the main thread
 uint8_t WS2812FX::setPixelSegment(uint8_t n) {
-  uint8_t prevSegId = _segment_index;
+  auto &ctx = _renderCtx[RENDER_CTX()];
+  uint8_t prevSegId = ctx.segIndex;
   if (n < _segments.size()) {
-    _segment_index = n;
-    _virtualSegmentLength = _segments[_segment_index].virtualLength();
+    ctx.segIndex = n;
+    ctx.vLength  = _segments[n].virtualLength();
   }
   return prevSegId;
 }
@@ -1705,6 +2931,66 @@ void WS2812FX::setRange(uint16_t i, uint16_t i2, uint32_t col) {
   for (unsigned x = i; x <= i2; x++) setPixelColor(x, col);
 }
 
+// adds (or replaces) pixel i of owner in the overlay layer
+void WS2812FX::setOverlayPixel(uint16_t i, uint32_t c, uint8_t alpha, uint8_t owner) {
+  if (i >= getLengthTotal() || !alpha) return;
+  for (int n = _overlayLen - 1; n >= 0; n--) {
+    if (_overlay[n].idx != i || _overlay[n].owner != owner) continue;
+    _overlay[n].color = c;
+    _overlay[n].alpha = alpha;
+    return;
+  }
+  if (_overlayLen == _overlayCap) { // grow by doubling, at most one entry per pixel and owner is useful
+    uint16_t cap = MIN(MAX(2 * _overlayCap, 16), 2 * getLengthTotal());
+    if (cap <= _overlayCap) return;
+    overlay_px_t *o = (overlay_px_t*) heapMalloc(HEAP_TAG_PIXELS, cap * sizeof(overlay_px_t));
+    if (!o) return;
+    if (_overlay) memcpy(o, _overlay, _overlayLen * sizeof(overlay_px_t));
+    heapFree(HEAP_TAG_PIXELS, _overlay, _overlayCap * sizeof(overlay_px_t));
+    _overlay = o;
+    _overlayCap = cap;
+  }
+  overlay_px_t &p = _overlay[_overlayLen++];
+  p.idx   = i;
+  p.owner = owner;
+  p.alpha = alpha;
+  p.color = c;
+  p.under = 0;
+  p.shown = ~c; // forces reading the frame color on first use
+}
+
+void WS2812FX::setOverlayRange(uint16_t i, uint16_t i2, uint32_t c, uint8_t alpha, uint8_t owner) {
+  if (i2 < i) std::swap(i,i2);
+  for (unsigned x = i; x <= i2; x++) setOverlayPixel(x, c, alpha, owner);
+}
+
+void WS2812FX::clearOverlay(uint8_t owner) {
+  if (owner == 255) {
+    heapFree(HEAP_TAG_PIXELS, _overlay, _overlayCap * sizeof(overlay_px_t));
+    _overlay = nullptr;
+    _overlayLen = _overlayCap = 0;
+    return;
+  }
+  uint16_t n = 0;
+  for (unsigned j = 0; j < _overlayLen; j++) if (_overlay[j].owner != owner) _overlay[n++] = _overlay[j];
+  _overlayLen = n;
+}
+
+// draws the overlay layer over the frame in bus buffers (called for each shown frame)
+void WS2812FX::compositeOverlay(void) {
+  for (unsigned n = 0; n < _overlayLen; n++) {
+    overlay_px_t &p = _overlay[n];
+    uint16_t i = getMappedPixelIndex(p.idx);
+    if (i >= _length) continue;
+    if (p.alpha == 255) { busses.setPixelColor(i, p.color); continue; }
+    // translucent: blend over the frame, or over the color it had if the frame was shown again without rendering
+    uint32_t cur = busses.getPixelColor(i);
+    if (cur != p.shown) p.under = cur;
+    busses.setPixelColor(i, color_blend(p.under, p.color, p.alpha));
+    p.shown = busses.getPixelColor(i);
+  }
+}
+
 void WS2812FX::setTransitionMode(bool t) {
   for (segment &seg : _segments) seg.startTransition(t ? _transitionDur : 0);
 }
@@ -1714,19 +3000,86 @@ void WS2812FX::printSize() {
   size_t size = 0;
   for (const Segment &seg : _segments) size += seg.getSize();
   DEBUG_PRINTF("Segments: %d -> %uB\n", _segments.size(), size);
-  DEBUG_PRINTF("Modes: %d*%d=%uB\n", sizeof(mode_ptr), _mode.size(), (_mode.capacity()*sizeof(mode_ptr)));
-  DEBUG_PRINTF("Data: %d*%d=%uB\n", sizeof(const char *), _modeData.size(), (_modeData.capacity()*sizeof(const char *)));
-  DEBUG_PRINTF("Map: %d*%d=%uB\n", sizeof(uint16_t), (int)customMappingSize, customMappingSize*sizeof(uint16_t));
+  DEBUG_PRINTF("Modes: %d (%d added) %d*%d=%uB\n", _modeCount, _modeExt.size(), sizeof(mode_data_t), _modeExt.size(), (_modeExt.capacity()*sizeof(mode_data_t)));
+  if (_mapRuns) DEBUG_PRINTF("Map: %d*%d=%uB (%d pixels)\n", sizeof(map_run_t), (int)_mapRunCount, _mapRunCount*sizeof(map_run_t), (int)customMappingSize);
+  else DEBUG_PRINTF("Map: %d*%d=%uB\n", sizeof(uint16_t), (int)customMappingSize, customMappingSize*sizeof(uint16_t));
   size = getLengthTotal();
-  if (useGlobalLedBuffer) DEBUG_PRINTF("Buffer: %d*%u=%uB\n", sizeof(CRGB), size, size*sizeof(CRGB));
+  if (useGlobalLedBuffer) DEBUG_PRINTF("Buffer: %d*%u=%uB\n", _hasWhiteChannel ? 4 : 3, size, size*(_hasWhiteChannel ? 4 : 3)); // bus buffers (upper bound)
 }
 #endif
 
-void WS2812FX::loadCustomPalettes() {
+/*
+ * Binary cache of parsed custom palettes, so palette JSON files need not be parsed on every boot:
+ * 'W','P','L',version, uint8 number of palettes, uint32 hash of the source files (index and size),
+ * followed by 16 RGB entries (48 bytes) per palette. Rewritten whenever the palette files are parsed.
+ */
+#define PAL_CACHE_VERSION 1
+#define PAL_CACHE_HEADER  9
+static const char s_palCacheFile[] PROGMEM = "/palettes.bin";
+
+static uint32_t customPaletteSourceHash() {
+  uint32_t h = FNV1A_SEED;
+  for (int index = 0; index < WLED_MAX_CUSTOM_PALETTES; index++) {
+    char fileName[32];
+    sprintf_P(fileName, PSTR("/palette%d.json"), index);
+    File f = WLED_FS.open(fileName, "r");
+    if (!f) break;
+    uint32_t size = f.size();
+    f.close();
+    const uint8_t i8 = index;
+    h = fnv1a(&size, sizeof(size), fnv1a(&i8, 1, h));
+  }
+  return h;
+}
+
+bool WS2812FX::loadPaletteCache(uint32_t srcHash) {
+  char fileName[16];
+  strcpy_P(fileName, s_palCacheFile);
+  File f = WLED_FS.open(fileName, "r");
+  if (!f) return false;
+  uint8_t hdr[PAL_CACHE_HEADER];
+  bool ok = f.read(hdr, PAL_CACHE_HEADER) == PAL_CACHE_HEADER && hdr[0] == 'W' && hdr[1] == 'P' && hdr[2] == 'L' && hdr[3] == PAL_CACHE_VERSION
+         && hdr[4] <= WLED_MAX_CUSTOM_PALETTES && (hdr[5] | (hdr[6] << 8) | (hdr[7] << 16) | ((uint32_t)hdr[8] << 24)) == srcHash
+         && f.size() == PAL_CACHE_HEADER + hdr[4] * 48U;
+  uint8_t buf[48];
+  for (size_t p = 0; ok && p < hdr[4]; p++) {
+    if (f.read(buf, sizeof(buf)) != sizeof(buf)) { ok = false; break; }
+    CRGBPalette16 pal;
+    for (size_t i = 0; i < 16; i++) pal[i] = CRGB(buf[3*i], buf[3*i+1], buf[3*i+2]);
+    customPalettes.push_back(pal);
+  }
+  f.close();
+  if (!ok) customPalettes.clear();
+  DEBUG_PRINTF("Custom palettes from cache: %s\n", ok ? "yes" : "no");
+  return ok;
+}
+
+void WS2812FX::savePaletteCache(uint32_t srcHash) {
+  char fileName[16];
+  strcpy_P(fileName, s_palCacheFile);
+  if (customPalettes.empty()) { WLED_FS.remove(fileName); return; }
+  File f = WLED_FS.open(fileName, "w");
+  if (!f) return;
+  uint8_t hdr[PAL_CACHE_HEADER] = {'W', 'P', 'L', PAL_CACHE_VERSION, (uint8_t)customPalettes.size(),
+                                   uint8_t(srcHash), uint8_t(srcHash >> 8), uint8_t(srcHash >> 16), uint8_t(srcHash >> 24)};
+  f.write(hdr, PAL_CACHE_HEADER);
+  uint8_t buf[48];
+  for (const CRGBPalette16 &pal : customPalettes) {
+    for (size_t i = 0; i < 16; i++) { buf[3*i] = pal[i].r; buf[3*i+1] = pal[i].g; buf[3*i+2] = pal[i].b; }
+    f.write(buf, sizeof(buf));
+  }
+  f.close();
+}
+
+// reparse: ignore the binary cache (palette files were changed)
+void WS2812FX::loadCustomPalettes(bool reparse) {
   byte tcp[72]; //support gradient palettes with up to 18 entries
   CRGBPalette16 targetPalette;
   customPalettes.clear(); // start fresh
-  for (int index = 0; index<10; index++) {
+  Segment::invalidatePalettes();
+  uint32_t srcHash = customPaletteSourceHash();
+  if (!reparse && loadPaletteCache(srcHash)) return;
+  for (int index = 0; index<WLED_MAX_CUSTOM_PALETTES; index++) {
     char fileName[32];
     sprintf_P(fileName, PSTR("/palette%d.json"), index);
 
@@ -1769,12 +3122,122 @@ void WS2812FX::loadCustomPalettes() {
       break;
     }
   }
+  savePaletteCache(srcHash);
 }
 
 //load custom mapping table from JSON file (called from finalizeInit() or deserializeState())
+// reads mapping data of binary ledmap in chunks directly into mapping table (no JSON buffer needed)
+static bool readLedmapBin(File &f, uint16_t *table, uint16_t count, bool rle) {
+  if (!rle) { // stored as-is (little endian like ESP)
+    size_t len = count * sizeof(uint16_t);
+    for (size_t pos = 0; pos < len; ) {
+      size_t r = f.read((uint8_t*)table + pos, MIN(len - pos, size_t(512)));
+      if (r == 0) return false;
+      pos += r;
+    }
+    return true;
+  }
+  // runs are long (rows/columns of panels) so records are few
+  unsigned i = 0;
+  while (i < count) {
+    uint8_t rec[4];
+    if (f.read(rec, sizeof(rec)) != sizeof(rec)) return false;
+    uint16_t value = rec[0] | (rec[1] << 8);
+    uint16_t run   = rec[2] | (rec[3] << 8);
+    int step = (run >> 14) == 1 ? 1 : (run >> 14) == 2 ? -1 : 0;
+    for (unsigned j = run & 0x3FFF; j > 0 && i < count; j--, value += step) table[i++] = value;
+  }
+  return true;
+}
+
+void WS2812FX::freeMapping() {
+  customMappingSize = 0;
+  free(customMappingTable);
+  customMappingTable = nullptr;
+  free(_mapRuns);
+  _mapRuns = nullptr;
+  _mapRunCount = _mapRunHit = 0;
+}
+
+// end of the run starting at i (step of the run is returned in step)
+static unsigned mapRunEnd(const uint16_t *t, unsigned size, unsigned i, int &step) {
+  step = 0;
+  if (i + 1 >= size) return i + 1;
+  int d = (int)t[i+1] - t[i];
+  if (d < INT16_MIN || d > INT16_MAX) return i + 1; // e.g. pixel next to a gap
+  step = d;
+  unsigned j = i + 2;
+  while (j < size && (int)t[j] - t[j-1] == step) j++;
+  return j;
+}
+
+// ledmaps are mostly made of sequential runs (rows of serpentine panels, offsets), if runs take less memory than
+// the dense table they replace it (lookup has to find the run, but consecutive pixels hit the same one)
+void WS2812FX::compactMapping() {
+  if (!customMappingTable || !customMappingSize) return;
+  unsigned runs = 0;
+  int step;
+  for (unsigned i = 0; i < customMappingSize; runs++) i = mapRunEnd(customMappingTable, customMappingSize, i, step);
+  if (runs * sizeof(map_run_t) >= customMappingSize * sizeof(uint16_t)) return;
+  map_run_t *r = (map_run_t*) callocLarge(runs, sizeof(map_run_t));
+  if (!r) return;
+  unsigned n = 0;
+  for (unsigned i = 0; i < customMappingSize; n++) {
+    unsigned j = mapRunEnd(customMappingTable, customMappingSize, i, step);
+    r[n].start = i;
+    r[n].len   = j - i;
+    r[n].value = customMappingTable[i];
+    r[n].step  = step;
+    i = j;
+  }
+  DEBUG_PRINTF("Ledmap compressed to %u runs (%uB).\n", n, n * sizeof(map_run_t));
+  free(customMappingTable);
+  customMappingTable = nullptr;
+  _mapRuns = r;
+  _mapRunCount = n;
+  _mapRunHit = 0;
+}
+
+// i < customMappingSize, runs cover all mapped pixels in ascending order
+uint16_t IRAM_ATTR WS2812FX::mapRunIndex(uint16_t i) {
+  const map_run_t *r = &_mapRuns[_mapRunHit];
+  if (i < r->start || i >= r->start + r->len) {
+    unsigned lo = 0, hi = _mapRunCount - 1;
+    while (lo < hi) {
+      unsigned mid = (lo + hi + 1) / 2;
+      if (_mapRuns[mid].start <= i) lo = mid; else hi = mid - 1;
+    }
+    _mapRunHit = lo;
+    r = &_mapRuns[lo];
+  }
+  return r->value + (int)(i - r->start) * r->step;
+}
+
 bool WS2812FX::deserializeMap(uint8_t n) {
   // 2D support creates its own ledmap (on the fly) if a ledmap.json exists it will overwrite built one.
 
+  // binary ledmap is preferred, it is streamed into mapping table
+  File f;
+  uint16_t count;
+  bool rle;
+  if (openLedmapBin(n, f, count, rle)) {
+    DEBUG_PRINT(F("Reading binary LED map ")); DEBUG_PRINTLN(n);
+    freeMapping();
+    if (count) {
+      customMappingTable = (uint16_t*) callocLarge(count, sizeof(uint16_t)); // PSRAM for large canvases
+      if (customMappingTable && readLedmapBin(f, customMappingTable, count, rle)) {
+        customMappingSize = count;
+        compactMapping();
+      } else {
+        DEBUG_PRINTLN(F("Binary ledmap could not be read."));
+        free(customMappingTable);
+        customMappingTable = nullptr;
+      }
+    }
+    f.close();
+    return customMappingSize;
+  }
+
   char fileName[32];
   strcpy_P(fileName, PSTR("/ledmap"));
   if (n) sprintf(fileName +7, "%d", n);
@@ -1783,15 +3246,11 @@ bool WS2812FX::deserializeMap(uint8_t n) {
 
   if (!isFile) {
     // erase custom mapping if selecting nonexistent ledmap.json (n==0)
-    if (!isMatrix && !n && customMappingTable != nullptr) {
-      customMappingSize = 0;
-      delete[] customMappingTable;
-      customMappingTable = nullptr;
-    }
+    if (!isMatrix && !n) freeMapping();
     return false;
   }
 
-  if (!requestJSONBufferLock(7)) return false;
+  if (!requestJSONBufferLock(JSON_LOCK_LEDMAP)) return false;
 
   if (!readObjectFromFile(fileName, nullptr, &doc)) {
     releaseJSONBufferLock();
@@ -1802,19 +3261,17 @@ bool WS2812FX::deserializeMap(uint8_t n) {
   DEBUG_PRINTLN(fileName);
 
   // erase old custom ledmap
-  if (customMappingTable != nullptr) {
-    customMappingSize = 0;
-    delete[] customMappingTable;
-    customMappingTable = nullptr;
-  }
+  freeMapping();
 
   JsonArray map = doc[F("map")];
   if (!map.isNull() && map.size()) {  // not an empty map
     customMappingSize  = map.size();
-    customMappingTable = new uint16_t[customMappingSize];
+    customMappingTable = (uint16_t*) callocLarge(customMappingSize, sizeof(uint16_t)); // PSRAM for large canvases
+    if (!customMappingTable) customMappingSize = 0;
     for (unsigned i=0; i<customMappingSize; i++) {
       customMappingTable[i] = (uint16_t) (map[i]<0 ? 0xFFFFU : map[i]);
     }
+    compactMapping();
   }
 
   releaseJSONBufferLock();
@@ -0,0 +1,194 @@
+/*
+  FX_particles.cpp contains the particle system shared by particle effects (see ParticleSystem in FX.h)
+
+  Positions and velocities are fixed point (16 fractional bits) so physics needs no floating point, which is
+  emulated in software on ESP8266 and ESP32-C3. Particle data is kept as separate arrays (x[], vx[], ...) in
+  segment data so moving all particles is a tight loop over the arrays they need.
+  Rendering adds (saturating) particle colors to the segment pixel buffer in one pass, resolving the buffer
+  once per call instead of going through setPixelColor() for every pixel (1D effects expanded onto 2D segments
+  and virtual strips still do).
+
+  LICENSE
+  The MIT License (MIT)
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+#include "wled.h"
+#include "FX.h"
+
+// segment data layout: uint16 count, uint16 layout (aligned extraLen | 2D flag), extra[], x[], vx[], (y[], vy[]), color[], life[], user[]
+#define PS_HEADER   4
+#define PS_ALIGN(n) (((n) + 3) & ~3)
+
+size_t ParticleSystem::dataSize(uint16_t n, bool twoD, size_t extraLen)
+{
+  return PS_HEADER + PS_ALIGN(extraLen) + n * ((twoD ? 4 : 2) * sizeof(int32_t) + sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint8_t));
+}
+
+bool ParticleSystem::setup(uint16_t n, bool twoD, size_t extraLen)
+{
+  const size_t len = dataSize(n, twoD, extraLen);
+  if (!n || extraLen > 0x7FFF || !SEGENV.allocateData(len)) return false;
+  uint8_t  *d   = SEGENV.data;
+  uint16_t *hdr = reinterpret_cast<uint16_t*>(d);
+  const uint16_t layout = PS_ALIGN(extraLen) | (twoD ? 1 : 0);
+  fresh = false;
+  if (hdr[0] != n || hdr[1] != layout) { // new or resized (arrays moved), start over
+    memset(d, 0, len);
+    hdr[0] = n;
+    hdr[1] = layout;
+    fresh  = true;
+  }
+  uint8_t *p = d + PS_HEADER;
+  extra = extraLen ? p : nullptr;           p += PS_ALIGN(extraLen);
+  x     = reinterpret_cast<int32_t*>(p);    p += n * sizeof(int32_t);
+  vx    = reinterpret_cast<int32_t*>(p);    p += n * sizeof(int32_t);
+  if (twoD) {
+    y   = reinterpret_cast<int32_t*>(p);    p += n * sizeof(int32_t);
+    vy  = reinterpret_cast<int32_t*>(p);    p += n * sizeof(int32_t);
+  } else {
+    y = vy = nullptr;
+  }
+  color = reinterpret_cast<uint32_t*>(p);   p += n * sizeof(uint32_t);
+  life  = reinterpret_cast<uint16_t*>(p);   p += n * sizeof(uint16_t);
+  user  = p;
+  count = n;
+  is2D  = twoD;
+  return true;
+}
+
+void ParticleSystem::spawn(uint16_t i, int32_t px, int32_t pvx, uint32_t c, uint16_t l)
+{
+  if (i >= count) return;
+  x[i]     = px;
+  vx[i]    = pvx;
+  color[i] = c;
+  life[i]  = l;
+}
+
+void ParticleSystem::spawn(uint16_t i, int32_t px, int32_t py, int32_t pvx, int32_t pvy, uint32_t c, uint16_t l)
+{
+  if (i >= count) return;
+  spawn(i, px, pvx, c, l);
+  if (!is2D) return;
+  y[i]  = py;
+  vy[i] = pvy;
+}
+
+void ParticleSystem::move(int32_t ax, int32_t ay, uint16_t first, uint16_t n)
+{
+  const unsigned end = MIN(unsigned(first) + n, count);
+  if (is2D) {
+    for (unsigned i = first; i < end; i++) {
+      if (!life[i]) continue;
+      x[i] += vx[i]; vx[i] += ax;
+      y[i] += vy[i]; vy[i] += ay;
+    }
+  } else {
+    for (unsigned i = first; i < end; i++) {
+      if (!life[i]) continue;
+      x[i] += vx[i]; vx[i] += ax;
+    }
+  }
+}
+
+// v = sqrt(2*g*h), in fixed point sqrt(2*g*h << PS_SHIFT), the operand is reduced to 32 bit (result loses one bit per step)
+int32_t ParticleSystem::launchVelocity(int32_t g, uint32_t h)
+{
+  uint64_t v2 = (2ULL * uint32_t(abs(g)) * h) << PS_SHIFT;
+  unsigned s = 0;
+  while (v2 > UINT32_MAX) { v2 >>= 2; s++; }
+  return int32_t(sqrt32_t(uint32_t(v2))) << s;
+}
+
+// 1D target: pixel buffer of a plain strip, or (buf == nullptr) addPixelColor() for strips expanded onto 2D
+static inline void psPlot(Segment &seg, uint32_t *buf, int vStrip, int p, uint32_t c)
+{
+  if (!c) return;
+  if (buf) buf[p] = color_add(buf[p], c, true);
+  else     seg.addPixelColor(p | (vStrip << 16), c, true);
+}
+
+// particle covers [pos - radius, pos + radius) but at least the pixel at pos, anti-aliased [pos - radius, pos + radius + 1)
+// weighted by how much of each pixel is covered (so a point particle is split between its two pixels by its fractional position)
+// mirroring maps pixel n to len-1-n (anti-aliased: the covered interval is mirrored)
+static void psDraw1D(Segment &seg, uint32_t *buf, int len, int vStrip, int32_t pos, uint32_t c, uint8_t flags, int32_t radius)
+{
+  const bool aa = flags & PS_AA;
+  if (flags & PS_FLIP) pos = (len - 1) * PS_ONE - pos + (aa ? 0 : PS_ONE - 1);
+  const int32_t l = pos - radius;
+  const int32_t r = aa ? pos + radius + PS_ONE : MAX(pos + radius, l + 1); // exclusive
+  const int first = MAX(l >> PS_SHIFT, 0);
+  const int last  = MIN((r - 1) >> PS_SHIFT, len - 1);
+  for (int p = first; p <= last; p++) {
+    if (!aa) { psPlot(seg, buf, vStrip, p, c); continue; }
+    const int32_t cov = MIN(r, (p + 1) * PS_ONE) - MAX(l, p * PS_ONE); // 1 .. PS_ONE
+    psPlot(seg, buf, vStrip, p, cov >= PS_ONE ? c : color_fade(c, cov >> (PS_SHIFT - 8)));
+  }
+}
+
+#ifndef WLED_DISABLE_2D
+#define WU_WEIGHT(a,b) ((uint8_t) (((a)*(b)+(a)+(b))>>8))
+// same weights as wu_pixel(), white is kept
+static void psDraw2D(uint32_t *buf, int cols, int rows, int32_t x, int32_t y, uint32_t c, uint8_t flags)
+{
+  if (flags & PS_FLIP) y = (rows - 1) * PS_ONE - y + ((flags & PS_AA) ? 0 : PS_ONE - 1);
+  const int px = x >> PS_SHIFT, py = y >> PS_SHIFT;
+  if (!(flags & PS_AA)) {
+    if (unsigned(px) < unsigned(cols) && unsigned(py) < unsigned(rows)) buf[px + py * cols] = color_add(buf[px + py * cols], c, true);
+    return;
+  }
+  const uint8_t xx = (x >> (PS_SHIFT - 8)) & 0xFF, yy = (y >> (PS_SHIFT - 8)) & 0xFF, ix = 255 - xx, iy = 255 - yy;
+  const uint8_t wu[4] = {WU_WEIGHT(ix, iy), WU_WEIGHT(xx, iy), WU_WEIGHT(ix, yy), WU_WEIGHT(xx, yy)};
+  for (int i = 0; i < 4; i++) {
+    const int qx = px + (i & 1), qy = py + (i >> 1);
+    if (unsigned(qx) >= unsigned(cols) || unsigned(qy) >= unsigned(rows) || !wu[i]) continue;
+    uint32_t &led = buf[qx + qy * cols];
+    led = color_add(led, color_fade(c, wu[i]), true);
+  }
+}
+#undef WU_WEIGHT
+#endif
+
+// vStrip: 0 or virtual strip number + 1 (as encoded by indexToVStrip()), only used for 1D effects expanded onto 2D segments
+void Segment::drawParticle(int32_t pos, uint32_t c, uint16_t vStrip, uint8_t flags, int32_t radius)
+{
+  if (!isActive() || !_pixels) return;
+  const bool linear = !(is2D() || isMatrixStrip()); // pixel buffer is the strip (no 1D to 2D expansion)
+  const int len = linear ? MIN(int(virtualLength()), int(_pixelsLen)) : virtualLength();
+  psDraw1D(*this, linear ? _pixels : nullptr, len, vStrip, pos, c, flags, radius);
+}
+
+void Segment::drawParticles(const ParticleSystem &ps, uint16_t first, uint16_t n, uint16_t vStrip, uint8_t flags, int32_t radius)
+{
+  if (!isActive() || !_pixels) return;
+  const unsigned end = MIN(unsigned(first) + n, ps.count);
+#ifndef WLED_DISABLE_2D
+  if (ps.is2D) {
+    uint32_t *buf = canvas();
+    if (!buf) return;
+    const int cols = virtualWidth(), rows = virtualHeight();
+    for (unsigned i = first; i < end; i++) if (ps.life[i]) psDraw2D(buf, cols, rows, ps.x[i], ps.y[i], ps.color[i], flags);
+    return;
+  }
+#else
+  if (ps.is2D) return;
+#endif
+  const bool linear = !(is2D() || isMatrixStrip());
+  const int len = linear ? MIN(int(virtualLength()), int(_pixelsLen)) : virtualLength();
+  uint32_t *buf = linear ? _pixels : nullptr;
+  for (unsigned i = first; i < end; i++) if (ps.life[i]) psDraw1D(*this, buf, len, vStrip, ps.x[i], ps.color[i], flags, radius);
+}
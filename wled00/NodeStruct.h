@@ -5,7 +5,7 @@
 * NodeStruct from the ESP Easy project (https://github.com/letscontrolit/ESPEasy)
 \*********************************************************************************************/
 
-#include <map>
+#include <new>
 #include <IPAddress.h>
 
 #define NODE_TYPE_ID_UNDEFINED        0
@@ -20,7 +20,7 @@
 \*********************************************************************************************/
 struct NodeStruct
 {
-  String    nodeName;
+  char      nodeName[33]; // inline, updated in place
   IPAddress ip;
   uint8_t   age;
   union {
@@ -31,12 +31,84 @@ struct NodeStruct
     };
   };
   uint32_t  build;
+  uint8_t   unit;       // key (instance id)
+  bool      used;
 
-  NodeStruct() : age(0), nodeType(0), build(0)
+  NodeStruct() : age(0), nodeType(0), build(0), unit(0), used(false)
   {
+    nodeName[0] = 0;
     for (uint8_t i = 0; i < 4; ++i) { ip[i] = 0; }
   }
 };
-typedef std::map<uint8_t, NodeStruct> NodesMap;
+
+/*********************************************************************************************\
+* NodesMap: fixed capacity, open addressed (linear probing) table keyed by unit
+* slots are allocated once on first insert and never freed (entries may move on erase())
+\*********************************************************************************************/
+class NodesMap
+{
+  private:
+    NodeStruct *_slots = nullptr;
+    size_t      _capacity;
+    size_t      _count = 0;
+
+    inline size_t home(uint8_t unit) const { return unit % _capacity; }
+
+  public:
+    NodesMap(size_t capacity = WLED_MAX_NODES) : _capacity(capacity) {}
+    ~NodesMap() { delete[] _slots; }
+
+    inline size_t size() const { return _count; }
+    inline size_t capacity() const { return _capacity; }
+    // slot by index for iteration (0 .. capacity()-1), nullptr if unused
+    inline NodeStruct* at(size_t i) { return (_slots && i < _capacity && _slots[i].used) ? &_slots[i] : nullptr; }
+
+    NodeStruct* find(uint8_t unit) {
+      if (!_slots) return nullptr;
+      for (size_t n = 0, i = home(unit); n < _capacity; n++, i = (i + 1) % _capacity) {
+        if (!_slots[i].used) return nullptr;
+        if (_slots[i].unit == unit) return &_slots[i];
+      }
+      return nullptr;
+    }
+
+    // existing node or new (cleared) node, nullptr if table is full or out of memory
+    NodeStruct* findOrAdd(uint8_t unit) {
+      NodeStruct *node = find(unit);
+      if (node || _count >= _capacity) return node;
+      if (!_slots) _slots = new (std::nothrow) NodeStruct[_capacity];
+      if (!_slots) return nullptr;
+      size_t i = home(unit);
+      while (_slots[i].used) i = (i + 1) % _capacity;
+      _slots[i] = NodeStruct();
+      _slots[i].unit = unit;
+      _slots[i].used = true;
+      _count++;
+      return &_slots[i];
+    }
+
+    // backward shift deletion keeps probe sequences intact without tombstones
+    void erase(NodeStruct *node) {
+      if (!node || !node->used) return;
+      size_t i = node - _slots;
+      _slots[i].used = false;
+      _count--;
+      for (size_t j = (i + 1) % _capacity; _slots[j].used; j = (j + 1) % _capacity) {
+        size_t h = home(_slots[j].unit);
+        // move entry j into hole i if its home slot is not within (i, j]
+        if ((i < j) ? (h <= i || h > j) : (h <= i && h > j)) {
+          _slots[i] = _slots[j];
+          _slots[j].used = false;
+          i = j;
+        }
+      }
+    }
+
+    // keeps the slots allocated so a response streaming the list never sees them freed
+    void clear() {
+      if (_slots) for (size_t i = 0; i < _capacity; i++) _slots[i].used = false;
+      _count = 0;
+    }
+};
 
 #endif // WLED_NODESTRUCT_H
@@ -0,0 +1,87 @@
+#ifndef WLED_API_KEYS_H
+#define WLED_API_KEYS_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef ARDUINO // host build (native unit tests), flash strings are plain memory
+  #define PROGMEM
+  #define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+  #define strncmp_P strncmp
+#endif
+
+/*
+ * HTTP API tokenizer
+ * The request is split at '&' once; each key is looked up in a perfect hash table (tools/api_keys_hash.py)
+ * and the position of its value (after '=', or after the key for flags) is stored.
+ * As before only the first occurrence of a key counts and keys are applied in the fixed order of handleSet().
+ * Used by handleSet() in set.cpp and by the native unit tests in test/ (no Arduino dependencies).
+ */
+enum ApiKey : uint8_t {
+  API_S, API_A, API_R, API_G, API_B, API_W, API_K, API_M, API_T, API_ND, API_NN, API_SM, API_SS, API_SV,
+  API_S2, API_GP, API_SP, API_RV, API_MI, API_SB, API_SW, API_PS, API_P1, API_P2, API_PL, API_R2, API_G2,
+  API_B2, API_W2, API_LX, API_LY, API_HU, API_SA, API_H2, API_K2, API_CL, API_C2, API_C3, API_SR, API_SC,
+  API_FX, API_SX, API_IX, API_FP, API_X1, API_X2, API_X3, API_M1, API_M2, API_M3, API_FXD, API_OL, API_SN,
+  API_RN, API_RD, API_NL, API_NT, API_NF, API_TT, API_ST, API_CT, API_LO, API_RB, API_NM, API_U0, API_U1,
+  API_IN, API_KEY_COUNT
+};
+#define API_AMP_KEYS (API_NN+1) // keys before this one are only recognized directly after '&' (e.g. "&A=")
+
+static const char apiKeyNames[API_KEY_COUNT][4] PROGMEM = {
+  "S","A","R","G","B","W","K","M","T","ND","NN","SM","SS","SV","S2","GP","SP","RV","MI","SB","SW","PS","P1",
+  "P2","PL","R2","G2","B2","W2","LX","LY","HU","SA","H2","K2","CL","C2","C3","SR","SC","FX","SX","IX","FP",
+  "X1","X2","X3","M1","M2","M3","FXD","OL","SN","RN","RD","NL","NT","NF","TT","ST","CT","LO","RB","NM","U0",
+  "U1","IN"
+};
+
+#define API_KEY_HASH_MUL 2654454967U
+static const uint8_t apiKeySlot[256] PROGMEM = {
+  255,255,255,255, 31,  9,255,255, 13,255,255,255,255,255, 62, 44,
+  255,255, 11,255,255,255,255,255,255,255,255, 66,255,255, 22,255,
+  255,255,255,255, 29,255,255,255,255, 38,255,255,  1,255, 61,255,
+   14,255, 10,255,255, 65, 58,255,255,255,255,255,255,255, 34, 20,
+  255,255,255, 47,255,255,255, 45,255, 42, 52,255,  0, 36, 15,255,
+  255,255,255,255,255, 23,255,255,255,255,  6, 30,255,255,255,255,
+   12, 51,255,255, 33,255,255,255,255, 17,255,255,255,255, 40,255,
+  255,255,255,255, 57, 32,255, 41,255,255,255, 48,255, 18, 54, 46,
+  255, 56,255,255, 37,255, 21,255,255,255,255,255,255,255,255,255,
+  255,255, 25,255,255,255,  7,255, 59,255,255,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255, 28,255, 53, 19,  2, 27, 50,
+   43,255, 49,255,255, 60,255,255,255, 16,255,255,255,255,255,255,
+  255,255,255, 55,  5, 26,255,255,255,255,  4,255,255,255,255,255,
+  255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
+  255,  3,255,255, 39,255,255,255,255,255,  8,255,255,255,255,255,
+  255,255,255,255,255,255, 35,255,255,255,255, 63,255, 64,255, 24,
+};
+
+static uint8_t apiKeyId(const char *key, size_t len)
+{
+  if (len == 0 || len > 3) return API_KEY_COUNT;
+  uint32_t k = 0;
+  for (size_t i = 0; i < len; i++) k |= (uint32_t)(uint8_t)key[i] << (8*i);
+  uint8_t id = pgm_read_byte(apiKeySlot + ((k * API_KEY_HASH_MUL) >> 24));
+  if (id >= API_KEY_COUNT || strncmp_P(key, apiKeyNames[id], len) || pgm_read_byte(&apiKeyNames[id][len])) return API_KEY_COUNT;
+  return id;
+}
+
+// fills val[] with pointers into req (nullptr if key is absent)
+static void tokenizeApiRequest(const char *req, const char *val[API_KEY_COUNT])
+{
+  for (size_t i = 0; i < API_KEY_COUNT; i++) val[i] = nullptr;
+  const char *p = strstr(req, "win");
+  if (!p) return;
+  p += 3;
+  bool amp = false;
+  while (*p) {
+    if (*p == '&') { amp = true; p++; continue; }
+    const char *k = p;
+    while (*p && *p != '=' && *p != '&') p++;
+    uint8_t id = apiKeyId(k, p - k);
+    const char *v = (*p == '=') ? p + 1 : p;
+    if (id < API_KEY_COUNT && !val[id] && (amp || id >= API_AMP_KEYS)) val[id] = v;
+    while (*p && *p != '&') p++; // skip value
+    amp = false;
+  }
+}
+
+#endif
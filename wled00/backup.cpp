@@ -0,0 +1,583 @@
+#include "wled.h"
+#include <memory>
+
+/*
+ * Backup (GET /backup) and restore (POST /backup) of configuration, presets, custom palettes and ledmaps.
+ * The backup is a tar archive compressed to gzip on the fly (LZ77 with a small window and fixed Huffman codes).
+ * It is generated piece by piece in the chunked response callback, one tar block at a time, so only a few kB
+ * of RAM are needed regardless of the file sizes and files are read only as fast as the client takes the data.
+ * Restore stores the uploaded archive, inflates it (any gzip with back references up to BK_INFLATE_WINDOW) and
+ * extracts the known files into temporary copies. Only when the whole archive was read and its CRC matches are
+ * the copies committed, otherwise they are dropped and all current files are kept.
+ * wsec.json is never part of the archive (passwords are not backed up).
+ */
+
+#ifndef WLED_DISABLE_BACKUP
+
+#ifdef ESP8266
+  #define BK_WINDOW_BITS    10
+  #define BK_HASH_BITS      9
+  #define BK_INFLATE_WINDOW 8192  // gzip produced elsewhere may need up to 32k
+#else
+  #define BK_WINDOW_BITS    12
+  #define BK_HASH_BITS      11
+  #define BK_INFLATE_WINDOW 32768
+#endif
+#define BK_WINDOW    (1 << BK_WINDOW_BITS)
+#define BK_MAX_MATCH 258
+#define BK_READ      512 // tar block, input compressed in one step
+#define BK_OUT       (((BK_READ + BK_MAX_MATCH) * 9 + 7) / 8 + 32) // worst case output of one step (9 bit literals, gzip header/trailer)
+#define TAR_BLOCK    512
+
+static const char *s_backupTmp = "/backup.tmp";
+#define BK_FILES     (2 + WLED_MAX_CUSTOM_PALETTES + 2*WLED_MAX_LEDMAPS) // candidates of backupFileName()
+
+// deflate length (257..285) and distance codes (0..29): base values, extra bits are derived
+static const uint16_t lenBase[]  PROGMEM = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258};
+static const uint16_t distBase[] PROGMEM = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577};
+static inline uint8_t lenExtra(uint8_t i)  { return (i < 8 || i == 28) ? 0 : (i - 4) / 4; }
+static inline uint8_t distExtra(uint8_t i) { return i < 4 ? 0 : i / 2 - 1; }
+
+// n-th candidate file of the archive, false past the last one
+static bool backupFileName(uint8_t n, char *name)
+{
+  if (n == 0) { strcpy_P(name, PSTR("/cfg.json"));     return true; }
+  if (n == 1) { strcpy_P(name, PSTR("/presets.json")); return true; }
+  n -= 2;
+  if (n < WLED_MAX_CUSTOM_PALETTES) { sprintf_P(name, PSTR("/palette%d.json"), n); return true; }
+  n -= WLED_MAX_CUSTOM_PALETTES;
+  if (n < 2*WLED_MAX_LEDMAPS) {
+    const bool bin = n >= WLED_MAX_LEDMAPS;
+    n %= WLED_MAX_LEDMAPS;
+    strcpy_P(name, PSTR("/ledmap"));
+    if (n) sprintf(name + 7, "%d", n);
+    strcat_P(name, bin ? PSTR(".bin") : PSTR(".json"));
+    return true;
+  }
+  return false;
+}
+
+// candidate index of an archived file name, -1 if it is not restored
+static int backupFileIndex(const char *name)
+{
+  char cand[33];
+  for (uint8_t n = 0; backupFileName(n, cand); n++) if (!strcmp(cand, name)) return n;
+  return -1;
+}
+
+
+/*
+ * backup: tar blocks -> LZ77/fixed Huffman deflate -> gzip
+ */
+struct BackupStream {
+  File     file;
+  uint32_t fileLeft = 0;        // bytes of the current file still to be archived
+  uint8_t  entry = 0;           // next candidate of backupFileName()
+  uint8_t  endBlocks = 0;       // zero blocks written after the last file
+  bool     tarDone = false;
+  bool     started = false;
+  bool     done = false;
+  uint8_t  blk[TAR_BLOCK];
+  uint16_t blkPos = TAR_BLOCK;  // consumed part of blk
+  uint8_t  win[2*BK_WINDOW];    // compressed history and lookahead
+  uint16_t pos = 0, fill = 0;
+  uint16_t head[1 << BK_HASH_BITS]; // last position+1 per hash, 0: none
+  uint8_t  out[BK_OUT];
+  uint16_t outPos = 0, outLen = 0;
+  uint32_t bitBuf = 0;
+  uint8_t  bitCnt = 0;
+  uint32_t crc = 0, size = 0;   // of the tar stream (gzip trailer)
+  BackupStream() { memset(head, 0, sizeof(head)); }
+  ~BackupStream() { if (file) file.close(); }
+};
+
+static void tarOctal(char *dst, size_t len, uint32_t v)
+{
+  dst[--len] = 0;
+  while (len) { dst[--len] = '0' + (v & 7); v >>= 3; }
+}
+
+// produces the next 512 byte tar block, false after the end of archive
+static bool tarNextBlock(BackupStream &bs)
+{
+  uint8_t *b = bs.blk;
+  if (bs.file) {
+    size_t n = min((size_t)bs.fileLeft, (size_t)TAR_BLOCK);
+    size_t r = bs.file.read(b, n);
+    if (r < n) memset(b + r, ' ', n - r); // file shrank meanwhile, whitespace keeps JSON valid
+    memset(b + n, 0, TAR_BLOCK - n);
+    bs.fileLeft -= n;
+    if (!bs.fileLeft) bs.file.close();
+    return true;
+  }
+  char name[33];
+  while (backupFileName(bs.entry, name)) {
+    bs.entry++;
+    if (!WLED_FS.exists(name)) continue;
+    bs.file = WLED_FS.open(name, "r");
+    if (!bs.file) continue;
+    bs.fileLeft = bs.file.size();
+    // ustar header
+    memset(b, 0, TAR_BLOCK);
+    strcpy((char*)b, name + 1);
+    tarOctal((char*)b + 100, 8, 0644);
+    tarOctal((char*)b + 108, 8, 0);
+    tarOctal((char*)b + 116, 8, 0);
+    tarOctal((char*)b + 124, 12, bs.fileLeft);
+    tarOctal((char*)b + 136, 12, toki.second());
+    b[156] = '0';
+    memcpy_P(b + 257, PSTR("ustar\0" "00"), 8);
+    memset(b + 148, ' ', 8);
+    uint32_t sum = 0;
+    for (size_t i = 0; i < TAR_BLOCK; i++) sum += b[i];
+    tarOctal((char*)b + 148, 7, sum);
+    if (!bs.fileLeft) bs.file.close();
+    DEBUG_PRINT(F("Backup ")); DEBUG_PRINTLN(name);
+    return true;
+  }
+  if (bs.endBlocks >= 2) return false;
+  bs.endBlocks++;
+  memset(b, 0, TAR_BLOCK);
+  return true;
+}
+
+static inline void putBits(BackupStream &bs, uint32_t v, uint8_t n)
+{
+  bs.bitBuf |= v << bs.bitCnt;
+  bs.bitCnt += n;
+  while (bs.bitCnt >= 8) { bs.out[bs.outLen++] = bs.bitBuf; bs.bitBuf >>= 8; bs.bitCnt -= 8; }
+}
+
+// Huffman codes are sent most significant bit first
+static inline void putCode(BackupStream &bs, uint16_t code, uint8_t n)
+{
+  uint16_t r = 0;
+  for (uint8_t i = 0; i < n; i++) { r = (r << 1) | (code & 1); code >>= 1; }
+  putBits(bs, r, n);
+}
+
+// fixed Huffman literal/length code
+static void putLit(BackupStream &bs, uint16_t v)
+{
+  if      (v < 144) putCode(bs, 0x30  + v,       8);
+  else if (v < 256) putCode(bs, 0x190 + v - 144, 9);
+  else if (v < 280) putCode(bs,         v - 256, 7);
+  else              putCode(bs, 0xC0  + v - 280, 8);
+}
+
+static void putMatch(BackupStream &bs, uint16_t len, uint16_t dist)
+{
+  uint8_t i = 28;
+  while (pgm_read_word(lenBase + i) > len) i--;
+  putLit(bs, 257 + i);
+  putBits(bs, len - pgm_read_word(lenBase + i), lenExtra(i));
+  i = 29;
+  while (pgm_read_word(distBase + i) > dist) i--;
+  putCode(bs, i, 5);
+  putBits(bs, dist - pgm_read_word(distBase + i), distExtra(i));
+}
+
+static inline uint16_t hash3(const uint8_t *p)
+{
+  return (uint32_t)((((uint32_t)p[0] << 16) | (p[1] << 8) | p[2]) * 2654435761UL) >> (32 - BK_HASH_BITS);
+}
+
+// reads one tar block and compresses what has enough lookahead into bs.out
+static void backupStep(BackupStream &bs)
+{
+  bs.outPos = bs.outLen = 0;
+  if (!bs.started) {
+    static const uint8_t gzHeader[] PROGMEM = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 3}; // deflate, no name, no time, Unix
+    memcpy_P(bs.out, gzHeader, sizeof(gzHeader));
+    bs.outLen = sizeof(gzHeader);
+    putBits(bs, 2, 3); // not final, fixed Huffman
+    bs.started = true;
+  }
+  if ((size_t)bs.fill + BK_READ > sizeof(bs.win)) { // slide window, pos > BK_WINDOW here
+    memmove(bs.win, bs.win + BK_WINDOW, bs.fill - BK_WINDOW);
+    bs.fill -= BK_WINDOW;
+    bs.pos  -= BK_WINDOW;
+    for (size_t i = 0; i < (1 << BK_HASH_BITS); i++) bs.head[i] = bs.head[i] > BK_WINDOW ? bs.head[i] - BK_WINDOW : 0;
+  }
+  if (!bs.tarDone) {
+    if (bs.blkPos >= TAR_BLOCK) {
+      if (tarNextBlock(bs)) bs.blkPos = 0;
+      else                  bs.tarDone = true;
+    }
+    if (!bs.tarDone) {
+      memcpy(bs.win + bs.fill, bs.blk, TAR_BLOCK);
+      bs.crc = crc32Update(bs.crc, bs.blk, TAR_BLOCK);
+      bs.size += TAR_BLOCK;
+      bs.fill += TAR_BLOCK;
+      bs.blkPos = TAR_BLOCK;
+    }
+  }
+
+  const uint16_t end = bs.tarDone ? bs.fill : (bs.fill > BK_MAX_MATCH ? bs.fill - BK_MAX_MATCH : 0);
+  while (bs.pos < end) {
+    uint16_t len = 0, dist = 0;
+    if (bs.pos + 2 < bs.fill) {
+      uint16_t &h = bs.head[hash3(bs.win + bs.pos)];
+      if (h && bs.pos - (h - 1) <= BK_WINDOW) {
+        const uint8_t *a = bs.win + h - 1, *b = bs.win + bs.pos;
+        const uint16_t maxLen = min(bs.fill - bs.pos, BK_MAX_MATCH);
+        while (len < maxLen && a[len] == b[len]) len++;
+        dist = bs.pos - (h - 1);
+      }
+      h = bs.pos + 1;
+    }
+    if (len >= 3) {
+      putMatch(bs, len, dist);
+      for (uint16_t i = 1; i < len && bs.pos + i + 2 < bs.fill; i++) bs.head[hash3(bs.win + bs.pos + i)] = bs.pos + i + 1;
+      bs.pos += len;
+    } else {
+      putLit(bs, bs.win[bs.pos++]);
+    }
+  }
+
+  if (bs.tarDone) {
+    putLit(bs, 256);                          // end of block
+    putBits(bs, 3, 3); putLit(bs, 256);       // empty final block
+    if (bs.bitCnt) putBits(bs, 0, 8 - bs.bitCnt);
+    for (size_t i = 0; i < 4; i++) bs.out[bs.outLen++] = bs.crc  >> (8*i);
+    for (size_t i = 0; i < 4; i++) bs.out[bs.outLen++] = bs.size >> (8*i);
+    bs.done = true;
+  }
+}
+
+void serveBackup(AsyncWebServerRequest* request)
+{
+  #ifdef WLED_ENABLE_PRESETS_BIN
+  exportPresets(); // bring presets.json up to date with presets.bin
+  #endif
+  flushFileJournal();
+  std::shared_ptr<BackupStream> bs(new (std::nothrow) BackupStream);
+  if (!bs) { request->send(503); return; }
+  AsyncWebServerResponse *response = request->beginChunkedResponse(F("application/gzip"), [bs](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+    size_t written = 0;
+    while (written < maxLen) {
+      if (bs->outPos >= bs->outLen) {
+        if (bs->done) break;
+        backupStep(*bs);
+        continue;
+      }
+      size_t n = min((size_t)(bs->outLen - bs->outPos), maxLen - written);
+      memcpy(buffer + written, bs->out + bs->outPos, n);
+      bs->outPos += n;
+      written += n;
+    }
+    return written;
+  });
+  char disp[64];
+  snprintf_P(disp, sizeof(disp), PSTR("attachment; filename=\"%s-backup.tar.gz\""), cmDNS);
+  response->addHeader(F("Content-Disposition"), disp);
+  response->addHeader(F("Cache-Control"), F("no-store"));
+  request->send(response);
+}
+
+
+/*
+ * restore: gzip -> inflate -> tar -> temporary copies -> commit
+ */
+struct RestoreState {
+  File     in;
+  uint8_t  buf[256];
+  uint16_t bufPos = 0, bufLen = 0;
+  bool     error = false;
+  uint32_t bitBuf = 0;
+  uint8_t  bitCnt = 0;
+  uint8_t *win = nullptr;       // inflate history (ring)
+  uint32_t total = 0;           // bytes inflated
+  uint32_t flushed = 0;         // bytes passed on to the tar parser
+  uint32_t crc = 0;
+  uint16_t litCount[16], litSym[288], distCount[16], distSym[32];
+  // tar parser
+  uint8_t  hdr[TAR_BLOCK];
+  uint16_t hdrLen = 0;
+  uint32_t left = 0, pad = 0;   // data/padding of the current entry still to be read
+  File     out;
+  int16_t  outIdx = -1;
+  bool     tarEnd = false;
+  uint8_t  restored[(BK_FILES + 7) / 8] = {0}; // backupFileName() indexes with a temporary copy
+  uint8_t  count = 0;
+  bool has(uint8_t n) const { return restored[n >> 3] & (1 << (n & 7)); }
+  ~RestoreState() { if (in) in.close(); if (out) out.close(); heapFree(HEAP_TAG_OTHER, win, BK_INFLATE_WINDOW); }
+};
+
+static void tmpName(char *name, uint8_t idx) { sprintf_P(name, PSTR("/bk%d.tmp"), idx); }
+
+// parses a complete tar header
+static void tarHeader(RestoreState &rs)
+{
+  const uint8_t *h = rs.hdr;
+  uint32_t sum = 0;
+  bool zero = true;
+  for (size_t i = 0; i < TAR_BLOCK; i++) { sum += (i >= 148 && i < 156) ? ' ' : h[i]; if (h[i]) zero = false; }
+  if (zero) { rs.tarEnd = true; return; }
+  if (sum != strtoul((const char*)h + 148, nullptr, 8)) { rs.error = true; return; }
+  char tmp[13];
+  memcpy(tmp, h + 124, 12); tmp[12] = 0;
+  rs.left = strtoul(tmp, nullptr, 8);
+  rs.pad  = (TAR_BLOCK - (rs.left % TAR_BLOCK)) % TAR_BLOCK;
+  if (h[156] != '0' && h[156] != 0) return; // directories, pax headers, links
+  char name[34] = "/";
+  const char *p = (const char*)h;
+  while (*p == '.' && p[1] == '/') p += 2; // archives repacked by tar
+  while (*p == '/') p++;
+  strncpy(name + 1, p, 32); name[33] = 0;
+  rs.outIdx = backupFileIndex(name);
+  if (rs.outIdx < 0) { DEBUG_PRINT(F("Restore skips ")); DEBUG_PRINTLN(name); return; }
+  tmpName(name, rs.outIdx);
+  rs.out = WLED_FS.open(name, "w");
+  if (!rs.out) rs.error = true;
+}
+
+static void tarEntryDone(RestoreState &rs)
+{
+  if (rs.out) { rs.out.close(); rs.restored[rs.outIdx >> 3] |= 1 << (rs.outIdx & 7); rs.count++; }
+  rs.outIdx = -1;
+}
+
+static void tarWrite(RestoreState &rs, const uint8_t *data, size_t len)
+{
+  while (len && !rs.error && !rs.tarEnd) {
+    size_t n;
+    if (rs.left) {
+      n = min(len, (size_t)rs.left);
+      if (rs.out && rs.out.write(data, n) != n) { rs.error = true; break; } // FS full
+      rs.left -= n;
+      if (!rs.left) tarEntryDone(rs);
+    } else if (rs.pad) {
+      n = min(len, (size_t)rs.pad);
+      rs.pad -= n;
+    } else {
+      n = min(len, (size_t)(TAR_BLOCK - rs.hdrLen));
+      memcpy(rs.hdr + rs.hdrLen, data, n);
+      rs.hdrLen += n;
+      if (rs.hdrLen == TAR_BLOCK) {
+        rs.hdrLen = 0;
+        tarHeader(rs);
+        if (!rs.left) tarEntryDone(rs); // empty file
+      }
+    }
+    data += n;
+    len  -= n;
+  }
+}
+
+static uint8_t getByte(RestoreState &rs)
+{
+  if (rs.bufPos >= rs.bufLen) {
+    rs.bufLen = rs.in.read(rs.buf, sizeof(rs.buf));
+    rs.bufPos = 0;
+    if (!rs.bufLen) { rs.error = true; return 0; } // truncated
+  }
+  return rs.buf[rs.bufPos++];
+}
+
+static uint32_t getBits(RestoreState &rs, uint8_t n)
+{
+  while (rs.bitCnt < n) { rs.bitBuf |= (uint32_t)getByte(rs) << rs.bitCnt; rs.bitCnt += 8; }
+  uint32_t v = rs.bitBuf & ((1UL << n) - 1);
+  rs.bitBuf >>= n;
+  rs.bitCnt -= n;
+  return v;
+}
+
+// passes inflated data on to CRC and tar parser (in pieces of 256 bytes, the ring size is a multiple)
+static void flushOutput(RestoreState &rs)
+{
+  while (rs.flushed < rs.total) {
+    const size_t at = rs.flushed % BK_INFLATE_WINDOW;
+    const size_t n  = min((size_t)(rs.total - rs.flushed), (size_t)256 - (at & 255));
+    rs.crc = crc32Update(rs.crc, rs.win + at, n);
+    tarWrite(rs, rs.win + at, n);
+    rs.flushed += n;
+  }
+}
+
+static inline void putByte(RestoreState &rs, uint8_t b)
+{
+  rs.win[rs.total++ % BK_INFLATE_WINDOW] = b;
+  if (!(rs.total & 255)) flushOutput(rs);
+}
+
+// canonical Huffman table from code lengths
+static void buildTable(uint16_t *count, uint16_t *sym, const uint8_t *lengths, uint16_t n)
+{
+  uint16_t offs[16];
+  memset(count, 0, 16 * sizeof(uint16_t));
+  for (uint16_t i = 0; i < n; i++) count[lengths[i]]++;
+  count[0] = 0;
+  offs[1] = 0;
+  for (uint8_t i = 1; i < 15; i++) offs[i + 1] = offs[i] + count[i];
+  for (uint16_t i = 0; i < n; i++) if (lengths[i]) sym[offs[lengths[i]]++] = i;
+}
+
+static int decodeSym(RestoreState &rs, const uint16_t *count, const uint16_t *sym)
+{
+  int code = 0, first = 0, index = 0;
+  for (uint8_t len = 1; len < 16; len++) {
+    code |= getBits(rs, 1);
+    const int c = count[len];
+    if (code - c < first) return sym[index + (code - first)];
+    index += c;
+    first  = (first + c) << 1;
+    code <<= 1;
+  }
+  rs.error = true;
+  return -1;
+}
+
+static bool dynamicTables(RestoreState &rs)
+{
+  static const uint8_t order[19] PROGMEM = {16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15};
+  uint8_t lengths[288+32];
+  const uint16_t nlen = getBits(rs, 5) + 257, ndist = getBits(rs, 5) + 1, ncode = getBits(rs, 4) + 4;
+  if (nlen > 286 || ndist > 30) return false;
+  memset(lengths, 0, 19);
+  for (uint8_t i = 0; i < ncode; i++) lengths[pgm_read_byte(order + i)] = getBits(rs, 3);
+  buildTable(rs.distCount, rs.distSym, lengths, 19); // code length code, tables are rebuilt below
+  for (uint16_t i = 0; i < nlen + ndist && !rs.error; ) {
+    int s = decodeSym(rs, rs.distCount, rs.distSym);
+    if (s < 16) { lengths[i++] = s; continue; }
+    uint8_t v = 0, rep;
+    if      (s == 16) { if (!i) return false; v = lengths[i-1]; rep = 3 + getBits(rs, 2); }
+    else if (s == 17) rep = 3  + getBits(rs, 3);
+    else              rep = 11 + getBits(rs, 7);
+    if (i + rep > nlen + ndist) return false;
+    while (rep--) lengths[i++] = v;
+  }
+  buildTable(rs.litCount,  rs.litSym,  lengths,        nlen);
+  buildTable(rs.distCount, rs.distSym, lengths + nlen, ndist);
+  return !rs.error;
+}
+
+static bool inflateCodes(RestoreState &rs)
+{
+  for (;;) {
+    int s = decodeSym(rs, rs.litCount, rs.litSym);
+    if (rs.error) return false;
+    if (s < 256) { putByte(rs, s); continue; }
+    if (s == 256) return true;
+    s -= 257;
+    if (s > 28) return false;
+    const uint16_t len = pgm_read_word(lenBase + s) + getBits(rs, lenExtra(s));
+    const int d = decodeSym(rs, rs.distCount, rs.distSym);
+    if (d < 0 || d > 29) return false;
+    const uint32_t dist = pgm_read_word(distBase + d) + getBits(rs, distExtra(d));
+    if (dist > rs.total || dist > BK_INFLATE_WINDOW) return false; // too far back for our history
+    for (uint16_t i = 0; i < len; i++) putByte(rs, rs.win[(rs.total - dist) % BK_INFLATE_WINDOW]);
+    if (rs.error) return false;
+  }
+}
+
+static bool inflateArchive(RestoreState &rs)
+{
+  uint8_t h[10];
+  for (size_t i = 0; i < sizeof(h); i++) h[i] = getByte(rs);
+  if (rs.error || h[0] != 0x1F || h[1] != 0x8B || h[2] != 8) return false;
+  if (h[3] & 0x04) { uint16_t x = getByte(rs); x |= getByte(rs) << 8; while (x-- && !rs.error) getByte(rs); } // extra field
+  if (h[3] & 0x08) while (getByte(rs) && !rs.error);  // file name
+  if (h[3] & 0x10) while (getByte(rs) && !rs.error);  // comment
+  if (h[3] & 0x02) { getByte(rs); getByte(rs); }      // header CRC
+
+  bool last = false;
+  while (!last && !rs.error) {
+    last = getBits(rs, 1);
+    switch (getBits(rs, 2)) {
+      case 0: { // stored
+        rs.bitBuf = rs.bitCnt = 0;
+        uint16_t len = getByte(rs); len |= getByte(rs) << 8;
+        uint16_t nlen = getByte(rs); nlen |= getByte(rs) << 8;
+        if ((uint16_t)~nlen != len) return false;
+        while (len-- && !rs.error) putByte(rs, getByte(rs));
+        break;
+      }
+      case 1: { // fixed Huffman
+        uint8_t lengths[288];
+        memset(lengths, 8, 144); memset(lengths + 144, 9, 112); memset(lengths + 256, 7, 24); memset(lengths + 280, 8, 8);
+        buildTable(rs.litCount, rs.litSym, lengths, 288);
+        memset(lengths, 5, 30);
+        buildTable(rs.distCount, rs.distSym, lengths, 30);
+        if (!inflateCodes(rs)) return false;
+        break;
+      }
+      case 2:
+        if (!dynamicTables(rs) || !inflateCodes(rs)) return false;
+        break;
+      default:
+        return false;
+    }
+  }
+  flushOutput(rs);
+  rs.bitBuf = rs.bitCnt = 0;
+  uint32_t crc = 0, size = 0;
+  for (size_t i = 0; i < 4; i++) crc  |= (uint32_t)getByte(rs) << (8*i);
+  for (size_t i = 0; i < 4; i++) size |= (uint32_t)getByte(rs) << (8*i);
+  return !rs.error && crc == rs.crc && size == rs.total;
+}
+
+// extracts the stored upload, commits all files or none, returns the number of restored files
+static uint8_t restoreBackup(bool &cfg)
+{
+  std::unique_ptr<RestoreState> rs(new (std::nothrow) RestoreState);
+  cfg = false;
+  if (!rs) return 0;
+  rs->win = (uint8_t*)heapMalloc(HEAP_TAG_OTHER, BK_INFLATE_WINDOW);
+  rs->in  = WLED_FS.open(s_backupTmp, "r");
+  bool ok = rs->win && rs->in && inflateArchive(*rs) && rs->tarEnd && !rs->error && rs->count;
+  if (rs->out) rs->out.close(); // entry cut short
+  rs->in.close();
+  WLED_FS.remove(s_backupTmp);
+  DEBUG_PRINTF("Restore %s (%u bytes)\n", ok ? "ok" : "failed", (unsigned)rs->total);
+
+  char tmp[16], name[33];
+  for (uint8_t n = 0; backupFileName(n, name); n++) {
+    tmpName(tmp, n);
+    if (rs->has(n)) commitFile(tmp, name, ok);
+    else if (WLED_FS.exists(tmp)) WLED_FS.remove(tmp); // leftover of an earlier attempt
+  }
+  if (!ok) return 0;
+
+  bool palettes = false, ledmaps = false;
+  for (uint8_t n = 2; n < BK_FILES; n++) if (rs->has(n)) (n < 2 + WLED_MAX_CUSTOM_PALETTES ? palettes : ledmaps) = true;
+  cfg = rs->has(0);
+  if (rs->has(1)) { // presets.json
+    presetsModifiedTime = toki.second();
+    invalidateFileIndex();
+    discardFileJournal();
+    invalidatePresetCache();
+    #ifdef WLED_ENABLE_PRESETS_BIN
+    requestPresetsImport();
+    #endif
+  }
+  if (palettes) strip.loadCustomPalettes(true);
+  if (ledmaps)  enumerateLedmaps();
+  return rs->count;
+}
+
+void handleBackupUpload(AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final)
+{
+  if (!index) request->_tempFile = WLED_FS.open(s_backupTmp, "w");
+  if (len && request->_tempFile) request->_tempFile.write(data, len);
+  if (!final) return;
+  if (request->_tempFile) request->_tempFile.close();
+  bool cfg;
+  if (!restoreBackup(cfg)) {
+    request->send(400, "text/plain", F("Backup invalid or incomplete, nothing restored."));
+    return;
+  }
+  cacheInvalidate++;
+  if (cfg) {
+    doReboot = true;
+    request->send(200, "text/plain", F("Backup restored.\nRebooting..."));
+  } else {
+    request->send(200, "text/plain", F("Backup restored."));
+  }
+}
+
+#else
+void serveBackup(AsyncWebServerRequest* request) { request->send(501); }
+void handleBackupUpload(AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) { if (final) request->send(501); }
+#endif
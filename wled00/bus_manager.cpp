@@ -8,14 +8,32 @@
 #include "pin_manager.h"
 #include "bus_wrapper.h"
 #include "bus_manager.h"
+#ifdef ARDUINO_ARCH_ESP32
+#include "driver/ledc.h"
+#endif
 
 //colors.cpp
-uint32_t colorBalanceFromKelvin(uint16_t kelvin, uint32_t rgb);
+void colorKtoBalance(uint16_t kelvin, byte* rgb);
 uint16_t approximateKelvinFromRGB(uint32_t rgb);
 void colorRGBtoRGBW(byte* rgb);
+#ifdef WLED_ENABLE_OUTPUT_GAMMA
+const uint16_t *getOutputGammaTable();
+#endif
+
+//heapmon.cpp
+void heapTrackAlloc(uint8_t tag, size_t len, bool ok);
+void heapTrackFree(uint8_t tag, size_t len);
+void* callocLarge(size_t n, size_t size);
+
+//trace.cpp
+#ifndef WLED_DISABLE_TRACE
+extern volatile bool traceOn;
+void traceRecord(uint8_t ev, uint8_t arg, uint16_t data, uint32_t ts, uint32_t dur);
+#endif
 
 //udp.cpp
 uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, byte *buffer, uint8_t bri=255, bool isRGBW=false);
+uint32_t realtimeBroadcastTime(uint8_t type, uint16_t length, bool isRGBW);
 
 // enable additional debug output
 #if defined(WLED_DEBUG_HOST)
@@ -38,6 +56,15 @@ uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, byte
   #define DEBUG_PRINTF(x...)
 #endif
 
+// 16 bit gamma table busses apply when converting to their output format (nullptr: no gamma at output)
+static inline const uint16_t *outputGamma() {
+  #ifdef WLED_ENABLE_OUTPUT_GAMMA
+  return getOutputGammaTable();
+  #else
+  return nullptr;
+  #endif
+}
+
 //color mangling macros
 #define RGBW32(r,g,b,w) (uint32_t((byte(w) << 24) | (byte(r) << 16) | (byte(g) << 8) | (byte(b))))
 #define R(c) (byte((c) >> 16))
@@ -75,9 +102,8 @@ uint8_t IRAM_ATTR ColorOrderMap::getPixelColorOrder(uint16_t pix, uint8_t defaul
 }
 
 
-uint32_t Bus::autoWhiteCalc(uint32_t c) {
-  uint8_t aWM = _autoWhiteMode;
-  if (_gAWM != AW_GLOBAL_DISABLED) aWM = _gAWM;
+// aWM is resolved once (getWhiteMode()) by callers writing runs of pixels
+uint32_t IRAM_ATTR Bus::autoWhiteCalc(uint32_t c, uint8_t aWM) {
   if (aWM == RGBW_MODE_MANUAL_ONLY) return c;
   uint8_t w = W(c);
   //ignore auto-white calculation if w>0 and mode DUAL (DUAL behaves as BRIGHTER if w==0)
@@ -91,17 +117,62 @@ uint32_t Bus::autoWhiteCalc(uint32_t c) {
   return RGBW32(r, g, b, w);
 }
 
+// generic version reads back every pixel, digital busses keep a running sum as pixels are written
+uint32_t Bus::getPowerUnits() {
+  uint32_t sum = 0;
+  for (unsigned i = 0; i < getLength(); i++) sum += pixelPower(getPixelColor(i));
+  return sum;
+}
+
 uint8_t *Bus::allocData(size_t size) {
   if (_data) free(_data); // should not happen, but for safety
-  return _data = (uint8_t *)(size>0 ? calloc(size, sizeof(uint8_t)) : nullptr);
+  return _data = (uint8_t *)(size>0 ? callocLarge(size, sizeof(uint8_t)) : nullptr); // only network busses are large
 }
 
 
+// pixel channels as sent by plain GRB/GRBW features, in given color order
+static inline void encodeWire(uint8_t *d, uint32_t c, uint8_t co, bool hasW) {
+  RgbwColor col = PolyBus::reorder(c, co);
+  d[0] = col.G; d[1] = col.R; d[2] = col.B;
+  if (hasW) d[3] = col.W;
+}
+
+static inline uint32_t decodeWire(const uint8_t *d, uint8_t co, bool hasW) {
+  uint8_t sg = d[0], sr = d[1], sb = d[2], sw = hasW ? d[3] : 0;
+  uint8_t r, g, b, w = sw;
+  switch (co >> 4) { // undo W swap
+    case 1: w = sb; sb = sw; break;
+    case 2: w = sg; sg = sw; break;
+    case 3: w = sr; sr = sw; break;
+  }
+  switch (co & 0x0F) {
+    default: g = sg; r = sr; b = sb; break; //0 = GRB
+    case  1: r = sg; g = sr; b = sb; break; //1 = RGB
+    case  2: b = sg; r = sr; g = sb; break; //2 = BRG
+    case  3: r = sg; b = sr; g = sb; break; //3 = RBG
+    case  4: b = sg; g = sr; r = sb; break; //4 = BGR
+    case  5: g = sg; b = sr; r = sb; break; //5 = GBR
+  }
+  return RGBW32(r, g, b, hasW ? w : 0);
+}
+
 BusDigital::BusDigital(BusConfig &bc, uint8_t nr, const ColorOrderMap &com)
 : Bus(bc.type, bc.start, bc.autoWhite, bc.count, bc.reversed, (bc.refreshReq || bc.type == TYPE_TM1814))
 , _skip(bc.skipAmount) //sacrificial pixels
 , _colorOrder(bc.colorOrder)
 , _colorOrderMap(com)
+, _milliAmpsMax(bc.milliAmpsMax)
+, _busColorOrder(255)
+, _coSpanCount(0)
+, _coSpanLast(0)
+, _wireCapable(false)
+, _wireOrder(255)
+, _pixPower(nullptr)
+, _powerSum(0)
+, _ditherErr(nullptr)
+, _lastShowAt(0)
+, _showInterval(0xFFFF)
+, _ditherOn(false)
 {
   if (!IS_DIGITAL(bc.type) || !bc.count) return;
   if (!pinManager.allocatePin(bc.pins[0], true, PinOwner::BusDigital)) return;
@@ -117,43 +188,152 @@ BusDigital::BusDigital(BusConfig &bc, uint8_t nr, const ColorOrderMap &com)
   }
   _iType = PolyBus::getI(bc.type, _pins, nr);
   if (_iType == I_NONE) return;
-  if (bc.doubleBuffer && !allocData(bc.count * (Bus::hasWhite(_type) + 3*Bus::hasRGB(_type)))) return; //warning: hardcoded channel count
-  _buffering = bc.doubleBuffer;
+  #ifdef WLED_ENABLE_OUTPUT_GAMMA
+  bool buffered = true; // bus buffer holds gamma corrected colors, reading them back would apply gamma again
+  #else
+  bool buffered = bc.doubleBuffer;
+  #endif
+  if (_iType == I_32_DM_DOT_3) buffered = true; // brightness is applied when converting buffer in show()
+  if (buffered && !allocData(bc.count * (Bus::hasWhite(_type) + 3*Bus::hasRGB(_type)))) return; //warning: hardcoded channel count
   uint16_t lenToCreate = bc.count;
   if (bc.type == TYPE_WS2812_1CH_X3) lenToCreate = NUM_ICS_WS2812_1CH_3X(bc.count); // only needs a third of "RGB" LEDs for NeoPixelBus
   _busPtr = PolyBus::create(_iType, _pins, lenToCreate + _skip, nr, _frequencykHz);
   _valid = (_busPtr != nullptr);
+  // if whole bus uses same color order, keep buffer in wire order so show() only needs to copy it
+  _wireCapable = _valid && _data && _type != TYPE_WS2812_1CH_X3 && PolyBus::getPixels(_busPtr, _iType) != nullptr;
+  updateColorOrder();
+  if (_valid) _pixPower = (uint8_t*) calloc(bc.count, sizeof(uint8_t)); // power is estimated by reading back pixels if this fails
   DEBUG_PRINTF("%successfully inited strip %u (len %u) with type %u and pins %u,%u (itype %u)\n", _valid?"S":"Uns", nr, bc.count, bc.type, _pins[0], _pins[1], _iType);
 }
 
 void BusDigital::show() {
   if (!_valid) return;
-  if (_buffering) { // should be _data != nullptr, but that causes ~20% FPS drop
+  if (_wireOrder != 255) {
+    // buffer is in wire order: copy into bus buffer applying brightness as NeoPixelBusLg would
+    const size_t channels = 3 + Bus::hasWhite(_type);
+    uint8_t *dst = PolyBus::getPixels(_busPtr, _iType);
+    #if !defined(STATUSLED) || STATUSLED>=0
+    memset(dst, 0, _skip * channels); // paint skipped pixels black
+    #else
+    if (_skip > 1) memset(dst + channels, 0, (_skip-1) * channels); // paint skipped pixels black, keep status LED
+    #endif
+    dst += _skip * channels;
+    const uint16_t *gt = outputGamma();
+    if (ditherActive(_bri == 255 && !gt)) {
+      // carry the part lost in the 8 bit conversion over to the next frame, so the average over frames is exact
+      uint16_t lut[256];
+      const uint32_t scale = _bri + 1;
+      for (size_t v = 0; v < 256; v++) lut[v] = gt ? (gt[v] * scale) >> 8 : v * scale;
+      for (size_t i = 0; i < _len; i++) {
+        const size_t offset = (_reversed ? _len - i - 1 : i) * channels;
+        const uint8_t *src = _data + offset;
+        uint8_t *err = _ditherErr + offset;
+        for (size_t c = 0; c < channels; c++) {
+          uint32_t t = lut[src[c]] + err[c];
+          if (t > 0xFFFF) t = 0xFFFF;
+          err[c] = t;
+          *dst++ = t >> 8;
+        }
+      }
+    } else if (_bri == 255 && !_reversed && !gt) {
+      memcpy(dst, _data, _len * channels);
+    } else if (!gt) {
+      const uint16_t scale = _bri + 1;
+      for (size_t i = 0; i < _len; i++) {
+        const uint8_t *src = _data + (_reversed ? _len - i - 1 : i) * channels;
+        for (size_t c = 0; c < channels; c++) *dst++ = (src[c] * scale) >> 8;
+      }
+    } else {
+      // gamma and brightness are combined at 16 bit so they only round once
+      uint8_t lut[256];
+      const uint32_t scale = _bri + 1;
+      for (size_t v = 0; v < 256; v++) lut[v] = (gt[v] * scale) >> 16;
+      for (size_t i = 0; i < _len; i++) {
+        const uint8_t *src = _data + (_reversed ? _len - i - 1 : i) * channels;
+        for (size_t c = 0; c < channels; c++) *dst++ = lut[src[c]];
+      }
+    }
+    PolyBus::show(_busPtr, _iType, false); // whole buffer is rewritten every frame
+    return;
+  }
+  const uint8_t *data = _data;
+  if (data) {
     size_t channels = Bus::hasWhite(_type) + 3*Bus::hasRGB(_type);
+    const uint16_t *gt = outputGamma();
+    const bool wide = gt && Bus::is16bit(_type);
+    // APA102 global brightness (5 bit) dims the LED current: use the smallest that reaches _bri and scale colors by the rest
+    // so that colors keep (almost) their full 8 bit resolution at low brightness
+    uint8_t *dot = PolyBus::getDotStarPixels(_busPtr, _iType);
+    const uint8_t  dotLum   = (_bri * 31 + 254) / 255;
+    const uint32_t dotScale = dotLum ? (_bri * 31 * 256) / (255 * dotLum) : 0; // 1..256
+    // walk color order spans along with pixels instead of looking up each pixel
+    uint8_t  span    = 0;
+    uint16_t spanEnd = _busColorOrder != 255 ? _len : _coSpans[0].end;
+    uint8_t  co      = _busColorOrder != 255 ? _busColorOrder : _coSpans[0].colorOrder;
     for (size_t i=0; i<_len; i++) {
       size_t offset = i*channels;
-      uint8_t co = _colorOrderMap.getPixelColorOrder(i+_start, _colorOrder);
+      if (i >= spanEnd) {
+        span++;
+        spanEnd = _coSpans[span].end;
+        co      = _coSpans[span].colorOrder;
+      }
       uint32_t c;
       if (_type == TYPE_WS2812_1CH_X3) { // map to correct IC, each controls 3 LEDs (_len is always a multiple of 3)
         switch (i%3) {
-          case 0: c = RGBW32(_data[offset]  , _data[offset+1], _data[offset+2], 0); break;
-          case 1: c = RGBW32(_data[offset-1], _data[offset]  , _data[offset+1], 0); break;
-          case 2: c = RGBW32(_data[offset-2], _data[offset-1], _data[offset]  , 0); break;
+          case 0: c = RGBW32(data[offset]  , data[offset+1], data[offset+2], 0); break;
+          case 1: c = RGBW32(data[offset-1], data[offset]  , data[offset+1], 0); break;
+          case 2: c = RGBW32(data[offset-2], data[offset-1], data[offset]  , 0); break;
         }
       } else {
-        c = RGBW32(_data[offset],_data[offset+1],_data[offset+2],(Bus::hasWhite(_type)?_data[offset+3]:0));
+        c = RGBW32(data[offset],data[offset+1],data[offset+2],(Bus::hasWhite(_type)?data[offset+3]:0));
       }
       uint16_t pix = i;
       if (_reversed) pix = _len - pix -1;
       pix += _skip;
+      if (wide) { // 16 bit channels keep the resolution gamma needs at the low end (brightness is applied by NeoPixelBus at 16 bit)
+        PolyBus::setPixelColor16(_busPtr, _iType, pix, gt[R(c)], gt[G(c)], gt[B(c)], gt[W(c)], co);
+        continue;
+      }
+      if (dot) { // written straight into the bus buffer in wire order
+        if (gt) c = RGBW32((gt[R(c)] * dotScale) >> 16, (gt[G(c)] * dotScale) >> 16, (gt[B(c)] * dotScale) >> 16, 0);
+        else    c = RGBW32((R(c) * dotScale) >> 8, (G(c) * dotScale) >> 8, (B(c) * dotScale) >> 8, 0);
+        RgbwColor col = PolyBus::reorder(c, co & 0x0F);
+        uint8_t *d = dot + pix * 4;
+        d[0] = 0xE0 | dotLum; d[1] = col.B; d[2] = col.G; d[3] = col.R;
+        continue;
+      }
+      if (gt) c = RGBW32(gt[R(c)] >> 8, gt[G(c)] >> 8, gt[B(c)] >> 8, gt[W(c)] >> 8);
       PolyBus::setPixelColor(_busPtr, _iType, pix, c, co);
     }
     #if !defined(STATUSLED) || STATUSLED>=0
-    if (_skip) PolyBus::setPixelColor(_busPtr, _iType, 0, 0, _colorOrderMap.getPixelColorOrder(_start, _colorOrder)); // paint skipped pixels black
+    if (_skip) PolyBus::setPixelColor(_busPtr, _iType, 0, 0, colorOrderAt(0)); // paint skipped pixels black
     #endif
-    for (int i=1; i<_skip; i++) PolyBus::setPixelColor(_busPtr, _iType, i, 0, _colorOrderMap.getPixelColorOrder(_start, _colorOrder)); // paint skipped pixels black
+    for (int i=1; i<_skip; i++) PolyBus::setPixelColor(_busPtr, _iType, i, 0, colorOrderAt(0)); // paint skipped pixels black
+  }
+  PolyBus::show(_busPtr, _iType, _data == nullptr); // faster if buffer consistency is not important
+}
+
+// measures refresh rate and decides if the frame about to be shown is dithered
+// exact: frame converts to 8 bit without loss (full brightness, no gamma at output)
+bool BusDigital::ditherActive(bool exact) {
+  uint32_t now = micros();
+  uint32_t interval = now - _lastShowAt;
+  _lastShowAt = now;
+  if (interval > 0xFFFF) interval = 0xFFFF;
+  _showInterval = (3 * _showInterval + interval) >> 2;
+  if (!_dithering || exact || _showInterval > WLED_DITHER_MAX_INTERVAL) {
+    _ditherOn = false;
+    return false;
+  }
+  size_t size = _len * (3 + Bus::hasWhite(_type));
+  if (!_ditherErr) {
+    _ditherErr = (uint8_t*) calloc(size, sizeof(uint8_t));
+    if (!_ditherErr) return false;
+  } else if (!_ditherOn) {
+    memset(_ditherErr, 0, size); // errors left from earlier frames are stale
   }
-  PolyBus::show(_busPtr, _iType, !_buffering); // faster if buffer consistency is not important
+  _ditherOn = true;
+  return true;
 }
 
 bool BusDigital::canShow() {
@@ -161,7 +341,7 @@ bool BusDigital::canShow() {
   return PolyBus::canShow(_busPtr, _iType);
 }
 
-void BusDigital::setBrightness(uint8_t b) {
+void BusDigital::setBrightness(uint8_t b, bool repaint) {
   if (_bri == b) return;
   //Fix for turning off onboard LED breaking bus
   #ifdef LED_BUILTIN
@@ -173,11 +353,11 @@ void BusDigital::setBrightness(uint8_t b) {
   Bus::setBrightness(b);
   PolyBus::setBrightness(_busPtr, _iType, b);
 
-  if (_buffering) return;
+  if (_data || !repaint) return;
 
   // must update/repaint every LED in the NeoPixelBus buffer to the new brightness
   // the only case where repainting is unnecessary is when all pixels are set after the brightness change but before the next show
-  // (which we can't rely on)
+  // (repaint == false: strip composites the whole frame with the new brightness)
   uint16_t hwLen = _len;
   if (_type == TYPE_WS2812_1CH_X3) hwLen = NUM_ICS_WS2812_1CH_3X(_len); // only needs a third of "RGB" LEDs for NeoPixelBus
   for (uint_fast16_t i = 0; i < hwLen; i++) {
@@ -191,7 +371,7 @@ void BusDigital::setBrightness(uint8_t b) {
 //TODO only show if no new show due in the next 50ms
 void BusDigital::setStatusPixel(uint32_t c) {
   if (_valid && _skip) {
-    PolyBus::setPixelColor(_busPtr, _iType, 0, c, _colorOrderMap.getPixelColorOrder(_start, _colorOrder));
+    PolyBus::setPixelColor(_busPtr, _iType, 0, c, colorOrderAt(0));
     if (canShow()) PolyBus::show(_busPtr, _iType);
   }
 }
@@ -199,20 +379,27 @@ void BusDigital::setStatusPixel(uint32_t c) {
 void IRAM_ATTR BusDigital::setPixelColor(uint16_t pix, uint32_t c) {
   if (!_valid) return;
   if (Bus::hasWhite(_type)) c = autoWhiteCalc(c);
-  if (_cct >= 1900) c = colorBalanceFromKelvin(_cct, c); //color correction from CCT
-  if (_buffering) { // should be _data != nullptr, but that causes ~20% FPS drop
-    size_t channels = Bus::hasWhite(_type) + 3*Bus::hasRGB(_type);
-    size_t offset = pix*channels;
-    if (Bus::hasRGB(_type)) {
-      _data[offset++] = R(c);
-      _data[offset++] = G(c);
-      _data[offset++] = B(c);
+  if (_cct >= 1900) c = balanceCCT(c); //color correction from CCT
+  trackPower(pix, c);
+  uint8_t *data = _data; // see note on _data
+  if (data) {
+    const bool hasW = Bus::hasWhite(_type);
+    const bool hasRGB = Bus::hasRGB(_type);
+    data += pix * (hasW + 3*hasRGB);
+    if (_wireOrder != 255) {
+      encodeWire(data, c, _wireOrder, hasW);
+      return;
     }
-    if (Bus::hasWhite(_type)) _data[offset] = W(c);
+    if (hasRGB) {
+      *data++ = R(c);
+      *data++ = G(c);
+      *data++ = B(c);
+    }
+    if (hasW) *data = W(c);
   } else {
+    uint8_t co = colorOrderAt(pix);
     if (_reversed) pix = _len - pix -1;
     pix += _skip;
-    uint8_t co = _colorOrderMap.getPixelColorOrder(pix+_start, _colorOrder);
     if (_type == TYPE_WS2812_1CH_X3) { // map to correct IC, each controls 3 LEDs
       uint16_t pOld = pix;
       pix = IC_INDEX_WS2812_1CH_3X(pix);
@@ -227,23 +414,59 @@ void IRAM_ATTR BusDigital::setPixelColor(uint16_t pix, uint32_t c) {
   }
 }
 
-// returns original color if global buffering is enabled, else returns lossly restored color from bus
-uint32_t BusDigital::getPixelColor(uint16_t pix) {
-  if (!_valid) return 0;
-  if (_buffering) { // should be _data != nullptr, but that causes ~20% FPS drop
-    size_t channels = Bus::hasWhite(_type) + 3*Bus::hasRGB(_type);
-    size_t offset = pix*channels;
-    uint32_t c;
-    if (!Bus::hasRGB(_type)) {
-      c = RGBW32(_data[offset], _data[offset], _data[offset], _data[offset]);
+// writes a contiguous run of pixels, type specific checks are only done once for the whole run
+void IRAM_ATTR BusDigital::setPixelColors(uint16_t pix, uint16_t count, const uint32_t *c) {
+  if (!_valid) return;
+  if (pix >= _len) return;
+  if (count > _len - pix) count = _len - pix;
+  if (!_data || _type == TYPE_WS2812_1CH_X3) {
+    for (unsigned i = 0; i < count; i++) setPixelColor(pix + i, c[i]);
+    return;
+  }
+  const bool hasW = Bus::hasWhite(_type);
+  const bool hasRGB = Bus::hasRGB(_type);
+  const size_t channels = hasW + 3*hasRGB;
+  const uint8_t aWM = getWhiteMode();
+  const bool balance = _cct >= 1900;
+  uint8_t *data = _data + pix*channels;
+  for (unsigned i = 0; i < count; i++) {
+    uint32_t col = c[i];
+    if (hasW) col = autoWhiteCalc(col, aWM);
+    if (balance) col = balanceCCT(col); //color correction from CCT
+    trackPower(pix + i, col);
+    if (_wireOrder != 255) {
+      encodeWire(data, col, _wireOrder, hasW);
+      data += channels;
     } else {
-      c = RGBW32(_data[offset], _data[offset+1], _data[offset+2], Bus::hasWhite(_type) ? _data[offset+3] : 0);
+    if (hasRGB) {
+      *data++ = R(col);
+      *data++ = G(col);
+      *data++ = B(col);
     }
-    return c;
+    if (hasW) *data++ = W(col);
+    }
+  }
+}
+
+uint32_t BusDigital::getPowerUnits() {
+  if (!_pixPower) return Bus::getPowerUnits();
+  return _powerSum << 2;
+}
+
+// returns original color if global buffering is enabled, else returns lossly restored color from bus
+uint32_t WLED_HOT(BusDigital_getPixelColor) BusDigital::getPixelColor(uint16_t pix) {
+  if (!_valid) return 0;
+  const uint8_t *data = _data;
+  if (data) {
+    const bool hasW = Bus::hasWhite(_type);
+    data += pix * (hasW + 3*Bus::hasRGB(_type));
+    if (_wireOrder != 255) return decodeWire(data, _wireOrder, hasW);
+    if (!Bus::hasRGB(_type)) return RGBW32(data[0], data[0], data[0], data[0]);
+    return RGBW32(data[0], data[1], data[2], hasW ? data[3] : 0);
   } else {
+    uint8_t co = colorOrderAt(pix);
     if (_reversed) pix = _len - pix -1;
     pix += _skip;
-    uint8_t co = _colorOrderMap.getPixelColorOrder(pix+_start, _colorOrder);
     uint32_t c = restoreColorLossy(PolyBus::getPixelColor(_busPtr, _iType, (_type==TYPE_WS2812_1CH_X3) ? IC_INDEX_WS2812_1CH_3X(pix) : pix, co),_bri);
     if (_type == TYPE_WS2812_1CH_X3) { // map to correct IC, each controls 3 LEDs
       uint8_t r = R(c);
@@ -259,6 +482,27 @@ uint32_t BusDigital::getPixelColor(uint16_t pix) {
   }
 }
 
+// time to clock out one frame (us) from protocol bit time and number of LEDs (including skipped ones)
+uint32_t BusDigital::getWireTime() {
+  uint32_t n = _len + _skip;
+  if (IS_2PIN(_type)) {
+    uint32_t bits;
+    switch (_type) {
+      case TYPE_APA102:  bits = 32 * n + 32 + n/2; break; // start frame, end frame of n/2 clocks
+      case TYPE_P9813:   bits = 32 * n + 64;       break;
+      case TYPE_LPD6803: bits = 16 * n + 32;       break;
+      default:           bits = 24 * n;            break; // WS2801, LPD8806
+    }
+    return _frequencykHz ? (uint64_t)bits * 1000U / _frequencykHz : 0;
+  }
+  uint32_t bytes = 3;
+  if      (_type == TYPE_SK6812_RGBW || _type == TYPE_TM1814) bytes = 4;
+  else if (_type == TYPE_UCS8903) bytes = 6;
+  else if (_type == TYPE_UCS8904) bytes = 8;
+  uint32_t bits = n * bytes * 8;
+  return (_type == TYPE_WS2811_400KHZ ? bits * 5 / 2 : bits * 5 / 4) + WLED_LED_RESET_US; // 2.5us or 1.25us per bit
+}
+
 uint8_t BusDigital::getPins(uint8_t* pinArray) {
   uint8_t numPins = IS_2PIN(_type) ? 2 : 1;
   for (uint8_t i = 0; i < numPins; i++) pinArray[i] = _pins[i];
@@ -269,6 +513,73 @@ void BusDigital::setColorOrder(uint8_t colorOrder) {
   // upper nibble contains W swap information
   if ((colorOrder & 0x0F) > 5) return;
   _colorOrder = colorOrder;
+  updateColorOrder();
+}
+
+// splits bus into sorted spans of uniform color order (map entries are only evaluated here, when map or bus changes)
+void BusDigital::compileColorOrder() {
+  uint16_t bounds[2*WLED_MAX_COLOR_ORDER_MAPPINGS+2];
+  uint8_t n = 0;
+  bounds[n++] = 0;
+  for (uint8_t m = 0; m < _colorOrderMap.count(); m++) {
+    const ColorOrderMapEntry *e = _colorOrderMap.get(m);
+    int32_t first = int32_t(e->start) - _start;
+    int32_t last  = first + e->len;
+    if (first > 0 && first < _len) bounds[n++] = first;
+    if (last  > 0 && last  < _len) bounds[n++] = last;
+  }
+  // insertion sort, there are only a few boundaries
+  for (uint8_t i = 1; i < n; i++) {
+    uint16_t b = bounds[i];
+    int j = i;
+    for (; j > 0 && bounds[j-1] > b; j--) bounds[j] = bounds[j-1];
+    bounds[j] = b;
+  }
+  bounds[n] = _len;
+  _coSpanCount = 0;
+  _coSpanLast = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    if (bounds[i] == bounds[i+1]) continue; // duplicate boundary
+    uint8_t co = _colorOrderMap.getPixelColorOrder(_start + bounds[i], _colorOrder);
+    if (_coSpanCount && _coSpans[_coSpanCount-1].colorOrder == co) _coSpans[_coSpanCount-1].end = bounds[i+1]; // merge with previous
+    else _coSpans[_coSpanCount++] = {bounds[i+1], co};
+  }
+  if (!_coSpanCount) _coSpans[_coSpanCount++] = {_len, _colorOrder};
+}
+
+uint8_t IRAM_ATTR BusDigital::spanColorOrder(uint16_t pix) {
+  uint8_t s = _coSpanLast;
+  if (pix >= _coSpans[s].end || (s && pix < _coSpans[s-1].end)) {
+    s = 0;
+    while (s < _coSpanCount-1 && pix >= _coSpans[s].end) s++;
+    _coSpanLast = s;
+  }
+  return _coSpans[s].colorOrder;
+}
+
+// color order is resolved once per bus unless color order map assigns different orders to parts of it
+void BusDigital::updateColorOrder() {
+  compileColorOrder();
+  _busColorOrder = _coSpanCount == 1 ? _coSpans[0].colorOrder : 255;
+  if (_wireCapable && _wireOrder != _busColorOrder) {
+    recodeData(_wireOrder, _busColorOrder);
+    _wireOrder = _busColorOrder;
+  }
+}
+
+// converts buffered pixels between RGBW order (255) and wire order of a color order
+void BusDigital::recodeData(uint8_t fromOrder, uint8_t toOrder) {
+  if (!_data) return;
+  const bool hasW = Bus::hasWhite(_type);
+  const size_t channels = 3 + hasW;
+  for (size_t i = 0; i < _len; i++) {
+    uint8_t *d = _data + i*channels;
+    uint32_t c = fromOrder == 255 ? RGBW32(d[0], d[1], d[2], hasW ? d[3] : 0) : decodeWire(d, fromOrder, hasW);
+    if (toOrder == 255) {
+      d[0] = R(c); d[1] = G(c); d[2] = B(c);
+      if (hasW) d[3] = W(c);
+    } else encodeWire(d, c, toOrder, hasW);
+  }
 }
 
 void BusDigital::reinit() {
@@ -283,6 +594,12 @@ void BusDigital::cleanup() {
   _valid = false;
   _busPtr = nullptr;
   if (_data != nullptr) freeData();
+  if (_pixPower) free(_pixPower);
+  _pixPower = nullptr;
+  if (_ditherErr) free(_ditherErr);
+  _ditherErr = nullptr;
+  _ditherOn = false;
+  _powerSum = 0;
   pinManager.deallocatePin(_pins[1], PinOwner::BusDigital);
   pinManager.deallocatePin(_pins[0], PinOwner::BusDigital);
 }
@@ -294,15 +611,20 @@ BusPwm::BusPwm(BusConfig &bc)
   if (!IS_PWM(bc.type)) return;
   uint8_t numPins = NUM_PWM_PINS(bc.type);
   _frequency = bc.frequency ? bc.frequency : WLED_PWM_FREQ;
+  _depth = WLED_PWM_MAX_BITS;
 
   #ifdef ESP8266
   analogWriteRange(255);  //same range as one RGB channel
   analogWriteFreq(_frequency);
   #else
+  // use highest resolution the LEDC timer can run at this frequency
+  while (_depth > 8 && (80000000UL >> _depth) < _frequency) _depth--;
+  _lastShow = 0;
   _ledcStart = pinManager.allocateLedc(numPins);
   if (_ledcStart == 255) { //no more free LEDC channels
     deallocatePins(); return;
   }
+  if (!_fadeInstalled) _fadeInstalled = (ledc_fade_func_install(0) == ESP_OK);
   #endif
 
   for (uint8_t i = 0; i < numPins; i++) {
@@ -314,7 +636,7 @@ BusPwm::BusPwm(BusConfig &bc)
     #ifdef ESP8266
     pinMode(_pins[i], OUTPUT);
     #else
-    ledcSetup(_ledcStart + i, _frequency, 8);
+    ledcSetup(_ledcStart + i, _frequency, _depth);
     ledcAttachPin(_pins[i], _ledcStart + i);
     #endif
   }
@@ -326,7 +648,7 @@ void BusPwm::setPixelColor(uint16_t pix, uint32_t c) {
   if (pix != 0 || !_valid) return; //only react to first pixel
   if (_type != TYPE_ANALOG_3CH) c = autoWhiteCalc(c);
   if (_cct >= 1900 && (_type == TYPE_ANALOG_3CH || _type == TYPE_ANALOG_4CH)) {
-    c = colorBalanceFromKelvin(_cct, c); //color correction from CCT
+    c = balanceCCT(c); //color correction from CCT
   }
   uint8_t r = R(c);
   uint8_t g = G(c);
@@ -384,13 +706,37 @@ uint32_t BusPwm::getPixelColor(uint16_t pix) {
 void BusPwm::show() {
   if (!_valid) return;
   uint8_t numPins = NUM_PWM_PINS(_type);
+  const uint16_t *gt = outputGamma();
+  const uint32_t maxDuty = (1U << _depth) - 1;
+  #ifdef ARDUINO_ARCH_ESP32
+  // frames in quick succession (transitions, effects) are faded in between by LEDC hardware at full resolution
+  // fade has to complete before the next frame, as starting a new fade waits for the running one
+  uint32_t now = millis();
+  uint32_t interval = now - _lastShow;
+  _lastShow = now;
+  bool fade = _fadeInstalled && interval > 1 && interval < WLED_PWM_FADE_MAX_INTERVAL;
+  uint32_t hPoint = 0;
+  #endif
   for (uint8_t i = 0; i < numPins; i++) {
-    uint8_t scaled = (_data[i] * _bri) / 255;
-    if (_reversed) scaled = 255 - scaled;
+    // brightness (and output gamma) at 16 bit, then reduced to PWM resolution
+    uint32_t level = gt ? (gt[_data[i]] * uint32_t(_bri + 1)) >> 8 : (_data[i] * 257U * (_bri + 1)) >> 8;
+    uint32_t duty = level >> (16 - _depth);
+    if (_reversed) duty = maxDuty - duty;
     #ifdef ESP8266
-    analogWrite(_pins[i], scaled);
+    analogWrite(_pins[i], duty);
     #else
-    ledcWrite(_ledcStart + i, scaled);
+    ledc_mode_t    mode = (ledc_mode_t)((_ledcStart + i) / 8);
+    ledc_channel_t ch   = (ledc_channel_t)((_ledcStart + i) % 8);
+    if (fade) {
+      ledc_set_fade_with_time(mode, ch, duty, interval / 2); // keeps phase of channel
+      ledc_fade_start(mode, ch, LEDC_FADE_NO_WAIT);
+    } else {
+      ledc_set_duty_with_hpoint(mode, ch, duty, hPoint);
+      ledc_update_duty(mode, ch);
+    }
+    // next channel turns on when this one turns off, so channels draw current in turn rather than all at the start of the period
+    hPoint += duty;
+    if (hPoint > maxDuty) hPoint -= maxDuty + 1;
     #endif
   }
 }
@@ -464,9 +810,42 @@ uint8_t BusOnOff::getPins(uint8_t* pinArray) {
 }
 
 
+#ifdef WLED_NETBUS_TASK
+TaskHandle_t      BusNetwork::_task = nullptr;
+SemaphoreHandle_t BusNetwork::_sendLock = nullptr;
+BusNetwork       *BusNetwork::_instances[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES] = {nullptr};
+
+// sends newest frame of each network bus; frames arriving while sending replace older unsent ones (drop oldest)
+void BusNetwork::senderTask(void *parameter) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // wait for a frame
+    xSemaphoreTake(_sendLock, portMAX_DELAY);
+    for (size_t i = 0; i < sizeof(_instances)/sizeof(_instances[0]); i++) if (_instances[i]) _instances[i]->sendPending();
+    xSemaphoreGive(_sendLock);
+  }
+}
+
+void BusNetwork::sendPending() {
+  xSemaphoreTake(_frameLock, portMAX_DELAY);
+  if (!_hasPending) { xSemaphoreGive(_frameLock); return; }
+  std::swap(_pending, _sending);
+  _sendingBri = _pendingBri;
+  _hasPending = false;
+  xSemaphoreGive(_frameLock);
+  realtimeBroadcast(_UDPtype, _client, _len, _sending, _sendingBri, _rgbw);
+}
+#endif
+
 BusNetwork::BusNetwork(BusConfig &bc)
 : Bus(bc.type, bc.start, bc.autoWhite, bc.count)
 , _broadcastLock(false)
+, _dropped(0)
+#ifdef WLED_NETBUS_TASK
+, _pending(nullptr)
+, _sending(nullptr)
+, _hasPending(false)
+, _frameLock(nullptr)
+#endif
 {
   switch (bc.type) {
     case TYPE_NET_ARTNET_RGB:
@@ -477,6 +856,10 @@ BusNetwork::BusNetwork(BusConfig &bc)
       _rgbw = false;
       _UDPtype = 1;
       break;
+    case TYPE_NET_DDP_TILES:
+      _rgbw = false;
+      _UDPtype = 3;
+      break;
     default: // TYPE_NET_DDP_RGB / TYPE_NET_DDP_RGBW
       _rgbw = bc.type == TYPE_NET_DDP_RGBW;
       _UDPtype = 0;
@@ -485,12 +868,42 @@ BusNetwork::BusNetwork(BusConfig &bc)
   _UDPchannels = _rgbw ? 4 : 3;
   _client = IPAddress(bc.pins[0],bc.pins[1],bc.pins[2],bc.pins[3]);
   _valid = (allocData(_len * _UDPchannels) != nullptr);
+#ifdef WLED_NETBUS_TASK
+  if (!_valid) return;
+  if (!_sendLock) _sendLock = xSemaphoreCreateMutex();
+  if (_sendLock && !_task) {
+    xTaskCreatePinnedToCore(
+      senderTask,     // Function to implement the task
+      "NetBus",       // Name of the task
+      3072,           // Stack size in words
+      nullptr,        // Task input parameter
+      1,              // Priority of the task (same as loop())
+      &_task,         // Task handle
+      0               // Core where the task should run (network stack)
+    );
+    DEBUG_PRINTF("Network bus task %s.\n", _task ? "started" : "failed");
+  }
+  // without sender task (or memory for frame buffers) frames are sent synchronously from show()
+  if (!_task || !(_frameLock = xSemaphoreCreateMutex())) return;
+  _pending = (uint8_t*)callocLarge(_len, _UDPchannels);
+  _sending = (uint8_t*)callocLarge(_len, _UDPchannels);
+  bool registered = false;
+  if (_pending && _sending) {
+    xSemaphoreTake(_sendLock, portMAX_DELAY);
+    for (size_t i = 0; i < sizeof(_instances)/sizeof(_instances[0]) && !registered; i++) if (!_instances[i]) { _instances[i] = this; registered = true; }
+    xSemaphoreGive(_sendLock);
+  }
+  if (!registered) {
+    free(_pending); _pending = nullptr;
+    free(_sending); _sending = nullptr;
+  }
+#endif
 }
 
 void BusNetwork::setPixelColor(uint16_t pix, uint32_t c) {
   if (!_valid || pix >= _len) return;
   if (_rgbw) c = autoWhiteCalc(c);
-  if (_cct >= 1900) c = colorBalanceFromKelvin(_cct, c); //color correction from CCT
+  if (_cct >= 1900) c = balanceCCT(c); //color correction from CCT
   uint16_t offset = pix * _UDPchannels;
   _data[offset]   = R(c);
   _data[offset+1] = G(c);
@@ -498,6 +911,23 @@ void BusNetwork::setPixelColor(uint16_t pix, uint32_t c) {
   if (_rgbw) _data[offset+3] = W(c);
 }
 
+void BusNetwork::setPixelColors(uint16_t pix, uint16_t count, const uint32_t *c) {
+  if (!_valid || pix >= _len) return;
+  if (count > _len - pix) count = _len - pix;
+  uint8_t *data = _data + pix * _UDPchannels;
+  const uint8_t aWM = getWhiteMode();
+  const bool balance = _cct >= 1900;
+  for (unsigned i = 0; i < count; i++) {
+    uint32_t col = c[i];
+    if (_rgbw) col = autoWhiteCalc(col, aWM);
+    if (balance) col = balanceCCT(col); //color correction from CCT
+    *data++ = R(col);
+    *data++ = G(col);
+    *data++ = B(col);
+    if (_rgbw) *data++ = W(col);
+  }
+}
+
 uint32_t BusNetwork::getPixelColor(uint16_t pix) {
   if (!_valid || pix >= _len) return 0;
   uint16_t offset = pix * _UDPchannels;
@@ -506,11 +936,35 @@ uint32_t BusNetwork::getPixelColor(uint16_t pix) {
 
 void BusNetwork::show() {
   if (!_valid || !canShow()) return;
+#ifdef WLED_NETBUS_TASK
+  if (_pending) {
+    // hand frame over to sender task, never wait for network
+    xSemaphoreTake(_frameLock, portMAX_DELAY);
+    if (_hasPending) _dropped++; // previous frame was not picked up yet, replace it
+    memcpy(_pending, _data, _len * _UDPchannels);
+    _pendingBri = _bri;
+    _hasPending = true;
+    xSemaphoreGive(_frameLock);
+    xTaskNotifyGive(_task);
+    return;
+  }
+#endif
   _broadcastLock = true;
+#ifdef WLED_NETBUS_TASK
+  // realtimeBroadcast() shares its packet buffer and socket with the sender task
+  if (_sendLock) xSemaphoreTake(_sendLock, portMAX_DELAY);
+#endif
   realtimeBroadcast(_UDPtype, _client, _len, _data, _bri, _rgbw);
+#ifdef WLED_NETBUS_TASK
+  if (_sendLock) xSemaphoreGive(_sendLock);
+#endif
   _broadcastLock = false;
 }
 
+uint32_t BusNetwork::getWireTime() {
+  return realtimeBroadcastTime(_UDPtype, _len, _rgbw);
+}
+
 uint8_t BusNetwork::getPins(uint8_t* pinArray) {
   for (uint8_t i = 0; i < 4; i++) {
     pinArray[i] = _client[i];
@@ -519,61 +973,243 @@ uint8_t BusNetwork::getPins(uint8_t* pinArray) {
 }
 
 void BusNetwork::cleanup() {
+#ifdef WLED_NETBUS_TASK
+  if (_pending) {
+    xSemaphoreTake(_sendLock, portMAX_DELAY); // wait until sender task is done with this bus
+    for (size_t i = 0; i < sizeof(_instances)/sizeof(_instances[0]); i++) if (_instances[i] == this) _instances[i] = nullptr;
+    xSemaphoreGive(_sendLock);
+  }
+  free(_pending); _pending = nullptr;
+  free(_sending); _sending = nullptr;
+  if (_frameLock) vSemaphoreDelete(_frameLock);
+  _frameLock = nullptr;
+#endif
   _type = I_NONE;
   _valid = false;
   freeData();
 }
 
 
-//utility to get the approx. memory usage of a given BusConfig
-uint32_t BusManager::memUsage(BusConfig &bc) {
+// heap a bus created from bc as bus number nr (drivers are assigned by number) will allocate, broken down into m if given
+// digital busses: buffers of the (NeoPixelBus) driver method, bus buffer (_data) and power tracking/dithering state
+uint32_t BusManager::memUsage(BusConfig &bc, uint8_t nr, bus_mem_t *m) {
+  bus_mem_t u = {0, 0, 0};
   uint8_t type = bc.type;
-  uint16_t len = bc.count + bc.skipAmount;
-  if (type > 15 && type < 32) { // digital types
-    if (type == TYPE_UCS8903 || type == TYPE_UCS8904) len *= 2; // 16-bit LEDs
-    #ifdef ESP8266
-      if (bc.pins[0] == 3) { //8266 DMA uses 5x the mem
-        if (type > 28) return len*20; //RGBW
-        return len*15;
+  if (IS_DIGITAL(type) && !(type >= TYPE_NET_DDP_RGB && type < 96)) {
+    uint8_t iType = PolyBus::getI(type, bc.pins, nr);
+    if (iType != I_NONE) { // else bus can't be created
+      const bool hasW = Bus::hasWhite(type);
+      const uint8_t channels = hasW + 3*Bus::hasRGB(type); // of _data: 3 bytes per pixel unless there is a white channel
+      uint8_t bpp = type > 28 && type < 32 ? 4 : 3; // bytes per pixel of NeoPixelBus feature
+      switch (type) {
+        case TYPE_UCS8903:  bpp = 6; break; // 16-bit LEDs
+        case TYPE_UCS8904:  bpp = 8; break;
+        case TYPE_APA102:
+        case TYPE_P9813:    bpp = 4; break;
+        case TYPE_LPD6803:  bpp = 2; break;
       }
-      if (type > 28) return len*4; //RGBW
-      return len*3;
-    #else //ESP32 RMT uses double buffer?
-      if (type > 28) return len*8; //RGBW
-      return len*6;
+      uint32_t pixels = type == TYPE_WS2812_1CH_X3 ? NUM_ICS_WS2812_1CH_3X(bc.count) : bc.count;
+      u.driver = (pixels + bc.skipAmount) * bpp * PolyBus::memFactor(iType);
+      #ifdef WLED_ENABLE_OUTPUT_GAMMA
+      bool buffered = true;
+      #else
+      bool buffered = bc.doubleBuffer || iType == I_32_DM_DOT_3;
+      #endif
+      if (buffered) u.buffer = bc.count * channels;
+      u.aux = bc.count; // power of each pixel
+      if (Bus::getDithering() && buffered) u.aux += bc.count * (3 + hasW); // dithering error (once frames are dithered)
+    }
+  } else if (type >= TYPE_NET_DDP_RGB && type < 96) {
+    u.buffer = bc.count * (type == TYPE_NET_DDP_RGBW ? 4 : 3);
+    #ifdef WLED_NETBUS_TASK
+    u.driver = 2 * u.buffer; // frame buffers of sender task
     #endif
   }
-  if (type > 31 && type < 48) return 5;
-  return len*3; //RGB
+  if (m) *m = u;
+  return u.driver + u.buffer + u.aux;
 }
 
-int BusManager::add(BusConfig &bc) {
-  if (getNumBusses() - getNumVirtualBusses() >= WLED_MAX_BUSSES) return -1;
+// creates bus number nr (drivers and channels are assigned by bus number)
+Bus* BusManager::createBus(BusConfig &bc, uint8_t nr) {
+  uint32_t heap = ESP.getFreeHeap(); // busses allocate their buffers (and NeoPixelBus its own) in the constructor
+  Bus *bus;
   if (bc.type >= TYPE_NET_DDP_RGB && bc.type < 96) {
-    busses[numBusses] = new BusNetwork(bc);
+    bus = new BusNetwork(bc);
   } else if (IS_DIGITAL(bc.type)) {
-    busses[numBusses] = new BusDigital(bc, numBusses, colorOrderMap);
+    bus = new BusDigital(bc, nr, colorOrderMap);
   } else if (bc.type == TYPE_ONOFF) {
-    busses[numBusses] = new BusOnOff(bc);
+    bus = new BusOnOff(bc);
   } else {
-    busses[numBusses] = new BusPwm(bc);
+    bus = new BusPwm(bc);
   }
-  return numBusses++;
+  uint32_t used = heap - ESP.getFreeHeap();
+  heapTrackAlloc(HEAP_TAG_BUS, used < heap ? used : 0, true); // invalid busses may also lack pins, not memory
+  configs[nr] = new BusConfig(bc);
+  return bus;
+}
+
+void BusManager::releaseBus(uint8_t nr) {
+  uint32_t heap = ESP.getFreeHeap();
+  delete busses[nr];
+  uint32_t released = ESP.getFreeHeap() - heap;
+  heapTrackFree(HEAP_TAG_BUS, released < heap ? released : 0);
+  delete configs[nr];
+  busses[nr] = nullptr;
+  configs[nr] = nullptr;
+}
+
+int BusManager::add(BusConfig &bc) {
+  if (getNumBusses() - getNumVirtualBusses() >= WLED_MAX_BUSSES) return -1;
+  busses[numBusses] = createBus(bc, numBusses);
+  numBusses++;
+  buildRoutes();
+  return numBusses - 1;
 }
 
 //do not call this method from system context (network callback)
 void BusManager::removeAll() {
   DEBUG_PRINTLN(F("Removing all."));
   //prevents crashes due to deleting busses while in use.
-  while (!canAllShow()) yield();
-  for (uint8_t i = 0; i < numBusses; i++) delete busses[i];
+  waitForAll();
+  for (uint8_t i = 0; i < numBusses; i++) releaseBus(i);
   numBusses = 0;
+  buildRoutes();
+}
+
+static bool sameOutput(const BusConfig &a, const BusConfig &b) {
+  return a.type == b.type && a.count == b.count && a.colorOrder == b.colorOrder && a.skipAmount == b.skipAmount
+      && a.refreshReq == b.refreshReq && !memcmp(a.pins, b.pins, sizeof(a.pins)) && a.frequency == b.frequency
+      && a.doubleBuffer == b.doubleBuffer && a.milliAmpsMax == b.milliAmpsMax;
+}
+
+// Replaces the bus configuration with cfgs[0..n-1] (in the same order add() would have been called), keeping every bus
+// whose output is configured exactly as before, together with its (NeoPixelBus/RMT/I2S) buffers and its current frame.
+// Only start, reversing and auto white mode of kept busses are updated. Busses are compared by number since drivers and
+// channels are assigned by number. relayout is set if the pixel layout (number, start or length of busses) changed.
+// Returns the number of busses created.
+int BusManager::reconfigure(BusConfig **cfgs, uint8_t n, bool &relayout) {
+  waitForAll();
+  const uint8_t oldNum = numBusses;
+  bool keep[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES];
+  if (n > WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES) n = WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES;
+  relayout = n != oldNum;
+  // release replaced busses first, so pins and channels are free for the new ones
+  for (uint8_t i = 0; i < oldNum; i++) {
+    keep[i] = i < n && busses[i]->isOk() && sameOutput(*configs[i], *cfgs[i]);
+    if (keep[i]) continue;
+    if (i >= n || configs[i]->start != cfgs[i]->start || configs[i]->count != cfgs[i]->count) relayout = true;
+    releaseBus(i);
+  }
+  int created = 0;
+  uint8_t physical = 0, i = 0;
+  for (; i < n; i++) {
+    BusConfig &bc = *cfgs[i];
+    bool isVirtual = bc.type >= TYPE_NET_DDP_RGB && bc.type < 96;
+    if (!isVirtual && physical >= WLED_MAX_BUSSES) break; // as add() would refuse it
+    if (!isVirtual) physical++;
+    if (i < oldNum && keep[i]) {
+      Bus *bus = busses[i];
+      if (bus->getStart() != bc.start) { bus->setStart(bc.start); relayout = true; }
+      bus->setReversed(bc.reversed);
+      if (Bus::hasWhite(bc.type)) bus->setAutoWhiteMode(bc.autoWhite);
+      *configs[i] = bc;
+    } else {
+      busses[i] = createBus(bc, i);
+      created++;
+    }
+  }
+  for (uint8_t j = i; j < oldNum; j++) if (keep[j]) { releaseBus(j); relayout = true; } // beyond the bus limit
+  numBusses = i;
+  buildRoutes();
+  DEBUG_PRINTF("Busses reconfigured: %d of %u created.\n", created, numBusses);
+  return created;
+}
+
+// sorts busses by their start so a pixel's bus can be found without scanning all busses
+void BusManager::buildRoutes() {
+  lastRoute = 0;
+  overlapping = false;
+  for (uint8_t i = 0; i < numBusses; i++) {
+    // insertion sort, there are only a few busses
+    Bus *b = busses[i];
+    int j = i;
+    for (; j > 0 && routes[j-1]->getStart() > b->getStart(); j--) routes[j] = routes[j-1];
+    routes[j] = b;
+  }
+  for (uint8_t i = 1; i < numBusses; i++) {
+    if (routes[i-1]->getStart() + routes[i-1]->getLength() > routes[i]->getStart()) overlapping = true;
+  }
+}
+
+// returns bus containing pixel or nullptr (only valid if busses do not overlap)
+Bus* IRAM_ATTR BusManager::findBus(uint16_t pix) {
+  if (numBusses == 0) return nullptr;
+  uint8_t r = lastRoute; // may be used concurrently, only read once
+  if (r < numBusses && routes[r]->containsPixel(pix)) return routes[r];
+  // binary search for last bus starting at or before pix
+  int lo = 0, hi = numBusses - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) >> 1;
+    if (routes[mid]->getStart() <= pix) lo = mid;
+    else                                hi = mid - 1;
+  }
+  if (!routes[lo]->containsPixel(pix)) return nullptr;
+  lastRoute = lo;
+  return routes[lo];
 }
 
 void BusManager::show() {
+  waitTime = 0;
+  for (uint8_t i = 0; i < numBusses; i++) {
+    Bus *b = busses[i];
+    // skip busses whose content did not change (some types need refresh to remain off)
+    if (!b->frameChanged(keepAlive) && !b->isOffRefreshRequired() && !b->isDithering()) continue;
+    // driver would block in show() until previous frame is sent: wait here so it can be accounted for
+    if (!b->canShow()) {
+      uint32_t t = micros();
+      while (!b->canShow()) yield();
+      waitTime += micros() - t;
+    }
+    uint32_t sent = b->getSentTime();
+    uint32_t done = b->getDoneTime(); // record completion of previous frame
+    b->markSent();
+    #ifndef WLED_DISABLE_TRACE
+    if (traceOn) {
+      if (sent && done != sent && done - sent < 1000000UL) traceRecord(TRACE_BUS_DONE, i, 0, sent, done - sent); // previous frame was seen complete
+      uint32_t start = b->getSentTime();
+      b->show();
+      traceRecord(TRACE_BUS, i, 0, start, micros() - start);
+      continue;
+    }
+    #endif
+    b->show();
+  }
+}
+
+bool BusManager::isBusy() {
+  return !canAllShow();
+}
+
+uint32_t BusManager::waitForAll() {
+  uint32_t t = micros();
+  while (!canAllShow()) yield();
+  for (uint8_t i = 0; i < numBusses; i++) busses[i]->getDoneTime();
+  return micros() - t;
+}
+
+// drivers are polled for completion (NeoPixelBus does not report it), time left is predicted from wire time
+uint32_t BusManager::getBusyTime() {
+  uint32_t busy = 0;
+  uint32_t now = micros();
   for (uint8_t i = 0; i < numBusses; i++) {
-    busses[i]->show();
+    Bus *b = busses[i];
+    if (!b->isInFlight()) continue;
+    uint32_t elapsed = now - b->getSentTime();
+    uint32_t wire = b->getWireTime();
+    uint32_t left = wire > elapsed ? wire - elapsed : 1; // late, completion is expected any moment
+    if (left > busy) busy = left;
   }
+  return busy;
 }
 
 void BusManager::setStatusPixel(uint32_t c) {
@@ -583,20 +1219,63 @@ void BusManager::setStatusPixel(uint32_t c) {
 }
 
 void IRAM_ATTR BusManager::setPixelColor(uint16_t pix, uint32_t c) {
+  if (!overlapping) {
+    Bus *b = findBus(pix);
+    if (b) { b->setPixelColor(pix - b->getStart(), c); b->hashPixel(pix, c); }
+    return;
+  }
+  // overlapping busses (same pixels sent to multiple outputs) need all of them updated
   for (uint8_t i = 0; i < numBusses; i++) {
     Bus* b = busses[i];
     uint16_t bstart = b->getStart();
     if (pix < bstart || pix >= bstart + b->getLength()) continue;
-    busses[i]->setPixelColor(pix - bstart, c);
+    b->setPixelColor(pix - bstart, c);
+    b->hashPixel(pix, c);
+  }
+}
+
+// writes a contiguous run of pixels, splitting it at bus boundaries
+void IRAM_ATTR BusManager::setPixelColors(uint16_t pix, uint16_t count, const uint32_t *c) {
+  if (overlapping) {
+    for (unsigned i = 0; i < count; i++) setPixelColor(pix + i, c[i]);
+    return;
+  }
+  while (count) {
+    Bus *b = findBus(pix);
+    unsigned n = 1; // skip pixel not belonging to any bus
+    if (b) {
+      n = b->getStart() + b->getLength() - pix;
+      if (n > count) n = count;
+      b->setPixelColors(pix - b->getStart(), n, c);
+      for (unsigned i = 0; i < n; i++) b->hashPixel(pix + i, c[i]);
+    }
+    pix += n;
+    c += n;
+    count -= n;
   }
 }
 
-void BusManager::setBrightness(uint8_t b) {
+void BusManager::updateColorOrderMap(const ColorOrderMap &com) {
+  memcpy(&colorOrderMap, &com, sizeof(ColorOrderMap));
+  for (uint8_t i = 0; i < numBusses; i++) busses[i]->updateColorOrder();
+}
+
+void BusManager::setBrightness(uint8_t b, bool repaint) {
   for (uint8_t i = 0; i < numBusses; i++) {
-    busses[i]->setBrightness(b);
+    busses[i]->setBrightness(b, repaint);
   }
 }
 
+void Bus::setCCT(int16_t cct) {
+  static int16_t balanced = -1;
+  _cct = cct;
+  if (cct < 1900 || cct == balanced) return;
+  byte rgb[4];
+  colorKtoBalance(cct, rgb); // LUT, segments usually have only a few distinct CCTs
+  memcpy(_cctBal, rgb, 3);
+  balanced = cct;
+}
+
 void BusManager::setSegmentCCT(int16_t cct, bool allowWBCorrection) {
   if (cct > 255) cct = 255;
   if (cct >= 0) {
@@ -606,7 +1285,11 @@ void BusManager::setSegmentCCT(int16_t cct, bool allowWBCorrection) {
   Bus::setCCT(cct);
 }
 
-uint32_t BusManager::getPixelColor(uint16_t pix) {
+uint32_t WLED_HOT(BusManager_getPixelColor) BusManager::getPixelColor(uint16_t pix) {
+  if (!overlapping) {
+    Bus *b = findBus(pix);
+    return b ? b->getPixelColor(pix - b->getStart()) : 0;
+  }
   for (uint8_t i = 0; i < numBusses; i++) {
     Bus* b = busses[i];
     uint16_t bstart = b->getStart();
@@ -635,7 +1318,33 @@ uint16_t BusManager::getTotalLength() {
   return len;
 }
 
+// returns true if bus needs to be sent: pixels written since last check differ from last frame sent,
+// brightness changed or keep-alive interval elapsed (receivers and LEDs may need periodic refresh)
+uint32_t Bus::getDoneTime() {
+  if (_inFlight && canShow()) {
+    _doneAt = micros();
+    _inFlight = false;
+  }
+  return _doneAt;
+}
+
+bool Bus::frameChanged(uint16_t keepAlive) {
+  uint32_t hash = _frameHash ^ _bri;
+  _frameHash = BUS_HASH_SEED;
+  unsigned long now = millis();
+  if (keepAlive && hash == _shownHash && now - _lastShown < keepAlive) return false;
+  _shownHash = hash;
+  _lastShown = now;
+  return true;
+}
+
 // Bus static member definition
 int16_t Bus::_cct = -1;
+uint8_t Bus::_cctBal[3] = {255, 255, 255};
 uint8_t Bus::_cctBlend = 0;
+bool    Bus::_powerMaxRGB = false;
+bool    Bus::_dithering = false;
+#ifdef ARDUINO_ARCH_ESP32
+bool    BusPwm::_fadeInstalled = false;
+#endif
 uint8_t Bus::_gAWM = 255;
@@ -18,10 +18,22 @@
 #define IC_INDEX_WS2812_2CH_3X(i)  ((i)*2/3)
 #define WS2812_2CH_3X_SPANS_2_ICS(i) ((i)&0x01)    // every other LED zone is on two different ICs
 
+// temporal dithering is only used while busses are refreshed at least this often (us), slower rates would flicker visibly
+#ifndef WLED_DITHER_MAX_INTERVAL
+  #define WLED_DITHER_MAX_INTERVAL 10000
+#endif
+
 // flag for using double buffering in BusDigital
 extern bool useGlobalLedBuffer;
 
 
+// heap allocated by a bus (BusManager::memUsage())
+typedef struct bus_mem_t {
+  uint32_t driver; // NeoPixelBus method or network sender buffers
+  uint32_t buffer; // bus buffer (_data)
+  uint32_t aux;    // power tracking, dithering
+} bus_mem_t;
+
 //temporary struct for passing bus configuration to bus
 struct BusConfig {
   uint8_t type;
@@ -35,8 +47,9 @@ struct BusConfig {
   uint8_t pins[5] = {LEDPIN, 255, 255, 255, 255};
   uint16_t frequency;
   bool doubleBuffer;
+  uint16_t milliAmpsMax; // current limit of bus' own power supply (0 = bus shares global ABL budget)
 
-  BusConfig(uint8_t busType, uint8_t* ppins, uint16_t pstart, uint16_t len = 1, uint8_t pcolorOrder = COL_ORDER_GRB, bool rev = false, uint8_t skip = 0, byte aw=RGBW_MODE_MANUAL_ONLY, uint16_t clock_kHz=0U, bool dblBfr=false)
+  BusConfig(uint8_t busType, uint8_t* ppins, uint16_t pstart, uint16_t len = 1, uint8_t pcolorOrder = COL_ORDER_GRB, bool rev = false, uint8_t skip = 0, byte aw=RGBW_MODE_MANUAL_ONLY, uint16_t clock_kHz=0U, bool dblBfr=false, uint16_t maMax=0)
   : count(len)
   , start(pstart)
   , colorOrder(pcolorOrder)
@@ -45,6 +58,7 @@ struct BusConfig {
   , autoWhite(aw)
   , frequency(clock_kHz)
   , doubleBuffer(dblBfr)
+  , milliAmpsMax(maMax)
   {
     refreshReq = (bool) GET_BIT(busType,7);
     type = busType & 0x7F;  // bit 7 may be/is hacked to include refresh info (1=refresh in off state, 0=no refresh)
@@ -58,7 +72,7 @@ struct BusConfig {
   //validates start and length and extends total if needed
   bool adjustBounds(uint16_t& total) {
     if (!count) count = 1;
-    if (count > MAX_LEDS_PER_BUS) count = MAX_LEDS_PER_BUS;
+    if (count > MAX_LEDS_PER_BUS && type != TYPE_NET_DDP_TILES) count = MAX_LEDS_PER_BUS; // tiles bus may span the whole canvas
     if (start >= MAX_LEDS) return false;
     //limit length of strip if it would exceed total permissible LEDs
     if (start + count > MAX_LEDS) count = MAX_LEDS - start;
@@ -101,6 +115,8 @@ struct ColorOrderMap {
 };
 
 
+#define BUS_HASH_SEED 2166136261U
+
 //parent class of BusDigital, BusPwm, and BusNetwork
 class Bus {
   public:
@@ -113,6 +129,12 @@ class Bus {
     , _valid(false)
     , _needsRefresh(refresh)
     , _data(nullptr) // keep data access consistent across all types of buses
+    , _frameHash(BUS_HASH_SEED)
+    , _shownHash(0)
+    , _lastShown(0)
+    , _sentAt(0)
+    , _doneAt(0)
+    , _inFlight(false)
     {
       _autoWhiteMode = Bus::hasWhite(type) ? aw : RGBW_MODE_MANUAL_ONLY;
     };
@@ -123,15 +145,21 @@ class Bus {
     virtual bool     canShow()                   { return true; }
     virtual void     setStatusPixel(uint32_t c)  {}
     virtual void     setPixelColor(uint16_t pix, uint32_t c) = 0;
+    virtual void     setPixelColors(uint16_t pix, uint16_t count, const uint32_t *c) { for (unsigned i = 0; i < count; i++) setPixelColor(pix + i, c[i]); } // contiguous run of pixels
     virtual uint32_t getPixelColor(uint16_t pix) { return 0; }
-    virtual void     setBrightness(uint8_t b)    { _bri = b; };
+    virtual void     setBrightness(uint8_t b, bool repaint = true) { _bri = b; };
     virtual void     cleanup() = 0;
     virtual uint8_t  getPins(uint8_t* pinArray)  { return 0; }
     virtual uint16_t getLength()                 { return _len; }
     virtual void     setColorOrder()             {}
+    virtual void     updateColorOrder()          {} // color order map changed
     virtual uint8_t  getColorOrder()             { return COL_ORDER_RGB; }
     virtual uint8_t  skippedLeds()               { return 0; }
     virtual uint16_t getFrequency()              { return 0U; }
+    virtual uint16_t getMaxCurrent()             { return 0U; } // mA of bus' own power supply, 0 if it shares global budget
+    virtual uint32_t getWireTime()               { return 0U; } // minimum time to send a frame (us), 0 if output does not limit frame rate
+    virtual uint32_t getPowerUnits();            // sum of channel values of all pixels at full brightness (for ABL)
+    inline  uint8_t  getBrightness()             { return _bri; }
     inline  void     setReversed(bool reversed)  { _reversed = reversed; }
     inline  uint16_t getStart()                  { return _start; }
     inline  void     setStart(uint16_t start)    { _start = start; }
@@ -140,6 +168,14 @@ class Bus {
     inline  bool     isReversed()                { return _reversed; }
     inline  bool     isOffRefreshRequired()      { return _needsRefresh; }
             bool     containsPixel(uint16_t pix) { return pix >= _start && pix < _start+_len; }
+    inline  void     hashPixel(uint16_t pix, uint32_t c) { _frameHash = (_frameHash ^ c ^ (uint32_t(pix) << 20) ^ uint16_t(_cct)) * 16777619U; } // FNV-1a like
+            bool     frameChanged(uint16_t keepAlive);
+    // output completion tracking (micros() timestamps), maintained by BusManager::show()
+    inline  void     markSent()                  { _sentAt = micros(); _inFlight = true; }
+    inline  uint32_t getSentTime() const         { return _sentAt; }
+            uint32_t getDoneTime();              // when last frame was seen completed (upper bound unless it was waited for)
+    inline  bool     isInFlight()                { return _inFlight && !canShow(); }
+    virtual bool     isDithering()               { return false; } // unchanged frames still need to be shown
 
     virtual bool hasRGB(void) { return Bus::hasRGB(_type); }
     static  bool hasRGB(uint8_t type) {
@@ -159,9 +195,8 @@ class Bus {
           type == TYPE_ANALOG_2CH    || type == TYPE_ANALOG_5CH) return true;
       return false;
     }
-    static void setCCT(uint16_t cct) {
-      _cct = cct;
-    }
+    static  bool is16bit(uint8_t type)  { return type == TYPE_UCS8903 || type == TYPE_UCS8904; }
+    static void setCCT(int16_t cct); // also prepares white balance multipliers, called once for each segment and frame
     static void setCCTBlend(uint8_t b) {
       if (b > 100) b = 100;
       _cctBlend = (b * 127) / 100;
@@ -174,6 +209,15 @@ class Bus {
     inline        uint8_t getAutoWhiteMode()          { return _autoWhiteMode; }
     inline static void    setGlobalAWMode(uint8_t m)  { if (m < 5) _gAWM = m; else _gAWM = AW_GLOBAL_DISABLED; }
     inline static uint8_t getGlobalAWMode()           { return _gAWM; }
+    inline        uint8_t getWhiteMode() const        { return _gAWM != AW_GLOBAL_DISABLED ? _gAWM : _autoWhiteMode; } // auto white mode in effect
+    inline static void    setPowerModelMaxRGB(bool m) { _powerMaxRGB = m; } // WS2815 power model: only brightest RGB channel counts
+    inline static void    setDithering(bool d)        { _dithering = d; }
+    inline static bool    getDithering()              { return _dithering; }
+    static inline uint16_t pixelPower(uint32_t c) {
+      uint8_t r = c >> 16, g = c >> 8, b = c, w = c >> 24;
+      if (_powerMaxRGB) return (r > g ? (r > b ? r : b) : (g > b ? g : b)) * 3;
+      return r + g + b + w;
+    }
 
   protected:
     uint8_t  _type;
@@ -184,12 +228,31 @@ class Bus {
     bool     _valid;
     bool     _needsRefresh;
     uint8_t  _autoWhiteMode;
+    // pixel buffer owned by the bus (nullptr: pixels live only in the driver buffer, e.g. NeoPixelBus, brightness applied)
+    // digital busses have one only if double buffered (or if the output needs the original colors); show() converts it
+    // into the driver buffer. Copy it to a local pointer before writing through it: stores through uint8_t* may alias
+    // *this, so the compiler would otherwise reload _data (and every other member used) after each single byte written
     uint8_t  *_data;
+    uint32_t _frameHash;  // hash of pixels written since last show
+    uint32_t _shownHash;  // hash of last frame sent
+    unsigned long _lastShown;
+    uint32_t _sentAt;     // micros() when last frame was handed to driver
+    uint32_t _doneAt;     // micros() when driver was first seen idle afterwards
+    bool     _inFlight;   // completion of last frame not observed yet
     static uint8_t _gAWM;
     static int16_t _cct;
+    static uint8_t _cctBal[3]; // white balance multipliers of _cct (if >= 1900)
     static uint8_t _cctBlend;
-
-    uint32_t autoWhiteCalc(uint32_t c);
+    static bool    _powerMaxRGB;
+    static bool    _dithering;
+
+    static uint32_t autoWhiteCalc(uint32_t c, uint8_t aWM);
+    inline uint32_t autoWhiteCalc(uint32_t c) { return autoWhiteCalc(c, getWhiteMode()); }
+    // x / 255 as (x + 1 + (x >> 8)) >> 8, exact for products of two bytes
+    static inline uint32_t balanceCCT(uint32_t c) {
+      uint_fast16_t r = _cctBal[0] * uint8_t(c >> 16), g = _cctBal[1] * uint8_t(c >> 8), b = _cctBal[2] * uint8_t(c);
+      return (c & 0xFF000000) | ((r + 1 + (r >> 8)) >> 8 << 16) | ((g + 1 + (g >> 8)) >> 8 << 8) | ((b + 1 + (b >> 8)) >> 8);
+    }
     uint8_t *allocData(size_t size = 1);
     void     freeData() { if (_data != nullptr) free(_data); _data = nullptr; }
 };
@@ -202,15 +265,21 @@ class BusDigital : public Bus {
 
     void show();
     bool canShow();
-    void setBrightness(uint8_t b);
+    void setBrightness(uint8_t b, bool repaint = true);
     void setStatusPixel(uint32_t c);
     void setPixelColor(uint16_t pix, uint32_t c);
+    void setPixelColors(uint16_t pix, uint16_t count, const uint32_t *c);
     void setColorOrder(uint8_t colorOrder);
+    void updateColorOrder();
     uint32_t getPixelColor(uint16_t pix);
     uint8_t  getColorOrder() { return _colorOrder; }
     uint8_t  getPins(uint8_t* pinArray);
     uint8_t  skippedLeds()   { return _skip; }
     uint16_t getFrequency()  { return _frequencykHz; }
+    uint16_t getMaxCurrent() { return _milliAmpsMax; }
+    uint32_t getWireTime();
+    uint32_t getPowerUnits();
+    bool     isDithering()   { return _ditherOn; }
     void reinit();
     void cleanup();
 
@@ -222,7 +291,41 @@ class BusDigital : public Bus {
     uint16_t _frequencykHz;
     void * _busPtr;
     const ColorOrderMap &_colorOrderMap;
-    bool _buffering; // temporary until we figure out why comparison "_data != nullptr" causes severe FPS drop
+    uint16_t _milliAmpsMax;
+    uint8_t _busColorOrder; // color order of whole bus if it resolves to a single one (255 = use _coSpans)
+    struct ColorOrderSpan {
+      uint16_t end;         // first pixel (bus index) past this span
+      uint8_t  colorOrder;
+    } _coSpans[2*WLED_MAX_COLOR_ORDER_MAPPINGS+1]; // color order map compiled for this bus, sorted by pixel
+    uint8_t _coSpanCount;
+    uint8_t _coSpanLast;    // last span hit, pixels are mostly accessed sequentially
+    bool _wireCapable;      // bus buffer can be written directly (plain 8 bit GRB/GRBW feature, double buffered)
+    uint8_t _wireOrder;     // color order _data is stored in, in wire order of the bus (255 = RGBW order, converted in show())
+    uint8_t *_pixPower;  // pixelPower()/4 of each pixel as last written, avoids reading back all pixels for ABL
+    uint32_t _powerSum;  // sum of _pixPower[]
+    uint8_t *_ditherErr; // fractional part of each channel not yet shown (temporal dithering)
+    uint32_t _lastShowAt;
+    uint16_t _showInterval; // smoothed time between frames (us)
+    bool     _ditherOn;
+
+    bool ditherActive(bool exact);
+
+    // pix is pixel index on bus (before reversing and skipping)
+    inline uint8_t colorOrderAt(uint16_t pix) {
+      return _busColorOrder != 255 ? _busColorOrder : spanColorOrder(pix);
+    }
+    uint8_t spanColorOrder(uint16_t pix);
+    void    compileColorOrder();
+
+    inline void trackPower(uint16_t pix, uint32_t c) {
+      if (!_pixPower || pix >= _len) return;
+      if (!Bus::hasRGB(_type)) c = (c >> 24) * 0x01010101U; // white in all channels, same as getPixelColor() returns
+      uint8_t p = pixelPower(c) >> 2;
+      _powerSum += p - _pixPower[pix];
+      _pixPower[pix] = p;
+    }
+
+    void recodeData(uint8_t fromOrder, uint8_t toOrder);
 
     inline uint32_t restoreColorLossy(uint32_t c, uint8_t restoreBri) {
       if (restoreBri < 255) {
@@ -254,7 +357,10 @@ class BusPwm : public Bus {
     uint8_t _pwmdata[5];
     #ifdef ARDUINO_ARCH_ESP32
     uint8_t _ledcStart;
+    uint32_t _lastShow;   // millis() of last frame, fades are used for frames in quick succession
+    static bool _fadeInstalled;
     #endif
+    uint8_t  _depth;      // PWM resolution (bits)
     uint16_t _frequency;
 
     void deallocatePins();
@@ -278,6 +384,10 @@ class BusOnOff : public Bus {
 };
 
 
+#if defined(ARDUINO_ARCH_ESP32) && !defined(WLED_DISABLE_NETBUS_TASK)
+  #define WLED_NETBUS_TASK // network busses are sent by a separate task, show() only hands frames over
+#endif
+
 class BusNetwork : public Bus {
   public:
     BusNetwork(BusConfig &bc);
@@ -287,10 +397,13 @@ class BusNetwork : public Bus {
     bool hasWhite() { return _rgbw; }
     bool canShow()  { return !_broadcastLock; } // this should be a return value from UDP routine if it is still sending data out
     void setPixelColor(uint16_t pix, uint32_t c);
+    void setPixelColors(uint16_t pix, uint16_t count, const uint32_t *c);
     uint32_t getPixelColor(uint16_t pix);
     uint8_t  getPins(uint8_t* pinArray);
+    uint32_t getWireTime();
     void show();
     void cleanup();
+    inline uint32_t getDroppedFrames() const { return _dropped; } // frames replaced by a newer one before they were sent
 
   private:
     IPAddress _client;
@@ -298,26 +411,48 @@ class BusNetwork : public Bus {
     uint8_t   _UDPchannels;
     bool      _rgbw;
     bool      _broadcastLock;
+    uint32_t  _dropped;
+#ifdef WLED_NETBUS_TASK
+    uint8_t  *_pending;        // newest frame handed over by show(), waiting for sender task
+    uint8_t  *_sending;        // frame being sent by sender task
+    uint8_t   _pendingBri;
+    uint8_t   _sendingBri;
+    bool      _hasPending;
+    SemaphoreHandle_t _frameLock; // protects _pending/_hasPending, only held for copying a frame or swapping buffers
+
+    static TaskHandle_t      _task;
+    static SemaphoreHandle_t _sendLock; // held while sending (sender task or synchronous fallback), busses are not removed meanwhile
+    static BusNetwork       *_instances[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES];
+    static void senderTask(void *parameter);
+    void sendPending();
+#endif
 };
 
 
 class BusManager {
   public:
-    BusManager() : numBusses(0) {};
+    BusManager() : numBusses(0), lastRoute(0), overlapping(false), keepAlive(1000), waitTime(0) {};
 
-    //utility to get the approx. memory usage of a given BusConfig
-    static uint32_t memUsage(BusConfig &bc);
+    // heap used by a bus created from bc as bus number nr
+    static uint32_t memUsage(BusConfig &bc, uint8_t nr = 0, bus_mem_t *m = nullptr);
 
     int add(BusConfig &bc);
 
     //do not call this method from system context (network callback)
     void removeAll();
-
-    void show();
+    // applies a new set of bus configurations, see implementation (do not call from system context either)
+    int reconfigure(BusConfig **cfgs, uint8_t n, bool &relayout);
+
+    void show();     // returns as soon as all busses started sending (DMA/RMT busses are still in flight)
+    bool isBusy();   // any bus still sending its last frame
+    uint32_t waitForAll(); // blocks until all busses finished sending, returns time waited (us)
+    uint32_t getBusyTime(); // predicted time until all busses finished sending (us), 0 if all are idle
+    inline uint32_t getWaitTime() const { return waitTime; } // time last show() waited for busses still sending the previous frame (us)
     bool canAllShow();
     void setStatusPixel(uint32_t c);
     void setPixelColor(uint16_t pix, uint32_t c);
-    void setBrightness(uint8_t b);
+    void setPixelColors(uint16_t pix, uint16_t count, const uint32_t *c);
+    void setBrightness(uint8_t b, bool repaint = true); // repaint: rescale pixels already in bus buffers
     void setSegmentCCT(int16_t cct, bool allowWBCorrection = false);
     uint32_t getPixelColor(uint16_t pix);
 
@@ -327,14 +462,31 @@ class BusManager {
     uint16_t getTotalLength();
     inline uint8_t getNumBusses() const { return numBusses; }
 
-    inline void                 updateColorOrderMap(const ColorOrderMap &com) { memcpy(&colorOrderMap, &com, sizeof(ColorOrderMap)); }
+    // unchanged frames are not sent again until keep-alive interval (ms) elapses (0 = always send)
+    inline void     setKeepAlive(uint16_t ms) { keepAlive = ms; }
+    inline uint16_t getKeepAlive() const      { return keepAlive; }
+
+    void                        updateColorOrderMap(const ColorOrderMap &com);
     inline const ColorOrderMap& getColorOrderMap() const { return colorOrderMap; }
 
   private:
     uint8_t numBusses;
     Bus* busses[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES];
+    BusConfig* configs[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES]; // each bus was created from, for reconfigure()
     ColorOrderMap colorOrderMap;
 
+    // pixel to bus routing: busses sorted by start, last hit is cached (pixels are usually written sequentially)
+    Bus* routes[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES];
+    uint8_t lastRoute;
+    bool overlapping; // at least one pixel is shared by multiple busses, routing table cannot be used
+    uint16_t keepAlive;
+    uint32_t waitTime;
+
+    void buildRoutes();
+    Bus* findBus(uint16_t pix);
+    Bus* createBus(BusConfig &bc, uint8_t nr);
+    void releaseBus(uint8_t nr);
+
     inline uint8_t getNumVirtualBusses() {
       int j = 0;
       for (int i=0; i<numBusses; i++) if (busses[i]->getType() >= TYPE_NET_DDP_RGB && busses[i]->getType() < 96) j++;
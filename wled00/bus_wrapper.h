@@ -18,6 +18,25 @@
 #endif
 // temporary end
 
+// parallel output: ESP32 drives up to 8 strips from I2S1 in 8 bit parallel mode, ESP32-S3 from LCD peripheral
+// all strips on the parallel bus are sent with a single DMA transfer (at most as long as the longest strip)
+#if defined(WLED_USE_PARALLEL_I2S) && defined(ARDUINO_ARCH_ESP32)
+  #if defined(CONFIG_IDF_TARGET_ESP32S3)
+    #define WLED_PARALLEL_PIXELBUS
+  #elif !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
+    #define WLED_PARALLEL_PIXELBUS
+    #ifndef WLED_NO_I2S1_PIXELBUS
+    #define WLED_NO_I2S1_PIXELBUS // I2S1 is used by parallel output
+    #endif
+  #endif
+#endif
+#define WLED_PARALLEL_STRIPS 8  // number of strips on parallel bus
+
+// APA102 on the hardware SPI bus of classic ESP32 is sent by DMA (CPU is free while the frame is clocked out)
+#if defined(ARDUINO_ARCH_ESP32) && !defined(WLED_DISABLE_SPI_DMA) && !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32S3) && !defined(CONFIG_IDF_TARGET_ESP32C3)
+  #define WLED_SPI_DMA_PIXELBUS
+#endif
+
 //Hardware SPI Pins
 #define P_8266_HS_MOSI 13
 #define P_8266_HS_CLK  14
@@ -99,6 +118,11 @@
 #define I_32_RN_UCS_4 60
 #define I_32_I0_UCS_4 61
 #define I_32_I1_UCS_4 62
+//parallel I2S/LCD (WS281x & SK6812 timing only)
+#define I_32_PX_NEO_3 63
+#define I_32_PX_NEO_4 64
+//APA102 via DMA SPI, dimmed by global brightness field
+#define I_32_DM_DOT_3 65
 //Bit Bang theoratically possible, but very undesirable and not needed (no pin restrictions on RMT and I2S)
 
 //APA102
@@ -228,6 +252,16 @@
 #ifndef WLED_NO_I2S1_PIXELBUS
 #define B_32_I1_UCS_4 NeoPixelBusLg<NeoRgbwUcs8904Feature, NeoEsp32I2s1800KbpsMethod, NeoGammaNullMethod>
 #endif
+//parallel output (all strips must use the same timing)
+#ifdef WLED_PARALLEL_PIXELBUS
+  #ifdef CONFIG_IDF_TARGET_ESP32S3
+#define B_32_PX_NEO_3 NeoPixelBusLg<NeoGrbFeature, NeoEsp32LcdX8Ws2812xMethod, NeoGammaNullMethod>
+#define B_32_PX_NEO_4 NeoPixelBusLg<NeoGrbwFeature, NeoEsp32LcdX8Ws2812xMethod, NeoGammaNullMethod>
+  #else
+#define B_32_PX_NEO_3 NeoPixelBusLg<NeoGrbFeature, NeoEsp32I2s1X8Ws2812xMethod, NeoGammaNullMethod>
+#define B_32_PX_NEO_4 NeoPixelBusLg<NeoGrbwFeature, NeoEsp32I2s1X8Ws2812xMethod, NeoGammaNullMethod>
+  #endif
+#endif
 //Bit Bang theoratically possible, but very undesirable and not needed (no pin restrictions on RMT and I2S)
 
 #endif
@@ -240,6 +274,14 @@
 #define B_HS_DOT_3 NeoPixelBusLg<DotStarBgrFeature, DotStarSpiHzMethod, NeoGammaNullMethod> //hardware VSPI
 #endif
 #define B_SS_DOT_3 NeoPixelBusLg<DotStarBgrFeature, DotStarMethod, NeoGammaNullMethod>    //soft SPI
+#ifdef WLED_SPI_DMA_PIXELBUS
+// W of RgbwColor is the 5 bit global brightness, luminance of NeoPixelBusLg is not used (kept at 255)
+#ifdef WLED_USE_ETHERNET
+#define B_32_DM_DOT_3 NeoPixelBusLg<DotStarLbgrFeature, DotStarEsp32DmaHspiHzMethod, NeoGammaNullMethod>
+#else
+#define B_32_DM_DOT_3 NeoPixelBusLg<DotStarLbgrFeature, DotStarEsp32DmaVspiHzMethod, NeoGammaNullMethod>
+#endif
+#endif
 
 //LPD8806
 #define B_HS_LPD_3 NeoPixelBusLg<Lpd8806GrbFeature, Lpd8806SpiHzMethod, NeoGammaNullMethod>
@@ -379,6 +421,13 @@ class PolyBus {
       case I_32_I1_UCS_4: (static_cast<B_32_I1_UCS_4*>(busPtr))->Begin(); break;
       #endif
 //      case I_32_BB_UCS_4: (static_cast<B_32_BB_UCS_4*>(busPtr))->Begin(); break;
+      #ifdef WLED_PARALLEL_PIXELBUS
+      case I_32_PX_NEO_3: (static_cast<B_32_PX_NEO_3*>(busPtr))->Begin(); break;
+      case I_32_PX_NEO_4: (static_cast<B_32_PX_NEO_4*>(busPtr))->Begin(); break;
+      #endif
+      #ifdef WLED_SPI_DMA_PIXELBUS
+      case I_32_DM_DOT_3: beginDotStar<B_32_DM_DOT_3*>(busPtr, pins[1], -1, pins[0], -1, clock_kHz); break;
+      #endif
       // ESP32 can (and should, to avoid inadvertently driving the chip select signal) specify the pins used for SPI, but only in begin()
       case I_HS_DOT_3: beginDotStar<B_HS_DOT_3*>(busPtr, pins[1], -1, pins[0], -1, clock_kHz); break;
       case I_HS_LPD_3: beginDotStar<B_HS_LPD_3*>(busPtr, pins[1], -1, pins[0], -1, clock_kHz); break;
@@ -479,6 +528,13 @@ class PolyBus {
       case I_32_I1_UCS_4: busPtr = new B_32_I1_UCS_4(len, pins[0]); break;
       #endif
 //      case I_32_BB_UCS_4: busPtr = new B_32_BB_UCS_4(len, pins[0], (NeoBusChannel)channel); break;
+      #ifdef WLED_PARALLEL_PIXELBUS
+      case I_32_PX_NEO_3: busPtr = new B_32_PX_NEO_3(len, pins[0]); break;
+      case I_32_PX_NEO_4: busPtr = new B_32_PX_NEO_4(len, pins[0]); break;
+      #endif
+      #ifdef WLED_SPI_DMA_PIXELBUS
+      case I_32_DM_DOT_3: busPtr = new B_32_DM_DOT_3(len, pins[1], pins[0]); break;
+      #endif
     #endif
       // for 2-wire: pins[1] is clk, pins[0] is dat.  begin expects (len, clk, dat)
       case I_HS_DOT_3: busPtr = new B_HS_DOT_3(len, pins[1], pins[0]); break;
@@ -580,6 +636,13 @@ class PolyBus {
       case I_32_I1_UCS_4: (static_cast<B_32_I1_UCS_4*>(busPtr))->Show(consistent); break;
       #endif
 //      case I_32_BB_UCS_4: (static_cast<B_32_BB_UCS_4*>(busPtr))->Show(consistent); break;
+      #ifdef WLED_PARALLEL_PIXELBUS
+      case I_32_PX_NEO_3: (static_cast<B_32_PX_NEO_3*>(busPtr))->Show(consistent); break;
+      case I_32_PX_NEO_4: (static_cast<B_32_PX_NEO_4*>(busPtr))->Show(consistent); break;
+      #endif
+      #ifdef WLED_SPI_DMA_PIXELBUS
+      case I_32_DM_DOT_3: (static_cast<B_32_DM_DOT_3*>(busPtr))->Show(consistent); break;
+      #endif
     #endif
       case I_HS_DOT_3: (static_cast<B_HS_DOT_3*>(busPtr))->Show(consistent); break;
       case I_SS_DOT_3: (static_cast<B_SS_DOT_3*>(busPtr))->Show(consistent); break;
@@ -594,6 +657,66 @@ class PolyBus {
     }
   }
 
+  // pixel buffer (in wire order, without luminance applied) of busses using plain 8 bit GRB/GRBW features, nullptr for others
+  // buffer is marked dirty as caller is expected to write into it before show()
+  template <class T> static uint8_t* rawPixels(void* busPtr) { T* b = static_cast<T*>(busPtr); b->Dirty(); return b->Pixels(); }
+  // pixel buffer of APA102 busses sent with global brightness, 4 bytes per pixel (0xE0 | brightness, B, G, R in wire order), nullptr for others
+  static uint8_t* getDotStarPixels(void* busPtr, uint8_t busType) {
+    switch (busType) {
+    #ifdef WLED_SPI_DMA_PIXELBUS
+      case I_32_DM_DOT_3: return rawPixels<B_32_DM_DOT_3>(busPtr);
+    #endif
+    }
+    return nullptr;
+  }
+
+  static uint8_t* getPixels(void* busPtr, uint8_t busType) {
+    switch (busType) {
+    #ifdef ESP8266
+      case I_8266_U0_NEO_3: return rawPixels<B_8266_U0_NEO_3>(busPtr);
+      case I_8266_U1_NEO_3: return rawPixels<B_8266_U1_NEO_3>(busPtr);
+      case I_8266_DM_NEO_3: return rawPixels<B_8266_DM_NEO_3>(busPtr);
+      case I_8266_BB_NEO_3: return rawPixels<B_8266_BB_NEO_3>(busPtr);
+      case I_8266_U0_NEO_4: return rawPixels<B_8266_U0_NEO_4>(busPtr);
+      case I_8266_U1_NEO_4: return rawPixels<B_8266_U1_NEO_4>(busPtr);
+      case I_8266_DM_NEO_4: return rawPixels<B_8266_DM_NEO_4>(busPtr);
+      case I_8266_BB_NEO_4: return rawPixels<B_8266_BB_NEO_4>(busPtr);
+      case I_8266_U0_400_3: return rawPixels<B_8266_U0_400_3>(busPtr);
+      case I_8266_U1_400_3: return rawPixels<B_8266_U1_400_3>(busPtr);
+      case I_8266_DM_400_3: return rawPixels<B_8266_DM_400_3>(busPtr);
+      case I_8266_BB_400_3: return rawPixels<B_8266_BB_400_3>(busPtr);
+    #endif
+    #ifdef ARDUINO_ARCH_ESP32
+      case I_32_RN_NEO_3: return rawPixels<B_32_RN_NEO_3>(busPtr);
+      #ifndef WLED_NO_I2S0_PIXELBUS
+      case I_32_I0_NEO_3: return rawPixels<B_32_I0_NEO_3>(busPtr);
+      #endif
+      #ifndef WLED_NO_I2S1_PIXELBUS
+      case I_32_I1_NEO_3: return rawPixels<B_32_I1_NEO_3>(busPtr);
+      #endif
+      case I_32_RN_NEO_4: return rawPixels<B_32_RN_NEO_4>(busPtr);
+      #ifndef WLED_NO_I2S0_PIXELBUS
+      case I_32_I0_NEO_4: return rawPixels<B_32_I0_NEO_4>(busPtr);
+      #endif
+      #ifndef WLED_NO_I2S1_PIXELBUS
+      case I_32_I1_NEO_4: return rawPixels<B_32_I1_NEO_4>(busPtr);
+      #endif
+      case I_32_RN_400_3: return rawPixels<B_32_RN_400_3>(busPtr);
+      #ifndef WLED_NO_I2S0_PIXELBUS
+      case I_32_I0_400_3: return rawPixels<B_32_I0_400_3>(busPtr);
+      #endif
+      #ifndef WLED_NO_I2S1_PIXELBUS
+      case I_32_I1_400_3: return rawPixels<B_32_I1_400_3>(busPtr);
+      #endif
+      #ifdef WLED_PARALLEL_PIXELBUS
+      case I_32_PX_NEO_3: return rawPixels<B_32_PX_NEO_3>(busPtr);
+      case I_32_PX_NEO_4: return rawPixels<B_32_PX_NEO_4>(busPtr);
+      #endif
+    #endif
+      default: return nullptr;
+    }
+  }
+
   static bool canShow(void* busPtr, uint8_t busType) {
     switch (busType) {
       case I_NONE: return true;
@@ -677,6 +800,13 @@ class PolyBus {
       case I_32_I1_UCS_4: return (static_cast<B_32_I1_UCS_4*>(busPtr))->CanShow(); break;
       #endif
 //      case I_32_BB_UCS_4: return (static_cast<B_32_BB_UCS_4*>(busPtr))->CanShow(); break;
+      #ifdef WLED_PARALLEL_PIXELBUS
+      case I_32_PX_NEO_3: return (static_cast<B_32_PX_NEO_3*>(busPtr))->CanShow(); break;
+      case I_32_PX_NEO_4: return (static_cast<B_32_PX_NEO_4*>(busPtr))->CanShow(); break;
+      #endif
+      #ifdef WLED_SPI_DMA_PIXELBUS
+      case I_32_DM_DOT_3: return (static_cast<B_32_DM_DOT_3*>(busPtr))->CanShow(); break;
+      #endif
     #endif
       case I_HS_DOT_3: return (static_cast<B_HS_DOT_3*>(busPtr))->CanShow(); break;
       case I_SS_DOT_3: return (static_cast<B_SS_DOT_3*>(busPtr))->CanShow(); break;
@@ -692,14 +822,12 @@ class PolyBus {
     return true;
   }
 
-  static void setPixelColor(void* busPtr, uint8_t busType, uint16_t pix, uint32_t c, uint8_t co) {
-    uint8_t r = c >> 16;
-    uint8_t g = c >> 8;
-    uint8_t b = c >> 0;
-    uint8_t w = c >> 24;
-    RgbwColor col;
+  // reorder channels to selected color order (G, R and B are the first three channels sent for GRB features)
+  // T is RgbwColor or Rgbw64Color, V the matching channel type
+  template <class T, typename V>
+  static inline T reorderT(V r, V g, V b, V w, uint8_t co) {
+    T col;
 
-    // reorder channels to selected order
     switch (co & 0x0F) {
       default: col.G = g; col.R = r; col.B = b; break; //0 = GRB, default
       case  1: col.G = r; col.R = g; col.B = b; break; //1 = RGB, common for WS2811
@@ -715,6 +843,15 @@ class PolyBus {
       case  2: col.W = col.G; col.G = w; break; // swap W & G
       case  3: col.W = col.R; col.R = w; break; // swap W & R
     }
+    return col;
+  }
+
+  static inline RgbwColor reorder(uint32_t c, uint8_t co) {
+    return reorderT<RgbwColor, uint8_t>(c >> 16, c >> 8, c, c >> 24, co);
+  }
+
+  static void setPixelColor(void* busPtr, uint8_t busType, uint16_t pix, uint32_t c, uint8_t co) {
+    RgbwColor col = reorder(c, co);
 
     switch (busType) {
       case I_NONE: break;
@@ -799,6 +936,13 @@ class PolyBus {
       case I_32_I1_UCS_4: (static_cast<B_32_I1_UCS_4*>(busPtr))->SetPixelColor(pix, Rgbw64Color(col)); break;
       #endif
 //      case I_32_BB_UCS_4: (static_cast<B_32_BB_UCS_4*>(busPtr))->SetPixelColor(pix, Rgbw64Color(col)); break;
+      #ifdef WLED_PARALLEL_PIXELBUS
+      case I_32_PX_NEO_3: (static_cast<B_32_PX_NEO_3*>(busPtr))->SetPixelColor(pix, RgbColor(col)); break;
+      case I_32_PX_NEO_4: (static_cast<B_32_PX_NEO_4*>(busPtr))->SetPixelColor(pix, col); break;
+      #endif
+      #ifdef WLED_SPI_DMA_PIXELBUS
+      case I_32_DM_DOT_3: (static_cast<B_32_DM_DOT_3*>(busPtr))->SetPixelColor(pix, RgbwColor(col.R, col.G, col.B, 31)); break; // full global brightness
+      #endif
     #endif
       case I_HS_DOT_3: (static_cast<B_HS_DOT_3*>(busPtr))->SetPixelColor(pix, RgbColor(col)); break;
       case I_SS_DOT_3: (static_cast<B_SS_DOT_3*>(busPtr))->SetPixelColor(pix, RgbColor(col)); break;
@@ -813,6 +957,41 @@ class PolyBus {
     }
   }
 
+  // sets a pixel with 16 bit channels, only types with 16 bit channels (UCS8903/UCS8904) are supported
+  static void setPixelColor16(void* busPtr, uint8_t busType, uint16_t pix, uint16_t r, uint16_t g, uint16_t b, uint16_t w, uint8_t co) {
+    Rgbw64Color col = reorderT<Rgbw64Color, uint16_t>(r, g, b, w, co);
+
+    switch (busType) {
+    #ifdef ESP8266
+      case I_8266_U0_UCS_3: (static_cast<B_8266_U0_UCS_3*>(busPtr))->SetPixelColor(pix, Rgb48Color(col.R, col.G, col.B)); break;
+      case I_8266_U1_UCS_3: (static_cast<B_8266_U1_UCS_3*>(busPtr))->SetPixelColor(pix, Rgb48Color(col.R, col.G, col.B)); break;
+      case I_8266_DM_UCS_3: (static_cast<B_8266_DM_UCS_3*>(busPtr))->SetPixelColor(pix, Rgb48Color(col.R, col.G, col.B)); break;
+      case I_8266_BB_UCS_3: (static_cast<B_8266_BB_UCS_3*>(busPtr))->SetPixelColor(pix, Rgb48Color(col.R, col.G, col.B)); break;
+      case I_8266_U0_UCS_4: (static_cast<B_8266_U0_UCS_4*>(busPtr))->SetPixelColor(pix, col); break;
+      case I_8266_U1_UCS_4: (static_cast<B_8266_U1_UCS_4*>(busPtr))->SetPixelColor(pix, col); break;
+      case I_8266_DM_UCS_4: (static_cast<B_8266_DM_UCS_4*>(busPtr))->SetPixelColor(pix, col); break;
+      case I_8266_BB_UCS_4: (static_cast<B_8266_BB_UCS_4*>(busPtr))->SetPixelColor(pix, col); break;
+    #endif
+    #ifdef ARDUINO_ARCH_ESP32
+      case I_32_RN_UCS_3: (static_cast<B_32_RN_UCS_3*>(busPtr))->SetPixelColor(pix, Rgb48Color(col.R, col.G, col.B)); break;
+      #ifndef WLED_NO_I2S0_PIXELBUS
+      case I_32_I0_UCS_3: (static_cast<B_32_I0_UCS_3*>(busPtr))->SetPixelColor(pix, Rgb48Color(col.R, col.G, col.B)); break;
+      #endif
+      #ifndef WLED_NO_I2S1_PIXELBUS
+      case I_32_I1_UCS_3: (static_cast<B_32_I1_UCS_3*>(busPtr))->SetPixelColor(pix, Rgb48Color(col.R, col.G, col.B)); break;
+      #endif
+      case I_32_RN_UCS_4: (static_cast<B_32_RN_UCS_4*>(busPtr))->SetPixelColor(pix, col); break;
+      #ifndef WLED_NO_I2S0_PIXELBUS
+      case I_32_I0_UCS_4: (static_cast<B_32_I0_UCS_4*>(busPtr))->SetPixelColor(pix, col); break;
+      #endif
+      #ifndef WLED_NO_I2S1_PIXELBUS
+      case I_32_I1_UCS_4: (static_cast<B_32_I1_UCS_4*>(busPtr))->SetPixelColor(pix, col); break;
+      #endif
+    #endif
+      default: setPixelColor(busPtr, busType, pix, RGBW32(r >> 8, g >> 8, b >> 8, w >> 8), co); break;
+    }
+  }
+
   static void setBrightness(void* busPtr, uint8_t busType, uint8_t b) {
     switch (busType) {
       case I_NONE: break;
@@ -897,6 +1076,10 @@ class PolyBus {
       case I_32_I1_UCS_4: (static_cast<B_32_I1_UCS_4*>(busPtr))->SetLuminance(b); break;
       #endif
 //      case I_32_BB_UCS_4: (static_cast<B_32_BB_UCS_4*>(busPtr))->SetLuminance(b); break;
+      #ifdef WLED_PARALLEL_PIXELBUS
+      case I_32_PX_NEO_3: (static_cast<B_32_PX_NEO_3*>(busPtr))->SetLuminance(b); break;
+      case I_32_PX_NEO_4: (static_cast<B_32_PX_NEO_4*>(busPtr))->SetLuminance(b); break;
+      #endif
     #endif
       case I_HS_DOT_3: (static_cast<B_HS_DOT_3*>(busPtr))->SetLuminance(b); break;
       case I_SS_DOT_3: (static_cast<B_SS_DOT_3*>(busPtr))->SetLuminance(b); break;
@@ -996,6 +1179,13 @@ class PolyBus {
       case I_32_I1_UCS_4: { Rgbw64Color c = (static_cast<B_32_I1_UCS_4*>(busPtr))->GetPixelColor(pix); col = RGBW32(c.R>>8,c.G>>8,c.B>>8,c.W>>8); } break;
       #endif
 //      case I_32_BB_UCS_4: col = (static_cast<B_32_BB_UCS_4*>(busPtr))->GetPixelColor(pix); break;
+      #ifdef WLED_PARALLEL_PIXELBUS
+      case I_32_PX_NEO_3: col = (static_cast<B_32_PX_NEO_3*>(busPtr))->GetPixelColor(pix); break;
+      case I_32_PX_NEO_4: col = (static_cast<B_32_PX_NEO_4*>(busPtr))->GetPixelColor(pix); break;
+      #endif
+      #ifdef WLED_SPI_DMA_PIXELBUS
+      case I_32_DM_DOT_3: col = (static_cast<B_32_DM_DOT_3*>(busPtr))->GetPixelColor(pix); col.W = 0; break; // W is global brightness
+      #endif
     #endif
       case I_HS_DOT_3: col = (static_cast<B_HS_DOT_3*>(busPtr))->GetPixelColor(pix); break;
       case I_SS_DOT_3: col = (static_cast<B_SS_DOT_3*>(busPtr))->GetPixelColor(pix); break;
@@ -1113,6 +1303,13 @@ class PolyBus {
       case I_32_I1_UCS_4: delete (static_cast<B_32_I1_UCS_4*>(busPtr)); break;
       #endif
 //      case I_32_BB_UCS_4: delete (static_cast<B_32_BB_UCS_4*>(busPtr)); break;
+      #ifdef WLED_PARALLEL_PIXELBUS
+      case I_32_PX_NEO_3: delete (static_cast<B_32_PX_NEO_3*>(busPtr)); break;
+      case I_32_PX_NEO_4: delete (static_cast<B_32_PX_NEO_4*>(busPtr)); break;
+      #endif
+      #ifdef WLED_SPI_DMA_PIXELBUS
+      case I_32_DM_DOT_3: delete (static_cast<B_32_DM_DOT_3*>(busPtr)); break;
+      #endif
     #endif
       case I_HS_DOT_3: delete (static_cast<B_HS_DOT_3*>(busPtr)); break;
       case I_SS_DOT_3: delete (static_cast<B_SS_DOT_3*>(busPtr)); break;
@@ -1149,6 +1346,9 @@ class PolyBus {
         default: t=I_NONE;
       }
       if (t > I_NONE && isHSPI) t--; //hardware SPI has one smaller ID than software
+      #ifdef WLED_SPI_DMA_PIXELBUS
+      if (t == I_HS_DOT_3) t = I_32_DM_DOT_3;
+      #endif
       return t;
     } else {
       #ifdef ESP8266
@@ -1175,6 +1375,18 @@ class PolyBus {
       }
       #else //ESP32
       uint8_t offset = 0; //0 = RMT (num 0-7) 8 = I2S0 9 = I2S1
+      #ifdef WLED_PARALLEL_PIXELBUS
+      // first 8 digital busses use parallel output if chip timing allows, other chips fall back to RMT
+      if (num < WLED_PARALLEL_STRIPS) switch (busType) {
+        case TYPE_WS2812_1CH_X3:
+        case TYPE_WS2812_2CH_X3:
+        case TYPE_WS2812_RGB:
+        case TYPE_WS2812_WWA:
+          return I_32_PX_NEO_3;
+        case TYPE_SK6812_RGBW:
+          return I_32_PX_NEO_4;
+      }
+      #endif
       #if defined(CONFIG_IDF_TARGET_ESP32S2)
       // ESP32-S2 only has 4 RMT channels
       if (num > 4) return I_NONE;
@@ -1189,6 +1401,9 @@ class PolyBus {
       //if (num > 3) offset = num -4; // I2S not supported yet
       #else
       // standard ESP32 has 8 RMT and 2 I2S channels
+      #ifdef WLED_PARALLEL_PIXELBUS
+      if (num > 8) return I_NONE; // I2S1 is used by parallel output
+      #endif
       if (num > 9) return I_NONE;
       if (num > 7) offset = num -7;
       #endif
@@ -1215,6 +1430,31 @@ class PolyBus {
     }
     return I_NONE;
   }
+
+  // heap bytes the driver (NeoPixelBus 2.8 method) allocates per byte of pixel data
+  static uint8_t memFactor(uint8_t busType) {
+    switch (busType) {
+      #ifdef ESP8266
+      case I_8266_DM_NEO_3: case I_8266_DM_NEO_4: case I_8266_DM_400_3: case I_8266_DM_TM1_4: case I_8266_DM_TM2_3:
+      case I_8266_DM_UCS_3: case I_8266_DM_UCS_4:
+        return 5; // pixel buffer and I2S DMA buffer (4 bit cadence)
+      #else
+      case I_32_RN_NEO_3: case I_32_RN_NEO_4: case I_32_RN_400_3: case I_32_RN_TM1_4: case I_32_RN_TM2_3:
+      case I_32_RN_UCS_3: case I_32_RN_UCS_4:
+        return 2; // editing and sending buffer
+      case I_32_I0_NEO_3: case I_32_I0_NEO_4: case I_32_I0_400_3: case I_32_I0_TM1_4: case I_32_I0_TM2_3:
+      case I_32_I0_UCS_3: case I_32_I0_UCS_4:
+      case I_32_I1_NEO_3: case I_32_I1_NEO_4: case I_32_I1_400_3: case I_32_I1_TM1_4: case I_32_I1_TM2_3:
+      case I_32_I1_UCS_3: case I_32_I1_UCS_4:
+        return 5; // pixel buffer and I2S DMA buffer (4 bit cadence)
+      case I_32_PX_NEO_3: case I_32_PX_NEO_4:
+        return 5; // pixel buffer and share of the DMA buffer of all parallel strips (exact if all are equally long)
+      case I_32_DM_DOT_3:
+        return 2; // pixel buffer and DMA buffer
+      #endif
+    }
+    return 1; // pixel buffer only (UART, bit bang, SPI)
+  }
 };
 
 #endif
\ No newline at end of file
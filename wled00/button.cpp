@@ -79,10 +79,78 @@ void doublePressAction(uint8_t b)
 #endif
 }
 
+/*
+ * Push buttons, switches and PIR sensors on interrupt capable pins report their edges through pin events
+ * (see PinManagerClass::attachEvent()): press and release are time stamped in the ISR and debounced there,
+ * so short/long/double presses and the AP/factory reset hold times are measured between the actual edges
+ * instead of between loop iterations that happened to see the pin change. Buttons without a free event slot
+ * and touch buttons are polled as before.
+ */
+#define BTN_EDGE_QUEUE 4  // unprocessed edges per button (a full click while the loop is stalled needs 2)
+
+static struct {
+  uint32_t us[BTN_EDGE_QUEUE]; // ISR time stamps of edges not yet seen by handleButton()
+  uint8_t  levels;             // pressed state after each queued edge (1 bit per edge)
+  uint8_t  count;
+  int8_t   gpio;               // pin with attached events
+  bool     attached;           // false if polled
+  bool     pressed;            // debounced state
+} btnEv[WLED_MAX_BUTTONS];
+
+static inline bool hasEvents(uint8_t b)
+{
+  return btnEv[b].attached && btnEv[b].gpio == btnPin[b];
+}
+
+static bool isActiveHigh(uint8_t b)
+{
+  return buttonType[b] == BTN_TYPE_PUSH_ACT_HIGH || buttonType[b] == BTN_TYPE_PIR_SENSOR;
+}
+
+static void onButtonEvent(uint8_t gpio, bool level, uint32_t us, void *arg)
+{
+  uint8_t b = (uintptr_t)arg;
+  if (b >= WLED_MAX_BUTTONS || !btnEv[b].attached || btnEv[b].gpio != gpio) return;
+  bool pressed = isActiveHigh(b) ? level : !level;
+  btnEv[b].pressed = pressed;
+  if (btnEv[b].count == BTN_EDGE_QUEUE) { // drop the oldest edge
+    memmove(btnEv[b].us, btnEv[b].us + 1, (BTN_EDGE_QUEUE-1) * sizeof(uint32_t));
+    btnEv[b].levels >>= 1;
+    btnEv[b].count--;
+  }
+  btnEv[b].us[btnEv[b].count] = us;
+  bitWrite(btnEv[b].levels, btnEv[b].count, pressed);
+  btnEv[b].count++;
+}
+
+// (re)subscribes to pin events of digital buttons, call after button pins or types changed
+void attachButtonEvents()
+{
+  for (uint8_t b = 0; b < WLED_MAX_BUTTONS; b++) {
+    if (btnEv[b].attached) pinManager.detachEvent(btnEv[b].gpio, PinOwner::Button);
+    btnEv[b].attached = false;
+    btnEv[b].count    = 0;
+    if (btnPin[b] < 0 || digitalPinToInterrupt(btnPin[b]) == NOT_AN_INTERRUPT) continue;
+    bool momentary = buttonType[b] == BTN_TYPE_PUSH || buttonType[b] == BTN_TYPE_PUSH_ACT_HIGH;
+    if (!momentary && buttonType[b] != BTN_TYPE_SWITCH && buttonType[b] != BTN_TYPE_PIR_SENSOR) continue;
+    // momentary buttons use a shorter debounce time so glitches still fail the minimum press duration
+    uint16_t debounce = momentary ? WLED_DEBOUNCE_THRESHOLD/2 : WLED_DEBOUNCE_THRESHOLD;
+    btnEv[b].gpio = btnPin[b];
+    btnEv[b].attached = true; // set before attaching, the callback checks it
+    if (!pinManager.attachEvent(btnPin[b], PinOwner::Button, onButtonEvent, (void*)(uintptr_t)b, debounce)) {
+      btnEv[b].attached = false; // no free slot, poll
+      continue;
+    }
+    // current level as first edge: fires the boot state of switches, ignored if nothing changed
+    onButtonEvent(btnPin[b], digitalRead(btnPin[b]), micros(), (void*)(uintptr_t)b);
+  }
+}
+
 bool isButtonPressed(uint8_t i)
 {
   if (btnPin[i]<0) return false;
   uint8_t pin = btnPin[i];
+  if (hasEvents(i)) return btnEv[i].pressed; // debounced by pin events
 
   switch (buttonType[i]) {
     case BTN_TYPE_NONE:
@@ -105,8 +173,44 @@ bool isButtonPressed(uint8_t i)
   return false;
 }
 
+static void switchAction(uint8_t b)
+{
+  if (!buttonPressedBefore[b]) { // on -> off
+    if (macroButton[b]) applyPreset(macroButton[b], CALL_MODE_BUTTON_PRESET);
+    else { //turn on
+      if (!bri) {toggleOnOff(); stateUpdated(CALL_MODE_BUTTON);}
+    }
+  } else {  // off -> on
+    if (macroLongPress[b]) applyPreset(macroLongPress[b], CALL_MODE_BUTTON_PRESET);
+    else { //turn off
+      if (bri) {toggleOnOff(); stateUpdated(CALL_MODE_BUTTON);}
+    }
+  }
+
+#ifndef WLED_DISABLE_MQTT
+  // publish MQTT message
+  if (buttonPublishMqtt && WLED_MQTT_CONNECTED) {
+    char subuf[64];
+    if (buttonType[b] == BTN_TYPE_PIR_SENSOR) sprintf_P(subuf, PSTR("%s/motion/%d"), mqttDeviceTopic, (int)b);
+    else sprintf_P(subuf, _mqtt_topic_button, mqttDeviceTopic, (int)b);
+    mqtt->publish(subuf, 0, false, !buttonPressedBefore[b] ? "off" : "on");
+  }
+#endif
+
+  buttonLongPressed[b] = buttonPressedBefore[b]; //save the last "long term" switch state
+}
+
 void handleSwitch(uint8_t b)
 {
+  if (hasEvents(b)) { // edges are debounced already, act on each of them
+    for (uint8_t e = 0; e < btnEv[b].count; e++) {
+      buttonPressedBefore[b] = bitRead(btnEv[b].levels, e);
+      if (buttonLongPressed[b] != buttonPressedBefore[b]) switchAction(b);
+    }
+    btnEv[b].count = 0;
+    return;
+  }
+
   // isButtonPressed() handles inverted/noninverted logic
   if (buttonPressedBefore[b] != isButtonPressed(b)) {
     buttonPressedTime[b] = millis();
@@ -116,52 +220,46 @@ void handleSwitch(uint8_t b)
   if (buttonLongPressed[b] == buttonPressedBefore[b]) return;
 
   if (millis() - buttonPressedTime[b] > WLED_DEBOUNCE_THRESHOLD) { //fire edge event only after 50ms without change (debounce)
-    if (!buttonPressedBefore[b]) { // on -> off
-      if (macroButton[b]) applyPreset(macroButton[b], CALL_MODE_BUTTON_PRESET);
-      else { //turn on
-        if (!bri) {toggleOnOff(); stateUpdated(CALL_MODE_BUTTON);}
-      }
-    } else {  // off -> on
-      if (macroLongPress[b]) applyPreset(macroLongPress[b], CALL_MODE_BUTTON_PRESET);
-      else { //turn off
-        if (bri) {toggleOnOff(); stateUpdated(CALL_MODE_BUTTON);}
-      }
-    }
-
-#ifndef WLED_DISABLE_MQTT
-    // publish MQTT message
-    if (buttonPublishMqtt && WLED_MQTT_CONNECTED) {
-      char subuf[64];
-      if (buttonType[b] == BTN_TYPE_PIR_SENSOR) sprintf_P(subuf, PSTR("%s/motion/%d"), mqttDeviceTopic, (int)b);
-      else sprintf_P(subuf, _mqtt_topic_button, mqttDeviceTopic, (int)b);
-      mqtt->publish(subuf, 0, false, !buttonPressedBefore[b] ? "off" : "on");
-    }
-#endif
-
-    buttonLongPressed[b] = buttonPressedBefore[b]; //save the last "long term" switch state
+    switchAction(b);
   }
 }
 
-#define ANALOG_BTN_READ_CYCLE 250   // min time between two analog reading cycles
-#define STRIP_WAIT_TIME 6           // max wait time in case of strip.isUpdating()
-#define POT_SMOOTHING 0.25f         // smoothing factor for raw potentiometer readings
+#define ANALOG_BTN_READ_CYCLE 250   // min time between two updates from an analog button
+#define POT_SMOOTHING 0.1f          // smoothing factor for raw potentiometer readings (per 20ms sample)
 #define POT_SENSITIVITY 4           // changes below this amount are noise (POT scratching, or ADC noise)
 
+static float filteredReading[WLED_MAX_BUTTONS] = {0.0f};
+
+static bool isAnalogButton(uint8_t b)
+{
+  return buttonType[b] == BTN_TYPE_ANALOG || buttonType[b] == BTN_TYPE_ANALOG_INVERTED;
+}
+
+// samples analog buttons into a running average (idle scheduler task), so the ADC is read in the gaps
+// between frames and often enough to average out noise instead of once per read cycle
+void sampleAnalogButtons()
+{
+  static bool primed[WLED_MAX_BUTTONS] = {false};
+  for (uint8_t b = 0; b < WLED_MAX_BUTTONS; b++) {
+    if (!isAnalogButton(b)) { primed[b] = false; continue; }
+    uint16_t rawReading;    // raw value from analogRead, scaled to 12bit
+    #ifdef ESP8266
+    rawReading = analogRead(A0) << 2;   // convert 10bit read to 12bit
+    #else
+    if ((btnPin[b] < 0) || (digitalPinToAnalogChannel(btnPin[b]) < 0)) continue; // pin must support analog ADC - newer esp32 frameworks throw lots of warnings otherwise
+    rawReading = analogRead(btnPin[b]); // collect at full 12bit resolution
+    #endif
+    float scaled = float(rawReading) / 16.0f; // scale to [0..255]
+    if (!primed[b]) filteredReading[b] = scaled; // start from the first sample instead of ramping up from 0
+    else            filteredReading[b] += POT_SMOOTHING * (scaled - filteredReading[b]);
+    primed[b] = true;
+  }
+}
+
 void handleAnalog(uint8_t b)
 {
   static uint8_t oldRead[WLED_MAX_BUTTONS] = {0};
-  static float filteredReading[WLED_MAX_BUTTONS] = {0.0f};
-  uint16_t rawReading;    // raw value from analogRead, scaled to 12bit
-
-  #ifdef ESP8266
-  rawReading = analogRead(A0) << 2;   // convert 10bit read to 12bit
-  #else
-  if ((btnPin[b] < 0) || (digitalPinToAnalogChannel(btnPin[b]) < 0)) return; // pin must support analog ADC - newer esp32 frameworks throw lots of warnings otherwise
-  rawReading = analogRead(btnPin[b]); // collect at full 12bit resolution
-  #endif
-  yield();                            // keep WiFi task running - analog read may take several millis on ESP8266
-
-  filteredReading[b] += POT_SMOOTHING * ((float(rawReading) / 16.0f) - filteredReading[b]); // filter raw input, and scale to [0..255]
+
   uint16_t aRead = max(min(int(filteredReading[b]), 255), 0);                               // squash into 8bit
   if(aRead <= POT_SENSITIVITY) aRead = 0;                                                   // make sure that 0 and 255 are used
   if(aRead >= 255-POT_SENSITIVITY) aRead = 255;
@@ -171,13 +269,6 @@ void handleAnalog(uint8_t b)
   // remove noise & reduce frequency of UI updates
   if (abs(int(aRead) - int(oldRead[b])) <= POT_SENSITIVITY) return;  // no significant change in reading
 
-  // Un-comment the next lines if you still see flickering related to potentiometer
-  // This waits until strip finishes updating (why: strip was not updating at the start of handleButton() but may have started during analogRead()?)
-  //unsigned long wait_started = millis();
-  //while(strip.isUpdating() && (millis() - wait_started < STRIP_WAIT_TIME)) {
-  //  delay(1);
-  //}
-
   oldRead[b] = aRead;
 
   // if no macro for "short press" and "long press" is defined use brightness control
@@ -224,28 +315,112 @@ void handleAnalog(uint8_t b)
   colorUpdated(CALL_MODE_BUTTON);
 }
 
+static inline bool sameMacros(uint8_t b)
+{
+  return macroButton[b] && macroButton[b] == macroLongPress[b] && macroButton[b] == macroDoublePress[b];
+}
+
+// momentary button pressed at time t (ms)
+static void buttonPress(uint8_t b, unsigned long t)
+{
+  // if all macros are the same, fire action immediately on rising edge
+  if (sameMacros(b)) {
+    if (!buttonPressedBefore[b]) shortPressAction(b);
+    buttonPressedBefore[b] = true;
+    buttonPressedTime[b] = t;
+    return;
+  }
+  // a late delivered edge must not turn an expired short press into a double press
+  if (buttonWaitTime[b] && t - buttonWaitTime[b] > WLED_DOUBLE_PRESS) {
+    buttonWaitTime[b] = 0;
+    shortPressAction(b);
+  }
+  if (!buttonPressedBefore[b]) buttonPressedTime[b] = t;
+  buttonPressedBefore[b] = true;
+}
+
+// momentary button still held at time now (ms)
+static void buttonHeld(uint8_t b, unsigned long now)
+{
+  if (sameMacros(b)) {
+    if (!hasEvents(b)) buttonPressedTime[b] = now; // continually update (for debouncing to work in release handler)
+    return;
+  }
+  if (now - buttonPressedTime[b] > WLED_LONG_PRESS) { //long press
+    if (!buttonLongPressed[b]) longPressAction(b);
+    else if (b) { //repeatable action (~3 times per s) on button > 0
+      longPressAction(b);
+      buttonPressedTime[b] = now - WLED_LONG_REPEATED_ACTION; //333ms
+    }
+    buttonLongPressed[b] = true;
+  }
+}
+
+// momentary button released at time t (ms)
+static void buttonRelease(uint8_t b, unsigned long t)
+{
+  long dur = t - buttonPressedTime[b];
+
+  // released after rising-edge short press action
+  if (sameMacros(b)) {
+    // debounce, blocks button for 50 ms once it has been released (pin events are debounced already)
+    if (hasEvents(b) || dur > WLED_DEBOUNCE_THRESHOLD) buttonPressedBefore[b] = false;
+    return;
+  }
+
+  if (dur < WLED_DEBOUNCE_THRESHOLD) {buttonPressedBefore[b] = false; return;} // too short "press", debounce
+  bool doublePress = buttonWaitTime[b]; //did we have a short press before?
+  buttonWaitTime[b] = 0;
+
+  if (b == 0 && dur > WLED_LONG_AP) { // long press on button 0 (when released)
+    if (dur > WLED_LONG_FACTORY_RESET) { // factory reset if pressed > 10 seconds
+      WLED_FS.format();
+      #ifdef WLED_ADD_EEPROM_SUPPORT
+      clearEEPROM();
+      #endif
+      doReboot = true;
+    } else {
+      WLED::instance().initAP(true);
+    }
+  } else if (!buttonLongPressed[b] && dur > WLED_LONG_PRESS) { // held long but released before the loop noticed
+    longPressAction(b);
+  } else if (!buttonLongPressed[b]) { //short press
+    //NOTE: this interferes with double click handling in usermods so usermod needs to implement full button handling
+    if (b != 1 && !macroDoublePress[b]) { //don't wait for double press on buttons without a default action if no double press macro set
+      shortPressAction(b);
+    } else { //double press if less than 350 ms between current press and previous short press release (buttonWaitTime!=0)
+      if (doublePress) {
+        doublePressAction(b);
+      } else {
+        buttonWaitTime[b] = t;
+      }
+    }
+  }
+  buttonPressedBefore[b] = false;
+  buttonLongPressed[b] = false;
+}
+
 void handleButton()
 {
   static unsigned long lastAnalogRead = 0UL;
   static unsigned long lastRun = 0UL;
   unsigned long now = millis();
+  bool analogDue = now - lastAnalogRead > ANALOG_BTN_READ_CYCLE;
 
   if (strip.isUpdating() && (now - lastRun < ANALOG_BTN_READ_CYCLE+1)) return; // don't interfere with strip update (unless strip is updating continuously, e.g. very long strips)
   lastRun = now;
 
   for (uint8_t b=0; b<WLED_MAX_BUTTONS; b++) {
     #ifdef ESP8266
-    if ((btnPin[b]<0 && !(buttonType[b] == BTN_TYPE_ANALOG || buttonType[b] == BTN_TYPE_ANALOG_INVERTED)) || buttonType[b] == BTN_TYPE_NONE) continue;
+    if ((btnPin[b]<0 && !isAnalogButton(b)) || buttonType[b] == BTN_TYPE_NONE) continue;
     #else
     if (btnPin[b]<0 || buttonType[b] == BTN_TYPE_NONE) continue;
     #endif
 
-    if (usermods.handleButton(b)) continue; // did usermod handle buttons
+    if (usermods.handleButton(b)) { btnEv[b].count = 0; continue; } // did usermod handle buttons (it reads isButtonPressed())
 
-    if (buttonType[b] == BTN_TYPE_ANALOG || buttonType[b] == BTN_TYPE_ANALOG_INVERTED) { // button is not a button but a potentiometer
-      if (now - lastAnalogRead > ANALOG_BTN_READ_CYCLE) {
-        handleAnalog(b);
-      }
+    if (isAnalogButton(b)) { // button is not a button but a potentiometer
+      if (analogDue) handleAnalog(b);
       continue;
     }
 
@@ -256,66 +431,23 @@ void handleButton()
     }
 
     // momentary button logic
-    if (isButtonPressed(b)) { // pressed
-
-      // if all macros are the same, fire action immediately on rising edge
-      if (macroButton[b] && macroButton[b] == macroLongPress[b] && macroButton[b] == macroDoublePress[b]) {
-        if (!buttonPressedBefore[b])
-          shortPressAction(b);
-        buttonPressedBefore[b] = true;
-        buttonPressedTime[b] = now; // continually update (for debouncing to work in release handler)
-        continue;
-      }
-
-      if (!buttonPressedBefore[b]) buttonPressedTime[b] = now;
-      buttonPressedBefore[b] = true;
-
-      if (now - buttonPressedTime[b] > WLED_LONG_PRESS) { //long press
-        if (!buttonLongPressed[b]) longPressAction(b);
-        else if (b) { //repeatable action (~3 times per s) on button > 0
-          longPressAction(b);
-          buttonPressedTime[b] = now - WLED_LONG_REPEATED_ACTION; //333ms
-        }
-        buttonLongPressed[b] = true;
-      }
-
-    } else if (!isButtonPressed(b) && buttonPressedBefore[b]) { //released
-      long dur = now - buttonPressedTime[b];
-
-      // released after rising-edge short press action
-      if (macroButton[b] && macroButton[b] == macroLongPress[b] && macroButton[b] == macroDoublePress[b]) {
-        if (dur > WLED_DEBOUNCE_THRESHOLD) buttonPressedBefore[b] = false; // debounce, blocks button for 50 ms once it has been released
-        continue;
-      }
-
-      if (dur < WLED_DEBOUNCE_THRESHOLD) {buttonPressedBefore[b] = false; continue;} // too short "press", debounce
-      bool doublePress = buttonWaitTime[b]; //did we have a short press before?
-      buttonWaitTime[b] = 0;
-
-      if (b == 0 && dur > WLED_LONG_AP) { // long press on button 0 (when released)
-        if (dur > WLED_LONG_FACTORY_RESET) { // factory reset if pressed > 10 seconds
-          WLED_FS.format();
-          #ifdef WLED_ADD_EEPROM_SUPPORT
-          clearEEPROM();
-          #endif
-          doReboot = true;
-        } else {
-          WLED::instance().initAP(true);
-        }
-      } else if (!buttonLongPressed[b]) { //short press
-        //NOTE: this interferes with double click handling in usermods so usermod needs to implement full button handling
-        if (b != 1 && !macroDoublePress[b]) { //don't wait for double press on buttons without a default action if no double press macro set
-          shortPressAction(b);
-        } else { //double press if less than 350 ms between current press and previous short press release (buttonWaitTime!=0)
-          if (doublePress) {
-            doublePressAction(b);
-          } else {
-            buttonWaitTime[b] = now;
-          }
-        }
+    if (hasEvents(b)) {
+      // replay captured edges with their ISR time stamps (converted to millis())
+      uint32_t nowUs = micros();
+      for (uint8_t e = 0; e < btnEv[b].count; e++) {
+        unsigned long t = now - (nowUs - btnEv[b].us[e]) / 1000U;
+        bool pressed = bitRead(btnEv[b].levels, e);
+        if (pressed == buttonPressedBefore[b]) continue; // lost the opposite edge when the queue was full
+        if (pressed) buttonPress(b, t);
+        else         buttonRelease(b, t);
       }
-      buttonPressedBefore[b] = false;
-      buttonLongPressed[b] = false;
+      btnEv[b].count = 0;
+      if (buttonPressedBefore[b]) buttonHeld(b, now);
+    } else if (isButtonPressed(b)) { // pressed
+      buttonPress(b, now);
+      buttonHeld(b, now);
+    } else if (buttonPressedBefore[b]) { //released
+      buttonRelease(b, now);
     }
 
     //if 350ms elapsed since last short press release it is a short press
@@ -324,7 +456,7 @@ void handleButton()
       shortPressAction(b);
     }
   }
-  if (now - lastAnalogRead > ANALOG_BTN_READ_CYCLE) {
+  if (analogDue) {
     lastAnalogRead = now;
   }
 }
@@ -9,10 +9,88 @@
 //simple macro for ArduinoJSON's or syntax
 #define CJSON(a,b) a = b | a
 
+// FNV-1a over serialized JSON without allocating a string
+class CfgHashPrint : public Print {
+  public:
+    uint32_t h = FNV1A_SEED;
+    size_t write(uint8_t c) override { h = fnv1a(&c, 1, h); return 1; }
+    size_t write(const uint8_t *buf, size_t len) override { h = fnv1a(buf, len, h); return len; }
+};
+
+static uint32_t hashConfigFile(const char *path) {
+  File f = WLED_FS.open(path, "r");
+  if (!f) return 0;
+  CfgHashPrint hp;
+  uint8_t buf[64];
+  size_t n;
+  while ((n = f.read(buf, sizeof(buf))) > 0) hp.write(buf, n);
+  f.close();
+  return hp.h | 1;
+}
+
+// writes doc to path (atomically via tmp) unless the content equals what is already stored
+// lastHash caches the hash of the stored file (0: unknown, hashed from FS on first use)
+static void writeConfigFile(const char *path, const char *tmp, uint32_t &lastHash) {
+  CfgHashPrint hp;
+  size_t len = serializeJson(doc, hp);
+  uint32_t h = hp.h | 1;
+  if (!lastHash) lastHash = hashConfigFile(path);
+  if (h == lastHash) {
+    DEBUG_PRINT(path); DEBUG_PRINTLN(F(" unchanged, not written."));
+    return;
+  }
+  File f = WLED_FS.open(tmp, "w"); // replace file only once completely written
+  size_t written = f ? serializeJson(doc, f) : 0;
+  f.close();
+  if (commitFile(tmp, path, written && written == len)) lastHash = h;
+}
+
+static uint32_t cfgHash = 0, cfgSecHash = 0;
+
 void getStringFromJson(char* dest, const char* src, size_t len) {
   if (src != nullptr) strlcpy(dest, src, len);
 }
 
+// bus configuration from an element of hw.led.ins (count is 0 if there is no bus to create)
+static BusConfig busConfigFromJson(JsonObject elm, bool dblBfr) {
+  uint8_t pins[5] = {255, 255, 255, 255, 255};
+  JsonArray pinArr = elm["pin"];
+  uint8_t i = 0;
+  for (int p : pinArr) {
+    pins[i++] = p;
+    if (i>4) break;
+  }
+
+  uint16_t length = elm["len"] | 1;
+  uint8_t colorOrder = (int)elm[F("order")]; // contains white channel swap option in upper nibble
+  uint8_t skipFirst = elm[F("skip")];
+  uint16_t start = elm["start"] | 0;
+  uint8_t ledType = elm["type"] | TYPE_WS2812_RGB;
+  bool reversed = elm["rev"];
+  bool refresh = elm["ref"] | false;
+  uint16_t freqkHz = elm[F("freq")] | 0;  // will be in kHz for DotStar and Hz for PWM (not yet implemented fully)
+  ledType |= refresh << 7; // hack bit 7 to indicate strip requires off refresh
+  uint8_t AWmode = elm[F("rgbwm")] | RGBW_MODE_MANUAL_ONLY;
+  uint16_t maMax = elm[F("maxpwr")] | 0; // bus with its own power supply (0 = shares global limit)
+  BusConfig bc = BusConfig(ledType, pins, start, length, colorOrder, reversed, skipFirst, AWmode, freqkHz, dblBfr, maMax);
+  if (pinArr.size() == 0 || length == 0 || start + length > MAX_LEDS) bc.count = 0; // zero length or we reached max. number of LEDs
+  return bc;
+}
+
+// LED memory planner: heap the busses of hw.led.ins would allocate if applied, as deserializeConfig() creates them
+// fills plan (WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES entries), returns number of busses
+uint8_t planBusMemory(JsonArray ins, bool dblBfr, bus_mem_t *plan) {
+  uint8_t s = 0;
+  for (JsonObject elm : ins) {
+    if (s >= WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES) break;
+    BusConfig bc = busConfigFromJson(elm, dblBfr);
+    if (bc.count == 0) continue;
+    BusManager::memUsage(bc, s, &plan[s]);
+    s++;
+  }
+  return s;
+}
+
 bool deserializeConfig(JsonObject doc, bool fromFS) {
   bool needsSave = false;
   //int rev_major = doc["rev"][0]; // 1
@@ -75,6 +153,7 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   noWifiSleep = doc[F("wifi")][F("sleep")] | !noWifiSleep; // inverted
   noWifiSleep = !noWifiSleep;
   force802_3g = doc[F("wifi")][F("phy")] | force802_3g; //force phy mode g?
+  CJSON(realtimeProfile, doc[F("wifi")][F("rtp")]);
 
   JsonObject hw = doc[F("hw")];
 
@@ -88,8 +167,10 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   CJSON(cctFromRgb, hw_led[F("cr")]);
   CJSON(strip.cctBlending, hw_led[F("cb")]);
   Bus::setCCTBlend(strip.cctBlending);
+  Bus::setDithering(hw_led[F("dith")] | Bus::getDithering());
   strip.setTargetFps(hw_led["fps"]); //NOP if 0, default 42 FPS
   CJSON(useGlobalLedBuffer, hw_led[F("ld")]);
+  busses.setKeepAlive(hw_led[F("ka")] | busses.getKeepAlive());
 
   #ifndef WLED_DISABLE_2D
   // 2D Matrix Settings
@@ -112,6 +193,9 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
         CJSON(p.yOffset,     pnl["y"]);
         CJSON(p.height,      pnl["h"]);
         CJSON(p.width,       pnl["w"]);
+        CJSON(p.canvas,      pnl["c"]);
+        JsonArray ip = pnl["ip"];
+        if (ip.size() == 4) for (size_t i = 0; i < 4; i++) p.ip[i] = ip[i];
         strip.panel.push_back(p);
         if (++s >= WLED_MAX_PANELS || s >= strip.panels) break; // max panels reached
       }
@@ -133,43 +217,18 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   if (fromFS || !ins.isNull()) {
     uint8_t s = 0;  // bus iterator
     if (fromFS) busses.removeAll(); // can't safely manipulate busses directly in network callback
-    uint32_t mem = 0, globalBufMem = 0;
-    uint16_t maxlen = 0;
+    uint32_t mem = 0;
     bool busesChanged = false;
     for (JsonObject elm : ins) {
       if (s >= WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES) break;
-      uint8_t pins[5] = {255, 255, 255, 255, 255};
-      JsonArray pinArr = elm["pin"];
-      if (pinArr.size() == 0) continue;
-      pins[0] = pinArr[0];
-      uint8_t i = 0;
-      for (int p : pinArr) {
-        pins[i++] = p;
-        if (i>4) break;
-      }
-
-      uint16_t length = elm["len"] | 1;
-      uint8_t colorOrder = (int)elm[F("order")]; // contains white channel swap option in upper nibble
-      uint8_t skipFirst = elm[F("skip")];
-      uint16_t start = elm["start"] | 0;
-      if (length==0 || start + length > MAX_LEDS) continue; // zero length or we reached max. number of LEDs, just stop
-      uint8_t ledType = elm["type"] | TYPE_WS2812_RGB;
-      bool reversed = elm["rev"];
-      bool refresh = elm["ref"] | false;
-      uint16_t freqkHz = elm[F("freq")] | 0;  // will be in kHz for DotStar and Hz for PWM (not yet implemented fully)
-      ledType |= refresh << 7; // hack bit 7 to indicate strip requires off refresh
-      uint8_t AWmode = elm[F("rgbwm")] | RGBW_MODE_MANUAL_ONLY;
+      BusConfig bc = busConfigFromJson(elm, useGlobalLedBuffer);
+      if (bc.count == 0) continue;
       if (fromFS) {
-        BusConfig bc = BusConfig(ledType, pins, start, length, colorOrder, reversed, skipFirst, AWmode, freqkHz, useGlobalLedBuffer);
-        mem += BusManager::memUsage(bc);
-        if (useGlobalLedBuffer && start + length > maxlen) {
-          maxlen = start + length;
-          globalBufMem = maxlen * 4;
-        }
-        if (mem + globalBufMem <= MAX_LED_MEMORY) if (busses.add(bc) == -1) break;  // finalization will be done in WLED::beginStrip()
+        mem += BusManager::memUsage(bc, busses.getNumBusses());
+        if (mem <= MAX_LED_MEMORY) if (busses.add(bc) == -1) break;  // finalization will be done in WLED::beginStrip()
       } else {
         if (busConfigs[s] != nullptr) delete busConfigs[s];
-        busConfigs[s] = new BusConfig(ledType, pins, start, length, colorOrder, reversed, skipFirst, AWmode, freqkHz, useGlobalLedBuffer);
+        busConfigs[s] = new BusConfig(bc);
         busesChanged = true;
       }
       s++;
@@ -270,6 +329,7 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   }
   CJSON(touchThreshold,btn_obj[F("tt")]);
   CJSON(buttonPublishMqtt,btn_obj["mqtt"]);
+  attachButtonEvents();
 
   int hw_ir_pin = hw["ir"]["pin"] | -2; // 4
   if (hw_ir_pin > -2) {
@@ -364,6 +424,8 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   strip.setTransition(fadeTransition ? transitionDelayDefault : 0);
   CJSON(strip.paletteFade, light_tr["pal"]);
   CJSON(randomPaletteChangeTime, light_tr[F("rpc")]);
+  CJSON(stateCoalesceInterval, light_tr[F("coal")]);
+  if (stateCoalesceInterval > 1000) stateCoalesceInterval = 1000;
 
   JsonObject light_nl = light["nl"];
   CJSON(nightlightMode, light_nl["mode"]);
@@ -406,6 +468,12 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   CJSON(syncGroups, if_sync_send["grp"]);
   if (if_sync_send[F("twice")]) udpNumRetries = 1; // import setting from 0.13 and earlier
   CJSON(udpNumRetries, if_sync_send["ret"]);
+  CJSON(udpDeltaNotify, if_sync_send[F("delta")]);
+  CJSON(clockSyncMode, if_sync[F("clk")]);
+  if (clockSyncMode > CLOCK_SYNC_LEADER) clockSyncMode = CLOCK_SYNC_OFF;
+#ifndef WLED_DISABLE_ESPNOW
+  CJSON(espNowSync, if_sync[F("espnow")]);
+#endif
 
   JsonObject if_nodes = interfaces["nodes"];
   CJSON(nodeListEnabled, if_nodes[F("list")]);
@@ -417,6 +485,10 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   CJSON(e131Port, if_live["port"]); // 5568
   if (e131Port == DDP_DEFAULT_PORT) e131Port = E131_DEFAULT_PORT; // prevent double DDP port allocation
   CJSON(e131Multicast, if_live[F("mc")]);
+  CJSON(e131FrameTimeout, if_live[F("ftmo")]);
+  if (!e131FrameTimeout) e131FrameTimeout = E131_FRAME_TIMEOUT;
+  CJSON(ddpPresentationDelay, if_live[F("ddpdly")]);
+  if (ddpPresentationDelay > DDP_MAX_PRESENTATION_DELAY) ddpPresentationDelay = DDP_MAX_PRESENTATION_DELAY;
 
   JsonObject if_live_dmx = if_live[F("dmx")];
   CJSON(e131Universe, if_live_dmx[F("uni")]);
@@ -428,12 +500,43 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   CJSON(e131Priority, if_live_dmx[F("e131prio")]);
   if (e131Priority > 200) e131Priority = 200;
   CJSON(DMXMode, if_live_dmx["mode"]);
+  #ifdef WLED_ENABLE_DMX_INPUT
+  CJSON(dmxInputRxPin, if_live_dmx[F("inrx")]);
+  CJSON(dmxInputEnPin, if_live_dmx[F("inen")]);
+  #endif
+
+  JsonObject if_live_out = if_live["out"];
+  CJSON(netOutUniverse, if_live_out[F("uni")]);
+  CJSON(e131OutPriority, if_live_out[F("prio")]);
+  if (e131OutPriority > 200) e131OutPriority = 200;
+  CJSON(netOutPacing, if_live_out[F("pace")]);
+  CJSON(netOutChannels, if_live_out[F("ch")]);
+  if (netOutChannels > 512) netOutChannels = 512;
+  CJSON(artnetOutNet, if_live_out[F("anet")]);
+  CJSON(artnetOutSubnet, if_live_out[F("asub")]);
+  CJSON(artnetOutUniverse, if_live_out[F("auni")]);
+  CJSON(artnetOutSync, if_live_out[F("async")]);
 
   tdd = if_live[F("timeout")] | -1;
   if (tdd >= 0) realtimeTimeoutMs = tdd * 100;
   CJSON(arlsForceMaxBri, if_live[F("maxbri")]);
   CJSON(arlsDisableGammaCorrection, if_live[F("no-gc")]); // false
   CJSON(arlsOffset, if_live[F("offset")]); // 0
+  CJSON(realtimeFade, if_live[F("fade")]);
+  JsonArray rtRoutes = if_live[F("route")]; // [[segment, universe, offset, length], ...]
+  if (!rtRoutes.isNull()) {
+    realtimeRouteCount = 0;
+    for (JsonVariant r : rtRoutes) {
+      if (realtimeRouteCount >= WLED_MAX_RT_ROUTES) break;
+      JsonArray ra = r.as<JsonArray>();
+      if (ra.size() < 2) continue;
+      rt_route_t &rt = realtimeRoutes[realtimeRouteCount++];
+      rt.seg = ra[0] | 0;
+      rt.uni = ra[1] | 0;
+      rt.ofs = ra[2] | 0;
+      rt.len = ra[3] | 0;
+    }
+  }
 
   CJSON(alexaEnabled, interfaces["va"][F("alexa")]); // false
 
@@ -597,7 +700,7 @@ void deserializeConfigFromFS() {
     #endif
   }
 
-  if (!requestJSONBufferLock(1)) return;
+  if (!requestJSONBufferLock(JSON_LOCK_CFG_DES)) return;
 
   DEBUG_PRINTLN(F("Reading settings from /cfg.json..."));
 
@@ -633,7 +736,7 @@ void serializeConfig() {
 
   DEBUG_PRINTLN(F("Writing settings to /cfg.json..."));
 
-  if (!requestJSONBufferLock(2)) return;
+  if (!requestJSONBufferLock(JSON_LOCK_CFG_SER)) return;
 
   JsonArray rev = doc.createNestedArray("rev");
   rev.add(1); //major settings revision
@@ -683,6 +786,7 @@ void serializeConfig() {
   JsonObject wifi = doc.createNestedObject("wifi");
   wifi[F("sleep")] = !noWifiSleep;
   wifi[F("phy")] = force802_3g;
+  wifi[F("rtp")] = realtimeProfile;
 
   #ifdef WLED_USE_ETHERNET
   JsonObject ethernet = doc.createNestedObject("eth");
@@ -718,8 +822,10 @@ void serializeConfig() {
   hw_led[F("cr")] = cctFromRgb;
   hw_led[F("cb")] = strip.cctBlending;
   hw_led["fps"] = strip.getTargetFps();
+  hw_led[F("dith")] = Bus::getDithering();
   hw_led[F("rgbwm")] = Bus::getGlobalAWMode(); // global auto white mode override
   hw_led[F("ld")] = useGlobalLedBuffer;
+  hw_led[F("ka")] = busses.getKeepAlive(); // keep-alive refresh of unchanged frames (ms)
 
   #ifndef WLED_DISABLE_2D
   // 2D Matrix Settings
@@ -737,6 +843,11 @@ void serializeConfig() {
       pnl["y"] = strip.panel[i].yOffset;
       pnl["h"] = strip.panel[i].height;
       pnl["w"] = strip.panel[i].width;
+      if (strip.panel[i].canvas) pnl["c"] = strip.panel[i].canvas;
+      if (strip.panel[i].ip[0]) {
+        JsonArray ip = pnl.createNestedArray("ip");
+        for (size_t j = 0; j < 4; j++) ip.add(strip.panel[i].ip[j]);
+      }
     }
   }
   #endif
@@ -760,6 +871,7 @@ void serializeConfig() {
     ins["ref"] = bus->isOffRefreshRequired();
     ins[F("rgbwm")] = bus->getAutoWhiteMode();
     ins[F("freq")] = bus->getFrequency();
+    ins[F("maxpwr")] = bus->getMaxCurrent();
   }
 
   JsonArray hw_com = hw.createNestedArray(F("com"));
@@ -834,6 +946,7 @@ void serializeConfig() {
   light_tr["dur"] = transitionDelayDefault / 100;
   light_tr["pal"] = strip.paletteFade;
   light_tr[F("rpc")] = randomPaletteChangeTime;
+  light_tr[F("coal")] = stateCoalesceInterval;
 
   JsonObject light_nl = light.createNestedObject("nl");
   light_nl["mode"] = nightlightMode;
@@ -868,6 +981,11 @@ void serializeConfig() {
   if_sync_send["macro"] = notifyMacro;
   if_sync_send["grp"] = syncGroups;
   if_sync_send["ret"] = udpNumRetries;
+  if_sync_send[F("delta")] = udpDeltaNotify;
+  if_sync[F("clk")] = clockSyncMode;
+#ifndef WLED_DISABLE_ESPNOW
+  if_sync[F("espnow")] = espNowSync;
+#endif
 
   JsonObject if_nodes = interfaces.createNestedObject("nodes");
   if_nodes[F("list")] = nodeListEnabled;
@@ -878,6 +996,8 @@ void serializeConfig() {
   if_live[F("mso")] = useMainSegmentOnly;
   if_live["port"] = e131Port;
   if_live[F("mc")] = e131Multicast;
+  if_live[F("ftmo")] = e131FrameTimeout;
+  if_live[F("ddpdly")] = ddpPresentationDelay;
 
   JsonObject if_live_dmx = if_live.createNestedObject("dmx");
   if_live_dmx[F("uni")] = e131Universe;
@@ -886,11 +1006,34 @@ void serializeConfig() {
   if_live_dmx[F("addr")] = DMXAddress;
   if_live_dmx[F("dss")] = DMXSegmentSpacing;
   if_live_dmx["mode"] = DMXMode;
+  #ifdef WLED_ENABLE_DMX_INPUT
+  if_live_dmx[F("inrx")] = dmxInputRxPin;
+  if_live_dmx[F("inen")] = dmxInputEnPin;
+  #endif
+
+  JsonObject if_live_out = if_live.createNestedObject("out");
+  if_live_out[F("uni")] = netOutUniverse;
+  if_live_out[F("prio")] = e131OutPriority;
+  if_live_out[F("pace")] = netOutPacing;
+  if_live_out[F("ch")] = netOutChannels;
+  if_live_out[F("anet")] = artnetOutNet;
+  if_live_out[F("asub")] = artnetOutSubnet;
+  if_live_out[F("auni")] = artnetOutUniverse;
+  if_live_out[F("async")] = artnetOutSync;
 
   if_live[F("timeout")] = realtimeTimeoutMs / 100;
   if_live[F("maxbri")] = arlsForceMaxBri;
   if_live[F("no-gc")] = arlsDisableGammaCorrection;
   if_live[F("offset")] = arlsOffset;
+  if_live[F("fade")] = realtimeFade;
+  JsonArray rtRoutes = if_live.createNestedArray(F("route"));
+  for (unsigned i = 0; i < realtimeRouteCount; i++) {
+    JsonArray ra = rtRoutes.createNestedArray();
+    ra.add(realtimeRoutes[i].seg);
+    ra.add(realtimeRoutes[i].uni);
+    ra.add(realtimeRoutes[i].ofs);
+    ra.add(realtimeRoutes[i].len);
+  }
 
 #ifndef WLED_DISABLE_ALEXA
   JsonObject if_va = interfaces.createNestedObject("va");
@@ -1013,9 +1156,7 @@ void serializeConfig() {
   JsonObject usermods_settings = doc.createNestedObject("um");
   usermods.addToConfig(usermods_settings);
 
-  File f = WLED_FS.open("/cfg.json", "w");
-  if (f) serializeJson(doc, f);
-  f.close();
+  writeConfigFile("/cfg.json", "/cfg.tmp", cfgHash);
   releaseJSONBufferLock();
 
   doSerializeConfig = false;
@@ -1025,7 +1166,7 @@ void serializeConfig() {
 bool deserializeConfigSec() {
   DEBUG_PRINTLN(F("Reading settings from /wsec.json..."));
 
-  if (!requestJSONBufferLock(3)) return false;
+  if (!requestJSONBufferLock(JSON_LOCK_CFG_SEC_DES)) return false;
 
   bool success = readObjectFromFile("/wsec.json", nullptr, &doc);
   if (!success) {
@@ -1066,7 +1207,7 @@ bool deserializeConfigSec() {
 void serializeConfigSec() {
   DEBUG_PRINTLN(F("Writing settings to /wsec.json..."));
 
-  if (!requestJSONBufferLock(4)) return;
+  if (!requestJSONBufferLock(JSON_LOCK_CFG_SEC_SER)) return;
 
   JsonObject nw = doc.createNestedObject("nw");
 
@@ -1096,8 +1237,6 @@ void serializeConfigSec() {
   ota[F("lock-wifi")] = wifiLock;
   ota[F("aota")] = aOtaEnabled;
 
-  File f = WLED_FS.open("/wsec.json", "w");
-  if (f) serializeJson(doc, f);
-  f.close();
+  writeConfigFile("/wsec.json", "/wsec.tmp", cfgSecHash);
   releaseJSONBufferLock();
 }
@@ -4,60 +4,57 @@
  * Color conversion & utility methods
  */
 
+// packed color arithmetic (SWAR_RB()/SWAR_WG(), two 16 bit lanes per word) is defined in fcn_pure.h
+
 /*
  * color blend function
  */
-uint32_t color_blend(uint32_t color1, uint32_t color2, uint16_t blend, bool b16) {
+uint32_t WLED_HOT(color_blend) color_blend(uint32_t color1, uint32_t color2, uint16_t blend, bool b16) {
   if(blend == 0)   return color1;
   uint16_t blendmax = b16 ? 0xFFFF : 0xFF;
   if(blend == blendmax) return color2;
-  uint8_t shift = b16 ? 16 : 8;
-
-  uint32_t w1 = W(color1);
-  uint32_t r1 = R(color1);
-  uint32_t g1 = G(color1);
-  uint32_t b1 = B(color1);
-
-  uint32_t w2 = W(color2);
-  uint32_t r2 = R(color2);
-  uint32_t g2 = G(color2);
-  uint32_t b2 = B(color2);
-
-  uint32_t w3 = ((w2 * blend) + (w1 * (blendmax - blend))) >> shift;
-  uint32_t r3 = ((r2 * blend) + (r1 * (blendmax - blend))) >> shift;
-  uint32_t g3 = ((g2 * blend) + (g1 * (blendmax - blend))) >> shift;
-  uint32_t b3 = ((b2 * blend) + (b1 * (blendmax - blend))) >> shift;
+  if (b16) {
+    // weights out of 256 (products fit 16 bit lanes) with exact ends and rounding, within 1 LSB of a 16 bit blend
+    uint32_t w2 = (blend + 0x80) >> 8; // 0..256
+    if (w2 == 0) return color1;
+    uint32_t w1 = 256 - w2;
+    uint32_t rb = (SWAR_RB(color2) * w2 + SWAR_RB(color1) * w1 + 0x00800080) >> 8;
+    uint32_t wg = (SWAR_WG(color2) * w2 + SWAR_WG(color1) * w1 + 0x00800080);
+    return (rb & 0x00FF00FF) | (wg & 0xFF00FF00);
+  }
 
-  return RGBW32(r3, g3, b3, w3);
+  uint32_t rb = (SWAR_RB(color2) * blend + SWAR_RB(color1) * (0xFF - blend)) >> 8;
+  uint32_t wg = (SWAR_WG(color2) * blend + SWAR_WG(color1) * (0xFF - blend));
+  return (rb & 0x00FF00FF) | (wg & 0xFF00FF00);
 }
 
 /*
  * color add function that preserves ratio
  * idea: https://github.com/Aircoookie/WLED/pull/2465 by https://github.com/Proto-molecule
  */
-uint32_t color_add(uint32_t c1, uint32_t c2, bool fast)
+uint32_t WLED_HOT(color_add) color_add(uint32_t c1, uint32_t c2, bool fast)
 {
+  uint32_t rb = SWAR_RB(c1) + SWAR_RB(c2); // each lane is max 510, overflow bit is 0x100
+  uint32_t wg = SWAR_WG(c1) + SWAR_WG(c2);
+  uint32_t ovf = (rb | wg) & 0x01000100;
+  if (!ovf) return rb | (wg << 8);
   if (fast) {
-    uint8_t r = R(c1);
-    uint8_t g = G(c1);
-    uint8_t b = B(c1);
-    uint8_t w = W(c1);
-    r = qadd8(r, R(c2));
-    g = qadd8(g, G(c2));
-    b = qadd8(b, B(c2));
-    w = qadd8(w, W(c2));
-    return RGBW32(r,g,b,w);
+    // saturate overflowing lanes (same as qadd8)
+    uint32_t rbo = rb & 0x01000100;
+    uint32_t wgo = wg & 0x01000100;
+    rb = (rb | (rbo - (rbo >> 8))) & 0x00FF00FF;
+    wg = (wg | (wgo - (wgo >> 8))) & 0x00FF00FF;
+    return rb | (wg << 8);
   } else {
-    uint32_t r = R(c1) + R(c2);
-    uint32_t g = G(c1) + G(c2);
-    uint32_t b = B(c1) + B(c2);
-    uint32_t w = W(c1) + W(c2);
+    uint32_t r = rb >> 16;
+    uint32_t g = wg & 0xFFFF;
+    uint32_t b = rb & 0xFFFF;
+    uint32_t w = wg >> 16;
     uint16_t max = r;
     if (g > max) max = g;
     if (b > max) max = b;
     if (w > max) max = w;
-    if (max < 256) return RGBW32(r, g, b, w);
-    else           return RGBW32(r * 255 / max, g * 255 / max, b * 255 / max, w * 255 / max);
+    return RGBW32(r * 255 / max, g * 255 / max, b * 255 / max, w * 255 / max);
   }
 }
 
@@ -65,24 +62,156 @@ uint32_t color_add(uint32_t c1, uint32_t c2, bool fast)
  * fades color toward black
  * if using "video" method the resulting color will never become black unless it is already black
  */
-uint32_t color_fade(uint32_t c1, uint8_t amount, bool video)
+uint32_t WLED_HOT(color_fade) color_fade(uint32_t c1, uint8_t amount, bool video)
 {
-  uint8_t r = R(c1);
-  uint8_t g = G(c1);
-  uint8_t b = B(c1);
-  uint8_t w = W(c1);
   if (video) {
-    r = scale8_video(r, amount);
-    g = scale8_video(g, amount);
-    b = scale8_video(b, amount);
-    w = scale8_video(w, amount);
+    // scale8_video(): i * scale / 256, +1 for non-zero channels (if scale is non-zero)
+    if (amount == 0) return 0;
+    uint32_t rb = (SWAR_RB(c1) * amount) >> 8;
+    uint32_t wg = (SWAR_WG(c1) * amount);
+    uint32_t nz = (((c1 & 0x7F7F7F7F) + 0x7F7F7F7F) | c1) & 0x80808080; // 0x80 in each non-zero byte
+    return ((rb & 0x00FF00FF) | (wg & 0xFF00FF00)) + (nz >> 7);
+  }
+  // scale8(): i * (1 + scale) / 256
+  uint32_t scale = amount + 1;
+  uint32_t rb = (SWAR_RB(c1) * scale) >> 8;
+  uint32_t wg = (SWAR_WG(c1) * scale);
+  return (rb & 0x00FF00FF) | (wg & 0xFF00FF00);
+}
+
+/*
+ * bulk variants operating on arrays of packed colors (i.e. segment buffers)
+ */
+void color_blend_n(uint32_t *dst, const uint32_t *src, size_t n, uint8_t amount)
+{
+  if (amount == 0) return;
+  if (amount == 255) { memcpy(dst, src, n * sizeof(uint32_t)); return; }
+  const uint32_t inv = 0xFF - amount;
+  for (size_t i = 0; i < n; i++) {
+    uint32_t c1 = dst[i], c2 = src[i];
+    uint32_t rb = (SWAR_RB(c2) * amount + SWAR_RB(c1) * inv) >> 8;
+    uint32_t wg = (SWAR_WG(c2) * amount + SWAR_WG(c1) * inv);
+    dst[i] = (rb & 0x00FF00FF) | (wg & 0xFF00FF00);
+  }
+}
+
+// per channel product of two colors (255 * 255 = 255)
+static inline uint32_t color_mul(uint32_t c1, uint32_t c2)
+{
+  uint32_t c = 0;
+  for (unsigned s = 0; s < 32; s += 8) c |= ((((c1 >> s) & 0xFF) * (((c2 >> s) & 0xFF) + 1)) >> 8) << s;
+  return c;
+}
+
+// composites src (layer) over dst (pixels below) using blend mode SEG_BLEND_* and layer opacity alpha
+void color_layer_n(uint32_t *dst, const uint32_t *src, size_t n, uint8_t mode, uint8_t alpha)
+{
+  if (alpha == 0) return;
+  const uint32_t inv = 0xFF - alpha;
+  for (size_t i = 0; i < n; i++) {
+    uint32_t c1 = dst[i], c2 = src[i];
+    switch (mode) {
+      case SEG_BLEND_ADD: { // saturating
+        uint32_t rb = SWAR_RB(c1) + SWAR_RB(c2);
+        uint32_t wg = SWAR_WG(c1) + SWAR_WG(c2);
+        rb |= ((rb >> 8) & 0x00010001) * 0xFF;
+        wg |= ((wg >> 8) & 0x00010001) * 0xFF;
+        c2 = (rb & 0x00FF00FF) | ((wg & 0x00FF00FF) << 8);
+        break;
+      }
+      case SEG_BLEND_MULTIPLY: c2 = color_mul(c1, c2); break;
+      case SEG_BLEND_SCREEN:   c2 = ~color_mul(~c1, ~c2); break;
+      case SEG_BLEND_MAX: {
+        uint32_t c = 0;
+        for (unsigned s = 0; s < 32; s += 8) c |= MAX((c1 >> s) & 0xFF, (c2 >> s) & 0xFF) << s;
+        c2 = c;
+        break;
+      }
+    }
+    if (alpha == 255) { dst[i] = c2; continue; }
+    uint32_t rb = (SWAR_RB(c2) * alpha + SWAR_RB(c1) * inv) >> 8;
+    uint32_t wg = (SWAR_WG(c2) * alpha + SWAR_WG(c1) * inv);
+    dst[i] = (rb & 0x00FF00FF) | (wg & 0xFF00FF00);
+  }
+}
+
+void color_add_n(uint32_t *dst, const uint32_t *src, size_t n, bool fast)
+{
+  for (size_t i = 0; i < n; i++) dst[i] = color_add(dst[i], src[i], fast);
+}
+
+/*
+ * ESP32-S3 PIE kernels (128 bit SIMD, 16 channels per instruction), opt-in with -D WLED_ENABLE_S3_SIMD (experimental)
+ * only used where the vector instructions give exactly the scalar result (golden frames must not change), i.e.
+ * scale8(): EE.VMUL.U8 with SAR = 8 is x * y >> 8 per lane. Blending needs the sum of two products before the
+ * shift, which does not fit the unsigned 8 bit lanes (saturating adds are signed), so it stays SWAR.
+ */
+#if defined(WLED_ENABLE_S3_SIMD) && defined(CONFIG_IDF_TARGET_ESP32S3)
+// len multiple of 16, src and dst 16 byte aligned (EE.VLD/VST ignore the low address bits), scale < 255
+// GCC does not know the q registers (they cannot be listed as clobbers), so q0-q2 and SAR are saved and restored
+static void IRAM_ATTR scale8_pie(uint8_t *dst, const uint8_t *src, size_t len, uint8_t scale)
+{
+  uint8_t fv[16] __attribute__((aligned(16)));
+  uint8_t qs[48] __attribute__((aligned(16)));
+  memset(fv, scale + 1, sizeof(fv));
+  uint8_t *q = qs;
+  uint32_t blocks = len >> 4;
+  uint32_t sar;
+  const uint32_t sh = 8;
+  asm volatile (
+    "rsr.sar        %[sar]          \n"
+    "ee.vst.128.ip  q0, %[q], 16    \n"
+    "ee.vst.128.ip  q1, %[q], 16    \n"
+    "ee.vst.128.ip  q2, %[q], -32   \n"
+    "wsr.sar        %[sh]           \n"
+    "ee.vld.128.ip  q1, %[fv], 0    \n"
+    "1:                             \n"
+    "ee.vld.128.ip  q0, %[s], 16    \n"
+    "ee.vmul.u8     q2, q0, q1      \n"
+    "ee.vst.128.ip  q2, %[d], 16    \n"
+    "addi           %[n], %[n], -1  \n"
+    "bnez           %[n], 1b        \n"
+    "ee.vld.128.ip  q0, %[q], 16    \n"
+    "ee.vld.128.ip  q1, %[q], 16    \n"
+    "ee.vld.128.ip  q2, %[q], 0     \n"
+    "wsr.sar        %[sar]          \n"
+    : [s] "+r"(src), [d] "+r"(dst), [n] "+r"(blocks), [q] "+r"(q), [sar] "=&r"(sar)
+    : [fv] "r"(fv), [sh] "r"(sh)
+    : "memory");
+}
+#endif
+
+// dst[i] = scale8(src[i], scale), dst may be src
+void scale8_n(uint8_t *dst, const uint8_t *src, size_t len, uint8_t scale)
+{
+  if (scale == 255) { if (dst != src) memmove(dst, src, len); return; }
+  const uint32_t f = scale + 1;
+  size_t i = 0;
+  #if defined(WLED_ENABLE_S3_SIMD) && defined(CONFIG_IDF_TARGET_ESP32S3)
+  if (len >= 32 && !(((uintptr_t)dst ^ (uintptr_t)src) & 15)) {
+    for (; (uintptr_t)(dst + i) & 15; i++) dst[i] = (src[i] * f) >> 8;
+    size_t n = (len - i) & ~(size_t)15;
+    scale8_pie(dst + i, src + i, n, scale);
+    i += n;
+  }
+  #endif
+  for (; i + 4 <= len; i += 4) {
+    uint32_t v;
+    memcpy(&v, src + i, 4);
+    v = scale8x4(v, f);
+    memcpy(dst + i, &v, 4);
+  }
+  for (; i < len; i++) dst[i] = (src[i] * f) >> 8;
+}
+
+void color_fade_n(uint32_t *dst, size_t n, uint8_t amount, bool video)
+{
+  if (amount == 255 && !video) return; // scale8(x,255) = x
+  if (!video) {
+    scale8_n((uint8_t*)dst, (const uint8_t*)dst, n * sizeof(uint32_t), amount); // per channel, same as per color
   } else {
-    r = scale8(r, amount);
-    g = scale8(g, amount);
-    b = scale8(b, amount);
-    w = scale8(w, amount);
+    for (size_t i = 0; i < n; i++) dst[i] = color_fade(dst[i], amount, true);
   }
-  return RGBW32(r, g, b, w);
 }
 
 void setRandomColor(byte* rgb)
@@ -138,6 +267,52 @@ void colorKtoRGB(uint16_t kelvin, byte* rgb) //white spectrum to rgb, calc
   rgb[3] = 0;
 }
 
+// colorKtoRGB() of white balance correction CCTs (1900K + 32K steps, see BusManager::setSegmentCCT())
+static const uint8_t kelvinBalanceLUT[256*3] PROGMEM = {
+  255,132,  0, 255,133,  4, 255,135,  9, 255,137, 13, 255,138, 18, 255,140, 22, 255,141, 26, 255,143, 30, // 1900K
+  255,144, 34, 255,146, 38, 255,147, 41, 255,149, 45, 255,150, 49, 255,151, 52, 255,153, 55, 255,154, 59, // 2156K
+  255,156, 62, 255,157, 65, 255,158, 68, 255,159, 71, 255,161, 74, 255,162, 77, 255,163, 79, 255,164, 82, // 2412K
+  255,166, 85, 255,167, 87, 255,168, 90, 255,169, 93, 255,170, 95, 255,171, 97, 255,172,100, 255,174,102, // 2668K
+  255,175,105, 255,176,107, 255,177,109, 255,178,111, 255,179,113, 255,180,116, 255,181,118, 255,182,120, // 2924K
+  255,183,122, 255,184,124, 255,185,126, 255,186,128, 255,187,130, 255,188,132, 255,189,134, 255,190,135, // 3180K
+  255,191,137, 255,192,139, 255,193,141, 255,193,143, 255,194,144, 255,195,146, 255,196,148, 255,197,149, // 3436K
+  255,198,151, 255,199,153, 255,200,154, 255,200,156, 255,201,158, 255,202,159, 255,203,161, 255,204,162, // 3692K
+  255,205,164, 255,205,165, 255,206,167, 255,207,168, 255,208,170, 255,208,171, 255,209,172, 255,210,174, // 3948K
+  255,211,175, 255,212,177, 255,212,178, 255,213,179, 255,214,181, 255,214,182, 255,215,183, 255,216,185, // 4204K
+  255,217,186, 255,217,187, 255,218,188, 255,219,190, 255,219,191, 255,220,192, 255,221,193, 255,222,195, // 4460K
+  255,222,196, 255,223,197, 255,224,198, 255,224,199, 255,225,200, 255,226,202, 255,226,203, 255,227,204, // 4716K
+  255,227,205, 255,228,206, 255,229,207, 255,229,208, 255,230,209, 255,231,210, 255,231,211, 255,232,213, // 4972K
+  255,232,214, 255,233,215, 255,234,216, 255,234,217, 255,235,218, 255,235,219, 255,236,220, 255,237,221, // 5228K
+  255,237,222, 255,238,223, 255,238,224, 255,239,225, 255,239,226, 255,240,227, 255,241,228, 255,241,229, // 5484K
+  255,242,229, 255,242,230, 255,243,231, 255,243,232, 255,244,233, 255,244,234, 255,245,235, 255,246,236, // 5740K
+  255,246,237, 255,247,238, 255,247,238, 255,248,239, 255,248,240, 255,249,241, 255,249,242, 255,250,243, // 5996K
+  255,250,244, 255,251,244, 255,251,245, 255,252,246, 255,252,247, 255,253,248, 255,253,249, 255,254,249, // 6252K
+  255,254,250, 255,255,251, 255,255,252, 255,252,255, 255,251,255, 255,250,255, 254,249,255, 253,248,255, // 6508K
+  251,247,255, 250,246,255, 249,246,255, 248,245,255, 246,244,255, 245,244,255, 244,243,255, 243,242,255, // 6764K
+  242,242,255, 241,241,255, 240,241,255, 239,240,255, 238,240,255, 237,239,255, 236,239,255, 236,238,255, // 7020K
+  235,238,255, 234,237,255, 233,237,255, 233,236,255, 232,236,255, 231,236,255, 231,235,255, 230,235,255, // 7276K
+  229,234,255, 229,234,255, 228,234,255, 227,233,255, 227,233,255, 226,233,255, 226,232,255, 225,232,255, // 7532K
+  225,232,255, 224,231,255, 223,231,255, 223,231,255, 222,231,255, 222,230,255, 222,230,255, 221,230,255, // 7788K
+  221,229,255, 220,229,255, 220,229,255, 219,229,255, 219,228,255, 218,228,255, 218,228,255, 218,228,255, // 8044K
+  217,227,255, 217,227,255, 216,227,255, 216,227,255, 216,226,255, 215,226,255, 215,226,255, 214,226,255, // 8300K
+  214,226,255, 214,225,255, 213,225,255, 213,225,255, 213,225,255, 212,225,255, 212,224,255, 212,224,255, // 8556K
+  211,224,255, 211,224,255, 211,224,255, 210,223,255, 210,223,255, 210,223,255, 210,223,255, 209,223,255, // 8812K
+  209,222,255, 209,222,255, 208,222,255, 208,222,255, 208,222,255, 208,222,255, 207,221,255, 207,221,255, // 9068K
+  207,221,255, 206,221,255, 206,221,255, 206,221,255, 206,221,255, 205,220,255, 205,220,255, 205,220,255, // 9324K
+  205,220,255, 204,220,255, 204,220,255, 204,219,255, 204,219,255, 204,219,255, 203,219,255, 203,219,255, // 9580K
+  203,219,255, 203,219,255, 202,218,255, 202,218,255, 202,218,255, 202,218,255, 202,218,255, 201,218,255  // 9836K
+};
+
+// white balance multipliers of a color temperature, float math only for temperatures outside LUT
+void colorKtoBalance(uint16_t kelvin, byte* rgb)
+{
+  unsigned n = (kelvin - 1900) >> 5;
+  if (kelvin >= 1900 && !((kelvin - 1900) & 31) && n < 256) {
+    memcpy_P(rgb, &kelvinBalanceLUT[n*3], 3);
+    rgb[3] = 0;
+  } else colorKtoRGB(kelvin, rgb);
+}
+
 void colorCTtoRGB(uint16_t mired, byte* rgb) //white spectrum to rgb, bins
 {
   //this is only an approximation using WS2812B with gamma correction enabled
@@ -288,13 +463,13 @@ uint32_t colorBalanceFromKelvin(uint16_t kelvin, uint32_t rgb)
   //remember so that slow colorKtoRGB() doesn't have to run for every setPixelColor()
   static byte correctionRGB[4] = {0,0,0,0};
   static uint16_t lastKelvin = 0;
-  if (lastKelvin != kelvin) colorKtoRGB(kelvin, correctionRGB);  // convert Kelvin to RGB
+  if (lastKelvin != kelvin) colorKtoBalance(kelvin, correctionRGB);  // convert Kelvin to RGB
   lastKelvin = kelvin;
-  byte rgbw[4];
-  rgbw[0] = ((uint16_t) correctionRGB[0] * R(rgb)) /255; // correct R
-  rgbw[1] = ((uint16_t) correctionRGB[1] * G(rgb)) /255; // correct G
-  rgbw[2] = ((uint16_t) correctionRGB[2] * B(rgb)) /255; // correct B
-  rgbw[3] =                                W(rgb);
+  byte rgbw[4]; // div255() avoids division for every pixel
+  rgbw[0] = div255((uint16_t) correctionRGB[0] * R(rgb)); // correct R
+  rgbw[1] = div255((uint16_t) correctionRGB[1] * G(rgb)); // correct G
+  rgbw[2] = div255((uint16_t) correctionRGB[2] * B(rgb)); // correct B
+  rgbw[3] =                                      W(rgb);
   return RGBW32(rgbw[0],rgbw[1],rgbw[2],rgbw[3]);
 }
 
@@ -356,6 +531,29 @@ uint8_t NeoGammaWLEDMethod::gammaT[256] = {
   177,180,182,184,186,189,191,193,196,198,200,203,205,208,210,213,
   215,218,220,223,225,228,231,233,236,239,241,244,247,249,252,255 };
 
+#ifdef WLED_ENABLE_OUTPUT_GAMMA
+// 16 bit gamma table used by busses at output, (re)filled on first use after gamma value changed
+static uint16_t gammaT16[256] = {0};
+static float gammaT16Val = 0.0f;
+
+static void calcGammaTable16(float gamma)
+{
+  for (size_t i = 0; i < 256; i++) {
+    gammaT16[i] = (int)(powf((float)i / 255.0f, gamma) * 65535.0f + 0.5f);
+  }
+  gammaT16Val = gamma;
+}
+
+// returns 16 bit gamma table for output, nullptr if colors are to be sent as-is
+const uint16_t *getOutputGammaTable()
+{
+  if (!gammaCorrectCol) return nullptr;
+  if (realtimeMode && arlsDisableGammaCorrection) return nullptr;
+  if (gammaT16Val != gammaCorrectVal) calcGammaTable16(gammaCorrectVal);
+  return gammaT16;
+}
+#endif
+
 // re-calculates & fills gamma table
 void NeoGammaWLEDMethod::calcGammaTable(float gamma)
 {
@@ -371,7 +569,7 @@ uint8_t NeoGammaWLEDMethod::Correct(uint8_t value)
 }
 
 // used for color gamma correction
-uint32_t NeoGammaWLEDMethod::Correct32(uint32_t color)
+uint32_t WLED_HOT(gamma32) NeoGammaWLEDMethod::Correct32(uint32_t color)
 {
   if (!gammaCorrectCol) return color;
   uint8_t w = W(color);
@@ -23,6 +23,10 @@
   #endif
 #endif
 
+#ifndef WLED_MAX_UM_HANDLES
+  #define WLED_MAX_UM_HANDLES 4     // published usermod data handles (see UsermodManager::publishUMData())
+#endif
+
 #ifndef WLED_MAX_BUSSES
   #ifdef ESP8266
     #define WLED_MAX_BUSSES 3
@@ -40,8 +44,13 @@
         #define WLED_MIN_VIRTUAL_BUSSES 3
       #endif
     #elif defined(CONFIG_IDF_TARGET_ESP32S3)  // 4 RMT, 8 LEDC, has 2 I2S but NPB does not support them ATM
-      #define WLED_MAX_BUSSES 6               // will allow 4 digital & 2 analog
-      #define WLED_MIN_VIRTUAL_BUSSES 4
+      #ifdef WLED_USE_PARALLEL_I2S
+        #define WLED_MAX_BUSSES 10            // will allow 8 digital (LCD parallel output) & 2 analog
+        #define WLED_MIN_VIRTUAL_BUSSES 0
+      #else
+        #define WLED_MAX_BUSSES 6             // will allow 4 digital & 2 analog
+        #define WLED_MIN_VIRTUAL_BUSSES 4
+      #endif
     #else
       #if defined(USERMOD_AUDIOREACTIVE)      // requested by @softhack007 https://github.com/blazoncek/WLED/issues/33
         #define WLED_MAX_BUSSES 8
@@ -91,6 +100,23 @@
   #endif
 #endif
 
+#ifndef WLED_MAX_SCHED_TASKS
+  #define WLED_MAX_SCHED_TASKS 40 // loop() subsystems, usermods may register further tasks
+#endif
+
+// custom palettes (palette0.json ...) use palette IDs counting down from 255
+#if defined(WLED_MAX_CUSTOM_PALETTES) && (WLED_MAX_CUSTOM_PALETTES > 64 || WLED_MAX_CUSTOM_PALETTES < 10)
+  #undef WLED_MAX_CUSTOM_PALETTES
+#endif
+#ifndef WLED_MAX_CUSTOM_PALETTES
+  #define WLED_MAX_CUSTOM_PALETTES 10
+#endif
+#define WLED_CUSTOM_PALETTES_START (255 - WLED_MAX_CUSTOM_PALETTES) // last ID before the custom palettes
+
+#ifndef WLED_MAX_RT_ROUTES
+  #define WLED_MAX_RT_ROUTES 8 // realtime routes (realtime stream ranges into segments)
+#endif
+
 #ifndef WLED_MAX_SEGNAME_LEN
   #ifdef ESP8266
     #define WLED_MAX_SEGNAME_LEN 32
@@ -193,6 +219,9 @@
 #define REALTIME_MODE_ARTNET      6
 #define REALTIME_MODE_TPM2NET     7
 #define REALTIME_MODE_DDP         8
+#define REALTIME_MODE_FSEQ        9
+#define REALTIME_MODE_DMX         10   // wired DMX512 input
+#define REALTIME_MODE_LAST        REALTIME_MODE_DMX // highest source, sizes per source statistics
 
 //realtime override modes
 #define REALTIME_OVERRIDE_NONE    0
@@ -254,9 +283,10 @@
 #define TYPE_LPD6803             54
 //Network types (master broadcast) (80-95)
 #define TYPE_NET_DDP_RGB         80            //network DDP RGB bus (master broadcast bus)
-#define TYPE_NET_E131_RGB        81            //network E131 RGB bus (master broadcast bus, unused)
+#define TYPE_NET_E131_RGB        81            //network E131 RGB bus (master broadcast bus)
 #define TYPE_NET_ARTNET_RGB      82            //network ArtNet RGB bus (master broadcast bus, unused)
 #define TYPE_NET_DDP_RGBW        88            //network DDP RGBW bus (master broadcast bus)
+#define TYPE_NET_DDP_TILES       89            //network DDP RGB bus split into 2D panels (tiles), each sent to its follower, synced by one push
 
 #define IS_DIGITAL(t) ((t) & 0x10) //digital are 16-31 and 48-63
 #define IS_PWM(t)     ((t) > 40 && (t) < 46)
@@ -328,6 +358,14 @@
 #define SEG_DIFFERS_GSO        0x20 // grouping, spacing & offset
 #define SEG_DIFFERS_SEL        0x80 // selected
 
+//Segment blend modes (how a segment is composited over the segments below it)
+#define SEG_BLEND_NORMAL          0
+#define SEG_BLEND_ADD             1
+#define SEG_BLEND_MULTIPLY        2
+#define SEG_BLEND_SCREEN          3
+#define SEG_BLEND_MAX             4            //lighten (per channel maximum)
+#define SEG_BLEND_COUNT           5
+
 //Playlist option byte
 #define PL_OPTION_SHUFFLE      0x01
 
@@ -383,14 +421,21 @@
 #ifndef MAX_LEDS
 #ifdef ESP8266
 #define MAX_LEDS 1664 //can't rely on memory limit to limit this to 1600 LEDs
+#elif defined(WLED_USE_PSRAM) && defined(BOARD_HAS_PSRAM)
+#define MAX_LEDS 32768 //pixel buffers, ledmap and network bus buffers of large canvases are placed in PSRAM
 #else
 #define MAX_LEDS 8192
 #endif
 #endif
+#if MAX_LEDS >= 65535
+  #error "MAX_LEDS must be below 65535, pixel indices are 16 bit (UINT16_MAX marks unmapped pixels)."
+#endif
 
 #ifndef MAX_LED_MEMORY
   #ifdef ESP8266
     #define MAX_LED_MEMORY 4000
+  #elif defined(WLED_USE_PSRAM) && defined(BOARD_HAS_PSRAM)
+    #define MAX_LED_MEMORY 512000
   #else
     #if defined(ARDUINO_ARCH_ESP32S2) || defined(ARDUINO_ARCH_ESP32C3)
       #define MAX_LED_MEMORY 32000
@@ -411,13 +456,47 @@
 #define SETTINGS_STACK_BUF_SIZE 3608  // warning: quite a large value for stack
 #endif
 
-#ifdef WLED_USE_ETHERNET
-  #define E131_MAX_UNIVERSE_COUNT 20
+// settings JS is generated into a chain of pages of this size and sent chunked (no size limit)
+#ifdef ESP8266
+#define OAPPEND_PAGE_SIZE 512
 #else
+#define OAPPEND_PAGE_SIZE 1024
+#endif
+
+// WLED sync notification packet: 41 byte header, UDP_SEG_SIZE bytes per segment, 2 byte keyframe trailer
+#define UDP_SEG_SIZE 36
+#define WLEDPACKETSIZE (41+(MAX_NUM_SEGMENTS*UDP_SEG_SIZE)+2)
+#define UDP_NOTIFY_DELTA 0xD0  // first byte of delta notification, also marks keyframe trailer of full packets
+
+// delta notifications: a full packet (keyframe) is sent if the last one is older than this (ms)
+#ifndef WLED_NOTIFY_KEYFRAME_INTERVAL
+  #define WLED_NOTIFY_KEYFRAME_INTERVAL 2000
+#endif
+
+// ESP-NOW sync: frame clock beacon interval (ms)
+#ifndef WLED_ESPNOW_BEACON_INTERVAL
+  #define WLED_ESPNOW_BEACON_INTERVAL 1000
+#endif
+
+// default time (ms) after which incomplete realtime frames (lost packets, missing sync) are shown anyway
+#ifndef E131_FRAME_TIMEOUT
+  #define E131_FRAME_TIMEOUT 15
+#endif
+// max. configurable delay (ms) added to DDP timecodes; frames timecoded further ahead than this (plus 1s) are shown immediately
+#ifndef DDP_MAX_PRESENTATION_DELAY
+  #define DDP_MAX_PRESENTATION_DELAY 500
+#endif
+// senders that stop sending E1.31 sync packets, ArtSync or DDP push for this long (ms) fall back to unsynchronized frames
+#ifndef E131_SYNC_TIMEOUT
+  #define E131_SYNC_TIMEOUT 4000
+#endif
+
+// UART receive buffer for Adalight/TPM2 (bytes), holds at least one frame of 300 RGB pixels
+#ifndef WLED_SERIAL_RX_BUFFER
   #ifdef ESP8266
-    #define E131_MAX_UNIVERSE_COUNT 9
+    #define WLED_SERIAL_RX_BUFFER 1024
   #else
-    #define E131_MAX_UNIVERSE_COUNT 12
+    #define WLED_SERIAL_RX_BUFFER 2048
   #endif
 #endif
 
@@ -439,6 +518,20 @@
   #define WLED_PWM_FREQ  19531
 #endif
 #endif
+// highest PWM resolution (bits) used, actual resolution also depends on frequency (ESP32 LEDC timer runs at 80MHz)
+#ifndef WLED_PWM_MAX_BITS
+  #if defined(ESP8266)
+    #define WLED_PWM_MAX_BITS 8  // analogWriteRange() is global, keep 8 bit for other users
+  #elif defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32S3) || defined(CONFIG_IDF_TARGET_ESP32C3)
+    #define WLED_PWM_MAX_BITS 14
+  #else
+    #define WLED_PWM_MAX_BITS 16
+  #endif
+#endif
+// frames closer together than this (ms) are faded in between by LEDC hardware
+#ifndef WLED_PWM_FADE_MAX_INTERVAL
+  #define WLED_PWM_FADE_MAX_INTERVAL 100
+#endif
 
 #define TOUCH_THRESHOLD 32 // limit to recognize a touch, higher value means more sensitive
 
@@ -449,9 +542,152 @@
   #define JSON_BUFFER_SIZE 24576
 #endif
 
+// global JSON doc is allocated on first use and freed after this many ms without use (0: keep once allocated)
+// ESP8266 keeps it by default as a fragmented heap may not offer the block again
+#ifndef WLED_JSON_IDLE_RELEASE
+  #ifdef ESP8266
+    #define WLED_JSON_IDLE_RELEASE 0
+  #else
+    #define WLED_JSON_IDLE_RELEASE 30000
+  #endif
+#endif
+#define JSON_BUFFER_MIN_SIZE 2048 // smallest global doc allocated for a sized request
+
+// JSON buffer pool: global doc plus buffers allocated at boot if memory allows
+#ifndef WLED_JSON_POOL_SIZE
+  #ifdef ESP8266
+    #define WLED_JSON_POOL_SIZE 1
+  #else
+    #define WLED_JSON_POOL_SIZE 4
+  #endif
+#endif
+
+// JSON buffer owners (requestJSONBufferLock()/requestJSONBuffer()), usermods may use other values below JSON_LOCK_OWNERS
+#define JSON_LOCK_OTHER           0
+#define JSON_LOCK_CFG_DES         1
+#define JSON_LOCK_CFG_SER         2
+#define JSON_LOCK_CFG_SEC_DES     3
+#define JSON_LOCK_CFG_SEC_SER     4
+#define JSON_LOCK_SETTINGS        5
+#define JSON_LOCK_XML             6
+#define JSON_LOCK_LEDMAP          7
+#define JSON_LOCK_EEPROM          8
+#define JSON_LOCK_PRESET_LOAD     9
+#define JSON_LOCK_PRESET_SAVE    10
+#define JSON_LOCK_WS_RECEIVE     11
+#define JSON_LOCK_WS_SEND        12
+#define JSON_LOCK_IR             13
+#define JSON_LOCK_HTTP_POST      14
+#define JSON_LOCK_MQTT           15
+#define JSON_LOCK_SERIAL         16
+#define JSON_LOCK_SERVEJSON      17
+#define JSON_LOCK_UDP_API        18
+#define JSON_LOCK_WS_RTSTATS     19
+#define JSON_LOCK_2D_GAPS        20
+#define JSON_LOCK_LEDMAP_ENUM    21
+#define JSON_LOCK_PRESET_API     22
+#define JSON_LOCK_PRESET_CONV    23
+#define JSON_LOCK_FS_BENCH       24
+#define JSON_LOCK_OWNERS         25
+
+// HTTP admission control (wled_server.cpp): request classes in order of priority
+#define ADM_CLASS_RT    0 // realtime pixel data (POST /json/leds), never refused
+#define ADM_CLASS_CTRL  1 // JSON and HTTP API, settings, updates
+#define ADM_CLASS_UI    2 // pages, assets, files and read-only JSON (effect/palette data, nodes, statistics)
+#define ADM_CLASSES     3
+// concurrent requests per class (from request headers until the connection is closed), more get 503
+#ifndef WLED_ADM_MAX_CTRL
+  #define WLED_ADM_MAX_CTRL 4
+#endif
+#ifndef WLED_ADM_MAX_UI
+  #ifdef ESP8266
+    #define WLED_ADM_MAX_UI 2
+  #else
+    #define WLED_ADM_MAX_UI 4
+  #endif
+#endif
+// ms a request may wait for the JSON buffer before it is answered 503 (control requests and WS wait 1000 ms)
+#ifndef WLED_ADM_WAIT_UI
+  #define WLED_ADM_WAIT_UI 250
+#endif
+// ms WS broadcasts stay state-only after a send buffer could not be allocated
+#ifndef WLED_WS_DEGRADE_HOLD
+  #define WLED_WS_DEGRADE_HOLD 10000
+#endif
+
+// event trace (trace.cpp): ring entries (power of 2, 12 bytes each, allocated when recording is started)
+#ifndef WLED_TRACE_LEN
+  #ifdef ESP8266
+    #define WLED_TRACE_LEN 256
+  #else
+    #define WLED_TRACE_LEN 2048
+  #endif
+#endif
+#define TRACE_LOOP      1 // loop() iteration
+#define TRACE_TASK      2 // scheduler task (arg: task id)
+#define TRACE_FX        3 // effect function (arg: segment, data: mode | render core << 8)
+#define TRACE_SHOW      4 // BusManager::show()
+#define TRACE_BUS       5 // show() of a bus (arg: bus), transfer continues in background
+#define TRACE_BUS_DONE  6 // bus transfer from start until it was seen complete (arg: bus)
+#define TRACE_PACKET    7 // realtime packet received (arg: realtime mode), instant
+#define TRACE_WS        8 // WS state message sent (arg: clients)
+#define TRACE_JSON      9 // JSON buffer held (arg: owner, data: wait ms | pool slot << 12)
+
 //#define MIN_HEAP_SIZE (8k for AsyncWebServer)
 #define MIN_HEAP_SIZE 8192
 
+// give up associating with the cached access point (network.cpp) and scan after this many ms
+#ifndef WLED_FAST_CONNECT_TIMEOUT
+  #define WLED_FAST_CONNECT_TIMEOUT 3000
+#endif
+
+// heap monitor (heapmon.cpp): allocations are attributed to these subsystems
+#define HEAP_TAG_OTHER    0
+#define HEAP_TAG_SEGDATA  1 // effect data arena and its heap fallbacks
+#define HEAP_TAG_PIXELS   2 // segment pixel buffers and index maps
+#define HEAP_TAG_TRANS    3 // mode blending copies of segment data and pixels
+#define HEAP_TAG_BUS      4 // bus objects and their buffers
+#define HEAP_TAG_WS       5 // WebSocket message buffers (released by AsyncWebSocket once sent)
+#define HEAP_TAG_JSON     6 // JSON buffer pool
+#define HEAP_TAG_COUNT    7
+
+#ifndef WLED_PSRAM_MIN_ALLOC
+  #define WLED_PSRAM_MIN_ALLOC 4096 // "large" buffers at least this size go to PSRAM (if used), smaller ones stay in internal RAM
+#endif
+
+// placement of render hot paths in internal RAM, see hot_profile.h (IRAM_ATTR/DRAM_ATTR are ESP32 macros from esp_attr.h)
+#if defined(WLED_ENABLE_HOT_IRAM) && defined(ARDUINO_ARCH_ESP32)
+  #ifndef WLED_HOT_PROFILE
+    #define WLED_HOT_PROFILE "hot_profile.h"
+  #endif
+  #define WLED_IRAM IRAM_ATTR
+  #define WLED_DRAM DRAM_ATTR
+  #include WLED_HOT_PROFILE
+  #define WLED_HOT(name) WLED_HOT_##name
+#else
+  #define WLED_HOT(name)
+#endif
+
+#ifndef WLED_LED_RESET_US
+  #define WLED_LED_RESET_US   300 // latch time of 1-wire LEDs (WS2812B/WS2813), added to wire time of every frame
+#endif
+#ifndef WLED_NET_PACKET_US
+  #define WLED_NET_PACKET_US  250 // typical time to send one UDP packet of a network bus (excluding pacing)
+#endif
+
+#define HEAP_WARN_OK      0
+#define HEAP_WARN_LOW     1 // largest free block below WLED_HEAP_WARN_BLOCK, allocations will start failing soon
+#define HEAP_WARN_CRIT    2 // below WLED_HEAP_CRIT_BLOCK or a tracked allocation failed recently
+
+#ifndef WLED_HEAP_WARN_BLOCK
+  #define WLED_HEAP_WARN_BLOCK (MIN_HEAP_SIZE + MAX_SEGMENT_DATA) // enough to re-create the effect data arena
+#endif
+#ifndef WLED_HEAP_CRIT_BLOCK
+  #define WLED_HEAP_CRIT_BLOCK MIN_HEAP_SIZE
+#endif
+#define HEAP_HISTORY_LEN  30
+#define HEAP_HISTORY_MS   60000
+
 // Maximum size of node map (list of other WLED instances)
 #ifdef ESP8266
   #define WLED_MAX_NODES 24
@@ -459,6 +695,13 @@
   #define WLED_MAX_NODES 150
 #endif
 
+// cluster clock sync (timebase) roles
+#define CLOCK_SYNC_OFF       0
+#define CLOCK_SYNC_FOLLOWER  1
+#define CLOCK_SYNC_LEADER    2
+#define CLOCK_SYNC_INTERVAL  1000 // ms between announcements/requests
+#define CLOCK_SYNC_TIMEOUT   5000 // ms without announcement after which the leader is considered gone
+
 //this is merely a default now and can be changed at runtime
 #ifndef LEDPIN
 #if defined(ESP8266) || (defined(ARDUINO_ARCH_ESP32) && defined(WLED_USE_PSRAM)) || defined(CONFIG_IDF_TARGET_ESP32C3) || defined(ARDUINO_ESP32_PICO)
@@ -481,6 +724,7 @@
 #endif
 
 #define INTERFACE_UPDATE_COOLDOWN 1000 // time in ms to wait between websockets, alexa, and MQTT updates
+#define CONFIG_SAVE_DELAY         1000 // time in ms config changes are collected before cfg.json is written (immediately if rebooting)
 
 #define PIN_RETRY_COOLDOWN   3000 // time in ms after an incorrect attempt PIN and OTA pass will be rejected even if correct
 #define PIN_TIMEOUT        900000 // time in ms after which the PIN will be required again, 15 minutes
@@ -22,7 +22,7 @@ var pN = "", pI = 0, pNum = 0;
 var pmt = 1, pmtLS = 0, pmtLast = 0;
 var lastinfo = {};
 var isM = false, mw = 0, mh=0;
-var ws, cpick, ranges, wsRpt=0;
+var ws, wsState = null, cpick, ranges, wsRpt=0;
 var cfg = {
 	theme:{base:"dark", bg:{url:""}, alpha:{bg:0.6,tab:0.8}, color:{bg:""}},
 	comp :{colors:{picker: true, rgb: false, quick: true, hex: false},
@@ -452,7 +452,8 @@ function loadPresets(callback = null)
 	if (!callback && pmt == pmtLast) return;
 
 	fetch(getURL('/presets.json'), {
-		method: 'get'
+		method: 'get',
+		cache: 'no-cache' // revalidate (ETag), unchanged presets are not downloaded again
 	})
 	.then(res => {
 		if (res.status=="404") return {"0":{}};
@@ -750,6 +751,16 @@ function populateSegments(s)
 							`<option value="3" ${inst.m12==3?' selected':''}>Corner</option>`+
 						`</select></div>`+
 					`</div>`;
+		let rsIdx = (inst.rs||0) + (inst.rs && inst.rsm ? 2 : 0);
+		let rndScl = `<div class="lbl-s">Render scale<br>`+
+						`<div class="sel-p"><select class="sel-p" id="seg${i}rs" onchange="setRS(${i})">`+
+							`<option value="0" ${rsIdx==0?' selected':''}>Full</option>`+
+							`<option value="1" ${rsIdx==1?' selected':''}>1/2</option>`+
+							`<option value="2" ${rsIdx==2?' selected':''}>1/4</option>`+
+							`<option value="3" ${rsIdx==3?' selected':''}>1/2 smooth</option>`+
+							`<option value="4" ${rsIdx==4?' selected':''}>1/4 smooth</option>`+
+						`</select></div>`+
+					`</div>`;
 		let sndSim = `<div data-snd="si" class="lbl-s hide">Sound sim<br>`+
 						`<div class="sel-p"><select class="sel-p" id="seg${i}si" onchange="setSi(${i})">`+
 							`<option value="0" ${inst.si==0?' selected':''}>BeatSin</option>`+
@@ -804,8 +815,9 @@ function populateSegments(s)
 					`</table>`+
 					`<div class="h bp" id="seg${i}len"></div>`+
 					(!isMSeg ? rvXck : '') +
-					(isMSeg&&stoY-staY>1&&stoX-staX>1 ? map2D : '') +
+					(isMSeg&&stoY-staY>1&&stoX-staX>1 ? map2D + rndScl : '') +
 					(s.AudioReactive && s.AudioReactive.on ? "" : sndSim) +
+					`<label class="check revchkl" title="Blend frames between effect updates">Interpolate<input type="checkbox" id="seg${i}ip" onchange="setIp(${i})" ${inst.ip?"checked":""}><span class="checkmark"></span></label>`+
 					`<label class="check revchkl" id="seg${i}lbtm">`+
 						(isMSeg?'Transpose':'Mirror effect') + (isMSeg ?
 						'<input type="checkbox" id="seg'+i+'tp" onchange="setTp('+i+')" '+(inst.tp?"checked":"")+'>':
@@ -1311,14 +1323,56 @@ function cmpP(a, b)
 	return n.localeCompare((b[1].playlist ? '<' : y) + b[1].n, undefined, {numeric: true});
 }
 
+// MessagePack decoder for state messages ({"enc":1}), covers the types sent by WLED
+function mpDecode(buf)
+{
+	let v = new DataView(buf), p = 0;
+	const str = (n)=>{ let s = new TextDecoder().decode(new Uint8Array(buf, p, n)); p += n; return s; };
+	const arr = (n)=>{ let a = []; while (n--) a.push(rd()); return a; };
+	const map = (n)=>{ let o = {}; while (n--) { let k = rd(); o[k] = rd(); } return o; };
+	const rd = ()=>{
+		let t = v.getUint8(p++), r;
+		if (t < 0x80) return t;
+		if (t < 0x90) return map(t & 15);
+		if (t < 0xA0) return arr(t & 15);
+		if (t < 0xC0) return str(t & 31);
+		if (t >= 0xE0) return t - 256;
+		switch (t) {
+			case 0xC0: return null;
+			case 0xC2: return false;
+			case 0xC3: return true;
+			case 0xCA: r = v.getFloat32(p); p += 4; return r;
+			case 0xCB: r = v.getFloat64(p); p += 8; return r;
+			case 0xCC: return v.getUint8(p++);
+			case 0xCD: r = v.getUint16(p); p += 2; return r;
+			case 0xCE: r = v.getUint32(p); p += 4; return r;
+			case 0xD0: return v.getInt8(p++);
+			case 0xD1: r = v.getInt16(p); p += 2; return r;
+			case 0xD2: r = v.getInt32(p); p += 4; return r;
+			case 0xD9: return str(v.getUint8(p++));
+			case 0xDA: r = v.getUint16(p); p += 2; return str(r);
+			case 0xDB: r = v.getUint32(p); p += 4; return str(r);
+			case 0xDC: r = v.getUint16(p); p += 2; return arr(r);
+			case 0xDD: r = v.getUint32(p); p += 4; return arr(r);
+			case 0xDE: r = v.getUint16(p); p += 2; return map(r);
+			case 0xDF: r = v.getUint32(p); p += 4; return map(r);
+		}
+		throw "MessagePack type " + t;
+	};
+	return rd();
+}
+
 function makeWS() {
 	if (ws || lastinfo.ws < 0) return;
 	let url = loc ? getURL('/ws').replace("http","ws") : "ws://"+window.location.hostname+"/ws";
 	ws = new WebSocket(url);
 	ws.binaryType = "arraybuffer";
 	ws.onmessage = (e)=>{
-		if (e.data instanceof ArrayBuffer) return; // liveview packet
-		var json = JSON.parse(e.data);
+		var json;
+		if (e.data instanceof ArrayBuffer) {
+			if (new Uint8Array(e.data)[0] == 76) return; // liveview packet ('L')
+			json = mpDecode(e.data); // state in MessagePack
+		} else json = JSON.parse(e.data);
 		if (json.leds) return; // JSON liveview packet
 		clearTimeout(jsonTimeout);
 		jsonTimeout = null;
@@ -1333,6 +1387,16 @@ function makeWS() {
 		} else
 			i = lastinfo;
 		var s = json.state ? json.state : json;
+		if (json.patch) { // only changed keys and segments since last message
+			if (!wsState) return;
+			delete wsState.error;
+			for (let k in json.patch) if (k !== "seg") wsState[k] = json.patch[k];
+			for (let ps of (json.patch.seg||[])) {
+				let j = wsState.seg.findIndex((x)=>x.id == ps.id);
+				if (j < 0) wsState.seg.push(ps); else wsState.seg[j] = ps;
+			}
+			s = wsState;
+		} else if (json.state) wsState = json.state;
 		displayRover(i, s);
 		readState(s);
 	};
@@ -1340,9 +1404,11 @@ function makeWS() {
 		gId('connind').style.backgroundColor = "var(--c-r)";
 		if (wsRpt++ < 5) setTimeout(makeWS,1500); // retry WS connection
 		ws = null;
+		wsState = null;
 	}
 	ws.onopen = (e)=>{
 		//ws.send("{'v':true}"); // unnecessary (https://github.com/Aircoookie/WLED/blob/master/wled00/ws.cpp#L18)
+		ws.send('{"sub":1,"enc":1}'); // receive state patches instead of full state+info, MessagePack encoded
 		wsRpt = 0;
 		reqsLegal = true;
 	}
@@ -2195,6 +2261,19 @@ function setM12(s)
 	requestJson(obj);
 }
 
+function setIp(s)
+{
+	var obj = {"seg": {"id": s, "ip": gId(`seg${s}ip`).checked}};
+	requestJson(obj);
+}
+
+function setRS(s)
+{
+	var value = gId(`seg${s}rs`).selectedIndex;
+	var obj = {"seg": {"id": s, "rs": value > 2 ? value - 2 : value, "rsm": value > 2}};
+	requestJson(obj);
+}
+
 function setSi(s)
 {
 	var value = gId(`seg${s}si`).selectedIndex;
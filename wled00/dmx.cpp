@@ -12,60 +12,89 @@
 
 #ifdef WLED_ENABLE_DMX
 
+#define DMX_CH_CONST 0xFE     // channel program: fixed value
+#define DMX_CH_BRI   0xFF     // channel program: master brightness (shutter)
+
+// fixture map compiled into one instruction per fixture channel, rebuilt when DMX settings or LED count change
+static struct {
+  uint8_t  shift[15];         // bit position of the color component in the pixel color or DMX_CH_*
+  uint8_t  value[15];         // value for DMX_CH_CONST
+  uint8_t  channels;
+  bool     scale;             // scale colors by brightness (no shutter channel)
+  uint16_t fixtures;          // fixtures that fit into the universe
+  uint32_t key;
+} dmxProg = {{0},{0},0,false,0,0};
+static uint32_t dmxFrame = 0; // strip frame last copied into the DMX buffer
+static uint8_t  dmxBri = 0;
+
+static void compileDMX(uint16_t len)
+{
+  uint8_t channels = min((unsigned)DMXChannels, sizeof(dmxProg.shift));
+  dmxProg.channels = channels;
+  dmxProg.scale = true;
+  for (unsigned j = 0; j < channels; j++) {
+    uint8_t s = DMX_CH_CONST, v = 0;
+    switch (DMXFixtureMap[j]) {
+      case 0: v = 0;                 break; // Set this channel to 0. Good way to tell strobe- and fade-functions to fuck right off.
+      case 1: s = 16;                break; // Red
+      case 2: s = 8;                 break; // Green
+      case 3: s = 0;                 break; // Blue
+      case 4: s = 24;                break; // White
+      case 5: s = DMX_CH_BRI; dmxProg.scale = false; break; // Shutter channel. Controls the brightness.
+      case 6: v = 255;               break; // Sets this channel to 255. Like 0, but more wholesome.
+    }
+    dmxProg.shift[j] = s;
+    dmxProg.value[j] = v;
+  }
+  // fixtures whose channels would lie beyond the universe are not sent
+  unsigned fixtures = len > DMXStartLED ? len - DMXStartLED : 0;
+  if (channels == 0 || DMXStart < 1 || DMXStart + channels - 1 > 512) fixtures = 0;
+  else if (DMXGap > 0) fixtures = min(fixtures, (unsigned)(512 - (DMXStart + channels - 1)) / DMXGap + 1);
+  else fixtures = min(fixtures, 1U);
+  dmxProg.fixtures = fixtures;
+  dmxFrame = strip.getFrameCount() - 1; // force refill
+}
+
 void handleDMX()
 {
   // don't act, when in DMX Proxy mode
   if (e131ProxyUniverse != 0) return;
-
-  uint8_t brightness = strip.getBrightness();
-
-  bool calc_brightness = true;
-
-   // check if no shutter channel is set
-   for (byte i = 0; i < DMXChannels; i++)
-   {
-     if (DMXFixtureMap[i] == 5) calc_brightness = false;
-   }
+  // previous frame still on the wire, it is only sent on the next call
+  if (dmx.sending()) return;
 
   uint16_t len = strip.getLengthTotal();
-  for (int i = DMXStartLED; i < len; i++) {        // uses the amount of LEDs as fixture count
-
-    uint32_t in = strip.getPixelColor(i);     // get the colors for the individual fixtures as suggested by Aircoookie in issue #462
-    byte w = W(in);
-    byte r = R(in);
-    byte g = G(in);
-    byte b = B(in);
+  uint8_t settings[] = {DMXChannels, uint8_t(DMXGap), uint8_t(DMXGap >> 8), uint8_t(DMXStart), uint8_t(DMXStart >> 8),
+                        uint8_t(DMXStartLED), uint8_t(DMXStartLED >> 8), uint8_t(len), uint8_t(len >> 8)};
+  uint32_t key = fnv1a(DMXFixtureMap, sizeof(DMXFixtureMap), fnv1a(settings, sizeof(settings)));
+  if (key != dmxProg.key) {
+    dmxProg.key = key;
+    compileDMX(len);
+  }
 
-    int DMXFixtureStart = DMXStart + (DMXGap * (i - DMXStartLED));
-    for (int j = 0; j < DMXChannels; j++) {
-      int DMXAddr = DMXFixtureStart + j;
-      switch (DMXFixtureMap[j]) {
-        case 0:        // Set this channel to 0. Good way to tell strobe- and fade-functions to fuck right off.
-          dmx.write(DMXAddr, 0);
-          break;
-        case 1:        // Red
-          dmx.write(DMXAddr, calc_brightness ? (r * brightness) / 255 : r);
-          break;
-        case 2:        // Green
-          dmx.write(DMXAddr, calc_brightness ? (g * brightness) / 255 : g);
-          break;
-        case 3:        // Blue
-          dmx.write(DMXAddr, calc_brightness ? (b * brightness) / 255 : b);
-          break;
-        case 4:        // White
-          dmx.write(DMXAddr, calc_brightness ? (w * brightness) / 255 : w);
-          break;
-        case 5:        // Shutter channel. Controls the brightness.
-          dmx.write(DMXAddr, brightness);
-          break;
-        case 6:        // Sets this channel to 255. Like 0, but more wholesome.
-          dmx.write(DMXAddr, 255);
-          break;
+  uint8_t brightness = strip.getBrightness();
+  // only copy new frames, unchanged output is resent as is (DMX receivers expect a continuous stream)
+  if (strip.getFrameCount() != dmxFrame || brightness != dmxBri) {
+    dmxFrame = strip.getFrameCount();
+    dmxBri = brightness;
+    uint8_t *out = dmx.getData();
+    unsigned bri = dmxProg.scale ? brightness : 255;
+    unsigned addr = DMXStart;
+    for (unsigned f = 0; f < dmxProg.fixtures; f++, addr += DMXGap) {
+      uint32_t in = strip.getPixelColor(DMXStartLED + f); // get the colors for the individual fixtures as suggested by Aircoookie in issue #462
+      uint8_t *ch = out + addr;
+      for (unsigned j = 0; j < dmxProg.channels; j++) {
+        uint8_t s = dmxProg.shift[j];
+        if (s == DMX_CH_CONST) ch[j] = dmxProg.value[j];
+        else if (s == DMX_CH_BRI) ch[j] = brightness;
+        else {
+          unsigned x = ((in >> s) & 0xFF) * bri;
+          ch[j] = (x + 1 + (x >> 8)) >> 8; // x/255
+        }
       }
     }
   }
 
-  dmx.update();        // update the DMX bus
+  dmx.update();        // start sending the DMX frame, does not wait for it to complete
 }
 
 void initDMX() {
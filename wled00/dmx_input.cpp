@@ -0,0 +1,160 @@
+#include "wled.h"
+
+/*
+ * Wired DMX512 input via RS-485 transceiver (MAX485 or similar, ESP32 only).
+ * Frames are delimited by the break the sender puts in front of each of them. The IDF UART driver
+ * receives bytes by interrupt into its ring buffer and reports breaks and line errors as events,
+ * which are polled from the main loop. Frames with start code 0 are decoded like universe e131Universe
+ * of E1.31 (DMXMode, DMXAddress), so all DMX_MODE_* work the same as with network DMX.
+ */
+
+#ifdef WLED_ENABLE_DMX_INPUT
+#include "driver/uart.h"
+
+#ifndef DMX_INPUT_UART
+  #define DMX_INPUT_UART UART_NUM_1  // UART2 is used by DMX output, UART0 by Serial
+#endif
+#define DMX_INPUT_SLOTS  512
+#define DMX_INPUT_RXBUF  1024        // UART driver ring buffer, two full frames
+#define DMX_INPUT_EVENTS 32
+#define DMX_POS_SKIP     -1          // next byte is the NUL the UART stores for the break
+#define DMX_POS_WAIT     -2          // waiting for a break (startup, error or overlong frame)
+
+static QueueHandle_t dmxInQueue = nullptr;
+static uint8_t  dmxInBuf[DMX_INPUT_SLOTS+1]; // start code + slots
+static int16_t  dmxInPos = DMX_POS_WAIT;
+static bool     dmxInBreakErr = false;      // framing error event caused by the break itself is expected
+static uint32_t dmxInBreakUs = 0;
+static dmx_input_stats_t dmxInStats = {0};
+
+// frame in dmxInBuf is complete: reached max length or next break arrived
+static void dmxInFrame()
+{
+  uint16_t len = dmxInPos > 0 ? dmxInPos : 0;
+  dmxInPos = DMX_POS_WAIT;
+  if (len < 2) return; // break without data
+  if (dmxInBuf[0] != 0) { dmxInStats.otherStart++; return; } // RDM, text packets, ...
+  dmxInStats.frames++;
+  dmxInStats.slots = len - 1;
+  dmxInStats.last = millis();
+  handleDMXInputFrame(dmxInBuf, len);
+}
+
+static void dmxInBreak()
+{
+  uint32_t now = micros();
+  if (dmxInPos > 0) dmxInFrame(); // shorter than 512 slots
+  if (dmxInBreakUs) {
+    uint32_t interval = now - dmxInBreakUs;
+    dmxInStats.interval = interval;
+    if (!dmxInStats.minInterval || interval < dmxInStats.minInterval) dmxInStats.minInterval = interval;
+    if (interval > dmxInStats.maxInterval) dmxInStats.maxInterval = interval;
+  }
+  dmxInBreakUs = now;
+  dmxInStats.breaks++;
+  dmxInPos = DMX_POS_SKIP;
+  dmxInBreakErr = true;
+}
+
+// moves len received bytes from the driver to the frame buffer
+static void dmxInRead(size_t len)
+{
+  uint8_t discard[32];
+  while (len) {
+    int n;
+    if (dmxInPos >= 0) {
+      n = uart_read_bytes(DMX_INPUT_UART, dmxInBuf + dmxInPos, min(len, sizeof(dmxInBuf) - dmxInPos), 0);
+      if (n <= 0) return;
+      dmxInPos += n;
+      if (dmxInPos >= (int)sizeof(dmxInBuf)) dmxInFrame(); // full frame, don't wait for the next break
+    } else {
+      n = uart_read_bytes(DMX_INPUT_UART, discard, dmxInPos == DMX_POS_SKIP ? 1 : min(len, sizeof(discard)), 0);
+      if (n <= 0) return;
+      if (dmxInPos == DMX_POS_SKIP) dmxInPos = 0;
+    }
+    len -= n;
+  }
+}
+
+void initDMXInput()
+{
+  if (dmxInQueue || dmxInputRxPin < 0) return;
+  PinManagerPinType pins[2] = { { dmxInputRxPin, false }, { dmxInputEnPin, true } };
+  if (!pinManager.allocateMultiplePins(pins, dmxInputEnPin >= 0 ? 2 : 1, PinOwner::DMXInput)) {
+    DEBUG_PRINTLN(F("DMX input: pins not available."));
+    return;
+  }
+  if (dmxInputEnPin >= 0) { pinMode(dmxInputEnPin, OUTPUT); digitalWrite(dmxInputEnPin, LOW); } // transceiver receives
+  uart_config_t cfg = {};
+  cfg.baud_rate = 250000;
+  cfg.data_bits = UART_DATA_8_BITS;
+  cfg.parity    = UART_PARITY_DISABLE;
+  cfg.stop_bits = UART_STOP_BITS_2;
+  cfg.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+  if (uart_param_config(DMX_INPUT_UART, &cfg) != ESP_OK
+   || uart_set_pin(DMX_INPUT_UART, UART_PIN_NO_CHANGE, dmxInputRxPin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK
+   || uart_driver_install(DMX_INPUT_UART, DMX_INPUT_RXBUF, 0, DMX_INPUT_EVENTS, &dmxInQueue, 0) != ESP_OK) {
+    DEBUG_PRINTLN(F("DMX input: UART init failed."));
+    dmxInQueue = nullptr;
+    pinManager.deallocatePin(dmxInputRxPin, PinOwner::DMXInput);
+    if (dmxInputEnPin >= 0) pinManager.deallocatePin(dmxInputEnPin, PinOwner::DMXInput);
+    return;
+  }
+  uart_set_rx_full_threshold(DMX_INPUT_UART, 64); // FIFO is 128 bytes, leaves room for latency of the interrupt
+  uart_set_rx_timeout(DMX_INPUT_UART, 2);         // hand over the tail of short frames quickly
+  DEBUG_PRINTF("DMX input on GPIO %d\n", dmxInputRxPin);
+}
+
+// scheduler task, every loop: at 250kbaud a full frame takes 23ms, the ring buffer bridges loops up to 40ms
+void handleDMXInput()
+{
+  if (!dmxInQueue) return;
+  uart_event_t ev;
+  while (xQueueReceive(dmxInQueue, &ev, 0)) {
+    switch (ev.type) {
+      case UART_DATA:
+        dmxInBreakErr = false;
+        dmxInRead(ev.size);
+        break;
+      case UART_BREAK:
+        dmxInBreak();
+        break;
+      case UART_FRAME_ERR:
+        if (dmxInBreakErr) { dmxInBreakErr = false; break; }
+        // fall through
+      case UART_PARITY_ERR:
+        dmxInStats.errors++;
+        dmxInPos = DMX_POS_WAIT; // drop corrupted frame
+        break;
+      case UART_FIFO_OVF:
+      case UART_BUFFER_FULL:
+        // loop was blocked too long, events no longer match the buffered data: start over with the next break
+        dmxInStats.overflows++;
+        uart_flush_input(DMX_INPUT_UART);
+        xQueueReset(dmxInQueue);
+        dmxInPos = DMX_POS_WAIT;
+        return;
+      default:
+        break;
+    }
+  }
+}
+
+const dmx_input_stats_t& getDMXInputStats()
+{
+  return dmxInStats;
+}
+
+void resetDMXInputStats()
+{
+  uint16_t slots = dmxInStats.slots;
+  unsigned long last = dmxInStats.last;
+  memset(&dmxInStats, 0, sizeof(dmxInStats));
+  dmxInStats.slots = slots;
+  dmxInStats.last = last;
+}
+
+#else
+void initDMXInput() {}
+void handleDMXInput() {}
+#endif
@@ -8,9 +8,151 @@
  * E1.31 handler
  */
 
+// number of universes needed for DMX mode and LED count (0 if DMX input is disabled)
+uint16_t e131UniverseCount() {
+  switch (DMXMode) {
+    case DMX_MODE_SINGLE_RGB:
+    case DMX_MODE_SINGLE_DRGB:
+    case DMX_MODE_PRESET:
+    case DMX_MODE_EFFECT:
+    case DMX_MODE_EFFECT_W:
+    case DMX_MODE_EFFECT_SEGMENT:
+    case DMX_MODE_EFFECT_SEGMENT_W:
+      return 1;  // 1 universe is enough
+
+    case DMX_MODE_MULTIPLE_DRGB:
+    case DMX_MODE_MULTIPLE_RGB:
+    case DMX_MODE_MULTIPLE_RGBW:
+      {
+        bool is4Chan = (DMXMode == DMX_MODE_MULTIPLE_RGBW);
+        const uint16_t dmxChannelsPerLed = is4Chan ? 4 : 3;
+        const uint16_t dimmerOffset = (DMXMode == DMX_MODE_MULTIPLE_DRGB) ? 1 : 0;
+        const uint16_t dmxLenOffset = (DMXAddress == 0) ? 0 : 1; // For legacy DMX start address 0
+        const uint16_t ledsInFirstUniverse = (((MAX_CHANNELS_PER_UNIVERSE - DMXAddress) + dmxLenOffset) - dimmerOffset) / dmxChannelsPerLed;
+        const uint16_t totalLen = strip.getLengthTotal();
+        if (totalLen <= ledsInFirstUniverse) return 1;
+        const uint16_t ledsPerUniverse = is4Chan ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
+        return 1 + (totalLen - ledsInFirstUniverse + ledsPerUniverse - 1) / ledsPerUniverse;
+      }
+    default:
+      return 0;
+  }
+}
+
+// first pixel of the realtime stream carried by universe uni (DMX_MODE_MULTIPLE_*), used for realtime routes
+uint16_t e131UniversePixel(uint16_t uni) {
+  if (uni <= e131Universe) return 0;
+  if (DMXMode != DMX_MODE_MULTIPLE_DRGB && DMXMode != DMX_MODE_MULTIPLE_RGB && DMXMode != DMX_MODE_MULTIPLE_RGBW) return 0;
+  bool is4Chan = (DMXMode == DMX_MODE_MULTIPLE_RGBW);
+  const uint16_t dmxChannelsPerLed = is4Chan ? 4 : 3;
+  const uint16_t dimmerOffset = (DMXMode == DMX_MODE_MULTIPLE_DRGB) ? 1 : 0;
+  const uint16_t dmxLenOffset = (DMXAddress == 0) ? 0 : 1;
+  const uint16_t ledsInFirstUniverse = (((MAX_CHANNELS_PER_UNIVERSE - DMXAddress) + dmxLenOffset) - dimmerOffset) / dmxChannelsPerLed;
+  const uint16_t ledsPerUniverse = is4Chan ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
+  return ledsInFirstUniverse + (uni - e131Universe - 1) * ledsPerUniverse;
+}
+
+// universes (or DDP pixels) of the current frame received so far, a frame is shown once it is complete
+// or, if the sender synchronizes its receivers, once the sync packet (E1.31 sync, ArtSync, DDP push) arrives
+static uint8_t *e131Received = nullptr;  // one bit per universe
+static uint16_t e131ReceivedCount = 0;
+static uint32_t ddpReceived = 0;         // pixels received since last push
+static unsigned long e131FrameStart = 0;
+static unsigned long e131SyncSeen = 0;   // last sync packet, 0 if sender does not synchronize
+static unsigned long ddpPushSeen = 0;    // last DDP push, 0 if sender does not push
+static uint16_t e131SyncUniverse = 0;    // E1.31 synchronization address announced in data packets
+static volatile bool e131FramePending = false; // frame complete, waiting for sync
+static volatile bool e131FrameDone = false;
+static volatile bool ddpShowPending = false;   // timecoded DDP frame waiting for its presentation time
+static unsigned long ddpShowAt = 0;
+
+// DDP timecode: middle 32 bit of an NTP timestamp (16 bit seconds, 16 bit fraction)
+// returns ms until presentation (negative if late), relative to our (NTP or UDP synced) clock
+static int32_t ddpTimecodeWait(uint32_t timecode) {
+  Toki::Time t = toki.getTime();
+  uint32_t now = ((t.sec + YEARS_70) << 16) | (((uint32_t)t.ms << 16) / 1000);
+  int32_t diff = (int32_t)(timecode - now); // 1/65536 s, wraps every 18h
+  return ((int64_t)diff * 1000 >> 16) + ddpPresentationDelay;
+}
+
+static inline bool syncRecent(unsigned long seen) {
+  return seen && millis() - seen < E131_SYNC_TIMEOUT;
+}
+
+static void e131FrameComplete() {
+  if (e131Received) memset(e131Received, 0, (e131Universes + 7) / 8);
+  e131ReceivedCount = 0;
+  if (syncRecent(e131SyncSeen)) e131FramePending = true;
+  else                          e131FrameDone = true;
+}
+
+// E1.31 sync packet or ArtSync: show the frame received so far
+static void e131Sync() {
+  e131SyncSeen = millis();
+  if (!e131SyncSeen) e131SyncSeen = 1;
+  if (!e131FramePending && !e131ReceivedCount) return;
+  if (e131Received) memset(e131Received, 0, (e131Universes + 7) / 8);
+  e131ReceivedCount = 0;
+  e131FramePending = false;
+  e131FrameDone = true;
+}
+
+// (re)allocates per universe state if number of universes changed
+static bool e131AllocUniverses() {
+  uint16_t n = e131UniverseCount();
+  if (n < 1) n = 1; // DDP uses the first sequence number
+  if (n == e131Universes && e131LastSequenceNumber) return true;
+  free(e131LastSequenceNumber);
+  free(e131Received);
+  e131LastSequenceNumber = (byte*) calloc(n, sizeof(byte));
+  e131Received = (uint8_t*) calloc((n + 7) / 8, sizeof(uint8_t));
+  e131ReceivedCount = 0;
+  if (!e131LastSequenceNumber || !e131Received) {
+    free(e131LastSequenceNumber); e131LastSequenceNumber = nullptr;
+    free(e131Received); e131Received = nullptr;
+    e131Universes = 0;
+    return false;
+  }
+  e131Universes = n;
+  DEBUG_PRINTF("E1.31: tracking %u universes\n", n);
+  return true;
+}
+
+static void e131UniverseReceived(uint16_t index, byte mde) {
+  const uint8_t bit = 1 << (index & 7);
+  // universe repeated before all others arrived: packets were lost, finish what we have and start a new frame
+  if (e131Received[index >> 3] & bit) {
+    realtimeStatsDuplicate(mde);
+    e131FrameComplete();
+  }
+  if (!e131ReceivedCount && !e131FramePending) e131FrameStart = millis();
+  e131Received[index >> 3] |= bit;
+  if (++e131ReceivedCount >= e131Universes) e131FrameComplete();
+}
+
+// called from main loop: true once per complete frame (or if a frame stays incomplete/unsynchronized for too long)
+bool e131FrameReady() {
+  if (ddpShowPending) {
+    if ((long)(millis() - ddpShowAt) < 0) return false;
+    ddpShowPending = false;
+    return true;
+  }
+  if (e131FrameDone) {
+    e131FrameDone = false;
+    return true;
+  }
+  if ((e131ReceivedCount || ddpReceived || e131FramePending) && millis() - e131FrameStart > e131FrameTimeout) {
+    e131FramePending = false;
+    e131FrameStart = millis();
+    return true;
+  }
+  return false;
+}
+
 //DDP protocol support, called by handleE131Packet
 //handles RGB data only
 void handleDDPPacket(e131_packet_t* p) {
+  if (!e131AllocUniverses()) return;
   int lastPushSeq = e131LastSequenceNumber[0];
 
   //reject late packets belonging to previous frame (assuming 4 packets max. before push)
@@ -18,9 +160,9 @@ void handleDDPPacket(e131_packet_t* p) {
     int sn = p->sequenceNum & 0xF;
     if (sn) {
       if (lastPushSeq > 5) {
-        if (sn > (lastPushSeq -5) && sn < lastPushSeq) return;
+        if (sn > (lastPushSeq -5) && sn < lastPushSeq) { realtimeStatsDropped(REALTIME_MODE_DDP); return; }
       } else {
-        if (sn > (10 + lastPushSeq) || sn < lastPushSeq) return;
+        if (sn > (10 + lastPushSeq) || sn < lastPushSeq) { realtimeStatsDropped(REALTIME_MODE_DDP); return; }
       }
     }
   }
@@ -32,25 +174,46 @@ void handleDDPPacket(e131_packet_t* p) {
   uint16_t stop = start + htons(p->dataLen) / ddpChannelsPerLed;
   uint8_t* data = p->data;
   uint16_t c = 0;
-  if (p->flags & DDP_TIMECODE_FLAG) c = 4; //packet has timecode flag, we do not support it, but data starts 4 bytes later
-
-  realtimeLock(realtimeTimeoutMs, REALTIME_MODE_DDP);
+  uint32_t timecode = 0;
+  if (p->flags & DDP_TIMECODE_FLAG) { //packet has timecode, data starts 4 bytes later
+    timecode = ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+    c = 4;
+  }
 
-  if (!realtimeOverride || (realtimeMode && useMainSegmentOnly)) {
-    for (uint16_t i = start; i < stop; i++) {
-      setRealtimePixel(i, data[c], data[c+1], data[c+2], ddpChannelsPerLed >3 ? data[c+3] : 0);
-      c += ddpChannelsPerLed;
-    }
+  if (realtimeLockData(realtimeTimeoutMs, REALTIME_MODE_DDP) && stop > start) {
+    setRealtimePixels(start, stop - start, data + c, ddpChannelsPerLed);
   }
 
   bool push = p->flags & DDP_PUSH_FLAG;
   if (push) {
+    ddpPushSeen = millis();
+    if (!ddpPushSeen) ddpPushSeen = 1;
+    ddpReceived = 0;
     e131NewData = true;
+    // present timecoded frames at their time if our clock is ms accurate, frames that are late or too far ahead are shown immediately
+    int32_t wait = (timecode && toki.getTimeSource() >= TOKI_TS_UDP_NTP) ? ddpTimecodeWait(timecode) : 0;
+    if (wait > 0 && wait <= 1000 + DDP_MAX_PRESENTATION_DELAY) {
+      ddpShowAt = millis() + wait;
+      ddpShowPending = true;
+    } else {
+      e131FrameDone = true;
+    }
     byte sn = p->sequenceNum & 0xF;
     if (sn) e131LastSequenceNumber[0] = sn;
+  } else if (!syncRecent(ddpPushSeen) && stop > start) {
+    // sender does not push: frame is complete once all pixels are covered
+    if (!ddpReceived) e131FrameStart = millis();
+    ddpReceived += stop - start;
+    e131NewData = true;
+    if (ddpReceived >= strip.getLengthTotal()) {
+      ddpReceived = 0;
+      e131FrameDone = true;
+    }
   }
 }
 
+static void handleDMXData(uint16_t uni, uint16_t dmxChannels, uint8_t* e131_data, byte mde, byte protocol);
+
 //E1.31 and Art-Net protocol support
 void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
 
@@ -64,18 +227,29 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
       handleArtnetPollReply(clientIP);
       return;
     }
+    if (p->art_opcode == ARTNET_OPCODE_OPSYNC) {
+      e131Sync();
+      return;
+    }
     uni = p->art_universe;
     dmxChannels = htons(p->art_length);
     e131_data = p->art_data;
     seq = p->art_sequence_number;
     mde = REALTIME_MODE_ARTNET;
   } else if (protocol == P_E131) {
+    if (htonl(p->root_vector) == 8) { // synchronization packet (E1.31: 6.3)
+      if (e131SyncUniverse && htons(p->sync_universe) == e131SyncUniverse) e131Sync();
+      return;
+    }
     // Ignore PREVIEW data (E1.31: 6.2.6)
     if ((p->options & 0x80) != 0) return;
     dmxChannels = htons(p->property_value_count) - 1;
     // DMX level data is zero start code. Ignore everything else. (E1.11: 8.5)
     if (dmxChannels == 0 || p->property_values[0] != 0) return;
     uni = htons(p->universe);
+    // data with a synchronization address is held until the sync packet arrives, otherwise shown as soon as the frame is complete
+    e131SyncUniverse = htons(p->sync_address);
+    if (!e131SyncUniverse) e131SyncSeen = 0;
     e131_data = p->property_values;
     seq = p->sequence_number;
     if (e131Priority != 0) {
@@ -100,9 +274,10 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
   #endif
 
   // only listen for universes we're handling & allocated memory
-  if (uni < e131Universe || uni >= (e131Universe + E131_MAX_UNIVERSE_COUNT)) return;
+  if (!e131AllocUniverses()) return;
+  if (uni < e131Universe || uni >= (e131Universe + e131Universes)) return;
 
-  uint8_t previousUniverses = uni - e131Universe;
+  uint16_t previousUniverses = uni - e131Universe;
 
   if (e131SkipOutOfSequence)
     if (seq < e131LastSequenceNumber[previousUniverses] && seq > 20 && e131LastSequenceNumber[previousUniverses] < 250){
@@ -113,12 +288,32 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
       DEBUG_PRINT(F(", universe="));
       DEBUG_PRINT(uni);
       DEBUG_PRINTLN(")");
+      realtimeStatsDropped(mde);
       return;
     }
   e131LastSequenceNumber[previousUniverses] = seq;
+  e131UniverseReceived(previousUniverses, mde);
 
   // update status info
   realtimeIP = clientIP;
+  handleDMXData(uni, dmxChannels, e131_data, mde, protocol);
+}
+
+#ifdef WLED_ENABLE_DMX_INPUT
+// wired DMX512 frame (data[0] is the start code), decoded like universe e131Universe of E1.31
+void handleDMXInputFrame(uint8_t* data, uint16_t len) {
+  if (len < 2 || !e131AllocUniverses()) return;
+  realtimeIP = (uint32_t)0;
+  handleDMXData(e131Universe, len - 1, data, REALTIME_MODE_DMX, P_E131);
+  // a wired frame is complete in itself, remaining universes of DMX_MODE_MULTIPLE_* are not waited for
+  if (e131NewData) e131FrameDone = true;
+}
+#endif
+
+// decodes DMX channels of one universe according to DMXMode, e131_data[0] is the start code unless protocol is P_ARTNET
+static void handleDMXData(uint16_t uni, uint16_t dmxChannels, uint8_t* e131_data, byte mde, byte protocol)
+{
+  uint16_t previousUniverses = uni - e131Universe;
   byte wChannel = 0;
   uint16_t totalLen = strip.getLengthTotal();
   uint16_t availDMXLen = 0;
@@ -146,21 +341,20 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
       if (uni != e131Universe) return;
       if (availDMXLen < 3) return;
 
-      realtimeLock(realtimeTimeoutMs, mde);
-
-      if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
+      if (!realtimeLockData(realtimeTimeoutMs, mde)) return;
 
       wChannel = (availDMXLen > 3) ? e131_data[dataOffset+3] : 0;
-      for (uint16_t i = 0; i < totalLen; i++)
-        setRealtimePixel(i, e131_data[dataOffset+0], e131_data[dataOffset+1], e131_data[dataOffset+2], wChannel);
+      {
+        const uint8_t col[4] = {e131_data[dataOffset+0], e131_data[dataOffset+1], e131_data[dataOffset+2], wChannel};
+        fillRealtimePixels(0, totalLen, col, 4);
+      }
       break;
 
     case DMX_MODE_SINGLE_DRGB:  // 4 channel: [Dimmer,R,G,B]
       if (uni != e131Universe) return;
       if (availDMXLen < 4) return;
 
-      realtimeLock(realtimeTimeoutMs, mde);
-      if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
+      if (!realtimeLockData(realtimeTimeoutMs, mde)) return;
       wChannel = (availDMXLen > 4) ? e131_data[dataOffset+4] : 0;
 
       if (bri != e131_data[dataOffset+0]) {
@@ -168,8 +362,10 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
         strip.setBrightness(bri, true);
       }
 
-      for (uint16_t i = 0; i < totalLen; i++)
-        setRealtimePixel(i, e131_data[dataOffset+1], e131_data[dataOffset+2], e131_data[dataOffset+3], wChannel);
+      {
+        const uint8_t col[4] = {e131_data[dataOffset+1], e131_data[dataOffset+2], e131_data[dataOffset+3], wChannel};
+        fillRealtimePixels(0, totalLen, col, 4);
+      }
       break;
 
     case DMX_MODE_PRESET:       // 2 channel: [Dimmer,Preset]
@@ -294,8 +490,7 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
           return;
         }
 
-        realtimeLock(realtimeTimeoutMs, mde);
-        if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
+        if (!realtimeLockData(realtimeTimeoutMs, mde)) return;
 
         if (ledsTotal > totalLen) {
           ledsTotal = totalLen;
@@ -308,16 +503,8 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
           }
         }
 
-        if (!is4Chan) {
-          for (uint16_t i = previousLeds; i < ledsTotal; i++) {
-            setRealtimePixel(i, e131_data[dmxOffset], e131_data[dmxOffset+1], e131_data[dmxOffset+2], 0);
-            dmxOffset+=3;
-          }
-        } else {
-          for (uint16_t i = previousLeds; i < ledsTotal; i++) {
-            setRealtimePixel(i, e131_data[dmxOffset], e131_data[dmxOffset+1], e131_data[dmxOffset+2], e131_data[dmxOffset+3]);
-            dmxOffset+=4;
-          }
+        if (ledsTotal > previousLeds) {
+          setRealtimePixels(previousLeds, ledsTotal - previousLeds, e131_data + dmxOffset, is4Chan ? 4 : 3);
         }
         break;
       }
@@ -334,55 +521,11 @@ void handleArtnetPollReply(IPAddress ipAddress) {
   ArtPollReply artnetPollReply;
   prepareArtnetPollReply(&artnetPollReply);
 
-  uint16_t startUniverse = e131Universe;
-  uint16_t endUniverse = e131Universe;
-
-  switch (DMXMode) {
-    case DMX_MODE_DISABLED:
-      return;  // nothing to do
-      break;
-
-    case DMX_MODE_SINGLE_RGB:
-    case DMX_MODE_SINGLE_DRGB:
-    case DMX_MODE_PRESET:
-    case DMX_MODE_EFFECT:
-    case DMX_MODE_EFFECT_W:
-    case DMX_MODE_EFFECT_SEGMENT:
-    case DMX_MODE_EFFECT_SEGMENT_W:
-      break;  // 1 universe is enough
-
-    case DMX_MODE_MULTIPLE_DRGB:
-    case DMX_MODE_MULTIPLE_RGB:
-    case DMX_MODE_MULTIPLE_RGBW:
-      {
-        bool is4Chan = (DMXMode == DMX_MODE_MULTIPLE_RGBW);
-        const uint16_t dmxChannelsPerLed = is4Chan ? 4 : 3;
-        const uint16_t dimmerOffset = (DMXMode == DMX_MODE_MULTIPLE_DRGB) ? 1 : 0;
-        const uint16_t dmxLenOffset = (DMXAddress == 0) ? 0 : 1; // For legacy DMX start address 0
-        const uint16_t ledsInFirstUniverse = (((MAX_CHANNELS_PER_UNIVERSE - DMXAddress) + dmxLenOffset) - dimmerOffset) / dmxChannelsPerLed;
-        const uint16_t totalLen = strip.getLengthTotal();
-
-        if (totalLen > ledsInFirstUniverse) {
-          const uint16_t ledsPerUniverse = is4Chan ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
-          const uint16_t remainLED = totalLen - ledsInFirstUniverse;
+  uint16_t universes = e131UniverseCount();
+  if (!universes) return; // nothing to do
 
-          endUniverse += (remainLED / ledsPerUniverse);
-
-          if ((remainLED % ledsPerUniverse) > 0) {
-            endUniverse++;
-          }
-
-          if ((endUniverse - startUniverse) > E131_MAX_UNIVERSE_COUNT) {
-            endUniverse = startUniverse + E131_MAX_UNIVERSE_COUNT - 1;
-          }
-        }
-        break;
-      }
-    default:
-      DEBUG_PRINTLN(F("unknown E1.31 DMX mode"));
-      return;  // nothing to do
-      break;
-  }
+  uint16_t startUniverse = e131Universe;
+  uint16_t endUniverse = e131Universe + universes - 1;
 
   for (uint16_t i = startUniverse; i <= endUniverse; ++i) {
     sendArtnetPollReply(&artnetPollReply, ipAddress, i);
@@ -523,7 +666,7 @@ void sendArtnetPollReply(ArtPollReply *reply, IPAddress ipAddress, uint16_t port
 
   notifierUdp.beginPacket(ipAddress, ARTNET_DEFAULT_PORT);
   notifierUdp.write(reply->raw, sizeof(ArtPollReply));
-  notifierUdp.endPacket();
+  notifierUdp.endPacket(); udpPacketsOut++;
 
   reply->reply_bind_index++;
 }
\ No newline at end of file
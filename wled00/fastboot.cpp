@@ -0,0 +1,71 @@
+#include "wled.h"
+
+/*
+ * Fast boot: light up right after the busses are created instead of after complete setup and boot preset.
+ * Once booting has settled (boot preset applied and faded in) brightness, primary color and effect of the
+ * main segment are stored in a tiny binary file, written only if they differ from the stored ones.
+ * On the next power-up beginStrip() shows this frame immediately, provided the boot preset is still the same
+ * and the effect was Solid; the regular boot then continues (and transitions) from there.
+ * RTC memory would not survive the power cycle of a wall switch, so a file is used.
+ */
+
+#ifndef WLED_DISABLE_FASTBOOT
+
+#define BOOT_FRAME_VERSION 1
+#define BOOT_FRAME_LEN     11
+#define BOOT_FRAME_SETTLE  60000 // give up taking the snapshot if booting does not settle within this time
+
+static const char s_bootFrameFile[] PROGMEM = "/boot.bin";
+static bool bootFrameChecked = false;
+
+// file layout: 'W','B','F',version, boot preset, brightness, effect, R, G, B, W (of the main segment)
+static bool readBootFrame(uint8_t *b) {
+  char fileName[12];
+  strcpy_P(fileName, s_bootFrameFile);
+  File f = WLED_FS.open(fileName, "r");
+  if (!f) return false;
+  bool ok = f.size() == BOOT_FRAME_LEN && f.read(b, BOOT_FRAME_LEN) == BOOT_FRAME_LEN;
+  f.close();
+  return ok && b[0] == 'W' && b[1] == 'B' && b[2] == 'F' && b[3] == BOOT_FRAME_VERSION;
+}
+
+// shows the stored frame, called from beginStrip() once busses and segments exist
+bool showBootFrame() {
+  uint8_t b[BOOT_FRAME_LEN];
+  if (!turnOnAtBoot || !readBootFrame(b)) return false;
+  if (b[4] != bootPreset || !b[5] || b[6] != FX_MODE_STATIC) return false;
+  Segment &seg = strip.getMainSegment();
+  seg.colors[0] = RGBW32(b[7], b[8], b[9], b[10]); // no transition, the segment is fresh
+  briOld = briT = b[5]; // the regular boot transitions from here
+  strip.setBrightness(scaledBri(briT), true);
+  strip.service();
+  firstLightMs = millis();
+  DEBUG_PRINTF("Boot frame shown at %u ms.\n", firstLightMs);
+  return true;
+}
+
+// stores the settled boot state (call from loop)
+void handleBootFrame() {
+  if (bootFrameChecked) return;
+  if (millis() > BOOT_FRAME_SETTLE || !turnOnAtBoot) { bootFrameChecked = true; return; }
+  if (transitionActive || (bootPreset && currentPreset != bootPreset) || !bri) return;
+  bootFrameChecked = true;
+
+  const Segment &seg = strip.getMainSegment();
+  uint32_t c = seg.colors[0];
+  uint8_t frame[BOOT_FRAME_LEN] = {'W', 'B', 'F', BOOT_FRAME_VERSION, bootPreset, bri, seg.mode, R(c), G(c), B(c), W(c)};
+  uint8_t old[BOOT_FRAME_LEN];
+  if (readBootFrame(old) && !memcmp(old, frame, sizeof(frame))) return; // spare the flash
+  char fileName[12];
+  strcpy_P(fileName, s_bootFrameFile);
+  File f = WLED_FS.open(fileName, "w");
+  if (!f) return;
+  f.write(frame, sizeof(frame));
+  f.close();
+  DEBUG_PRINTLN(F("Boot frame saved."));
+}
+
+#else
+bool showBootFrame() { return false; }
+void handleBootFrame() {}
+#endif
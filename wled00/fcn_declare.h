@@ -5,6 +5,8 @@
  * All globally accessible functions are declared here
  */
 
+#include "fcn_pure.h" // div255(), fnv1a(), crc32Update(), ... (no Arduino dependencies)
+
 //alexa.cpp
 #ifndef WLED_DISABLE_ALEXA
 void onAlexaChange(EspalexaDevice* dev);
@@ -18,6 +20,8 @@ void shortPressAction(uint8_t b=0);
 void longPressAction(uint8_t b=0);
 void doublePressAction(uint8_t b=0);
 bool isButtonPressed(uint8_t b=0);
+void attachButtonEvents();
+void sampleAnalogButtons();
 void handleButton();
 void handleIO();
 
@@ -27,6 +31,8 @@ void deserializeConfigFromFS();
 bool deserializeConfigSec();
 void serializeConfig();
 void serializeConfigSec();
+struct bus_mem_t;
+uint8_t planBusMemory(JsonArray ins, bool dblBfr, bus_mem_t *plan);
 
 template<typename DestType>
 bool getJsonValue(const JsonVariant& element, DestType& destination) {
@@ -60,14 +66,27 @@ class NeoGammaWLEDMethod {
   private:
     static uint8_t gammaT[];
 };
+#ifdef WLED_ENABLE_OUTPUT_GAMMA
+// colors stay linear until the busses apply gamma when converting to their output format (at 16 bit precision)
+#define gamma32(c) (c)
+#define gamma8(c)  (c)
+const uint16_t *getOutputGammaTable();
+#else
 #define gamma32(c) NeoGammaWLEDMethod::Correct32(c)
 #define gamma8(c)  NeoGammaWLEDMethod::rawGamma8(c)
+#endif
 uint32_t color_blend(uint32_t,uint32_t,uint16_t,bool b16=false);
 uint32_t color_add(uint32_t,uint32_t, bool fast=false);
 uint32_t color_fade(uint32_t c1, uint8_t amount, bool video=false);
+void color_blend_n(uint32_t *dst, const uint32_t *src, size_t n, uint8_t amount);
+void color_layer_n(uint32_t *dst, const uint32_t *src, size_t n, uint8_t mode, uint8_t alpha);
+void color_add_n(uint32_t *dst, const uint32_t *src, size_t n, bool fast=false);
+void color_fade_n(uint32_t *dst, size_t n, uint8_t amount, bool video=false);
+void scale8_n(uint8_t *dst, const uint8_t *src, size_t len, uint8_t scale);
 inline uint32_t colorFromRgbw(byte* rgbw) { return uint32_t((byte(rgbw[3]) << 24) | (byte(rgbw[0]) << 16) | (byte(rgbw[1]) << 8) | (byte(rgbw[2]))); }
 void colorHStoRGB(uint16_t hue, byte sat, byte* rgb); //hue, sat to rgb
 void colorKtoRGB(uint16_t kelvin, byte* rgb);
+void colorKtoBalance(uint16_t kelvin, byte* rgb);
 void colorCTtoRGB(uint16_t mired, byte* rgb); //white spectrum to rgb
 void colorXYtoRGB(float x, float y, byte* rgb); // only defined if huesync disabled TODO
 void colorRGBtoXY(byte* rgb, float* xy); // only defined if huesync disabled TODO
@@ -81,26 +100,136 @@ void setRandomColor(byte* rgb);
 void initDMX();
 void handleDMX();
 
+//dmx_input.cpp
+typedef struct DMXInputStats {
+  uint32_t frames;      // frames with start code 0
+  uint32_t otherStart;  // frames with other start codes (RDM, text), ignored
+  uint32_t breaks;
+  uint32_t errors;      // framing or parity errors, the frame is dropped
+  uint32_t overflows;   // receive buffer overflows (loop blocked too long)
+  uint32_t interval;    // break to break (us), last frame
+  uint32_t minInterval, maxInterval;
+  uint16_t slots;       // channels in last frame
+  unsigned long last;   // millis() of last frame
+} dmx_input_stats_t;
+void initDMXInput();
+void handleDMXInput();
+const dmx_input_stats_t& getDMXInputStats();
+void resetDMXInputStats();
+
+//fseq.cpp
+void handleFseq();
+void fseqPlay(const char *path, bool loop = false, double at = 0, uint8_t channels = 3);
+void fseqStop();
+bool isFseqPlaying();
+void serializeFseq(JsonObject root);
+
 //e131.cpp
 void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol);
+void handleDDPPacket(e131_packet_t* p);
+void handleDMXInputFrame(uint8_t* data, uint16_t len);
+uint16_t e131UniverseCount();
+uint16_t e131UniversePixel(uint16_t uni);
+bool e131FrameReady();
 void handleArtnetPollReply(IPAddress ipAddress);
 void prepareArtnetPollReply(ArtPollReply* reply);
 void sendArtnetPollReply(ArtPollReply* reply, IPAddress ipAddress, uint16_t portAddress);
 
+//fastboot.cpp
+bool showBootFrame();
+void handleBootFrame();
+
+//idle.cpp
+void idleWake();
+void handleIdle();
+void serializeIdle(JsonObject root);
+
 //file.cpp
 bool handleFileRead(AsyncWebServerRequest*, String path);
 bool writeObjectToFileUsingId(const char* file, uint16_t id, JsonDocument* content);
 bool writeObjectToFile(const char* file, const char* key, JsonDocument* content);
 bool readObjectFromFileUsingId(const char* file, uint16_t id, JsonDocument* dest);
 bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest);
+int16_t readNextObjectFromFile(const char* file, uint16_t fromId, JsonDocument* dest, const JsonDocument* filter = nullptr);
+void invalidateFileIndex();
+void handleFileJournal();
+void flushFileJournal();
+void discardFileJournal();
+bool commitFile(const char* tmp, const char* file, bool complete = true);
+void recoverFS();
+#ifdef WLED_ENABLE_PRESETS_BIN
+uint32_t getBinFileGeneration(const char* file);
+uint8_t readObjectFromBinFile(const char* file, uint8_t id, JsonDocument* dest, size_t *pos = nullptr);
+bool writeObjectToBinFile(const char* file, uint8_t id, JsonDocument* content);
+#endif
 void updateFSInfo();
 void closeFile();
 
+// filesystem I/O statistics of file.cpp (per operation and per file) and FS benchmark results
+#ifndef WLED_DISABLE_FS_STATS
+enum FsOp : uint8_t { FS_OP_FIND, FS_OP_READ, FS_OP_WRITE, FS_OP_APPEND, FS_OP_DELETE, FS_OP_JOURNAL, FS_OP_COMPACT, FS_OP_COUNT };
+#define FS_STATS_FILES 6        // files tracked by name, others are summed up in the last entry
+typedef struct FsOpStats {
+  uint32_t count;
+  uint32_t us, maxUs;           // total and longest duration
+} fs_op_stats_t;
+typedef struct FsFileStats {
+  char     name[24];            // "" = unused, "*" = other files
+  uint32_t reads, writes, seeks;
+  uint32_t bytesRead, bytesWritten;
+  uint32_t ops, us;             // file.cpp operations on this file and their total duration
+} fs_file_stats_t;
+enum FsBenchPhase : uint8_t { FS_BENCH_SEQ_READ, FS_BENCH_SEQ_WRITE, FS_BENCH_APPEND, FS_BENCH_READ, FS_BENCH_FIND, FS_BENCH_REPLACE, FS_BENCH_DELETE, FS_BENCH_PHASES };
+typedef struct FsBenchResult {
+  uint8_t  iterations;
+  uint32_t fileSize;            // size of presets.json the benchmark file was copied from
+  uint32_t bytes[FS_BENCH_PHASES];
+  fs_op_stats_t phase[FS_BENCH_PHASES];
+} fs_bench_t;
+const fs_op_stats_t* getFSOpStats();     // FS_OP_COUNT entries
+const fs_file_stats_t* getFSFileStats(); // FS_STATS_FILES entries
+void resetFSStats();
+void requestFSBenchmark(uint8_t iterations);
+bool isFSBenchmarking();
+const fs_bench_t* getFSBenchmark();      // nullptr if never run
+void handleFSBenchmark();
+#endif
+
+//heapmon.cpp
+typedef struct HeapTagStats {
+  uint32_t allocs, fails;       // allocations by this subsystem, failed ones
+  uint32_t bytes;               // total bytes allocated
+  uint32_t live, peak;          // bytes currently held, most ever held
+} heap_tag_stats_t;
+typedef struct HeapStats {
+  uint32_t freeHeap, minFreeHeap;
+  uint32_t maxBlock, minMaxBlock; // largest allocatable block
+  uint8_t  frag;                // 100 - largest block / free heap (%)
+  uint8_t  warn;                // HEAP_WARN_*
+  uint32_t lastFail;            // millis() of last failed tracked allocation, 0 if none
+  uint16_t history[HEAP_HISTORY_LEN]; // lowest largest block per HEAP_HISTORY_MS in 16 byte units, index histPos is oldest
+  uint8_t  histPos, histCount;
+} heap_stats_t;
+void* heapMalloc(uint8_t tag, size_t len);
+void* heapCalloc(uint8_t tag, size_t n, size_t size);
+void  heapFree(uint8_t tag, void *p, size_t len);
+void* heapMallocLarge(uint8_t tag, size_t len);            // prefer PSRAM for buffers of WLED_PSRAM_MIN_ALLOC or more
+void* heapCallocLarge(uint8_t tag, size_t n, size_t size); // (released with heapFree())
+void* callocLarge(size_t n, size_t size);                  // untracked variant, released with free()
+void  heapTrackAlloc(uint8_t tag, size_t len, bool ok); // for allocations not made by heapMalloc()/heapCalloc()
+void  heapTrackFree(uint8_t tag, size_t len);
+const heap_tag_stats_t* getHeapTagStats(uint8_t tag);
+const char* getHeapTagName(uint8_t tag); // PSTR
+const heap_stats_t& getHeapStats();
+void resetHeapStats();
+void handleHeapMonitor();
+
 //hue.cpp
 void handleHue();
 void reconnectHue();
 void onHueError(void* arg, AsyncClient* client, int8_t error);
 void onHueConnect(void* arg, AsyncClient* client);
+void onHueDisconnect(void* arg, AsyncClient* client);
 void sendHuePoll();
 void onHueData(void* arg, AsyncClient* client, void *data, size_t len);
 
@@ -133,6 +262,7 @@ void decodeIR21(uint32_t code);
 void decodeIR6(uint32_t code);
 void decodeIR9(uint32_t code);
 void decodeIRJson(uint32_t code);
+void invalidateIRTable();
 
 void initIR();
 void handleIR();
@@ -145,14 +275,22 @@ void handleIR();
 
 bool deserializeSegment(JsonObject elem, byte it, byte presetId = 0);
 bool deserializeState(JsonObject root, byte callMode = CALL_MODE_DIRECT_CHANGE, byte presetId = 0);
+bool deserializeStateFast(const char *json, size_t len, bool &verbose);
 void serializeSegment(JsonObject& root, Segment& seg, byte id, bool forPreset = false, bool segmentBounds = true);
 void serializeState(JsonObject root, bool forPreset = false, bool includeBri = true, bool segmentBounds = true, bool selectedSegmentsOnly = false);
 void serializeInfo(JsonObject root);
+void serializeRealtimeStats(JsonObject root);
+void serializeFSStats(JsonObject root);
+void serializeHeapStats(JsonObject root);
+void serializeMemPlan(JsonObject root, const bus_mem_t *plan, uint8_t n);
 void serializeModeNames(JsonArray root);
 void serializeModeData(JsonArray root);
 void serveJson(AsyncWebServerRequest* request);
+void handleLedsUpload(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
+void serveLedsUpload(AsyncWebServerRequest *request);
 #ifdef WLED_ENABLE_JSONLIVE
 bool serveLiveLeds(AsyncWebServerRequest* request, uint32_t wsClient = 0);
+void serveLiveLedsBinary(AsyncWebServerRequest* request);
 #endif
 
 //led.cpp
@@ -168,6 +306,7 @@ void colorUpdated(byte callMode);
 void stateUpdated(byte callMode);
 void updateInterfaces(uint8_t callMode);
 void handleTransitions();
+void updateTransitionBri(unsigned long t);
 void handleNightlight();
 byte scaledBri(byte in);
 
@@ -195,13 +334,32 @@ void checkTimers();
 void calculateSunriseAndSunset();
 void setTimeFromAPI(uint32_t timein);
 
+//ota.cpp
+#define OTA_IDLE    0
+#define OTA_RUNNING 1
+#define OTA_DONE    2 // rebooting into new firmware
+#define OTA_FAILED  3
+typedef struct OTAStats {
+  uint32_t size;        // upload size (content length, includes multipart overhead)
+  uint32_t received;    // bytes taken from upload
+  uint32_t written;     // bytes written to flash
+  unsigned long start;  // millis() when update started
+  uint32_t duration;    // ms, so far while running
+  uint32_t frame;       // strip frame count at start, frames shown during update once finished
+  uint16_t maxWriteMs;  // longest single flash write
+  uint8_t  state;       // OTA_*
+} ota_stats_t;
+bool otaStreamBegin(size_t size);
+bool otaStreamWrite(const uint8_t *data, size_t len);
+bool otaStreamEnd();  // blocks until all data is written
+const ota_stats_t& getOTAStats();
+
 //overlay.cpp
 void handleOverlayDraw();
 void _overlayAnalogCountdown();
 void _overlayAnalogClock();
 
 //playlist.cpp
-void shufflePlaylist();
 void unloadPlaylist();
 int16_t loadPlaylist(JsonObject playlistObject, byte presetId = 0);
 void handlePlaylist();
@@ -216,10 +374,20 @@ inline bool applyTemporaryPreset() {return applyPreset(255);};
 void savePreset(byte index, const char* pname = nullptr, JsonObject saveobj = JsonObject());
 inline void saveTemporaryPreset() {savePreset(255);};
 void deletePreset(byte index);
+void invalidatePresetCache(byte index = 0);
+bool prefetchPreset(byte index);
+#ifdef WLED_ENABLE_PRESETS_BIN
+void requestPresetsImport();
+void exportPresets();
+#endif
 bool getPresetName(byte index, String& name);
+uint32_t getPresetsTag();
+bool readPreset(byte index, JsonDocument *dest);
+byte serializePresetList(JsonArray list, byte from);
 
 //remote.cpp
 void handleRemote();
+void espNowSendNotify(const uint8_t *packet, size_t len);
 
 //set.cpp
 bool isAsterisksOnly(const char* str, byte maxLen);
@@ -229,15 +397,120 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply=tru
 //udp.cpp
 void notify(byte callMode, bool followUp=false);
 uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri=255, bool isRGBW=false);
+uint32_t realtimeBroadcastTime(uint8_t type, uint16_t length, bool isRGBW);
 void realtimeLock(uint32_t timeoutMs, byte md = REALTIME_MODE_GENERIC);
+bool realtimeLockData(uint32_t timeoutMs, byte md);
 void exitRealtime();
 void handleNotifications();
+void parseNotifyPacket(const uint8_t *udpIn, size_t len);
 void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w);
+void setRealtimePixels(uint16_t start, uint16_t count, const uint8_t *data, uint8_t channels);
+void fillRealtimePixels(uint16_t start, uint16_t count, const uint8_t *color, uint8_t channels);
+void setRealtimePixelsIndexed(uint16_t count, const uint8_t *data);
+typedef struct RealtimeRoute {
+  uint16_t uni;         // first universe (E1.31/Art-Net), 0 to use ofs
+  uint16_t ofs;         // or first pixel of the realtime stream (DDP offset, UDP index)
+  uint16_t len;         // pixels, 0 = rest of the segment
+  uint8_t  seg;         // segment receiving the pixels in its own (2D row by row) order
+} rt_route_t;
+bool realtimeSegmentsOnly();
+void realtimeFreezeSegments(bool freeze);
+void handleRealtimeFade();
 void refreshNodeList();
 void sendSysInfoUDP();
+bool clockSyncActive();
+void handleClockSync();
+void serializeClockSync(JsonObject root);
+
+// realtime input statistics, one entry per source (realtime mode)
+#define RT_STATS_SAMPLES 32     // latency samples kept for percentiles
+typedef struct RealtimeStats {
+  uint32_t packets, frames;     // totals since reset
+  uint32_t dropped, duplicates; // out-of-sequence packets skipped, universes repeated within a frame
+  uint32_t secStart;            // millis() at start of current rate interval
+  uint16_t secPackets, secFrames;
+  uint16_t pps, fps;            // rates of last full second
+  uint32_t frameStart;          // micros() of first packet of frame being received
+  bool     inFrame;
+  uint8_t  latPos, latCount;
+  uint16_t lat[RT_STATS_SAMPLES]; // receive-to-show latency (us, saturated)
+} realtime_stats_t;
+void realtimeStatsDropped(byte md);
+void realtimeStatsDuplicate(byte md);
+void realtimeStatsShown();
+const realtime_stats_t* getRealtimeStats(byte md);
+void resetRealtimeStats();
+typedef struct UdpRxStats {   // notifier and polled realtime sockets (udp.cpp)
+  uint32_t backlogged;          // polls that found more than one packet queued
+  uint32_t cut;                 // polls ended by packet/time budget with packets possibly left queued
+  uint32_t maxGap;              // longest time between polls in last full second (us), packets may wait that long in lwIP
+  uint8_t  maxDepth;            // most packets handled in one poll in last full second
+  uint8_t  curDepth;            // current second
+  uint32_t curGap, last, secStart;
+} udp_rx_stats_t;
+const udp_rx_stats_t& getUdpRxStats();
+
+//trace.cpp
+#ifndef WLED_DISABLE_TRACE
+extern volatile bool traceOn;
+void traceRecord(uint8_t ev, uint8_t arg, uint16_t data, uint32_t ts, uint32_t dur);
+inline void traceEvent(uint8_t ev, uint8_t arg, uint16_t data, uint32_t ts, uint32_t dur = 0) { if (traceOn) traceRecord(ev, arg, data, ts, dur); }
+#else
+inline void traceEvent(uint8_t ev, uint8_t arg, uint16_t data, uint32_t ts, uint32_t dur = 0) {}
+#endif
+bool traceStart();
+void traceStop();
+void serveTrace(AsyncWebServerRequest* request);
+
+//metrics.cpp
+typedef struct LoopStats {
+  uint32_t loops;                        // total iterations
+  uint64_t loopUs, stripUs, usermodUs;   // total time spent
+  uint32_t loopMax, stripMax, usermodMax; // maximum of the last completed window (us)
+  uint32_t curLoopMax, curStripMax, curUsermodMax;
+  uint32_t windowStart;                  // millis()
+  uint32_t lps, curLoops;                // loops per second in the last completed window, loops in the current one
+} loop_stats_t;
+#define LOOP_STATS_WINDOW 10000          // ms, maxima are reported for the last completed window
+extern loop_stats_t loopStats;
+void addLoopStats(uint32_t loopUs, uint32_t stripUs, uint32_t usermodUs);
+void serveMetrics(AsyncWebServerRequest* request);
+
+//backup.cpp
+void serveBackup(AsyncWebServerRequest* request);
+void handleBackupUpload(AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final);
+
+//scheduler.cpp
+#define TASK_PRIO_HIGH   0 // input which determines the next frame (realtime data, notifications, transitions), always run when due
+#define TASK_PRIO_NORMAL 1 // always run when due
+#define TASK_PRIO_IDLE   2 // runs only in gaps between frames
+#define TASK_NO_REALTIME 0x01 // skip while realtime data drives the LEDs
+#define TASK_YIELD       0x02 // yield() after running
+typedef void (*task_fn_t)();
+typedef struct SchedTask {
+  const char *name;
+  task_fn_t fn;
+  uint16_t  interval;           // ms between runs, 0: every loop
+  uint16_t  budget;             // expected maximum run time (us)
+  uint8_t   prio, flags;
+  uint32_t  lastRun;            // millis()
+  uint32_t  lastUs;             // run time in current loop iteration, 0 if not run
+  uint32_t  runs, maxUs;
+  uint64_t  totalUs;
+  uint32_t  winMaxUs, curMaxUs; // longest run in the last completed stats window and in the current one
+  uint32_t  deferred, overruns; // idle task postponed for a frame, budget exceeded
+} sched_task_t;
+int8_t schedAddTask(const char *name, task_fn_t fn, uint16_t interval = 0, uint8_t prio = TASK_PRIO_NORMAL, uint16_t budget = 0, uint8_t flags = 0);
+void schedRun();
+const sched_task_t* getSchedTask(uint8_t id);
+uint8_t getSchedTaskCount();
+void resetSchedStats();
+void rollSchedStatsWindow();
 
 //network.cpp
 int getSignalQuality(int rssi);
+bool beginFastConnect();
+void saveFastConnect();
 void WiFiEvent(WiFiEvent_t event);
 
 //um_manager.cpp
@@ -274,6 +547,38 @@ typedef struct UM_Exchange_Data {
 } um_data_t;
 const unsigned int um_data_size = sizeof(um_data_t);  // 12 bytes
 
+// stable handle to usermod data published via UsermodManager::publishUMData()
+// consumers resolve it once (getUMHandle()) and compare version to detect new data
+typedef struct UM_Data_Handle {
+  uint8_t            id;         // usermod ID
+  bool               published;  // provider uses the registry (otherwise consumers fall back to polling getUMData())
+  um_data_t         *data;       // nullptr while provider is disabled
+  volatile uint32_t  version;    // incremented by provider each time data changed
+} um_handle_t;
+
+// events delivered to usermods via onEvent() if their getEventMask() includes UM_EVENT_MASK(type)
+typedef enum UM_Event_Types : uint8_t {
+  UM_EVENT_BRIGHTNESS = 0,      // global brightness changed
+  UM_EVENT_SEGMENT,             // segment settings (effect, colors, palette...) changed
+  UM_EVENT_PRESET,              // preset applied
+  UM_EVENT_REALTIME,            // realtime mode entered or exited
+  UM_EVENT_FRAME,               // frame shown (one event per loop iteration at most)
+  UM_EVENT_COUNT
+} um_event_type_t;
+#define UM_EVENT_MASK(t) (1UL << (t))
+typedef struct UM_Event {
+  um_event_type_t type;
+  uint8_t callMode;             // CALL_MODE_* that caused it, if known
+  union {
+    struct { uint8_t bri, oldBri; } brightness;
+    struct { uint8_t id; } segment;     // main segment id (segment changes are not tracked individually)
+    struct { uint8_t id; } preset;
+    struct { uint8_t mode, oldMode; } realtime; // REALTIME_MODE_*, mode is REALTIME_MODE_INACTIVE on exit
+    struct { uint16_t fps; uint32_t time; } frame; // time: millis() of show
+  };
+} um_event_t;
+#define UM_LOOP_ON_EVENT 0xFFFF // getLoopInterval(): call loop() after an event was delivered (or every ~65s)
+
 class Usermod {
   protected:
     um_data_t *um_data; // um_data should be allocated using new in (derived) Usermod's setup() or constructor
@@ -297,18 +602,40 @@ class Usermod {
     virtual void onUpdateBegin(bool) {}                                      // fired prior to and after unsuccessful firmware update
     virtual void onStateChange(uint8_t mode) {}                              // fired upon WLED state change
     virtual uint16_t getId() {return USERMOD_ID_UNSPECIFIED;}
+    virtual uint16_t getLoopInterval() { return 0; }                         // ms between loop() calls, 0: every main loop iteration
+    virtual int8_t getLoopCore() { return -1; }                              // ESP32: run loop() in a task pinned to this core (-1: main loop), loop() must then be thread safe
+    virtual uint32_t getEventMask() { return 0; }                            // UM_EVENT_MASK() of events to receive, queried once after setup()
+    virtual void onEvent(const um_event_t &ev) {}                             // event delivery (from the main loop)
 };
 
+typedef struct UsermodStats {
+  uint32_t lastRun;             // millis()
+  uint32_t runs, maxUs;
+  uint64_t totalUs;
+  uint32_t eventMask;
+  bool     wake;                // event delivered, run loop() regardless of interval
+} um_stats_t;
+
 class UsermodManager {
   private:
     Usermod* ums[WLED_MAX_USERMODS];
+    um_stats_t stats[WLED_MAX_USERMODS];
     byte numMods = 0;
+    uint32_t eventMask = 0;     // events any usermod wants
+    um_handle_t handles[WLED_MAX_UM_HANDLES];
+    byte numHandles = 0;
+    void runLoop(byte i, uint32_t now);
+    #if defined(ARDUINO_ARCH_ESP32) && !defined(CONFIG_FREERTOS_UNICORE)
+    static void coreTask(void *);
+    #endif
 
   public:
     void loop();
     void handleOverlayDraw();
     bool handleButton(uint8_t b);
     bool getUMData(um_data_t **um_data, uint8_t mod_id = USERMOD_ID_RESERVED); // USERMOD_ID_RESERVED will poll all usermods
+    um_handle_t* getUMHandle(uint8_t mod_id);                              // stable handle, nullptr if registry is full
+    um_handle_t* publishUMData(uint8_t mod_id, um_data_t *data);           // called by provider, bump handle->version on new data
     void setup();
     void connected();
     void appendConfigData();
@@ -324,6 +651,11 @@ class UsermodManager {
     bool add(Usermod* um);
     Usermod* lookup(uint16_t mod_id);
     byte getModCount() {return numMods;};
+    Usermod* getMod(byte i) { return i < numMods ? ums[i] : nullptr; }
+    const um_stats_t* getStats(byte i) { return i < numMods ? &stats[i] : nullptr; }
+    void resetStats();
+    inline bool wantsEvent(um_event_type_t type) { return eventMask & UM_EVENT_MASK(type); }
+    void dispatchEvent(const um_event_t &ev);
 };
 
 //usermods_list.cpp
@@ -341,12 +673,46 @@ bool getVal(JsonVariant elem, byte* val, byte minv=0, byte maxv=255);
 bool updateVal(const char* req, const char* key, byte* val, byte minv=0, byte maxv=255);
 bool oappend(const char* txt); // append new c string to temp buffer efficiently
 bool oappendi(int i);          // append new number to temp buffer efficiently
+typedef struct OAppendPage {
+  struct OAppendPage *next;
+  uint16_t len;
+  char     data[OAPPEND_PAGE_SIZE];
+} oappend_page_t;
+bool oappendPagesBegin();                  // oappend() output goes to a chain of pages instead of obuf
+oappend_page_t* oappendPagesEnd();         // complete chain or nullptr if a page could not be allocated
+void oappendPagesFree(oappend_page_t *p);
 void sappend(char stype, const char* key, int val);
 void sappends(char stype, const char* key, char* val);
 void prepareHostname(char* hostname);
 bool isAsterisksOnly(const char* str, byte maxLen);
-bool requestJSONBufferLock(uint8_t module=255);
+bool requestJSONBufferLock(uint8_t module=255, size_t size=0, unsigned timeout=1000); // size: expected JSON input length, 0 for full buffer
 void releaseJSONBufferLock();
+typedef struct JsonLockStats {
+  uint32_t requests, waits, timeouts; // waits: buffer was not free immediately
+  uint16_t maxWait;                   // ms
+} json_lock_stats_t;
+void initJSONBufferPool();
+void lockState();   // serializes applying state, see StateGuard
+void unlockState();
+JsonDocument* requestJSONBuffer(uint8_t module, unsigned timeout = 1000, size_t size = 0);
+void handleJSONBufferIdle();
+void releaseJSONBuffer(JsonDocument *d);
+bool holdsJSONBufferLock();
+uint8_t getJSONBufferPoolSize();
+uint8_t getJSONBuffersInUse();
+uint8_t getJSONBufferQueue(bool peak = false); // requests waiting for a JSON buffer (peak since boot)
+const json_lock_stats_t* getJSONLockStats(uint8_t owner);
+// offsets of sections within effect data string "Name@sliders;colors;palette;flags and defaults" (0: section is missing)
+typedef struct ModeDataIndex {
+  uint8_t sliders;  // after '@' (name ends before it)
+  uint8_t colors;   // after 1st ';' following '@'
+  uint8_t palette;  // after 2nd ';'
+  uint8_t defaults; // after last ';'
+  uint8_t len;      // string length (up to 255)
+} mode_data_idx_t;
+const mode_data_idx_t *getModeDataIndex(uint8_t mode);
+uint32_t getModeDataHash();
+size_t copyModeData(uint8_t mode, unsigned from, unsigned to, char *dest, size_t size);
 uint8_t extractModeName(uint8_t mode, const char *src, char *dest, uint8_t maxLen);
 uint8_t extractModeSlider(uint8_t mode, uint8_t slider, char *dest, uint8_t maxLen, uint8_t *var = nullptr);
 int16_t extractModeDefaults(uint8_t mode, const char *segVar);
@@ -354,6 +720,7 @@ void checkSettingsPIN(const char *pin);
 uint16_t crc16(const unsigned char* data_p, size_t length);
 um_data_t* simulateSound(uint8_t simulationId);
 void enumerateLedmaps();
+bool openLedmapBin(uint8_t n, File &f, uint16_t &count, bool &rle, char *name = nullptr);
 uint8_t get_random_wheel_index(uint8_t pos);
 
 // RAII guard class for the JSON Buffer lock
@@ -372,6 +739,15 @@ class JSONBufferGuard {
     inline void release() { if (holding_lock) releaseJSONBufferLock(); holding_lock = false; }
 };
 
+// RAII guard class for applying state (parsing may happen in parallel in JSON pool buffers, applying may not)
+class StateGuard {
+  public:
+    inline StateGuard() { lockState(); };
+    inline ~StateGuard() { unlockState(); };
+    inline StateGuard(const StateGuard&) = delete; // Noncopyable
+    inline StateGuard& operator=(const StateGuard&) = delete;
+};
+
 #ifdef WLED_ADD_EEPROM_SUPPORT
 //wled_eeprom.cpp
 void applyMacro(byte index);
@@ -401,10 +777,17 @@ void clearEEPROM();
   #define fmod_t fmod
   #define floor_t floor
 #endif
+// fixed point versions (16 bit angle: 65536 = 2*PI, Q15 result)
+int16_t  sin16_t(uint16_t theta);
+int16_t  cos16_t(uint16_t theta);
+uint16_t atan2_16t(int32_t y, int32_t x);
+uint16_t sqrt32_t(uint32_t x);
 
 //wled_serial.cpp
 void handleSerial();
 void updateBaudRate(uint32_t rate);
+uint32_t getSerialRxBytes();
+uint32_t getSerialRxErrors();
 
 //wled_server.cpp
 bool isIp(String str);
@@ -418,15 +801,30 @@ void serveMessage(AsyncWebServerRequest* request, uint16_t code, const String& h
 String dmxProcessor(const String& var);
 void serveSettings(AsyncWebServerRequest* request, bool post = false);
 void serveSettingsJS(AsyncWebServerRequest* request);
+bool handleIfNoneMatchCacheHeader(AsyncWebServerRequest* request, uint32_t contentTag = 0);
+void setStaticContentCacheHeaders(AsyncWebServerResponse *response, uint32_t contentTag = 0);
+typedef struct AdmissionStats {
+  uint32_t admitted, rejected;
+  uint8_t  inFlight, peak;
+} adm_stats_t;
+const adm_stats_t* getAdmissionStats(uint8_t cls);
 
 //ws.cpp
 void handleWs();
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len);
 void sendDataWs(AsyncWebSocketClient * client = nullptr);
+uint8_t getWsLiveViewers();
+uint8_t getWsSubscribers();
+typedef struct WsLoadStats {
+  uint32_t degraded;  // times broadcasts dropped to state-only
+  uint32_t closes;    // times all clients were disconnected (1013)
+  bool     stateOnly; // broadcasts currently carry no info
+} ws_load_stats_t;
+const ws_load_stats_t* getWsLoadStats();
 
 //xml.cpp
 void XML_response(AsyncWebServerRequest *request, char* dest = nullptr);
 void URL_response(AsyncWebServerRequest *request);
-void getSettingsJS(byte subPage, char* dest);
+void getSettingsJS(byte subPage);
 
 #endif
@@ -0,0 +1,47 @@
+#ifndef WLED_FCN_PURE_H
+#define WLED_FCN_PURE_H
+
+/*
+ * Small functions without Arduino/ESP dependencies (math, hashes, checksums)
+ * Included by fcn_declare.h and built on the host by the native unit tests in test/ (pio test -e native)
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+// x / 255 without division, exact for all products of two bytes (x <= 255*255)
+inline uint8_t div255(uint16_t x) {
+  return (x + 1 + (x >> 8)) >> 8;
+}
+
+/*
+ * packed color arithmetic (SWAR): red & blue and white & green are processed as two 16 bit lanes
+ * of a single 32 bit word (masked with 0x00FF00FF), which halves the number of multiplications
+ */
+#define SWAR_RB(c) ((c) & 0x00FF00FF)
+#define SWAR_WG(c) (((c) >> 8) & 0x00FF00FF)
+
+// scale8() of all 4 bytes of v with f = scale+1 (1..256), two 16 bit lanes cannot overflow
+inline uint32_t scale8x4(uint32_t v, uint32_t f) {
+  return (((SWAR_RB(v) * f) >> 8) & 0x00FF00FF) | ((SWAR_WG(v) * f) & 0xFF00FF00);
+}
+
+// FNV-1a hash (cache keys, content tags), a hash is continued by passing it as seed
+#define FNV1A_SEED 2166136261U
+inline uint32_t fnv1a(const void *data, size_t len, uint32_t seed = FNV1A_SEED) {
+  const uint8_t *p = (const uint8_t*)data;
+  while (len--) seed = (seed ^ *p++) * 16777619U;
+  return seed;
+}
+
+// standard CRC-32 (as used by gzip), continue with the previous result to checksum data in pieces
+inline uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    for (unsigned k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320UL & (0U - (crc & 1)));
+  }
+  return ~crc;
+}
+
+#endif
@@ -32,6 +32,75 @@ static volatile size_t knownLargestSpace = MAX_SPACE;
 
 static File f; // don't export to other cpp files
 
+#ifndef WLED_DISABLE_FS_STATS
+/*
+ * I/O statistics: every read, write and seek done by this file goes through fsRead()/fsWrite()/fsSeek() and is
+ * counted for the file of the current operation, FsOpTimer measures the duration of the public operations
+ * (nested operations, e.g. a compaction triggered by a write, are counted for both).
+ */
+static fs_op_stats_t   fsOpStats[FS_OP_COUNT];
+static fs_file_stats_t fsFileStats[FS_STATS_FILES];
+static fs_file_stats_t *fsCur = nullptr; // file of the operation in progress
+
+static fs_file_stats_t* fsStatsFor(const char *file) {
+  if (!file) file = "*";
+  for (size_t i = 0; i < FS_STATS_FILES-1; i++) {
+    if (!fsFileStats[i].name[0]) strlcpy(fsFileStats[i].name, file, sizeof(fsFileStats[i].name));
+    if (!strncmp(fsFileStats[i].name, file, sizeof(fsFileStats[i].name)-1)) return &fsFileStats[i];
+  }
+  fsFileStats[FS_STATS_FILES-1].name[0] = '*';
+  return &fsFileStats[FS_STATS_FILES-1];
+}
+
+class FsOpTimer {
+  public:
+    // file nullptr: part of the enclosing operation (I/O counted for its file)
+    FsOpTimer(FsOp op, const char *file) : _op(op), _top(file || !fsCur), _prev(fsCur), _start(micros()) { if (_top) fsCur = fsStatsFor(file); }
+    ~FsOpTimer() {
+      uint32_t us = micros() - _start;
+      fs_op_stats_t &st = fsOpStats[_op];
+      st.count++;
+      st.us += us;
+      if (us > st.maxUs) st.maxUs = us;
+      if (!_top) return;
+      fsCur->ops++;
+      fsCur->us += us;
+      fsCur = _prev;
+    }
+  private:
+    FsOp _op;
+    bool _top;
+    fs_file_stats_t *_prev;
+    uint32_t _start;
+};
+#define FS_OP_TIMER(op, file) FsOpTimer fsOpTimer(op, file)
+
+static inline void fsCountRead(size_t n)  { if (fsCur) { fsCur->reads++;  fsCur->bytesRead += n; } }
+static inline void fsCountWrite(size_t n) { if (fsCur) { fsCur->writes++; fsCur->bytesWritten += n; } }
+static inline void fsCountSeek()          { if (fsCur) fsCur->seeks++; }
+
+const fs_op_stats_t* getFSOpStats() { return fsOpStats; }
+const fs_file_stats_t* getFSFileStats() { return fsFileStats; }
+
+void resetFSStats() {
+  memset(fsOpStats, 0, sizeof(fsOpStats));
+  memset(fsFileStats, 0, sizeof(fsFileStats));
+  fsCur = nullptr; // no operation is in progress when called from the web server/loop
+}
+#else
+#define FS_OP_TIMER(op, file)
+static inline void fsCountRead(size_t n)  {}
+static inline void fsCountWrite(size_t n) {}
+static inline void fsCountSeek()          {}
+#endif
+
+static inline size_t fsRead(File &file, uint8_t *buf, size_t len) { size_t n = file.read(buf, len); fsCountRead(n); return n; }
+static inline int    fsRead(File &file) { fsCountRead(1); return file.read(); }
+static inline size_t fsWrite(File &file, const uint8_t *buf, size_t len) { size_t n = file.write(buf, len); fsCountWrite(n); return n; }
+static inline size_t fsWrite(File &file, uint8_t c) { size_t n = file.write(c); fsCountWrite(n); return n; }
+template<typename T> static inline size_t fsPrint(File &file, T v) { size_t n = file.print(v); fsCountWrite(n); return n; }
+static inline bool   fsSeek(File &file, uint32_t pos, SeekMode mode = SeekSet) { fsCountSeek(); return file.seek(pos, mode); }
+
 //wrapper to find out how long closing takes
 void closeFile() {
   #ifdef WLED_DEBUG_FS
@@ -46,6 +115,7 @@ void closeFile() {
 //find() that reads and buffers data from file stream in 256-byte blocks.
 //Significantly faster, f.find(key) can take SECONDS for multi-kB files
 static bool bufferedFind(const char *target, bool fromStart = true) {
+  FS_OP_TIMER(FS_OP_FIND, nullptr);
   #ifdef WLED_DEBUG_FS
     DEBUGFS_PRINT("Find ");
     DEBUGFS_PRINTLN(target);
@@ -57,10 +127,10 @@ static bool bufferedFind(const char *target, bool fromStart = true) {
 
   size_t index = 0;
   byte buf[FS_BUFSIZE];
-  if (fromStart) f.seek(0);
+  if (fromStart) fsSeek(f, 0);
 
   while (f.position() < f.size() -1) {
-    size_t bufsize = f.read(buf, FS_BUFSIZE); // better to use size_t instead if uint16_t
+    size_t bufsize = fsRead(f, buf, FS_BUFSIZE); // better to use size_t instead if uint16_t
     size_t count = 0;
     while (count < bufsize) {
       if(buf[count] != target[index])
@@ -68,7 +138,7 @@ static bool bufferedFind(const char *target, bool fromStart = true) {
 
       if(buf[count] == target[index]) {
         if(++index >= targetLen) { // return true if all chars in the target match
-          f.seek((f.position() - bufsize) + count +1);
+          fsSeek(f, (f.position() - bufsize) + count +1);
           DEBUGFS_PRINTF("Found at pos %d, took %d ms", f.position(), millis() - s);
           return true;
         }
@@ -98,17 +168,17 @@ static bool bufferedFindSpace(size_t targetLen, bool fromStart = true) {
 
   size_t index = 0; // better to use size_t instead if uint16_t
   byte buf[FS_BUFSIZE];
-  if (fromStart) f.seek(0);
+  if (fromStart) fsSeek(f, 0);
 
   while (f.position() < f.size() -1) {
-    size_t bufsize = f.read(buf, FS_BUFSIZE);
+    size_t bufsize = fsRead(f, buf, FS_BUFSIZE);
     size_t count = 0;
 
     while (count < bufsize) {
       if(buf[count] == ' ') {
         if(++index >= targetLen) { // return true if space long enough
           if (fromStart) {
-            f.seek((f.position() - bufsize) + count +1 - targetLen);
+            fsSeek(f, (f.position() - bufsize) + count +1 - targetLen);
             knownLargestSpace = MAX_SPACE; //there may be larger spaces after, so we don't know
           }
           DEBUGFS_PRINTF("Found at pos %d, took %d ms", f.position(), millis() - s);
@@ -143,14 +213,14 @@ static bool bufferedFindObjectEnd() {
   byte buf[FS_BUFSIZE];
 
   while (f.position() < f.size() -1) {
-    size_t bufsize = f.read(buf, FS_BUFSIZE); // better to use size_t instead of uint16_t
+    size_t bufsize = fsRead(f, buf, FS_BUFSIZE); // better to use size_t instead of uint16_t
     size_t count = 0;
 
     while (count < bufsize) {
       if (buf[count] == '{') objDepth++;
       if (buf[count] == '}') objDepth--;
       if (objDepth == 0) {
-        f.seek((f.position() - bufsize) + count +1);
+        fsSeek(f, (f.position() - bufsize) + count +1);
         DEBUGFS_PRINTF("} at pos %d, took %d ms", f.position(), millis() - s);
         return true;
       }
@@ -161,6 +231,369 @@ static bool bufferedFindObjectEnd() {
   return false;
 }
 
+/*
+ * In-RAM index of presets.json: preset id -> offset of the object ('{' following the key) and its length.
+ * Built lazily by a single scan on first access and kept up to date by writeObjectToFile(), so loading a
+ * preset (e.g. every playlist step) is a seek instead of a scan of the whole file.
+ * An entry is only trusted if the file size matches the size seen at the last index update and the
+ * key is found in front of the recorded offset, anything else falls back to bufferedFind() and
+ * drops the index (rebuilt on next access).
+ */
+#define FS_INDEX_IDS 251 // preset ids 0-250
+
+static struct FsIndex {
+  uint32_t *pos = nullptr; // 0: no such object
+  uint16_t *len = nullptr; // 0: object too large to index, scan for it
+  size_t   size = 0;       // file size the index is valid for
+  bool     valid = false;
+} fsIndex;
+
+void invalidateFileIndex() {
+  fsIndex.valid = false;
+}
+
+static bool isIndexedFile(const char *file) {
+  return file && strcmp_P(file, PSTR("/presets.json")) == 0;
+}
+
+//returns id of an object key in "<id>": form, -1 if not indexable
+static int16_t keyToId(const char *key) {
+  if (!key || key[0] != '"' || !isdigit(key[1])) return -1;
+  int id = 0;
+  const char *c = key + 1;
+  for (; isdigit(*c); c++) if ((id = id*10 + (*c - '0')) >= FS_INDEX_IDS) return -1;
+  return (c[0] == '"' && c[1] == ':' && !c[2]) ? id : -1;
+}
+
+//scans the whole file once and records position and length of all root-level objects with numeric keys
+static bool buildFileIndex() {
+  FS_OP_TIMER(FS_OP_FIND, nullptr);
+  #ifdef WLED_DEBUG_FS
+    DEBUGFS_PRINTLN(F("Build index"));
+    uint32_t s = millis();
+  #endif
+  if (!fsIndex.pos) {
+    fsIndex.pos = (uint32_t*)malloc(FS_INDEX_IDS * sizeof(uint32_t));
+    fsIndex.len = (uint16_t*)malloc(FS_INDEX_IDS * sizeof(uint16_t));
+    if (!fsIndex.pos || !fsIndex.len) {
+      free(fsIndex.pos); free(fsIndex.len);
+      fsIndex.pos = nullptr; fsIndex.len = nullptr;
+      return false;
+    }
+  }
+  memset(fsIndex.pos, 0, FS_INDEX_IDS * sizeof(uint32_t));
+  memset(fsIndex.len, 0, FS_INDEX_IDS * sizeof(uint16_t));
+  fsIndex.valid = false;
+  if (!f) return false;
+
+  int16_t depth = 0;
+  bool inStr = false, esc = false, inKey = false;
+  int16_t keyId = -1, pendingId = -1, objId = -1; // key being read, key awaiting its object, object being measured
+  uint32_t objStart = 0, keyEnd = 0, p = 0;
+  byte buf[FS_BUFSIZE];
+
+  fsSeek(f, 0);
+  while (f.position() < f.size()) {
+    size_t bufsize = fsRead(f, buf, FS_BUFSIZE);
+    if (!bufsize) break;
+    for (size_t count = 0; count < bufsize; count++, p++) {
+      char c = buf[count];
+      if (inStr) {
+        if (esc) esc = false;
+        else if (c == '\\') { esc = true; keyId = -1; }
+        else if (c == '"') { inStr = false; if (inKey) { pendingId = keyId; keyEnd = p; inKey = false; } }
+        else if (inKey) keyId = (keyId >= 0 && isdigit(c) && keyId*10 + (c - '0') < FS_INDEX_IDS) ? keyId*10 + (c - '0') : -1;
+        continue;
+      }
+      switch (c) {
+        case '"':
+          inStr = true;
+          inKey = (depth == 1);
+          keyId = 0;
+          pendingId = -1;
+          break;
+        case '{':
+          if (depth == 1 && pendingId >= 0 && p == keyEnd + 2) { objId = pendingId; objStart = p; } // only "<id>":{ is indexed
+          pendingId = -1;
+          depth++;
+          break;
+        case '}':
+          depth--;
+          if (depth == 1 && objId >= 0) {
+            fsIndex.pos[objId] = objStart;
+            fsIndex.len[objId] = (p + 1 - objStart <= UINT16_MAX) ? p + 1 - objStart : 0;
+            objId = -1;
+          }
+          break;
+        case ':': case ' ': case '\t': case '\r': case '\n':
+          break;
+        default:
+          pendingId = -1; // root-level value is not an object
+          break;
+      }
+    }
+  }
+  fsIndex.size = f.size();
+  fsIndex.valid = true;
+  DEBUGFS_PRINTF("Indexed, took %d ms\n", millis() - s);
+  return true;
+}
+
+//positions file at the object with given key using the index
+//returns 1 if found, 0 if the key is not in the file and -1 if the index can't tell
+static int8_t indexedFind(const char *key, int16_t id) {
+  if (id < 0 || !f) return -1;
+  if (fsIndex.valid && fsIndex.size != f.size()) fsIndex.valid = false; // modified outside of writeObjectToFile()
+  if (!fsIndex.valid && !buildFileIndex()) return -1;
+  uint32_t pos = fsIndex.pos[id];
+  if (!pos) return 0;
+  if (!fsIndex.len[id]) return -1;
+  size_t keyLen = strlen(key);
+  char buf[12];
+  if (pos < keyLen || keyLen >= sizeof(buf)) return -1;
+  fsSeek(f, pos - keyLen);
+  if (fsRead(f, (uint8_t*)buf, keyLen + 1) != keyLen + 1 || strncmp(buf, key, keyLen) || buf[keyLen] != '{') {
+    DEBUGFS_PRINTLN(F("Index stale"));
+    fsIndex.valid = false;
+    return -1;
+  }
+  fsSeek(f, pos);
+  return 1;
+}
+
+static void updateFileIndex(int16_t id, uint32_t pos, size_t len) {
+  if (id < 0 || !fsIndex.valid) return;
+  fsIndex.pos[id] = pos;
+  fsIndex.len[id] = (len <= UINT16_MAX) ? len : 0;
+  fsIndex.size = f.size();
+}
+
+#ifndef WLED_DISABLE_FS_JOURNAL
+/*
+ * Write journal for presets.json: writeObjectToFile() only appends the new object to presets.jnl
+ * (entry: 'J', uint8 id, uint16 length, uint32 CRC32 of id, length and payload, followed by the JSON payload;
+ * length 0 deletes the object) and readObjectFromFile() looks into the journal first.
+ * When idle (or before presets.json is served) the journal is compacted: presets.json is rewritten into
+ * presets.tmp with all journaled objects applied and all padding dropped, presets.tmp replaces presets.json
+ * and the journal is removed. An entry with bad CRC (power loss while appending) ends the journal, a crash
+ * while compacting leaves either the old presets.json and the journal or a complete presets.tmp (recoverFS()).
+ */
+#define JNL_ENTRY_LEN     8
+#define JNL_COMPACT_SIZE  16384 // compact as soon as possible once the journal is larger
+#define JNL_IDLE_MS       5000  // otherwise compact after this time without new entries
+
+static const char *s_jnlFile     = "/presets.jnl";
+static const char *s_presetsTmp  = "/presets.tmp";
+static const char *s_presetsFile = "/presets.json";
+
+static struct FsJournal {
+  uint32_t *pos = nullptr; // offset+1 of the latest entry per id, 0: not journaled
+  size_t   size = 0;       // end of the valid entries
+  uint32_t lastWrite = 0;
+  bool     loaded = false;
+  bool     torn = false;   // file contains garbage after the last valid entry
+} fsJournal;
+
+//reads the journal once and remembers the latest valid entry of each id
+static bool loadJournal() {
+  if (fsJournal.loaded) return true;
+  if (!fsJournal.pos) {
+    fsJournal.pos = (uint32_t*)malloc(FS_INDEX_IDS * sizeof(uint32_t));
+    if (!fsJournal.pos) return false;
+  }
+  memset(fsJournal.pos, 0, FS_INDEX_IDS * sizeof(uint32_t));
+  fsJournal.size = 0;
+  fsJournal.torn = false;
+  File jf = WLED_FS.open(s_jnlFile, "r");
+  if (jf) {
+    size_t p = 0;
+    uint8_t hdr[JNL_ENTRY_LEN], buf[FS_BUFSIZE];
+    while (p + JNL_ENTRY_LEN <= jf.size()) {
+      fsSeek(jf, p);
+      if (fsRead(jf, hdr, JNL_ENTRY_LEN) != JNL_ENTRY_LEN || hdr[0] != 'J') break;
+      size_t len = hdr[2] | (hdr[3] << 8);
+      if (p + JNL_ENTRY_LEN + len > jf.size()) break;
+      uint32_t crc = crc32Update(0, hdr + 1, 3);
+      for (size_t n = 0; n < len; ) {
+        size_t block = fsRead(jf, buf, min(len - n, (size_t)FS_BUFSIZE));
+        if (!block) break;
+        crc = crc32Update(crc, buf, block);
+        n += block;
+      }
+      if (crc != (hdr[4] | (hdr[5] << 8) | (hdr[6] << 16) | ((uint32_t)hdr[7] << 24))) break;
+      if (hdr[1] < FS_INDEX_IDS) fsJournal.pos[hdr[1]] = p + 1;
+      p += JNL_ENTRY_LEN + len;
+    }
+    fsJournal.size = p;
+    fsJournal.torn = (p != jf.size());
+    jf.close();
+    DEBUGFS_PRINTF("Journal %d bytes%s\n", p, fsJournal.torn ? " (torn)" : "");
+  }
+  fsJournal.loaded = true;
+  return true;
+}
+
+//returns 1 if the journal has the object, 0 if it was deleted and -1 if it is not journaled
+static int8_t journalRead(int16_t id, JsonDocument* dest) {
+  if (id < 0 || !loadJournal() || !fsJournal.pos[id]) return -1;
+  File jf = WLED_FS.open(s_jnlFile, "r");
+  if (!jf) return -1;
+  uint8_t hdr[JNL_ENTRY_LEN];
+  fsSeek(jf, fsJournal.pos[id] - 1);
+  int8_t found = 0;
+  if (fsRead(jf, hdr, JNL_ENTRY_LEN) == JNL_ENTRY_LEN && (hdr[2] | hdr[3])) {
+    found = !deserializeJson(*dest, jf);
+    fsCountRead(jf.position() - fsJournal.pos[id] + 1 - JNL_ENTRY_LEN);
+  }
+  jf.close();
+  if (!found) dest->clear();
+  return found;
+}
+
+static bool copyFileRange(File &src, File &dst, size_t pos, size_t len) {
+  byte buf[FS_BUFSIZE];
+  fsSeek(src, pos);
+  while (len) {
+    size_t block = fsRead(src, buf, min(len, (size_t)FS_BUFSIZE));
+    if (!block || fsWrite(dst, buf, block) != block) return false;
+    len -= block;
+  }
+  return true;
+}
+
+//rewrites presets.json with all journaled objects applied, the caller must hold the JSON buffer lock
+static bool compactJournal() {
+  if (!loadJournal()) return false;
+  if (!fsJournal.size && !fsJournal.torn) return true;
+  FS_OP_TIMER(FS_OP_COMPACT, s_presetsFile);
+  #ifdef WLED_DEBUG_FS
+    DEBUGFS_PRINTLN(F("Compact journal"));
+    uint32_t s = millis();
+  #endif
+  if (doCloseFile) closeFile();
+  File dst = WLED_FS.open(s_presetsTmp, "w");
+  File jf  = WLED_FS.open(s_jnlFile, "r");
+  f = WLED_FS.open(s_presetsFile, "r");
+  bool ok = dst && (!fsJournal.size || jf) && (!f || buildFileIndex());
+  if (ok) ok = fsPrint(dst, F("{\"0\":{}")) > 0;
+  char key[10];
+  for (size_t id = 1; ok && id < FS_INDEX_IDS; id++) {
+    sprintf_P(key, PSTR(",\"%d\":"), (int)id);
+    if (fsJournal.pos[id]) {
+      uint8_t hdr[JNL_ENTRY_LEN];
+      fsSeek(jf, fsJournal.pos[id] - 1);
+      if (fsRead(jf, hdr, JNL_ENTRY_LEN) != JNL_ENTRY_LEN) { ok = false; break; }
+      size_t len = hdr[2] | (hdr[3] << 8);
+      if (len) ok = fsPrint(dst, key) && copyFileRange(jf, dst, fsJournal.pos[id] - 1 + JNL_ENTRY_LEN, len);
+    } else if (f && fsIndex.pos[id]) {
+      size_t len = fsIndex.len[id];
+      if (!len) { fsSeek(f, fsIndex.pos[id]); bufferedFindObjectEnd(); len = f.position() - fsIndex.pos[id]; } // too large for the index
+      ok = fsPrint(dst, key) && copyFileRange(f, dst, fsIndex.pos[id], len);
+    }
+  }
+  if (ok) ok = fsPrint(dst, '}') > 0;
+  if (f) f.close();
+  if (jf) jf.close();
+  if (dst) dst.close();
+  if (!ok) {
+    DEBUGFS_PRINTLN(F("Compaction failed!"));
+    WLED_FS.remove(s_presetsTmp);
+    return false;
+  }
+  WLED_FS.remove(s_presetsFile);
+  WLED_FS.rename(s_presetsTmp, s_presetsFile);
+  WLED_FS.remove(s_jnlFile);
+  memset(fsJournal.pos, 0, FS_INDEX_IDS * sizeof(uint32_t));
+  fsJournal.size = 0;
+  fsJournal.torn = false;
+  invalidateFileIndex();
+  knownLargestSpace = MAX_SPACE;
+  DEBUGFS_PRINTF("Compacted, took %d ms\n", millis() - s);
+  return true;
+}
+
+//appends new content of an object to the journal, false if the caller has to write presets.json directly
+static bool journalAppend(int16_t id, JsonDocument* content) {
+  if (id <= 0 || !loadJournal()) return false;
+  if (fsJournal.torn && !compactJournal()) return false; // never append behind garbage
+  size_t len = content->isNull() ? 0 : measureJson(*content);
+  if (len > UINT16_MAX) return false;
+  updateFSInfo();
+  if (fsBytesTotal - fsBytesUsed < len + 4096) return false; // let in-place write handle low space
+  FS_OP_TIMER(FS_OP_JOURNAL, s_jnlFile);
+  char *buf = len ? (char*)malloc(len + 1) : nullptr;
+  if (len && !buf) return false;
+  if (buf) serializeJson(*content, buf, len + 1);
+  uint8_t hdr[JNL_ENTRY_LEN] = {'J', uint8_t(id), uint8_t(len), uint8_t(len >> 8)};
+  uint32_t crc = crc32Update(crc32Update(0, hdr + 1, 3), (const uint8_t*)buf, len);
+  for (size_t i = 0; i < 4; i++) hdr[4+i] = crc >> (8*i);
+  File jf = WLED_FS.open(s_jnlFile, "a");
+  bool ok = jf && fsWrite(jf, hdr, JNL_ENTRY_LEN) == JNL_ENTRY_LEN && (!len || fsWrite(jf, (const uint8_t*)buf, len) == len);
+  if (jf) jf.close();
+  free(buf);
+  if (!ok) { fsJournal.loaded = false; return false; } // re-read journal, the entry may be partially written
+  fsJournal.pos[id] = fsJournal.size + 1;
+  fsJournal.size += JNL_ENTRY_LEN + len;
+  fsJournal.lastWrite = millis();
+  DEBUGFS_PRINTF("Journaled %d (%d bytes)\n", id, len);
+  return true;
+}
+
+//compacts the journal when it is not written to for a while or grows too large (call from loop)
+void handleFileJournal() {
+  if (!fsJournal.loaded || (!fsJournal.size && !fsJournal.torn)) return;
+  if (fsJournal.size < JNL_COMPACT_SIZE && (millis() - fsJournal.lastWrite < JNL_IDLE_MS || realtimeMode)) return;
+  if (fileDoc || !requestJSONBufferLock(JSON_LOCK_PRESET_SAVE)) return;
+  compactJournal();
+  releaseJSONBufferLock();
+}
+
+//applies the journal immediately (e.g. before presets.json is sent to a client)
+void flushFileJournal() {
+  if (!loadJournal() || (!fsJournal.size && !fsJournal.torn)) return;
+  if (!requestJSONBufferLock(JSON_LOCK_PRESET_SAVE)) return;
+  compactJournal();
+  releaseJSONBufferLock();
+}
+
+//presets.json was replaced as a whole (upload), pending entries are obsolete
+void discardFileJournal() {
+  WLED_FS.remove(s_jnlFile);
+  fsJournal.loaded = false;
+}
+#else
+void handleFileJournal() {}
+void flushFileJournal() {}
+void discardFileJournal() {}
+#endif
+
+//replaces file with its completely written temporary copy, an incomplete copy is dropped and the old content kept
+bool commitFile(const char* tmp, const char* file, bool complete)
+{
+  if (!complete) {
+    DEBUGFS_PRINT(F("Incomplete ")); DEBUGFS_PRINTLN(tmp);
+    WLED_FS.remove(tmp);
+    return false;
+  }
+  WLED_FS.remove(file);
+  return WLED_FS.rename(tmp, file);
+}
+
+//finishes a file replacement interrupted by reset/power loss (tmp complete, original already removed) or drops an incomplete copy
+void recoverFS()
+{
+  static const char *files[][2] = {{"/presets.tmp", "/presets.json"}, {"/cfg.tmp", "/cfg.json"}, {"/wsec.tmp", "/wsec.json"}};
+  for (size_t i = 0; i < sizeof(files)/sizeof(files[0]); i++) {
+    if (!WLED_FS.exists(files[i][0])) continue;
+    DEBUGFS_PRINT(F("Recover ")); DEBUGFS_PRINTLN(files[i][1]);
+    if (WLED_FS.exists(files[i][1])) WLED_FS.remove(files[i][0]);
+    else                             WLED_FS.rename(files[i][0], files[i][1]);
+  }
+  #ifndef WLED_DISABLE_FS_JOURNAL
+  if (WLED_FS.exists(s_jnlFile)) loadJournal(); // compacted by handleFileJournal() once idle
+  #endif
+}
+
 //fills n bytes from current file pos with ' ' characters
 static void writeSpace(size_t l)
 {
@@ -169,15 +602,16 @@ static void writeSpace(size_t l)
 
   while (l > 0) {
     size_t block = (l>FS_BUFSIZE) ? FS_BUFSIZE : l;
-    f.write(buf, block);
+    fsWrite(f, buf, block);
     l -= block;
   }
 
   if (knownLargestSpace < l) knownLargestSpace = l;
 }
 
-bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint32_t contentLen = 0)
+bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint32_t contentLen = 0, int16_t id = -1)
 {
+  FS_OP_TIMER(FS_OP_APPEND, nullptr);
   #ifdef WLED_DEBUG_FS
     DEBUGFS_PRINTLN(F("Append"));
     uint32_t s1 = millis();
@@ -188,7 +622,7 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
   if (f.size() < 3) {
     char init[10];
     strcpy_P(init, PSTR("{\"0\":{}}"));
-    f.print(init);
+    fsPrint(f, init);
   }
 
   if (content->isNull()) {
@@ -200,9 +634,11 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
   if (!contentLen) contentLen = measureJson(*content);
   DEBUGFS_PRINTF("CLen %d\n", contentLen);
   if (bufferedFindSpace(contentLen + strlen(key) + 1)) {
-    if (f.position() > 2) f.write(','); //add comma if not first object
-    f.print(key);
-    serializeJson(*content, f);
+    if (f.position() > 2) fsWrite(f, ','); //add comma if not first object
+    fsPrint(f, key);
+    pos = f.position();
+    fsCountWrite(serializeJson(*content, f));
+    updateFileIndex(id, pos, contentLen);
     DEBUGFS_PRINTF("Inserted, took %d ms (total %d)", millis() - s1, millis() - s);
     doCloseFile = true;
     return true;
@@ -221,13 +657,13 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
 
   //check if last character in file is '}' (typical)
   uint32_t eof = f.size() -1;
-  f.seek(eof, SeekSet);
-  if (f.read() == '}') pos = eof;
+  fsSeek(f, eof, SeekSet);
+  if (fsRead(f) == '}') pos = eof;
 
   if (pos == 0) //not found
   {
     DEBUGFS_PRINTLN("not }");
-    f.seek(0);
+    fsSeek(f, 0);
     while (bufferedFind("}",false)) //find last closing bracket in JSON if not last char
     {
       pos = f.position();
@@ -237,18 +673,21 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
   DEBUGFS_PRINT("pos "); DEBUGFS_PRINTLN(pos);
   if (pos > 2)
   {
-    f.seek(pos, SeekSet);
-    f.write(',');
+    fsSeek(f, pos, SeekSet);
+    fsWrite(f, ',');
   } else { //file content is not valid JSON object
-    f.seek(0, SeekSet);
-    f.print('{'); //start JSON
+    fsSeek(f, 0, SeekSet);
+    fsPrint(f, '{'); //start JSON
+    invalidateFileIndex();
   }
 
-  f.print(key);
+  fsPrint(f, key);
 
   //Append object
-  serializeJson(*content, f);
-  f.write('}');
+  pos = f.position();
+  fsCountWrite(serializeJson(*content, f));
+  fsWrite(f, '}');
+  updateFileIndex(id, pos, contentLen);
 
   doCloseFile = true;
   DEBUGFS_PRINTF("Appended, took %d ms (total %d)", millis() - s1, millis() - s);
@@ -271,6 +710,15 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
     s = millis();
   #endif
 
+  FS_OP_TIMER(content->isNull() ? FS_OP_DELETE : FS_OP_WRITE, file);
+  int16_t id = isIndexedFile(file) ? keyToId(key) : -1;
+  #ifndef WLED_DISABLE_FS_JOURNAL
+  if (id > 0) {
+    if (journalAppend(id, content)) return true;
+    if (fsJournal.size && !compactJournal()) return false; // a journaled version would shadow an in-place write
+  }
+  #endif
+
   size_t pos = 0;
   f = WLED_FS.open(file, "r+");
   if (!f && !WLED_FS.exists(file)) f = WLED_FS.open(file, "w+");
@@ -279,15 +727,18 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
     return false;
   }
 
-  if (!bufferedFind(key)) //key does not exist in file
+  int8_t found = indexedFind(key, id);
+  if (found < 0) found = bufferedFind(key);
+  if (!found) //key does not exist in file
   {
-    return appendObjectToFile(key, content, s);
+    return appendObjectToFile(key, content, s, 0, id);
   }
 
   //an object with this key already exists, replace or delete it
   pos = f.position();
   //measure out end of old object
-  bufferedFindObjectEnd();
+  if (id >= 0 && fsIndex.valid && fsIndex.pos[id] == pos && fsIndex.len[id]) fsSeek(f, pos + fsIndex.len[id]);
+  else bufferedFindObjectEnd();
   size_t pos2 = f.position();
 
   uint32_t oldLen = pos2 - pos;
@@ -304,20 +755,25 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
 
   if (contentLen && contentLen <= oldLen) { //replace and fill diff with spaces
     DEBUGFS_PRINTLN(F("replace"));
-    f.seek(pos);
-    serializeJson(*content, f);
+    fsSeek(f, pos);
+    fsCountWrite(serializeJson(*content, f));
     writeSpace(pos2 - f.position());
+    updateFileIndex(id, pos, contentLen);
   } else if (contentLen && bufferedFindSpace(contentLen - oldLen, false)) { //enough leading spaces to replace
     DEBUGFS_PRINTLN(F("replace (trailing)"));
-    f.seek(pos);
-    serializeJson(*content, f);
+    fsSeek(f, pos);
+    fsCountWrite(serializeJson(*content, f));
+    updateFileIndex(id, pos, contentLen);
   } else {
     DEBUGFS_PRINTLN(F("delete"));
+    size_t objPos = pos;
     pos -= strlen(key);
     if (pos > 3) pos--; //also delete leading comma if not first object
-    f.seek(pos);
+    fsSeek(f, pos);
     writeSpace(pos2 - pos);
-    if (contentLen) return appendObjectToFile(key, content, s, contentLen);
+    if (fsIndex.valid && id >= 0 && fsIndex.pos[id] == objPos) updateFileIndex(id, 0, 0);
+    else invalidateFileIndex();
+    if (contentLen) return appendObjectToFile(key, content, s, contentLen, id);
   }
 
   doCloseFile = true;
@@ -340,10 +796,24 @@ bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest)
     DEBUGFS_PRINTF("Read from %s with key %s >>>\n", file, (key==nullptr)?"nullptr":key);
     uint32_t s = millis();
   #endif
+  FS_OP_TIMER(FS_OP_READ, file);
+  int16_t id = (key != nullptr && isIndexedFile(file)) ? keyToId(key) : -1;
+  #ifndef WLED_DISABLE_FS_JOURNAL
+  int8_t journaled = journalRead(id, dest);
+  if (journaled >= 0) {
+    DEBUGFS_PRINTF("Read from journal, took %d ms\n", millis() - s);
+    return journaled;
+  }
+  #endif
   f = WLED_FS.open(file, "r");
   if (!f) return false;
 
-  if (key != nullptr && !bufferedFind(key)) //key does not exist in file
+  int8_t found = 1;
+  if (key != nullptr) {
+    found = indexedFind(key, id);
+    if (found < 0) found = bufferedFind(key);
+  }
+  if (!found) //key does not exist in file
   {
     f.close();
     dest->clear();
@@ -351,12 +821,315 @@ bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest)
     return false;
   }
 
+  size_t start = f.position();
   deserializeJson(*dest, f);
+  fsCountRead(f.position() - start);
+
+  f.close();
+  DEBUGFS_PRINTF("Read, took %d ms\n", millis() - s);
+  return true;
+}
+
+//reads the object with the lowest numeric key >= fromId from an indexed file (optionally filtered, e.g. names only)
+//the journal is not consulted, flush it first; returns the id of the object read, -1 if there is none
+int16_t readNextObjectFromFile(const char* file, uint16_t fromId, JsonDocument* dest, const JsonDocument* filter)
+{
+  if (!isIndexedFile(file)) return -1;
+  if (doCloseFile) closeFile();
+  FS_OP_TIMER(FS_OP_READ, file);
+  f = WLED_FS.open(file, "r");
+  if (!f) return -1;
+  if (fsIndex.valid && fsIndex.size != f.size()) fsIndex.valid = false;
+  if (!fsIndex.valid && !buildFileIndex()) {
+    f.close();
+    dest->clear();
+    return -1;
+  }
 
+  int16_t found = -1;
+  for (uint16_t id = fromId; id < FS_INDEX_IDS; id++) {
+    if (!fsIndex.pos[id]) continue;
+    char key[10];
+    sprintf(key, "\"%d\":", id);
+    int8_t r = indexedFind(key, id);
+    if (r < 0) r = bufferedFind(key); // too large to index or stale (indexedFind() rebuilds it for the next id)
+    if (r <= 0) continue;
+    size_t start = f.position();
+    if (filter) deserializeJson(*dest, f, DeserializationOption::Filter(*filter));
+    else        deserializeJson(*dest, f);
+    fsCountRead(f.position() - start);
+    found = id;
+    break;
+  }
   f.close();
+  if (found < 0) dest->clear();
+  return found;
+}
+
+#ifdef WLED_ENABLE_PRESETS_BIN
+/*
+ * Binary object store: objects addressed by a numeric id (1-255) are stored as MessagePack in records.
+ * File header:   'W','P','B',version, uint32 generation (incremented on every change)
+ * Record header: uint8 id (0: free record), uint8 reserved, uint16 payload length, uint16 capacity,
+ *                followed by <capacity> bytes of which the first <length> are the payload
+ * All integers are little endian. A changed object is rewritten in place if it fits its record, otherwise
+ * the record is freed and the object goes into the smallest free record it fits or is appended.
+ * Cost of reading/writing an object depends on the number of records and the object size, not on the file size.
+ */
+#define BIN_VERSION     1
+#define BIN_HEADER_LEN  8
+#define BIN_RECORD_LEN  6
+
+typedef struct BinRecord {
+  uint8_t  id;
+  uint16_t len, cap;
+} bin_record_t;
+
+static bool readBinRecord(File &bf, bin_record_t &r) {
+  uint8_t b[BIN_RECORD_LEN];
+  if (fsRead(bf, b, BIN_RECORD_LEN) != BIN_RECORD_LEN) return false;
+  r.id  = b[0];
+  r.len = b[2] | (b[3] << 8);
+  r.cap = b[4] | (b[5] << 8);
+  return true;
+}
+
+static void writeBinRecord(File &bf, const bin_record_t &r) {
+  uint8_t b[BIN_RECORD_LEN] = {r.id, 0, uint8_t(r.len), uint8_t(r.len >> 8), uint8_t(r.cap), uint8_t(r.cap >> 8)};
+  fsWrite(bf, b, BIN_RECORD_LEN);
+}
+
+//returns false if file does not start with a valid header
+static bool readBinHeader(File &bf, uint32_t *gen = nullptr) {
+  uint8_t b[BIN_HEADER_LEN];
+  fsSeek(bf, 0);
+  if (fsRead(bf, b, BIN_HEADER_LEN) != BIN_HEADER_LEN || b[0] != 'W' || b[1] != 'P' || b[2] != 'B' || b[3] != BIN_VERSION) return false;
+  if (gen) *gen = b[4] | (b[5] << 8) | (b[6] << 16) | ((uint32_t)b[7] << 24);
+  return true;
+}
+
+static void writeBinHeader(File &bf, uint32_t gen) {
+  uint8_t b[BIN_HEADER_LEN] = {'W', 'P', 'B', BIN_VERSION, uint8_t(gen), uint8_t(gen >> 8), uint8_t(gen >> 16), uint8_t(gen >> 24)};
+  fsSeek(bf, 0);
+  fsWrite(bf, b, BIN_HEADER_LEN);
+}
+
+uint32_t getBinFileGeneration(const char* file)
+{
+  uint32_t gen = 0;
+  File bf = WLED_FS.open(file, "r");
+  if (!bf) return 0;
+  if (!readBinHeader(bf, &gen)) gen = 0;
+  bf.close();
+  return gen;
+}
+
+//reads object with given id, or with pos != nullptr the next object at or after *pos (iteration, start with *pos = 0)
+//returns id of the object read, 0 if none
+uint8_t readObjectFromBinFile(const char* file, uint8_t id, JsonDocument* dest, size_t *pos)
+{
+  #ifdef WLED_DEBUG_FS
+    DEBUGFS_PRINTF("Read from %s id %d >>>\n", file, id);
+    uint32_t s = millis();
+  #endif
+  FS_OP_TIMER(FS_OP_READ, file);
+  File bf = WLED_FS.open(file, "r");
+  if (!bf) return 0;
+  uint8_t found = 0;
+  if (readBinHeader(bf)) {
+    size_t p = (pos && *pos > BIN_HEADER_LEN) ? *pos : BIN_HEADER_LEN;
+    bin_record_t r;
+    while (p + BIN_RECORD_LEN <= bf.size()) {
+      fsSeek(bf, p);
+      if (!readBinRecord(bf, r)) break;
+      p += BIN_RECORD_LEN + r.cap;
+      if (!r.id || !r.len || (!pos && r.id != id)) continue;
+      bool ok = !deserializeMsgPack(*dest, bf);
+      fsCountRead(bf.position() - (p - r.cap));
+      if (ok) { found = r.id; break; }
+      if (!pos) break; // when iterating skip corrupted records
+    }
+    if (pos) *pos = p;
+  }
+  bf.close();
+  if (!found) dest->clear();
   DEBUGFS_PRINTF("Read, took %d ms\n", millis() - s);
+  return found;
+}
+
+//replaces object with given id, a null object deletes it
+bool writeObjectToBinFile(const char* file, uint8_t id, JsonDocument* content)
+{
+  #ifdef WLED_DEBUG_FS
+    DEBUGFS_PRINTF("Write to %s id %d >>>\n", file, id);
+    uint32_t s = millis();
+  #endif
+  if (!id) return false;
+  if (doCloseFile) closeFile();
+  FS_OP_TIMER(content->isNull() ? FS_OP_DELETE : FS_OP_WRITE, file);
+  uint32_t gen = 0;
+  File bf = WLED_FS.open(file, "r+");
+  if (!bf && !WLED_FS.exists(file)) {
+    bf = WLED_FS.open(file, "w+");
+    if (bf) writeBinHeader(bf, 0);
+  } else if (bf && !readBinHeader(bf, &gen)) {
+    bf.close(); // not ours, leave it alone
+    return false;
+  }
+  if (!bf) return false;
+
+  size_t len = content->isNull() ? 0 : measureMsgPack(*content);
+  if (len > UINT16_MAX) { bf.close(); return false; }
+
+  size_t p = BIN_HEADER_LEN, oldPos = 0, freePos = 0;
+  bin_record_t r, oldRec = {0,0,0}, freeRec = {0,0,0};
+  while (p + BIN_RECORD_LEN <= bf.size()) {
+    fsSeek(bf, p);
+    if (!readBinRecord(bf, r)) break;
+    if (r.id == id && !oldPos) { oldPos = p; oldRec = r; }
+    else if (!r.id && r.cap >= len && (!freePos || r.cap < freeRec.cap)) { freePos = p; freeRec = r; }
+    p += BIN_RECORD_LEN + r.cap;
+  }
+
+  if (oldPos && len && oldRec.cap >= len) { //fits into old record
+    DEBUGFS_PRINTLN(F("replace"));
+    freePos = oldPos; freeRec = oldRec;
+  } else {
+    if (oldPos) { //free old record
+      DEBUGFS_PRINTLN(F("delete"));
+      oldRec.id = 0; oldRec.len = 0;
+      fsSeek(bf, oldPos);
+      writeBinRecord(bf, oldRec);
+    }
+    if (len && !freePos) { //append
+      updateFSInfo();
+      if (len + 512 > (fsBytesTotal - fsBytesUsed)) {
+        errorFlag = ERR_FS_QUOTA;
+        bf.close();
+        return false;
+      }
+      freePos = p;
+      freeRec.cap = min((len + 15) & ~15U, (size_t)UINT16_MAX); // some slack for growing objects
+    }
+  }
+  if (len) {
+    freeRec.id = id; freeRec.len = len;
+    fsSeek(bf, freePos);
+    writeBinRecord(bf, freeRec);
+    fsCountWrite(serializeMsgPack(*content, bf));
+    for (size_t i = len; i < freeRec.cap && freePos == p; i++) fsWrite(bf, (uint8_t)0); // pad appended record
+  }
+  writeBinHeader(bf, gen + 1);
+  bf.close();
+  DEBUGFS_PRINTF("Written, took %d ms\n", millis() - s);
   return true;
 }
+#endif
+
+#ifndef WLED_DISABLE_FS_STATS
+/*
+ * Filesystem benchmark (/json/fs?bench=<iterations>), run from loop: presets.json is copied to a scratch file
+ * (sequential read and write throughput), then the access patterns of preset handling are timed on the copy:
+ * appending new objects, reading them, searching a key that is not in the file (full scan), replacing them
+ * with larger objects and deleting them. presets.json itself is never modified, the scratch file is removed.
+ */
+#define FS_BENCH_MAX_ITER 32
+static const char s_benchFile[] PROGMEM = "/fsbench.json";
+static uint8_t fsBenchRequest = 0;
+static fs_bench_t *fsBench = nullptr;
+
+void requestFSBenchmark(uint8_t iterations) {
+  fsBenchRequest = constrain(iterations, 1, FS_BENCH_MAX_ITER);
+}
+
+bool isFSBenchmarking() { return fsBenchRequest; }
+
+const fs_bench_t* getFSBenchmark() { return fsBench; }
+
+static inline void fsBenchAdd(FsBenchPhase ph, uint32_t start) {
+  uint32_t us = micros() - start;
+  fs_op_stats_t &st = fsBench->phase[ph];
+  st.count++;
+  st.us += us;
+  if (us > st.maxUs) st.maxUs = us;
+}
+
+static bool fsBenchCopy(const char *from, const char *to) {
+  File src = WLED_FS.open(from, "r");
+  File dst = WLED_FS.open(to, "w");
+  bool ok = dst;
+  if (src && dst) {
+    byte buf[FS_BUFSIZE];
+    while (ok) {
+      uint32_t t = micros();
+      size_t n = src.read(buf, FS_BUFSIZE);
+      fsBenchAdd(FS_BENCH_SEQ_READ, t);
+      if (!n) break;
+      t = micros();
+      ok = dst.write(buf, n) == n;
+      dst.flush();
+      fsBenchAdd(FS_BENCH_SEQ_WRITE, t);
+      fsBench->bytes[FS_BENCH_SEQ_READ]  += n;
+      fsBench->bytes[FS_BENCH_SEQ_WRITE] += n;
+    }
+  }
+  if (src) src.close();
+  if (dst) {
+    if (!src) fsPrint(dst, F("{\"0\":{}}")); // no presets, start from an empty file
+    dst.close();
+  }
+  return ok;
+}
+
+static void fillBenchObject(JsonDocument &d, int i, size_t pad) {
+  d.clear();
+  d["n"] = F("fsbench");
+  d["i"] = i;
+  char s[65];
+  memset(s, 'x', sizeof(s)-1);
+  s[min(pad, sizeof(s)-1)] = '\0';
+  d["pad"] = s; // copied, s goes out of scope
+}
+
+void handleFSBenchmark() {
+  if (!fsBenchRequest || fileDoc) return;
+  flushFileJournal(); // copy the current state of the presets
+  if (!requestJSONBufferLock(JSON_LOCK_FS_BENCH)) return;
+  if (!fsBench) fsBench = (fs_bench_t*)malloc(sizeof(fs_bench_t));
+  if (!fsBench) { fsBenchRequest = 0; releaseJSONBufferLock(); return; }
+  DEBUG_PRINTF("FS benchmark, %d iterations\n", fsBenchRequest);
+  if (doCloseFile) closeFile();
+  memset(fsBench, 0, sizeof(fs_bench_t));
+  fsBench->iterations = fsBenchRequest;
+  char bench[16], key[16];
+  strcpy_P(bench, s_benchFile);
+  {
+    File p = WLED_FS.open("/presets.json", "r");
+    if (p) { fsBench->fileSize = p.size(); p.close(); }
+  }
+  if (fsBenchCopy("/presets.json", bench)) {
+    for (int pass = FS_BENCH_APPEND; pass <= FS_BENCH_DELETE; pass++) {
+      for (int i = 0; i < fsBench->iterations; i++) {
+        sprintf_P(key, PSTR("\"fsb%d\":"), pass == FS_BENCH_FIND ? 999 : i); // "fsb999" is never stored
+        bool wr = (pass == FS_BENCH_APPEND || pass == FS_BENCH_REPLACE || pass == FS_BENCH_DELETE);
+        if (pass == FS_BENCH_DELETE) doc.clear();
+        else if (wr) fillBenchObject(doc, i, pass == FS_BENCH_REPLACE ? 64 : 16); // replacement does not fit
+        uint32_t t = micros();
+        if (wr) writeObjectToFile(bench, key, &doc);
+        else       readObjectFromFile(bench, key, &doc);
+        if (doCloseFile) closeFile();
+        fsBenchAdd((FsBenchPhase)pass, t);
+        if (wr) fsBench->bytes[pass] += doc.isNull() ? 0 : measureJson(doc);
+      }
+    }
+  }
+  WLED_FS.remove(bench);
+  doc.clear();
+  releaseJSONBufferLock();
+  fsBenchRequest = 0;
+  DEBUG_PRINTLN(F("FS benchmark done."));
+}
+#endif
 
 void updateFSInfo() {
   #ifdef ARDUINO_ARCH_ESP32
@@ -399,6 +1172,19 @@ bool handleFileRead(AsyncWebServerRequest* request, String path){
   if(path.endsWith("/")) path += "index.htm";
   if(path.indexOf("sec") > -1) return false;
   String contentType = getContentType(request, path);
+  if (path.equals(F("/presets.json"))) {
+    // revalidated by ETag, the UI reloads it after every change of presetsModifiedTime
+    if (handleIfNoneMatchCacheHeader(request, getPresetsTag())) return true;
+    #ifdef WLED_ENABLE_PRESETS_BIN
+    exportPresets(); // bring the export up to date with presets.bin
+    #endif
+    flushFileJournal();
+    if (!WLED_FS.exists(path)) return false;
+    AsyncWebServerResponse *response = request->beginResponse(WLED_FS, path, contentType);
+    setStaticContentCacheHeaders(response, getPresetsTag());
+    request->send(response);
+    return true;
+  }
   /*String pathWithGz = path + ".gz";
   if(WLED_FS.exists(pathWithGz)){
     request->send(WLED_FS, pathWithGz, contentType);
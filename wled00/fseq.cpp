@@ -0,0 +1,318 @@
+#include "wled.h"
+
+/*
+ * FSEQ (xLights/FPP sequence) playback as realtime source
+ * Frames of uncompressed v1/v2 files (including sparse channel ranges) are read ahead into a second buffer and
+ * shown on the effect clock (millis() + strip.timebase), which follows NTP and cluster clock sync, so controllers
+ * given the same start time ("at") stay frame accurate with each other. Late frames are skipped, not slowed down.
+ * On ESP32 a reader task keeps the next frame buffered (SD_MMC reads are DMA driven), elsewhere the next frame
+ * is read right after a frame was shown. Paths starting with "/sd/" are read from the SD card (sd_card usermod).
+ * Channels map onto LEDs like DDP: 3 (or 4) channels per LED from channel 0, plus the realtime LED offset.
+ * zstd/zlib compressed files are rejected as there is no decompressor in the firmware, export them uncompressed.
+ */
+
+#ifdef WLED_ENABLE_FSEQ
+
+#if defined(WLED_USE_SD_MMC)
+  #include "SD_MMC.h"
+  #define FSEQ_SD SD_MMC
+#elif defined(WLED_USE_SD_SPI)
+  #include "SD.h"
+  #define FSEQ_SD SD
+#endif
+
+#define FSEQ_MAX_RANGES 8
+#define FSEQ_PATH_LEN   33
+#define FSEQ_REQ_START  1
+#define FSEQ_REQ_STOP   2
+
+// slot states
+#define FSEQ_SLOT_EMPTY   0
+#define FSEQ_SLOT_READING 1
+#define FSEQ_SLOT_READY   2
+#define FSEQ_SLOT_IN_USE  3
+
+static File fseqFile;
+static struct {
+  uint32_t dataOffset;          // file offset of frame 0
+  uint32_t frameSize;           // bytes per frame in file
+  uint32_t frames;
+  uint16_t step;                // ms per frame
+  uint8_t  numRanges;           // sparse v2 files: frame data holds these channel ranges back to back
+  uint32_t rangeStart[FSEQ_MAX_RANGES], rangeLen[FSEQ_MAX_RANGES];
+} fseqHdr;
+
+static uint8_t *fseqBuf[2] = {nullptr, nullptr};
+static volatile uint32_t fseqSlotFrame[2];
+static volatile uint8_t  fseqSlotState[2];
+static uint32_t fseqReadLen = 0;  // bytes read per frame (channels beyond the strip are skipped)
+
+static char     fseqPath[FSEQ_PATH_LEN] = "";
+static volatile bool fseqActive = false;
+static volatile bool fseqReading = false;
+static volatile uint32_t fseqWant = 0; // next frame the reader should have ready
+static bool     fseqLoop = false;
+static uint8_t  fseqCpl = 3;      // channels per LED
+static uint32_t fseqStart = 0;    // effect time of frame 0
+static uint32_t fseqShown = UINT32_MAX;
+static uint32_t fseqLate = 0;     // frames skipped because they were not read in time
+static uint8_t  fseqError = 0;    // 1 open failed, 2 bad header, 3 compressed, 4 out of memory
+
+// playback requests (JSON API, may run in network callback)
+static volatile uint8_t fseqReq = 0;
+static char     fseqReqPath[FSEQ_PATH_LEN];
+static bool     fseqReqLoop;
+static uint8_t  fseqReqCpl;
+static double   fseqReqAt;        // unix time (s) of frame 0, 0: now
+
+#ifdef ARDUINO_ARCH_ESP32
+static portMUX_TYPE fseqMux = portMUX_INITIALIZER_UNLOCKED;
+#define FSEQ_LOCK()   portENTER_CRITICAL(&fseqMux)
+#define FSEQ_UNLOCK() portEXIT_CRITICAL(&fseqMux)
+static TaskHandle_t fseqTask = nullptr;
+#else
+#define FSEQ_LOCK()
+#define FSEQ_UNLOCK()
+#endif
+
+static inline uint32_t le16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static inline uint32_t le24(const uint8_t *p) { return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16); }
+static inline uint32_t le32(const uint8_t *p) { return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+static inline uint32_t fseqNext(uint32_t f) {
+  return ++f < fseqHdr.frames ? f : (fseqLoop ? 0 : UINT32_MAX);
+}
+
+static bool fseqReadFrame(uint32_t f, uint8_t *buf) {
+  if (!fseqFile.seek(fseqHdr.dataOffset + f * fseqHdr.frameSize)) return false;
+  return fseqFile.read(buf, fseqReadLen) == fseqReadLen;
+}
+
+// reads the wanted frame and the one after it into slots not holding either, returns true if a frame was read
+static bool fseqFill() {
+  uint32_t want[2] = {fseqWant, fseqNext(fseqWant)};
+  for (size_t w = 0; w < 2; w++) {
+    if (want[w] == UINT32_MAX) continue;
+    int slot = -1;
+    FSEQ_LOCK();
+    if (fseqSlotFrame[0] == want[w] || fseqSlotFrame[1] == want[w]) { FSEQ_UNLOCK(); continue; } // already there (or being read)
+    for (size_t s = 0; s < 2; s++) {
+      bool keep = fseqSlotState[s] == FSEQ_SLOT_IN_USE || (fseqSlotState[s] != FSEQ_SLOT_EMPTY && (fseqSlotFrame[s] == want[0] || fseqSlotFrame[s] == want[1]));
+      if (!keep) { slot = s; break; }
+    }
+    if (slot >= 0) { fseqSlotState[slot] = FSEQ_SLOT_READING; fseqSlotFrame[slot] = want[w]; }
+    FSEQ_UNLOCK();
+    if (slot < 0) return false;
+    bool ok = fseqReadFrame(want[w], fseqBuf[slot]);
+    FSEQ_LOCK();
+    fseqSlotState[slot] = ok ? FSEQ_SLOT_READY : FSEQ_SLOT_EMPTY;
+    if (!ok) fseqSlotFrame[slot] = UINT32_MAX;
+    FSEQ_UNLOCK();
+    return ok;
+  }
+  return false;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+static void fseqReaderTask(void *) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(20));
+    fseqReading = true;
+    while (fseqActive && fseqFill());
+    fseqReading = false;
+  }
+}
+#endif
+
+static void fseqClose() {
+  fseqActive = false;
+  #ifdef ARDUINO_ARCH_ESP32
+  for (size_t i = 0; i < 100 && fseqReading; i++) delay(1); // let reader finish the frame it is reading
+  #endif
+  if (fseqFile) fseqFile.close();
+  for (size_t s = 0; s < 2; s++) {
+    heapFree(HEAP_TAG_OTHER, fseqBuf[s], fseqReadLen);
+    fseqBuf[s] = nullptr;
+    fseqSlotState[s] = FSEQ_SLOT_EMPTY;
+    fseqSlotFrame[s] = UINT32_MAX;
+  }
+  fseqReadLen = 0;
+}
+
+static bool fseqParseHeader() {
+  uint8_t h[32];
+  if (fseqFile.read(h, sizeof(h)) != sizeof(h)) return false;
+  if (memcmp(h, "PSEQ", 4) && memcmp(h, "FSEQ", 4)) return false;
+  fseqHdr.dataOffset = le16(h+4);
+  fseqHdr.frameSize  = le32(h+10); // channel count
+  fseqHdr.frames     = le32(h+14);
+  fseqHdr.step       = h[18] ? h[18] : 50;
+  fseqHdr.numRanges  = 0;
+  if (h[7] >= 2) {
+    if (h[20] & 0x0F) { fseqError = 3; return false; }
+    uint16_t blocks = h[21] | ((h[20] & 0xF0) << 4);
+    uint8_t  ranges = h[22];
+    if (ranges) {
+      if (ranges > FSEQ_MAX_RANGES || !fseqFile.seek(32 + blocks * 8)) return false;
+      fseqHdr.frameSize = 0;
+      for (size_t r = 0; r < ranges; r++) {
+        uint8_t e[6];
+        if (fseqFile.read(e, 6) != 6) return false;
+        fseqHdr.rangeStart[r] = le24(e);
+        fseqHdr.rangeLen[r]   = le24(e+3);
+        fseqHdr.frameSize    += fseqHdr.rangeLen[r];
+      }
+      fseqHdr.numRanges = ranges;
+    }
+  }
+  return fseqHdr.frameSize && fseqHdr.frames && fseqHdr.dataOffset >= 28;
+}
+
+static void fseqOpen() {
+  fseqClose();
+  fseqError = 0;
+  strlcpy(fseqPath, fseqReqPath, sizeof(fseqPath));
+  fseqLoop = fseqReqLoop;
+  fseqCpl  = fseqReqCpl == 4 ? 4 : 3;
+  #ifdef FSEQ_SD
+  if (!strncmp_P(fseqPath, PSTR("/sd/"), 4)) fseqFile = FSEQ_SD.open(fseqPath + 3, "r");
+  else
+  #endif
+  fseqFile = WLED_FS.open(fseqPath, "r");
+  if (!fseqFile) { fseqError = 1; return; }
+  if (!fseqParseHeader()) {
+    if (!fseqError) fseqError = 2;
+    fseqClose();
+    return;
+  }
+  uint32_t need = (uint32_t)strip.getLengthTotal() * fseqCpl;
+  fseqReadLen = fseqHdr.numRanges ? fseqHdr.frameSize : min(fseqHdr.frameSize, need);
+  for (size_t s = 0; s < 2; s++) fseqBuf[s] = (uint8_t*) heapMalloc(HEAP_TAG_OTHER, fseqReadLen);
+  if (!fseqBuf[0] || !fseqBuf[1]) { fseqError = 4; fseqClose(); return; }
+
+  // frame 0 is read right away so playback can start on time
+  if (!fseqReadFrame(0, fseqBuf[0])) { fseqError = 2; fseqClose(); return; }
+  fseqSlotFrame[0] = 0;
+  fseqSlotState[0] = FSEQ_SLOT_READY;
+  fseqWant = 0;
+  fseqShown = UINT32_MAX;
+  fseqLate = 0;
+
+  uint32_t effectNow = millis() + strip.timebase;
+  fseqStart = effectNow;
+  if (fseqReqAt > 0) { // start at given unix time (relies on NTP or UDP time sync of all controllers)
+    Toki::Time t = toki.getTime();
+    double delta = fseqReqAt - ((double)t.sec + t.ms / 1000.0);
+    if (delta > -86400.0 && delta < 86400.0) fseqStart = effectNow + (int32_t)(delta * 1000.0);
+  }
+  fseqActive = true;
+  DEBUG_PRINTF("FSEQ: %s, %u frames of %u bytes, %u ms\n", fseqPath, fseqHdr.frames, fseqHdr.frameSize, fseqHdr.step);
+  #ifdef ARDUINO_ARCH_ESP32
+  if (!fseqTask) xTaskCreatePinnedToCore(fseqReaderTask, "FSEQread", 3072, nullptr, 1, &fseqTask, 0);
+  if (fseqTask) xTaskNotifyGive(fseqTask);
+  #endif
+}
+
+static void fseqShow(const uint8_t *buf) {
+  if (!realtimeLockData(max((uint32_t)realtimeTimeoutMs, 4U * fseqHdr.step), REALTIME_MODE_FSEQ)) return;
+  if (!fseqHdr.numRanges) {
+    setRealtimePixels(0, fseqReadLen / fseqCpl, buf, fseqCpl);
+  } else {
+    for (size_t r = 0, off = 0; r < fseqHdr.numRanges; off += fseqHdr.rangeLen[r++]) {
+      if (fseqHdr.rangeStart[r] % fseqCpl) continue; // range does not start at an LED
+      setRealtimePixels(fseqHdr.rangeStart[r] / fseqCpl, fseqHdr.rangeLen[r] / fseqCpl, buf + off, fseqCpl);
+    }
+  }
+  strip.show();
+  realtimeStatsShown();
+}
+
+void fseqPlay(const char *path, bool loop, double at, uint8_t channels) {
+  strlcpy(fseqReqPath, path, sizeof(fseqReqPath));
+  fseqReqLoop = loop;
+  fseqReqAt   = at;
+  fseqReqCpl  = channels;
+  fseqReq     = FSEQ_REQ_START;
+}
+
+void fseqStop() {
+  fseqReq = FSEQ_REQ_STOP;
+}
+
+bool isFseqPlaying() {
+  return fseqActive;
+}
+
+void handleFseq() {
+  if (fseqReq) {
+    uint8_t req = fseqReq;
+    fseqReq = 0;
+    if (req == FSEQ_REQ_START) fseqOpen();
+    else if (fseqActive) { fseqClose(); if (realtimeMode == REALTIME_MODE_FSEQ) exitRealtime(); }
+  }
+  if (!fseqActive) return;
+  if (realtimeMode != REALTIME_MODE_INACTIVE && realtimeMode != REALTIME_MODE_FSEQ) { fseqClose(); return; } // another source took over
+
+  int32_t t = (int32_t)(millis() + strip.timebase - fseqStart);
+  if (t < 0) return; // waiting for start time, frame 0 is ready
+  uint32_t f = t / fseqHdr.step;
+  if (f >= fseqHdr.frames) {
+    if (!fseqLoop) { fseqClose(); if (realtimeMode == REALTIME_MODE_FSEQ) exitRealtime(); return; }
+    uint32_t loops = f / fseqHdr.frames;
+    fseqStart += loops * fseqHdr.frames * fseqHdr.step;
+    f -= loops * fseqHdr.frames;
+    fseqShown = UINT32_MAX;
+  }
+  if (f == fseqShown) {
+    #ifndef ARDUINO_ARCH_ESP32
+    fseqFill(); // read ahead while waiting for the next frame
+    #endif
+    return;
+  }
+
+  int slot = -1;
+  FSEQ_LOCK();
+  for (size_t s = 0; s < 2; s++) if (fseqSlotFrame[s] == f && fseqSlotState[s] == FSEQ_SLOT_READY) { slot = s; fseqSlotState[s] = FSEQ_SLOT_IN_USE; break; }
+  FSEQ_UNLOCK();
+  if (slot < 0) {
+    fseqWant = f;
+    #ifdef ARDUINO_ARCH_ESP32
+    if (fseqTask) xTaskNotifyGive(fseqTask);
+    return; // show it once read, unless it is replaced by the next frame meanwhile
+    #else
+    if (!fseqFill()) return;
+    for (size_t s = 0; s < 2; s++) if (fseqSlotFrame[s] == f && fseqSlotState[s] == FSEQ_SLOT_READY) slot = s;
+    if (slot < 0) return;
+    fseqSlotState[slot] = FSEQ_SLOT_IN_USE;
+    #endif
+  }
+
+  if (fseqShown != UINT32_MAX && f > fseqShown + 1) {
+    fseqLate += f - fseqShown - 1;
+    realtimeStatsDropped(REALTIME_MODE_FSEQ);
+  }
+  fseqShow(fseqBuf[slot]);
+  FSEQ_LOCK();
+  fseqSlotState[slot] = FSEQ_SLOT_READY;
+  FSEQ_UNLOCK();
+  fseqShown = f;
+  uint32_t next = fseqNext(f);
+  if (next != UINT32_MAX) fseqWant = next;
+  #ifdef ARDUINO_ARCH_ESP32
+  if (fseqTask) xTaskNotifyGive(fseqTask);
+  #endif
+}
+
+void serializeFseq(JsonObject root) {
+  root[F("on")] = (bool)fseqActive;
+  root["f"] = fseqPath;
+  if (fseqError) root[F("err")] = fseqError;
+  if (!fseqActive) return;
+  root["n"] = fseqHdr.frames;
+  root[F("step")] = fseqHdr.step;
+  root[F("frame")] = fseqShown == UINT32_MAX ? -1 : (int32_t)fseqShown;
+  root[F("late")] = fseqLate;
+  root[F("loop")] = fseqLoop;
+}
+
+#endif
@@ -0,0 +1,182 @@
+#include "wled.h"
+#if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM) && defined(WLED_USE_PSRAM)
+#include "esp_heap_caps.h"
+#endif
+
+/*
+ * Heap monitor: samples free heap and largest free block once a second and keeps their minima and a history
+ * of the largest block (lowest value per HEAP_HISTORY_MS), so slow fragmentation of long running nodes shows up
+ * long before allocations fail. Allocations of the big consumers (effect data, pixel buffers, busses, WebSocket
+ * and JSON buffers) are made through the tagged wrappers below or reported by heapTrackAlloc()/heapTrackFree(),
+ * which attributes bytes currently held and failed allocations to these subsystems (HEAP_TAG_*).
+ * Everything else (String, lwIP, AsyncWebServer) is only visible in the sampled free heap.
+ */
+
+#ifdef ARDUINO_ARCH_ESP32
+static portMUX_TYPE heapMux = portMUX_INITIALIZER_UNLOCKED; // allocations may happen from network callbacks
+#define HEAP_LOCK()   portENTER_CRITICAL(&heapMux)
+#define HEAP_UNLOCK() portEXIT_CRITICAL(&heapMux)
+#else
+#define HEAP_LOCK()
+#define HEAP_UNLOCK()
+#endif
+#define HEAP_FAIL_HOLD 60000 // a failed allocation keeps the warning at HEAP_WARN_CRIT this long (ms)
+
+static heap_tag_stats_t heapTags[HEAP_TAG_COUNT];
+static heap_stats_t     heapStats = {0};
+static uint32_t         heapHistStart = 0;
+static uint16_t         heapHistMin = UINT16_MAX;
+
+void heapTrackAlloc(uint8_t tag, size_t len, bool ok)
+{
+  if (tag >= HEAP_TAG_COUNT) tag = HEAP_TAG_OTHER;
+  HEAP_LOCK();
+  heap_tag_stats_t &t = heapTags[tag];
+  if (ok) {
+    t.allocs++;
+    t.bytes += len;
+    t.live += len;
+    if (t.live > t.peak) t.peak = t.live;
+  } else {
+    t.fails++;
+    heapStats.lastFail = millis() | 1; // 0 means "never"
+  }
+  HEAP_UNLOCK();
+  if (!ok) DEBUG_PRINTF("!!! Heap allocation failed: %u bytes (%d) !!!\n", (unsigned)len, (int)tag);
+}
+
+void heapTrackFree(uint8_t tag, size_t len)
+{
+  if (tag >= HEAP_TAG_COUNT) tag = HEAP_TAG_OTHER;
+  HEAP_LOCK();
+  heap_tag_stats_t &t = heapTags[tag];
+  t.live = t.live > len ? t.live - len : 0; // heap deltas measured around bus creation may not add up exactly
+  HEAP_UNLOCK();
+}
+
+void* heapMalloc(uint8_t tag, size_t len)
+{
+  void *p = malloc(len);
+  heapTrackAlloc(tag, len, p);
+  return p;
+}
+
+void* heapCalloc(uint8_t tag, size_t n, size_t size)
+{
+  void *p = calloc(n, size);
+  heapTrackAlloc(tag, n * size, p);
+  return p;
+}
+
+// large buffers (segment pixel buffers, ledmap, network bus buffers) are placed in PSRAM so canvases beyond internal
+// RAM are possible, while small and frequently used ones (effect data, palettes, LED driver buffers) stay internal;
+// free() releases both, PSRAM is not part of the sampled free heap
+void* callocLarge(size_t n, size_t size)
+{
+  #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM) && defined(WLED_USE_PSRAM)
+  if (n * size >= WLED_PSRAM_MIN_ALLOC && psramFound()) {
+    void *p = heap_caps_calloc(n, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (p) return p;
+  }
+  #endif
+  return calloc(n, size);
+}
+
+void* heapMallocLarge(uint8_t tag, size_t len)
+{
+  #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM) && defined(WLED_USE_PSRAM)
+  if (len >= WLED_PSRAM_MIN_ALLOC && psramFound()) {
+    void *p = heap_caps_malloc(len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (p) { heapTrackAlloc(tag, len, true); return p; }
+  }
+  #endif
+  return heapMalloc(tag, len);
+}
+
+void* heapCallocLarge(uint8_t tag, size_t n, size_t size)
+{
+  void *p = callocLarge(n, size);
+  heapTrackAlloc(tag, n * size, p);
+  return p;
+}
+
+void heapFree(uint8_t tag, void *p, size_t len)
+{
+  if (!p) return;
+  free(p);
+  heapTrackFree(tag, len);
+}
+
+const heap_tag_stats_t* getHeapTagStats(uint8_t tag)
+{
+  return tag < HEAP_TAG_COUNT ? &heapTags[tag] : nullptr;
+}
+
+const char* getHeapTagName(uint8_t tag)
+{
+  switch (tag) {
+    case HEAP_TAG_SEGDATA: return PSTR("segdata");
+    case HEAP_TAG_PIXELS:  return PSTR("pixels");
+    case HEAP_TAG_TRANS:   return PSTR("trans");
+    case HEAP_TAG_BUS:     return PSTR("bus");
+    case HEAP_TAG_WS:      return PSTR("ws");
+    case HEAP_TAG_JSON:    return PSTR("json");
+  }
+  return PSTR("other");
+}
+
+const heap_stats_t& getHeapStats()
+{
+  return heapStats;
+}
+
+// clears minima, history and counters (bytes currently held are kept)
+void resetHeapStats()
+{
+  HEAP_LOCK();
+  for (size_t i = 0; i < HEAP_TAG_COUNT; i++) {
+    heapTags[i].allocs = heapTags[i].fails = heapTags[i].bytes = 0;
+    heapTags[i].peak = heapTags[i].live;
+  }
+  heapStats.lastFail = 0;
+  HEAP_UNLOCK();
+  heapStats.minFreeHeap = heapStats.freeHeap;
+  heapStats.minMaxBlock = heapStats.maxBlock;
+  heapStats.histPos = heapStats.histCount = 0;
+  heapHistStart = millis();
+  heapHistMin = UINT16_MAX;
+}
+
+// samples the heap (scheduler task, once a second)
+void handleHeapMonitor()
+{
+  uint32_t freeHeap = ESP.getFreeHeap();
+  #ifdef ARDUINO_ARCH_ESP32
+  uint32_t maxBlock = ESP.getMaxAllocHeap();
+  #else
+  uint32_t maxBlock = ESP.getMaxFreeBlockSize();
+  #endif
+  uint32_t now = millis();
+  if (!heapStats.minFreeHeap || freeHeap < heapStats.minFreeHeap) heapStats.minFreeHeap = freeHeap;
+  if (!heapStats.minMaxBlock || maxBlock < heapStats.minMaxBlock) heapStats.minMaxBlock = maxBlock;
+  heapStats.freeHeap = freeHeap;
+  heapStats.maxBlock = maxBlock;
+  heapStats.frag = freeHeap ? 100 - (uint64_t)maxBlock * 100 / freeHeap : 0;
+
+  uint16_t blk16 = min(maxBlock >> 4, (uint32_t)UINT16_MAX);
+  if (blk16 < heapHistMin) heapHistMin = blk16;
+  if (!heapHistStart) heapHistStart = now;
+  if (now - heapHistStart >= HEAP_HISTORY_MS) {
+    heapStats.history[(heapStats.histPos + heapStats.histCount) % HEAP_HISTORY_LEN] = heapHistMin;
+    if (heapStats.histCount < HEAP_HISTORY_LEN) heapStats.histCount++;
+    else heapStats.histPos = (heapStats.histPos + 1) % HEAP_HISTORY_LEN;
+    heapHistStart = now;
+    heapHistMin = UINT16_MAX;
+  }
+
+  uint8_t warn = HEAP_WARN_OK;
+  if (maxBlock < WLED_HEAP_WARN_BLOCK) warn = HEAP_WARN_LOW;
+  if (maxBlock < WLED_HEAP_CRIT_BLOCK || (heapStats.lastFail && now - heapStats.lastFail < HEAP_FAIL_HOLD)) warn = HEAP_WARN_CRIT;
+  if (warn > heapStats.warn) DEBUG_PRINTF("Heap warning %u: %u free, largest block %u.\n", warn, freeHeap, maxBlock);
+  heapStats.warn = warn;
+}
@@ -0,0 +1,39 @@
+#ifndef WLED_HOT_PROFILE_H
+#define WLED_HOT_PROFILE_H
+
+/*
+ * Placement profile of render hot paths (build with -D WLED_ENABLE_HOT_IRAM, ESP32 only).
+ * Code and tables in flash are executed/read through the flash cache, which is flushed whenever WiFi or
+ * file system access the flash. The functions below are called once or several times for every pixel of
+ * every frame (measured with debug timing of effects while WiFi was busy) and are placed into IRAM, the
+ * lookup tables into DRAM. Set an entry to nothing to keep it in flash, e.g. if IRAM is short on ESP32-S2/C3.
+ * A different profile can be used with -D WLED_HOT_PROFILE=\"my_hot_profile.h\" (must define all entries).
+ * Entries are WLED_HOT_<name>, the comment names the symbol for pio-scripts/obj-dump.py (<env>.hot.txt).
+ *
+ * Always in IRAM (IRAM_ATTR): Segment::XY(), Segment::writePixel*(), WS2812FX::setPixelColor()/writeRange(),
+ * BusManager::setPixelColor(s)(), BusDigital::setPixelColor(s)(). Palette cache and 8 bit gamma table are RAM anyway.
+ */
+
+// color arithmetic
+#define WLED_HOT_color_blend                  WLED_IRAM // color_blend
+#define WLED_HOT_color_add                    WLED_IRAM // color_add
+#define WLED_HOT_color_fade                   WLED_IRAM // color_fade
+#define WLED_HOT_gamma32                      WLED_IRAM // NeoGammaWLEDMethod::Correct32
+
+// segment pixel access
+#define WLED_HOT_Segment_currentColor         WLED_IRAM // Segment::currentColor
+#define WLED_HOT_Segment_color_from_palette   WLED_IRAM // Segment::color_from_palette
+#define WLED_HOT_Segment_getPixelColor        WLED_IRAM // Segment::getPixelColor
+#define WLED_HOT_Segment_getPixelColorXY      WLED_IRAM // Segment::getPixelColorXY
+
+// strip and bus pixel access (effects reading back the strip, overlays)
+#define WLED_HOT_WS2812FX_getPixelColor       WLED_IRAM // WS2812FX::getPixelColor
+#define WLED_HOT_BusManager_getPixelColor     WLED_IRAM // BusManager::getPixelColor
+#define WLED_HOT_BusDigital_getPixelColor     WLED_IRAM // BusDigital::getPixelColor
+
+// fixed point trigonometry
+#define WLED_HOT_sin16_t                      WLED_IRAM // sin16_t
+#define WLED_HOT_cos16_t                      WLED_IRAM // cos16_t
+#define WLED_HOT_sinQuarter                   WLED_DRAM // sinQuarter
+
+#endif
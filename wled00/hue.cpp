@@ -6,6 +6,29 @@
 
 #ifndef WLED_DISABLE_HUESYNC
 
+/*
+ * The connection to the bridge is kept open between polls (HTTP keep-alive) and only re-established when the
+ * bridge closes it, instead of a TCP handshake per poll. Responses are collected across TCP segments (plain or
+ * chunked body), a body identical to the last one is skipped without parsing and otherwise only the fields used
+ * below are deserialized (ArduinoJson filter).
+ * Note: the Hue event stream (SSE) is only offered by the v2 API over HTTPS, which AsyncClient cannot do.
+ */
+#ifndef HUE_RESPONSE_MAX
+  #define HUE_RESPONSE_MAX 3072   // status line, headers and body of a light state response (allocated while receiving)
+#endif
+
+static char    *hueBuf = nullptr; // response being received
+static uint16_t hueBufLen = 0;
+static uint32_t hueLastHash = 0;  // of the last applied light state body
+static bool     hueAwaiting = false;
+
+static void hueResetResponse()
+{
+  heapFree(HEAP_TAG_OTHER, hueBuf, HUE_RESPONSE_MAX);
+  hueBuf = nullptr;
+  hueBufLen = 0;
+}
+
 void handleHue()
 {
   if (hueReceived)
@@ -21,11 +44,13 @@ void handleHue()
 
   if (!WLED_CONNECTED || hueClient == nullptr || millis() - hueLastRequestSent < huePollIntervalMs) return;
 
-  hueLastRequestSent = millis();
   if (huePollingEnabled)
   {
-    reconnectHue();
+    // reuse the open connection unless the last request never got an answer
+    if (hueClient->connected() && !hueAwaiting) sendHuePoll();
+    else { hueLastRequestSent = millis(); reconnectHue(); }
   } else {
+    hueLastRequestSent = millis();
     hueClient->close();
     if (hueError == HUE_ERROR_ACTIVE) hueError = HUE_ERROR_INACTIVE;
   }
@@ -40,8 +65,16 @@ void reconnectHue()
     hueClient->onConnect(&onHueConnect, hueClient);
     hueClient->onData(&onHueData, hueClient);
     hueClient->onError(&onHueError, hueClient);
+    hueClient->onDisconnect(&onHueDisconnect, hueClient);
     hueAuthRequired = (strlen(hueApiKey)<20);
   }
+  hueLastHash = 0; // settings may have changed
+  if (hueClient->connected() || hueClient->disconnecting()) {
+    hueClient->close(); // bridge IP may have changed, connect on next poll
+    hueLastRequestSent = millis() - huePollIntervalMs + 100;
+    return;
+  }
+  hueAwaiting = false;
   hueClient->connect(hueIP, 80);
 }
 
@@ -57,6 +90,13 @@ void onHueConnect(void* arg, AsyncClient* client)
   sendHuePoll();
 }
 
+void onHueDisconnect(void* arg, AsyncClient* client)
+{
+  DEBUG_PRINTLN(F("Hue disconnect"));
+  hueResetResponse();
+  hueAwaiting = false;
+}
+
 void sendHuePoll()
 {
   if (hueClient == nullptr || !hueClient->connected()) return;
@@ -65,7 +105,7 @@ void sendHuePoll()
   {
     req += F("POST /api HTTP/1.1\r\nHost: ");
     req += hueIP.toString();
-    req += F("\r\nContent-Length: 25\r\n\r\n{\"devicetype\":\"wled#esp\"}");
+    req += F("\r\nConnection: keep-alive\r\nContent-Length: 25\r\n\r\n{\"devicetype\":\"wled#esp\"}");
   } else
   {
     req += F("GET /api/");
@@ -74,28 +114,90 @@ void sendHuePoll()
     req += String(huePollLightId);
     req += F(" HTTP/1.1\r\nHost: ");
     req += hueIP.toString();
-    req += "\r\n\r\n";
+    req += F("\r\nConnection: keep-alive\r\n\r\n");
   }
+  hueResetResponse();
   hueClient->add(req.c_str(), req.length());
   hueClient->send();
+  hueAwaiting = true;
   hueLastRequestSent = millis();
 }
 
+// case insensitive search in the (null terminated) headers
+static const char* hueFindHeader(const char* headers, const char* name)
+{
+  size_t len = strlen(name);
+  for (const char* c = headers; *c; c++) if (!strncasecmp(c, name, len)) return c + len;
+  return nullptr;
+}
+
+// returns the body of the response in hueBuf once it is complete (null terminated), nullptr otherwise
+static char* hueResponseBody()
+{
+  char* body = strstr(hueBuf, "\r\n\r\n");
+  if (body == nullptr) return nullptr;
+  *body = '\0'; // terminate headers for searching
+  body += 4;
+  const char* cl = hueFindHeader(hueBuf, "Content-Length:");
+  bool chunked = hueFindHeader(hueBuf, "chunked") != nullptr;
+  body[-4] = '\r';
+  size_t bodyLen = hueBufLen - (body - hueBuf);
+
+  if (cl != nullptr && !chunked) return bodyLen >= (size_t)atoi(cl) ? body : nullptr;
+  if (!chunked) return nullptr; // bridges send either of both
+
+  // chunked: complete after the zero length chunk, then join chunks in place
+  if (bodyLen < 5 || strcmp(hueBuf + hueBufLen - 5, "0\r\n\r\n")) return nullptr;
+  char* src = body;
+  char* dst = body;
+  while (true) {
+    char* ext;
+    size_t len = strtoul(src, &ext, 16);
+    src = strstr(ext, "\r\n");
+    if (len == 0 || src == nullptr) break;
+    src += 2;
+    if (src + len > hueBuf + hueBufLen) break;
+    memmove(dst, src, len);
+    dst += len;
+    src += len + 2; // trailing CRLF
+  }
+  *dst = '\0';
+  return body;
+}
+
 void onHueData(void* arg, AsyncClient* client, void *data, size_t len)
 {
   if (!len) return;
-  char* str = (char*)data;
-  DEBUG_PRINTLN(hueApiKey);
+  if (hueBuf == nullptr) {
+    hueBuf = (char*)heapMalloc(HEAP_TAG_OTHER, HUE_RESPONSE_MAX);
+    if (hueBuf == nullptr) return;
+    hueBufLen = 0;
+  }
+  if (hueBufLen + len >= HUE_RESPONSE_MAX) { // more than a single light state, e.g. wrong light ID type
+    DEBUG_PRINTLN(F("Hue response too long"));
+    hueResetResponse();
+    hueAwaiting = false;
+    hueError = HUE_ERROR_JSON_PARSING;
+    client->close();
+    return;
+  }
+  memcpy(hueBuf + hueBufLen, data, len);
+  hueBufLen += len;
+  hueBuf[hueBufLen] = '\0';
+
+  char* str = hueResponseBody();
+  if (str == nullptr) return; // wait for more data
+  hueAwaiting = false;
   DEBUG_PRINTLN(str);
-  //only get response body
-  str = strstr(str,"\r\n\r\n");
-  if (str == nullptr) return;
-  str += 4;
 
-  StaticJsonDocument<1024> root;
+  StaticJsonDocument<256> filter;
+  StaticJsonDocument<384> root;
   if (str[0] == '[') //is JSON array
   {
-    auto error = deserializeJson(root, str);
+    filter[0][F("error")]["type"] = true;
+    filter[0][F("success")][F("username")] = true;
+    auto error = deserializeJson(root, (const char*)str, DeserializationOption::Filter(filter)); // copies strings, hueBuf is freed below
+    hueResetResponse();
     if (error)
     {
       hueError = HUE_ERROR_JSON_PARSING; return;
@@ -127,42 +229,47 @@ void onHueData(void* arg, AsyncClient* client, void *data, size_t len)
     return;
   }
 
-  //else, assume it is JSON object, look for state and only parse that
-  str = strstr(str,"state");
-  if (str == nullptr) return;
-  str = strstr(str,"{");
+  //else, assume it is JSON object, skip it if the light did not change since the last poll
+  uint32_t hash = fnv1a(str, strlen(str));
+  if (hash == hueLastHash && hueError == HUE_ERROR_ACTIVE) { hueResetResponse(); return; }
+  hueLastHash = hash;
 
-  auto error = deserializeJson(root, str);
-  if (error)
+  JsonObject fs = filter.createNestedObject("state");
+  fs["on"] = fs["bri"] = fs[F("colormode")] = fs["ct"] = fs["xy"] = fs["hue"] = fs[F("sat")] = true;
+  auto error = deserializeJson(root, (const char*)str, DeserializationOption::Filter(filter));
+  hueResetResponse();
+  if (error || !root["state"].is<JsonObject>())
   {
+    hueLastHash = 0;
     hueError = HUE_ERROR_JSON_PARSING; return;
   }
+  JsonObject state = root["state"];
 
   float hueX=0, hueY=0;
   uint16_t hueHue=0, hueCt=0;
   byte hueBri=0, hueSat=0, hueColormode=0;
 
-  if (root["on"]) {
-    if (root.containsKey("bri")) //Dimmable device
+  if (state["on"]) {
+    if (state.containsKey("bri")) //Dimmable device
     {
-      hueBri = root["bri"];
+      hueBri = state["bri"];
       hueBri++;
-      const char* cm =root[F("colormode")];
+      const char* cm =state[F("colormode")];
       if (cm != nullptr) //Color device
       {
         if (strstr(cm,("ct")) != nullptr) //ct mode
         {
-          hueCt = root["ct"];
+          hueCt = state["ct"];
           hueColormode = 3;
         } else if (strstr(cm,"xy") != nullptr) //xy mode
         {
-          hueX = root["xy"][0]; // 0.5051
-          hueY = root["xy"][1]; // 0.4151
+          hueX = state["xy"][0]; // 0.5051
+          hueY = state["xy"][1]; // 0.4151
           hueColormode = 1;
         } else //hs mode
         {
-          hueHue = root["hue"];
-          hueSat = root[F("sat")];
+          hueHue = state["hue"];
+          hueSat = state[F("sat")];
           hueColormode = 2;
         }
       }
@@ -0,0 +1,90 @@
+#include "wled.h"
+
+/*
+ * Idle power management (WLED_ENABLE_IDLE_PM): while no frame is due for a while (lights off, only static effects,
+ * no transition) and no realtime data is received, loop() sleeps at the end of each pass (lets WiFi modem sleep and
+ * the idle task run) and ESP32 clocks down to WLED_IDLE_CPU_MHZ. Input (state changes, realtime data) or a frame
+ * becoming due returns to full speed before anything is rendered; a hold time after input avoids toggling.
+ * Time spent at each level is reported in info ("pm").
+ * esp_pm (DFS, automatic light sleep) is not used: stock Arduino-ESP32 is built without CONFIG_PM_ENABLE, and light
+ * sleep would stop RMT/I2S LED output and delay network input. ESP8266 keeps its clock (bit-banged outputs are timed
+ * by CPU cycles), it only sleeps.
+ */
+
+#ifdef WLED_ENABLE_IDLE_PM
+
+#ifndef WLED_IDLE_CPU_MHZ
+  #define WLED_IDLE_CPU_MHZ 80 // lowest frequency keeping WiFi and the 80 MHz APB clock (RMT, I2S, LEDC)
+#endif
+#define IDLE_MIN_MS   50   // idle only if next frame is at least this far away
+#define IDLE_HOLD_MS  2000 // full speed after input
+#define IDLE_SLEEP_MS 10   // longest sleep per loop pass (latency of network input handled in loop())
+
+static bool          idleActive = false;
+static volatile bool idleWakeReq = false;
+static uint32_t      idleLastWake = 0;
+static uint32_t      idleSince = 0;      // millis() of last level change
+static uint32_t      idleMs[2] = {0, 0}; // time spent at full speed and idle
+static uint32_t      idleWakes = 0;
+#ifdef ARDUINO_ARCH_ESP32
+static uint32_t      idleFullMhz = 0;
+#endif
+
+// input arrived, may be called from any task
+void idleWake() {
+  idleWakeReq = true;
+}
+
+static void setIdle(bool idle) {
+  if (idle == idleActive) return;
+  uint32_t now = millis();
+  idleMs[idleActive] += now - idleSince;
+  idleSince = now;
+  idleActive = idle;
+  if (!idle) idleWakes++;
+#ifdef ARDUINO_ARCH_ESP32
+  if (!idleFullMhz) idleFullMhz = getCpuFrequencyMhz();
+  if (idleFullMhz > WLED_IDLE_CPU_MHZ) setCpuFrequencyMhz(idle ? WLED_IDLE_CPU_MHZ : idleFullMhz);
+#endif
+}
+
+// ms the system may idle, 0 if it has to run at full speed
+static uint32_t idleBudget() {
+  if (realtimeMode && !realtimeOverride) return 0; // frames are driven by incoming data
+  if (realtimeProfile || transitionActive || strip.isUpdating() || doInitBusses) return 0;
+  if (offMode && !strip.isOffRefreshRequired()) return UINT32_MAX;
+  return strip.timeToNextRender();
+}
+
+// end of loop(): clock down and sleep while idle, full speed once input arrived or a frame is about to become due
+void handleIdle() {
+  uint32_t now = millis();
+  if (idleWakeReq) {
+    idleWakeReq = false;
+    idleLastWake = now;
+  }
+  uint32_t budget = now - idleLastWake < IDLE_HOLD_MS ? 0 : idleBudget();
+  if (budget < IDLE_MIN_MS) {
+    setIdle(false);
+    return;
+  }
+  setIdle(true);
+  delay(MIN(budget - IDLE_MIN_MS, (uint32_t)IDLE_SLEEP_MS) + 1); // wakes at least IDLE_MIN_MS before next frame
+}
+
+void serializeIdle(JsonObject root) {
+  JsonObject pm = root.createNestedObject("pm");
+  pm[F("idle")] = idleActive;
+  pm[F("mhz")]  = ESP.getCpuFreqMHz();
+  uint32_t cur = millis() - idleSince;
+  JsonArray res = pm.createNestedArray(F("res")); // s at full speed, idle
+  res.add((idleMs[0] + (idleActive ? 0 : cur)) / 1000);
+  res.add((idleMs[1] + (idleActive ? cur : 0)) / 1000);
+  pm[F("wake")] = idleWakes;
+}
+
+#else
+void idleWake() {}
+void handleIdle() {}
+void serializeIdle(JsonObject root) {}
+#endif
@@ -8,6 +8,7 @@
 
 #if defined(WLED_DISABLE_INFRARED)
 void handleIR(){}
+void invalidateIRTable(){}
 #else
 
 IRrecv* irrecv;
@@ -628,81 +629,423 @@ Sample:
                "label": "Preset 1, fallback to Saw - Party if not found"},
 }
 */
-void decodeIRJson(uint32_t code)
+/*
+ * ir.json is not searched on every key press: one scan (on first use and again after the file changed) builds
+ * a hash table of IR code -> position and length of its object, so a key press reads and parses only that object.
+ * The most recently used commands are also kept compiled (HTTP API request, built-in function or JSON command
+ * text), repeats and favourite keys then need no file access and, unless they are JSON commands, no JSON buffer.
+ */
+#define IR_TABLE_MAX     512  // codes indexed
+#define IR_CACHE_SIZE    4    // compiled commands kept
+#define IR_CACHE_TEXT    256  // longer commands are not kept
+#define IR_TABLE_RECHECK 5000 // ms between checks whether ir.json changed (uploads invalidate immediately)
+
+enum : uint8_t { IR_CMD_HTTP, IR_CMD_INCBRI, IR_CMD_DECBRI, IR_CMD_PRESET, IR_CMD_JSON };
+
+struct IRTableEntry {
+  uint32_t code;
+  uint32_t pos; // of the object's '{'
+  uint16_t len; // 0: empty slot
+};
+
+struct IRCommand {
+  uint32_t code = 0;
+  uint32_t used = 0;       // LRU tick, 0: empty cache slot
+  uint8_t  type = IR_CMD_HTTP;
+  bool     rpt = false;    // repeatable action
+  uint8_t  preset = 0, fx = 0, pal = 0;
+  bool     randomFx = false;
+  char    *text = nullptr; // HTTP API request ("win&" prefixed) or serialized JSON command
+};
+
+static const char s_irFile[] PROGMEM = "/ir.json";
+
+static struct IRTable {
+  IRTableEntry *slots = nullptr;
+  uint16_t mask = 0;
+  size_t   size = 0;       // ir.json size the table was built for
+  uint32_t checked = 0;    // millis() of the last size check
+  bool     valid = false;
+  bool     exists = false; // ir.json was found
+} irTable;
+
+static volatile bool irTableStale = false; // set by invalidateIRTable(), may be called from the web server task
+static IRCommand irCache[IR_CACHE_SIZE];
+static uint32_t irCacheTick = 0;
+
+// ir.json was replaced (upload), table and compiled commands are rebuilt on next key press
+void invalidateIRTable() {
+  irTableStale = true;
+}
+
+static inline unsigned irHash(uint32_t code) {
+  return (code * 2654435761UL) >> 16;
+}
+
+static void irCacheClear() {
+  for (auto &c : irCache) { free(c.text); c = IRCommand(); }
+}
+
+// scans ir.json for root-level "0x<hex>": {...} objects, returns their number (only counts if slots is nullptr)
+static unsigned irTableScan(File &f, IRTableEntry *slots, uint16_t mask)
+{
+  unsigned n = 0;
+  int depth = 0;
+  unsigned keyPos = 0;
+  bool inStr = false, esc = false, inKey = false, keyOk = false, pending = false, inObj = false;
+  uint32_t keyCode = 0, objCode = 0, objStart = 0, p = 0;
+  uint8_t buf[128];
+
+  f.seek(0);
+  while (size_t len = f.read(buf, sizeof(buf))) {
+    for (size_t i = 0; i < len; i++, p++) {
+      char c = buf[i];
+      if (inStr) {
+        if (esc) esc = false;
+        else if (c == '\\') { esc = true; keyOk = false; }
+        else if (c == '"') { inStr = false; if (inKey) pending = keyOk && keyPos > 2; inKey = false; }
+        else if (inKey && keyOk) {
+          if      (keyPos == 0) keyOk = (c == '0');
+          else if (keyPos == 1) keyOk = (c == 'x' || c == 'X');
+          else if (keyPos < 10 && isxdigit(c)) keyCode = (keyCode << 4) | (isdigit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+          else keyOk = false;
+          keyPos++;
+        }
+        continue;
+      }
+      switch (c) {
+        case '"':
+          inStr = true;
+          inKey = (depth == 1);
+          keyOk = true; keyPos = 0; keyCode = 0;
+          pending = false;
+          break;
+        case '{':
+          if (depth == 1 && pending) { inObj = true; objCode = keyCode; objStart = p; }
+          pending = false;
+          depth++;
+          break;
+        case '}':
+          depth--;
+          if (depth == 1 && inObj) {
+            inObj = false;
+            uint32_t objLen = p + 1 - objStart;
+            if (objLen > UINT16_MAX || n >= IR_TABLE_MAX) break;
+            n++;
+            if (!slots) break;
+            for (unsigned h = irHash(objCode); ; h++) { // table is at most half full
+              IRTableEntry &e = slots[h & mask];
+              if (!e.len) { e.code = objCode; e.pos = objStart; e.len = objLen; break; }
+              if (e.code == objCode) { n--; break; } // first one counts (as the scan did)
+            }
+          }
+          break;
+        case ':': case ',': case ' ': case '\t': case '\r': case '\n':
+          break;
+        default:
+          pending = false; // not an object
+          break;
+      }
+    }
+  }
+  return n;
+}
+
+static void irTableBuild()
 {
-  char objKey[10];
-  String cmdStr;
-  JsonObject fdo;
-  JsonObject jsonCmdObj;
+  #ifdef WLED_DEBUG
+  uint32_t s = millis();
+  #endif
+  free(irTable.slots);
+  irTable = IRTable();
+  irTableStale = false;
+  irCacheClear();
+  irTable.checked = millis();
+  irTable.valid = true;
 
-  if (!requestJSONBufferLock(13)) return;
+  char fileName[10];
+  strcpy_P(fileName, s_irFile);
+  File f = WLED_FS.open(fileName, "r");
+  if (!f) return;
+  irTable.exists = true;
+  irTable.size = f.size();
+  unsigned n = irTableScan(f, nullptr, 0);
+  if (n) {
+    unsigned cap = 4;
+    while (cap < 2 * n) cap <<= 1;
+    irTable.slots = (IRTableEntry*)calloc(cap, sizeof(IRTableEntry));
+    if (irTable.slots) {
+      irTable.mask = cap - 1;
+      irTableScan(f, irTable.slots, irTable.mask);
+    } else irTable.valid = false; // retry next time
+  }
+  f.close();
+  DEBUG_PRINTF("IR: %u codes indexed in %u ms.\n", n, millis() - s);
+}
 
-  sprintf_P(objKey, PSTR("\"0x%lX\":"), (unsigned long)code);
+// rebuilds the table if ir.json was uploaded or (checked every few seconds) its size changed
+static void irTableCheck()
+{
+  if (irTableStale || !irTable.valid) { irTableBuild(); return; }
+  if (millis() - irTable.checked < IR_TABLE_RECHECK) return;
+  irTable.checked = millis();
+  char fileName[10];
+  strcpy_P(fileName, s_irFile);
+  File f = WLED_FS.open(fileName, "r");
+  bool changed = f ? (!irTable.exists || f.size() != irTable.size) : irTable.exists;
+  f.close();
+  if (changed) irTableBuild();
+}
 
-  // attempt to read command from ir.json
-  // this may fail for two reasons: ir.json does not exist or IR code not found
-  // if the IR code is not found readObjectFromFile() will clean() doc JSON document
-  // so we can differentiate between the two
-  readObjectFromFile("/ir.json", objKey, &doc);
-  fdo = doc.as<JsonObject>();
-  lastValidCode = 0;
-  if (fdo.isNull()) {
+static const IRTableEntry *irTableFind(uint32_t code)
+{
+  if (!irTable.slots) return nullptr;
+  for (unsigned h = irHash(code); ; h++) {
+    const IRTableEntry &e = irTable.slots[h & irTable.mask];
+    if (!e.len) return nullptr;
+    if (e.code == code) return &e;
+  }
+}
+
+// compiles the command of an ir.json object
+static bool irCompile(JsonObject fdo, IRCommand &c)
+{
+  JsonObject jsonCmdObj = fdo["cmd"];
+  if (!jsonCmdObj.isNull()) {
+    c.type = IR_CMD_JSON;
+    size_t len = measureJson(jsonCmdObj) + 1;
+    c.text = (char*)malloc(len);
+    if (!c.text) return false;
+    serializeJson(jsonCmdObj, c.text, len);
+    return true;
+  }
+  String cmdStr = fdo["cmd"].as<String>();
+  if (cmdStr.startsWith("!")) {
+    // call limited set of C functions
+    if (cmdStr.startsWith(F("!incBri"))) {
+      c.type = IR_CMD_INCBRI; c.rpt = true;
+    } else if (cmdStr.startsWith(F("!decBri"))) {
+      c.type = IR_CMD_DECBRI; c.rpt = true;
+    } else if (cmdStr.startsWith(F("!presetF"))) { //!presetFallback
+      c.type = IR_CMD_PRESET;
+      c.preset = fdo["PL"] | 1;
+      c.randomFx = fdo["FX"].isNull();
+      c.fx = fdo["FX"] | 0;
+      c.pal = fdo["FP"] | 0;
+    } else return false;
+    return true;
+  }
+  // HTTP API command
+  String apireq = "win"; apireq += '&';                        // reduce flash string usage
+  if (cmdStr.indexOf("~") > 0 || fdo["rpt"]) c.rpt = true;     // repeatable action
+  if (!cmdStr.startsWith(apireq)) cmdStr = apireq + cmdStr;    // if no "win&" prefix
+  c.type = IR_CMD_HTTP;
+  c.text = strdup(cmdStr.c_str());
+  return c.text != nullptr;
+}
+
+// reads and compiles the command of a code from ir.json
+static bool irLoad(uint32_t code, IRCommand &c)
+{
+  irTableCheck();
+  const IRTableEntry *e = irTableFind(code);
+  if (!e) {
     //the received code does not exist
-    if (!WLED_FS.exists("/ir.json")) errorFlag = ERR_FS_IRLOAD; //warn if IR file itself doesn't exist
-    releaseJSONBufferLock();
-    return;
+    if (!irTable.exists) errorFlag = ERR_FS_IRLOAD; //warn if IR file itself doesn't exist
+    return false;
   }
+  if (!requestJSONBufferLock(JSON_LOCK_IR)) return false;
+  char fileName[10];
+  strcpy_P(fileName, s_irFile);
+  File f = WLED_FS.open(fileName, "r");
+  bool ok = f && f.size() == irTable.size && f.seek(e->pos) && f.peek() == '{' && !deserializeJson(doc, f);
+  f.close();
+  if (ok) {
+    c.code = code;
+    ok = irCompile(doc.as<JsonObject>(), c);
+  } else irTable.valid = false; // modified, rebuild on next key press
+  doc.clear();
+  releaseJSONBufferLock();
+  return ok;
+}
+
+static IRCommand *irCacheFind(uint32_t code)
+{
+  for (auto &c : irCache) if (c.used && c.code == code) { c.used = ++irCacheTick; return &c; }
+  return nullptr;
+}
 
-  cmdStr = fdo["cmd"].as<String>();
-  jsonCmdObj = fdo["cmd"]; //object
+// moves a compiled command into the cache (replacing the least recently used one), returns the cached command or c
+static IRCommand *irCacheStore(IRCommand &c)
+{
+  if (c.text && strlen(c.text) > IR_CACHE_TEXT) return &c;
+  IRCommand *slot = &irCache[0];
+  for (auto &s : irCache) if (s.used < slot->used) slot = &s;
+  free(slot->text);
+  *slot = c;
+  slot->used = ++irCacheTick;
+  c.text = nullptr;
+  return slot;
+}
 
-  if (jsonCmdObj.isNull())  // we could also use: fdo["cmd"].is<String>()
-  {
-    if (cmdStr.startsWith("!")) {
-      // call limited set of C functions
-      if (cmdStr.startsWith(F("!incBri"))) {
-        lastValidCode = code;
-        incBrightness();
-      } else if (cmdStr.startsWith(F("!decBri"))) {
-        lastValidCode = code;
-        decBrightness();
-      } else if (cmdStr.startsWith(F("!presetF"))) { //!presetFallback
-        uint8_t p1 = fdo["PL"] | 1;
-        uint8_t p2 = fdo["FX"] | random8(strip.getModeCount() -1);
-        uint8_t p3 = fdo["FP"] | 0;
-        presetFallback(p1, p2, p3);
-      }
-    } else {
-      // HTTP API command
-      String apireq = "win"; apireq += '&';                        // reduce flash string usage
-      if (cmdStr.indexOf("~") > 0 || fdo["rpt"]) lastValidCode = code; // repeatable action
-      if (!cmdStr.startsWith(apireq)) cmdStr = apireq + cmdStr;    // if no "win&" prefix
+static void irExecute(const IRCommand &c)
+{
+  switch (c.type) {
+    case IR_CMD_INCBRI: incBrightness(); break;
+    case IR_CMD_DECBRI: decBrightness(); break;
+    case IR_CMD_PRESET: presetFallback(c.preset, c.randomFx ? random8(strip.getModeCount() -1) : c.fx, c.pal); break;
+    case IR_CMD_HTTP: {
+      String cmdStr = c.text;
       if (!irApplyToAllSelected && cmdStr.indexOf(F("SS="))<0) {
         char tmp[10];
         sprintf_P(tmp, PSTR("&SS=%d"), strip.getMainSegmentId());
         cmdStr += tmp;
       }
-      fdo.clear();                                                 // clear JSON buffer (it is no longer needed)
       handleSet(nullptr, cmdStr, false);                           // no stateUpdated() call here
+      break;
     }
-  } else {
-    // command is JSON object (TODO: currently will not handle irApplyToAllSelected correctly)
-    if (jsonCmdObj[F("psave")].isNull()) deserializeState(jsonCmdObj, CALL_MODE_BUTTON_PRESET);
-    else {
-      uint8_t psave = jsonCmdObj[F("psave")].as<int>();
-      char pname[33];
-      sprintf_P(pname, PSTR("IR Preset %d"), psave);
-      fdo.clear();
-      if (psave > 0 && psave < 251) savePreset(psave, pname, fdo);
+    case IR_CMD_JSON: {
+      // command is JSON object (TODO: currently will not handle irApplyToAllSelected correctly)
+      if (!requestJSONBufferLock(JSON_LOCK_IR)) return;
+      deserializeJson(doc, (const char*)c.text); // copy, the cached text is kept
+      JsonObject jsonCmdObj = doc.as<JsonObject>();
+      if (jsonCmdObj[F("psave")].isNull()) deserializeState(jsonCmdObj, CALL_MODE_BUTTON_PRESET);
+      else {
+        uint8_t psave = jsonCmdObj[F("psave")].as<int>();
+        char pname[33];
+        sprintf_P(pname, PSTR("IR Preset %d"), psave);
+        JsonObject fdo = doc.to<JsonObject>();
+        if (psave > 0 && psave < 251) savePreset(psave, pname, fdo);
+      }
+      releaseJSONBufferLock();
+      break;
     }
   }
-  releaseJSONBufferLock();
+}
+
+void decodeIRJson(uint32_t code)
+{
+  lastValidCode = 0;
+  if (irTableStale) irTableBuild(); // drops compiled commands of the old file
+  IRCommand loaded;
+  IRCommand *c = irCacheFind(code);
+  if (!c) {
+    if (!irLoad(code, loaded)) { free(loaded.text); return; }
+    c = irCacheStore(loaded);
+  }
+  if (c->rpt) lastValidCode = code;
+  irExecute(*c);
+  free(loaded.text); // not cached
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && !defined(WLED_IR_NO_RMT)
+/*
+ * ESP32: frames of the built-in remotes (NEC/Samsung style 32 bit pulse distance codes) are captured by an RMT
+ * receive channel and decoded by a low priority task, so there is no IR timing work in the loop or GPIO interrupts.
+ * Codes (same values as IRremoteESP8266, MSB first) are queued for handleIR(). ir.json remotes may use any protocol
+ * and keep using IRremoteESP8266, as does everything if the RMT channel is needed by a digital LED output.
+ */
+#include "driver/rmt.h"
+#define WLED_IR_USE_RMT
+#ifndef WLED_IR_RMT_CHANNEL
+  #if defined(CONFIG_IDF_TARGET_ESP32C3)
+    #define WLED_IR_RMT_CHANNEL RMT_CHANNEL_2 // 1st receive only channel
+  #elif defined(CONFIG_IDF_TARGET_ESP32S3)
+    #define WLED_IR_RMT_CHANNEL RMT_CHANNEL_4 // 1st receive only channel
+  #elif defined(CONFIG_IDF_TARGET_ESP32S2)
+    #define WLED_IR_RMT_CHANNEL RMT_CHANNEL_3 // also used by 4th bus
+  #else
+    #define WLED_IR_RMT_CHANNEL RMT_CHANNEL_7 // also used by 8th bus
+  #endif
+#endif
+
+static TaskHandle_t  irTask = nullptr;
+static QueueHandle_t irQueue = nullptr;
+static volatile bool irRmtStop = false;
+
+// duration within +-25% of expected one (us)
+static inline bool irMatch(uint32_t d, uint32_t t) { return d > (t * 3) / 4 && d < (t * 5) / 4 + 100; }
+
+// receiver output is active low: duration0 is a mark, duration1 the following space
+static bool irRmtDecode(const rmt_item32_t *it, size_t n, uint32_t &code)
+{
+  if (n < 2) return false;
+  uint32_t mark = it[0].duration0, space = it[0].duration1;
+  if (!irMatch(mark, 9000) && !irMatch(mark, 4500)) return false;
+  if (irMatch(mark, 9000) && irMatch(space, 2250)) { code = 0xFFFFFFFF; return true; } // NEC repeat
+  if (!irMatch(space, 4500) || n < 33) return false;
+  uint32_t v = 0;
+  for (size_t i = 1; i <= 32; i++) {
+    if (!irMatch(it[i].duration0, 560)) return false;
+    if      (irMatch(it[i].duration1, 1690)) v = (v << 1) | 1;
+    else if (irMatch(it[i].duration1, 560))  v <<= 1;
+    else return false;
+  }
+  code = v;
+  return true;
+}
+
+static void irRmtTask(void *)
+{
+  RingbufHandle_t rb = nullptr;
+  rmt_get_ringbuf_handle(WLED_IR_RMT_CHANNEL, &rb);
+  rmt_rx_start(WLED_IR_RMT_CHANNEL, true);
+  while (!irRmtStop) {
+    size_t len = 0;
+    rmt_item32_t *items = (rmt_item32_t*) xRingbufferReceive(rb, &len, pdMS_TO_TICKS(100));
+    if (!items) continue;
+    uint32_t code;
+    if (irRmtDecode(items, len / sizeof(rmt_item32_t), code)) xQueueSend(irQueue, &code, 0);
+    vRingbufferReturnItem(rb, items);
+  }
+  rmt_rx_stop(WLED_IR_RMT_CHANNEL);
+  rmt_driver_uninstall(WLED_IR_RMT_CHANNEL);
+  irTask = nullptr;
+  vTaskDelete(nullptr);
+}
+
+static bool irRmtStart()
+{
+  #if !defined(CONFIG_IDF_TARGET_ESP32C3) && !defined(CONFIG_IDF_TARGET_ESP32S3)
+  if (busses.getNumBusses() > WLED_IR_RMT_CHANNEL) return false; // bus N may use RMT channel N
+  #endif
+  if (!irQueue) irQueue = xQueueCreate(4, sizeof(uint32_t));
+  if (!irQueue) return false;
+  rmt_config_t cfg = RMT_DEFAULT_CONFIG_RX((gpio_num_t)irPin, WLED_IR_RMT_CHANNEL);
+  cfg.clk_div = 80;                      // 1us ticks
+  cfg.rx_config.filter_en = true;
+  cfg.rx_config.filter_ticks_thresh = 100;
+  cfg.rx_config.idle_threshold = 12000;  // end of frame
+  if (rmt_config(&cfg) != ESP_OK || rmt_driver_install(WLED_IR_RMT_CHANNEL, 512, 0) != ESP_OK) return false;
+  irRmtStop = false;
+  if (xTaskCreate(irRmtTask, "IR", 2048, nullptr, 1, &irTask) != pdPASS) {
+    irTask = nullptr;
+    rmt_driver_uninstall(WLED_IR_RMT_CHANNEL);
+    return false;
+  }
+  DEBUG_PRINTLN(F("IR: RMT receiver started."));
+  return true;
+}
+#endif
+
+static void handleIRCode(uint32_t code)
+{
+  if (code != 0) // only print results if anything is received ( != 0 )
+  {
+    if (!pinManager.isPinAllocated(hardwareTX) || pinManager.getPinOwner(hardwareTX) == PinOwner::DebugOut) // Serial TX pin (GPIO 1 on ESP32 and ESP8266)
+      Serial.printf_P(PSTR("IR recv: 0x%lX\n"), (unsigned long)code);
+  }
+  decodeIR(code);
 }
 
 void initIR()
 {
   if (irEnabled > 0)
   {
+    if (irEnabled == 8) irTableBuild();
+    #ifdef WLED_IR_USE_RMT
+    if (irEnabled != 8 && irRmtStart()) return;
+    #endif
     irrecv = new IRrecv(irPin);
     irrecv->enableIRIn();
   }
@@ -710,6 +1053,15 @@ void initIR()
 
 void handleIR()
 {
+  #ifdef WLED_IR_USE_RMT
+  if (irTask) {
+    if (irEnabled > 0 && irEnabled != 8 && !irRmtStop) {
+      uint32_t code;
+      while (xQueueReceive(irQueue, &code, 0) == pdTRUE) handleIRCode(code);
+    } else irRmtStop = true; // task stops the receiver and ends itself
+    return;
+  }
+  #endif
   if (irEnabled > 0 && millis() - irCheckedTime > 120 && !strip.isUpdating())
   {
     irCheckedTime = millis();
@@ -722,12 +1074,7 @@ void handleIR()
 
       if (irrecv->decode(&results))
       {
-        if (results.value != 0) // only print results if anything is received ( != 0 )
-        {
-					if (!pinManager.isPinAllocated(hardwareTX) || pinManager.getPinOwner(hardwareTX) == PinOwner::DebugOut) // Serial TX pin (GPIO 1 on ESP32 and ESP8266)
-          	Serial.printf_P(PSTR("IR recv: 0x%lX\n"), (unsigned long)results.value);
-        }
-        decodeIR(results.value);
+        handleIRCode(results.value);
         irrecv->resume();
       }
     } else if (irrecv != NULL)
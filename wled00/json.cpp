@@ -1,6 +1,7 @@
 #include "wled.h"
 
 #include "palettes.h"
+#include <memory>
 
 #define JSON_PATH_STATE      1
 #define JSON_PATH_INFO       2
@@ -10,11 +11,130 @@
 #define JSON_PATH_FXDATA     6
 #define JSON_PATH_NETWORKS   7
 #define JSON_PATH_EFFECTS    8
+#define JSON_PATH_PERF       9
+#define JSON_PATH_BENCH     10
+#define JSON_PATH_RTSTATS   11
+#define JSON_PATH_FSSTATS   12
+#define JSON_PATH_HEAP      13
+#define JSON_PATH_MEM       14
 
 /*
  * JSON API (De)serialization
  */
 
+// individual LED data ("i", "ib", POST /json/leds) is written unmapped into a frozen segment, shown at once
+static uint8_t beginPixelData(Segment &seg)
+{
+  uint8_t oldMap1D2D = seg.map1D2D;
+  seg.map1D2D = M12_Pixels; // no mapping
+  seg.updateGeometry();
+
+  // set brightness immediately and disable transition
+  jsonTransitionOnce = true;
+  seg.stopTransition();
+  strip.setTransition(0);
+  strip.setBrightness(scaledBri(bri), true);
+
+  // freeze and init to black
+  if (!seg.freeze) {
+    seg.freeze = true;
+    seg.fill(BLACK);
+  }
+  return oldMap1D2D;
+}
+
+static void endPixelData(Segment &seg, uint8_t oldMap1D2D)
+{
+  seg.map1D2D = oldMap1D2D; // restore mapping
+  seg.updateGeometry();
+  strip.trigger(); // force segment update
+}
+
+/*
+ * compact per-LED data: "ib":{"d":"<base64>" (or "h":"<hex>"), "s":start, "t":stride, "f":bytes per pixel}
+ * pixel formats: 3 RGB (default), 4 RGBW, 2 RGB565 (big endian), 1 grey; pixels go to start, start + stride, ...
+ * (2D segments row by row), decoded straight into the segment (no JSON array); raw bytes: POST /json/leds
+ */
+struct PixelDataWriter {
+  Segment *seg;
+  uint32_t pos, end;   // next pixel, buffer length
+  uint16_t stride;
+  uint8_t  bpp;        // bytes per pixel
+  uint8_t  fill;       // bytes of current pixel received
+  uint8_t  px[4];
+  uint8_t  oldMap1D2D; // restored when done (POST)
+  uint8_t  runLen;
+  uint32_t run[16];    // contiguous pixels are written as a run
+  void init(Segment &s, uint16_t first, uint16_t step, uint8_t bytes);
+  void write(const uint8_t *data, size_t len);
+  void flush();
+};
+
+void PixelDataWriter::init(Segment &s, uint16_t first, uint16_t step, uint8_t bytes)
+{
+  seg    = &s;
+  pos    = first;
+  stride = step ? step : 1;
+  bpp    = (bytes >= 1 && bytes <= 4) ? bytes : 3;
+  fill   = runLen = 0;
+  end    = s.bufferLength();
+}
+
+void PixelDataWriter::flush()
+{
+  if (runLen) seg->setPixelsRaw(pos - runLen, runLen, run);
+  runLen = 0;
+}
+
+void PixelDataWriter::write(const uint8_t *data, size_t len)
+{
+  for (size_t i = 0; i < len && pos < end; i++) {
+    px[fill++] = data[i];
+    if (fill < bpp) continue;
+    fill = 0;
+    uint32_t c;
+    switch (bpp) {
+      case 1:  c = RGBW32(px[0], px[0], px[0], 0); break;
+      case 2:  { uint16_t v = (px[0] << 8) | px[1]; c = RGBW32(((v >> 8) & 0xF8) | (v >> 13), ((v >> 3) & 0xFC) | ((v >> 9) & 0x03), ((v << 3) & 0xF8) | ((v >> 2) & 0x07), 0); } break;
+      case 4:  c = RGBW32(px[0], px[1], px[2], px[3]); break;
+      default: c = RGBW32(px[0], px[1], px[2], 0); break;
+    }
+    c = gamma32(c);
+    if (stride > 1) { seg->setPixelColor(int(pos), c); pos += stride; continue; }
+    run[runLen++] = c; pos++;
+    if (runLen == sizeof(run)/sizeof(run[0])) flush();
+  }
+}
+
+static int8_t base64Value(char c)
+{
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  if (c == '+' || c == '-') return 62; // also URL safe alphabet
+  if (c == '/' || c == '_') return 63;
+  return -1;
+}
+
+static void decodePixelData(PixelDataWriter &w, const char *str, bool hex)
+{
+  uint8_t out[48];
+  size_t n = 0;
+  uint32_t acc = 0;
+  unsigned bits = 0;
+  for (; *str; str++) {
+    int8_t v;
+    if (hex) { v = (*str >= '0' && *str <= '9') ? *str - '0' : ((*str | 0x20) >= 'a' && (*str | 0x20) <= 'f') ? (*str | 0x20) - 'a' + 10 : -1; if (v >= 0) { acc = (acc << 4) | v; bits += 4; } }
+    else     { v = base64Value(*str);                                                                                                 if (v >= 0) { acc = (acc << 6) | v; bits += 6; } }
+    if (bits < 8) continue; // skips padding and white space too
+    bits -= 8;
+    out[n++] = acc >> bits;
+    if (n == sizeof(out)) { w.write(out, n); n = 0; }
+  }
+  if (n) w.write(out, n);
+  w.flush();
+}
+
 bool deserializeSegment(JsonObject elem, byte it, byte presetId)
 {
   byte id = elem["id"] | it;
@@ -34,8 +154,7 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
   //DEBUG_PRINTLN("-- JSON deserialize segment.");
   Segment& seg = strip.getSegment(id);
   //DEBUG_PRINTF("--  Original segment: %p\n", &seg);
-  Segment prev = seg; //make a backup so we can tell if something changed
-  //DEBUG_PRINTF("--  Duplicate segment: %p\n", &prev);
+  const Segment::settings_t prev = seg.settings(); //make a backup so we can tell if something changed (settings only, no buffers)
 
   uint16_t start = elem["start"] | seg.start;
   if (stop < 0) {
@@ -97,7 +216,7 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
   uint8_t  soundSim = elem["si"] | seg.soundSim;
   uint8_t  map1D2D  = elem["m12"] | seg.map1D2D;
 
-  if ((spc>0 && spc!=seg.spacing) || seg.map1D2D!=map1D2D) seg.fill(BLACK); // clear spacing gaps
+  if ((spc>0 && spc!=seg.spacing) || seg.map1D2D!=map1D2D) seg.clear(); // clear spacing gaps
 
   seg.map1D2D  = constrain(map1D2D, 0, 7);
   seg.soundSim = constrain(soundSim, 0, 1);
@@ -119,7 +238,7 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
   // update segment (delete if necessary)
   // do not call seg.setUp() here, as it may cause a crash due to concurrent access if the segment is currently drawing effects
   // WS2812FX handles queueing of the change
-  strip.setSegment(id, start, stop, grp, spc, of, startY, stopY);
+  strip.setSegment(id, start, stop, grp, spc, of, startY, stopY, elem["cv"] | 255);
   if (newSeg) seg.refreshLightCapabilities(); // fix for #3403
 
   if (seg.reset && seg.stop == 0) {
@@ -142,6 +261,22 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
 
   seg.setCCT(elem["cct"] | seg.cct);
 
+  // layer compositing: blend mode, layer opacity and z-order
+  uint8_t bm = elem["bm"] | seg.blendMode;
+  if (bm < SEG_BLEND_COUNT) seg.blendMode = bm;
+  seg.layerOpacity = elem["lo"] | seg.layerOpacity;
+  seg.zIndex = constrain(elem["z"] | (int)seg.zIndex, -128, 127);
+  seg.interpolate = elem["ip"] | seg.interpolate; // blend output frames between effect updates
+
+  #ifndef WLED_DISABLE_2D
+  // reduced resolution rendering (2D): effect canvas is 1/2 or 1/4 of segment size, upscaled when rendered
+  uint8_t rs = elem["rs"] | seg.renderScale;
+  if (rs > 2) rs = 2;
+  if (rs != seg.renderScale) seg.markForReset(); // effect data may depend on canvas size
+  seg.renderScale  = rs;
+  seg.renderSmooth = elem["rsm"] | seg.renderSmooth;
+  #endif
+
   JsonArray colarr = elem["col"];
   if (!colarr.isNull())
   {
@@ -210,8 +345,9 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
   seg.reverse_y  = elem["rY"]  | seg.reverse_y;
   seg.mirror_y   = elem["mY"]  | seg.mirror_y;
   seg.transpose  = elem[F("tp")] | seg.transpose;
-  if (seg.is2D() && seg.map1D2D == M12_pArc && (reverse != seg.reverse || reverse_y != seg.reverse_y || mirror != seg.mirror || mirror_y != seg.mirror_y)) seg.fill(BLACK); // clear entire segment (in case of Arc 1D to 2D expansion)
+  if (seg.is2D() && seg.map1D2D == M12_pArc && (reverse != seg.reverse || reverse_y != seg.reverse_y || mirror != seg.mirror || mirror_y != seg.mirror_y)) seg.clear(); // clear entire segment (in case of Arc 1D to 2D expansion)
   #endif
+  seg.updateGeometry(); // options and mapping are assigned directly
 
   byte fx = seg.mode;
   byte last = strip.getModeCount();
@@ -247,20 +383,7 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
 
   JsonArray iarr = elem[F("i")]; //set individual LEDs
   if (!iarr.isNull()) {
-    uint8_t oldMap1D2D = seg.map1D2D;
-    seg.map1D2D = M12_Pixels; // no mapping
-
-    // set brightness immediately and disable transition
-    jsonTransitionOnce = true;
-    seg.stopTransition();
-    strip.setTransition(0);
-    strip.setBrightness(scaledBri(bri), true);
-
-    // freeze and init to black
-    if (!seg.freeze) {
-      seg.freeze = true;
-      seg.fill(BLACK);
-    }
+    uint8_t oldMap1D2D = beginPixelData(seg);
 
     uint16_t start = 0, stop = 0;
     byte set = 0; //0 nothing set, 1 start set, 2 range set
@@ -294,8 +417,17 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
         set = 0;
       }
     }
-    seg.map1D2D = oldMap1D2D; // restore mapping
-    strip.trigger(); // force segment update
+    endPixelData(seg, oldMap1D2D);
+  }
+
+  JsonObject ib = elem[F("ib")]; //individual LEDs, compact encoding
+  if (!ib.isNull() && (ib["d"].is<const char*>() || ib["h"].is<const char*>())) {
+    uint8_t oldMap1D2D = beginPixelData(seg);
+    PixelDataWriter w;
+    w.init(seg, ib["s"] | 0, ib["t"] | 1, ib["f"] | 3);
+    if (ib["d"].is<const char*>()) decodePixelData(w, ib["d"], false);
+    else                           decodePixelData(w, ib["h"], true);
+    endPixelData(seg, oldMap1D2D);
   }
   // send UDP/WS if segment options changed (except selection; will also deselect current preset)
   if (seg.differs(prev) & 0x7F) stateChanged = true;
@@ -307,6 +439,7 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
 // presetId is non-0 if called from handlePreset()
 bool deserializeState(JsonObject root, byte callMode, byte presetId)
 {
+  StateGuard state; // requests of other tasks may be parsed meanwhile, but are applied after this one
   bool stateResponse = root[F("v")] | false;
 
   #if defined(WLED_DEBUG) && defined(WLED_DEBUG_HOST)
@@ -327,9 +460,7 @@ bool deserializeState(JsonObject root, byte callMode, byte presetId)
     for (size_t s=0; s < strip.getSegmentsNum(); s++) {
       strip.getSegment(s).freeze = false;
     }
-    if (realtimeMode && !realtimeOverride && useMainSegmentOnly) { // keep live segment frozen if live
-      strip.getMainSegment().freeze = true;
-    }
+    if (realtimeMode && !realtimeOverride) realtimeFreezeSegments(true); // keep live segments frozen if live
   }
 
   int tr = -1;
@@ -351,6 +482,9 @@ bool deserializeState(JsonObject root, byte callMode, byte presetId)
   tr = root[F("tb")] | -1;
   if (tr >= 0) strip.timebase = ((uint32_t)tr) - millis();
 
+  // seed of effect random numbers (restarts effects), nodes given the same seed together show the same effects
+  if (root[F("seed")].is<uint32_t>()) strip.setRandomSeed(root[F("seed")]);
+
   JsonObject nl       = root["nl"];
   nightlightActive    = nl["on"]      | nightlightActive;
   nightlightDelayMins = nl["dur"]     | nightlightDelayMins;
@@ -377,9 +511,7 @@ bool deserializeState(JsonObject root, byte callMode, byte presetId)
 
   realtimeOverride = root[F("lor")] | realtimeOverride;
   if (realtimeOverride > 2) realtimeOverride = REALTIME_OVERRIDE_ALWAYS;
-  if (realtimeMode && useMainSegmentOnly) {
-    strip.getMainSegment().freeze = !realtimeOverride;
-  }
+  if (realtimeMode) realtimeFreezeSegments(!realtimeOverride);
 
   if (root.containsKey("live")) {
     if (root["live"].as<bool>()) {
@@ -391,6 +523,16 @@ bool deserializeState(JsonObject root, byte callMode, byte presetId)
     }
   }
 
+  #ifdef WLED_ENABLE_FSEQ
+  JsonObject fseq = root[F("fseq")];
+  if (!fseq.isNull()) {
+    const char *fn = fseq["f"] | "";
+    if (fseq["on"] | (bool)fn[0]) {
+      if (fn[0]) fseqPlay(fn, fseq[F("loop")] | false, fseq["at"] | 0.0, fseq["ch"] | 3);
+    } else fseqStop();
+  }
+  #endif
+
   int it = 0;
   JsonVariant segVar = root["seg"];
   if (segVar.is<JsonObject>())
@@ -470,7 +612,7 @@ bool deserializeState(JsonObject root, byte callMode, byte presetId)
       char fileName[32];
       sprintf_P(fileName, PSTR("/palette%d.json"), strip.customPalettes.size()-1);
       if (WLED_FS.exists(fileName)) WLED_FS.remove(fileName);
-      strip.loadCustomPalettes();
+      strip.loadCustomPalettes(true);
     }
   }
 
@@ -480,6 +622,193 @@ bool deserializeState(JsonObject root, byte callMode, byte presetId)
   return stateResponse;
 }
 
+/*
+ * Fast path for small, frequent state commands (e.g. {"bri":128}, {"on":"t"}, {"seg":[{"id":0,"fx":5}]})
+ * Recognizes only objects with keys on, bri, transition, tt, v and a single "seg" object with keys
+ * id, fx, sx, ix, pal, c1, c2, c3, bri, on (plain integers 0-255 or booleans, "t" for toggling on).
+ * Such commands are applied directly, with the same results as deserializeState(), without parsing into a JSON buffer.
+ * Returns false (nothing applied) for anything else, the caller then uses the full path.
+ */
+#define FAST_STATE_MAX_LEN 160
+
+struct FastStateCmd {
+  int16_t bri = -1;
+  int32_t tr = -1, tt = -1;
+  int8_t  on = -1;      // 0 off, 1 on, 2 toggle ("t")
+  bool    v = false;
+  bool    seg = false, segArray = false;
+  int16_t id = -1;
+  int16_t fx = -1, sx = -1, ix = -1, pal = -1, c1 = -1, c2 = -1, c3 = -1, sbri = -1;
+  int8_t  son = -1;
+};
+
+struct FastJsonScanner {
+  const char *p, *end;
+  void ws() { while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++; }
+  bool eat(char c) { ws(); if (p < end && *p == c) { p++; return true; } return false; }
+  // key or short string without escapes
+  bool str(char *out, size_t size) {
+    if (!eat('"')) return false;
+    size_t n = 0;
+    while (p < end && *p != '"') {
+      if (*p == '\\' || n + 1 >= size) return false;
+      out[n++] = *p++;
+    }
+    out[n] = 0;
+    return eat('"');
+  }
+  // integer 0-65535 (isBool false), boolean (0/1) or "t" (2) for on
+  bool val(int32_t &v, bool &isBool, bool allowToggle = false) {
+    ws();
+    if (p >= end) return false;
+    isBool = true;
+    if (*p == 't' && end - p >= 4 && !strncmp(p, "true", 4))  { p += 4; v = 1; return true; }
+    if (*p == 'f' && end - p >= 5 && !strncmp(p, "false", 5)) { p += 5; v = 0; return true; }
+    if (*p == '"') {
+      char s[2];
+      if (!allowToggle || !str(s, sizeof(s)) || s[0] != 't') return false;
+      v = 2;
+      return true;
+    }
+    isBool = false;
+    if (*p < '0' || *p > '9') return false;
+    v = 0;
+    while (p < end && *p >= '0' && *p <= '9') { v = v*10 + (*p++ - '0'); if (v > 65535) return false; }
+    return p >= end || (*p != '.' && *p != 'e' && *p != 'E');
+  }
+};
+
+static bool parseFastSegment(FastJsonScanner &sc, FastStateCmd &cmd)
+{
+  if (!sc.eat('{')) return false;
+  if (sc.eat('}')) return false; // nothing to do, leave to full path
+  do {
+    char key[5];
+    int32_t v;
+    if (!sc.str(key, sizeof(key)) || !sc.eat(':')) return false;
+    bool isOn = !strcmp(key, "on"), isBool;
+    if (!sc.val(v, isBool, isOn)) return false;
+    if (isOn != isBool || v > 255) return false; // other types are treated differently by the full path
+    if      (!strcmp(key, "id"))  cmd.id   = v;
+    else if (!strcmp(key, "fx"))  cmd.fx   = v;
+    else if (!strcmp(key, "sx"))  cmd.sx   = v;
+    else if (!strcmp(key, "ix"))  cmd.ix   = v;
+    else if (!strcmp(key, "pal")) cmd.pal  = v;
+    else if (!strcmp(key, "c1"))  cmd.c1   = v;
+    else if (!strcmp(key, "c2"))  cmd.c2   = v;
+    else if (!strcmp(key, "c3"))  cmd.c3   = v;
+    else if (!strcmp(key, "bri")) cmd.sbri = v;
+    else if (isOn)                cmd.son  = v;
+    else return false;
+  } while (sc.eat(','));
+  return sc.eat('}');
+}
+
+static bool parseFastState(const char *json, size_t len, FastStateCmd &cmd)
+{
+  if (!json || len == 0 || len > FAST_STATE_MAX_LEN) return false;
+  FastJsonScanner sc = {json, json + len};
+  if (!sc.eat('{')) return false;
+  if (sc.eat('}')) return false;
+  do {
+    char key[11];
+    int32_t v;
+    if (!sc.str(key, sizeof(key)) || !sc.eat(':')) return false;
+    if (!strcmp(key, "seg")) {
+      if (cmd.seg) return false;
+      cmd.seg = true;
+      cmd.segArray = sc.eat('[');
+      if (!parseFastSegment(sc, cmd)) return false;
+      if (cmd.segArray && !sc.eat(']')) return false; // only a single segment
+      continue;
+    }
+    bool isOn = !strcmp(key, "on"), isBool;
+    bool wantBool = isOn || !strcmp(key, "v");
+    if (!sc.val(v, isBool, isOn) || isBool != wantBool) return false; // other types are treated differently by the full path
+    if      (isOn)                       cmd.on  = v;
+    else if (!strcmp(key, "bri"))        { if (v > 255) return false; cmd.bri = v; }
+    else if (!strcmp(key, "transition")) cmd.tr  = v;
+    else if (!strcmp(key, "tt"))         cmd.tt  = v;
+    else if (!strcmp(key, "v"))          { if (v > 1) return false; cmd.v = v; }
+    else return false;
+  } while (sc.eat(','));
+  if (!sc.eat('}')) return false;
+  sc.ws();
+  if (sc.p < sc.end && *sc.p) return false; // trailing data
+
+  if (cmd.seg) {
+    if (cmd.segArray && cmd.id < 0) cmd.id = 0; // array element without id applies to segment 0
+    if (cmd.id >= 0 && (cmd.id >= strip.getSegmentsNum() || !strip.getSegment(cmd.id).isActive())) return false; // may append/delete
+  }
+  return true;
+}
+
+// same effect as deserializeSegment() for the keys recognized by the fast path
+static void applyFastSegment(const FastStateCmd &cmd, Segment &seg)
+{
+  bool changed = false;
+  if (cmd.sbri >= 0) {
+    changed |= (seg.opacity != cmd.sbri && cmd.sbri > 0) || (seg.on != (cmd.sbri > 0));
+    if (cmd.sbri > 0) seg.setOpacity(cmd.sbri);
+    seg.setOption(SEG_OPTION_ON, cmd.sbri); // use transition
+  }
+  if (cmd.son >= 0) {
+    bool on = (cmd.son == 2) ? !seg.on : cmd.son;
+    changed |= (on != seg.on);
+    seg.setOption(SEG_OPTION_ON, on); // use transition
+  }
+  if (cmd.fx >= 0) {
+    if (currentPlaylist >= 0) unloadPlaylist();
+    if (cmd.fx != seg.mode) { seg.setMode(cmd.fx, false); changed = true; }
+  }
+  if (cmd.sx >= 0) { changed |= (seg.speed     != cmd.sx); seg.speed     = cmd.sx; }
+  if (cmd.ix >= 0) { changed |= (seg.intensity != cmd.ix); seg.intensity = cmd.ix; }
+  if (cmd.pal >= 0 && (seg.getLightCapabilities() & 1)) { changed |= (seg.palette != cmd.pal); seg.setPalette(cmd.pal); }
+  if (cmd.c1 >= 0) { changed |= (seg.custom1 != cmd.c1); seg.custom1 = cmd.c1; }
+  if (cmd.c2 >= 0) { changed |= (seg.custom2 != cmd.c2); seg.custom2 = cmd.c2; }
+  if (cmd.c3 >= 0) { uint8_t c3 = constrain(cmd.c3, 0, 31); changed |= (seg.custom3 != c3); seg.custom3 = c3; }
+  if (changed) stateChanged = true;
+}
+
+bool deserializeStateFast(const char *json, size_t len, bool &verbose)
+{
+  FastStateCmd cmd;
+  if (!parseFastState(json, len, cmd)) return false;
+  verbose = cmd.v;
+  StateGuard state;
+
+  // top level part of deserializeState()
+  bool onBefore = bri;
+  if (cmd.bri >= 0) bri = cmd.bri;
+  bool on = (cmd.on == 0 || cmd.on == 1) ? cmd.on : (bri > 0);
+  if (!on != !bri) toggleOnOff();
+  if (cmd.on == 2 && (onBefore || !bri)) toggleOnOff();
+  if (bri && !onBefore) { // unfreeze all segments when turning on
+    for (size_t s=0; s < strip.getSegmentsNum(); s++) strip.getSegment(s).freeze = false;
+    if (realtimeMode && !realtimeOverride) realtimeFreezeSegments(true); // keep live segments frozen if live
+  }
+  if (cmd.tr >= 0) {
+    transitionDelay = cmd.tr * 100;
+    if (fadeTransition) strip.setTransition(transitionDelay);
+  }
+  if (cmd.tt >= 0) {
+    jsonTransitionOnce = true;
+    if (fadeTransition) strip.setTransition(cmd.tt * 100);
+  }
+  if (realtimeMode) realtimeFreezeSegments(!realtimeOverride);
+
+  if (cmd.seg) {
+    if (cmd.id >= 0) applyFastSegment(cmd, strip.getSegment(cmd.id));
+    else for (size_t s = 0; s < strip.getSegmentsNum(); s++) { // no id: all selected segments
+      Segment &sg = strip.getSegment(s);
+      if (sg.isSelected() && sg.isActive()) applyFastSegment(cmd, sg);
+    }
+  }
+
+  stateUpdated(CALL_MODE_DIRECT_CHANGE);
+  return true;
+}
+
 void serializeSegment(JsonObject& root, Segment& seg, byte id, bool forPreset, bool segmentBounds)
 {
   root["id"] = id;
@@ -490,6 +819,7 @@ void serializeSegment(JsonObject& root, Segment& seg, byte id, bool forPreset, b
     if (strip.isMatrix) {
       root[F("startY")] = seg.startY;
       root[F("stopY")]  = seg.stopY;
+      if (strip.getCanvasCount() > 1) root["cv"] = seg.canvasIdx;
     }
     #endif
   }
@@ -503,6 +833,16 @@ void serializeSegment(JsonObject& root, Segment& seg, byte id, bool forPreset, b
   root["bri"]    = (segbri) ? segbri : 255;
   root["cct"]    = seg.cct;
   root[F("set")] = seg.set;
+  root["bm"]     = seg.blendMode;
+  root["lo"]     = seg.layerOpacity;
+  root["z"]      = seg.zIndex;
+  root["ip"]     = seg.interpolate;
+  #ifndef WLED_DISABLE_2D
+  if (strip.isMatrix) {
+    root["rs"]  = seg.renderScale;
+    root["rsm"] = seg.renderSmooth;
+  }
+  #endif
 
   if (seg.name != nullptr) root["n"] = reinterpret_cast<const char *>(seg.name); //not good practice, but decreases required JSON buffer
   else if (forPreset) root["n"] = "";
@@ -549,7 +889,8 @@ void serializeSegment(JsonObject& root, Segment& seg, byte id, bool forPreset, b
   root["m12"] = seg.map1D2D;
 }
 
-void serializeState(JsonObject root, bool forPreset, bool includeBri, bool segmentBounds, bool selectedSegmentsOnly)
+// everything in state except the segment array
+static void serializeStateHeader(JsonObject root, bool forPreset, bool includeBri)
 {
   if (includeBri) {
     root["on"] = (bri > 0);
@@ -562,6 +903,7 @@ void serializeState(JsonObject root, bool forPreset, bool includeBri, bool segme
 
     root["ps"] = (currentPreset > 0) ? currentPreset : -1;
     root[F("pl")] = currentPlaylist;
+    root[F("seed")] = strip.getRandomSeed(); // 0: chosen at boot
 
     usermods.addToJsonState(root);
 
@@ -586,6 +928,11 @@ void serializeState(JsonObject root, bool forPreset, bool includeBri, bool segme
   }
 
   root[F("mainseg")] = strip.getMainSegmentId();
+}
+
+void serializeState(JsonObject root, bool forPreset, bool includeBri, bool segmentBounds, bool selectedSegmentsOnly)
+{
+  serializeStateHeader(root, forPreset, includeBri);
 
   JsonArray seg = root.createNestedArray("seg");
   for (size_t s = 0; s < strip.getMaxSegments(); s++) {
@@ -619,6 +966,11 @@ void serializeInfo(JsonObject root)
   leds[F("count")] = strip.getLengthTotal();
   leds[F("pwr")] = strip.currentMilliamps;
   leds["fps"] = strip.getFps();
+  leds[F("fpsmax")] = strip.getWireFps(); // 0: output does not limit frame rate
+  if (strip.getWireFps() && strip.getWireFps() < strip.getTargetFps()) leds[F("fpsbus")] = strip.getWireBus(); // bus capping target FPS
+  #ifdef WLED_FRAME_CLOCK
+  leds[F("ovr")] = strip.getClockOverruns(); // frame clock ticks without a frame
+  #endif
   leds[F("maxpwr")] = (strip.currentMilliamps)? strip.ablMilliampsMax : 0;
   leds[F("maxseg")] = strip.getMaxSegments();
   //leds[F("actseg")] = strip.getActiveSegmentsNum();
@@ -629,6 +981,13 @@ void serializeInfo(JsonObject root)
     JsonObject matrix = leds.createNestedObject("matrix");
     matrix["w"] = Segment::maxWidth;
     matrix["h"] = Segment::maxHeight;
+    if (strip.getCanvasCount() > 1) {
+      JsonArray cvs = matrix.createNestedArray("cv"); // [w,h] of each canvas, first is w/h above
+      for (const WS2812FX::Canvas &c : strip.canvas) {
+        JsonArray d = cvs.createNestedArray();
+        d.add(c.width); d.add(c.height);
+      }
+    }
   }
   #endif
 
@@ -675,6 +1034,8 @@ void serializeInfo(JsonObject root)
     case REALTIME_MODE_ARTNET:   root["lm"] = F("Art-Net"); break;
     case REALTIME_MODE_TPM2NET:  root["lm"] = F("tpm2.net"); break;
     case REALTIME_MODE_DDP:      root["lm"] = F("DDP"); break;
+    case REALTIME_MODE_FSEQ:     root["lm"] = F("FSEQ"); break;
+    case REALTIME_MODE_DMX:      root["lm"] = F("DMX"); break;
   }
 
   if (realtimeIP[0] == 0)
@@ -693,6 +1054,7 @@ void serializeInfo(JsonObject root)
   root[F("fxcount")] = strip.getModeCount();
   root[F("palcount")] = strip.getPaletteCount();
   root[F("cpalcount")] = strip.customPalettes.size(); //number of custom palettes
+  root[F("cpalmax")] = WLED_MAX_CUSTOM_PALETTES;
 
   JsonArray ledmaps = root.createNestedArray(F("maps"));
   for (size_t i=0; i<WLED_MAX_LEDMAPS; i++) {
@@ -711,6 +1073,9 @@ void serializeInfo(JsonObject root)
   wifi_info[F("rssi")] = qrssi;
   wifi_info[F("signal")] = getSignalQuality(qrssi);
   wifi_info[F("channel")] = WiFi.channel();
+  wifi_info[F("ct")] = wifiConnectTime;   // ms the last connection took
+  wifi_info[F("fast")] = wifiLastFast;    // made by fast connect (cached access point)
+  wifi_info[F("rc")] = wifiReconnects;
 
   JsonObject fs_info = root.createNestedObject("fs");
   fs_info["u"] = fsBytesUsed / 1000;
@@ -718,6 +1083,14 @@ void serializeInfo(JsonObject root)
   fs_info[F("pmt")] = presetsModifiedTime;
 
   root[F("ndc")] = nodeListEnabled ? (int)Nodes.size() : -1;
+  if (clockSyncMode) serializeClockSync(root);
+  #ifdef WLED_ENABLE_FSEQ
+  JsonObject fseq = root.createNestedObject(F("fseq"));
+  serializeFseq(fseq);
+  #endif
+  #ifdef WLED_ENABLE_IDLE_PM
+  serializeIdle(root);
+  #endif
 
   #ifdef ARDUINO_ARCH_ESP32
   #ifdef WLED_DEBUG
@@ -746,11 +1119,69 @@ void serializeInfo(JsonObject root)
   root[F("lwip")] = LWIP_VERSION_MAJOR;
   #endif
 
+  #ifndef WLED_DISABLE_OTA
+  const ota_stats_t &ot = getOTAStats();
+  if (ot.state != OTA_IDLE) { // progress of firmware upload, LEDs keep running meanwhile
+    JsonObject ota = root.createNestedObject(F("ota"));
+    ota[F("state")] = ot.state;
+    ota[F("pct")]   = ot.size ? MIN(100U, (unsigned)(ot.written * 100ULL / ot.size)) : 0;
+    ota[F("rcv")]   = ot.received;
+    ota[F("wr")]    = ot.written;
+    ota[F("kbps")]  = ot.duration ? ot.written / ot.duration : 0; // bytes per ms = kB/s
+    ota[F("maxwr")] = ot.maxWriteMs;
+    if (ot.state != OTA_RUNNING) ota[F("fps")] = ot.duration ? ot.frame * 1000UL / ot.duration : 0;
+  }
+  #endif
+
   root[F("freeheap")] = ESP.getFreeHeap();
+  const heap_stats_t &hs = getHeapStats(); // early warning before allocations start failing, details in /json/heap
+  JsonObject heap = root.createNestedObject(F("heap"));
+  heap[F("blk")]    = hs.maxBlock;
+  heap[F("minblk")] = hs.minMaxBlock;
+  heap[F("frag")]   = hs.frag;
+  heap[F("warn")]   = hs.warn;
   #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM)
   if (psramFound()) root[F("psram")] = ESP.getFreePsram();
   #endif
   root[F("uptime")] = millis()/1000 + rolloverMillis*4294967;
+  root[F("ttfl")] = firstLightMs; // time to first light after boot (ms), 0 if not lit yet
+
+  // main loop timing (us): averages since boot, maxima of the last 10s, slowest subsystems of the last 10s
+  JsonObject lp = root.createNestedObject(F("loop"));
+  uint32_t nLoops = loopStats.loops ? loopStats.loops : 1;
+  lp[F("lps")] = loopStats.lps;
+  lp[F("avg")] = (uint32_t)(loopStats.loopUs / nLoops);
+  lp[F("max")] = loopStats.loopMax;
+  JsonArray lpStrip = lp.createNestedArray(F("strip"));
+  lpStrip.add((uint32_t)(loopStats.stripUs / nLoops)); lpStrip.add(loopStats.stripMax);
+  JsonArray lpUm = lp.createNestedArray("um");
+  lpUm.add((uint32_t)(loopStats.usermodUs / nLoops)); lpUm.add(loopStats.usermodMax);
+  const sched_task_t *top[3] = {nullptr, nullptr, nullptr};
+  for (uint8_t i = 0; i < getSchedTaskCount(); i++) {
+    const sched_task_t *t = getSchedTask(i);
+    for (size_t j = 0; j < 3; j++) {
+      if (top[j] && top[j]->winMaxUs >= t->winMaxUs) continue;
+      for (size_t k = 2; k > j; k--) top[k] = top[k-1];
+      top[j] = t;
+      break;
+    }
+  }
+  JsonArray lpTop = lp.createNestedArray(F("top")); // [name, max us]
+  for (size_t j = 0; j < 3 && top[j] && top[j]->winMaxUs; j++) {
+    JsonArray e = lpTop.createNestedArray();
+    e.add(top[j]->name); e.add(top[j]->winMaxUs);
+  }
+
+  JsonObject jbuf = root.createNestedObject(F("jbuf")); // JSON buffer pool usage and contention
+  jbuf["n"]   = getJSONBufferPoolSize();
+  jbuf[F("use")] = getJSONBuffersInUse();
+  JsonArray jown = jbuf.createNestedArray(F("own")); // owners that had to wait: [id, requests, waits, timeouts, longest wait ms]
+  for (uint8_t i = 0; i < JSON_LOCK_OWNERS; i++) {
+    const json_lock_stats_t *st = getJSONLockStats(i);
+    if (!st || !st->waits) continue;
+    JsonArray o = jown.createNestedArray();
+    o.add(i); o.add(st->requests); o.add(st->waits); o.add(st->timeouts); o.add(st->maxWait);
+  }
 
   char time[32];
   getTimeString(time);
@@ -971,36 +1402,408 @@ void serializeNetworks(JsonObject root)
   }
 }
 
+static void serializeEffectStats(JsonObject obj, const fx_stats_t &st)
+{
+  obj["n"]   = st.count;
+  obj["min"] = st.count ? st.min : 0;
+  obj["avg"] = st.avg();
+  obj["max"] = st.max;
+  JsonArray hist = obj.createNestedArray("h");
+  for (unsigned b = 0; b < FX_STATS_BUCKETS; b++) hist.add(st.hist[b]);
+}
+
+// effect render times in microseconds, per effect and per segment
+void serializePerf(JsonObject root)
+{
+  JsonArray buckets = root.createNestedArray(F("hb")); // histogram bucket upper limits
+  for (unsigned b = 0; b < FX_STATS_BUCKETS-1; b++) buckets.add(strip.getStatsBucketLimit(b));
+
+  JsonArray fx = root.createNestedArray("fx");
+  const fx_stats_t *fxStats = strip.getEffectStats();
+  for (unsigned i = 0; i < FX_STATS_SLOTS; i++) {
+    if (!fxStats[i].count) continue;
+    JsonObject e = fx.createNestedObject();
+    e["id"] = fxStats[i].id;
+    serializeEffectStats(e, fxStats[i]);
+  }
+
+  JsonArray seg = root.createNestedArray("seg");
+  const fx_stats_t *segStats = strip.getSegmentStats();
+  for (unsigned i = 0; i < strip.getSegmentsNum(); i++) {
+    Segment &sg = strip.getSegment(i);
+    if (!sg.isActive() || !segStats[i].count) continue;
+    JsonObject e = seg.createNestedObject();
+    e["id"]  = i;
+    e["fx"]  = segStats[i].id;
+    e["len"] = sg.length();
+    e["fps"] = strip.getSegmentFps(i); // achieved frame rate
+    serializeEffectStats(e, segStats[i]);
+  }
+
+  // output: time spent converting/starting transfers and time spent waiting for previous frame, per frame
+  JsonObject out = root.createNestedObject("out");
+  serializeEffectStats(out.createNestedObject("show"), strip.getOutputStats());
+  serializeEffectStats(out.createNestedObject("wait"), strip.getWaitStats());
+  JsonArray bus = out.createNestedArray("bus");
+  uint32_t now = micros();
+  for (unsigned i = 0; i < busses.getNumBusses(); i++) {
+    Bus *b = busses.getBus(i);
+    if (!b) break;
+    JsonObject e = bus.createNestedObject();
+    uint32_t done = b->getDoneTime();
+    bool busy = b->isInFlight();
+    e["busy"] = busy;
+    e["age"]  = now - b->getSentTime();                      // since last frame was started (us)
+    e["tx"]   = busy ? 0 : done - b->getSentTime();          // duration of last transfer (upper bound unless it was waited for)
+  }
+
+  // usermod loop(): runs, total (ms) and maximum (us) run time
+  JsonArray um = root.createNestedArray("um");
+  for (byte i = 0; i < usermods.getModCount(); i++) {
+    Usermod *mod = usermods.getMod(i);
+    const um_stats_t *st = usermods.getStats(i);
+    JsonObject e = um.createNestedObject();
+    e["id"]   = mod->getId();
+    e["int"]  = mod->getLoopInterval();
+    if (mod->getLoopCore() >= 0) e["core"] = mod->getLoopCore();
+    e["run"]  = st->runs;
+    e["ms"]   = (uint32_t)(st->totalUs / 1000);
+    e["max"]  = st->maxUs;
+  }
+
+  // loop() subsystems (scheduler.cpp): runs, total (ms) and maximum (us) run time, idle tasks postponed, budget overruns
+  JsonArray tasks = root.createNestedArray(F("tasks"));
+  for (uint8_t i = 0; i < getSchedTaskCount(); i++) {
+    const sched_task_t *t = getSchedTask(i);
+    JsonObject e = tasks.createNestedObject();
+    e["n"]    = t->name;
+    e["p"]    = t->prio;
+    e["int"]  = t->interval;
+    e["run"]  = t->runs;
+    e["ms"]   = (uint32_t)(t->totalUs / 1000);
+    e["max"]  = t->maxUs;
+    e["def"]  = t->deferred;
+    e["ovr"]  = t->overruns;
+  }
+
+  // admission control: per request class (realtime, control, UI) admitted, refused (503), in flight and peak,
+  // requests waiting for a JSON buffer (now, peak), WS broadcasts state-only, times dropped to it, times all clients were closed
+  JsonObject adm = root.createNestedObject(F("adm"));
+  JsonArray cls = adm.createNestedArray(F("cls"));
+  for (uint8_t i = 0; i < ADM_CLASSES; i++) {
+    const adm_stats_t *a = getAdmissionStats(i);
+    JsonArray e = cls.createNestedArray();
+    e.add(a->admitted); e.add(a->rejected); e.add(a->inFlight); e.add(a->peak);
+  }
+  JsonArray q = adm.createNestedArray("q");
+  q.add(getJSONBufferQueue()); q.add(getJSONBufferQueue(true));
+  const ws_load_stats_t *wl = getWsLoadStats();
+  JsonArray wsl = adm.createNestedArray("ws");
+  wsl.add(wl->stateOnly); wsl.add(wl->degraded); wsl.add(wl->closes);
+}
+
+// results of on-device effect benchmark (started with /json/bench?start=<ms per effect>)
+// or golden run (/json/bench?golden=<frames per effect>, effects rendered deterministically, "h" is output hash)
+void serializeBench(JsonObject root)
+{
+  root["run"] = strip.isBenchmarking();
+  const uint16_t golden = strip.getGoldenFrames();
+  if (golden) root[F("golden")] = golden;
+  if (strip.isBenchmarking()) root[F("cur")] = strip.getBenchmarkProgress(); // effect being measured
+  root[F("heap")] = ESP.getFreeHeap(); // for reference
+  #if defined(WLED_ENABLE_S3_SIMD) && defined(CONFIG_IDF_TARGET_ESP32S3)
+  root[F("simd")] = true; // vector kernels in use, compare with a build without
+  #endif
+  const bench_result_t *res = strip.getBenchmarkResults();
+  if (!res) return;
+  JsonArray fx = root.createNestedArray("fx");
+  for (unsigned i = 0; i < strip.getModeCount(); i++) {
+    if (!res[i].frames) continue;
+    JsonObject e = fx.createNestedObject();
+    e["id"]   = i;
+    e["us"]   = res[i].us;  // per frame
+    e["fps"]  = res[i].us ? 1000000UL / res[i].us : 0; // sustainable without output
+    e[F("heap")] = res[i].heap;
+    e[F("data")] = res[i].data;
+    if (golden) e["h"] = res[i].hash;
+  }
+}
+
+// realtime input statistics per source (sent every second to WS clients subscribed with {"rts":true})
+void serializeRealtimeStats(JsonObject root)
+{
+  root["lm"] = realtimeMode;
+  root[F("lip")] = realtimeIP[0] ? realtimeIP.toString() : "";
+  root[F("rtp")] = realtimeProfile;
+  const udp_rx_stats_t &rx = getUdpRxStats();
+  JsonObject rxq = root.createNestedObject(F("rxq")); // receive queue of UDP sockets handled in loop
+  rxq[F("poll")] = rx.maxGap;   // longest time between polls in the last second (us), adds to latency
+  rxq[F("max")]  = rx.maxDepth; // most packets handled in one poll in the last second
+  rxq["bl"]      = rx.backlogged;
+  rxq[F("cut")]  = rx.cut;
+  JsonArray src = root.createNestedArray("src");
+  for (byte md = REALTIME_MODE_GENERIC; md <= REALTIME_MODE_LAST; md++) {
+    const realtime_stats_t *st = getRealtimeStats(md);
+    if (!st) continue;
+    JsonObject e = src.createNestedObject();
+    e["lm"]   = md;
+    e["pkt"]  = st->packets;
+    e["frm"]  = st->frames;
+    e[F("drop")] = st->dropped;
+    e["dup"]  = st->duplicates;
+    e["pps"]  = st->pps;
+    e["fps"]  = st->fps;
+    // receive-to-show latency percentiles (us) of the last RT_STATS_SAMPLES frames
+    uint16_t lat[RT_STATS_SAMPLES];
+    unsigned n = st->latCount;
+    for (unsigned i = 0; i < n; i++) {
+      uint16_t v = st->lat[i];
+      unsigned j = i;
+      for (; j > 0 && lat[j-1] > v; j--) lat[j] = lat[j-1];
+      lat[j] = v;
+    }
+    JsonObject l = e.createNestedObject("lat");
+    l["p50"] = n ? lat[(n-1)*50/100] : 0;
+    l["p90"] = n ? lat[(n-1)*90/100] : 0;
+    l["p99"] = n ? lat[(n-1)*99/100] : 0;
+    l["max"] = n ? lat[n-1] : 0;
+  }
+  #ifdef WLED_ENABLE_DMX_INPUT
+  const dmx_input_stats_t &di = getDMXInputStats();
+  JsonObject din = root.createNestedObject(F("dmxin")); // wired DMX receiver
+  din[F("frm")]   = di.frames;
+  din[F("slots")] = di.slots;
+  din[F("int")]   = di.interval;    // break to break (us)
+  din[F("imin")]  = di.minInterval;
+  din[F("imax")]  = di.maxInterval;
+  din[F("err")]   = di.errors;
+  din[F("ovf")]   = di.overflows;
+  din[F("osc")]   = di.otherStart;
+  din[F("age")]   = di.last ? millis() - di.last : 0; // ms since last frame
+  #endif
+  #ifdef WLED_ENABLE_ADALIGHT
+  JsonObject ser = root.createNestedObject("ser"); // Adalight/TPM2 serial receiver
+  ser["rx"]  = getSerialRxBytes();
+  ser["err"] = getSerialRxErrors();
+  #endif
+}
+
+#ifndef WLED_DISABLE_FS_STATS
+static void serializeFSOpStats(JsonObject o, const fs_op_stats_t &st)
+{
+  o["n"]   = st.count;
+  o["us"]  = st.us;
+  o[F("max")] = st.maxUs;
+}
+
+// filesystem I/O of file.cpp since boot/reset and results of the last FS benchmark (/json/fs?bench=<iterations>)
+void serializeFSStats(JsonObject root)
+{
+  static const char opNames[][8] PROGMEM = {"find", "read", "write", "append", "del", "jnl", "compact"};
+  static const char benchNames[][8] PROGMEM = {"seqr", "seqw", "append", "read", "find", "replace", "del"};
+  char name[8];
+
+  root["run"] = isFSBenchmarking();
+  JsonObject ops = root.createNestedObject(F("ops"));
+  const fs_op_stats_t *op = getFSOpStats();
+  for (size_t i = 0; i < FS_OP_COUNT; i++) {
+    if (!op[i].count) continue;
+    strcpy_P(name, opNames[i]);
+    serializeFSOpStats(ops.createNestedObject(name), op[i]);
+  }
+  JsonArray files = root.createNestedArray(F("files"));
+  const fs_file_stats_t *fst = getFSFileStats();
+  for (size_t i = 0; i < FS_STATS_FILES; i++) {
+    if (!fst[i].name[0]) continue;
+    JsonObject e = files.createNestedObject();
+    e[F("name")]  = fst[i].name;
+    e["rd"]  = fst[i].reads;
+    e["wr"]  = fst[i].writes;
+    e["sk"]  = fst[i].seeks;
+    e[F("brd")] = fst[i].bytesRead;
+    e[F("bwr")] = fst[i].bytesWritten;
+    e["n"]   = fst[i].ops;
+    e["us"]  = fst[i].us;
+  }
+  const fs_bench_t *b = getFSBenchmark();
+  if (!b || !b->iterations) return;
+  JsonObject bench = root.createNestedObject(F("bench"));
+  bench["n"] = b->iterations;
+  bench[F("size")] = b->fileSize;
+  for (size_t i = 0; i < FS_BENCH_PHASES; i++) {
+    strcpy_P(name, benchNames[i]);
+    JsonObject ph = bench.createNestedObject(name);
+    serializeFSOpStats(ph, b->phase[i]);
+    if (b->bytes[i]) ph["b"] = b->bytes[i];
+  }
+}
+#endif
+
+// heap monitor: minima since boot/reset, allocations per subsystem and history of the largest free block (oldest first)
+void serializeHeapStats(JsonObject root)
+{
+  const heap_stats_t &hs = getHeapStats();
+  root[F("free")]   = hs.freeHeap;
+  root[F("min")]    = hs.minFreeHeap;
+  root[F("blk")]    = hs.maxBlock;
+  root[F("minblk")] = hs.minMaxBlock;
+  root[F("frag")]   = hs.frag;
+  root[F("warn")]   = hs.warn;
+  root[F("thr")]    = WLED_HEAP_WARN_BLOCK;
+  root[F("segdata")] = MAX_SEGMENT_DATA;
+  if (Segment::getMaxSegmentDataPSRAM()) { // cold effect data tier [used, max]
+    JsonArray sp = root.createNestedArray(F("segpsram"));
+    sp.add(Segment::getUsedSegmentDataPSRAM());
+    sp.add(Segment::getMaxSegmentDataPSRAM());
+  }
+  if (hs.lastFail) root[F("fail")] = (millis() - hs.lastFail) / 1000; // seconds since last failed allocation
+  JsonObject tags = root.createNestedObject(F("tags")); // [live bytes, peak, allocations, failures]
+  char name[8];
+  for (uint8_t i = 0; i < HEAP_TAG_COUNT; i++) {
+    const heap_tag_stats_t *t = getHeapTagStats(i);
+    if (!t->allocs && !t->fails && !t->live) continue;
+    strncpy_P(name, getHeapTagName(i), sizeof(name)-1); name[sizeof(name)-1] = 0;
+    JsonArray e = tags.createNestedArray(name);
+    e.add(t->live); e.add(t->peak); e.add(t->allocs); e.add(t->fails);
+  }
+  JsonArray hist = root.createNestedArray(F("hist")); // lowest largest block per minute (bytes)
+  for (uint8_t i = 0; i < hs.histCount; i++) hist.add((uint32_t)hs.history[(hs.histPos + i) % HEAP_HISTORY_LEN] << 4);
+}
+
+// busses in use as planned by BusManager::memUsage() (LED buffer setting may have changed since they were created)
+static uint8_t planBussesInUse(bus_mem_t *plan)
+{
+  uint8_t n = busses.getNumBusses();
+  for (uint8_t i = 0; i < n; i++) {
+    Bus *b = busses.getBus(i);
+    uint8_t pins[5] = {255, 255, 255, 255, 255};
+    b->getPins(pins);
+    BusConfig bc(b->getType() | (b->isOffRefreshRequired() << 7), pins, b->getStart(), b->getLength(), b->getColorOrder(), b->isReversed(),
+                 b->skippedLeds(), b->getAutoWhiteMode(), b->getFrequency(), useGlobalLedBuffer, b->getMaxCurrent());
+    BusManager::memUsage(bc, i, &plan[i]);
+  }
+  return n;
+}
+
+// LED memory planner (/json/mem): heap the busses of a configuration allocate, per bus [driver, bus buffer, power/dithering]
+// (GET: busses in use, POST {"ins":[...],"ld":true} in cfg.json format: evaluated, not applied), busses are admitted against
+// MAX_LED_MEMORY in order as loopBusInit() does; "head" is the heap left once they replace the busses in use, keeping
+// a JSON buffer and MIN_HEAP_SIZE free (effect data arena is allocated at boot and does not change with the configuration)
+void serializeMemPlan(JsonObject root, const bus_mem_t *plan, uint8_t n)
+{
+  bus_mem_t inUse[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES];
+  uint8_t nInUse = planBussesInUse(inUse);
+  if (!plan) { plan = inUse; n = nInUse; }
+  uint32_t cur = 0;
+  for (uint8_t i = 0; i < nInUse; i++) cur += inUse[i].driver + inUse[i].buffer + inUse[i].aux;
+
+  uint32_t tot = 0;
+  uint8_t dropped = 0;
+  JsonArray bus = root.createNestedArray(F("bus"));
+  for (uint8_t i = 0; i < n; i++) {
+    JsonArray b = bus.createNestedArray();
+    b.add(plan[i].driver); b.add(plan[i].buffer); b.add(plan[i].aux);
+    uint32_t m = plan[i].driver + plan[i].buffer + plan[i].aux;
+    if (tot + m <= MAX_LED_MEMORY) tot += m;
+    else dropped++;
+  }
+  int32_t head = (int32_t)(ESP.getFreeHeap() + cur) - (int32_t)(tot + JSON_BUFFER_SIZE + MIN_HEAP_SIZE);
+  root[F("tot")]  = tot;
+  root[F("max")]  = MAX_LED_MEMORY;
+  root[F("drop")] = dropped; // busses that would not be created
+  root[F("cur")]  = cur;
+  root[F("seg")]  = MAX_SEGMENT_DATA;
+  root[F("json")] = JSON_BUFFER_SIZE;
+  root[F("head")] = head;
+  root["ok"] = !dropped && head >= 0;
+}
+
 void serializeNodes(JsonObject root)
 {
   JsonArray nodes = root.createNestedArray("nodes");
 
-  for (NodesMap::iterator it = Nodes.begin(); it != Nodes.end(); ++it)
+  for (size_t i = 0; i < Nodes.capacity(); i++)
   {
-    if (it->second.ip[0] != 0)
+    NodeStruct *it = Nodes.at(i);
+    if (it && it->ip[0] != 0)
     {
       JsonObject node = nodes.createNestedObject();
-      node[F("name")] = it->second.nodeName;
-      node["type"]    = it->second.nodeType;
-      node["ip"]      = it->second.ip.toString();
-      node[F("age")]  = it->second.age;
-      node[F("vid")]  = it->second.build;
+      node[F("name")] = it->nodeName;
+      node["type"]    = it->nodeType;
+      node["ip"]      = it->ip.toString();
+      node[F("age")]  = it->age;
+      node[F("vid")]  = it->build;
     }
   }
 }
 
+// writes one node as JSON object into buf (at least 160 bytes), returns length
+static size_t printNode(char *buf, const NodeStruct &node, bool first)
+{
+  char name[65]; // escaped name (max. 32 characters each escaped)
+  size_t n = 0;
+  for (const char *c = node.nodeName; *c && n < sizeof(name)-2; c++) {
+    if (*c == '"' || *c == '\\') name[n++] = '\\';
+    name[n++] = ((uint8_t)*c < 0x20) ? ' ' : *c;
+  }
+  name[n] = 0;
+  return snprintf_P(buf, 160, PSTR("%s{\"name\":\"%s\",\"type\":%u,\"ip\":\"%u.%u.%u.%u\",\"age\":%u,\"vid\":%u}"),
+                    first ? "" : ",", name, node.nodeType, node.ip[0], node.ip[1], node.ip[2], node.ip[3], node.age, (unsigned)node.build);
+}
+
+// streams the node list slot by slot without JSON buffer (lock) or building the whole response in RAM
+static void serveNodes(AsyncWebServerRequest* request)
+{
+  struct NodesChunkState {
+    size_t slot  = 0;  // next slot of node table to print
+    uint8_t part = 0;  // 0 header, 1 nodes, 2 footer, 3 done
+    bool first   = true;
+    char text[160];    // pending text not yet sent (response buffer may be smaller than one node)
+    size_t len = 0, pos = 0;
+  };
+  std::shared_ptr<NodesChunkState> st = std::make_shared<NodesChunkState>();
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse(F("application/json"),
+    [st](uint8_t *buf, size_t maxLen, size_t index) -> size_t {
+      size_t out = 0;
+      while (out < maxLen) {
+        if (st->pos < st->len) {
+          size_t n = min(st->len - st->pos, maxLen - out);
+          memcpy(buf + out, st->text + st->pos, n);
+          st->pos += n;
+          out += n;
+          continue;
+        }
+        st->pos = st->len = 0;
+        if (st->part == 0) {
+          strcpy_P(st->text, PSTR("{\"nodes\":[")); st->len = strlen(st->text);
+          st->part = 1;
+        } else if (st->part == 1) {
+          if (st->slot >= Nodes.capacity()) { st->part = 2; continue; }
+          NodeStruct *node = Nodes.at(st->slot++);
+          if (!node || node->ip[0] == 0) continue;
+          NodeStruct copy = *node; // node may be updated from main loop meanwhile
+          st->len = printNode(st->text, copy, st->first);
+          st->first = false;
+        } else if (st->part == 2) {
+          strcpy_P(st->text, PSTR("]}")); st->len = strlen(st->text);
+          st->part = 3;
+        } else break;
+      }
+      return out;
+    });
+  request->send(response);
+}
+
 // deserializes mode data string into JsonArray
 void serializeModeData(JsonArray fxdata)
 {
   char lineBuffer[256];
   for (size_t i = 0; i < strip.getModeCount(); i++) {
-    strncpy_P(lineBuffer, strip.getModeData(i), sizeof(lineBuffer)/sizeof(char)-1);
-    lineBuffer[sizeof(lineBuffer)/sizeof(char)-1] = '\0'; // terminate string
-    if (lineBuffer[0] != 0) {
-      char* dataPtr = strchr(lineBuffer,'@');
-      if (dataPtr) fxdata.add(dataPtr+1);
-      else         fxdata.add("");
-    }
+    const mode_data_idx_t *idx = getModeDataIndex(i);
+    if (!idx || !idx->len) continue;
+    copyModeData(i, idx->sliders ? idx->sliders : idx->len, idx->len, lineBuffer, sizeof(lineBuffer));
+    fxdata.add(lineBuffer);
   }
 }
 
@@ -1010,13 +1813,10 @@ void serializeModeNames(JsonArray arr)
 {
   char lineBuffer[256];
   for (size_t i = 0; i < strip.getModeCount(); i++) {
-    strncpy_P(lineBuffer, strip.getModeData(i), sizeof(lineBuffer)/sizeof(char)-1);
-    lineBuffer[sizeof(lineBuffer)/sizeof(char)-1] = '\0'; // terminate string
-    if (lineBuffer[0] != 0) {
-      char* dataPtr = strchr(lineBuffer,'@');
-      if (dataPtr) *dataPtr = 0; // terminate mode data after name
-      arr.add(lineBuffer);
-    }
+    const mode_data_idx_t *idx = getModeDataIndex(i);
+    if (!idx || !idx->len) continue;
+    copyModeData(i, 0, idx->sliders ? idx->sliders-1 : idx->len, lineBuffer, sizeof(lineBuffer));
+    arr.add(lineBuffer);
   }
 }
 
@@ -1044,6 +1844,239 @@ class LockedJsonResponse: public AsyncJsonResponse {
   virtual ~LockedJsonResponse() { if (_holding_lock) releaseJSONBufferLock(); };
 };
 
+/*
+ * Streamed (chunked) JSON responses for state, info, effects and fxdata.
+ * Output is produced piece by piece (state header, each segment, each effect...) while the
+ * response is being sent, each piece serialized from a small private document.
+ * Neither the global JSON buffer (lock) nor memory for the whole response is needed.
+ */
+#ifdef ESP8266
+#define JSON_STREAM_DOC_SIZE  1536 // state header or one segment
+#define JSON_STREAM_INFO_SIZE 3072
+#else
+#define JSON_STREAM_DOC_SIZE  2048
+#define JSON_STREAM_INFO_SIZE 4096
+#endif
+
+enum JsonStreamSection : uint8_t {
+  JS_STATE_KEY, JS_STATE_HEAD, JS_STATE_SEGS, JS_STATE_END, JS_INFO_KEY, JS_INFO, JS_EFFECTS_KEY,
+  JS_ARRAY_OPEN, JS_MODE_NAMES, JS_MODE_DATA, JS_ARRAY_CLOSE, JS_PALETTES_KEY, JS_PALETTES, JS_OBJECT_CLOSE, JS_END
+};
+
+struct JsonStream {
+  uint8_t sections[14];
+  uint8_t section = 0;    // index into sections
+  uint16_t item   = 0;    // segment or mode being iterated
+  bool first      = true; // no comma before first array element
+  const char *text = nullptr; // pending output
+  bool flash      = false;    // pending output is in PROGMEM
+  char *owned     = nullptr;  // pending output was allocated for this piece
+  size_t len = 0, pos = 0;
+  char line[2*256+4];     // escaped effect name or data
+
+  ~JsonStream() { free(owned); }
+
+  void setText(const char *t, size_t l, bool f = false) { text = t; len = l; pos = 0; flash = f; }
+  void setText_P(const char *t) { setText(t, strlen_P(t), true); }
+  // takes serialized document, optionally replacing its closing brace with suffix
+  bool setDoc(JsonDocument &d, const char *suffix = nullptr) {
+    size_t l = measureJson(d);
+    size_t sl = suffix ? strlen_P(suffix) : 0;
+    free(owned);
+    owned = (char*)malloc(l + sl + 2); // comma, document, terminating 0
+    if (!owned) return false;
+    size_t o = 0;
+    if (!first) owned[o++] = ',';
+    o += serializeJson(d, owned + o, l + 1);
+    if (suffix && o && owned[o-1] == '}') { strcpy_P(owned + o - 1, suffix); o += sl - 1; }
+    setText(owned, o);
+    first = false;
+    return true;
+  }
+  // escaped mode name (names) or mode data (!names) of mode i into line buffer, returns false for empty slots
+  bool setMode(uint16_t i, bool names) {
+    char lineBuffer[256];
+    const mode_data_idx_t *idx = getModeDataIndex(i);
+    if (!idx || !idx->len) return false;
+    const size_t nameEnd = idx->sliders ? idx->sliders-1 : idx->len;
+    if (names) copyModeData(i, 0, nameEnd, lineBuffer, sizeof(lineBuffer));             // name only
+    else       copyModeData(i, idx->sliders ? idx->sliders : idx->len, idx->len, lineBuffer, sizeof(lineBuffer)); // data only
+    const char *src = lineBuffer;
+    size_t o = 0;
+    if (!first) line[o++] = ',';
+    line[o++] = '"';
+    for (; *src; src++) {
+      if (*src == '"' || *src == '\\') line[o++] = '\\';
+      line[o++] = *src;
+    }
+    line[o++] = '"';
+    setText(line, o);
+    first = false;
+    return true;
+  }
+};
+
+// prepares next piece of output, returns false when response is complete
+static bool nextJsonPiece(JsonStream &st)
+{
+  for (;;) {
+    switch (st.sections[st.section]) {
+      case JS_STATE_KEY:    st.setText_P(PSTR("{\"state\":")); st.section++; return true;
+      case JS_STATE_HEAD: {
+        DynamicJsonDocument d(JSON_STREAM_DOC_SIZE);
+        serializeStateHeader(d.to<JsonObject>(), false, true);
+        if (d.overflowed()) DEBUG_PRINTLN(F("JSON stream: state truncated."));
+        st.section++;
+        st.item = 0;
+        if (!st.setDoc(d, PSTR(",\"seg\":["))) return false;
+        st.first = true;
+        return true;
+      }
+      case JS_STATE_SEGS:
+        while (st.item < strip.getSegmentsNum()) { // segments may be added or removed meanwhile
+          uint16_t s = st.item++;
+          Segment &sg = strip.getSegment(s);
+          if (!sg.isActive()) continue;
+          DynamicJsonDocument d(JSON_STREAM_DOC_SIZE);
+          JsonObject seg0 = d.to<JsonObject>();
+          serializeSegment(seg0, sg, s, false, true);
+          return st.setDoc(d);
+        }
+        st.section++;
+        break;
+      case JS_STATE_END:    st.setText_P(PSTR("]}")); st.section++; return true;
+      case JS_INFO_KEY:     st.setText_P(PSTR(",\"info\":")); st.section++; return true;
+      case JS_INFO: {
+        size_t size = JSON_STREAM_INFO_SIZE;
+        DynamicJsonDocument d(size);
+        serializeInfo(d.to<JsonObject>());
+        while (d.overflowed() && size < JSON_BUFFER_SIZE) { // usermods add to info: retry with a larger document
+          size = MIN(2*size, (size_t)JSON_BUFFER_SIZE);
+          DynamicJsonDocument b(size);
+          if (!b.capacity()) break; // out of memory
+          serializeInfo(b.to<JsonObject>());
+          d = std::move(b);
+        }
+        st.section++;
+        st.first = true;
+        if (d.overflowed()) { // tell the client that info is incomplete
+          DEBUG_PRINTLN(F("JSON stream: info truncated."));
+          return st.setDoc(d, PSTR(",\"error\":9}")); // ERR_JSON
+        }
+        return st.setDoc(d);
+      }
+      case JS_EFFECTS_KEY:  st.setText_P(PSTR(",\"effects\":")); st.section++; return true;
+      case JS_ARRAY_OPEN:   st.setText_P(PSTR("[")); st.section++; st.item = 0; st.first = true; return true;
+      case JS_MODE_NAMES:
+      case JS_MODE_DATA:
+        while (st.item < strip.getModeCount()) {
+          if (st.setMode(st.item++, st.sections[st.section] == JS_MODE_NAMES)) return true;
+        }
+        st.section++;
+        break;
+      case JS_ARRAY_CLOSE:  st.setText_P(PSTR("]")); st.section++; return true;
+      case JS_PALETTES_KEY: st.setText_P(PSTR(",\"palettes\":")); st.section++; return true;
+      case JS_PALETTES:     st.setText_P(JSON_palette_names); st.section++; return true;
+      case JS_OBJECT_CLOSE: st.setText_P(PSTR("}")); st.section++; return true;
+      default:              return false;
+    }
+  }
+}
+
+// content tags for ETags of generated static JSON (effects and palettes only change with firmware, usermods or uploaded palettes)
+static uint32_t modeDataTag()
+{
+  return getModeDataHash(); // computed with the mode data index, rebuilt when usermods add effects
+}
+
+static uint32_t paletteTag()
+{
+  const uint8_t count = strip.getPaletteCount();
+  uint32_t h = fnv1a(&count, 1);
+  for (const CRGBPalette16 &pal : strip.customPalettes) h = fnv1a(pal.entries, sizeof(pal.entries), h);
+  return h ? h : 1;
+}
+
+static void serveJsonStream(AsyncWebServerRequest* request, byte subJson, uint32_t contentTag = 0)
+{
+  std::shared_ptr<JsonStream> st = std::make_shared<JsonStream>();
+  static const uint8_t seqState[]  PROGMEM = { JS_STATE_HEAD, JS_STATE_SEGS, JS_STATE_END, JS_END };
+  static const uint8_t seqInfo[]   PROGMEM = { JS_INFO, JS_END };
+  static const uint8_t seqEff[]    PROGMEM = { JS_ARRAY_OPEN, JS_MODE_NAMES, JS_ARRAY_CLOSE, JS_END };
+  static const uint8_t seqFxData[] PROGMEM = { JS_ARRAY_OPEN, JS_MODE_DATA, JS_ARRAY_CLOSE, JS_END };
+  static const uint8_t seqSI[]     PROGMEM = { JS_STATE_KEY, JS_STATE_HEAD, JS_STATE_SEGS, JS_STATE_END, JS_INFO_KEY, JS_INFO, JS_OBJECT_CLOSE, JS_END };
+  static const uint8_t seqAll[]    PROGMEM = { JS_STATE_KEY, JS_STATE_HEAD, JS_STATE_SEGS, JS_STATE_END, JS_INFO_KEY, JS_INFO,
+                                               JS_EFFECTS_KEY, JS_ARRAY_OPEN, JS_MODE_NAMES, JS_ARRAY_CLOSE, JS_PALETTES_KEY, JS_PALETTES, JS_OBJECT_CLOSE, JS_END };
+  const uint8_t *seq;
+  size_t n;
+  switch (subJson) {
+    case JSON_PATH_STATE:      seq = seqState;  n = sizeof(seqState);  break;
+    case JSON_PATH_INFO:       seq = seqInfo;   n = sizeof(seqInfo);   break;
+    case JSON_PATH_EFFECTS:    seq = seqEff;    n = sizeof(seqEff);    break;
+    case JSON_PATH_FXDATA:     seq = seqFxData; n = sizeof(seqFxData); break;
+    case JSON_PATH_STATE_INFO: seq = seqSI;     n = sizeof(seqSI);     break;
+    default:                   seq = seqAll;    n = sizeof(seqAll);    break;
+  }
+  memcpy_P(st->sections, seq, n);
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse(F("application/json"),
+    [st](uint8_t *buf, size_t maxLen, size_t index) -> size_t {
+      size_t out = 0;
+      while (out < maxLen) {
+        if (st->pos < st->len) {
+          size_t n = min(st->len - st->pos, maxLen - out);
+          if (st->flash) memcpy_P(buf + out, st->text + st->pos, n);
+          else           memcpy(buf + out, st->text + st->pos, n);
+          st->pos += n;
+          out += n;
+          continue;
+        }
+        free(st->owned); st->owned = nullptr;
+        st->len = st->pos = 0;
+        if (!nextJsonPiece(*st)) break;
+      }
+      return out;
+    });
+  if (contentTag) setStaticContentCacheHeaders(response, contentTag);
+  request->send(response);
+}
+
+// preset list in pages (/json/presets?from=<id>, metadata only) and single presets (/json/presets?id=<id>)
+// so clients don't need to download all of presets.json, both revalidated by ETag (304 until presets change)
+static void servePresets(AsyncWebServerRequest* request)
+{
+  uint32_t contentTag = getPresetsTag();
+  if (handleIfNoneMatchCacheHeader(request, contentTag)) return;
+  int id = request->hasParam(F("id")) ? request->getParam(F("id"))->value().toInt() : -1;
+  if (id < 0) {
+    #ifdef WLED_ENABLE_PRESETS_BIN
+    exportPresets(); // the list is read from presets.json
+    #endif
+    flushFileJournal(); // both need a JSON buffer, before we lock it
+  }
+  if (!requestJSONBufferLock(JSON_LOCK_PRESET_API, 0, WLED_ADM_WAIT_UI)) {
+    request->send(503, "application/json", F("{\"error\":3}"));
+    return;
+  }
+  LockedJsonResponse *response = new LockedJsonResponse(&doc, false); // releases the lock when destroyed
+  if (id >= 0) {
+    if (id > 250 || !readPreset(id, &doc)) { // preset is read into the response root
+      delete response;
+      request->send(404, "application/json", F("{\"error\":12}"));
+      return;
+    }
+  } else {
+    JsonObject root = response->getRoot();
+    int from = request->hasParam(F("from")) ? request->getParam(F("from"))->value().toInt() : 1;
+    root[F("pmt")] = presetsModifiedTime;
+    JsonArray list = root.createNestedArray("p");
+    root[F("next")] = serializePresetList(list, constrain(from, 1, 250));
+  }
+  response->setLength();
+  setStaticContentCacheHeaders(response, contentTag);
+  request->send(response);
+}
+
 void serveJson(AsyncWebServerRequest* request)
 {
   byte subJson = 0;
@@ -1051,19 +2084,42 @@ void serveJson(AsyncWebServerRequest* request)
   if      (url.indexOf("state") > 0) subJson = JSON_PATH_STATE;
   else if (url.indexOf("info")  > 0) subJson = JSON_PATH_INFO;
   else if (url.indexOf("si")    > 0) subJson = JSON_PATH_STATE_INFO;
-  else if (url.indexOf("nodes") > 0) subJson = JSON_PATH_NODES;
+  else if (url.indexOf("nodes") > 0) {
+    serveNodes(request);
+    return;
+  }
+  else if (url.indexOf("trace") > 0) {
+    serveTrace(request);
+    return;
+  }
+  else if (url.indexOf("presets") > 0) {
+    servePresets(request);
+    return;
+  }
   else if (url.indexOf("eff")   > 0) subJson = JSON_PATH_EFFECTS;
   else if (url.indexOf("palx")  > 0) subJson = JSON_PATH_PALETTES;
   else if (url.indexOf("fxda")  > 0) subJson = JSON_PATH_FXDATA;
   else if (url.indexOf("net")   > 0) subJson = JSON_PATH_NETWORKS;
+  else if (url.indexOf("perf")  > 0) subJson = JSON_PATH_PERF;
+  else if (url.indexOf("bench") > 0) subJson = JSON_PATH_BENCH;
+  else if (url.indexOf("rt")    > 0) subJson = JSON_PATH_RTSTATS;
+  else if (url.indexOf("heap")  > 0) subJson = JSON_PATH_HEAP;
+  else if (url.indexOf("mem")   > 0) subJson = JSON_PATH_MEM;
+  #ifndef WLED_DISABLE_FS_STATS
+  else if (url.indexOf("fs")    > 0) subJson = JSON_PATH_FSSTATS;
+  #endif
   #ifdef WLED_ENABLE_JSONLIVE
   else if (url.indexOf("live")  > 0) {
-    serveLiveLeds(request);
+    if (request->hasArg(F("bin")) || request->hasArg(F("b64"))) serveLiveLedsBinary(request);
+    else serveLiveLeds(request);
     return;
   }
   #endif
   else if (url.indexOf("pal") > 0) {
-    request->send_P(200, F("application/json"), JSON_palette_names);
+    if (handleIfNoneMatchCacheHeader(request, 1)) return;
+    AsyncWebServerResponse *response = request->beginResponse_P(200, F("application/json"), (const uint8_t*)JSON_palette_names, strlen_P(JSON_palette_names));
+    setStaticContentCacheHeaders(response, 1); // names only change with firmware
+    request->send(response);
     return;
   }
   else if (url.indexOf("cfg") > 0 && handleFileRead(request, F("/cfg.json"))) {
@@ -1074,7 +2130,20 @@ void serveJson(AsyncWebServerRequest* request)
     return;
   }
 
-  if (!requestJSONBufferLock(17)) {
+  // static content is revalidated by ETag (browser sends If-None-Match), 304 if unchanged
+  uint32_t contentTag = 0;
+  if (subJson == JSON_PATH_EFFECTS || subJson == JSON_PATH_FXDATA) contentTag = modeDataTag();
+  else if (subJson == JSON_PATH_PALETTES) contentTag = paletteTag();
+  if (contentTag && handleIfNoneMatchCacheHeader(request, contentTag)) return;
+
+  // read-only paths are streamed, without global JSON buffer
+  switch (subJson) {
+    case JSON_PATH_STATE: case JSON_PATH_INFO: case JSON_PATH_STATE_INFO: case JSON_PATH_EFFECTS: case JSON_PATH_FXDATA: case 0:
+      serveJsonStream(request, subJson, contentTag);
+      return;
+  }
+
+  if (!requestJSONBufferLock(JSON_LOCK_SERVEJSON, 0, WLED_ADM_WAIT_UI)) { // UI requests, control requests are streamed
     request->send(503, "application/json", F("{\"error\":3}"));
     return;
   }
@@ -1100,6 +2169,38 @@ void serveJson(AsyncWebServerRequest* request)
       serializeModeData(lDoc); break;
     case JSON_PATH_NETWORKS:
       serializeNetworks(lDoc); break;
+    case JSON_PATH_PERF:
+      serializePerf(lDoc);
+      if (request->hasParam(F("reset"))) { strip.resetEffectStats(); resetSchedStats(); usermods.resetStats(); }
+      break;
+    case JSON_PATH_BENCH:
+      if (request->hasParam(F("start"))) { // ms per effect
+        int ms = request->getParam(F("start"))->value().toInt();
+        strip.startBenchmark(ms > 0 ? constrain(ms, 50, 5000) : 500);
+      } else if (request->hasParam(F("golden"))) { // frames per effect
+        int frames = request->getParam(F("golden"))->value().toInt();
+        strip.startGoldenRun(frames > 0 ? constrain(frames, 1, 2000) : 100);
+      }
+      serializeBench(lDoc);
+      break;
+    case JSON_PATH_RTSTATS:
+      serializeRealtimeStats(lDoc);
+      if (request->hasParam(F("reset"))) resetRealtimeStats();
+      break;
+    case JSON_PATH_HEAP:
+      serializeHeapStats(lDoc);
+      if (request->hasParam(F("reset"))) resetHeapStats();
+      break;
+    case JSON_PATH_MEM:
+      serializeMemPlan(lDoc, nullptr, 0);
+      break;
+    #ifndef WLED_DISABLE_FS_STATS
+    case JSON_PATH_FSSTATS:
+      if (request->hasParam(F("reset"))) resetFSStats();
+      if (request->hasParam(F("bench"))) requestFSBenchmark(request->getParam(F("bench"))->value().toInt()); // iterations per pattern
+      serializeFSStats(lDoc);
+      break;
+    #endif
     default: //all
       JsonObject state = lDoc.createNestedObject("state");
       serializeState(state);
@@ -1121,10 +2222,47 @@ void serveJson(AsyncWebServerRequest* request)
   #endif
   response->setLength();
   DEBUG_PRINT(F("JSON content length: ")); DEBUG_PRINTLN(len);
+  if (contentTag) setStaticContentCacheHeaders(response, contentTag);
 
   request->send(response);
 }
 
+/*
+ * POST /json/leds?seg=<id>&s=<start>&t=<stride>&f=<bytes per pixel> with raw pixel data as body (formats as "ib")
+ * pixels are decoded as the body arrives, nothing is buffered
+ */
+void handleLedsUpload(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+{
+  if (index == 0) {
+    uint8_t id = request->hasArg(F("seg")) ? request->arg(F("seg")).toInt() : strip.getMainSegmentId();
+    if (id >= strip.getSegmentsNum() || !strip.getSegment(id).isActive()) return;
+    PixelDataWriter *w = (PixelDataWriter*) malloc(sizeof(PixelDataWriter)); // freed with request
+    if (!w) return;
+    Segment &seg = strip.getSegment(id);
+    w->oldMap1D2D = beginPixelData(seg);
+    w->init(seg, request->hasArg(F("s")) ? request->arg(F("s")).toInt() : 0,
+                 request->hasArg(F("t")) ? request->arg(F("t")).toInt() : 1,
+                 request->hasArg(F("f")) ? request->arg(F("f")).toInt() : 3);
+    request->_tempObject = w;
+  }
+  PixelDataWriter *w = (PixelDataWriter*) request->_tempObject;
+  if (!w) return;
+  w->write(data, len);
+  if (index + len >= total) {
+    w->flush();
+    endPixelData(*w->seg, w->oldMap1D2D);
+    w->seg = nullptr; // done
+  }
+}
+
+void serveLedsUpload(AsyncWebServerRequest *request)
+{
+  PixelDataWriter *w = (PixelDataWriter*) request->_tempObject;
+  if (!w) { request->send(400, "application/json", F("{\"error\":9}")); return; } // no data or invalid segment
+  if (w->seg) { w->flush(); endPixelData(*w->seg, w->oldMap1D2D); w->seg = nullptr; } // body shorter than announced
+  request->send(200, "application/json", F("{\"success\":true}"));
+}
+
 #ifdef WLED_ENABLE_JSONLIVE
 #define MAX_LIVE_LEDS 180
 
@@ -1155,7 +2293,10 @@ bool serveLiveLeds(AsyncWebServerRequest* request, uint32_t wsClient)
     r = scale8(qadd8(w, r), strip.getBrightness()); //R, add white channel to RGB channels as a simple RGBW -> RGB map
     g = scale8(qadd8(w, g), strip.getBrightness()); //G
     b = scale8(qadd8(w, b), strip.getBrightness()); //B
-    olen += sprintf(obuf + olen, "\"%06X\",", RGBW32(r,g,b,0));
+    static const char hex[] = "0123456789ABCDEF";
+    obuf[olen++] = '"';
+    for (uint8_t v : {r, g, b}) { obuf[olen++] = hex[v >> 4]; obuf[olen++] = hex[v & 0xF]; }
+    obuf[olen++] = '"'; obuf[olen++] = ',';
   }
   olen -= 1;
   oappend((const char*)F("],\"n\":"));
@@ -1171,4 +2312,100 @@ bool serveLiveLeds(AsyncWebServerRequest* request, uint32_t wsClient)
   #endif
   return true;
 }
+
+/*
+ * /json/live?bin (application/octet-stream) or /json/live?b64 (same bytes base64 encoded, text/plain)
+ * full resolution snapshot, generated while being sent:
+ *   'L', 4, 16 bit width, 16 bit height (big endian), then RGB per pixel (row by row, white added to RGB, brightness applied)
+ * optional area: seg=<id> (segment bounds) or x, y, w, h (rectangle, y and h only for 2D) on canvas cv=<n>
+ */
+struct LiveStream {
+  uint16_t x0, y0, w, h;
+  uint16_t stride; // physical row length
+  uint16_t base = 0; // first logical pixel of canvas
+  uint32_t px = 0; // next pixel
+  uint8_t hdr[6];
+  bool b64;
+};
+
+static void liveStreamPixel(const LiveStream &ls, uint32_t n, uint8_t *rgb)
+{
+  uint32_t i = ls.base + (ls.y0 + n / ls.w) * ls.stride + ls.x0 + n % ls.w;
+  uint32_t c = strip.getPixelColor(i);
+  uint8_t w = W(c);
+  rgb[0] = scale8(qadd8(w, R(c)), strip.getBrightness());
+  rgb[1] = scale8(qadd8(w, G(c)), strip.getBrightness());
+  rgb[2] = scale8(qadd8(w, B(c)), strip.getBrightness());
+}
+
+static void base64Triplet(const uint8_t *in, uint8_t *out)
+{
+  static const char b64[] PROGMEM = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  out[0] = pgm_read_byte(b64 + (in[0] >> 2));
+  out[1] = pgm_read_byte(b64 + (((in[0] & 0x03) << 4) | (in[1] >> 4)));
+  out[2] = pgm_read_byte(b64 + (((in[1] & 0x0F) << 2) | (in[2] >> 6)));
+  out[3] = pgm_read_byte(b64 + (in[2] & 0x3F));
+}
+
+void serveLiveLedsBinary(AsyncWebServerRequest* request)
+{
+  std::shared_ptr<LiveStream> ls = std::make_shared<LiveStream>();
+  uint16_t width = strip.getLengthTotal(), height = 1;
+  uint8_t  cv = request->hasArg(F("cv")) ? request->arg(F("cv")).toInt() : 0;
+  if (request->hasArg(F("seg"))) {
+    uint8_t id = request->arg(F("seg")).toInt();
+    if (id >= strip.getSegmentsNum() || !strip.getSegment(id).isActive()) { request->send(404); return; }
+    cv = strip.getSegment(id).canvasIdx;
+  }
+  #ifndef WLED_DISABLE_2D
+  if (strip.isMatrix) {
+    const WS2812FX::Canvas c = strip.getCanvas(cv);
+    width = c.width; height = c.height; ls->base = c.offset;
+  }
+  #endif
+  ls->stride = width;
+  ls->x0 = ls->y0 = 0; ls->w = width; ls->h = height;
+  if (request->hasArg(F("seg"))) {
+    Segment &sg = strip.getSegment(request->arg(F("seg")).toInt());
+    ls->x0 = sg.start; ls->w = sg.stop - sg.start;
+    if (height > 1) { ls->y0 = sg.startY; ls->h = sg.stopY - sg.startY; }
+  } else {
+    if (request->hasArg(F("x"))) ls->x0 = request->arg(F("x")).toInt();
+    if (request->hasArg(F("w"))) ls->w  = request->arg(F("w")).toInt(); else ls->w = width > ls->x0 ? width - ls->x0 : 0;
+    if (height > 1) {
+      if (request->hasArg(F("y"))) ls->y0 = request->arg(F("y")).toInt();
+      if (request->hasArg(F("h"))) ls->h  = request->arg(F("h")).toInt(); else ls->h = height > ls->y0 ? height - ls->y0 : 0;
+    }
+  }
+  // clip to the physical area
+  if (ls->x0 >= width || ls->y0 >= height || !ls->w || !ls->h) { request->send(400); return; }
+  ls->w = min<uint16_t>(ls->w, width - ls->x0);
+  ls->h = min<uint16_t>(ls->h, height - ls->y0);
+
+  ls->b64 = request->hasArg(F("b64"));
+  const uint8_t hdr[6] = { 'L', 4, (uint8_t)(ls->w >> 8), (uint8_t)ls->w, (uint8_t)(ls->h >> 8), (uint8_t)ls->h };
+  memcpy(ls->hdr, hdr, sizeof(hdr));
+
+  // header (6 bytes) and each pixel (3 bytes) map to whole base64 groups, so nothing needs to be carried between pieces
+  AsyncWebServerResponse *response = request->beginChunkedResponse(ls->b64 ? F("text/plain") : F("application/octet-stream"),
+    [ls](uint8_t *buf, size_t maxLen, size_t index) -> size_t {
+      const uint32_t total = (uint32_t)ls->w * ls->h;
+      const size_t unit = ls->b64 ? 4 : 3;
+      size_t out = 0;
+      if (index == 0) {
+        if (maxLen < 2*unit) return 0;
+        if (ls->b64) { base64Triplet(ls->hdr, buf); base64Triplet(ls->hdr + 3, buf + 4); out = 8; }
+        else         { memcpy(buf, ls->hdr, 6); out = 6; }
+      }
+      uint8_t rgb[3];
+      for (; ls->px < total && out + unit <= maxLen; ls->px++) {
+        if (ls->b64) { liveStreamPixel(*ls, ls->px, rgb); base64Triplet(rgb, buf + out); }
+        else         liveStreamPixel(*ls, ls->px, buf + out);
+        out += unit;
+      }
+      return out;
+    });
+  response->addHeader(F("Cache-Control"), F("no-store"));
+  request->send(response);
+}
 #endif
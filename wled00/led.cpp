@@ -95,13 +95,34 @@ void applyFinalBri() {
 
 //called after every state changes, schedules interface updates, handles brightness transition and nightlight activation
 //unlike colorUpdated(), does NOT apply any colors or FX to segments
+//state changes within stateCoalesceInterval of the last one are rendered immediately, but notifications,
+//interface updates and transition start are emitted once from handleTransitions() when the interval is over
+static unsigned long lastStateEmit = 0;
+static bool    coalescePending  = false;
+static bool    coalesceEmitting = false;
+static uint8_t coalesceCallMode = CALL_MODE_DIRECT_CHANGE;
+
 void stateUpdated(byte callMode) {
   //call for notifier -> 0: init 1: direct change 2: button 3: notification 4: nightlight 5: other (No notification)
   //                     6: fx changed 7: hue 8: preset cycle 9: blynk 10: alexa 11: ws send only 12: button preset
+  idleWake();
   setValuesFromFirstSelectedSeg();
+  bool segmentChanged = stateChanged;
 
   if (bri != briOld || stateChanged) {
-    if (stateChanged) currentPreset = 0; //something changed, so we are no longer in the preset
+    if (stateChanged && !coalesceEmitting) currentPreset = 0; //something changed, so we are no longer in the preset (done when deferred)
+
+    if (stateCoalesceInterval && callMode != CALL_MODE_INIT && !coalesceEmitting && millis() - lastStateEmit < stateCoalesceInterval) {
+      // keep a notifying call mode if any of the coalesced changes had one
+      if (!coalescePending || (callMode != CALL_MODE_NOTIFICATION && callMode != CALL_MODE_NO_NOTIFY)) coalesceCallMode = callMode;
+      coalescePending = true;
+      stateChanged = false;
+      if (!transitionActive) { briT = bri; applyBri(); } // render intermediate brightness, ongoing transition heads there already
+      if (bri > 0) briLast = bri;
+      strip.trigger();
+      return;
+    }
+    lastStateEmit = millis();
 
     if (callMode != CALL_MODE_NOTIFICATION && callMode != CALL_MODE_NO_NOTIFY) notify(callMode);
     if (bri != briOld && nodeBroadcastEnabled) sendSysInfoUDP(); // update on state
@@ -132,6 +153,19 @@ void stateUpdated(byte callMode) {
 
   // notify usermods of state change
   usermods.onStateChange(callMode);
+  static byte eventBri = 0; // brightness of the last brightness event
+  if (bri != eventBri && usermods.wantsEvent(UM_EVENT_BRIGHTNESS)) {
+    um_event_t ev = {UM_EVENT_BRIGHTNESS, callMode};
+    ev.brightness.bri = bri;
+    ev.brightness.oldBri = eventBri;
+    usermods.dispatchEvent(ev);
+  }
+  eventBri = bri;
+  if (segmentChanged && usermods.wantsEvent(UM_EVENT_SEGMENT)) {
+    um_event_t ev = {UM_EVENT_SEGMENT, callMode};
+    ev.segment.id = strip.getMainSegmentId();
+    usermods.dispatchEvent(ev);
+  }
 
   if (fadeTransition) {
     if (strip.getTransition() == 0) {
@@ -142,11 +176,8 @@ void stateUpdated(byte callMode) {
       return;
     }
 
-    if (transitionActive) {
-      briOld = briT;
-      tperLast = 0;
-    } else
-      strip.setTransitionMode(true); // force all segments to transition mode
+    briOld = briT; // start from current brightness (differs from briOld if ongoing or coalesced intermediate changes were rendered)
+    if (!transitionActive) strip.setTransitionMode(true); // force all segments to transition mode
     transitionActive = true;
     transitionStartTime = millis();
   } else {
@@ -176,32 +207,55 @@ void updateInterfaces(uint8_t callMode)
 }
 
 
+//global brightness at time t of the transition, integer progress like Segment::updateTransition()
+static byte transitionBri(unsigned long t) {
+  unsigned dur  = strip.getTransition();
+  unsigned diff = (long)(t - transitionStartTime) > 0 ? t - transitionStartTime : 0; // frame clock time may lag millis()
+  uint32_t prog = (dur > 0 && diff < dur) ? diff * 0xFFFFU / dur : 0xFFFFU;
+  return (bri * prog + briOld * (0xFFFFU - prog)) / 0xFFFFU;
+}
+
+
 void handleTransitions()
 {
+  //emit coalesced state changes
+  if (coalescePending && millis() - lastStateEmit >= stateCoalesceInterval) {
+    coalescePending = false;
+    coalesceEmitting = true;
+    stateChanged = true;
+    stateUpdated(coalesceCallMode);
+    coalesceEmitting = false;
+  }
+
   //handle still pending interface update
   updateInterfaces(interfaceUpdateCallMode);
 #ifndef WLED_DISABLE_MQTT
   if (doPublishMqtt) publishMqtt();
 #endif
 
-  if (transitionActive && strip.getTransition() > 0) {
-    float tper = (millis() - transitionStartTime)/(float)strip.getTransition();
-    if (tper >= 1.0f) {
-      strip.setTransitionMode(false); // stop all transitions
-      // restore (global) transition time if not called from UDP notifier or single/temporary transition from JSON (also playlist)
-      if (jsonTransitionOnce) strip.setTransition(transitionDelay);
-      transitionActive = false;
-      jsonTransitionOnce = false;
-      tperLast = 0;
-      applyFinalBri();
-      return;
-    }
-    if (tper - tperLast < 0.004f) return;
-    tperLast = tper;
-    briT = briOld + ((bri - briOld) * tper);
-
-    applyBri();
+  // brightness itself is advanced by updateTransitionBri() when frames are rendered
+  // realtime data drives the LEDs without service(): step it here, it is shown with the next realtime frame
+  if (transitionActive && realtimeMode && !realtimeOverride && !realtimeSegmentsOnly()) {
+    briT = transitionBri(millis());
+    if (!arlsForceMaxBri) strip.setBrightness(scaledBri(briT), true);
   }
+  if (transitionActive && millis() - transitionStartTime >= strip.getTransition()) {
+    strip.setTransitionMode(false); // stop all transitions
+    // restore (global) transition time if not called from UDP notifier or single/temporary transition from JSON (also playlist)
+    if (jsonTransitionOnce) strip.setTransition(transitionDelay);
+    transitionActive = false;
+    jsonTransitionOnce = false;
+    applyFinalBri();
+  }
+}
+
+
+//global brightness transition, called from strip.service() once per frame together with segment transitions
+//the frame is composited with the new brightness (no repaint)
+void updateTransitionBri(unsigned long t) {
+  if (!transitionActive) return;
+  briT = transitionBri(t);
+  if (!realtimeMode || !arlsForceMaxBri) strip.setFrameBrightness(scaledBri(briT));
 }
 
 
@@ -0,0 +1,281 @@
+#include "wled.h"
+#include <memory>
+#include <stdarg.h>
+
+/*
+ * Runtime counters in Prometheus/OpenMetrics text format (GET /metrics)
+ * Output is generated one metric family at a time into a small line buffer
+ * and streamed as a chunked response, so no JSON buffer or large String is needed.
+ */
+
+loop_stats_t loopStats = {0};
+
+void addLoopStats(uint32_t loopUs, uint32_t stripUs, uint32_t usermodUs)
+{
+  loopStats.loops++;
+  loopStats.curLoops++;
+  loopStats.loopUs    += loopUs;
+  loopStats.stripUs   += stripUs;
+  loopStats.usermodUs += usermodUs;
+  if (loopUs    > loopStats.curLoopMax)    loopStats.curLoopMax    = loopUs;
+  if (stripUs   > loopStats.curStripMax)   loopStats.curStripMax   = stripUs;
+  if (usermodUs > loopStats.curUsermodMax) loopStats.curUsermodMax = usermodUs;
+  uint32_t window = millis() - loopStats.windowStart;
+  if (window > LOOP_STATS_WINDOW) {
+    loopStats.lps = (uint64_t)loopStats.curLoops * 1000 / window; loopStats.curLoops = 0;
+    loopStats.loopMax    = loopStats.curLoopMax;    loopStats.curLoopMax    = 0;
+    loopStats.stripMax   = loopStats.curStripMax;   loopStats.curStripMax   = 0;
+    loopStats.usermodMax = loopStats.curUsermodMax; loopStats.curUsermodMax = 0;
+    loopStats.windowStart = millis();
+    rollSchedStatsWindow();
+  }
+}
+
+#ifndef WLED_DISABLE_METRICS
+
+#define METRICS_LINE_LEN 320
+
+// metric families, each one is generated in one or more pieces (MF_* order is output order)
+enum MetricFamily : uint8_t {
+  MF_INFO, MF_UPTIME, MF_FPS, MF_TARGET_FPS, MF_SHOW, MF_WAIT,
+  MF_LOOPS, MF_LOOP_RATE, MF_LOOP_TIME, MF_LOOP_MAX, MF_TASK_RUNS, MF_TASK_TIME, MF_TASK_MAX, MF_TASK_DEFER, MF_HEAP, MF_HEAP_BLOCK, MF_HEAP_MIN_BLOCK, MF_HEAP_WARN, MF_HEAP_TAG, MF_HEAP_FAIL, MF_PSRAM,
+  MF_JSON_POOL, MF_JSON_USED, MF_JSON_REQ, MF_JSON_WAIT, MF_JSON_TIMEOUT, MF_JSON_QUEUE,
+  MF_HTTP_ADMIT, MF_HTTP_REJECT, MF_HTTP_INFLIGHT, MF_WS_CLIENTS, MF_WS_STATE_ONLY, MF_WS_CLOSES, MF_WS_LIVE, MF_WS_SUBS, MF_UDP_IN, MF_UDP_OUT,
+  MF_RT_PACKETS, MF_RT_FRAMES, MF_RT_DROPPED, MF_RT_DUP,
+  MF_POWER, MF_POWER_LIMIT, MF_RSSI, MF_COUNT
+};
+
+struct MetricsStream {
+  uint8_t  family = 0, item = 0;      // current family and item (label value) within it
+  uint16_t len = 0, pos = 0;          // pending bytes in line[]
+  char     line[METRICS_LINE_LEN];
+};
+
+// appends to the line buffer, output that does not fit is truncated (line buffer is sized for the longest piece)
+static void mAppend(MetricsStream &ms, const char *fmt, ...)
+{
+  if (ms.len >= METRICS_LINE_LEN - 1) return;
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf_P(ms.line + ms.len, METRICS_LINE_LEN - ms.len, fmt, args);
+  va_end(args);
+  if (n > 0) ms.len = min(ms.len + n, METRICS_LINE_LEN - 1);
+}
+
+static void mHeader(MetricsStream &ms, const char *name, const char *type, const char *help)
+{
+  mAppend(ms, PSTR("# HELP wled_%s %s\n# TYPE wled_%s %s\n"), name, help, name, type);
+}
+
+static void mValue(MetricsStream &ms, const char *name, const char *type, const char *help, uint32_t val)
+{
+  mHeader(ms, name, type, help);
+  mAppend(ms, PSTR("wled_%s %u\n"), name, (unsigned)val);
+}
+
+static const char *rtSourceName(uint8_t md)
+{
+  switch (md) {
+    case REALTIME_MODE_GENERIC: return PSTR("generic");
+    case REALTIME_MODE_UDP:     return PSTR("udp");
+    case REALTIME_MODE_HYPERION:return PSTR("hyperion");
+    case REALTIME_MODE_E131:    return PSTR("e131");
+    case REALTIME_MODE_ADALIGHT:return PSTR("adalight");
+    case REALTIME_MODE_ARTNET:  return PSTR("artnet");
+    case REALTIME_MODE_TPM2NET: return PSTR("tpm2net");
+    case REALTIME_MODE_DDP:     return PSTR("ddp");
+    case REALTIME_MODE_FSEQ:    return PSTR("fseq");
+    case REALTIME_MODE_DMX:     return PSTR("dmx");
+  }
+  return PSTR("other");
+}
+
+// per source realtime counter family, one item per source
+static bool mRealtime(MetricsStream &ms, const char *name, const char *help, uint8_t which)
+{
+  uint8_t md = REALTIME_MODE_GENERIC + ms.item;
+  if (md > REALTIME_MODE_LAST) return false;
+  if (!ms.item) mHeader(ms, name, PSTR("counter"), help);
+  const realtime_stats_t *st = getRealtimeStats(md);
+  if (st) {
+    uint32_t v = which == 0 ? st->packets : which == 1 ? st->frames : which == 2 ? st->dropped : st->duplicates;
+    mAppend(ms, PSTR("wled_%s{source=\"%s\"} %u\n"), name, rtSourceName(md), (unsigned)v);
+  }
+  return true;
+}
+
+// per request class admission control family, one item per class
+static bool mAdmission(MetricsStream &ms, const char *name, const char *type, const char *help, uint8_t which)
+{
+  const adm_stats_t *a = getAdmissionStats(ms.item);
+  if (!a) return false;
+  if (!ms.item) mHeader(ms, name, type, help);
+  uint32_t v = which == 0 ? a->admitted : which == 1 ? a->rejected : a->inFlight;
+  mAppend(ms, PSTR("wled_%s{class=\"%s\"} %u\n"), name, ms.item == ADM_CLASS_RT ? PSTR("realtime") : ms.item == ADM_CLASS_CTRL ? PSTR("control") : PSTR("ui"), (unsigned)v);
+  return true;
+}
+
+// per owner JSON buffer lock counter family, one item per owner that was ever seen
+static bool mJsonLock(MetricsStream &ms, const char *name, const char *help, uint8_t which)
+{
+  uint8_t owner = ms.item + 1;
+  if (owner >= JSON_LOCK_OWNERS) return false;
+  if (ms.item == 0) mHeader(ms, name, PSTR("counter"), help);
+  const json_lock_stats_t *st = getJSONLockStats(owner);
+  if (st && st->requests) {
+    uint32_t v = which == 0 ? st->requests : which == 1 ? st->waits : st->timeouts;
+    mAppend(ms, PSTR("wled_%s{owner=\"%u\"} %u\n"), name, (unsigned)owner, (unsigned)v);
+  }
+  return true;
+}
+
+// per loop subsystem (scheduler task) family, one item per task
+static bool mTask(MetricsStream &ms, const char *name, const char *type, const char *help, uint8_t which)
+{
+  const sched_task_t *t = getSchedTask(ms.item);
+  if (!t) return false;
+  if (ms.item == 0) mHeader(ms, name, type, help);
+  if (which == 1) {
+    mAppend(ms, PSTR("wled_%s{task=\"%s\"} %u.%06u\n"), name, t->name, (unsigned)(t->totalUs/1000000), (unsigned)(t->totalUs%1000000));
+    return true;
+  }
+  uint32_t v = which == 0 ? t->runs : which == 2 ? t->winMaxUs : t->deferred;
+  mAppend(ms, PSTR("wled_%s{task=\"%s\"} %u\n"), name, t->name, (unsigned)v);
+  return true;
+}
+
+// per subsystem heap attribution family, one item per HEAP_TAG_*
+static bool mHeapTag(MetricsStream &ms, const char *name, const char *type, const char *help, uint8_t which)
+{
+  const heap_tag_stats_t *t = getHeapTagStats(ms.item);
+  if (!t) return false;
+  if (ms.item == 0) mHeader(ms, name, type, help);
+  mAppend(ms, PSTR("wled_%s{tag=\"%s\"} %u\n"), name, getHeapTagName(ms.item), (unsigned)(which ? t->fails : t->live));
+  return true;
+}
+
+// fills ms.line with the next piece of output, returns false when done
+static bool nextMetrics(MetricsStream &ms)
+{
+  ms.len = ms.pos = 0;
+  while (ms.family < MF_COUNT && !ms.len) {
+    bool more = false; // family has further items
+    switch (ms.family) {
+      case MF_INFO:
+        mHeader(ms, PSTR("info"), PSTR("gauge"), PSTR("Build and device information"));
+        mAppend(ms, PSTR("wled_info{version=\"%s\",vid=\"%u\",name=\"%s\",arch=\"%s\"} 1\n"),
+          versionString, (unsigned)VERSION, serverDescription,
+        #ifdef ARDUINO_ARCH_ESP32
+          ESP.getChipModel()
+        #else
+          "esp8266"
+        #endif
+        );
+        break;
+      case MF_UPTIME:     mValue(ms, PSTR("uptime_seconds"), PSTR("counter"), PSTR("Time since boot"), millis()/1000); break;
+      case MF_FPS:        mValue(ms, PSTR("fps"), PSTR("gauge"), PSTR("Frames shown per second"), strip.getFps()); break;
+      case MF_TARGET_FPS: mValue(ms, PSTR("target_fps"), PSTR("gauge"), PSTR("Configured frame rate"), strip.getTargetFps()); break;
+      case MF_SHOW:
+        mHeader(ms, PSTR("show_microseconds"), PSTR("gauge"), PSTR("Time spent in bus output per frame"));
+        mAppend(ms, PSTR("wled_show_microseconds{stat=\"avg\"} %u\nwled_show_microseconds{stat=\"max\"} %u\n"),
+          (unsigned)strip.getOutputStats().avg(), (unsigned)strip.getOutputStats().max);
+        break;
+      case MF_WAIT:
+        mHeader(ms, PSTR("wait_microseconds"), PSTR("gauge"), PSTR("Time blocked waiting for previous frame to be sent"));
+        mAppend(ms, PSTR("wled_wait_microseconds{stat=\"avg\"} %u\nwled_wait_microseconds{stat=\"max\"} %u\n"),
+          (unsigned)strip.getWaitStats().avg(), (unsigned)strip.getWaitStats().max);
+        break;
+      case MF_LOOPS:      mValue(ms, PSTR("loops_total"), PSTR("counter"), PSTR("Main loop iterations"), loopStats.loops); break;
+      case MF_LOOP_RATE:  mValue(ms, PSTR("loops_per_second"), PSTR("gauge"), PSTR("Main loop iterations per second in the last 10s"), loopStats.lps); break;
+      case MF_LOOP_TIME:
+        mHeader(ms, PSTR("loop_seconds_total"), PSTR("counter"), PSTR("Time spent in main loop"));
+        mAppend(ms, PSTR("wled_loop_seconds_total{part=\"all\"} %u.%06u\n"), (unsigned)(loopStats.loopUs/1000000), (unsigned)(loopStats.loopUs%1000000));
+        mAppend(ms, PSTR("wled_loop_seconds_total{part=\"strip\"} %u.%06u\n"), (unsigned)(loopStats.stripUs/1000000), (unsigned)(loopStats.stripUs%1000000));
+        mAppend(ms, PSTR("wled_loop_seconds_total{part=\"usermods\"} %u.%06u\n"), (unsigned)(loopStats.usermodUs/1000000), (unsigned)(loopStats.usermodUs%1000000));
+        break;
+      case MF_LOOP_MAX:
+        mHeader(ms, PSTR("loop_max_microseconds"), PSTR("gauge"), PSTR("Longest main loop iteration in the last 10s"));
+        mAppend(ms, PSTR("wled_loop_max_microseconds{part=\"all\"} %u\nwled_loop_max_microseconds{part=\"strip\"} %u\nwled_loop_max_microseconds{part=\"usermods\"} %u\n"),
+          (unsigned)loopStats.loopMax, (unsigned)loopStats.stripMax, (unsigned)loopStats.usermodMax);
+        break;
+      case MF_TASK_RUNS:  more = mTask(ms, PSTR("task_runs_total"), PSTR("counter"), PSTR("Runs per loop subsystem"), 0); break;
+      case MF_TASK_TIME:  more = mTask(ms, PSTR("task_seconds_total"), PSTR("counter"), PSTR("Run time per loop subsystem"), 1); break;
+      case MF_TASK_MAX:   more = mTask(ms, PSTR("task_max_microseconds"), PSTR("gauge"), PSTR("Longest run per loop subsystem in the last 10s"), 2); break;
+      case MF_TASK_DEFER: more = mTask(ms, PSTR("task_deferred_total"), PSTR("counter"), PSTR("Idle subsystem runs postponed for a frame"), 3); break;
+      case MF_HEAP:       mValue(ms, PSTR("heap_free_bytes"), PSTR("gauge"), PSTR("Free heap"), ESP.getFreeHeap()); break;
+      case MF_HEAP_BLOCK:
+      #ifdef ARDUINO_ARCH_ESP32
+        mValue(ms, PSTR("heap_largest_block_bytes"), PSTR("gauge"), PSTR("Largest allocatable heap block"), ESP.getMaxAllocHeap());
+      #else
+        mValue(ms, PSTR("heap_largest_block_bytes"), PSTR("gauge"), PSTR("Largest allocatable heap block"), ESP.getMaxFreeBlockSize());
+      #endif
+        break;
+      case MF_HEAP_MIN_BLOCK: mValue(ms, PSTR("heap_min_largest_block_bytes"), PSTR("gauge"), PSTR("Smallest largest heap block seen"), getHeapStats().minMaxBlock); break;
+      case MF_HEAP_WARN:  mValue(ms, PSTR("heap_warning"), PSTR("gauge"), PSTR("Heap warning level (0 ok, 1 low, 2 critical)"), getHeapStats().warn); break;
+      case MF_HEAP_TAG:   more = mHeapTag(ms, PSTR("heap_tag_bytes"), PSTR("gauge"), PSTR("Heap held per subsystem"), 0); break;
+      case MF_HEAP_FAIL:  more = mHeapTag(ms, PSTR("heap_alloc_failures_total"), PSTR("counter"), PSTR("Failed heap allocations per subsystem"), 1); break;
+      case MF_PSRAM:
+      #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM)
+        if (psramFound()) mValue(ms, PSTR("psram_free_bytes"), PSTR("gauge"), PSTR("Free PSRAM"), ESP.getFreePsram());
+      #endif
+        break;
+      case MF_JSON_POOL:  mValue(ms, PSTR("json_buffers"), PSTR("gauge"), PSTR("JSON buffers in pool"), getJSONBufferPoolSize()); break;
+      case MF_JSON_USED:  mValue(ms, PSTR("json_buffers_in_use"), PSTR("gauge"), PSTR("JSON buffers currently locked"), getJSONBuffersInUse()); break;
+      case MF_JSON_REQ:     more = mJsonLock(ms, PSTR("json_lock_requests_total"), PSTR("JSON buffer requests per owner"), 0); break;
+      case MF_JSON_WAIT:    more = mJsonLock(ms, PSTR("json_lock_waits_total"), PSTR("JSON buffer requests that had to wait"), 1); break;
+      case MF_JSON_TIMEOUT: more = mJsonLock(ms, PSTR("json_lock_timeouts_total"), PSTR("JSON buffer requests that timed out"), 2); break;
+      case MF_JSON_QUEUE: mValue(ms, PSTR("json_lock_queue"), PSTR("gauge"), PSTR("Requests waiting for a JSON buffer"), getJSONBufferQueue()); break;
+      case MF_HTTP_ADMIT:    more = mAdmission(ms, PSTR("http_admitted_total"), PSTR("counter"), PSTR("HTTP requests admitted per class"), 0); break;
+      case MF_HTTP_REJECT:   more = mAdmission(ms, PSTR("http_rejected_total"), PSTR("counter"), PSTR("HTTP requests refused (503) per class"), 1); break;
+      case MF_HTTP_INFLIGHT: more = mAdmission(ms, PSTR("http_in_flight"), PSTR("gauge"), PSTR("HTTP requests in progress per class"), 2); break;
+      case MF_WS_CLIENTS:
+      #ifdef WLED_ENABLE_WEBSOCKETS
+        mValue(ms, PSTR("ws_clients"), PSTR("gauge"), PSTR("Connected WebSocket clients"), ws.count());
+      #endif
+        break;
+      case MF_WS_STATE_ONLY: mValue(ms, PSTR("ws_state_only"), PSTR("gauge"), PSTR("WebSocket broadcasts degraded to state only"), getWsLoadStats()->stateOnly); break;
+      case MF_WS_CLOSES:  mValue(ms, PSTR("ws_overload_closes_total"), PSTR("counter"), PSTR("Times all WebSocket clients were closed for lack of memory"), getWsLoadStats()->closes); break;
+      case MF_WS_LIVE:    mValue(ms, PSTR("ws_live_viewers"), PSTR("gauge"), PSTR("WebSocket live view clients"), getWsLiveViewers()); break;
+      case MF_WS_SUBS:    mValue(ms, PSTR("ws_state_subscribers"), PSTR("gauge"), PSTR("WebSocket state patch subscribers"), getWsSubscribers()); break;
+      case MF_UDP_IN:     mValue(ms, PSTR("udp_packets_received_total"), PSTR("counter"), PSTR("UDP packets received (sync, realtime)"), udpPacketsIn); break;
+      case MF_UDP_OUT:    mValue(ms, PSTR("udp_packets_sent_total"), PSTR("counter"), PSTR("UDP packets sent"), udpPacketsOut); break;
+      case MF_RT_PACKETS: more = mRealtime(ms, PSTR("realtime_packets_total"), PSTR("Realtime packets received per source"), 0); break;
+      case MF_RT_FRAMES:  more = mRealtime(ms, PSTR("realtime_frames_total"), PSTR("Realtime frames received per source"), 1); break;
+      case MF_RT_DROPPED: more = mRealtime(ms, PSTR("realtime_dropped_total"), PSTR("Out of sequence realtime packets per source"), 2); break;
+      case MF_RT_DUP:     more = mRealtime(ms, PSTR("realtime_duplicates_total"), PSTR("Repeated realtime universes per source"), 3); break;
+      case MF_POWER:      mValue(ms, PSTR("power_milliamps"), PSTR("gauge"), PSTR("Estimated LED current"), strip.currentMilliamps); break;
+      case MF_POWER_LIMIT:mValue(ms, PSTR("power_limit_milliamps"), PSTR("gauge"), PSTR("Configured current limit (0: disabled)"), strip.ablMilliampsMax); break;
+      case MF_RSSI:
+        if (Network.isConnected() && !apActive) {
+          mHeader(ms, PSTR("wifi_rssi_dbm"), PSTR("gauge"), PSTR("WiFi signal strength"));
+          mAppend(ms, PSTR("wled_wifi_rssi_dbm %d\n"), (int)WiFi.RSSI());
+        }
+        break;
+    }
+    if (more) ms.item++;
+    else { ms.family++; ms.item = 0; }
+  }
+  return ms.len;
+}
+
+void serveMetrics(AsyncWebServerRequest* request)
+{
+  std::shared_ptr<MetricsStream> ms = std::make_shared<MetricsStream>();
+  AsyncWebServerResponse *response = request->beginChunkedResponse(F("text/plain; version=0.0.4"), [ms](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+    size_t written = 0;
+    while (written < maxLen) {
+      if (ms->pos >= ms->len && !nextMetrics(*ms)) break;
+      size_t n = min((size_t)(ms->len - ms->pos), maxLen - written);
+      memcpy(buffer + written, ms->line + ms->pos, n);
+      ms->pos += n;
+      written += n;
+    }
+    return written;
+  });
+  response->addHeader(F("Cache-Control"), F("no-store"));
+  request->send(response);
+}
+
+#else
+void serveMetrics(AsyncWebServerRequest* request) { request->send(501); }
+#endif
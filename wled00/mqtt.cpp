@@ -6,6 +6,54 @@
 
 #ifdef WLED_ENABLE_MQTT
 #define MQTT_KEEP_ALIVE_TIME 60    // contact the MQTT broker every 60 seconds
+#ifndef WLED_MQTT_PUBLISH_MS
+  #define WLED_MQTT_PUBLISH_MS 250 // min. time between publishes of a state topic
+#endif
+
+#ifndef USERMOD_SMARTNEST
+// state topics are only published when their payload changed, at most once per WLED_MQTT_PUBLISH_MS each;
+// changes within that time are held back and the latest value is sent once it has passed
+#define MQTT_TOPIC_BRI    0
+#define MQTT_TOPIC_COL    1
+#define MQTT_TOPIC_STATUS 2
+#define MQTT_TOPIC_XML    3
+#define MQTT_TOPICS       4
+
+static uint32_t mqttHash[MQTT_TOPICS]; // hash of last published payload
+static uint32_t mqttSent[MQTT_TOPICS]; // time of last publish
+static bool     mqttForce = false;     // (re)connected: publish all topics
+
+static uint32_t mqttPayloadHash(const char *p)
+{
+  return fnv1a(p, strlen(p));
+}
+
+static void mqttPublishTopic(uint8_t t, const char *suffix, const char *payload, bool retain)
+{
+  uint32_t h = mqttPayloadHash(payload);
+  if (!mqttForce && h == mqttHash[t]) return;
+  char subuf[38];
+  strlcpy(subuf, mqttDeviceTopic, 33);
+  strcat_P(subuf, suffix);
+  mqtt->publish(subuf, 0, retain, payload);
+  mqttHash[t] = h;
+  mqttSent[t] = millis();
+}
+
+// same content as XML_response() (/win), written directly instead of through oappend()
+static void mqttXmlState(char *dest, size_t len)
+{
+  snprintf_P(dest, len, PSTR("<?xml version=\"1.0\" ?><vs><ac>%u</ac><cl>%u</cl><cl>%u</cl><cl>%u</cl><cs>%u</cs><cs>%u</cs><cs>%u</cs>"
+    "<ns>%u</ns><nr>%u</nr><nl>%u</nl><nf>%u</nf><nd>%u</nd><nt>%u</nt><fx>%u</fx><sx>%u</sx><ix>%u</ix><fp>%u</fp>"
+    "<wv>%d</wv><ws>%u</ws><ps>%u</ps><cy>%u</cy><ds>%s%s</ds><ss>%u</ss></vs>"),
+    (nightlightActive && nightlightMode > NL_MODE_SET) ? briT : bri,
+    col[0], col[1], col[2], colSec[0], colSec[1], colSec[2],
+    notifyDirect, receiveNotifications, nightlightActive, nightlightMode > NL_MODE_SET, nightlightDelayMins, nightlightTargetBri,
+    effectCurrent, effectSpeed, effectIntensity, effectPalette,
+    strip.hasWhiteChannel() ? (int)col[3] : -1, colSec[3], currentPreset, currentPlaylist >= 0,
+    serverDescription, realtimeMode ? " (live)" : "", strip.getFirstSelectedSegId());
+}
+#endif
 
 void parseMQTTBriPayload(char* payload)
 {
@@ -47,6 +95,9 @@ void onMqttConnect(bool sessionPresent)
 
   usermods.onMqttConnect(sessionPresent);
 
+  #ifndef USERMOD_SMARTNEST
+  mqttForce = true;
+  #endif
   doPublishMqtt = true;
   DEBUG_PRINTLN(F("MQTT ready"));
 }
@@ -103,20 +154,21 @@ void onMqttMessage(char* topic, char* payload, AsyncMqttClientMessageProperties
     colorFromDecOrHexString(col, payloadStr);
     colorUpdated(CALL_MODE_DIRECT_CHANGE);
   } else if (strcmp_P(topic, PSTR("/api")) == 0) {
-    if (!requestJSONBufferLock(15)) {
+    JsonDocument *pdoc = requestJSONBuffer(JSON_LOCK_MQTT); // any free buffer of the pool
+    if (!pdoc) {
       delete[] payloadStr;
       payloadStr = nullptr;
       return;
     }
     if (payloadStr[0] == '{') { //JSON API
-      deserializeJson(doc, payloadStr);
-      deserializeState(doc.as<JsonObject>());
+      deserializeJson(*pdoc, payloadStr);
+      deserializeState(pdoc->as<JsonObject>());
     } else { //HTTP API
       String apireq = "win"; apireq += '&'; // reduce flash string usage
       apireq += payloadStr;
       handleSet(nullptr, apireq);
     }
-    releaseJSONBufferLock();
+    releaseJSONBuffer(pdoc);
   } else if (strlen(topic) != 0) {
     // non standard topic, check with usermods
     usermods.onMqttMessage(topic, payloadStr);
@@ -133,31 +185,36 @@ void publishMqtt()
 {
   doPublishMqtt = false;
   if (!WLED_MQTT_CONNECTED) return;
-  DEBUG_PRINTLN(F("Publish MQTT"));
 
   #ifndef USERMOD_SMARTNEST
-  char s[10];
-  char subuf[38];
-
-  sprintf_P(s, PSTR("%u"), bri);
-  strlcpy(subuf, mqttDeviceTopic, 33);
-  strcat_P(subuf, PSTR("/g"));
-  mqtt->publish(subuf, 0, retainMqttMsg, s);         // optionally retain message (#2263)
-
-  sprintf_P(s, PSTR("#%06X"), (col[3] << 24) | (col[0] << 16) | (col[1] << 8) | (col[2]));
-  strlcpy(subuf, mqttDeviceTopic, 33);
-  strcat_P(subuf, PSTR("/c"));
-  mqtt->publish(subuf, 0, retainMqttMsg, s);         // optionally retain message (#2263)
-
-  strlcpy(subuf, mqttDeviceTopic, 33);
-  strcat_P(subuf, PSTR("/status"));
-  mqtt->publish(subuf, 0, true, "online");          // retain message for a LWT
-
-  char apires[1024];                                // allocating 1024 bytes from stack can be risky
-  XML_response(nullptr, apires);
-  strlcpy(subuf, mqttDeviceTopic, 33);
-  strcat_P(subuf, PSTR("/v"));
-  mqtt->publish(subuf, 0, retainMqttMsg, apires);   // optionally retain message (#2263)
+  uint32_t now = millis();
+  for (uint8_t t = 0; t < MQTT_TOPICS; t++) {
+    if (!mqttForce && now - mqttSent[t] < WLED_MQTT_PUBLISH_MS) {
+      doPublishMqtt = true; // check again on next loop (trailing edge)
+      continue;
+    }
+    char s[10];
+    switch (t) {
+      case MQTT_TOPIC_BRI:
+        sprintf_P(s, PSTR("%u"), bri);
+        mqttPublishTopic(t, PSTR("/g"), s, retainMqttMsg);        // optionally retain message (#2263)
+        break;
+      case MQTT_TOPIC_COL:
+        sprintf_P(s, PSTR("#%06X"), (col[3] << 24) | (col[0] << 16) | (col[1] << 8) | (col[2]));
+        mqttPublishTopic(t, PSTR("/c"), s, retainMqttMsg);        // optionally retain message (#2263)
+        break;
+      case MQTT_TOPIC_STATUS:
+        mqttPublishTopic(t, PSTR("/status"), "online", true);     // retain message for a LWT
+        break;
+      case MQTT_TOPIC_XML: {
+        char apires[512];
+        mqttXmlState(apires, sizeof(apires));
+        mqttPublishTopic(t, PSTR("/v"), apires, retainMqttMsg);   // optionally retain message (#2263)
+        break;
+      }
+    }
+  }
+  mqttForce = false;
   #endif
 }
 
@@ -149,6 +149,81 @@ int getSignalQuality(int rssi)
 }
 
 
+/*
+ * Fast WiFi connect: BSSID and channel of the last successful connection (and the DHCP lease if built with
+ * WLED_ENABLE_WIFI_CACHED_IP) are kept in a tiny file. initConnection() first associates directly with that
+ * access point, skipping the scan; if that does not succeed within WLED_FAST_CONNECT_TIMEOUT the regular
+ * scan-and-connect follows. Reusing the lease also skips DHCP, but assumes the router keeps the address
+ * reserved, hence opt-in (a configured static IP always takes precedence).
+ */
+#define WIFI_CACHE_VERSION 1
+#define WIFI_CACHE_LEN     31
+
+static const char s_wifiCacheFile[] PROGMEM = "/wifi.bin";
+
+static uint32_t wifiCacheHash(const char *ssid) {
+  return fnv1a(ssid, strlen(ssid));
+}
+
+// file layout: 'W','W','C',version, SSID hash (4), BSSID (6), channel, IP (4), gateway (4), subnet (4), DNS (4)
+static bool readWifiCache(uint8_t *b) {
+  char fileName[12];
+  strcpy_P(fileName, s_wifiCacheFile);
+  File f = WLED_FS.open(fileName, "r");
+  if (!f) return false;
+  bool ok = f.size() == WIFI_CACHE_LEN && f.read(b, WIFI_CACHE_LEN) == WIFI_CACHE_LEN;
+  f.close();
+  if (!ok || b[0] != 'W' || b[1] != 'W' || b[2] != 'C' || b[3] != WIFI_CACHE_VERSION) return false;
+  uint32_t h;
+  memcpy(&h, b + 4, sizeof(h));
+  return h == wifiCacheHash(clientSSID) && b[14] > 0 && b[14] <= 14;
+}
+
+// starts association with the cached access point, returns false if there is none for the configured SSID
+// (call after WiFi.config() and before any WiFi.begin())
+bool beginFastConnect() {
+  uint8_t b[WIFI_CACHE_LEN];
+  if (!readWifiCache(b)) return false;
+#ifdef WLED_ENABLE_WIFI_CACHED_IP
+  if (!(staticIP[0] && staticGateway[0]) && b[15]) {
+    WiFi.config(IPAddress(b[15], b[16], b[17], b[18]), IPAddress(b[19], b[20], b[21], b[22]),
+                IPAddress(b[23], b[24], b[25], b[26]), IPAddress(b[27], b[28], b[29], b[30]));
+  }
+#endif
+  DEBUG_PRINTF("Fast connect to %02X:%02X:%02X:%02X:%02X:%02X on channel %u.\n", b[8], b[9], b[10], b[11], b[12], b[13], b[14]);
+  WiFi.begin(clientSSID, clientPass, b[14], b + 8);
+  return true;
+}
+
+// stores the access point (and lease) of the established connection, written only if it changed (call from loop)
+void saveFastConnect() {
+  if (WiFi.status() != WL_CONNECTED) return; // e.g. Ethernet
+  const uint8_t *bssid = WiFi.BSSID();
+  int32_t channel = WiFi.channel();
+  if (!bssid || channel <= 0 || channel > 14) return;
+  uint8_t b[WIFI_CACHE_LEN] = {'W', 'W', 'C', WIFI_CACHE_VERSION};
+  uint32_t h = wifiCacheHash(clientSSID);
+  memcpy(b + 4, &h, sizeof(h));
+  memcpy(b + 8, bssid, 6);
+  b[14] = channel;
+#ifdef WLED_ENABLE_WIFI_CACHED_IP
+  if (!(staticIP[0] && staticGateway[0])) { // only a DHCP lease is worth caching
+    IPAddress ip[4] = {WiFi.localIP(), WiFi.gatewayIP(), WiFi.subnetMask(), WiFi.dnsIP()};
+    for (unsigned i = 0; i < 4; i++) for (unsigned j = 0; j < 4; j++) b[15 + 4*i + j] = ip[i][j];
+  }
+#endif
+  uint8_t old[WIFI_CACHE_LEN];
+  if (readWifiCache(old) && !memcmp(old, b, sizeof(b))) return; // spare the flash
+  char fileName[12];
+  strcpy_P(fileName, s_wifiCacheFile);
+  File f = WLED_FS.open(fileName, "w");
+  if (!f) return;
+  f.write(b, sizeof(b));
+  f.close();
+  DEBUG_PRINTLN(F("WiFi fast connect data saved."));
+}
+
+
 //handle Ethernet connection event
 void WiFiEvent(WiFiEvent_t event)
 {
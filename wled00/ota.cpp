@@ -0,0 +1,163 @@
+#include "wled.h"
+
+/*
+ * Streaming firmware update (/update upload) that keeps the LEDs running.
+ * On ESP32 the upload handler (AsyncTCP task) only copies data into a stream buffer; a writer task takes it out
+ * in chunks of one flash sector and writes them with Update, pausing after each chunk until at least one frame
+ * was shown (or WLED_OTA_FPS frame time passed). Erasing and writing flash stalls execution from flash on both
+ * cores, so pacing the writes is what keeps rendering going. The strip is capped to WLED_OTA_FPS meanwhile so
+ * the frames fit between writes. When the buffer is full the upload handler blocks, which throttles the sender
+ * through the TCP window. On ESP8266 data is written directly (as before), only statistics are kept.
+ */
+
+#ifndef WLED_DISABLE_OTA
+
+#ifndef WLED_OTA_FPS
+  #define WLED_OTA_FPS     20    // frame rate guaranteed while flash is written
+#endif
+#define OTA_CHUNK          4096  // one flash sector
+#define OTA_BUFFER         (4*OTA_CHUNK)
+#define OTA_SEND_TIMEOUT   5000  // ms the upload handler waits for buffer space
+#define OTA_DATA_TIMEOUT   10000 // ms without data after which the upload is considered aborted
+
+static ota_stats_t otaStats = {0};
+
+static void otaStart(size_t size)
+{
+  memset(&otaStats, 0, sizeof(otaStats));
+  otaStats.size  = size;
+  otaStats.start = millis();
+  otaStats.frame = strip.getFrameCount();
+  otaStats.state = OTA_RUNNING;
+  strip.setFpsLimit(WLED_OTA_FPS);
+}
+
+static void otaFinish(bool ok)
+{
+  otaStats.duration = millis() - otaStats.start;
+  otaStats.frame    = strip.getFrameCount() - otaStats.frame; // frames shown during update
+  otaStats.state    = ok ? OTA_DONE : OTA_FAILED;
+  DEBUG_PRINTF("OTA %s: %u bytes in %lu ms, %u frames.\n", ok ? "done" : "failed", otaStats.written, (unsigned long)otaStats.duration, otaStats.frame);
+  if (!ok) strip.setFpsLimit(0); // device reboots with the new firmware otherwise
+}
+
+static bool otaWrite(uint8_t *data, size_t len)
+{
+  uint32_t t = millis();
+  size_t n = Update.write(data, len);
+  t = millis() - t;
+  if (t > otaStats.maxWriteMs) otaStats.maxWriteMs = MIN(t, (uint32_t)UINT16_MAX);
+  otaStats.written += n;
+  return n == len && !Update.hasError();
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+#include "freertos/stream_buffer.h"
+
+static StreamBufferHandle_t otaBuffer = nullptr;
+static SemaphoreHandle_t    otaDone   = nullptr;
+static volatile bool        otaFinal  = false; // all data is in the buffer
+static volatile bool        otaOk     = false;
+
+static void otaWriterTask(void *)
+{
+  uint8_t *chunk = (uint8_t*) heapMalloc(HEAP_TAG_OTHER, OTA_CHUNK);
+  bool ok = chunk;
+  uint32_t last = millis();
+  for (;;) {
+    size_t n = chunk ? xStreamBufferReceive(otaBuffer, chunk, OTA_CHUNK, pdMS_TO_TICKS(50)) : 0;
+    if (!n) {
+      if (otaFinal && xStreamBufferIsEmpty(otaBuffer)) break;
+      if (!chunk || millis() - last > OTA_DATA_TIMEOUT) { ok = false; break; } // upload was aborted
+      continue;
+    }
+    last = millis();
+    if (ok && !otaWrite(chunk, n)) ok = false; // keep draining so the upload handler does not block
+    if (!ok) continue;
+    // let loop() show a frame before the next write stalls it again
+    uint32_t f = strip.getFrameCount(), t = millis();
+    while (strip.getFrameCount() == f && millis() - t < 1000/WLED_OTA_FPS) vTaskDelay(1);
+  }
+  heapFree(HEAP_TAG_OTHER, chunk, OTA_CHUNK);
+  if (!ok) Update.abort();
+  otaOk = ok && Update.end(true);
+  DEBUG_PRINTLN(otaOk ? F("Update Success") : F("Update Failed"));
+  otaFinish(otaOk);
+  SemaphoreHandle_t done = otaDone;
+  xSemaphoreGive(done);
+  vTaskDelete(nullptr);
+}
+
+bool otaStreamBegin(size_t size)
+{
+  if (otaStats.state == OTA_RUNNING) return false; // one update at a time
+  if (!otaBuffer) otaBuffer = xStreamBufferCreate(OTA_BUFFER, OTA_CHUNK); // kept, upload may be retried
+  if (!otaDone)   otaDone   = xSemaphoreCreateBinary();
+  if (!otaBuffer || !otaDone) return false;
+  xStreamBufferReset(otaBuffer);
+  xSemaphoreTake(otaDone, 0);
+  otaFinal = otaOk = false;
+  otaStart(size);
+  if (!Update.begin((ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000)
+   || xTaskCreate(otaWriterTask, "OTAwrite", 4096, nullptr, 1, nullptr) != pdPASS) {
+    Update.abort();
+    otaFinish(false);
+    return false;
+  }
+  return true;
+}
+
+bool otaStreamWrite(const uint8_t *data, size_t len)
+{
+  if (otaStats.state != OTA_RUNNING || otaFinal) return false;
+  size_t n = xStreamBufferSend(otaBuffer, data, len, pdMS_TO_TICKS(OTA_SEND_TIMEOUT)); // blocks while writer is behind
+  otaStats.received += n;
+  return n == len;
+}
+
+// waits until the writer task has written all data
+bool otaStreamEnd()
+{
+  if (otaStats.state != OTA_RUNNING) return otaStats.state == OTA_DONE;
+  otaFinal = true;
+  xSemaphoreTake(otaDone, portMAX_DELAY);
+  return otaOk;
+}
+
+#else
+
+bool otaStreamBegin(size_t size)
+{
+  otaStart(size);
+  Update.runAsync(true);
+  if (!Update.begin((ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000)) { otaFinish(false); return false; }
+  return true;
+}
+
+bool otaStreamWrite(const uint8_t *data, size_t len)
+{
+  if (otaStats.state != OTA_RUNNING) return false;
+  otaStats.received += len;
+  if (otaWrite(const_cast<uint8_t*>(data), len)) return true;
+  otaFinish(false);
+  return false;
+}
+
+bool otaStreamEnd()
+{
+  if (otaStats.state != OTA_RUNNING) return otaStats.state == OTA_DONE;
+  bool ok = Update.end(true);
+  DEBUG_PRINTLN(ok ? F("Update Success") : F("Update Failed"));
+  otaFinish(ok);
+  return ok;
+}
+
+#endif
+
+const ota_stats_t& getOTAStats()
+{
+  if (otaStats.state == OTA_RUNNING) otaStats.duration = millis() - otaStats.start;
+  return otaStats;
+}
+
+#endif
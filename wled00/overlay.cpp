@@ -2,6 +2,8 @@
 
 /*
  * Used to draw clock overlays over the strip
+ * The clock is drawn into the overlay layer of the strip (composited in strip.show()) and only redrawn when
+ * its content changes, i.e. once a second, not for every frame.
  */
 
 void _overlayAnalogClock()
@@ -25,11 +27,11 @@ void _overlayAnalogClock()
   {
     if (secondPixel < analogClock12pixel)
     {
-      strip.setRange(analogClock12pixel, overlayMax, 0xFF0000);
-      strip.setRange(overlayMin, secondPixel, 0xFF0000);
+      strip.setOverlayRange(analogClock12pixel, overlayMax, 0xFF0000);
+      strip.setOverlayRange(overlayMin, secondPixel, 0xFF0000);
     } else
     {
-      strip.setRange(analogClock12pixel, secondPixel, 0xFF0000);
+      strip.setOverlayRange(analogClock12pixel, secondPixel, 0xFF0000);
     }
   }
   if (analogClock5MinuteMarks)
@@ -38,12 +40,12 @@ void _overlayAnalogClock()
     {
       int pix = analogClock12pixel + roundf((overlaySize / 12.0f) *i);
       if (pix > overlayMax) pix -= overlaySize;
-      strip.setPixelColor(pix, 0x00FFAA);
+      strip.setOverlayPixel(pix, 0x00FFAA);
     }
   }
-  if (!analogClockSecondsTrail) strip.setPixelColor(secondPixel, 0xFF0000);
-  strip.setPixelColor(minutePixel, 0x00FF00);
-  strip.setPixelColor(hourPixel, 0x0000FF);
+  if (!analogClockSecondsTrail) strip.setOverlayPixel(secondPixel, 0xFF0000);
+  strip.setOverlayPixel(minutePixel, 0x00FF00);
+  strip.setOverlayPixel(hourPixel, 0x0000FF);
 }
 
 
@@ -78,17 +80,34 @@ void _overlayAnalogCountdown()
     byte pixelCnt = perc*overlaySize;
     if (analogClock12pixel + pixelCnt > overlayMax)
     {
-      strip.setRange(analogClock12pixel, overlayMax, ((uint32_t)colSec[3] << 24)| ((uint32_t)colSec[0] << 16) | ((uint32_t)colSec[1] << 8) | colSec[2]);
-      strip.setRange(overlayMin, overlayMin +pixelCnt -(1+ overlayMax -analogClock12pixel), ((uint32_t)colSec[3] << 24)| ((uint32_t)colSec[0] << 16) | ((uint32_t)colSec[1] << 8) | colSec[2]);
+      strip.setOverlayRange(analogClock12pixel, overlayMax, ((uint32_t)colSec[3] << 24)| ((uint32_t)colSec[0] << 16) | ((uint32_t)colSec[1] << 8) | colSec[2]);
+      strip.setOverlayRange(overlayMin, overlayMin +pixelCnt -(1+ overlayMax -analogClock12pixel), ((uint32_t)colSec[3] << 24)| ((uint32_t)colSec[0] << 16) | ((uint32_t)colSec[1] << 8) | colSec[2]);
     } else
     {
-      strip.setRange(analogClock12pixel, analogClock12pixel + pixelCnt, ((uint32_t)colSec[3] << 24)| ((uint32_t)colSec[0] << 16) | ((uint32_t)colSec[1] << 8) | colSec[2]);
+      strip.setOverlayRange(analogClock12pixel, analogClock12pixel + pixelCnt, ((uint32_t)colSec[3] << 24)| ((uint32_t)colSec[0] << 16) | ((uint32_t)colSec[1] << 8) | colSec[2]);
     }
   }
 }
 
+// everything the analog clock/countdown depends on
+static uint32_t _overlayAnalogClockKey()
+{
+  uint32_t v[] = {
+    (uint32_t)(countdownMode ? toki.second() : localTime), (uint32_t)countdownTime,
+    (uint32_t)overlayMin | (uint32_t)overlayMax << 16, analogClock12pixel,
+    (uint32_t)countdownMode | (uint32_t)analogClockSecondsTrail << 1 | (uint32_t)analogClock5MinuteMarks << 2,
+    RGBW32(colSec[0], colSec[1], colSec[2], colSec[3])
+  };
+  return fnv1a(v, sizeof(v)) | 1; // 0 means "no overlay"
+}
+
 void handleOverlayDraw() {
-  usermods.handleOverlayDraw();
+  static uint32_t overlayKey = 0; // content of overlay layer
+  usermods.handleOverlayDraw(); // usermods still draw into each frame (or use the overlay layer themselves)
+  uint32_t key = overlayCurrent == 1 ? _overlayAnalogClockKey() : 0;
+  if (key == overlayKey) return; // overlay layer is still valid
+  overlayKey = key;
+  strip.clearOverlay();
   if (overlayCurrent == 1) _overlayAnalogClock();
 }
 
@@ -34,6 +34,7 @@ bool PinManagerClass::deallocatePin(byte gpio, PinOwner tag)
 
   byte by = gpio >> 3;
   byte bi = gpio - 8*by;
+  detachEvent(gpio, ownerTag[gpio]);
   bitWrite(pinAlloc[by], bi, false);
   ownerTag[gpio] = PinOwner::None;
   return true;
@@ -322,4 +323,112 @@ void PinManagerClass::deallocateLedc(byte pos, byte channels)
 }
 #endif
 
+/// GPIO edge events
+#define PIN_EVENT_QUEUE 32  // must be a power of 2
+
+static struct PinEventSub {
+  pin_event_cb     cb;
+  void            *arg;
+  uint32_t         lastUs;    // time of last delivered event
+  uint16_t         debounce;  // ms
+  int8_t           gpio;
+  PinOwner         tag;
+  volatile uint8_t isrLevel;  // last level seen by the ISR
+  uint8_t          level;     // last delivered level
+  bool             pending;   // level may have changed during debounce time or queue overflow
+} pinEvSub[WLED_PIN_EVENT_SLOTS];
+
+static struct {
+  uint32_t us;
+  int8_t   gpio;
+  uint8_t  slot;
+  uint8_t  level;
+} pinEvQueue[PIN_EVENT_QUEUE];
+static volatile uint8_t pinEvHead = 0, pinEvTail = 0; // written by ISR resp. loop only
+static volatile bool    pinEvOverflow = false;
+
+static void IRAM_ATTR pinEventISR(void *arg)
+{
+  uint8_t s = (uintptr_t)arg;
+  uint8_t level = digitalRead(pinEvSub[s].gpio);
+  if (level == pinEvSub[s].isrLevel) return; // bounced back already
+  pinEvSub[s].isrLevel = level;
+  uint8_t next = (pinEvHead + 1) & (PIN_EVENT_QUEUE-1);
+  if (next == pinEvTail) { pinEvOverflow = true; return; }
+  pinEvQueue[pinEvHead].us    = micros();
+  pinEvQueue[pinEvHead].gpio  = pinEvSub[s].gpio;
+  pinEvQueue[pinEvHead].slot  = s;
+  pinEvQueue[pinEvHead].level = level;
+  pinEvHead = next;
+}
+
+static void deliverPinEvent(PinEventSub &p, uint8_t level, uint32_t us)
+{
+  if (p.debounce && us - p.lastUs < p.debounce * 1000U) { p.pending = true; return; }
+  p.pending = false;
+  if (level == p.level) return;
+  p.level  = level;
+  p.lastUs = us;
+  p.cb(p.gpio, level, us, p.arg);
+}
+
+bool PinManagerClass::attachEvent(byte gpio, PinOwner tag, pin_event_cb cb, void *arg, uint16_t debounceMs)
+{
+  if (!cb || gpio >= WLED_NUM_PINS || tag == PinOwner::None || !isPinAllocated(gpio, tag)) return false;
+  detachEvent(gpio, tag);
+  for (size_t s = 0; s < WLED_PIN_EVENT_SLOTS; s++) {
+    PinEventSub &p = pinEvSub[s];
+    if (p.cb) continue;
+    p.gpio     = gpio;
+    p.tag      = tag;
+    p.arg      = arg;
+    p.debounce = debounceMs;
+    p.level    = p.isrLevel = digitalRead(gpio);
+    p.lastUs   = micros() - debounceMs * 1000U;
+    p.pending  = false;
+    p.cb       = cb;
+    attachInterruptArg(gpio, pinEventISR, (void*)(uintptr_t)s, CHANGE);
+    DEBUG_PRINTF("PIN EVENT: IO %d attached (slot %d).\n", (int)gpio, (int)s);
+    return true;
+  }
+  DEBUG_PRINTLN(F("PIN EVENT: no free slot."));
+  return false;
+}
+
+void PinManagerClass::detachEvent(byte gpio, PinOwner tag)
+{
+  for (size_t s = 0; s < WLED_PIN_EVENT_SLOTS; s++) {
+    PinEventSub &p = pinEvSub[s];
+    if (!p.cb || p.gpio != gpio || p.tag != tag) continue;
+    detachInterrupt(gpio);
+    p.cb = nullptr;
+    p.gpio = -1;
+  }
+}
+
+void PinManagerClass::handleEvents()
+{
+  while (pinEvTail != pinEvHead) {
+    uint8_t t = pinEvTail;
+    PinEventSub &p = pinEvSub[pinEvQueue[t].slot];
+    // events of a detached (or re-used) slot are dropped
+    if (p.cb && p.gpio == pinEvQueue[t].gpio) deliverPinEvent(p, pinEvQueue[t].level, pinEvQueue[t].us);
+    pinEvTail = (t + 1) & (PIN_EVENT_QUEUE-1);
+  }
+  bool overflow = pinEvOverflow;
+  if (overflow) {
+    pinEvOverflow = false;
+    DEBUG_PRINTLN(F("PIN EVENT: queue overflow."));
+  }
+  // deliver levels that settled after the debounce time (or got lost in overflow)
+  for (size_t s = 0; s < WLED_PIN_EVENT_SLOTS; s++) {
+    PinEventSub &p = pinEvSub[s];
+    if (!p.cb || !(p.pending || overflow)) continue;
+    uint32_t now = micros();
+    if (now - p.lastUs < p.debounce * 1000U) continue;
+    p.isrLevel = digitalRead(p.gpio);
+    deliverPinEvent(p, p.isrLevel, now);
+  }
+}
+
 PinManagerClass pinManager = PinManagerClass();
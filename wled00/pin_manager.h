@@ -35,6 +35,7 @@ enum struct PinOwner : uint8_t {
   DMX           = 0x8A,   // 'DMX'  == hard-coded to IO2
   HW_I2C        = 0x8B,   // 'I2C'  == hardware I2C pins (4&5 on ESP8266, 21&22 on ESP32)
   HW_SPI        = 0x8C,   // 'SPI'  == hardware (V)SPI pins (13,14&15 on ESP8266, 5,18&23 on ESP32)
+  DMXInput      = 0x8D,   // 'DMXi' == wired DMX input from configuration
   // Use UserMod IDs from const.h here
   UM_Unspecified       = USERMOD_ID_UNSPECIFIED,        // 0x01
   UM_Example           = USERMOD_ID_EXAMPLE,            // 0x02 // Usermod "usermod_v2_example.h"
@@ -65,6 +66,17 @@ enum struct PinOwner : uint8_t {
 };
 static_assert(0u == static_cast<uint8_t>(PinOwner::None), "PinOwner::None must be zero, so default array initialization works as expected");
 
+/*
+ * GPIO edge events: level changes are captured in an ISR (with a micros() time stamp) and
+ * delivered from the main loop (PinManagerClass::handleEvents()), so callbacks may use any WLED API.
+ * Edges within the debounce time after a delivered one are folded into a single event
+ * carrying the settled level once the debounce time has passed.
+ */
+typedef void (*pin_event_cb)(uint8_t gpio, bool level, uint32_t us, void *arg);
+#ifndef WLED_PIN_EVENT_SLOTS
+  #define WLED_PIN_EVENT_SLOTS 8  // max. number of pins with event subscriptions
+#endif
+
 class PinManagerClass {
   private:
   #ifdef ESP8266
@@ -114,6 +126,13 @@ class PinManagerClass {
 
   PinOwner getPinOwner(byte gpio);
 
+  // Subscribes to level changes of an input pin allocated by the same owner (pin mode has to be set before).
+  // Returns false if the pin is not owned by tag or all event slots are in use (fall back to polling).
+  bool attachEvent(byte gpio, PinOwner tag, pin_event_cb cb, void *arg = nullptr, uint16_t debounceMs = 0);
+  void detachEvent(byte gpio, PinOwner tag); // also done by deallocatePin()
+  // delivers queued pin events, called from the main loop
+  void handleEvents();
+
   #ifdef ARDUINO_ARCH_ESP32
   byte allocateLedc(byte channels);
   void deallocateLedc(byte pos, byte channels);
@@ -2,8 +2,19 @@
 
 /*
  * Handles playlists, timed sequences of presets
+ * Entries are not kept in RAM: loadPlaylist() converts them into a small binary file (5 bytes per entry,
+ * rewritten only if it differs) and the playlist reads the one entry it needs when stepping, so memory
+ * use does not depend on the playlist length. Shuffling walks a seeded permutation of the entry indices
+ * instead of reordering the entries.
  */
 
+#define PL_FILE_VERSION 1
+#define PL_HEADER_LEN   10
+#define PL_ENTRY_LEN    5
+#define PL_CHUNK        16 // entries encoded per file write
+
+static const char s_playlistFile[] PROGMEM = "/playlist.bin";
+
 typedef struct PlaylistEntry {
   uint8_t preset; //ID of the preset to apply
   uint16_t dur;   //Duration of the entry (in tenths of seconds)
@@ -14,10 +25,13 @@ byte           playlistRepeat = 1;        //how many times to repeat the playlis
 byte           playlistEndPreset = 0;     //what preset to apply after playlist end (0 = stay on last preset)
 byte           playlistOptions = 0;       //bit 0: shuffle playlist after each iteration. bits 1-7 TBD
 
-PlaylistEntry *playlistEntries = nullptr;
-byte           playlistLen;               //number of playlist entries
-int8_t         playlistIndex = -1;
+uint16_t       playlistLen = 0;           //number of playlist entries
+int32_t        playlistIndex = -1;        //position in the (shuffled) order
 uint16_t       playlistEntryDur = 0;      //duration of the current entry in tenths of seconds
+static uint32_t playlistSeed = 0;          //permutation of the current iteration, 0 = playlist order
+static uint32_t playlistSeedNext = 0;      //permutation of the next iteration
+static bool    playlistPrefetched = false; //next entry's preset is already in the preset cache
+static bool    playlistShuffled = false;   //shuffled ahead of roll-over to know the next preset
 
 //values we need to keep about the parent playlist while inside sub-playlist
 //int8_t         parentPlaylistIndex = -1;
@@ -25,30 +39,118 @@ uint16_t       playlistEntryDur = 0;      //duration of the current entry in ten
 //byte           parentPlaylistPresetId = 0; //for re-loading
 
 
-void shufflePlaylist() {
-  int currentIndex = playlistLen;
-  PlaylistEntry temporaryValue;
+// file layout: 'W','P','L',version, entries (uint16), FNV-1a hash of the entries (uint32), then per entry
+// preset, duration (uint16), transition (uint16), all little endian
+static File openPlaylistFile(const char *mode) {
+  char fileName[16];
+  strcpy_P(fileName, s_playlistFile);
+  return WLED_FS.open(fileName, mode);
+}
+
+static bool readPlaylistEntry(File &f, uint16_t n, PlaylistEntry &e) {
+  uint8_t b[PL_ENTRY_LEN];
+  if (!f.seek(PL_HEADER_LEN + (size_t)n * PL_ENTRY_LEN) || f.read(b, PL_ENTRY_LEN) != PL_ENTRY_LEN) return false;
+  e.preset = b[0];
+  e.dur    = b[1] | (b[2] << 8);
+  e.tr     = b[3] | (b[4] << 8);
+  return true;
+}
+
+static bool readPlaylistEntry(uint16_t n, PlaylistEntry &e) {
+  if (n >= playlistLen) return false;
+  File f = openPlaylistFile("r");
+  if (!f) return false;
+  bool ok = readPlaylistEntry(f, n, e);
+  f.close();
+  return ok;
+}
+
+// encodes the entries of a playlist object, "dur" and "transition" may be arrays (last value repeats) or single values
+// returns hash of the encoded entries, writes them to f if given (bytes written are added to *written)
+static uint32_t encodePlaylist(JsonObject playlistObj, uint16_t len, File *f = nullptr, size_t *written = nullptr) {
+  JsonArray presets   = playlistObj["ps"];
+  JsonArray durations = playlistObj["dur"];
+  JsonArray tr        = playlistObj[F("transition")];
+  uint16_t dur        = durations.isNull() ? playlistObj["dur"] | 100 : 100; //10 seconds as fallback
+  uint16_t transition = tr.isNull() ? playlistObj[F("transition")] | (transitionDelay / 100) : (transitionDelay / 100);
+  JsonArray::iterator d = durations.begin(), t = tr.begin();
+
+  uint32_t hash = FNV1A_SEED;
+  uint8_t buf[PL_CHUNK * PL_ENTRY_LEN];
+  size_t n = 0;
+  uint16_t it = 0;
+  for (int ps : presets) {
+    if (it++ >= len) break;
+    if (d != durations.end()) { int v = (*d).as<int>(); dur = (v > 1) ? v : 100; ++d; }
+    if (t != tr.end()) { transition = (*t).as<uint16_t>(); ++t; }
+    uint8_t *e = buf + n;
+    e[0] = ps;
+    e[1] = dur & 0xFF;        e[2] = dur >> 8;
+    e[3] = transition & 0xFF; e[4] = transition >> 8;
+    hash = fnv1a(e, PL_ENTRY_LEN, hash);
+    n += PL_ENTRY_LEN;
+    if (n == sizeof(buf) || it == len) {
+      if (f) *written += f->write(buf, n);
+      n = 0;
+    }
+  }
+  return hash;
+}
 
-  // While there remain elements to shuffle...
-  while (currentIndex--) {
-    // Pick a random element...
-    int randomIndex = random(0, currentIndex);
-    // And swap it with the current element.
-    temporaryValue = playlistEntries[currentIndex];
-    playlistEntries[currentIndex] = playlistEntries[randomIndex];
-    playlistEntries[randomIndex] = temporaryValue;
+// stores the entries, the file is left alone if it already holds them (spare the flash)
+static bool writePlaylistFile(JsonObject playlistObj, uint16_t len) {
+  const uint32_t hash = encodePlaylist(playlistObj, len);
+  uint8_t h[PL_HEADER_LEN] = {'W', 'P', 'L', PL_FILE_VERSION, uint8_t(len & 0xFF), uint8_t(len >> 8),
+                              uint8_t(hash & 0xFF), uint8_t(hash >> 8), uint8_t(hash >> 16), uint8_t(hash >> 24)};
+  const size_t size = PL_HEADER_LEN + (size_t)len * PL_ENTRY_LEN;
+  File f = openPlaylistFile("r");
+  if (f) {
+    uint8_t old[PL_HEADER_LEN];
+    bool same = f.size() == size && f.read(old, PL_HEADER_LEN) == PL_HEADER_LEN && !memcmp(old, h, PL_HEADER_LEN);
+    f.close();
+    if (same) return true;
   }
+  f = openPlaylistFile("w");
+  if (!f) return false;
+  size_t written = f.write(h, PL_HEADER_LEN);
+  encodePlaylist(playlistObj, len, &f, &written);
+  f.close();
+  DEBUG_PRINTF("Playlist stored (%u entries).\n", len);
+  return written == size;
+}
+
+// seeded permutation of the entry indices: a 4 round Feistel network on the smallest even power of 2 that holds
+// the playlist, indices outside the playlist are encrypted again until they fall into it (cycle walking)
+static uint16_t permuteIndex(uint16_t n, uint32_t seed) {
+  if (!seed || playlistLen < 2) return n;
+  unsigned half = 1;
+  while ((1UL << (2*half)) < playlistLen) half++;
+  const uint32_t mask = (1UL << half) - 1;
+  uint32_t i = n;
+  do {
+    uint32_t l = i >> half, r = i & mask;
+    for (unsigned k = 0; k < 4; k++) {
+      uint32_t x = (r + k) * 0x9E3779B1UL ^ seed;
+      x ^= x >> 15; x *= 0x2C1B3C6DUL; x ^= x >> 12;
+      uint32_t tmp = l ^ (x & mask);
+      l = r; r = tmp;
+    }
+    i = (l << half) | r;
+  } while (i >= playlistLen);
+  return i;
+}
+
+static uint32_t shuffleSeed() {
   DEBUG_PRINTLN(F("Playlist shuffle."));
+  return random(1, INT32_MAX);
 }
 
 
 void unloadPlaylist() {
-  if (playlistEntries != nullptr) {
-    delete[] playlistEntries;
-    playlistEntries = nullptr;
-  }
   currentPlaylist = playlistIndex = -1;
   playlistLen = playlistEntryDur = playlistOptions = 0;
+  playlistSeed = playlistSeedNext = 0;
+  playlistPrefetched = playlistShuffled = false;
   DEBUG_PRINTLN(F("Playlist unloaded."));
 }
 
@@ -57,47 +159,11 @@ int16_t loadPlaylist(JsonObject playlistObj, byte presetId) {
   unloadPlaylist();
 
   JsonArray presets = playlistObj["ps"];
-  playlistLen = presets.size();
-  if (playlistLen == 0) return -1;
-  if (playlistLen > 100) playlistLen = 100;
-
-  playlistEntries = new PlaylistEntry[playlistLen];
-  if (playlistEntries == nullptr) return -1;
-
-  byte it = 0;
-  for (int ps : presets) {
-    if (it >= playlistLen) break;
-    playlistEntries[it].preset = ps;
-    it++;
-  }
-
-  it = 0;
-  JsonArray durations = playlistObj["dur"];
-  if (durations.isNull()) {
-    playlistEntries[0].dur = playlistObj["dur"] | 100; //10 seconds as fallback
-    it = 1;
-  } else {
-    for (int dur : durations) {
-      if (it >= playlistLen) break;
-      playlistEntries[it].dur = (dur > 1) ? dur : 100;
-      it++;
-    }
-  }
-  for (int i = it; i < playlistLen; i++) playlistEntries[i].dur = playlistEntries[it -1].dur;
-
-  it = 0;
-  JsonArray tr = playlistObj[F("transition")];
-  if (tr.isNull()) {
-    playlistEntries[0].tr = playlistObj[F("transition")] | (transitionDelay / 100);
-    it = 1;
-  } else {
-    for (int transition : tr) {
-      if (it >= playlistLen) break;
-      playlistEntries[it].tr = transition;
-      it++;
-    }
-  }
-  for (int i = it; i < playlistLen; i++) playlistEntries[i].tr = playlistEntries[it -1].tr;
+  uint16_t len = min(presets.size(), (size_t)UINT16_MAX);
+  if (len == 0) return -1;
+  // may run in the web server task: the loop does not step the playlist while it is unloaded and the JSON buffer is held
+  if (!writePlaylistFile(playlistObj, len)) return -1;
+  playlistLen = len;
 
   int rep = playlistObj[F("repeat")];
   bool shuffle = false;
@@ -120,10 +186,35 @@ int16_t loadPlaylist(JsonObject playlistObj, byte presetId) {
 }
 
 
+// preset the playlist will apply next (shuffles ahead of time if the next step is a roll-over), 0 if none
+static byte nextPlaylistPreset() {
+  int32_t next = (playlistIndex + 1) % playlistLen;
+  uint32_t seed = playlistSeed;
+  if (next == 0) {
+    if (playlistRepeat == 1) return playlistEndPreset;
+    if (playlistOptions & PL_OPTION_SHUFFLE) {
+      if (!playlistShuffled) playlistSeedNext = shuffleSeed();
+      playlistShuffled = true;
+      seed = playlistSeedNext;
+    }
+  }
+  PlaylistEntry e;
+  return readPlaylistEntry(permuteIndex(next, seed), e) ? e.preset : 0;
+}
+
+
 void handlePlaylist() {
   static unsigned long presetCycledTime = 0;
   // if fileDoc is not null JSON buffer is in use so just quit
-  if (currentPlaylist < 0 || playlistEntries == nullptr || fileDoc != nullptr) return;
+  if (currentPlaylist < 0 || playlistLen == 0 || fileDoc != nullptr) return;
+
+  // well ahead of the end of the entry (but not right after applying it) load the next preset into RAM,
+  // so the step itself does not have to read and parse presets.json
+  // done from the loop as file access is not thread safe (shared file handle in file.cpp)
+  unsigned long elapsed = millis() - presetCycledTime;
+  if (!playlistPrefetched && playlistIndex >= 0 && elapsed > min(1000UL, 50UL*playlistEntryDur)) {
+    playlistPrefetched = prefetchPreset(nextPlaylistPreset()) || elapsed > 100UL*playlistEntryDur / 2 + 1000; // retry a while if buffers are busy
+  }
 
   if (millis() - presetCycledTime > (100*playlistEntryDur)) {
     presetCycledTime = millis();
@@ -140,17 +231,27 @@ void handlePlaylist() {
       }
       if (playlistRepeat > 1) playlistRepeat--; // decrease repeat count on each index reset if not an endless playlist
       // playlistRepeat == 0: endless loop
-      if (playlistOptions & PL_OPTION_SHUFFLE) shufflePlaylist(); // shuffle playlist and start over
+      if (playlistOptions & PL_OPTION_SHUFFLE) { // shuffle playlist and start over
+        playlistSeed = playlistShuffled ? playlistSeedNext : shuffleSeed();
+      }
+      playlistShuffled = false;
     }
 
+    PlaylistEntry e;
+    if (!readPlaylistEntry(permuteIndex(playlistIndex, playlistSeed), e)) { // playlist.bin deleted or replaced
+      unloadPlaylist();
+      return;
+    }
     jsonTransitionOnce = true;
-    strip.setTransition(fadeTransition ? playlistEntries[playlistIndex].tr * 100 : 0);
-    playlistEntryDur = playlistEntries[playlistIndex].dur;
-    applyPreset(playlistEntries[playlistIndex].preset);
+    strip.setTransition(fadeTransition ? e.tr * 100 : 0);
+    playlistEntryDur = e.dur;
+    playlistPrefetched = false;
+    applyPreset(e.preset);
   }
 }
 
 
+// entries are read back in playlist order (not the shuffled one)
 void serializePlaylist(JsonObject sObj) {
   JsonObject playlist = sObj.createNestedObject(F("playlist"));
   JsonArray ps = playlist.createNestedArray("ps");
@@ -159,9 +260,14 @@ void serializePlaylist(JsonObject sObj) {
   playlist[F("repeat")] = (playlistIndex < 0 && playlistRepeat > 0) ? playlistRepeat - 1 : playlistRepeat; // remove added repetition count (if not yet running)
   playlist["end"] = playlistEndPreset;
   playlist["r"] = playlistOptions & PL_OPTION_SHUFFLE;
-  for (int i=0; i<playlistLen; i++) {
-    ps.add(playlistEntries[i].preset);
-    dur.add(playlistEntries[i].dur);
-    transition.add(playlistEntries[i].tr);
+  if (!playlistLen) return;
+  File f = openPlaylistFile("r");
+  if (!f) return;
+  PlaylistEntry e;
+  for (unsigned i = 0; i < playlistLen && readPlaylistEntry(f, i, e); i++) {
+    ps.add(e.preset);
+    dur.add(e.dur);
+    transition.add(e.tr);
   }
+  f.close();
 }
@@ -16,15 +16,196 @@ static char quickLoad[9];
 static char saveName[33];
 static bool includeBri = true, segBounds = true, selectedOnly = false, playlistSave = false;;
 
+// LRU cache of recently applied presets (serialized JSON as read from presets.json)
+// so playlists cycling through a few presets don't hit the filesystem on every step
+#ifndef WLED_PRESET_CACHE_SIZE
+  #ifdef ESP8266
+    #define WLED_PRESET_CACHE_SIZE    4   // entries, 0 to disable
+    #define WLED_PRESET_CACHE_BYTES   2048
+  #else
+    #define WLED_PRESET_CACHE_SIZE    16
+    #define WLED_PRESET_CACHE_BYTES   8192
+  #endif
+#endif
+#ifndef WLED_PRESET_CACHE_BYTES
+  #define WLED_PRESET_CACHE_BYTES     4096
+#endif
+#ifndef WLED_PRESET_CACHE_PSRAM
+  #define WLED_PRESET_CACHE_PSRAM     65536 // byte limit if PSRAM is used
+#endif
+
+#ifndef WLED_PRESET_PAGE_SIZE
+  #ifdef ESP8266
+    #define WLED_PRESET_PAGE_SIZE     16  // presets per /json/presets page
+  #else
+    #define WLED_PRESET_PAGE_SIZE     32
+  #endif
+#endif
+
+#if WLED_PRESET_CACHE_SIZE > 0
+typedef struct PresetCacheEntry {
+  char     *json;   // nullptr: slot unused
+  uint16_t len;
+  uint8_t  id;
+  uint32_t used;    // LRU tick
+} preset_cache_entry_t;
+
+static preset_cache_entry_t presetCache[WLED_PRESET_CACHE_SIZE] = {0};
+static size_t   presetCacheBytes = 0;
+static uint32_t presetCacheTick = 0;
+
+static size_t presetCacheLimit() {
+  #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM) && defined(WLED_USE_PSRAM)
+  if (psramFound()) return WLED_PRESET_CACHE_PSRAM;
+  #endif
+  return WLED_PRESET_CACHE_BYTES;
+}
+
+static void presetCacheDrop(preset_cache_entry_t &e) {
+  if (!e.json) return;
+  free(e.json);
+  presetCacheBytes -= e.len + 1;
+  e.json = nullptr;
+}
+
+static const char *presetCacheGet(uint8_t id) {
+  for (size_t i = 0; i < WLED_PRESET_CACHE_SIZE; i++) {
+    if (presetCache[i].json && presetCache[i].id == id) {
+      presetCache[i].used = ++presetCacheTick;
+      return presetCache[i].json;
+    }
+  }
+  return nullptr;
+}
+
+static void presetCachePut(uint8_t id, JsonDocument *d) {
+  size_t len = measureJson(*d);
+  size_t limit = presetCacheLimit();
+  if (len + 1 > limit / 2 || len > UINT16_MAX) return; // a single preset must not flush the whole cache
+  invalidatePresetCache(id);
+  preset_cache_entry_t *slot = nullptr;
+  while (true) {
+    preset_cache_entry_t *lru = nullptr;
+    slot = nullptr;
+    for (size_t i = 0; i < WLED_PRESET_CACHE_SIZE; i++) {
+      if (!presetCache[i].json) { if (!slot) slot = &presetCache[i]; }
+      else if (!lru || presetCache[i].used < lru->used) lru = &presetCache[i];
+    }
+    if (slot && presetCacheBytes + len + 1 <= limit) break;
+    if (!lru) return;
+    presetCacheDrop(*lru); // evict least recently used
+  }
+  #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM) && defined(WLED_USE_PSRAM)
+  if (psramFound())
+    slot->json = (char*) ps_malloc(len + 1);
+  else
+  #endif
+    slot->json = (char*) malloc(len + 1);
+  if (!slot->json) return;
+  serializeJson(*d, slot->json, len + 1);
+  slot->len  = len;
+  slot->id   = id;
+  slot->used = ++presetCacheTick;
+  presetCacheBytes += len + 1;
+}
+
+// id 0 drops all presets (e.g. presets.json was replaced)
+void invalidatePresetCache(byte id) {
+  for (size_t i = 0; i < WLED_PRESET_CACHE_SIZE; i++) {
+    if (!id || presetCache[i].id == id) presetCacheDrop(presetCache[i]);
+  }
+}
+#else
+static inline const char *presetCacheGet(uint8_t id) { return nullptr; }
+static inline void presetCachePut(uint8_t id, JsonDocument *d) {}
+void invalidatePresetCache(byte id) {}
+#endif
+
 static const char *getFileName(bool persist = true) {
   return persist ? "/presets.json" : "/tmp.json";
 }
 
+#ifdef WLED_ENABLE_PRESETS_BIN
+// persistent presets live in presets.bin (MessagePack records, see file.cpp), presets.json is only an
+// import/export bridge: it is converted into presets.bin when uploaded (or on first boot) and regenerated
+// from presets.bin whenever it is requested and presets.bin changed since the last export
+static const char *s_presetsBin = "/presets.bin";
+static bool presetsImportPending = false;
+static uint32_t presetsExportedGen = UINT32_MAX; // presets.bin generation presets.json was exported from (unknown)
+
+static bool importPresets(unsigned timeout = 1000) {
+  JsonDocument *d = requestJSONBuffer(JSON_LOCK_PRESET_CONV, timeout);
+  if (!d) return false;
+  DEBUG_PRINTLN(F("Importing presets.json"));
+  WLED_FS.remove(s_presetsBin);
+  for (unsigned id = 1; id <= 250; id++) {
+    if (readObjectFromFileUsingId(getFileName(), id, d) && !d->isNull()) writeObjectToBinFile(s_presetsBin, id, d);
+  }
+  releaseJSONBuffer(d);
+  presetsImportPending = false;
+  presetsExportedGen = getBinFileGeneration(s_presetsBin); // presets.json has the same content
+  invalidatePresetCache();
+  return true;
+}
+
+void requestPresetsImport() {
+  presetsImportPending = true;
+}
+
+void exportPresets() {
+  if (presetsImportPending) return; // presets.json is newer
+  uint32_t gen = getBinFileGeneration(s_presetsBin);
+  if (gen == presetsExportedGen) return;
+  JsonDocument *d = requestJSONBuffer(JSON_LOCK_PRESET_CONV);
+  if (!d) return;
+  if (presetsExportedGen == UINT32_MAX && readObjectFromFileUsingId(getFileName(), 0, d) && (*d)["g"].is<uint32_t>())
+    presetsExportedGen = (*d)["g"]; // same as exported before reboot
+  if (gen != presetsExportedGen) {
+    DEBUG_PRINTLN(F("Exporting presets.json"));
+    if (doCloseFile) closeFile();
+    File jf = WLED_FS.open(getFileName(), "w");
+    if (jf) {
+      char key[24];
+      sprintf_P(key, PSTR("{\"0\":{\"g\":%u}"), (unsigned)gen); // dummy object 0 carries the generation
+      jf.print(key);
+      size_t pos = 0;
+      uint8_t id;
+      while ((id = readObjectFromBinFile(s_presetsBin, 0, d, &pos))) {
+        sprintf_P(key, PSTR(",\"%d\":"), id);
+        jf.print(key);
+        serializeJson(*d, jf);
+      }
+      jf.print('}');
+      jf.close();
+      invalidateFileIndex();
+      presetsExportedGen = gen;
+    }
+  }
+  releaseJSONBuffer(d);
+}
+#endif
+
+static bool loadPreset(bool persist, byte id, JsonDocument *d) {
+  #ifdef WLED_ENABLE_PRESETS_BIN
+  if (persist) return readObjectFromBinFile(s_presetsBin, id, d);
+  #endif
+  return readObjectFromFileUsingId(getFileName(persist), id, d);
+}
+
+static bool storePreset(bool persist, byte id, JsonDocument *d) {
+  #ifdef WLED_ENABLE_PRESETS_BIN
+  if (persist) {
+    if (presetsImportPending) importPresets(0); // don't lose not yet imported presets (buffer may be busy, we hold one)
+    return writeObjectToBinFile(s_presetsBin, id, d);
+  }
+  #endif
+  return writeObjectToFileUsingId(getFileName(persist), id, d);
+}
+
 static void doSaveState() {
   bool persist = (presetToSave < 251);
-  const char *filename = getFileName(persist);
 
-  if (!requestJSONBufferLock(10)) return; // will set fileDoc
+  if (!requestJSONBufferLock(JSON_LOCK_PRESET_SAVE)) return; // will set fileDoc
 
   initPresetsFile(); // just in case if someone deleted presets.json using /edit
   JsonObject sObj = doc.to<JsonObject>();
@@ -61,13 +242,16 @@ static void doSaveState() {
     if (tmpRAMbuffer!=nullptr) {
       serializeJson(*fileDoc, tmpRAMbuffer, len);
     } else {
-      writeObjectToFileUsingId(filename, presetToSave, fileDoc);
+      storePreset(persist, presetToSave, fileDoc);
     }
   } else
   #endif
-  writeObjectToFileUsingId(filename, presetToSave, fileDoc);
+  storePreset(persist, presetToSave, fileDoc);
 
-  if (persist) presetsModifiedTime = toki.second(); //unix time
+  if (persist) {
+    presetsModifiedTime = toki.second(); //unix time
+    invalidatePresetCache(presetToSave);
+  }
   releaseJSONBufferLock();
   updateFSInfo();
 
@@ -81,9 +265,9 @@ static void doSaveState() {
 
 bool getPresetName(byte index, String& name)
 {
-  if (!requestJSONBufferLock(9)) return false;
+  if (!requestJSONBufferLock(JSON_LOCK_PRESET_LOAD)) return false;
   bool presetExists = false;
-  if (readObjectFromFileUsingId(getFileName(), index, &doc))
+  if (loadPreset(true, index, &doc))
   {
     JsonObject fdo = doc.as<JsonObject>();
     if (fdo["n"]) {
@@ -95,8 +279,47 @@ bool getPresetName(byte index, String& name)
   return presetExists;
 }
 
+// content tag for ETags of presets.json and /json/presets, changes whenever presets are saved, deleted or uploaded
+uint32_t getPresetsTag()
+{
+  return presetsModifiedTime ? presetsModifiedTime : 1;
+}
+
+// full preset for /json/presets?id=, caller holds the JSON buffer lock
+bool readPreset(byte index, JsonDocument *dest)
+{
+  if (index == 0 || index > 250) return false;
+  return loadPreset(true, index, dest) && !dest->isNull();
+}
+
+// one page of the preset list for /json/presets?from=: id, name, quick load label and playlist flag of up to
+// WLED_PRESET_PAGE_SIZE presets with id >= from, in id order. Presets are read with a filter so their bodies
+// never need RAM. Journal must be flushed (and presets.json exported) before, caller holds the JSON buffer lock.
+// returns id to continue with, 0 if this was the last page
+byte serializePresetList(JsonArray list, byte from)
+{
+  StaticJsonDocument<128> filter;
+  filter["n"]  = true;
+  filter["ql"] = true;
+  filter[F("playlist")][F("end")] = true; // only presence matters, not the (possibly long) list of presets
+  StaticJsonDocument<256> meta;
+  int16_t id = MAX(from, 1);
+  for (unsigned count = 0; (id = readNextObjectFromFile(getFileName(), id, &meta, &filter)) > 0 && id <= 250; id++) {
+    if (count++ == WLED_PRESET_PAGE_SIZE) return id;
+    JsonObject p = list.createNestedObject();
+    p["id"] = id;
+    p["n"]  = meta["n"]; // copies the string, meta is reused
+    if (!meta["ql"].isNull()) p["ql"] = meta["ql"];
+    if (meta.containsKey(F("playlist"))) p[F("pl")] = true;
+  }
+  return 0;
+}
+
 void initPresetsFile()
 {
+  #ifdef WLED_ENABLE_PRESETS_BIN
+  if (!WLED_FS.exists(s_presetsBin) && WLED_FS.exists(getFileName())) presetsImportPending = true; // first boot with presets.bin
+  #endif
   if (WLED_FS.exists(getFileName())) return;
 
   StaticJsonDocument<64> doc;
@@ -111,6 +334,145 @@ void initPresetsFile()
   f.close();
 }
 
+/*
+ * HTTP API presets ("win") are translated once after loading into the equivalent JSON state ("wj", kept next to
+ * "win" in the loaded document and the preset cache, presets.json is not changed) and applied by deserializeState()
+ * like JSON presets. Only commands with an exact JSON equivalent are translated (plain values, no '~' or random),
+ * presets using anything else store "wj":false and keep going through handleSet().
+ */
+#define WJ_A   0
+#define WJ_T   1
+#define WJ_SS  2
+#define WJ_FX  3  // FX..M3: segment values in the order of wjSegKeys
+#define WJ_M3  12
+#define WJ_R   13 // R,G,B,W,R2,G2,B2,W2
+#define WJ_SB  21 // SB..MI: segment options, only together with SS (handleSet() applies them to one segment)
+#define WJ_MI  24
+#define WJ_KEYS 25
+static const char wjKeys[WJ_KEYS][3] PROGMEM = {
+  "A","T","SS","FX","SX","IX","FP","X1","X2","X3","M1","M2","M3","R","G","B","W","R2","G2","B2","W2","SB","SW","RV","MI"
+};
+static const char wjSegKeys[][4] PROGMEM = {"fx","sx","ix","pal","c1","c2","c3","o1","o2","o3"};
+
+// plain decimal value 0-255 terminated by '&' or end of string, -1 otherwise
+static int wjNumber(const char *v) {
+  int n = 0, d = 0;
+  for (; *v && *v != '&'; v++, d++) {
+    if (*v < '0' || *v > '9' || d == 3) return -1;
+    n = n * 10 + *v - '0';
+  }
+  return (d && n < 256) ? n : -1;
+}
+
+static void wjColor(JsonArray col, unsigned slot, const byte *rgbw) {
+  while (col.size() <= slot) col.createNestedArray(); // empty arrays leave colors unchanged
+  JsonArray c = col[slot];
+  for (size_t i = 0; i < 4; i++) c.add(rgbw[i]);
+}
+
+static bool translateWin(const char *win, JsonObject wj) {
+  int val[WJ_KEYS];
+  const char *colStr[3] = {nullptr, nullptr, nullptr}; // CL, C2, C3
+  bool fxDef = false;
+  for (size_t i = 0; i < WJ_KEYS; i++) val[i] = -1;
+
+  for (const char *p = win; *p; ) {
+    if (*p == '&') { p++; continue; }
+    const char *k = p;
+    while (*p && *p != '=' && *p != '&') p++;
+    size_t len = p - k;
+    const char *v = (*p == '=') ? p + 1 : p;
+    while (*p && *p != '&') p++;
+    if ((len == 2 && !strncmp_P(k, PSTR("IN"), 2)) || (len == 2 && !strncmp_P(k, PSTR("NN"), 2))) continue; // no effect in presets
+    if (len == 3 && !strncmp_P(k, PSTR("FXD"), 3)) { fxDef = true; continue; }
+    if (len == 2 && (k[0] == 'C') && (k[1] == 'L' || k[1] == '2' || k[1] == '3')) {
+      unsigned slot = k[1] == 'L' ? 0 : k[1] - '1';
+      if (colStr[slot] || p - v < 1 || p - v > 10) return false;
+      colStr[slot] = v;
+      continue;
+    }
+    size_t id = 0;
+    while (id < WJ_KEYS && (len > 2 || strncmp_P(k, wjKeys[id], len) || pgm_read_byte(&wjKeys[id][len]))) id++;
+    if (id == WJ_KEYS || val[id] >= 0) return false; // unknown to the translation or repeated
+    if ((val[id] = wjNumber(v)) < 0) return false;
+  }
+
+  if (val[WJ_A] >= 0) wj["bri"] = val[WJ_A];
+  if (val[WJ_T] >= 0) {
+    if (val[WJ_T] > 1) {
+      if (val[WJ_A] >= 0) return false; // toggles after setting brightness, "on":"t" would not turn off
+      wj["on"] = "t";
+    } else wj["on"] = (bool)val[WJ_T];
+    wj.createNestedObject("nl")["on"] = false; // T= always ends nightlight
+  }
+
+  JsonObject seg = wj.createNestedObject("seg");
+  if (val[WJ_SS] >= 0) seg["id"] = val[WJ_SS];
+  if (val[WJ_FX] >= 0) {
+    if (val[WJ_FX] >= strip.getModeCount()) return false;
+    if (fxDef) seg[F("fxdef")] = true;
+  }
+  if (val[WJ_FX+3] >= strip.getPaletteCount() || val[WJ_FX+6] > 31) return false; // FP out of range, X3 is 5 bit
+  for (size_t i = WJ_FX; i <= WJ_M3; i++) {
+    if (val[i] < 0) continue;
+    if (i > WJ_FX+6) seg[FPSTR(wjSegKeys[i - WJ_FX])] = (bool)val[i];
+    else             seg[FPSTR(wjSegKeys[i - WJ_FX])] = val[i];
+  }
+
+  JsonArray col = seg.createNestedArray("col");
+  for (size_t c = 0; c < 3; c++) {
+    byte rgbw[4];
+    bool any = false, all = c < 2;
+    for (size_t i = 0; c < 2 && i < 4; i++) {
+      any |= val[WJ_R + 4*c + i] >= 0;
+      all &= val[WJ_R + 4*c + i] >= 0;
+      rgbw[i] = val[WJ_R + 4*c + i];
+    }
+    if (any && (!all || colStr[c])) return false; // partial colors keep the other channels of the current color
+    if (colStr[c]) {
+      char buf[12];
+      size_t n = 0;
+      while (colStr[c][n] && colStr[c][n] != '&') { buf[n] = colStr[c][n]; n++; } // at most 10 chars
+      buf[n] = 0;
+      colorFromDecOrHexString(rgbw, buf);
+    } else if (!all) continue;
+    wjColor(col, c, rgbw);
+  }
+  if (!col.size()) seg.remove("col");
+
+  if (val[WJ_SS] < 0) {
+    for (size_t i = WJ_SB; i <= WJ_MI; i++) if (val[i] >= 0) return false;
+  } else {
+    if (val[WJ_SB]   >= 0) seg["bri"] = val[WJ_SB];
+    if (val[WJ_SB+1] >= 0) { if (val[WJ_SB+1] > 1) seg["on"] = "t"; else seg["on"] = (bool)val[WJ_SB+1]; }
+    if (val[WJ_SB+2] >= 0) seg["rev"] = (bool)val[WJ_SB+2];
+    if (val[WJ_MI]   >= 0) seg["mi"]  = (bool)val[WJ_MI];
+  }
+  if (seg.size() <= (size_t)(val[WJ_SS] >= 0)) wj.remove("seg"); // nothing for the segment(s)
+  return true;
+}
+
+// adds "wj" (translation or false) to a loaded "win" preset, true if the document changed
+static bool compileWinPreset(JsonObject fdo) {
+  const char *win = fdo["win"];
+  if (!win || fdo.containsKey("wj")) return false;
+  JsonObject wj = fdo.createNestedObject("wj");
+  if (wj.isNull()) return false;
+  if (!translateWin(win, wj)) fdo["wj"] = false;
+  DEBUG_PRINT(F("win preset ")); DEBUG_PRINTLN(fdo["wj"].is<JsonObject>() ? F("translated") : F("not translatable"));
+  return true;
+}
+
+// the translation holds if the segment(s) it addresses exist now, otherwise handleSet() decides
+static bool winPresetJsonUsable(JsonObject wj) {
+  if (wj.isNull()) return false;
+  JsonObject seg = wj["seg"];
+  if (seg.isNull()) return true;
+  if (seg.containsKey("id")) return (seg["id"].as<unsigned>() < strip.getSegmentsNum());
+  for (size_t s = 0; s < strip.getSegmentsNum(); s++) if (strip.getSegment(s).isSelected()) return true;
+  return false; // handleSet() falls back to the main segment if none is selected
+}
+
 bool applyPreset(byte index, byte callMode)
 {
   DEBUG_PRINT(F("Request to apply preset: "));
@@ -131,6 +493,10 @@ void applyPresetWithFallback(uint8_t index, uint8_t callMode, uint8_t effectID,
 
 void handlePresets()
 {
+  #ifdef WLED_ENABLE_PRESETS_BIN
+  if (presetsImportPending && !fileDoc && !importPresets(0)) return;
+  #endif
+
   if (presetToSave) {
     doSaveState();
     return;
@@ -143,10 +509,9 @@ void handlePresets()
   uint8_t tmpMode   = callModeToApply;
 
   JsonObject fdo;
-  const char *filename = getFileName(tmpPreset < 255);
 
   // allocate buffer
-  if (!requestJSONBufferLock(9)) return;  // will also assign fileDoc
+  if (!requestJSONBufferLock(JSON_LOCK_PRESET_LOAD)) return;  // will also assign fileDoc
 
   presetToApply = 0; //clear request for preset
   callModeToApply = 0;
@@ -154,20 +519,31 @@ void handlePresets()
   DEBUG_PRINT(F("Applying preset: "));
   DEBUG_PRINTLN(tmpPreset);
 
+  const char *cached = (tmpPreset < 255) ? presetCacheGet(tmpPreset) : nullptr;
   #ifdef ARDUINO_ARCH_ESP32
   if (tmpPreset==255 && tmpRAMbuffer!=nullptr) {
     deserializeJson(*fileDoc,tmpRAMbuffer);
+    compileWinPreset(fileDoc->as<JsonObject>());
     errorFlag = ERR_NONE;
   } else
   #endif
-  {
-  errorFlag = readObjectFromFileUsingId(filename, tmpPreset, fileDoc) ? ERR_NONE : ERR_FS_PLOAD;
+  if (cached) {
+    DEBUG_PRINTLN(F("Preset from cache."));
+    deserializeJson(*fileDoc, cached); // const char* input is copied, cache entry stays intact
+    errorFlag = ERR_NONE;
+  } else {
+  errorFlag = loadPreset(tmpPreset < 255, tmpPreset, fileDoc) ? ERR_NONE : ERR_FS_PLOAD;
+  if (!errorFlag) compileWinPreset(fileDoc->as<JsonObject>());
+  if (!errorFlag && tmpPreset < 255) presetCachePut(tmpPreset, fileDoc); // before deserializeState() modifies it
   }
   fdo = fileDoc->as<JsonObject>();
 
   //HTTP API commands
   const char* httpwin = fdo["win"];
-  if (httpwin) {
+  if (httpwin && winPresetJsonUsable(fdo["wj"])) {
+    deserializeState(fdo["wj"], CALL_MODE_NO_NOTIFY, tmpPreset); // translated, see translateWin()
+    changePreset = true;
+  } else if (httpwin) {
     String apireq = "win"; // reduce flash string usage
     apireq += F("&IN&"); // internal call
     apireq += httpwin;
@@ -194,6 +570,30 @@ void handlePresets()
   if (changePreset) notify(tmpMode); // force UDP notification
   stateUpdated(tmpMode);  // was colorUpdated() if anything breaks
   updateInterfaces(tmpMode);
+  if (changePreset && usermods.wantsEvent(UM_EVENT_PRESET)) {
+    um_event_t ev = {UM_EVENT_PRESET, tmpMode};
+    ev.preset.id = tmpPreset;
+    usermods.dispatchEvent(ev);
+  }
+}
+
+// loads a preset into the preset cache ahead of time so applying it later needs no filesystem access (playlists)
+// returns false if it could not be done now (JSON buffers busy) and should be retried
+bool prefetchPreset(byte index)
+{
+  #if WLED_PRESET_CACHE_SIZE > 0
+  if (index == 0 || index > 250) return true;
+  if (presetCacheGet(index)) return true; // also marks it as recently used
+  JsonDocument *d = requestJSONBuffer(JSON_LOCK_PRESET_LOAD, 0); // don't stall the loop if all buffers are busy
+  if (!d) return false;
+  if (loadPreset(true, index, d)) {
+    compileWinPreset(d->as<JsonObject>());
+    presetCachePut(index, d);
+  }
+  releaseJSONBuffer(d);
+  DEBUG_PRINT(F("Prefetched preset ")); DEBUG_PRINTLN(index);
+  #endif
+  return true;
 }
 
 //called from handleSet(PS=) [network callback (fileDoc==nullptr), IR (irrational), deserializeState, UDP] and deserializeState() [network callback (filedoc!=nullptr)]
@@ -222,7 +622,7 @@ void savePreset(byte index, const char* pname, JsonObject sObj)
     if (sObj[F("playlist")].isNull()) {
       // we will save API call immediately (often causes presets.json corruption)
       presetToSave = 0;
-      if (index > 250 || !fileDoc) return; // cannot save API calls to temporary preset (255)
+      if (index > 250 || sObj.isNull()) return; // cannot save API calls to temporary preset (255)
       sObj.remove("o");
       sObj.remove("v");
       sObj.remove("time");
@@ -230,8 +630,15 @@ void savePreset(byte index, const char* pname, JsonObject sObj)
       sObj.remove(F("psave"));
       if (sObj["n"].isNull()) sObj["n"] = saveName;
       initPresetsFile(); // just in case if someone deleted presets.json using /edit
-      writeObjectToFileUsingId(getFileName(index<255), index, fileDoc);
+      if (holdsJSONBufferLock()) {
+        storePreset(true, index, fileDoc); // API call was parsed into global doc
+      } else if (requestJSONBufferLock(JSON_LOCK_PRESET_API)) {
+        doc.set(sObj); // API call came in a pool buffer, file access is serialized by global doc
+        storePreset(true, index, &doc);
+        releaseJSONBufferLock();
+      } else return;
       presetsModifiedTime = toki.second(); //unix time
+      invalidatePresetCache(index);
       updateFSInfo();
     } else {
       // store playlist
@@ -244,7 +651,8 @@ void savePreset(byte index, const char* pname, JsonObject sObj)
 
 void deletePreset(byte index) {
   StaticJsonDocument<24> empty;
-  writeObjectToFileUsingId(getFileName(), index, &empty);
+  storePreset(true, index, &empty);
   presetsModifiedTime = toki.second(); //unix time
+  invalidatePresetCache(index);
   updateFSInfo();
 }
\ No newline at end of file
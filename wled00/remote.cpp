@@ -17,6 +17,13 @@
 #define WIZMOTE_BUTTON_BRIGHT_UP   9
 #define WIZMOTE_BUTTON_BRIGHT_DOWN 8
 
+// ESP-NOW sync: 'W', type, message id, fragment index, fragment count, payload
+#define ESP_NOW_SYNC_HEADER        5
+#define ESP_NOW_SYNC_CHUNK         (250 - ESP_NOW_SYNC_HEADER)
+#define ESP_NOW_SYNC_NOTIFY        'S' // WLED sync notification (same as UDP, fragmented)
+#define ESP_NOW_SYNC_BEACON        'B' // frame clock beacon: effect time (32 bit), sync groups
+#define ESP_NOW_PRESUMED_DELAY     1   // ms
+
 #ifdef WLED_DISABLE_ESPNOW
 void handleRemote(){}
 #else
@@ -43,6 +50,19 @@ static uint32_t last_seq = UINT32_MAX;
 static int brightnessBeforeNightMode = NIGHT_MODE_DEACTIVATED;
 static message_structure incoming;
 
+static const uint8_t espNowBroadcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+static bool espNowPeerAdded = false;
+static uint8_t espNowMsgId = 0;
+static unsigned long espNowLastBeacon = 0;
+// received in WiFi task, applied from loop() in handleRemote()
+static uint8_t *espNowIn = nullptr; // notification reassembly buffer (WLEDPACKETSIZE)
+static uint8_t espNowInId = 0, espNowInDoneId = 0, espNowInMask = 0;
+static volatile bool espNowInReady = false;
+static volatile bool espNowBeaconReady = false;
+static uint32_t espNowBeaconTime = 0;
+static unsigned long espNowBeaconAt = 0;
+static uint8_t espNowBeaconGroups = 0;
+
 // Pulled from the IR Remote logic but reduced to 10 steps with a constant of 3
 static const byte brightnessSteps[] = {
   6, 9, 14, 22, 33, 50, 75, 113, 170, 255
@@ -115,6 +135,77 @@ static void presetWithFallback(uint8_t presetID, uint8_t effectID, uint8_t palet
   applyPresetWithFallback(presetID, CALL_MODE_BUTTON_PRESET, effectID, paletteID);
 }
  
+static bool espNowAddBroadcastPeer() {
+  #ifdef ESP8266
+  esp_now_set_self_role(ESP_NOW_ROLE_COMBO);
+  return esp_now_add_peer((uint8_t*)espNowBroadcast, ESP_NOW_ROLE_COMBO, 0, NULL, 0) == 0;
+  #else
+  esp_now_peer_info_t peer = {};
+  memcpy(peer.peer_addr, espNowBroadcast, 6);
+  peer.channel = 0; // current WiFi channel
+  peer.encrypt = false;
+  return esp_now_add_peer(&peer) == ESP_OK;
+  #endif
+}
+
+// sends a WLED sync notification as ESP-NOW broadcast, in fragments of up to 245 bytes
+void espNowSendNotify(const uint8_t *packet, size_t len) {
+  if (esp_now_state != ESP_NOW_STATE_ON || !espNowPeerAdded) return;
+  uint8_t buf[ESP_NOW_SYNC_HEADER + ESP_NOW_SYNC_CHUNK];
+  uint8_t frags = (len + ESP_NOW_SYNC_CHUNK - 1) / ESP_NOW_SYNC_CHUNK;
+  espNowMsgId++;
+  for (uint8_t f = 0; f < frags; f++) {
+    size_t ofs = f * ESP_NOW_SYNC_CHUNK;
+    size_t n = MIN((size_t)ESP_NOW_SYNC_CHUNK, len - ofs);
+    buf[0] = 'W';
+    buf[1] = ESP_NOW_SYNC_NOTIFY;
+    buf[2] = espNowMsgId;
+    buf[3] = f;
+    buf[4] = frags;
+    memcpy(buf + ESP_NOW_SYNC_HEADER, packet + ofs, n);
+    esp_now_send((uint8_t*)espNowBroadcast, buf, n + ESP_NOW_SYNC_HEADER);
+  }
+}
+
+// frame clock beacon: effect time of this node, receivers align their timebase to it
+static void espNowSendBeacon() {
+  uint32_t t = millis() + strip.timebase;
+  uint8_t buf[ESP_NOW_SYNC_HEADER + 5] = {'W', ESP_NOW_SYNC_BEACON, ++espNowMsgId, 0, 1,
+    uint8_t(t >> 24), uint8_t(t >> 16), uint8_t(t >> 8), uint8_t(t), syncGroups};
+  esp_now_send((uint8_t*)espNowBroadcast, buf, sizeof(buf));
+}
+
+// runs in WiFi task: only copies data, it is applied in handleRemote()
+static void espNowSyncRecv(const uint8_t *data, int len) {
+  if (data[1] == ESP_NOW_SYNC_BEACON) {
+    if (len < ESP_NOW_SYNC_HEADER + 5 || espNowBeaconReady) return;
+    const uint8_t *b = data + ESP_NOW_SYNC_HEADER;
+    espNowBeaconTime = (b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3];
+    espNowBeaconGroups = b[4];
+    espNowBeaconAt = millis();
+    espNowBeaconReady = true;
+    return;
+  }
+  if (data[1] != ESP_NOW_SYNC_NOTIFY || !espNowIn || espNowInReady) return;
+  uint8_t id = data[2], frag = data[3], frags = data[4];
+  if (!frags || frags > 8 || frag >= frags || id == espNowInDoneId) return;
+  if (id != espNowInId || !espNowInMask) { // start of new notification
+    espNowInId = id;
+    espNowInMask = 0;
+    memset(espNowIn, 0, WLEDPACKETSIZE);
+  }
+  size_t ofs = frag * ESP_NOW_SYNC_CHUNK;
+  size_t n = len - ESP_NOW_SYNC_HEADER;
+  if (ofs + n > WLEDPACKETSIZE) return;
+  memcpy(espNowIn + ofs, data + ESP_NOW_SYNC_HEADER, n);
+  espNowInMask |= 1 << frag;
+  if (espNowInMask == (1 << frags) - 1) {
+    espNowInMask = 0;
+    espNowInDoneId = id;
+    espNowInReady = true;
+  }
+}
+
 // Callback function that will be executed when data is received
 #ifdef ESP8266
 void OnDataRecv(uint8_t * mac, uint8_t *incomingData, uint8_t len) {
@@ -122,6 +213,11 @@ void OnDataRecv(uint8_t * mac, uint8_t *incomingData, uint8_t len) {
 void OnDataRecv(const uint8_t * mac, const uint8_t *incomingData, int len) {
 #endif
 
+  if (espNowSync && len > ESP_NOW_SYNC_HEADER && incomingData[0] == 'W') { // WLED sync (Wizmote packets start with 0x81/0x91)
+    espNowSyncRecv(incomingData, len);
+    return;
+  }
+
   sprintf (last_signal_src, "%02x%02x%02x%02x%02x%02x",
     mac [0], mac [1], mac [2], mac [3], mac [4], mac [5]);
 
@@ -169,7 +265,7 @@ void OnDataRecv(const uint8_t * mac, const uint8_t *incomingData, int len) {
 }
 
 void handleRemote() {
-  if (enable_espnow_remote) {
+  if (enable_espnow_remote || espNowSync) {
     if ((esp_now_state == ESP_NOW_STATE_UNINIT) && (interfacesInited || apActive)) { // ESPNOW requires Wifi to be initialized (either STA, or AP Mode) 
       DEBUG_PRINTLN(F("Initializing ESP_NOW listener"));
       // Init ESP-NOW
@@ -184,6 +280,25 @@ void handleRemote() {
       
       esp_now_register_recv_cb(OnDataRecv);
       esp_now_state = ESP_NOW_STATE_ON;
+      espNowPeerAdded = false;
+    }
+    if (esp_now_state != ESP_NOW_STATE_ON || !espNowSync) return;
+
+    if (!espNowPeerAdded) espNowPeerAdded = espNowAddBroadcastPeer();
+    if (!espNowIn) espNowIn = (uint8_t*) malloc(WLEDPACKETSIZE);
+
+    if (espNowInReady) {
+      if (espNowIn[0] == 0 && !realtimeMode && receiveNotifications) parseNotifyPacket(espNowIn, WLEDPACKETSIZE);
+      espNowInReady = false;
+    }
+    if (espNowBeaconReady) {
+      if (!realtimeMode && receiveNotificationEffects && !clockSyncActive() && (receiveGroups & espNowBeaconGroups) && millis() - notificationSentTime > 1000)
+        strip.timebase = espNowBeaconTime + ESP_NOW_PRESUMED_DELAY - espNowBeaconAt;
+      espNowBeaconReady = false;
+    }
+    if (espNowPeerAdded && notifyDirect && syncGroups && !realtimeMode && millis() - espNowLastBeacon > WLED_ESPNOW_BEACON_INTERVAL) {
+      espNowSendBeacon();
+      espNowLastBeacon = millis();
     }
   } else {
     if (esp_now_state == ESP_NOW_STATE_ON) {
@@ -192,6 +307,9 @@ void handleRemote() {
         DEBUG_PRINTLN(F("Error de-initializing ESP-NOW"));
       }
       esp_now_state = ESP_NOW_STATE_UNINIT;
+      espNowPeerAdded = false;
+      free(espNowIn);
+      espNowIn = nullptr;
     } else if (esp_now_state == ESP_NOW_STATE_ERROR) {
       //Clear any error states (allows retrying by cycling)
       esp_now_state = ESP_NOW_STATE_UNINIT;
@@ -0,0 +1,96 @@
+#include "wled.h"
+
+/*
+ * Cooperative scheduler for the subsystems run from WLED::loop()
+ * Tasks run in registration order, each when its interval has elapsed (0: every loop).
+ * TASK_PRIO_IDLE tasks (reconnects, node refresh, housekeeping) only run if the next frame is not due
+ * within their time budget, so they fill the gaps between frames instead of delaying them. An idle task
+ * is run anyway once it is overdue by more than TASK_MAX_DEFER_MS so it can not starve.
+ * While a frame is rendered in slices (WLED_RENDER_SLICE_US) idle tasks are deferred until it is shown.
+ * Tasks flagged TASK_NO_REALTIME are skipped while realtime data (E1.31, DDP, Adalight...) drives the LEDs.
+ */
+
+#define TASK_MAX_DEFER_MS 2000
+
+static sched_task_t schedTasks[WLED_MAX_SCHED_TASKS];
+static uint8_t schedTaskCount = 0;
+
+// returns task id, -1 if the table is full
+int8_t schedAddTask(const char *name, task_fn_t fn, uint16_t interval, uint8_t prio, uint16_t budget, uint8_t flags)
+{
+  if (!fn || schedTaskCount >= WLED_MAX_SCHED_TASKS) return -1;
+  sched_task_t &t = schedTasks[schedTaskCount];
+  memset(&t, 0, sizeof(sched_task_t));
+  t.name = name;
+  t.fn = fn;
+  t.interval = interval;
+  t.prio = prio;
+  t.budget = budget;
+  t.flags = flags;
+  return schedTaskCount++;
+}
+
+// microseconds until the strip wants to show the next frame (INT32_MAX if it does not render)
+static int32_t timeToNextFrame()
+{
+  if (realtimeMode && !realtimeOverride) return INT32_MAX; // frames are driven by incoming data
+  if (offMode && !strip.isOffRefreshRequired()) return INT32_MAX;
+  if (strip.isRendering()) return 0; // frame is rendered in slices, let it complete first
+  int32_t ms = (int32_t)(strip.getLastShow() + strip.getFrameTime() - millis());
+  return ms > 0 ? ms * 1000 : 0;
+}
+
+void schedRun()
+{
+  bool rtBlocked = realtimeMode && !realtimeOverride && !realtimeSegmentsOnly();
+  for (uint8_t i = 0; i < schedTaskCount; i++) {
+    sched_task_t &t = schedTasks[i];
+    t.lastUs = 0;
+    if (rtBlocked && (t.flags & TASK_NO_REALTIME)) continue;
+    uint32_t now = millis();
+    if (t.interval && now - t.lastRun < t.interval) continue;
+    if (t.prio == TASK_PRIO_IDLE && t.runs && now - t.lastRun < t.interval + TASK_MAX_DEFER_MS && timeToNextFrame() < (int32_t)t.budget) {
+      t.deferred++;
+      continue;
+    }
+    t.lastRun = now;
+    uint32_t start = micros();
+    t.fn();
+    uint32_t us = micros() - start;
+    traceEvent(TRACE_TASK, i, 0, start, us);
+    t.lastUs = us;
+    t.runs++;
+    t.totalUs += us;
+    if (us > t.maxUs) t.maxUs = us;
+    if (us > t.curMaxUs) t.curMaxUs = us;
+    if (t.budget && us > t.budget) t.overruns++;
+    if (t.flags & TASK_YIELD) yield();
+  }
+}
+
+const sched_task_t* getSchedTask(uint8_t id)
+{
+  return id < schedTaskCount ? &schedTasks[id] : nullptr;
+}
+
+uint8_t getSchedTaskCount()
+{
+  return schedTaskCount;
+}
+
+void resetSchedStats()
+{
+  for (uint8_t i = 0; i < schedTaskCount; i++) {
+    sched_task_t &t = schedTasks[i];
+    t.runs = t.totalUs = t.maxUs = t.winMaxUs = t.curMaxUs = t.deferred = t.overruns = 0;
+  }
+}
+
+// called every LOOP_STATS_WINDOW by addLoopStats()
+void rollSchedStatsWindow()
+{
+  for (uint8_t i = 0; i < schedTaskCount; i++) {
+    schedTasks[i].winMaxUs = schedTasks[i].curMaxUs;
+    schedTasks[i].curMaxUs = 0;
+  }
+}
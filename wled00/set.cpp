@@ -1,4 +1,5 @@
 #include "wled.h"
+#include "api_keys.h"
 
 /*
  * Receives client input
@@ -34,6 +35,7 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 
     force802_3g = request->hasArg(F("FG"));
     noWifiSleep = request->hasArg(F("WS"));
+    realtimeProfile = request->hasArg(F("RTP"));
 
     #ifndef WLED_DISABLE_ESPNOW
     enable_espnow_remote = request->hasArg(F("RE"));
@@ -92,6 +94,7 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
     Bus::setCCTBlend(strip.cctBlending);
     Bus::setGlobalAWMode(request->arg(F("AW")).toInt());
     strip.setTargetFps(request->arg(F("FR")).toInt());
+    Bus::setDithering(request->hasArg(F("DI")));
     useGlobalLedBuffer = request->hasArg(F("LD"));
 
     bool busesChanged = false;
@@ -107,6 +110,7 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
       char aw[4] = "AW"; aw[2] = 48+s; aw[3] = 0; //auto white mode
       char wo[4] = "WO"; wo[2] = 48+s; wo[3] = 0; //channel swap
       char sp[4] = "SP"; sp[2] = 48+s; sp[3] = 0; //bus clock speed (DotStar & PWM)
+      char ma[4] = "MA"; ma[2] = 48+s; ma[3] = 0; //current limit of bus' own power supply
       if (!request->hasArg(lp)) {
         DEBUG_PRINT(F("No data for "));
         DEBUG_PRINTLN(s);
@@ -151,10 +155,11 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
       }
       channelSwap = Bus::hasWhite(type) ? request->arg(wo).toInt() : 0;
       type |= request->hasArg(rf) << 7; // off refresh override
+      uint16_t maMax = request->arg(ma).toInt(); // 0: shares global ABL limit
       // actual finalization is done in WLED::loop() (removing old busses and adding new)
       // this may happen even before this loop is finished so we do "doInitBusses" after the loop
       if (busConfigs[s] != nullptr) delete busConfigs[s];
-      busConfigs[s] = new BusConfig(type, pins, start, length, colorOrder | (channelSwap<<4), request->hasArg(cv), skip, awmode, freqHz, useGlobalLedBuffer);
+      busConfigs[s] = new BusConfig(type, pins, start, length, colorOrder | (channelSwap<<4), request->hasArg(cv), skip, awmode, freqHz, useGlobalLedBuffer, maMax);
       busesChanged = true;
     }
     //doInitBusses = busesChanged; // we will do that below to ensure all input data is processed
@@ -226,6 +231,7 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
         buttonType[i] = BTN_TYPE_NONE;
       }
     }
+    attachButtonEvents();
     touchThreshold = request->arg(F("TT")).toInt();
 
     strip.ablMilliampsMax = request->arg(F("MA")).toInt();
@@ -254,6 +260,8 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
     strip.paletteFade = request->hasArg(F("PF"));
     t = request->arg(F("TP")).toInt();
     randomPaletteChangeTime = MIN(255,MAX(1,t));
+    t = request->arg(F("TC")).toInt();
+    stateCoalesceInterval = MIN(1000,MAX(0,t));
 
     nightlightTargetBri = request->arg(F("TB")).toInt();
     t = request->arg(F("TL")).toInt();
@@ -313,6 +321,12 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 
     t = request->arg(F("UR")).toInt();
     if ((t>=0) && (t<30)) udpNumRetries = t;
+    udpDeltaNotify = request->hasArg(F("ND"));
+    t = request->arg(F("CK")).toInt();
+    if (t >= CLOCK_SYNC_OFF && t <= CLOCK_SYNC_LEADER) clockSyncMode = t;
+    #ifndef WLED_DISABLE_ESPNOW
+    espNowSync = request->hasArg(F("EN"));
+    #endif
 
 
     nodeListEnabled = request->hasArg(F("NL"));
@@ -321,6 +335,7 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 
     receiveDirect = request->hasArg(F("RD"));
     useMainSegmentOnly = request->hasArg(F("MO"));
+    realtimeFade = request->hasArg(F("LF"));
     e131SkipOutOfSequence = request->hasArg(F("ES"));
     e131Multicast = request->hasArg(F("EM"));
     t = request->arg(F("EP")).toInt();
@@ -329,12 +344,38 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
     if (t >= 0  && t <= 63999) e131Universe = t;
     t = request->arg(F("DA")).toInt();
     if (t >= 0  && t <= 510) DMXAddress = t;
+    t = request->arg(F("FT")).toInt();
+    if (t > 0  && t <= 1000) e131FrameTimeout = t;
+    t = request->arg(F("DY")).toInt();
+    if (t >= 0  && t <= DDP_MAX_PRESENTATION_DELAY) ddpPresentationDelay = t;
     t = request->arg(F("XX")).toInt();
     if (t >= 0  && t <= 150) DMXSegmentSpacing = t;
     t = request->arg(F("PY")).toInt();
     if (t >= 0  && t <= 200) e131Priority = t;
     t = request->arg(F("DM")).toInt();
     if (t >= DMX_MODE_DISABLED && t <= DMX_MODE_PRESET) DMXMode = t;
+    #ifdef WLED_ENABLE_DMX_INPUT
+    t = request->arg(F("IDR")).toInt();
+    if (t >= -1 && t < WLED_NUM_PINS) dmxInputRxPin = t;
+    t = request->arg(F("IDE")).toInt();
+    if (t >= -1 && t < WLED_NUM_PINS) dmxInputEnPin = t;
+    #endif
+    t = request->arg(F("OU")).toInt();
+    if (t > 0  && t <= 63999) netOutUniverse = t;
+    t = request->arg(F("OP")).toInt();
+    if (t >= 0  && t <= 200) e131OutPriority = t;
+    t = request->arg(F("OG")).toInt();
+    if (t >= 0  && t <= 20000) netOutPacing = t;
+    t = request->arg(F("OC")).toInt();
+    if (t >= 0  && t <= 512) netOutChannels = t;
+    strip.updateWireLimit(); // network bus packets per frame depend on pacing and channels
+    t = request->arg(F("AN")).toInt();
+    if (t >= 0  && t <= 127) artnetOutNet = t;
+    t = request->arg(F("AS")).toInt();
+    if (t >= 0  && t <= 15) artnetOutSubnet = t;
+    t = request->arg(F("AU")).toInt();
+    if (t >= 0  && t <= 15) artnetOutUniverse = t;
+    artnetOutSync = request->hasArg(F("AY"));
     t = request->arg(F("ET")).toInt();
     if (t > 99  && t <= 65000) realtimeTimeoutMs = t;
     arlsForceMaxBri = request->hasArg(F("FB"));
@@ -542,7 +583,7 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
   //USERMODS
   if (subPage == SUBPAGE_UM)
   {
-    if (!requestJSONBufferLock(5)) return;
+    if (!requestJSONBufferLock(JSON_LOCK_SETTINGS)) return;
 
     // global I2C & SPI pins
     int8_t hw_sda_pin  = !request->arg(F("SDA")).length() ? -1 : (int)request->arg(F("SDA")).toInt();
@@ -703,14 +744,18 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
         pO[l] = 'Y'; p.yOffset     = request->arg(pO).toInt();
         pO[l] = 'W'; p.width       = request->arg(pO).toInt();
         pO[l] = 'H'; p.height      = request->arg(pO).toInt();
+        pO[l] = 'C'; p.canvas      = MIN(WLED_MAX_CANVASES-1, (int)request->arg(pO).toInt()); // 0 if missing
+        pO[l] = 'I'; IPAddress ip; if (ip.fromString(request->arg(pO))) for (size_t j = 0; j < 4; j++) p.ip[j] = ip[j];
         strip.panel.push_back(p);
       }
       strip.setUpMatrix(); // will check limits
       strip.makeAutoSegments(true);
       strip.deserializeMap();
     } else {
-      Segment::maxWidth  = strip.getLengthTotal();
+      strip.canvas.clear();
+      Segment::maxWidth  = strip.getLength();
       Segment::maxHeight = 1;
+      Segment::matrixArea = Segment::maxWidth;
     }
   }
   #endif
@@ -725,28 +770,40 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 }
 
 
+// like updateVal() for a tokenized value
+static bool apiVal(const char *v, byte* val, byte minv=0, byte maxv=0)
+{
+  if (!v) return false;
+  parseNumber(v, val, minv, maxv);
+  return true;
+}
+
 //HTTP API request parser
 bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
 {
   if (!(req.indexOf("win") >= 0)) return false;
+  StateGuard state; // HTTP API is applied like JSON state, one task at a time
 
-  int pos = 0;
   DEBUG_PRINT(F("API req: "));
   DEBUG_PRINTLN(req);
 
+  const char *v[API_KEY_COUNT];
+  tokenizeApiRequest(req.c_str(), v);
+  const char *pos;
+
   //segment select (sets main segment)
-  pos = req.indexOf(F("SM="));
-  if (pos > 0 && !realtimeMode) {
-    strip.setMainSegmentId(getNumVal(&req, pos));
+  pos = v[API_SM];
+  if (pos && !realtimeMode) {
+    strip.setMainSegmentId(atoi(pos));
   }
 
   byte selectedSeg = strip.getFirstSelectedSegId();
 
   bool singleSegment = false;
 
-  pos = req.indexOf(F("SS="));
-  if (pos > 0) {
-    byte t = getNumVal(&req, pos);
+  pos = v[API_SS];
+  if (pos) {
+    byte t = atoi(pos);
     if (t < strip.getSegmentsNum()) {
       selectedSeg = t;
       singleSegment = true;
@@ -754,9 +811,9 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   }
 
   Segment& selseg = strip.getSegment(selectedSeg);
-  pos = req.indexOf(F("SV=")); //segment selected
-  if (pos > 0) {
-    byte t = getNumVal(&req, pos);
+  pos = v[API_SV]; //segment selected
+  if (pos) {
+    byte t = atoi(pos);
     if (t == 2) for (uint8_t i = 0; i < strip.getSegmentsNum(); i++) strip.getSegment(i).selected = false; // unselect other segments
     selseg.selected = t;
   }
@@ -782,93 +839,93 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   uint16_t stopY   = selseg.stopY;
   uint8_t  grpI    = selseg.grouping;
   uint16_t spcI    = selseg.spacing;
-  pos = req.indexOf(F("&S=")); //segment start
-  if (pos > 0) {
-    startI = getNumVal(&req, pos);
+  pos = v[API_S]; //segment start
+  if (pos) {
+    startI = atoi(pos);
   }
-  pos = req.indexOf(F("S2=")); //segment stop
-  if (pos > 0) {
-    stopI = getNumVal(&req, pos);
+  pos = v[API_S2]; //segment stop
+  if (pos) {
+    stopI = atoi(pos);
   }
-  pos = req.indexOf(F("GP=")); //segment grouping
-  if (pos > 0) {
-    grpI = getNumVal(&req, pos);
+  pos = v[API_GP]; //segment grouping
+  if (pos) {
+    grpI = atoi(pos);
     if (grpI == 0) grpI = 1;
   }
-  pos = req.indexOf(F("SP=")); //segment spacing
-  if (pos > 0) {
-    spcI = getNumVal(&req, pos);
+  pos = v[API_SP]; //segment spacing
+  if (pos) {
+    spcI = atoi(pos);
   }
   strip.setSegment(selectedSeg, startI, stopI, grpI, spcI, UINT16_MAX, startY, stopY);
 
-  pos = req.indexOf(F("RV=")); //Segment reverse
-  if (pos > 0) selseg.reverse = req.charAt(pos+3) != '0';
+  pos = v[API_RV]; //Segment reverse
+  if (pos) selseg.reverse = pos[0] != '0';
 
-  pos = req.indexOf(F("MI=")); //Segment mirror
-  if (pos > 0) selseg.mirror = req.charAt(pos+3) != '0';
+  pos = v[API_MI]; //Segment mirror
+  if (pos) { selseg.mirror = pos[0] != '0'; selseg.updateGeometry(); }
 
-  pos = req.indexOf(F("SB=")); //Segment brightness/opacity
-  if (pos > 0) {
-    byte segbri = getNumVal(&req, pos);
+  pos = v[API_SB]; //Segment brightness/opacity
+  if (pos) {
+    byte segbri = atoi(pos);
     selseg.setOption(SEG_OPTION_ON, segbri); // use transition
     if (segbri) {
       selseg.setOpacity(segbri);
     }
   }
 
-  pos = req.indexOf(F("SW=")); //segment power
-  if (pos > 0) {
-    switch (getNumVal(&req, pos)) {
+  pos = v[API_SW]; //segment power
+  if (pos) {
+    switch (atoi(pos)) {
       case 0:  selseg.setOption(SEG_OPTION_ON, false);      break; // use transition
       case 1:  selseg.setOption(SEG_OPTION_ON, true);       break; // use transition
       default: selseg.setOption(SEG_OPTION_ON, !selseg.on); break; // use transition
     }
   }
 
-  pos = req.indexOf(F("PS=")); //saves current in preset
-  if (pos > 0) savePreset(getNumVal(&req, pos));
+  pos = v[API_PS]; //saves current in preset
+  if (pos) savePreset(atoi(pos));
 
-  pos = req.indexOf(F("P1=")); //sets first preset for cycle
-  if (pos > 0) presetCycMin = getNumVal(&req, pos);
+  pos = v[API_P1]; //sets first preset for cycle
+  if (pos) presetCycMin = atoi(pos);
 
-  pos = req.indexOf(F("P2=")); //sets last preset for cycle
-  if (pos > 0) presetCycMax = getNumVal(&req, pos);
+  pos = v[API_P2]; //sets last preset for cycle
+  if (pos) presetCycMax = atoi(pos);
 
   //apply preset
-  if (updateVal(req.c_str(), "PL=", &presetCycCurr, presetCycMin, presetCycMax)) {
+  if (apiVal(v[API_PL], &presetCycCurr, presetCycMin, presetCycMax)) {
     unloadPlaylist();
     applyPreset(presetCycCurr);
   }
 
   //set brightness
-  updateVal(req.c_str(), "&A=", &bri);
+  apiVal(v[API_A], &bri);
 
   bool col0Changed = false, col1Changed = false;
   //set colors
-  col0Changed |= updateVal(req.c_str(), "&R=", &colIn[0]);
-  col0Changed |= updateVal(req.c_str(), "&G=", &colIn[1]);
-  col0Changed |= updateVal(req.c_str(), "&B=", &colIn[2]);
-  col0Changed |= updateVal(req.c_str(), "&W=", &colIn[3]);
+  col0Changed |= apiVal(v[API_R], &colIn[0]);
+  col0Changed |= apiVal(v[API_G], &colIn[1]);
+  col0Changed |= apiVal(v[API_B], &colIn[2]);
+  col0Changed |= apiVal(v[API_W], &colIn[3]);
 
-  col1Changed |= updateVal(req.c_str(), "R2=", &colInSec[0]);
-  col1Changed |= updateVal(req.c_str(), "G2=", &colInSec[1]);
-  col1Changed |= updateVal(req.c_str(), "B2=", &colInSec[2]);
-  col1Changed |= updateVal(req.c_str(), "W2=", &colInSec[3]);
+  col1Changed |= apiVal(v[API_R2], &colInSec[0]);
+  col1Changed |= apiVal(v[API_G2], &colInSec[1]);
+  col1Changed |= apiVal(v[API_B2], &colInSec[2]);
+  col1Changed |= apiVal(v[API_W2], &colInSec[3]);
 
   #ifdef WLED_ENABLE_LOXONE
   //lox parser
-  pos = req.indexOf(F("LX=")); // Lox primary color
-  if (pos > 0) {
-    int lxValue = getNumVal(&req, pos);
+  pos = v[API_LX]; // Lox primary color
+  if (pos) {
+    int lxValue = atoi(pos);
     if (parseLx(lxValue, colIn)) {
       bri = 255;
       nightlightActive = false; //always disable nightlight when toggling
       col0Changed = true;
     }
   }
-  pos = req.indexOf(F("LY=")); // Lox secondary color
-  if (pos > 0) {
-    int lxValue = getNumVal(&req, pos);
+  pos = v[API_LY]; // Lox secondary color
+  if (pos) {
+    int lxValue = atoi(pos);
     if(parseLx(lxValue, colInSec)) {
       bri = 255;
       nightlightActive = false; //always disable nightlight when toggling
@@ -878,58 +935,58 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   #endif
 
   //set hue
-  pos = req.indexOf(F("HU="));
-  if (pos > 0) {
-    uint16_t temphue = getNumVal(&req, pos);
+  pos = v[API_HU];
+  if (pos) {
+    uint16_t temphue = atoi(pos);
     byte tempsat = 255;
-    pos = req.indexOf(F("SA="));
-    if (pos > 0) {
-      tempsat = getNumVal(&req, pos);
+    pos = v[API_SA];
+    if (pos) {
+      tempsat = atoi(pos);
     }
-    byte sec = req.indexOf(F("H2"));
+    byte sec = v[API_H2] != nullptr;
     colorHStoRGB(temphue, tempsat, (sec>0) ? colInSec : colIn);
     col0Changed |= (!sec); col1Changed |= sec;
   }
 
   //set white spectrum (kelvin)
-  pos = req.indexOf(F("&K="));
-  if (pos > 0) {
-    byte sec = req.indexOf(F("K2"));
-    colorKtoRGB(getNumVal(&req, pos), (sec>0) ? colInSec : colIn);
+  pos = v[API_K];
+  if (pos) {
+    byte sec = v[API_K2] != nullptr;
+    colorKtoRGB(atoi(pos), (sec>0) ? colInSec : colIn);
     col0Changed |= (!sec); col1Changed |= sec;
   }
 
   //set color from HEX or 32bit DEC
   byte tmpCol[4];
-  pos = req.indexOf(F("CL="));
-  if (pos > 0) {
-    colorFromDecOrHexString(colIn, (char*)req.substring(pos + 3).c_str());
+  pos = v[API_CL];
+  if (pos) {
+    colorFromDecOrHexString(colIn, (char*)pos);
     col0Changed = true;
   }
-  pos = req.indexOf(F("C2="));
-  if (pos > 0) {
-    colorFromDecOrHexString(colInSec, (char*)req.substring(pos + 3).c_str());
+  pos = v[API_C2];
+  if (pos) {
+    colorFromDecOrHexString(colInSec, (char*)pos);
     col1Changed = true;
   }
-  pos = req.indexOf(F("C3="));
-  if (pos > 0) {
-    colorFromDecOrHexString(tmpCol, (char*)req.substring(pos + 3).c_str());
+  pos = v[API_C3];
+  if (pos) {
+    colorFromDecOrHexString(tmpCol, (char*)pos);
     uint32_t col2 = RGBW32(tmpCol[0], tmpCol[1], tmpCol[2], tmpCol[3]);
     selseg.setColor(2, col2); // defined above (SS= or main)
     if (!singleSegment) strip.setColor(2, col2); // will set color to all active & selected segments
   }
 
   //set to random hue SR=0->1st SR=1->2nd
-  pos = req.indexOf(F("SR"));
-  if (pos > 0) {
-    byte sec = getNumVal(&req, pos);
+  pos = v[API_SR];
+  if (pos) {
+    byte sec = atoi(pos);
     setRandomColor(sec? colInSec : colIn);
     col0Changed |= (!sec); col1Changed |= sec;
   }
 
   //swap 2nd & 1st
-  pos = req.indexOf(F("SC"));
-  if (pos > 0) {
+  pos = v[API_SC];
+  if (pos) {
     byte temp;
     for (uint8_t i=0; i<4; i++) {
       temp        = colIn[i];
@@ -955,19 +1012,19 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   bool fxModeChanged = false, speedChanged = false, intensityChanged = false, paletteChanged = false;
   bool custom1Changed = false, custom2Changed = false, custom3Changed = false, check1Changed = false, check2Changed = false, check3Changed = false;
   // set effect parameters
-  if (updateVal(req.c_str(), "FX=", &effectIn, 0, strip.getModeCount()-1)) {
+  if (apiVal(v[API_FX], &effectIn, 0, strip.getModeCount()-1)) {
     if (request != nullptr) unloadPlaylist(); // unload playlist if changing FX using web request
     fxModeChanged = true;
   }
-  speedChanged     = updateVal(req.c_str(), "SX=", &speedIn);
-  intensityChanged = updateVal(req.c_str(), "IX=", &intensityIn);
-  paletteChanged   = updateVal(req.c_str(), "FP=", &paletteIn, 0, strip.getPaletteCount()-1);
-  custom1Changed   = updateVal(req.c_str(), "X1=", &custom1In);
-  custom2Changed   = updateVal(req.c_str(), "X2=", &custom2In);
-  custom3Changed   = updateVal(req.c_str(), "X3=", &custom3In);
-  check1Changed    = updateVal(req.c_str(), "M1=", &check1In);
-  check2Changed    = updateVal(req.c_str(), "M2=", &check2In);
-  check3Changed    = updateVal(req.c_str(), "M3=", &check3In);
+  speedChanged     = apiVal(v[API_SX], &speedIn);
+  intensityChanged = apiVal(v[API_IX], &intensityIn);
+  paletteChanged   = apiVal(v[API_FP], &paletteIn, 0, strip.getPaletteCount()-1);
+  custom1Changed   = apiVal(v[API_X1], &custom1In);
+  custom2Changed   = apiVal(v[API_X2], &custom2In);
+  custom3Changed   = apiVal(v[API_X3], &custom3In);
+  check1Changed    = apiVal(v[API_M1], &check1In);
+  check2Changed    = apiVal(v[API_M2], &check2In);
+  check3Changed    = apiVal(v[API_M3], &check3In);
 
   stateChanged |= (fxModeChanged || speedChanged || intensityChanged || paletteChanged || custom1Changed || custom2Changed || custom3Changed || check1Changed || check2Changed || check3Changed);
 
@@ -975,7 +1032,7 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   for (uint8_t i = 0; i < strip.getSegmentsNum(); i++) {
     Segment& seg = strip.getSegment(i);
     if (i != selectedSeg && (singleSegment || !seg.isActive() || !seg.isSelected())) continue; // skip non main segments if not applying to all
-    if (fxModeChanged)    seg.setMode(effectIn, req.indexOf(F("FXD="))>0);  // apply defaults if FXD= is specified
+    if (fxModeChanged)    seg.setMode(effectIn, v[API_FXD] != nullptr);  // apply defaults if FXD= is specified
     if (speedChanged)     seg.speed     = speedIn;
     if (intensityChanged) seg.intensity = intensityIn;
     if (paletteChanged)   seg.setPalette(paletteIn);
@@ -988,34 +1045,34 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   }
 
   //set advanced overlay
-  pos = req.indexOf(F("OL="));
-  if (pos > 0) {
-    overlayCurrent = getNumVal(&req, pos);
+  pos = v[API_OL];
+  if (pos) {
+    overlayCurrent = atoi(pos);
   }
 
   //apply macro (deprecated, added for compatibility with pre-0.11 automations)
-  pos = req.indexOf(F("&M="));
-  if (pos > 0) {
-    applyPreset(getNumVal(&req, pos) + 16);
+  pos = v[API_M];
+  if (pos) {
+    applyPreset(atoi(pos) + 16);
   }
 
   //toggle send UDP direct notifications
-  pos = req.indexOf(F("SN="));
-  if (pos > 0) notifyDirect = (req.charAt(pos+3) != '0');
+  pos = v[API_SN];
+  if (pos) notifyDirect = (pos[0] != '0');
 
   //toggle receive UDP direct notifications
-  pos = req.indexOf(F("RN="));
-  if (pos > 0) receiveNotifications = (req.charAt(pos+3) != '0');
+  pos = v[API_RN];
+  if (pos) receiveNotifications = (pos[0] != '0');
 
   //receive live data via UDP/Hyperion
-  pos = req.indexOf(F("RD="));
-  if (pos > 0) receiveDirect = (req.charAt(pos+3) != '0');
+  pos = v[API_RD];
+  if (pos) receiveDirect = (pos[0] != '0');
 
   //main toggle on/off (parse before nightlight, #1214)
-  pos = req.indexOf(F("&T="));
-  if (pos > 0) {
+  pos = v[API_T];
+  if (pos) {
     nightlightActive = false; //always disable nightlight when toggling
-    switch (getNumVal(&req, pos))
+    switch (atoi(pos))
     {
       case 0: if (bri != 0){briLast = bri; bri = 0;} break; //off, only if it was previously on
       case 1: if (bri == 0) bri = briLast; break; //on, only if it was previously off
@@ -1025,16 +1082,16 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
 
   //toggle nightlight mode
   bool aNlDef = false;
-  if (req.indexOf(F("&ND")) > 0) aNlDef = true;
-  pos = req.indexOf(F("NL="));
-  if (pos > 0)
+  if (v[API_ND]) aNlDef = true;
+  pos = v[API_NL];
+  if (pos)
   {
-    if (req.charAt(pos+3) == '0')
+    if (pos[0] == '0')
     {
       nightlightActive = false;
     } else {
       nightlightActive = true;
-      if (!aNlDef) nightlightDelayMins = getNumVal(&req, pos);
+      if (!aNlDef) nightlightDelayMins = atoi(pos);
       else         nightlightDelayMins = nightlightDelayMinsDefault;
       nightlightStartTime = millis();
     }
@@ -1046,75 +1103,73 @@ bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply)
   }
 
   //set nightlight target brightness
-  pos = req.indexOf(F("NT="));
-  if (pos > 0) {
-    nightlightTargetBri = getNumVal(&req, pos);
+  pos = v[API_NT];
+  if (pos) {
+    nightlightTargetBri = atoi(pos);
     nightlightActiveOld = false; //re-init
   }
 
   //toggle nightlight fade
-  pos = req.indexOf(F("NF="));
-  if (pos > 0)
+  pos = v[API_NF];
+  if (pos)
   {
-    nightlightMode = getNumVal(&req, pos);
+    nightlightMode = atoi(pos);
 
     nightlightActiveOld = false; //re-init
   }
   if (nightlightMode > NL_MODE_SUN) nightlightMode = NL_MODE_SUN;
 
-  pos = req.indexOf(F("TT="));
-  if (pos > 0) transitionDelay = getNumVal(&req, pos);
+  pos = v[API_TT];
+  if (pos) transitionDelay = atoi(pos);
   if (fadeTransition) strip.setTransition(transitionDelay);
 
   //set time (unix timestamp)
-  pos = req.indexOf(F("ST="));
-  if (pos > 0) {
-    setTimeFromAPI(getNumVal(&req, pos));
+  pos = v[API_ST];
+  if (pos) {
+    setTimeFromAPI(atoi(pos));
   }
 
   //set countdown goal (unix timestamp)
-  pos = req.indexOf(F("CT="));
-  if (pos > 0) {
-    countdownTime = getNumVal(&req, pos);
+  pos = v[API_CT];
+  if (pos) {
+    countdownTime = atoi(pos);
     if (countdownTime - toki.second() > 0) countdownOverTriggered = false;
   }
 
-  pos = req.indexOf(F("LO="));
-  if (pos > 0) {
-    realtimeOverride = getNumVal(&req, pos);
+  pos = v[API_LO];
+  if (pos) {
+    realtimeOverride = atoi(pos);
     if (realtimeOverride > 2) realtimeOverride = REALTIME_OVERRIDE_ALWAYS;
-    if (realtimeMode && useMainSegmentOnly) {
-      strip.getMainSegment().freeze = !realtimeOverride;
-    }
+    if (realtimeMode) realtimeFreezeSegments(!realtimeOverride);
   }
 
-  pos = req.indexOf(F("RB"));
-  if (pos > 0) doReboot = true;
+  pos = v[API_RB];
+  if (pos) doReboot = true;
 
   // clock mode, 0: normal, 1: countdown
-  pos = req.indexOf(F("NM="));
-  if (pos > 0) countdownMode = (req.charAt(pos+3) != '0');
+  pos = v[API_NM];
+  if (pos) countdownMode = (pos[0] != '0');
 
-  pos = req.indexOf(F("U0=")); //user var 0
-  if (pos > 0) {
-    userVar0 = getNumVal(&req, pos);
+  pos = v[API_U0]; //user var 0
+  if (pos) {
+    userVar0 = atoi(pos);
   }
 
-  pos = req.indexOf(F("U1=")); //user var 1
-  if (pos > 0) {
-    userVar1 = getNumVal(&req, pos);
+  pos = v[API_U1]; //user var 1
+  if (pos) {
+    userVar1 = atoi(pos);
   }
   // you can add more if you need
 
   // global col[], effectCurrent, ... are updated in stateChanged()
   if (!apply) return true; // when called by JSON API, do not call colorUpdated() here
 
-  pos = req.indexOf(F("&NN")); //do not send UDP notifications this time
-  stateUpdated((pos > 0) ? CALL_MODE_NO_NOTIFY : CALL_MODE_DIRECT_CHANGE);
+  pos = v[API_NN]; //do not send UDP notifications this time
+  stateUpdated(pos ? CALL_MODE_NO_NOTIFY : CALL_MODE_DIRECT_CHANGE);
 
   // internal call, does not send XML response
-  pos = req.indexOf(F("IN"));
-  if (pos < 1) XML_response(request);
+  pos = v[API_IN];
+  if (!pos) XML_response(request);
 
   return true;
 }
@@ -24,8 +24,9 @@
 
 #define DMXSPEED       250000
 #define DMXFORMAT      SERIAL_8N2
-#define BREAKSPEED     83333
-#define BREAKFORMAT    SERIAL_8N1
+#define BREAKUS        92      // break and mark after break (us), at least 88 and 8 per DMX512
+#define MABUS          12
+#define BYTEUS         44      // one 8N2 slot at 250kbaud
 
 bool dmxStarted = false;
 int sendPin = 2;		//default on ESP8266
@@ -33,12 +34,13 @@ int sendPin = 2;		//default on ESP8266
 //DMX value array and size. Entry 0 will hold startbyte, so we need 512+1 elements
 uint8_t dmxDataStore[dmxMaxChannel+1] = {};
 int channelSize;
+static int txPos = -1;  // next byte of the frame in transmission or -1 if idle
 
 
 void DMXESPSerial::init() {
   channelSize = defaultMax;
 
-  Serial1.begin(DMXSPEED);
+  Serial1.begin(DMXSPEED, DMXFORMAT);
   pinMode(sendPin, OUTPUT);
   dmxStarted = true;
 }
@@ -52,7 +54,7 @@ void DMXESPSerial::init(int chanQuant) {
 
   channelSize = chanQuant;
 
-  Serial1.begin(DMXSPEED);
+  Serial1.begin(DMXSPEED, DMXFORMAT);
   pinMode(sendPin, OUTPUT);
   dmxStarted = true;
 }
@@ -80,30 +82,47 @@ void DMXESPSerial::write(int Channel, uint8_t value) {
 
 void DMXESPSerial::end() {
   channelSize = 0;
+  txPos = -1;
   Serial1.end();
   dmxStarted = false;
 }
 
-void DMXESPSerial::update() {
-  if (dmxStarted == false) init();
-
-  //Send break
-  digitalWrite(sendPin, HIGH);
-  Serial1.begin(BREAKSPEED, BREAKFORMAT);
-  Serial1.write(0);
-  Serial1.flush();
-  delay(1);
-  Serial1.end();
+uint8_t *DMXESPSerial::getData() {
+  dmxDataStore[0] = 0; // start code
+  return dmxDataStore;
+}
 
-  //send data
-  Serial1.begin(DMXSPEED, DMXFORMAT);
-  digitalWrite(sendPin, LOW);
-  Serial1.write(dmxDataStore, channelSize);
-  Serial1.flush();
-  delay(1);
-  Serial1.end();
+// Serial1 has no TX buffer beyond the 128 byte hardware FIFO, so the frame is fed in chunks
+// whenever this is called (every loop) instead of blocking until all of it is out
+bool DMXESPSerial::sending() {
+  if (txPos < 0) return false;
+  int len = channelSize + 1; // start code + channels
+  if (txPos < len) {
+    int n = min(Serial1.availableForWrite(), len - txPos);
+    if (n > 0) txPos += Serial1.write(dmxDataStore + txPos, n);
+    return true;
+  }
+  if ((USS(UART1) >> USTXC) & 0xff) return true; // FIFO not empty yet
+  txPos = -1;
+  return false;
 }
 
 // Function to update the DMX bus
+void DMXESPSerial::update() {
+  if (dmxStarted == false) init();
+  if (sending()) return;
+
+  // last stop bits may still be shifted out after the FIFO emptied
+  delayMicroseconds(BYTEUS);
+  //Send break by holding TX low, then mark after break
+  USC0(UART1) |= (1 << UCBRK);
+  delayMicroseconds(BREAKUS);
+  USC0(UART1) &= ~(1 << UCBRK);
+  delayMicroseconds(MABUS);
+
+  dmxDataStore[0] = 0;
+  txPos = 0;
+  sending();
+}
 
 #endif
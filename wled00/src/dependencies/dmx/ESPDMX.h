@@ -24,7 +24,9 @@ public:
   void init(int MaxChan);
   uint8_t read(int Channel);
   void write(int channel, uint8_t value);
-  void update();
+  uint8_t *getData();   // channel values, index is DMX address (0 holds start code)
+  bool sending();       // previous frame still being transmitted, tops up the UART FIFO
+  void update();        // starts transmission of a frame (does not wait for it)
   void end();
 };
 
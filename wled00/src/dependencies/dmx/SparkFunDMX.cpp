@@ -21,21 +21,22 @@ Distributed as-is; no warranty is given.
 
 #include "SparkFunDMX.h"
 #include <HardwareSerial.h>
+#include "driver/uart.h"
 
 #define dmxMaxChannel  512
 #define defaultMax 32
 
 #define DMXSPEED       250000
 #define DMXFORMAT      SERIAL_8N2
-#define BREAKSPEED     83333
-#define BREAKFORMAT    SERIAL_8N1
+#define DMXUART        UART_NUM_2
+#define BREAKBITS      25      // break of 100us sent after each frame, precedes the next one (mark after break is the gap until then)
 
 static const int enablePin = -1;		// disable the enable pin because it is not needed
 static const int rxPin = -1;       // disable the receiving pin because it is not needed - softhack007: Pin=-1 means "use default" not "disable"
 static const int txPin = 2;        // transmit DMX data over this pin (default is pin 2)
 
-//DMX value array and size. Entry 0 will hold startbyte
-static uint8_t dmxData[dmxMaxChannel] = { 0 };
+//DMX value array and size. Entry 0 will hold startbyte, so we need 512+1 elements
+static uint8_t dmxData[dmxMaxChannel+1] = { 0 };
 static int chanSize = 0;
 #if !defined(DMX_SEND_ONLY)
 static int currentChannel = 0;
@@ -111,7 +112,21 @@ void SparkFunDMX::initWrite (int chanQuant) {
 
   chanSize = chanQuant + 1; //Add 1 for start code
 
-  DMXSerial.begin(DMXSPEED, DMXFORMAT, rxPin, txPin);
+  // frames are copied into the IDF UART driver ring buffer and sent from its interrupt, so update() does not block
+  // (driver is installed here: HardwareSerial of core 1.0.6 does not use it and cannot size its TX buffer)
+  static bool driverInstalled = false;
+  if (!driverInstalled) {
+    uart_config_t config = {};
+    config.baud_rate = DMXSPEED;
+    config.data_bits = UART_DATA_8_BITS;
+    config.parity    = UART_PARITY_DISABLE;
+    config.stop_bits = UART_STOP_BITS_2;
+    config.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    uart_param_config(DMXUART, &config);
+    uart_set_pin(DMXUART, txPin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    // RX buffer is unused but must be larger than the hardware FIFO
+    driverInstalled = uart_driver_install(DMXUART, UART_FIFO_LEN + 1, dmxMaxChannel + 1 + UART_FIFO_LEN, 0, NULL, 0) == ESP_OK;
+  }
   if (enablePin >= 0) {
     pinMode(enablePin, OUTPUT);
     digitalWrite(enablePin, HIGH);
@@ -129,29 +144,31 @@ uint8_t SparkFunDMX::read(int Channel) {
 // Function to send DMX data
 void SparkFunDMX::write(int Channel, uint8_t value) {
   if (Channel < 0) Channel = 0;
-  if (Channel > chanSize) chanSize = Channel;
+  if (Channel > dmxMaxChannel) return;
+  if (Channel >= chanSize) chanSize = Channel + 1;
   dmxData[0] = 0;
   dmxData[Channel] = value; //add one to account for start byte
 }
 
 
 
+uint8_t *SparkFunDMX::getData() {
+  dmxData[0] = 0; // start code
+  return dmxData;
+}
+
+// true while previous frame (and its trailing break) is still being transmitted
+bool SparkFunDMX::sending() {
+  return _READWRITE == _WRITE && uart_wait_tx_done(DMXUART, 0) == ESP_ERR_TIMEOUT;
+}
+
 void SparkFunDMX::update() {
   if (_READWRITE == _WRITE)
   {
-    //Send DMX break
-    digitalWrite(txPin, HIGH);
-    DMXSerial.begin(BREAKSPEED, BREAKFORMAT, rxPin, txPin);//Begin the Serial port
-    DMXSerial.write(0);
-    DMXSerial.flush();
-    delay(1);
-    DMXSerial.end();
-    
-    //Send DMX data
-    DMXSerial.begin(DMXSPEED, DMXFORMAT, rxPin, txPin);//Begin the Serial port
-    DMXSerial.write(dmxData, chanSize);
-    DMXSerial.flush();
-    DMXSerial.end();//clear our DMX array, end the Hardware Serial port
+    // queue frame followed by break (non blocking), skipped if previous frame is not sent yet
+    if (sending()) return;
+    dmxData[0] = 0;
+    uart_write_bytes_with_break(DMXUART, (const char*)dmxData, chanSize, BREAKBITS);
   }
 #if !defined(DMX_SEND_ONLY)
   else if (_READWRITE == _READ)//In a perfect world, this function ends serial communication upon packet completion and attaches RX to a CHANGE interrupt so the start code can be read again
@@ -31,7 +31,9 @@ public:
   uint8_t read(int Channel);
 #endif
   void write(int channel, uint8_t value);
-  void update();
+  uint8_t *getData();   // channel values, index is DMX address (0 holds start code)
+  bool sending();       // previous frame still being transmitted
+  void update();        // starts transmission of a frame (does not wait for it)
 private:
   const uint8_t _startCodeValue = 0xFF;
   const bool _READ = true;
@@ -59,6 +59,7 @@ typedef struct ip_addr ip4_addr_t;
 #define ARTNET_OPCODE_OPDMX 0x5000
 #define ARTNET_OPCODE_OPPOLL 0x2000
 #define ARTNET_OPCODE_OPPOLLREPLY 0x2100
+#define ARTNET_OPCODE_OPSYNC 0x5200
 
 #define P_E131   0
 #define P_ARTNET 1
@@ -76,7 +77,7 @@ typedef struct ip_addr ip4_addr_t;
 #define E131_FRAME_VECTOR 40
 #define E131_FRAME_SOURCE 44
 #define E131_FRAME_PRIORITY 108
-#define E131_FRAME_RESERVED 109
+#define E131_FRAME_RESERVED 109 // synchronization address
 #define E131_FRAME_SEQ 111
 #define E131_FRAME_OPT 112
 #define E131_FRAME_UNIVERSE 113
@@ -105,7 +106,7 @@ typedef union {
       uint32_t frame_vector;
       uint8_t  source_name[64];
       uint8_t  priority;
-      uint16_t reserved;
+      uint16_t sync_address;
       uint8_t  sequence_number;
       uint8_t  options;
       uint16_t universe;
@@ -120,6 +121,13 @@ typedef union {
       uint8_t  property_values[513];
     } __attribute__((packed));
 	
+  struct { //E1.31 synchronization packet (root vector 8, frame vector 1)
+    uint8_t  sync_header[44];
+    uint8_t  sync_sequence_number;
+    uint16_t sync_universe;
+    uint16_t sync_reserved;
+  } __attribute__((packed));
+
 	struct { //Art-Net packet
     uint8_t  art_id[8];
     uint16_t art_opcode;
@@ -208,6 +216,8 @@ class ESPAsyncE131 {
 	  static const uint8_t ART_ID[];
     static const uint32_t VECTOR_ROOT = 4;
     static const uint32_t VECTOR_FRAME = 2;
+    static const uint32_t VECTOR_ROOT_EXTENDED = 8;
+    static const uint32_t VECTOR_EXTENDED_SYNC = 1;
     static const uint8_t VECTOR_DMP = 2;
 
     AsyncUDP        udp;        // AsyncUDP
@@ -0,0 +1,175 @@
+#include "wled.h"
+#include <memory>
+
+/*
+ * Event trace recorder (GET /json/trace, ?on=1 starts, ?on=0 stops recording)
+ * Timestamped events are written into a ring of WLED_TRACE_LEN entries, allocated when recording starts.
+ * Writers claim a slot with one atomic increment and never wait, the ring overwrites its oldest events.
+ * Timed events are recorded once they end (start and duration), so a ring entry is a complete event
+ * and the ring is in order of event ends (trace viewers sort by start).
+ * Export is Chrome/Perfetto trace JSON (chrome://tracing, ui.perfetto.dev), streamed from the ring
+ * while recording is paused. Timestamps are micros(), the export is relative to the oldest event.
+ */
+
+#ifndef WLED_DISABLE_TRACE
+
+typedef struct TraceEvent {
+  uint32_t ts;   // micros() at start
+  uint32_t dur;  // us, 0 for instant events
+  uint16_t data; // event specific (effect, JSON wait...)
+  uint8_t  ev;   // TRACE_*
+  uint8_t  arg;  // event specific (segment, bus, task...)
+} trace_event_t;
+
+volatile bool traceOn = false;
+static trace_event_t    *traceRing = nullptr;
+static volatile uint32_t traceHead = 0; // events written since recording was started
+
+void traceRecord(uint8_t ev, uint8_t arg, uint16_t data, uint32_t ts, uint32_t dur)
+{
+  #ifdef ARDUINO_ARCH_ESP32
+  uint32_t i = __atomic_fetch_add(&traceHead, 1, __ATOMIC_RELAXED);
+  #else
+  uint32_t i = traceHead++; // single core, events are not recorded from interrupts
+  #endif
+  trace_event_t &e = traceRing[i & (WLED_TRACE_LEN-1)];
+  e.ts   = ts;
+  e.dur  = dur;
+  e.data = data;
+  e.ev   = ev;
+  e.arg  = arg;
+}
+
+bool traceStart()
+{
+  if (!traceRing) traceRing = (trace_event_t*) heapCallocLarge(HEAP_TAG_OTHER, WLED_TRACE_LEN, sizeof(trace_event_t));
+  if (!traceRing) return false;
+  traceHead = 0;
+  traceOn = true;
+  return true;
+}
+
+void traceStop() { traceOn = false; }
+
+struct TraceStream {
+  uint32_t first = 0, count = 0, pos = 0; // ring index of oldest event, events, next event
+  uint32_t base = 0;                      // ts of oldest event
+  uint8_t  track = 0;                     // track names written
+  bool     wasOn = false, done = false;
+  uint16_t len = 0, out = 0;              // pending bytes in line[]
+  char     line[200];
+  ~TraceStream() { traceOn = wasOn; }
+};
+
+// tracks (Chrome "threads"): 1 loop, 2-3 effects per core, 4 output, 5 network, JSON buffers, bus transfers
+#define TRACK_JSON 6
+#define TRACK_BUS  (TRACK_JSON + WLED_JSON_POOL_SIZE)
+#define TRACKS     (TRACK_BUS + WLED_MAX_BUSSES + WLED_MIN_VIRTUAL_BUSSES)
+
+static uint8_t traceTrack(const trace_event_t &e)
+{
+  switch (e.ev) {
+    case TRACE_LOOP: case TRACE_TASK: return 1;
+    case TRACE_FX:                    return 2 + (e.data >> 8);
+    case TRACE_SHOW: case TRACE_BUS:  return 4;
+    case TRACE_PACKET: case TRACE_WS: return 5;
+    case TRACE_JSON:                  return TRACK_JSON + (e.data >> 12);
+    case TRACE_BUS_DONE:              return TRACK_BUS + e.arg;
+  }
+  return 0;
+}
+
+static bool nextTraceEvent(TraceStream &ts)
+{
+  char *l = ts.line;
+  const size_t sz = sizeof(ts.line);
+  int n = 0;
+  if (ts.track < TRACKS) {
+    const uint8_t t = ts.track++;
+    if (t == 0) n = snprintf_P(l, sz, PSTR("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"WLED\"}}"));
+    else {
+      n = snprintf_P(l, sz, PSTR(",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\""), t);
+      if      (t == 1)          n += snprintf_P(l+n, sz-n, PSTR("loop"));
+      else if (t < 4)           n += snprintf_P(l+n, sz-n, PSTR("effects core %u"), t-2);
+      else if (t == 4)          n += snprintf_P(l+n, sz-n, PSTR("output"));
+      else if (t == 5)          n += snprintf_P(l+n, sz-n, PSTR("network"));
+      else if (t < TRACK_BUS)   n += snprintf_P(l+n, sz-n, PSTR("JSON buffer %u"), t-TRACK_JSON);
+      else                      n += snprintf_P(l+n, sz-n, PSTR("bus %u transfer"), t-TRACK_BUS);
+      n += snprintf_P(l+n, sz-n, PSTR("\"}}"));
+    }
+  } else if (ts.pos < ts.count) {
+    const trace_event_t e = traceRing[(ts.first + ts.pos++) & (WLED_TRACE_LEN-1)];
+    n = snprintf_P(l, sz, PSTR(",{\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%u"), e.dur ? 'X' : 'i', traceTrack(e), (unsigned)(e.ts - ts.base));
+    if (e.dur) n += snprintf_P(l+n, sz-n, PSTR(",\"dur\":%u"), (unsigned)e.dur);
+    else       n += snprintf_P(l+n, sz-n, PSTR(",\"s\":\"t\""));
+    switch (e.ev) {
+      case TRACE_LOOP:     n += snprintf_P(l+n, sz-n, PSTR(",\"name\":\"loop\"}")); break;
+      case TRACE_TASK: {
+        const sched_task_t *task = getSchedTask(e.arg);
+        n += snprintf_P(l+n, sz-n, PSTR(",\"name\":\"%s\"}"), task ? task->name : "task");
+        break;
+      }
+      case TRACE_FX:       n += snprintf_P(l+n, sz-n, PSTR(",\"name\":\"fx %u\",\"args\":{\"seg\":%u}}"), e.data & 0xFF, e.arg); break;
+      case TRACE_SHOW:     n += snprintf_P(l+n, sz-n, PSTR(",\"name\":\"show\"}")); break;
+      case TRACE_BUS:      n += snprintf_P(l+n, sz-n, PSTR(",\"name\":\"bus %u\"}"), e.arg); break;
+      case TRACE_BUS_DONE: n += snprintf_P(l+n, sz-n, PSTR(",\"name\":\"frame\"}")); break;
+      case TRACE_PACKET:   n += snprintf_P(l+n, sz-n, PSTR(",\"name\":\"packet\",\"args\":{\"mode\":%u}}"), e.arg); break;
+      case TRACE_WS:       n += snprintf_P(l+n, sz-n, PSTR(",\"name\":\"ws send\",\"args\":{\"clients\":%u}}"), e.arg); break;
+      case TRACE_JSON:     n += snprintf_P(l+n, sz-n, PSTR(",\"name\":\"owner %u\",\"args\":{\"wait\":%u}}"), e.arg, e.data & 0x0FFF); break;
+      default:             n += snprintf_P(l+n, sz-n, PSTR(",\"name\":\"%u\"}"), e.ev); break;
+    }
+  } else if (!ts.done) {
+    n = snprintf_P(l, sz, PSTR("]}"));
+    ts.done = true;
+  } else return false;
+  ts.len = min(n, (int)sz-1);
+  ts.out = 0;
+  return true;
+}
+
+void serveTrace(AsyncWebServerRequest* request)
+{
+  if (request->hasParam(F("on"))) {
+    bool ok = true;
+    if (request->getParam(F("on"))->value().toInt()) ok = traceStart();
+    else traceStop();
+    uint32_t head = traceHead;
+    char s[48];
+    snprintf_P(s, sizeof(s), PSTR("{\"on\":%s,\"n\":%u}"), traceOn ? "true" : "false", (unsigned)min(head, (uint32_t)WLED_TRACE_LEN));
+    request->send(ok ? 200 : 503, "application/json", s);
+    return;
+  }
+  std::shared_ptr<TraceStream> ts = std::make_shared<TraceStream>();
+  ts->wasOn = traceOn;
+  traceOn = false; // ring is read while recording is paused
+  if (traceRing) {
+    uint32_t head = traceHead;
+    ts->count = min(head, (uint32_t)WLED_TRACE_LEN);
+    ts->first = head - ts->count;
+    if (ts->count) ts->base = traceRing[ts->first & (WLED_TRACE_LEN-1)].ts;
+    for (uint32_t i = 1; i < ts->count; i++) { // events are in order of their end
+      uint32_t t = traceRing[(ts->first + i) & (WLED_TRACE_LEN-1)].ts;
+      if ((int32_t)(t - ts->base) < 0) ts->base = t;
+    }
+  }
+  AsyncWebServerResponse *response = request->beginChunkedResponse(F("application/json"), [ts](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+    size_t written = 0;
+    while (written < maxLen) {
+      if (ts->out >= ts->len && !nextTraceEvent(*ts)) break;
+      size_t n = min((size_t)(ts->len - ts->out), maxLen - written);
+      memcpy(buffer + written, ts->line + ts->out, n);
+      ts->out += n;
+      written += n;
+    }
+    return written;
+  });
+  response->addHeader(F("Cache-Control"), F("no-store"));
+  response->addHeader(F("Content-Disposition"), F("attachment; filename=wled-trace.json"));
+  request->send(response);
+}
+
+#else
+bool traceStart() { return false; }
+void traceStop() {}
+void serveTrace(AsyncWebServerRequest* request) { request->send(501); }
+#endif
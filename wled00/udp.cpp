@@ -4,15 +4,50 @@
  * UDP sync notifier / Realtime / Hyperion / TPM2.NET
  */
 
-#define UDP_SEG_SIZE 36
 #define SEG_OFFSET (41+(MAX_NUM_SEGMENTS*UDP_SEG_SIZE))
-#define WLEDPACKETSIZE (41+(MAX_NUM_SEGMENTS*UDP_SEG_SIZE)+0)
 #define UDP_IN_MAXSIZE 1472
 #define PRESUMED_NETWORK_DELAY 3 //how many ms could it take on avg to reach the receiver? This will be added to transmitted times
+#define UDP_RX_BURST 16        // most packets handled per loop
+#define UDP_RX_BUDGET_US 4000  // time budget for handling queued packets per loop (us), 4x with realtime profile
+
+// notifications are coalesced: notify() only marks one as pending, it is sent at most once per frame
+static bool notifyPending = false;
+static byte notifyPendingMode = CALL_MODE_INIT;
+static bool notifyPendingFollowUp = false;
+
+// delta notifications: changed byte runs against the last full packet (keyframe) sent
+// deltas are cumulative, so a lost one is healed by the next (or by a retransmission)
+static uint8_t *notifyBase = nullptr;
+static uint8_t notifyKeySeq = 0, notifyDeltaSeq = 0;
+static unsigned long notifyKeyTime = 0;
+// receiver side: last keyframe of the sender we follow
+static uint8_t *notifyRxBase = nullptr;
+static uint16_t notifyRxLen = 0;
+static uint8_t notifyRxSeq = 0, notifyRxDeltaSeq = 0;
+static IPAddress notifyRxIP;
+
+// received notifications are staged (last one wins) and applied once per loop, before the next frame is rendered
+// retransmissions and identical packets of other senders (same content apart from call mode, follow up flag and times)
+// received within WLED_NOTIFY_DEDUP_MS of the last applied one are dropped
+#ifndef WLED_NOTIFY_DEDUP_MS
+  #define WLED_NOTIFY_DEDUP_MS 2000
+#endif
+static uint8_t *notifyStaged = nullptr; // WLEDPACKETSIZE
+static bool notifyStagedPending = false;
+static unsigned long notifyStagedTime = 0;
+static uint32_t notifyAppliedHash = 0;
+static unsigned long notifyAppliedTime = 0;
+
+static void sendNotifyPacket(byte callMode, bool followUp);
+static void handleClockSyncPacket(const uint8_t *udpIn, uint16_t len, unsigned long rxTime);
 
 void notify(byte callMode, bool followUp)
 {
+  #ifndef WLED_DISABLE_ESPNOW
+  if (!udpConnected && !espNowSync) return;
+  #else
   if (!udpConnected) return;
+  #endif
   if (!syncGroups) return;
   switch (callMode)
   {
@@ -26,7 +61,37 @@ void notify(byte callMode, bool followUp)
     case CALL_MODE_ALEXA:         if (!notifyAlexa)  return; break;
     default: return;
   }
+  notifyPendingMode = callMode;
+  notifyPendingFollowUp = followUp && !(notifyPending && !notifyPendingFollowUp); // a pending change is never demoted to a retransmission
+  notifyPending = true;
+}
+
+// changed runs as [offset hi, offset lo, length, bytes], gaps of up to 3 unchanged bytes are included
+// returns 0 if encoded size would exceed maxLen
+static size_t encodeNotifyDelta(const uint8_t *pkt, const uint8_t *base, size_t len, uint8_t *out, size_t maxLen)
+{
+  size_t o = 0, i = 0;
+  while (i < len) {
+    if (pkt[i] == base[i]) { i++; continue; }
+    size_t last = i;
+    for (size_t end = i + 1; end < len && end - i < 255 && end - last <= 3; end++)
+      if (pkt[end] != base[end]) last = end;
+    size_t n = last - i + 1;
+    if (o + 3 + n > maxLen) return 0;
+    out[o++] = i >> 8;
+    out[o++] = i & 0xFF;
+    out[o++] = n;
+    memcpy(out + o, pkt + i, n);
+    o += n;
+    i = last + 1;
+  }
+  return o;
+}
+
+static void sendNotifyPacket(byte callMode, bool followUp)
+{
   byte udpOut[WLEDPACKETSIZE];
+  memset(udpOut, 0, sizeof(udpOut)); // unused segment slots must not differ between packets
   Segment& mainseg = strip.getMainSegment();
   udpOut[0] = 0; //0: wled notifier protocol 1: WARLS protocol
   udpOut[1] = callMode;
@@ -138,26 +203,236 @@ void notify(byte callMode, bool followUp)
   //uint16_t offs = SEG_OFFSET;
   //next value to be added has index: udpOut[offs + 0]
 
-  IPAddress broadcastIp;
-  broadcastIp = ~uint32_t(Network.subnetMask()) | uint32_t(Network.gatewayIP());
+  #ifndef WLED_DISABLE_ESPNOW
+  if (espNowSync) {
+    espNowSendNotify(udpOut, 41 + s*UDP_SEG_SIZE); // only active segments, receivers use udpOut[39]
+  } else
+  #endif
+  {
+    IPAddress broadcastIp;
+    broadcastIp = ~uint32_t(Network.subnetMask()) | uint32_t(Network.gatewayIP());
+
+    // keyframe trailer: receivers supporting deltas keep this packet as base
+    udpOut[WLEDPACKETSIZE-2] = UDP_NOTIFY_DELTA;
+    udpOut[WLEDPACKETSIZE-1] = notifyKeySeq;
+
+    byte delta[WLEDPACKETSIZE/2];
+    size_t dlen = 0;
+    if (udpDeltaNotify && !notifyBase) notifyBase = (uint8_t*) malloc(WLEDPACKETSIZE);
+    if (udpDeltaNotify && notifyBase && millis() - notifyKeyTime < WLED_NOTIFY_KEYFRAME_INTERVAL) {
+      delta[0] = UDP_NOTIFY_DELTA;
+      delta[1] = 1; // delta version
+      delta[2] = notifyKeySeq;
+      delta[3] = WLEDPACKETSIZE >> 8;
+      delta[4] = WLEDPACKETSIZE & 0xFF;
+      delta[5] = ++notifyDeltaSeq;
+      size_t n = encodeNotifyDelta(udpOut, notifyBase, WLEDPACKETSIZE, delta + 6, sizeof(delta) - 6);
+      if (n) dlen = n + 6;
+    }
 
-  notifierUdp.beginPacket(broadcastIp, udpPort);
-  notifierUdp.write(udpOut, WLEDPACKETSIZE);
-  notifierUdp.endPacket();
+    notifierUdp.beginPacket(broadcastIp, udpPort);
+    if (dlen) {
+      notifierUdp.write(delta, dlen);
+    } else {
+      if (udpDeltaNotify && notifyBase) { // new keyframe
+        udpOut[WLEDPACKETSIZE-1] = ++notifyKeySeq;
+        memcpy(notifyBase, udpOut, WLEDPACKETSIZE);
+        notifyKeyTime = millis();
+        notifyDeltaSeq = 0;
+      }
+      notifierUdp.write(udpOut, WLEDPACKETSIZE);
+    }
+    notifierUdp.endPacket(); udpPacketsOut++;
+  }
   notificationSentCallMode = callMode;
   notificationSentTime = millis();
   notificationCount = followUp ? notificationCount + 1 : 0;
 }
 
+// realtime input statistics, allocated on first realtime packet
+static realtime_stats_t *rtStats = nullptr;
+static udp_rx_stats_t udpRxStats = {0};
+
+static realtime_stats_t* realtimeStatsFor(byte md) {
+  if (md == REALTIME_MODE_INACTIVE || md > REALTIME_MODE_LAST) return nullptr;
+  if (!rtStats) rtStats = (realtime_stats_t*) calloc(REALTIME_MODE_LAST, sizeof(realtime_stats_t));
+  return rtStats ? &rtStats[md-1] : nullptr;
+}
+
+// rolls per second counters over, rates drop to 0 if a source went silent
+static void realtimeStatsRoll(realtime_stats_t *st) {
+  uint32_t elapsed = millis() - st->secStart;
+  if (elapsed < 1000) return;
+  st->pps = elapsed < 2000 ? st->secPackets : 0;
+  st->fps = elapsed < 2000 ? st->secFrames  : 0;
+  st->secPackets = st->secFrames = 0;
+  st->secStart = millis();
+}
+
+static void realtimeStatsPacket(byte md) {
+  realtime_stats_t *st = realtimeStatsFor(md);
+  if (!st) return;
+  realtimeStatsRoll(st);
+  traceEvent(TRACE_PACKET, md, 0, micros());
+  st->packets++;
+  st->secPackets++;
+  if (!st->inFrame) {
+    st->frameStart = micros();
+    st->inFrame = true;
+  }
+}
+
+void realtimeStatsDropped(byte md) {
+  realtime_stats_t *st = realtimeStatsFor(md);
+  if (!st) return;
+  realtimeStatsRoll(st);
+  st->packets++;
+  st->secPackets++;
+  st->dropped++;
+}
+
+void realtimeStatsDuplicate(byte md) {
+  realtime_stats_t *st = realtimeStatsFor(md);
+  if (st) st->duplicates++;
+}
+
+// call after a realtime frame was shown
+void realtimeStatsShown() {
+  realtime_stats_t *st = realtimeStatsFor(realtimeMode);
+  if (!st) return;
+  realtimeStatsRoll(st);
+  st->frames++;
+  st->secFrames++;
+  if (!st->inFrame) return;
+  st->inFrame = false;
+  st->lat[st->latPos] = MIN(micros() - st->frameStart, (uint32_t)UINT16_MAX);
+  st->latPos = (st->latPos + 1) % RT_STATS_SAMPLES;
+  if (st->latCount < RT_STATS_SAMPLES) st->latCount++;
+}
+
+// nullptr if source never sent anything
+const realtime_stats_t* getRealtimeStats(byte md) {
+  if (!rtStats || md == REALTIME_MODE_INACTIVE || md > REALTIME_MODE_LAST) return nullptr;
+  realtime_stats_t *st = &rtStats[md-1];
+  if (!st->packets) return nullptr;
+  realtimeStatsRoll(st);
+  return st;
+}
+
+void resetRealtimeStats() {
+  if (rtStats) memset((void*)rtStats, 0, REALTIME_MODE_LAST * sizeof(realtime_stats_t));
+  udpRxStats.backlogged = udpRxStats.cut = 0;
+  #ifdef WLED_ENABLE_DMX_INPUT
+  resetDMXInputStats();
+  #endif
+}
+
+bool realtimeSegmentsOnly()
+{
+  return useMainSegmentOnly || realtimeRouteCount;
+}
+
+// segments receiving realtime data (routes or main segment), returns their number
+static unsigned liveSegmentIds(uint8_t *ids)
+{
+  unsigned n = 0;
+  if (realtimeRouteCount) {
+    for (unsigned r = 0; r < realtimeRouteCount; r++) {
+      uint8_t id = realtimeRoutes[r].seg;
+      if (id >= strip.getSegmentsNum()) continue;
+      unsigned j = 0;
+      while (j < n && ids[j] != id) j++;
+      if (j == n) ids[n++] = id;
+    }
+  } else if (useMainSegmentOnly) {
+    ids[n++] = strip.getMainSegmentId();
+  }
+  return n;
+}
+
+// segments receiving realtime data are frozen (their effects do not run) while realtime mode is active
+void realtimeFreezeSegments(bool freeze)
+{
+  uint8_t ids[WLED_MAX_RT_ROUTES];
+  for (unsigned n = liveSegmentIds(ids), i = 0; i < n; i++) strip.getSegment(ids[i]).freeze = freeze;
+}
+
+/*
+ * Realtime fade (realtimeFade): live segments are layers whose liveAlpha is ramped over transitionDelay,
+ * composited over the segments below them like any layered segment. On realtime start the (cleared) live
+ * segments fade in, on timeout the realtime data fades out, then the segments' own effects fade in again.
+ */
+#define RT_FADE_NONE 0
+#define RT_FADE_IN   1 // realtime data fades in
+#define RT_FADE_OUT  2 // realtime data fades out (segments still frozen)
+#define RT_FADE_FX   3 // segment effects fade in after realtime ended
+static uint8_t rtFadeState = RT_FADE_NONE;
+static uint8_t rtFadeFrom = 0;
+static unsigned long rtFadeStart = 0;
+
+static inline bool realtimeFadeEnabled()
+{
+  return realtimeFade && transitionDelay && realtimeSegmentsOnly();
+}
+
+static void setLiveAlpha(uint8_t a)
+{
+  uint8_t ids[WLED_MAX_RT_ROUTES];
+  for (unsigned n = liveSegmentIds(ids), i = 0; i < n; i++) strip.getSegment(ids[i]).liveAlpha = a;
+}
+
+static uint8_t liveAlpha()
+{
+  uint8_t ids[WLED_MAX_RT_ROUTES];
+  return liveSegmentIds(ids) ? strip.getSegment(ids[0]).liveAlpha : 255;
+}
+
+static void startRealtimeFade(uint8_t state)
+{
+  rtFadeFrom  = state == RT_FADE_FX ? 0 : liveAlpha();
+  rtFadeStart = millis();
+  rtFadeState = state;
+}
+
+// called every loop
+void handleRealtimeFade()
+{
+  if (rtFadeState == RT_FADE_NONE) return;
+  uint32_t elapsed = millis() - rtFadeStart;
+  unsigned p = elapsed >= transitionDelay ? 255 : elapsed * 255 / transitionDelay;
+  if (rtFadeState == RT_FADE_OUT) {
+    setLiveAlpha(rtFadeFrom * (255 - p) / 255);
+    if (p < 255) return;
+    realtimeFreezeSegments(false); // realtime data is gone, let effects run again
+    startRealtimeFade(RT_FADE_FX);
+    return;
+  }
+  setLiveAlpha(rtFadeFrom + (255 - rtFadeFrom) * p / 255);
+  if (p == 255) rtFadeState = RT_FADE_NONE;
+}
+
 void realtimeLock(uint32_t timeoutMs, byte md)
 {
-  if (!realtimeMode && !realtimeOverride) {
+  idleWake();
+  realtimeStatsPacket(md);
+
+  if (!realtimeMode && !realtimeOverride && rtFadeState == RT_FADE_OUT) {
+    // data returned while fading out: segments still hold realtime data, fade back in from where we are
+    startRealtimeFade(RT_FADE_IN);
+  } else if (!realtimeMode && !realtimeOverride && realtimeRouteCount) {
+    // routed segments: clear their buffers, all other segments keep running (unless WLED was off, then they stay off)
+    if (bri == 0) for (size_t s = 0; s < strip.getSegmentsNum(); s++) strip.getSegment(s).freeze = true;
+    realtimeFreezeSegments(true);
+    for (unsigned r = 0; r < realtimeRouteCount; r++)
+      if (realtimeRoutes[r].seg < strip.getSegmentsNum()) strip.getSegment(realtimeRoutes[r].seg).fill(BLACK);
+  } else if (!realtimeMode && !realtimeOverride) {
     uint16_t stop, start;
     if (useMainSegmentOnly) {
       Segment& mainseg = strip.getMainSegment();
       start = mainseg.start;
       stop  = mainseg.stop;
       mainseg.freeze = true;
+      mainseg.fill(BLACK); // clear segment buffer as it is drawn every frame
     } else {
       start = 0;
       stop  = strip.getLengthTotal();
@@ -171,6 +446,10 @@ void realtimeLock(uint32_t timeoutMs, byte md)
       }
     }
   }
+  if (!realtimeMode && !realtimeOverride && rtFadeState != RT_FADE_IN && realtimeFadeEnabled()) {
+    setLiveAlpha(0);
+    startRealtimeFade(RT_FADE_IN);
+  }
   // if strip is off (bri==0) and not already in RTM
   if (briT == 0 && !realtimeMode && !realtimeOverride) {
     strip.setBrightness(scaledBri(briLast), true);
@@ -179,6 +458,12 @@ void realtimeLock(uint32_t timeoutMs, byte md)
   if (realtimeTimeout != UINT32_MAX) {
     realtimeTimeout = (timeoutMs == 255001 || timeoutMs == 65000) ? UINT32_MAX : millis() + timeoutMs;
   }
+  if (md != realtimeMode && usermods.wantsEvent(UM_EVENT_REALTIME)) {
+    um_event_t ev = {UM_EVENT_REALTIME, CALL_MODE_NO_NOTIFY};
+    ev.realtime.mode = md;
+    ev.realtime.oldMode = realtimeMode;
+    usermods.dispatchEvent(ev);
+  }
   realtimeMode = md;
 
   if (realtimeOverride) return;
@@ -186,19 +471,38 @@ void realtimeLock(uint32_t timeoutMs, byte md)
   if (briT > 0 && md == REALTIME_MODE_GENERIC) strip.show();
 }
 
+// common entry of all realtime decoders: locks the strip for mode md, true if the pixel data of the packet is to be applied
+// (realtime override only lets data through to live segments)
+bool realtimeLockData(uint32_t timeoutMs, byte md)
+{
+  realtimeLock(timeoutMs, md);
+  return !realtimeOverride || (realtimeMode && realtimeSegmentsOnly());
+}
+
 void exitRealtime() {
   if (!realtimeMode) return;
+  byte md = realtimeMode;
   if (realtimeOverride == REALTIME_OVERRIDE_ONCE) realtimeOverride = REALTIME_OVERRIDE_NONE;
   strip.setBrightness(scaledBri(bri), true);
   realtimeTimeout = 0; // cancel realtime mode immediately
   realtimeMode = REALTIME_MODE_INACTIVE; // inform UI immediately
   realtimeIP[0] = 0;
-  if (useMainSegmentOnly) { // unfreeze live segment again
-    strip.getMainSegment().freeze = false;
+  if (realtimeSegmentsOnly() && realtimeFadeEnabled() && !realtimeOverride) {
+    startRealtimeFade(RT_FADE_OUT); // live segments are unfrozen once faded out
+  } else if (realtimeSegmentsOnly()) { // unfreeze live segments again
+    rtFadeState = RT_FADE_NONE;
+    setLiveAlpha(255);
+    realtimeFreezeSegments(false);
   } else {
     strip.show(); // possible fix for #3589
   }
   updateInterfaces(CALL_MODE_WS_SEND);
+  if (usermods.wantsEvent(UM_EVENT_REALTIME)) {
+    um_event_t ev = {UM_EVENT_REALTIME, CALL_MODE_WS_SEND};
+    ev.realtime.mode = REALTIME_MODE_INACTIVE;
+    ev.realtime.oldMode = md;
+    usermods.dispatchEvent(ev);
+  }
 }
 
 
@@ -208,268 +512,406 @@ void sendTPM2Ack() {
   notifierUdp.beginPacket(notifierUdp.remoteIP(), TMP2NET_OUT_PORT);
   uint8_t response_ack = 0xac;
   notifierUdp.write(&response_ack, 1);
-  notifierUdp.endPacket();
+  notifierUdp.endPacket(); udpPacketsOut++;
 }
 
 
+// full packets with keyframe trailer are kept as base for following delta packets of the same sender
+static void storeNotifyBase(const uint8_t *udpIn, uint16_t len, IPAddress ip)
+{
+  if (len < 43 || udpIn[len-2] != UDP_NOTIFY_DELTA) return; // sender does not send deltas
+  if (len != notifyRxLen || !notifyRxBase) {
+    free(notifyRxBase);
+    notifyRxBase = (uint8_t*) malloc(len);
+    notifyRxLen = notifyRxBase ? len : 0;
+    if (!notifyRxBase) return;
+  }
+  memcpy(notifyRxBase, udpIn, len);
+  notifyRxSeq = udpIn[len-1];
+  notifyRxDeltaSeq = 0;
+  notifyRxIP = ip;
+}
+
+// rebuilds the full packet from keyframe and delta, ignores deltas without matching keyframe and stale/repeated deltas
+static void applyNotifyDelta(const uint8_t *udpIn, uint16_t len, IPAddress ip)
+{
+  if (len < 6 || udpIn[1] != 1 || !notifyRxBase || ip != notifyRxIP) return;
+  if (udpIn[2] != notifyRxSeq || ((udpIn[3] << 8) | udpIn[4]) != notifyRxLen) return;
+  if ((int8_t)(udpIn[5] - notifyRxDeltaSeq) <= 0) return;
+  uint8_t pkt[notifyRxLen];
+  memcpy(pkt, notifyRxBase, notifyRxLen);
+  for (size_t i = 6; i + 3 <= len; ) {
+    uint16_t ofs = (udpIn[i] << 8) | udpIn[i+1];
+    uint8_t n = udpIn[i+2];
+    if (i + 3 + n > len || ofs + n > notifyRxLen) return; // malformed
+    memcpy(pkt + ofs, udpIn + i + 3, n);
+    i += 3 + n;
+  }
+  notifyRxDeltaSeq = udpIn[5];
+  parseNotifyPacket(pkt, notifyRxLen);
+}
+
+// hash of the state carried by a notification, ignoring call mode (1), follow up flag (24), timebase and time (25-35)
+// and the keyframe trailer
+static uint32_t notifyContentHash(const uint8_t *udpIn, size_t len)
+{
+  if (udpIn[11] > 10 && udpIn[11] < 200 && len > 41) len = MIN(len, 41U + udpIn[39]*udpIn[40]);
+  uint32_t h = fnv1a(udpIn, MIN(len, (size_t)1));
+  if (len > 2)  h = fnv1a(udpIn + 2, MIN(len, (size_t)24) - 2, h);
+  if (len > 36) h = fnv1a(udpIn + 36, len - 36, h);
+  return h;
+}
+
+// stages a WLED sync notification (received via UDP or ESP-NOW), applied by commitNotifyPacket()
+void parseNotifyPacket(const uint8_t *udpIn, size_t len)
+{
+  //ignore notification if received within a second after sending a notification ourselves
+  if (millis() - notificationSentTime < 1000) return;
+  if (len < 12 || udpIn[1] > 199) return; //do not receive custom versions
+
+  //compatibilityVersionByte:
+  byte version = udpIn[11];
+
+  // if we are not part of any sync group ignore message
+  if (version < 9 || version > 199) {
+    // legacy senders are treated as if sending in sync group 1 only
+    if (!(receiveGroups & 0x01)) return;
+  } else if (len < 37 || !(receiveGroups & udpIn[36])) return;
+
+  if (!notifyStaged) notifyStaged = (uint8_t*) malloc(WLEDPACKETSIZE);
+  if (!notifyStaged) return;
+  if (len > WLEDPACKETSIZE) len = WLEDPACKETSIZE;
+  memcpy(notifyStaged, udpIn, len);
+  memset(notifyStaged + len, 0, WLEDPACKETSIZE - len); // fields legacy packets do not carry
+  notifyStagedTime = millis();
+  notifyStagedPending = true;
+}
+
+static void applyNotifyPacket(const uint8_t *udpIn, unsigned long rxTime);
+
+// applies the staged notification, once per loop (frame boundary)
+static void commitNotifyPacket()
+{
+  if (!notifyStagedPending) return;
+  notifyStagedPending = false;
+  if ((long)(notificationSentTime - notifyStagedTime) > 0) return; // superseded by a local change sent meanwhile
+  uint32_t h = notifyContentHash(notifyStaged, WLEDPACKETSIZE);
+  if (h == notifyAppliedHash && millis() - notifyAppliedTime < WLED_NOTIFY_DEDUP_MS) return; // retransmission or other sender
+  notifyAppliedHash = h;
+  notifyAppliedTime = millis();
+  applyNotifyPacket(notifyStaged, notifyStagedTime);
+}
+
+static void applyNotifyPacket(const uint8_t *udpIn, unsigned long rxTime)
+{
+  byte version = udpIn[11];
+  bool someSel = (receiveNotificationBrightness || receiveNotificationColor || receiveNotificationEffects);
+
+  // set transition time before making any segment changes
+  if (version > 3) {
+    if (fadeTransition) {
+      jsonTransitionOnce = true;
+      strip.setTransition(((udpIn[17] << 0) & 0xFF) + ((udpIn[18] << 8) & 0xFF00));
+    }
+  }
+
+  //apply colors from notification to main segment, only if not syncing full segments
+  if ((receiveNotificationColor || !someSel) && (version < 11 || !receiveSegmentOptions)) {
+    // primary color, only apply white if intended (version > 0)
+    strip.setColor(0, RGBW32(udpIn[3], udpIn[4], udpIn[5], (version > 0) ? udpIn[10] : 0));
+    if (version > 1) {
+      strip.setColor(1, RGBW32(udpIn[12], udpIn[13], udpIn[14], udpIn[15])); // secondary color
+    }
+    if (version > 6) {
+      strip.setColor(2, RGBW32(udpIn[20], udpIn[21], udpIn[22], udpIn[23])); // tertiary color
+      if (version > 9 && version < 200 && udpIn[37] < 255) { // valid CCT/Kelvin value
+        uint16_t cct = udpIn[38];
+        if (udpIn[37] > 0) { //Kelvin
+          cct |= (udpIn[37] << 8);
+        }
+        strip.setCCT(cct);
+      }
+    }
+  }
+
+  bool timebaseUpdated = false;
+  //apply effects from notification
+  bool applyEffects = (receiveNotificationEffects || !someSel);
+  if (version < 200)
+  {
+    if (applyEffects && currentPlaylist >= 0) unloadPlaylist();
+    if (version > 10 && (receiveSegmentOptions || receiveSegmentBounds)) {
+      uint8_t numSrcSegs = udpIn[39];
+      for (size_t i = 0; i < numSrcSegs; i++) {
+        uint16_t ofs = 41 + i*udpIn[40]; //start of segment offset byte
+        uint8_t id = udpIn[0 +ofs];
+        if (id > strip.getSegmentsNum()) break;
+
+        Segment& selseg = strip.getSegment(id);
+        if (!selseg.isActive() || !selseg.isSelected()) continue; //do not apply to non selected segments
+
+        uint16_t startY = 0, start  = (udpIn[1+ofs] << 8 | udpIn[2+ofs]);
+        uint16_t stopY  = 1, stop   = (udpIn[3+ofs] << 8 | udpIn[4+ofs]);
+        uint16_t offset = (udpIn[7+ofs] << 8 | udpIn[8+ofs]);
+        if (!receiveSegmentOptions) {
+          selseg.setUp(start, stop, selseg.grouping, selseg.spacing, offset, startY, stopY);
+          continue;
+        }
+        //for (size_t j = 1; j<4; j++) selseg.setOption(j, (udpIn[9 +ofs] >> j) & 0x01); //only take into account mirrored, on, reversed; ignore selected
+        selseg.options = (selseg.options & 0x0071U) | (udpIn[9 +ofs] & 0x0E); // ignore selected, freeze, reset & transitional
+        selseg.updateGeometry();
+        selseg.setOpacity(udpIn[10+ofs]);
+        if (applyEffects) {
+          strip.setMode(id,  udpIn[11+ofs]);
+          selseg.speed     = udpIn[12+ofs];
+          selseg.intensity = udpIn[13+ofs];
+          selseg.palette   = udpIn[14+ofs];
+        }
+        if (receiveNotificationColor || !someSel) {
+          selseg.setColor(0, RGBW32(udpIn[15+ofs],udpIn[16+ofs],udpIn[17+ofs],udpIn[18+ofs]));
+          selseg.setColor(1, RGBW32(udpIn[19+ofs],udpIn[20+ofs],udpIn[21+ofs],udpIn[22+ofs]));
+          selseg.setColor(2, RGBW32(udpIn[23+ofs],udpIn[24+ofs],udpIn[25+ofs],udpIn[26+ofs]));
+          selseg.setCCT(udpIn[27+ofs]);
+        }
+        if (version > 11) {
+          // when applying synced options ignore selected as it may be used as indicator of which segments to sync
+          // freeze, reset should never be synced
+          // LSB to MSB: select, reverse, on, mirror, freeze, reset, reverse_y, mirror_y, transpose, map1d2d (3), ssim (2), set (2)
+          selseg.options = (selseg.options & 0b0000000000110001U) | (udpIn[28+ofs]<<8) | (udpIn[9 +ofs] & 0b11001110U); // ignore selected, freeze, reset
+          selseg.updateGeometry();
+          if (applyEffects) {
+            selseg.custom1 = udpIn[29+ofs];
+            selseg.custom2 = udpIn[30+ofs];
+            selseg.custom3 = udpIn[31+ofs] & 0x1F;
+            selseg.check1  = (udpIn[31+ofs]>>5) & 0x1;
+            selseg.check1  = (udpIn[31+ofs]>>6) & 0x1;
+            selseg.check1  = (udpIn[31+ofs]>>7) & 0x1;
+          }
+          startY = (udpIn[32+ofs] << 8 | udpIn[33+ofs]);
+          stopY  = (udpIn[34+ofs] << 8 | udpIn[35+ofs]);
+        }
+        if (receiveSegmentBounds) {
+          selseg.setUp(start, stop, udpIn[5+ofs], udpIn[6+ofs], offset, startY, stopY);
+        } else {
+          selseg.setUp(selseg.start, selseg.stop, udpIn[5+ofs], udpIn[6+ofs], selseg.offset, selseg.startY, selseg.stopY);
+        }
+      }
+      stateChanged = true;
+    }
+
+    // simple effect sync, applies to all selected segments
+    if (applyEffects && (version < 11 || !receiveSegmentOptions)) {
+      for (size_t i = 0; i < strip.getSegmentsNum(); i++) {
+        Segment& seg = strip.getSegment(i);
+        if (!seg.isActive() || !seg.isSelected()) continue;
+        seg.setMode(udpIn[8]);
+        seg.speed = udpIn[9];
+        if (version > 2) seg.intensity = udpIn[16];
+        if (version > 4) seg.setPalette(udpIn[19]);
+      }
+      stateChanged = true;
+    }
+
+    if (applyEffects && version > 5 && !clockSyncActive()) {
+      uint32_t t = (udpIn[25] << 24) | (udpIn[26] << 16) | (udpIn[27] << 8) | (udpIn[28]);
+      t += PRESUMED_NETWORK_DELAY; //adjust trivially for network delay
+      t -= rxTime;
+      strip.timebase = t;
+      timebaseUpdated = true;
+    }
+  }
+
+  //adjust system time, but only if sender is more accurate than self
+  if (version > 7 && version < 200)
+  {
+    Toki::Time tm;
+    tm.sec = (udpIn[30] << 24) | (udpIn[31] << 16) | (udpIn[32] << 8) | (udpIn[33]);
+    tm.ms = (udpIn[34] << 8) | (udpIn[35]);
+    if (udpIn[29] > toki.getTimeSource()) { //if sender's time source is more accurate
+      toki.adjust(tm, PRESUMED_NETWORK_DELAY + (millis() - rxTime)); //adjust trivially for network delay and time staged
+      uint8_t ts = TOKI_TS_UDP;
+      if (udpIn[29] > 99) ts = TOKI_TS_UDP_NTP;
+      else if (udpIn[29] >= TOKI_TS_SEC) ts = TOKI_TS_UDP_SEC;
+      toki.setTime(tm, ts);
+    } else if (timebaseUpdated && toki.getTimeSource() > 99) { //if we both have good times, get a more accurate timebase
+      Toki::Time myTime = toki.getTime();
+      toki.adjust(myTime, -(int32_t)(millis() - rxTime)); // our time at reception
+      uint32_t diff = toki.msDifference(tm, myTime);
+      strip.timebase -= PRESUMED_NETWORK_DELAY; //no need to presume, use difference between NTP times at send and receive points
+      if (toki.isLater(tm, myTime)) {
+        strip.timebase += diff;
+      } else {
+        strip.timebase -= diff;
+      }
+    }
+  }
+
+  nightlightActive = udpIn[6];
+  if (nightlightActive) nightlightDelayMins = udpIn[7];
+
+  if (receiveNotificationBrightness || !someSel) bri = udpIn[2];
+  stateUpdated(CALL_MODE_NOTIFICATION);
+}
+
+
+static bool receiveNotification();
+
+static bool rtShowPending = false, rtStatsPending = false; // realtime frame received in current burst
+
+const udp_rx_stats_t& getUdpRxStats()
+{
+  return udpRxStats;
+}
+
 void handleNotifications()
 {
-  IPAddress localIP;
+  handleRealtimeFade();
 
   //send second notification if enabled
   if(udpConnected && (notificationCount < udpNumRetries) && ((millis()-notificationSentTime) > 250)){
     notify(notificationSentCallMode,true);
   }
 
-  if (e131NewData && millis() - strip.getLastShow() > 15)
+  //send pending notification, changes within one frame are coalesced
+  if (notifyPending && millis() - notificationSentTime >= FRAMETIME) {
+    notifyPending = false;
+    sendNotifyPacket(notifyPendingMode, notifyPendingFollowUp);
+  }
+
+  // realtime data for live segments only is composited with the effects and shown by service(), not per packet
+  if (e131NewData && e131FrameReady()) // show each frame once, when all its universes have arrived
   {
     e131NewData = false;
-    strip.show();
+    if (!(realtimeMode && realtimeSegmentsOnly())) strip.show();
+    realtimeStatsShown();
   }
 
   //unlock strip when realtime UDP times out
   if (realtimeMode && millis() > realtimeTimeout) exitRealtime();
 
+  handleClockSync();
+
   //receive UDP notifications
-  if (!udpConnected) return;
+  if (!udpConnected) {
+    commitNotifyPacket(); // ESP-NOW
+    return;
+  }
+
+  uint32_t nowUs = micros();
+  udp_rx_stats_t &st = udpRxStats;
+  if (st.last && nowUs - st.last > st.curGap) st.curGap = nowUs - st.last;
+  st.last = nowUs;
+  if (millis() - st.secStart >= 1000) {
+    st.maxGap   = st.curGap;
+    st.maxDepth = st.curDepth;
+    st.curGap   = st.curDepth = 0;
+    st.secStart = millis();
+  }
 
+  // handle all queued packets (bounded by count and time), so packets do not pile up in lwIP while frames are slow to render
+  const uint32_t budget = realtimeProfile ? 4*UDP_RX_BUDGET_US : UDP_RX_BUDGET_US;
+  unsigned depth = 0;
+  bool more = true;
+  while (depth < UDP_RX_BURST && micros() - nowUs < budget && (more = receiveNotification())) depth++;
+  if (depth > 1) st.backlogged++;
+  if (more && depth) st.cut++; // budget ran out, further packets may be queued
+  if (depth > st.curDepth) st.curDepth = depth;
+
+  commitNotifyPacket(); // notifications of this burst (and ESP-NOW) are applied once
+
+  // realtime frames are shown once per burst, a frame superseded within the burst is not output
+  if (rtShowPending && !(realtimeMode && realtimeSegmentsOnly())) strip.show(); // live segments: see above
+  if (rtStatsPending) realtimeStatsShown();
+  rtShowPending = rtStatsPending = false;
+}
+
+// reads and handles one packet of notifier or realtime sockets, false if none was queued
+static bool receiveNotification()
+{
+  IPAddress localIP;
   bool isSupp = false;
   size_t packetSize = notifierUdp.parsePacket();
   if (!packetSize && udp2Connected) {
     packetSize = notifier2Udp.parsePacket();
     isSupp = true;
   }
+  unsigned long rxTime = millis(); // receive timestamp for clock sync
+  if (packetSize) udpPacketsIn++;
 
   //hyperion / raw RGB
   if (!packetSize && udpRgbConnected) {
     packetSize = rgbUdp.parsePacket();
     if (packetSize) {
-      if (!receiveDirect) return;
-      if (packetSize > UDP_IN_MAXSIZE || packetSize < 3) return;
+      udpPacketsIn++;
+      if (!receiveDirect) return true;
+      if (packetSize > UDP_IN_MAXSIZE || packetSize < 3) return true;
       realtimeIP = rgbUdp.remoteIP();
       DEBUG_PRINTLN(rgbUdp.remoteIP());
       uint8_t lbuf[packetSize];
       rgbUdp.read(lbuf, packetSize);
-      realtimeLock(realtimeTimeoutMs, REALTIME_MODE_HYPERION);
-      if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
-      uint16_t id = 0;
-      uint16_t totalLen = strip.getLengthTotal();
-      for (size_t i = 0; i < packetSize -2; i += 3)
-      {
-        setRealtimePixel(id, lbuf[i], lbuf[i+1], lbuf[i+2], 0);
-        id++; if (id >= totalLen) break;
-      }
-      if (!(realtimeMode && useMainSegmentOnly)) strip.show();
-      return;
+      if (!realtimeLockData(realtimeTimeoutMs, REALTIME_MODE_HYPERION)) return true;
+      setRealtimePixels(0, MIN(packetSize / 3, strip.getLengthTotal()), lbuf, 3);
+      rtShowPending = rtStatsPending = true;
+      return true;
     }
   }
 
-  if (!(receiveNotifications || receiveDirect)) return;
+  if (!(receiveNotifications || receiveDirect || clockSyncMode)) return packetSize; // packet is discarded by next parsePacket()
 
   localIP = Network.localIP();
   //notifier and UDP realtime
-  if (!packetSize || packetSize > UDP_IN_MAXSIZE) return;
-  if (!isSupp && notifierUdp.remoteIP() == localIP) return; //don't process broadcasts we send ourselves
+  if (!packetSize || packetSize > UDP_IN_MAXSIZE) return packetSize;
+  if (!isSupp && notifierUdp.remoteIP() == localIP) return true; //don't process broadcasts we send ourselves
 
   uint8_t udpIn[packetSize +1];
   uint16_t len;
   if (isSupp) len = notifier2Udp.read(udpIn, packetSize);
   else        len =  notifierUdp.read(udpIn, packetSize);
 
+  // cluster clock sync
+  if (isSupp && udpIn[0] == 255 && udpIn[1] == 2 && len >= 4) {
+    handleClockSyncPacket(udpIn, len, rxTime);
+    return true;
+  }
+
   // WLED nodes info notifications
   if (isSupp && udpIn[0] == 255 && udpIn[1] == 1 && len >= 40) {
-    if (!nodeListEnabled || notifier2Udp.remoteIP() == localIP) return;
+    if (!nodeListEnabled || notifier2Udp.remoteIP() == localIP) return true;
 
     uint8_t unit = udpIn[39];
-    NodesMap::iterator it = Nodes.find(unit);
-    if (it == Nodes.end() && Nodes.size() < WLED_MAX_NODES) { // Create a new element when not present
-      Nodes[unit].age = 0;
-      it = Nodes.find(unit);
-    }
+    NodeStruct *node = Nodes.findOrAdd(unit); // nullptr if list is full
 
-    if (it != Nodes.end()) {
+    if (node) {
       for (size_t x = 0; x < 4; x++) {
-        it->second.ip[x] = udpIn[x + 2];
+        node->ip[x] = udpIn[x + 2];
       }
-      it->second.age = 0; // reset 'age counter'
-      char tmpNodeName[33] = { 0 };
-      memcpy(&tmpNodeName[0], reinterpret_cast<byte *>(&udpIn[6]), 32);
-      tmpNodeName[32]     = 0;
-      it->second.nodeName = tmpNodeName;
-      it->second.nodeName.trim();
-      it->second.nodeType = udpIn[38];
+      node->age = 0; // reset 'age counter'
+      memcpy(node->nodeName, &udpIn[6], 32); // update name in place, trim trailing spaces
+      node->nodeName[32] = 0;
+      for (int x = strlen(node->nodeName) - 1; x >= 0 && node->nodeName[x] == ' '; x--) node->nodeName[x] = 0;
+      node->nodeType = udpIn[38];
       uint32_t build = 0;
       if (len >= 44)
         for (size_t i=0; i<sizeof(uint32_t); i++)
           build |= udpIn[40+i]<<(8*i);
-      it->second.build = build;
+      node->build = build;
     }
-    return;
+    return true;
   }
 
   //wled notifier, ignore if realtime packets active
   if (udpIn[0] == 0 && !realtimeMode && receiveNotifications)
   {
-    //ignore notification if received within a second after sending a notification ourselves
-    if (millis() - notificationSentTime < 1000) return;
-    if (udpIn[1] > 199) return; //do not receive custom versions
-
-    //compatibilityVersionByte:
-    byte version = udpIn[11];
-
-    // if we are not part of any sync group ignore message
-    if (version < 9 || version > 199) {
-      // legacy senders are treated as if sending in sync group 1 only
-      if (!(receiveGroups & 0x01)) return;
-    } else if (!(receiveGroups & udpIn[36])) return;
-
-    bool someSel = (receiveNotificationBrightness || receiveNotificationColor || receiveNotificationEffects);
-
-    // set transition time before making any segment changes
-    if (version > 3) {
-      if (fadeTransition) {
-        jsonTransitionOnce = true;
-        strip.setTransition(((udpIn[17] << 0) & 0xFF) + ((udpIn[18] << 8) & 0xFF00));
-      }
-    }
-
-    //apply colors from notification to main segment, only if not syncing full segments
-    if ((receiveNotificationColor || !someSel) && (version < 11 || !receiveSegmentOptions)) {
-      // primary color, only apply white if intended (version > 0)
-      strip.setColor(0, RGBW32(udpIn[3], udpIn[4], udpIn[5], (version > 0) ? udpIn[10] : 0));
-      if (version > 1) {
-        strip.setColor(1, RGBW32(udpIn[12], udpIn[13], udpIn[14], udpIn[15])); // secondary color
-      }
-      if (version > 6) {
-        strip.setColor(2, RGBW32(udpIn[20], udpIn[21], udpIn[22], udpIn[23])); // tertiary color
-        if (version > 9 && version < 200 && udpIn[37] < 255) { // valid CCT/Kelvin value
-          uint16_t cct = udpIn[38];
-          if (udpIn[37] > 0) { //Kelvin
-            cct |= (udpIn[37] << 8);
-          }
-          strip.setCCT(cct);
-        }
-      }
-    }
-
-    bool timebaseUpdated = false;
-    //apply effects from notification
-    bool applyEffects = (receiveNotificationEffects || !someSel);
-    if (version < 200)
-    {
-      if (applyEffects && currentPlaylist >= 0) unloadPlaylist();
-      if (version > 10 && (receiveSegmentOptions || receiveSegmentBounds)) {
-        uint8_t numSrcSegs = udpIn[39];
-        for (size_t i = 0; i < numSrcSegs; i++) {
-          uint16_t ofs = 41 + i*udpIn[40]; //start of segment offset byte
-          uint8_t id = udpIn[0 +ofs];
-          if (id > strip.getSegmentsNum()) break;
-
-          Segment& selseg = strip.getSegment(id);
-          if (!selseg.isActive() || !selseg.isSelected()) continue; //do not apply to non selected segments
-
-          uint16_t startY = 0, start  = (udpIn[1+ofs] << 8 | udpIn[2+ofs]);
-          uint16_t stopY  = 1, stop   = (udpIn[3+ofs] << 8 | udpIn[4+ofs]);
-          uint16_t offset = (udpIn[7+ofs] << 8 | udpIn[8+ofs]);
-          if (!receiveSegmentOptions) {
-            selseg.setUp(start, stop, selseg.grouping, selseg.spacing, offset, startY, stopY);
-            continue;
-          }
-          //for (size_t j = 1; j<4; j++) selseg.setOption(j, (udpIn[9 +ofs] >> j) & 0x01); //only take into account mirrored, on, reversed; ignore selected
-          selseg.options = (selseg.options & 0x0071U) | (udpIn[9 +ofs] & 0x0E); // ignore selected, freeze, reset & transitional
-          selseg.setOpacity(udpIn[10+ofs]);
-          if (applyEffects) {
-            strip.setMode(id,  udpIn[11+ofs]);
-            selseg.speed     = udpIn[12+ofs];
-            selseg.intensity = udpIn[13+ofs];
-            selseg.palette   = udpIn[14+ofs];
-          }
-          if (receiveNotificationColor || !someSel) {
-            selseg.setColor(0, RGBW32(udpIn[15+ofs],udpIn[16+ofs],udpIn[17+ofs],udpIn[18+ofs]));
-            selseg.setColor(1, RGBW32(udpIn[19+ofs],udpIn[20+ofs],udpIn[21+ofs],udpIn[22+ofs]));
-            selseg.setColor(2, RGBW32(udpIn[23+ofs],udpIn[24+ofs],udpIn[25+ofs],udpIn[26+ofs]));
-            selseg.setCCT(udpIn[27+ofs]);
-          }
-          if (version > 11) {
-            // when applying synced options ignore selected as it may be used as indicator of which segments to sync
-            // freeze, reset should never be synced
-            // LSB to MSB: select, reverse, on, mirror, freeze, reset, reverse_y, mirror_y, transpose, map1d2d (3), ssim (2), set (2)
-            selseg.options = (selseg.options & 0b0000000000110001U) | (udpIn[28+ofs]<<8) | (udpIn[9 +ofs] & 0b11001110U); // ignore selected, freeze, reset
-            if (applyEffects) {
-              selseg.custom1 = udpIn[29+ofs];
-              selseg.custom2 = udpIn[30+ofs];
-              selseg.custom3 = udpIn[31+ofs] & 0x1F;
-              selseg.check1  = (udpIn[31+ofs]>>5) & 0x1;
-              selseg.check1  = (udpIn[31+ofs]>>6) & 0x1;
-              selseg.check1  = (udpIn[31+ofs]>>7) & 0x1;
-            }
-            startY = (udpIn[32+ofs] << 8 | udpIn[33+ofs]);
-            stopY  = (udpIn[34+ofs] << 8 | udpIn[35+ofs]);
-          }
-          if (receiveSegmentBounds) {
-            selseg.setUp(start, stop, udpIn[5+ofs], udpIn[6+ofs], offset, startY, stopY);
-          } else {
-            selseg.setUp(selseg.start, selseg.stop, udpIn[5+ofs], udpIn[6+ofs], selseg.offset, selseg.startY, selseg.stopY);
-          }
-        }
-        stateChanged = true;
-      }
-
-      // simple effect sync, applies to all selected segments
-      if (applyEffects && (version < 11 || !receiveSegmentOptions)) {
-        for (size_t i = 0; i < strip.getSegmentsNum(); i++) {
-          Segment& seg = strip.getSegment(i);
-          if (!seg.isActive() || !seg.isSelected()) continue;
-          seg.setMode(udpIn[8]);
-          seg.speed = udpIn[9];
-          if (version > 2) seg.intensity = udpIn[16];
-          if (version > 4) seg.setPalette(udpIn[19]);
-        }
-        stateChanged = true;
-      }
-
-      if (applyEffects && version > 5) {
-        uint32_t t = (udpIn[25] << 24) | (udpIn[26] << 16) | (udpIn[27] << 8) | (udpIn[28]);
-        t += PRESUMED_NETWORK_DELAY; //adjust trivially for network delay
-        t -= millis();
-        strip.timebase = t;
-        timebaseUpdated = true;
-      }
-    }
-
-    //adjust system time, but only if sender is more accurate than self
-    if (version > 7 && version < 200)
-    {
-      Toki::Time tm;
-      tm.sec = (udpIn[30] << 24) | (udpIn[31] << 16) | (udpIn[32] << 8) | (udpIn[33]);
-      tm.ms = (udpIn[34] << 8) | (udpIn[35]);
-      if (udpIn[29] > toki.getTimeSource()) { //if sender's time source is more accurate
-        toki.adjust(tm, PRESUMED_NETWORK_DELAY); //adjust trivially for network delay
-        uint8_t ts = TOKI_TS_UDP;
-        if (udpIn[29] > 99) ts = TOKI_TS_UDP_NTP;
-        else if (udpIn[29] >= TOKI_TS_SEC) ts = TOKI_TS_UDP_SEC;
-        toki.setTime(tm, ts);
-      } else if (timebaseUpdated && toki.getTimeSource() > 99) { //if we both have good times, get a more accurate timebase
-        Toki::Time myTime = toki.getTime();
-        uint32_t diff = toki.msDifference(tm, myTime);
-        strip.timebase -= PRESUMED_NETWORK_DELAY; //no need to presume, use difference between NTP times at send and receive points
-        if (toki.isLater(tm, myTime)) {
-          strip.timebase += diff;
-        } else {
-          strip.timebase -= diff;
-        }
-      }
-    }
-
-    nightlightActive = udpIn[6];
-    if (nightlightActive) nightlightDelayMins = udpIn[7];
-
-    if (receiveNotificationBrightness || !someSel) bri = udpIn[2];
-    stateUpdated(CALL_MODE_NOTIFICATION);
-    return;
+    storeNotifyBase(udpIn, len, isSupp ? notifier2Udp.remoteIP() : notifierUdp.remoteIP());
+    parseNotifyPacket(udpIn, len);
+    return true;
+  }
+  if (udpIn[0] == UDP_NOTIFY_DELTA) {
+    if (!realtimeMode && receiveNotifications) applyNotifyDelta(udpIn, len, isSupp ? notifier2Udp.remoteIP() : notifierUdp.remoteIP());
+    return true;
   }
 
-  if (!receiveDirect) return;
+  if (!receiveDirect) return true;
 
   //TPM2.NET
   if (udpIn[0] == 0x9c)
@@ -478,13 +920,12 @@ void handleNotifications()
     //if the number of LEDs in your installation doesn't allow that, please include padding bytes at the end of the last packet
     byte tpmType = udpIn[1];
     if (tpmType == 0xaa) { //TPM2.NET polling, expect answer
-      sendTPM2Ack(); return;
+      sendTPM2Ack(); return true;
     }
-    if (tpmType != 0xda) return; //return if notTPM2.NET data
+    if (tpmType != 0xda) return true; //return if notTPM2.NET data
 
     realtimeIP = (isSupp) ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
-    realtimeLock(realtimeTimeoutMs, REALTIME_MODE_TPM2NET);
-    if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
+    if (!realtimeLockData(realtimeTimeoutMs, REALTIME_MODE_TPM2NET)) return true;
 
     tpmPacketCount++; //increment the packet count
     if (tpmPacketCount == 1) tpmPayloadFrameSize = (udpIn[2] << 8) + udpIn[3]; //save frame size for the whole payload if this is the first packet
@@ -493,21 +934,14 @@ void handleNotifications()
 
     uint16_t id = (tpmPayloadFrameSize/3)*(packetNum-1); //start LED
     uint16_t totalLen = strip.getLengthTotal();
-    for (size_t i = 6; i < tpmPayloadFrameSize + 4U; i += 3)
-    {
-      if (id < totalLen)
-      {
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
-        id++;
-      }
-      else break;
-    }
+    size_t payload = MIN((size_t)tpmPayloadFrameSize, len > 6 ? len - 6U : 0U); // payload follows 6 byte header
+    if (id < totalLen) setRealtimePixels(id, MIN(payload / 3, (size_t)(totalLen - id)), udpIn + 6, 3);
     if (tpmPacketCount == numPackets) //reset packet count and show if all packets were received
     {
       tpmPacketCount = 0;
-      strip.show();
+      rtShowPending = rtStatsPending = true;
     }
-    return;
+    return true;
   }
 
   //UDP realtime: 1 warls 2 drgb 3 drgbw
@@ -515,99 +949,143 @@ void handleNotifications()
   {
     realtimeIP = (isSupp) ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
     DEBUG_PRINTLN(realtimeIP);
-    if (packetSize < 2) return;
+    if (packetSize < 2) return true;
 
     if (udpIn[1] == 0)
     {
       realtimeTimeout = 0;
-      return;
-    } else {
-      realtimeLock(udpIn[1]*1000 +1, REALTIME_MODE_UDP);
+      return true;
     }
-    if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
+    if (!realtimeLockData(udpIn[1]*1000 +1, REALTIME_MODE_UDP)) return true;
 
     uint16_t totalLen = strip.getLengthTotal();
     if ((udpIn[0] == 1) && (packetSize > 5)) //warls - avoiding infinite "for" loop (unsigned underflow)    
     {
-      for (size_t i = 2; i < packetSize -3; i += 4)
-      {
-        setRealtimePixel(udpIn[i], udpIn[i+1], udpIn[i+2], udpIn[i+3], 0);
-      }
+      setRealtimePixelsIndexed((packetSize - 2) / 4, udpIn + 2);
     } else if (udpIn[0] == 2) //drgb
     {
-      uint16_t id = 0;
-      for (size_t i = 2; i < packetSize -2; i += 3)
-      {
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
-
-        id++; if (id >= totalLen) break;
-      }
-    } else if ((udpIn[0] == 3) && (packetSize > 5)) //drgbw - avoiding infinite "for" loop (unsigned underflow)
+      setRealtimePixels(0, MIN((packetSize - 2) / 3, totalLen), udpIn + 2, 3);
+    } else if ((udpIn[0] == 3) && (packetSize > 5)) //drgbw
     {
-      uint16_t id = 0;
-      for (size_t i = 2; i < packetSize -3; i += 4)
-      {
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], udpIn[i+3]);
-
-        id++; if (id >= totalLen) break;
-      }
-    } else if (udpIn[0] == 4) //dnrgb
+      setRealtimePixels(0, MIN((packetSize - 2) / 4, totalLen), udpIn + 2, 4);
+    } else if ((udpIn[0] == 4) && (packetSize > 4)) //dnrgb
     {
       uint16_t id = ((udpIn[3] << 0) & 0xFF) + ((udpIn[2] << 8) & 0xFF00);
-      for (size_t i = 4; i < packetSize -2; i += 3)
-      {
-        if (id >= totalLen) break;
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
-        id++;
-      }
-    } else if (udpIn[0] == 5) //dnrgbw
+      if (id < totalLen) setRealtimePixels(id, MIN((packetSize - 4) / 3, totalLen - id), udpIn + 4, 3);
+    } else if ((udpIn[0] == 5) && (packetSize > 4)) //dnrgbw
     {
       uint16_t id = ((udpIn[3] << 0) & 0xFF) + ((udpIn[2] << 8) & 0xFF00);
-      for (size_t i = 4; i < packetSize -2; i += 4)
-      {
-        if (id >= totalLen) break;
-        setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], udpIn[i+3]);
-        id++;
-      }
+      if (id < totalLen) setRealtimePixels(id, MIN((packetSize - 4) / 4, totalLen - id), udpIn + 4, 4);
     }
-    strip.show();
-    return;
+    rtShowPending = rtStatsPending = true;
+    return true;
   }
 
   // API over UDP
   udpIn[packetSize] = '\0';
 
-  if (requestJSONBufferLock(18)) {
+  JsonDocument *pdoc = requestJSONBuffer(JSON_LOCK_UDP_API); // any free buffer of the pool
+  if (pdoc) {
     if (udpIn[0] >= 'A' && udpIn[0] <= 'Z') { //HTTP API
       String apireq = "win"; apireq += '&'; // reduce flash string usage
       apireq += (char*)udpIn;
       handleSet(nullptr, apireq);
     } else if (udpIn[0] == '{') { //JSON API
-      DeserializationError error = deserializeJson(doc, udpIn);
-      JsonObject root = doc.as<JsonObject>();
+      DeserializationError error = deserializeJson(*pdoc, udpIn);
+      JsonObject root = pdoc->as<JsonObject>();
       if (!error && !root.isNull()) deserializeState(root);
     }
-    releaseJSONBufferLock();
+    releaseJSONBuffer(pdoc);
   }
+  return true;
 }
 
 
-void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w)
+// realtime routes: pixels of the stream go to the segments whose ranges they fall in, as runs
+static void routeRealtimePixels(unsigned pix, unsigned count, const uint32_t *c)
 {
-  uint16_t pix = i + arlsOffset;
-  if (pix < strip.getLengthTotal()) {
-    if (!arlsDisableGammaCorrection && gammaCorrectCol) {
-      r = gamma8(r);
-      g = gamma8(g);
-      b = gamma8(b);
-      w = gamma8(w);
-    }
-    if (useMainSegmentOnly) {
-      Segment &seg = strip.getMainSegment();
-      if (pix<seg.length()) seg.setPixelColor(pix, r, g, b, w);
-    } else {
-      strip.setPixelColor(pix, r, g, b, w);
+  const unsigned end = pix + count;
+  for (unsigned r = 0; r < realtimeRouteCount; r++) {
+    const rt_route_t &rt = realtimeRoutes[r];
+    if (rt.seg >= strip.getSegmentsNum()) continue;
+    const unsigned rStart = rt.uni ? e131UniversePixel(rt.uni) : rt.ofs;
+    const unsigned rEnd = rt.len ? rStart + rt.len : UINT16_MAX; // segment clips
+    const unsigned s = MAX(pix, rStart), e = MIN(end, rEnd);
+    if (s >= e) continue;
+    strip.getSegment(rt.seg).setPixelsRaw(s - rStart, e - s, c + (s - pix));
+  }
+}
+
+// pipeline shared by all realtime decoders: a span of pixels of the stream (start, count) is gamma corrected, shifted by
+// arlsOffset, clipped and written to the strip, the main segment or the routed segments in chunks, as runs
+// data holds 3 (RGB) or 4 (RGBW) channels per LED, stride is the distance of LEDs in data (0 repeats one color)
+static void realtimeSpan(uint16_t start, uint16_t count, const uint8_t *data, uint8_t channels, uint8_t stride)
+{
+  const bool routed = realtimeRouteCount; // routes address the stream itself, arlsOffset does not apply
+  int pix = routed ? start : start + arlsOffset;
+  if (pix < 0) { // negative offset: skip LEDs that fall before the strip
+    if (count <= -pix) return;
+    count += pix;
+    data  -= pix * stride;
+    pix    = 0;
+  }
+  Segment *seg = (useMainSegmentOnly && !routed) ? &strip.getMainSegment() : nullptr;
+  const int len = routed ? UINT16_MAX : seg ? seg->length() : strip.getLengthTotal();
+  if (pix >= len) return;
+  if (count > len - pix) count = len - pix;
+
+  const bool gc = !arlsDisableGammaCorrection && gammaCorrectCol;
+  const bool hasW = channels > 3;
+  uint32_t buf[64];
+  if (!stride) { // solid span, color converted once
+    uint32_t c = gc ? RGBW32(gamma8(data[0]), gamma8(data[1]), gamma8(data[2]), hasW ? gamma8(data[3]) : 0)
+                    : RGBW32(data[0], data[1], data[2], hasW ? data[3] : 0);
+    for (unsigned i = 0; i < MIN(count, (uint16_t)64); i++) buf[i] = c;
+  }
+  while (count) {
+    const unsigned n = count < 64 ? count : 64;
+    if (stride && gc) {
+      for (unsigned i = 0; i < n; i++, data += stride)
+        buf[i] = RGBW32(gamma8(data[0]), gamma8(data[1]), gamma8(data[2]), hasW ? gamma8(data[3]) : 0);
+    } else if (stride) { // solid spans keep the color in buf
+      for (unsigned i = 0; i < n; i++, data += stride)
+        buf[i] = RGBW32(data[0], data[1], data[2], hasW ? data[3] : 0);
     }
+    if (routed)   routeRealtimePixels(pix, n, buf);
+    else if (seg) seg->setPixelColors(pix, n, buf);
+    else          strip.writeRange(pix, n, buf);
+    pix   += n;
+    count -= n;
+  }
+}
+
+void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w)
+{
+  const uint8_t px[4] = {r, g, b, w};
+  realtimeSpan(i, 1, px, 4, 4);
+}
+
+// contiguous run of LEDs, data holds 3 (RGB) or 4 (RGBW) channels per LED
+void setRealtimePixels(uint16_t start, uint16_t count, const uint8_t *data, uint8_t channels)
+{
+  realtimeSpan(start, count, data, channels, channels);
+}
+
+// count LEDs set to one color (3 or 4 channels)
+void fillRealtimePixels(uint16_t start, uint16_t count, const uint8_t *color, uint8_t channels)
+{
+  realtimeSpan(start, count, color, channels, 0);
+}
+
+// indexed LEDs (WARLS): count entries of [index, R, G, B], consecutive indices are written as one run
+void setRealtimePixelsIndexed(uint16_t count, const uint8_t *data)
+{
+  while (count) {
+    unsigned n = 1;
+    while (n < count && data[n*4] == data[0] + n) n++;
+    realtimeSpan(data[0], n, data + 1, 3, 4);
+    data  += n * 4;
+    count -= n;
   }
 }
 
@@ -616,21 +1094,170 @@ void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w)
 \*********************************************************************************************/
 void refreshNodeList()
 {
-  for (NodesMap::iterator it = Nodes.begin(); it != Nodes.end();) {
-    bool mustRemove = true;
-
-    if (it->second.ip[0] != 0) {
-      if (it->second.age < 10) {
-        it->second.age++;
-        mustRemove = false;
-        ++it;
-      }
+  for (size_t i = 0; i < Nodes.capacity(); i++) {
+    NodeStruct *node = Nodes.at(i);
+    if (node && node->age <= 10) node->age++;
+  }
+  // separate pass as erase() may shift entries into already visited slots
+  for (size_t i = 0; i < Nodes.capacity(); i++) {
+    NodeStruct *node = Nodes.at(i);
+    while (node && (node->ip[0] == 0 || node->age > 10)) {
+      Nodes.erase(node);
+      node = Nodes.at(i); // re-check slot, a shifted entry may now occupy it
     }
+  }
+}
 
-    if (mustRemove) {
-      it = Nodes.erase(it);
+/*********************************************************************************************\
+   Cluster clock sync: followers measure offset of their effect time (millis() + strip.timebase)
+   to a leader with NTP-style request/reply (4 timestamps) and discipline strip.timebase
+   with a PI loop (phase and frequency/drift), keeping effects of all nodes in phase.
+   Packets go over the supplemental port: 255, 2, type ('A' announce, 'Q' request, 'R' reply), ...
+\*********************************************************************************************/
+#define CLOCK_SYNC_ANNOUNCE 'A' // leader -> broadcast: sync groups
+#define CLOCK_SYNC_REQUEST  'Q' // follower -> leader: seq, t1 (follower millis())
+#define CLOCK_SYNC_REPLY    'R' // leader -> follower: seq, t1, t2 (receive), t3 (send), both leader effect time
+#define CLOCK_SYNC_STEP     50  // ms, larger offsets are corrected at once instead of slewed
+#define CLOCK_SYNC_RTT_SLACK 3  // ms, samples with round trip that much above the recent minimum are discarded
+#define CLOCK_SYNC_KP       0.25f  // phase gain
+#define CLOCK_SYNC_KI       0.02f  // frequency gain
+#define CLOCK_SYNC_MAX_FREQ 0.0005f // 500 ppm
+
+static IPAddress clkLeader;
+static unsigned long clkLeaderSeen = 0, clkLastTx = 0, clkLastUpdate = 0, clkLastSample = 0;
+static uint32_t clkReqSent = 0;
+static uint8_t  clkSeq = 0;
+static bool     clkWaiting = false, clkLocked = false;
+static int32_t  clkOffset = 0;  // last accepted offset (ms, leader ahead if positive)
+static uint16_t clkRtt = 0, clkRttMin = UINT16_MAX;
+static float    clkFreq = 0.0f; // estimated drift relative to leader (ms per ms)
+static float    clkResidual = 0.0f; // sub-millisecond part of timebase corrections not yet applied
+static uint32_t clkSamples = 0;
+
+static inline void writeU32(uint8_t *b, uint32_t v) { b[0] = v >> 24; b[1] = v >> 16; b[2] = v >> 8; b[3] = v; }
+static inline uint32_t readU32(const uint8_t *b) { return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3]; }
+
+static void clockSyncUnlock() {
+  clkLocked = false;
+  clkWaiting = false;
+  clkFreq = clkResidual = 0.0f;
+  clkRttMin = UINT16_MAX;
+  clkSamples = 0;
+}
+
+// true if timebase is currently disciplined by cluster clock sync (notifier/beacon timebase is ignored then)
+bool clockSyncActive() {
+  return clockSyncMode == CLOCK_SYNC_FOLLOWER && clkLocked;
+}
+
+static void clockSyncSample(int32_t offset, uint16_t rtt, unsigned long now) {
+  // minimum round trip filter: queued/delayed packets carry an asymmetric, unusable delay
+  if (clkRttMin < UINT16_MAX && (clkSamples & 0x0F) == 0) clkRttMin++; // let minimum follow slowly if the network changes
+  if (rtt < clkRttMin) clkRttMin = rtt;
+  if (rtt > clkRttMin + CLOCK_SYNC_RTT_SLACK) return;
+
+  clkOffset = offset;
+  clkRtt = rtt;
+  clkSamples++;
+  if (!clkLocked || offset > CLOCK_SYNC_STEP || offset < -CLOCK_SYNC_STEP) {
+    strip.timebase += offset; // step
+    clkResidual = 0.0f;
+    clkLocked = true;
+  } else {
+    float dt = now - clkLastSample;
+    if (dt > 0) clkFreq += CLOCK_SYNC_KI * offset / dt;
+    clkFreq = constrain(clkFreq, -CLOCK_SYNC_MAX_FREQ, CLOCK_SYNC_MAX_FREQ);
+    clkResidual += CLOCK_SYNC_KP * offset;
+  }
+  clkLastSample = now;
+}
+
+static void handleClockSyncPacket(const uint8_t *udpIn, uint16_t len, unsigned long rxTime) {
+  IPAddress ip = notifier2Udp.remoteIP();
+  if (ip == Network.localIP()) return;
+
+  switch (udpIn[2]) {
+    case CLOCK_SYNC_ANNOUNCE:
+      if (clockSyncMode != CLOCK_SYNC_FOLLOWER || len < 4 || !(receiveGroups & udpIn[3])) return;
+      if (ip != clkLeader) { clkLeader = ip; clockSyncUnlock(); }
+      clkLeaderSeen = rxTime;
+      break;
+    case CLOCK_SYNC_REQUEST: {
+      if (clockSyncMode != CLOCK_SYNC_LEADER || len < 8) return;
+      uint8_t out[16] = {255, 2, CLOCK_SYNC_REPLY, udpIn[3]};
+      memcpy(out + 4, udpIn + 4, 4);
+      writeU32(out + 8, rxTime + strip.timebase);
+      writeU32(out + 12, millis() + strip.timebase);
+      notifier2Udp.beginPacket(ip, notifier2Udp.remotePort());
+      notifier2Udp.write(out, sizeof(out));
+      notifier2Udp.endPacket(); udpPacketsOut++;
+      } break;
+    case CLOCK_SYNC_REPLY: {
+      if (clockSyncMode != CLOCK_SYNC_FOLLOWER || len < 16 || !clkWaiting || ip != clkLeader || udpIn[3] != clkSeq) return;
+      uint32_t t1 = readU32(udpIn + 4);
+      if (t1 != clkReqSent) return;
+      clkWaiting = false;
+      uint32_t t2 = readU32(udpIn + 8), t3 = readU32(udpIn + 12);
+      int32_t rtt = (int32_t)(rxTime - t1) - (int32_t)(t3 - t2);
+      if (rtt < 0 || rtt > 1000) return;
+      // offset = ((t2 - t1') + (t3 - t4')) / 2 with t1', t4' our effect time (same timebase for both)
+      int32_t offset = ((int32_t)(t2 - (t1 + strip.timebase)) + (int32_t)(t3 - (rxTime + strip.timebase))) / 2;
+      clockSyncSample(offset, rtt, rxTime);
+      } break;
+  }
+}
+
+void handleClockSync() {
+  if (clockSyncMode == CLOCK_SYNC_OFF || !udp2Connected || !WLED_CONNECTED) return;
+  unsigned long now = millis();
+
+  if (clockSyncMode == CLOCK_SYNC_LEADER) {
+    if (now - clkLastTx < CLOCK_SYNC_INTERVAL) return;
+    uint8_t out[4] = {255, 2, CLOCK_SYNC_ANNOUNCE, syncGroups};
+    IPAddress broadcastIP(255, 255, 255, 255);
+    notifier2Udp.beginPacket(broadcastIP, udpPort2);
+    notifier2Udp.write(out, sizeof(out));
+    notifier2Udp.endPacket(); udpPacketsOut++;
+    clkLastTx = now;
+    return;
+  }
+
+  // apply drift compensation and pending phase correction in whole milliseconds
+  if (clkLocked) {
+    clkResidual += clkFreq * (float)(now - clkLastUpdate);
+    if (clkResidual >= 1.0f || clkResidual <= -1.0f) {
+      int32_t step = clkResidual;
+      strip.timebase += step;
+      clkResidual -= step;
     }
   }
+  clkLastUpdate = now;
+
+  if (clkLeader[0] == 0 || now - clkLeaderSeen > CLOCK_SYNC_TIMEOUT) {
+    if (clkLocked) clockSyncUnlock(); // leader gone, keep current timebase
+    return;
+  }
+  if (now - clkLastTx < CLOCK_SYNC_INTERVAL) return;
+  uint8_t out[8] = {255, 2, CLOCK_SYNC_REQUEST, ++clkSeq};
+  clkReqSent = now;
+  writeU32(out + 4, clkReqSent);
+  notifier2Udp.beginPacket(clkLeader, udpPort2);
+  notifier2Udp.write(out, sizeof(out));
+  notifier2Udp.endPacket(); udpPacketsOut++;
+  clkWaiting = true;
+  clkLastTx = now;
+}
+
+void serializeClockSync(JsonObject root) {
+  JsonObject cs = root.createNestedObject(F("csync"));
+  cs[F("mode")] = clockSyncMode;
+  if (clockSyncMode != CLOCK_SYNC_FOLLOWER) return;
+  cs[F("lock")] = clkLocked;
+  cs[F("ldr")]  = clkLeader.toString();
+  cs[F("ofs")]  = clkOffset;  // ms, last measured skew to leader
+  cs[F("rtt")]  = clkRtt;
+  cs[F("ppm")]  = (int32_t)(clkFreq * 1000000.0f); // estimated drift
+  cs["n"]       = clkSamples;
 }
 
 /*********************************************************************************************\
@@ -685,7 +1312,7 @@ void sendSysInfoUDP()
   IPAddress broadcastIP(255, 255, 255, 255);
   notifier2Udp.beginPacket(broadcastIP, udpPort2);
   notifier2Udp.write(data, sizeof(data));
-  notifier2Udp.endPacket();
+  notifier2Udp.endPacket(); udpPacketsOut++;
 }
 
 
@@ -723,89 +1350,216 @@ void sendSysInfoUDP()
 static       size_t sequenceNumber = 0; // this needs to be shared across all outputs
 static const size_t ART_NET_HEADER_SIZE = 12;
 static const byte   ART_NET_HEADER[] PROGMEM = {0x41,0x72,0x74,0x2d,0x4e,0x65,0x74,0x00,0x00,0x50,0x00,0x0e};
+static const size_t E131_HEADER_SIZE = 126; // E131_DMP_DATA + start code
+static const byte   E131_ACN_ID[] PROGMEM = {0x41,0x53,0x43,0x2d,0x45,0x31,0x2e,0x31,0x37,0x00,0x00,0x00}; // "ASC-E1.17"
+
+// packets are assembled in one buffer (allocated on first use) and sent with a single write, socket stays open
+#define NET_OUT_BUFFER_SIZE (10 + DDP_CHANNELS_PER_PACKET) // DDP packets are the largest
+static WiFiUDP  netOutUdp;
+static uint8_t *netOutBuffer = nullptr;
+static uint8_t  e131Sequence = 0;
+
+// copies channel values scaled by bri (same result as scale8())
+static void scaleChannels(uint8_t *dst, const uint8_t *src, size_t len, uint8_t bri) {
+  #ifdef WLED_ENABLE_OUTPUT_GAMMA
+  const uint16_t *gt = getOutputGammaTable();
+  if (gt) { // gamma and brightness combined at 16 bit, rounded once
+    const uint32_t scale = bri + 1;
+    uint8_t lut[256];
+    for (size_t v = 0; v < 256; v++) lut[v] = (gt[v] * scale) >> 16;
+    for (size_t i = 0; i < len; i++) dst[i] = lut[src[i]];
+    return;
+  }
+  #endif
+  scale8_n(dst, src, len, bri);
+}
 
-uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri, bool isRGBW)  {
-  if (!(apActive || interfacesInited) || !client[0] || !length) return 1;  // network not initialised or dummy/unset IP address  031522 ajn added check for ap
+static bool sendNetPacket(IPAddress client, uint16_t port, size_t size) {
+  if (!netOutUdp.beginPacket(client, port)) {
+    DEBUG_PRINTLN(F("WiFiUDP.beginPacket returned an error"));
+    return false;
+  }
+  netOutUdp.write(netOutBuffer, size);
+  if (!netOutUdp.endPacket()) {
+    DEBUG_PRINTLN(F("WiFiUDP.endPacket returned an error"));
+    return false;
+  }
+  udpPacketsOut++;
+  // pacing keeps bursts of packets from overflowing buffers of simple access points or nodes
+  if (netOutPacing >= 1000) delay(netOutPacing / 1000);
+  else if (netOutPacing) delayMicroseconds(netOutPacing);
+  return true;
+}
 
-  WiFiUDP ddpUdp;
+static inline void put16(uint8_t *p, uint16_t v) { p[0] = v >> 8; p[1] = v; } // network byte order
 
-  switch (type) {
-    case 0: // DDP
-    {
-      // calculate the number of UDP packets we need to send
-      size_t channelCount = length * (isRGBW? 4:3); // 1 channel for every R,G,B value
-      size_t packetCount = ((channelCount-1) / DDP_CHANNELS_PER_PACKET) +1;
+// DMX channels sent per universe, pixels are not split across universes
+static size_t channelsPerUniverse(bool isRGBW) {
+  const size_t channelsPerPixel = isRGBW ? 4 : 3;
+  size_t n = (netOutChannels && netOutChannels < 512) ? netOutChannels : 512;
+  n -= n % channelsPerPixel;
+  return n ? n : channelsPerPixel;
+}
 
-      // there are 3 channels per RGB pixel
-      uint32_t channel = 0; // TODO: allow specifying the start channel
-      // the current position in the buffer
-      size_t bufferOffset = 0;
+// sends channelCount channels from buffer as DDP packets, push flag on last packet if requested
+static bool sendDDP(IPAddress client, uint8_t *buffer, size_t channelCount, uint8_t bri, bool isRGBW, bool push, bool sequenced) {
+  uint8_t *pkt = netOutBuffer;
+  // calculate the number of UDP packets we need to send
+  size_t packetCount = ((channelCount-1) / DDP_CHANNELS_PER_PACKET) +1;
 
-      for (size_t currentPacket = 0; currentPacket < packetCount; currentPacket++) {
-        if (sequenceNumber > 15) sequenceNumber = 0;
+  // there are 3 channels per RGB pixel
+  uint32_t channel = 0; // TODO: allow specifying the start channel
 
-        if (!ddpUdp.beginPacket(client, DDP_DEFAULT_PORT)) {  // port defined in ESPAsyncE131.h
-          DEBUG_PRINTLN(F("WiFiUDP.beginPacket returned an error"));
-          return 1; // problem
-        }
+  for (size_t currentPacket = 0; currentPacket < packetCount; currentPacket++) {
+    if (sequenceNumber > 15) sequenceNumber = 0;
 
-        // the amount of data is AFTER the header in the current packet
-        size_t packetSize = DDP_CHANNELS_PER_PACKET;
+    // the amount of data is AFTER the header in the current packet
+    size_t packetSize = DDP_CHANNELS_PER_PACKET;
 
-        uint8_t flags = DDP_FLAGS1_VER1;
-        if (currentPacket == (packetCount - 1U)) {
-          // last packet, set the push flag
-          // TODO: determine if we want to send an empty push packet to each destination after sending the pixel data
-          flags = DDP_FLAGS1_VER1 | DDP_FLAGS1_PUSH;
-          if (channelCount % DDP_CHANNELS_PER_PACKET) {
-            packetSize = channelCount % DDP_CHANNELS_PER_PACKET;
-          }
-        }
+    uint8_t flags = DDP_FLAGS1_VER1;
+    if (currentPacket == (packetCount - 1U)) {
+      // last packet, set the push flag
+      if (push) flags = DDP_FLAGS1_VER1 | DDP_FLAGS1_PUSH;
+      if (channelCount % DDP_CHANNELS_PER_PACKET) {
+        packetSize = channelCount % DDP_CHANNELS_PER_PACKET;
+      }
+    }
 
-        // write the header
-        /*0*/ddpUdp.write(flags);
-        /*1*/ddpUdp.write(sequenceNumber++ & 0x0F); // sequence may be unnecessary unless we are sending twice (as requested in Sync settings)
-        /*2*/ddpUdp.write(isRGBW ?  DDP_TYPE_RGBW32 : DDP_TYPE_RGB24);
-        /*3*/ddpUdp.write(DDP_ID_DISPLAY);
-        // data offset in bytes, 32-bit number, MSB first
-        /*4*/ddpUdp.write(0xFF & (channel >> 24));
-        /*5*/ddpUdp.write(0xFF & (channel >> 16));
-        /*6*/ddpUdp.write(0xFF & (channel >>  8));
-        /*7*/ddpUdp.write(0xFF & (channel      ));
-        // data length in bytes, 16-bit number, MSB first
-        /*8*/ddpUdp.write(0xFF & (packetSize >> 8));
-        /*9*/ddpUdp.write(0xFF & (packetSize     ));
-
-        // write the colors, the write write(const uint8_t *buffer, size_t size)
-        // function is just a loop internally too
-        for (size_t i = 0; i < packetSize; i += (isRGBW?4:3)) {
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // R
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // G
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // B
-          if (isRGBW) ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // W
-        }
+    // header
+    pkt[0] = flags;
+    pkt[1] = sequenced ? sequenceNumber++ & 0x0F : 0; // sequence may be unnecessary unless we are sending twice (as requested in Sync settings)
+    pkt[2] = isRGBW ?  DDP_TYPE_RGBW32 : DDP_TYPE_RGB24;
+    pkt[3] = DDP_ID_DISPLAY;
+    put16(pkt+4, channel >> 16); // data offset in bytes, 32-bit number, MSB first
+    put16(pkt+6, channel);
+    put16(pkt+8, packetSize);    // data length in bytes, 16-bit number, MSB first
+    scaleChannels(pkt+10, buffer + channel, packetSize, bri);
 
-        if (!ddpUdp.endPacket()) {
-          DEBUG_PRINTLN(F("WiFiUDP.endPacket returned an error"));
-          return 1; // problem
-        }
+    if (!sendNetPacket(client, DDP_DEFAULT_PORT, 10 + packetSize)) return false; // problem
+
+    channel += packetSize;
+  }
+  return true;
+}
 
-        channel += packetSize;
+// estimated time realtimeBroadcast() takes to send length LEDs (us), from number of packets and pacing
+uint32_t realtimeBroadcastTime(uint8_t type, uint16_t length, bool isRGBW)
+{
+  if (!length) return 0;
+  const size_t channelsPerPixel = isRGBW ? 4 : 3;
+  const size_t channelCount = length * channelsPerPixel;
+  size_t packetCount;
+  switch (type) {
+    case 1: // E1.31
+    case 2: // Art-Net
+      packetCount = ((channelCount-1) / channelsPerUniverse(isRGBW)) + 1;
+      break;
+    case 3: // DDP tiles (data packets of each panel and one push)
+    {
+      packetCount = 1;
+      #ifndef WLED_DISABLE_2D
+      for (const WS2812FX::Panel &p : strip.panel) {
+        size_t count = p.width * p.height * channelsPerPixel;
+        if (p.ip[0] && count) packetCount += ((count-1) / DDP_CHANNELS_PER_PACKET) + 1;
       }
+      #endif
+    } break;
+    default: // DDP
+      packetCount = ((channelCount-1) / DDP_CHANNELS_PER_PACKET) + 1;
+      break;
+  }
+  return packetCount * (WLED_NET_PACKET_US + netOutPacing);
+}
+
+uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri, bool isRGBW)  {
+  if (!(apActive || interfacesInited) || !client[0] || !length) return 1;  // network not initialised or dummy/unset IP address  031522 ajn added check for ap
+
+  if (!netOutBuffer) netOutBuffer = (uint8_t*)malloc(NET_OUT_BUFFER_SIZE);
+  if (!netOutBuffer) return 1;
+  uint8_t *pkt = netOutBuffer;
+  const size_t channelCount = length * (isRGBW?4:3); // 1 channel for every R,G,B,(W?) value
+
+  switch (type) {
+    case 0: // DDP
+      if (!sendDDP(client, buffer, channelCount, bri, isRGBW, true, true)) return 1;
+      break;
+
+    case 3: // DDP tiles: each 2D panel goes to its follower, all followers show at once on a single push
+    {
+      #ifndef WLED_DISABLE_2D
+      const size_t channelsPerPixel = isRGBW ? 4 : 3;
+      size_t start = 0; // panels occupy consecutive LEDs in panel order (without gaps)
+      for (const WS2812FX::Panel &p : strip.panel) {
+        size_t count = p.width * p.height;
+        if (start + count > length) break;
+        if (p.ip[0]) {
+          // unsequenced, followers would otherwise see gaps from packets sent to other tiles
+          if (!sendDDP(IPAddress(p.ip[0], p.ip[1], p.ip[2], p.ip[3]), buffer + start * channelsPerPixel, count * channelsPerPixel, bri, isRGBW, false, false)) return 1;
+        }
+        start += count;
+      }
+      // push without data to bus address (broadcast or multicast reaching all followers)
+      pkt[0] = DDP_FLAGS1_VER1 | DDP_FLAGS1_PUSH;
+      pkt[1] = 0;
+      pkt[2] = DDP_TYPE_RGB24;
+      pkt[3] = DDP_ID_DISPLAY;
+      put16(pkt+4, 0);
+      put16(pkt+6, 0);
+      put16(pkt+8, 0);
+      if (!sendNetPacket(client, DDP_DEFAULT_PORT, DDP_SYNCPACKET_LEN)) return 1;
+      #endif
     } break;
 
     case 1: //E1.31
     {
+      const size_t E131_CHANNELS_PER_PACKET = channelsPerUniverse(isRGBW);
+      const size_t packetCount = ((channelCount-1)/E131_CHANNELS_PER_PACKET)+1;
+
+      // parts of header that are the same for all packets
+      static uint8_t cid[16] = {0};
+      if (!cid[0]) { // component identifier: "WLED" and MAC address
+        memcpy(cid, "WLED", 4);
+        WiFi.macAddress(cid + 10);
+      }
+      memset(pkt, 0, E131_HEADER_SIZE);
+      put16(pkt+E131_ROOT_PREAMBLE_SIZE, 0x0010);
+      memcpy_P(pkt+E131_ROOT_ID, E131_ACN_ID, sizeof(E131_ACN_ID));
+      pkt[E131_ROOT_VECTOR+3] = 0x04;  // VECTOR_ROOT_E131_DATA
+      memcpy(pkt+E131_ROOT_CID, cid, sizeof(cid));
+      pkt[E131_FRAME_VECTOR+3] = 0x02; // VECTOR_E131_DATA_PACKET
+      strlcpy((char*)pkt+E131_FRAME_SOURCE, serverDescription, 64);
+      pkt[E131_FRAME_PRIORITY] = e131OutPriority;
+      pkt[E131_FRAME_SEQ] = e131Sequence++;
+      pkt[E131_DMP_VECTOR] = 0x02;     // VECTOR_DMP_SET_PROPERTY
+      pkt[E131_DMP_TYPE] = 0xA1;
+      put16(pkt+E131_DMP_ADDR_INC, 1);
+
+      size_t bufferOffset = 0;
+      for (size_t currentPacket = 0; currentPacket < packetCount; currentPacket++) {
+        size_t packetSize = E131_CHANNELS_PER_PACKET;
+        if (currentPacket == (packetCount - 1U) && (channelCount % E131_CHANNELS_PER_PACKET)) packetSize = channelCount % E131_CHANNELS_PER_PACKET;
+
+        const size_t size = E131_HEADER_SIZE + packetSize;
+        put16(pkt+E131_ROOT_FLENGTH,  0x7000 | (size - E131_ROOT_FLENGTH));
+        put16(pkt+E131_FRAME_FLENGTH, 0x7000 | (size - E131_FRAME_FLENGTH));
+        put16(pkt+E131_FRAME_UNIVERSE, netOutUniverse + currentPacket);
+        put16(pkt+E131_DMP_FLENGTH,   0x7000 | (size - E131_DMP_FLENGTH));
+        put16(pkt+E131_DMP_COUNT, packetSize + 1); // including start code (0)
+        scaleChannels(pkt+E131_HEADER_SIZE, buffer + bufferOffset, packetSize, bri);
+
+        if (!sendNetPacket(client, E131_DEFAULT_PORT, size)) return 1;
+        bufferOffset += packetSize;
+      }
     } break;
 
     case 2: //ArtNet
     {
       // calculate the number of UDP packets we need to send
-      const size_t channelCount = length * (isRGBW?4:3); // 1 channel for every R,G,B,(W?) value
-      const size_t ARTNET_CHANNELS_PER_PACKET = isRGBW?512:510; // 512/4=128 RGBW LEDs, 510/3=170 RGB LEDs
+      const size_t ARTNET_CHANNELS_PER_PACKET = channelsPerUniverse(isRGBW); // by default 512/4=128 RGBW LEDs, 510/3=170 RGB LEDs
       const size_t packetCount = ((channelCount-1)/ARTNET_CHANNELS_PER_PACKET)+1;
+      // 15 bit port address: net (7 bits), subnet (4 bits) and universe (4 bits), consecutive packets use consecutive addresses
+      const uint16_t portAddress = ((artnetOutNet & 0x7F) << 8) | ((artnetOutSubnet & 0x0F) << 4) | (artnetOutUniverse & 0x0F);
 
-      uint32_t channel = 0; 
       size_t bufferOffset = 0;
 
       sequenceNumber++;
@@ -814,11 +1568,6 @@ uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8
 
         if (sequenceNumber > 255) sequenceNumber = 0;
 
-        if (!ddpUdp.beginPacket(client, ARTNET_DEFAULT_PORT)) {
-          DEBUG_PRINTLN(F("Art-Net WiFiUDP.beginPacket returned an error"));
-          return 1; // borked
-        }
-
         size_t packetSize = ARTNET_CHANNELS_PER_PACKET;
 
         if (currentPacket == (packetCount - 1U)) {
@@ -828,28 +1577,27 @@ uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8
           }
         }
 
-        byte header_buffer[ART_NET_HEADER_SIZE];
-        memcpy_P(header_buffer, ART_NET_HEADER, ART_NET_HEADER_SIZE);
-        ddpUdp.write(header_buffer, ART_NET_HEADER_SIZE); // This doesn't change. Hard coded ID, OpCode, and protocol version.
-        ddpUdp.write(sequenceNumber & 0xFF); // sequence number. 1..255
-        ddpUdp.write(0x00); // physical - more an FYI, not really used for anything. 0..3
-        ddpUdp.write((currentPacket) & 0xFF); // Universe LSB. 1 full packet == 1 full universe, so just use current packet number.
-        ddpUdp.write(0x00); // Universe MSB, unused.
-        ddpUdp.write(0xFF & (packetSize >> 8)); // 16-bit length of channel data, MSB
-        ddpUdp.write(0xFF & (packetSize     )); // 16-bit length of channel data, LSB
-
-        for (size_t i = 0; i < packetSize; i += (isRGBW?4:3)) {
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // R
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // G
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // B
-          if (isRGBW) ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // W
-        }
+        memcpy_P(pkt, ART_NET_HEADER, ART_NET_HEADER_SIZE); // This doesn't change. Hard coded ID, OpCode, and protocol version.
+        pkt[12] = sequenceNumber & 0xFF; // sequence number. 1..255
+        pkt[13] = 0x00; // physical - more an FYI, not really used for anything. 0..3
+        const uint16_t universe = (portAddress + currentPacket) & 0x7FFF; // 1 full packet == 1 full universe
+        pkt[14] = universe & 0xFF; // SubUni: subnet and universe
+        pkt[15] = universe >> 8;   // Net
+        put16(pkt+16, packetSize); // 16-bit length of channel data, MSB first
+        scaleChannels(pkt+18, buffer + bufferOffset, packetSize, bri);
+
+        if (!sendNetPacket(client, ARTNET_DEFAULT_PORT, 18 + packetSize)) return 1; // borked
+        bufferOffset += packetSize;
+      }
 
-        if (!ddpUdp.endPacket()) {
-          DEBUG_PRINTLN(F("Art-Net WiFiUDP.endPacket returned an error"));
-          return 1; // borked
-        }
-        channel += packetSize;
+      if (artnetOutSync) {
+        // ArtSync: nodes in synchronous mode output all universes received so far at once (avoids tearing)
+        memcpy_P(pkt, ART_NET_HEADER, ART_NET_HEADER_SIZE);
+        pkt[9]  = 0x52; // OpSync (0x5200, little endian)
+        pkt[12] = 0x00; // Aux1
+        pkt[13] = 0x00; // Aux2
+        IPAddress broadcastIp = ~uint32_t(Network.subnetMask()) | uint32_t(Network.gatewayIP());
+        if (!sendNetPacket(broadcastIp, ARTNET_DEFAULT_PORT, 14)) return 1;
       }
     } break;
   }
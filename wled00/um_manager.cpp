@@ -3,10 +3,93 @@
  * Registration and management utility for v2 usermods
  */
 
+// core of the main loop (usermods asking for it run in the main loop)
+#if defined(ARDUINO_ARCH_ESP32) && !defined(CONFIG_FREERTOS_UNICORE)
+  #ifdef ARDUINO_RUNNING_CORE
+    #define UM_LOOP_CORE ARDUINO_RUNNING_CORE
+  #else
+    #define UM_LOOP_CORE 1
+  #endif
+static inline bool runsInMainLoop(Usermod *um) { int8_t c = um->getLoopCore(); return c < 0 || c == UM_LOOP_CORE || c >= portNUM_PROCESSORS; }
+#else
+static inline bool runsInMainLoop(Usermod *um) { return true; }
+#endif
+
+// calls loop() of a usermod if its interval has elapsed and records the time it took
+void UsermodManager::runLoop(byte i, uint32_t now)
+{
+  um_stats_t &st = stats[i];
+  uint16_t interval = ums[i]->getLoopInterval();
+  if (interval && st.runs && !st.wake && now - st.lastRun < interval) return;
+  st.wake = false;
+  st.lastRun = now;
+  uint32_t start = micros();
+  ums[i]->loop();
+  uint32_t us = micros() - start;
+  st.runs++;
+  st.totalUs += us;
+  if (us > st.maxUs) st.maxUs = us;
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && !defined(CONFIG_FREERTOS_UNICORE)
+// runs loop() of usermods pinned to another core than the main loop, one task per core
+void UsermodManager::coreTask(void *param)
+{
+  int8_t core = (int)(intptr_t)param;
+  for (;;) {
+    uint32_t now = millis();
+    for (byte i = 0; i < usermods.numMods; i++) {
+      if (usermods.ums[i]->getLoopCore() == core) usermods.runLoop(i, now);
+    }
+    vTaskDelay(1);
+  }
+}
+#endif
+
 //Usermod Manager internals
-void UsermodManager::setup()             { for (byte i = 0; i < numMods; i++) ums[i]->setup(); }
+void UsermodManager::setup()
+{
+  eventMask = 0;
+  for (byte i = 0; i < numMods; i++) {
+    ums[i]->setup();
+    stats[i].eventMask = ums[i]->getEventMask();
+    eventMask |= stats[i].eventMask;
+  }
+  #if defined(ARDUINO_ARCH_ESP32) && !defined(CONFIG_FREERTOS_UNICORE)
+  for (int core = 0; core < portNUM_PROCESSORS; core++) {
+    if (core == UM_LOOP_CORE) continue;
+    bool used = false;
+    for (byte i = 0; i < numMods && !used; i++) used = (ums[i]->getLoopCore() == core);
+    if (!used) continue;
+    BaseType_t ok = xTaskCreatePinnedToCore(coreTask, "UsermodLoop", 4096, (void*)(intptr_t)core, 1, nullptr, core);
+    DEBUG_PRINTF("Usermod loop task on core %d %s.\n", core, ok == pdPASS ? "started" : "failed");
+  }
+  #endif
+}
 void UsermodManager::connected()         { for (byte i = 0; i < numMods; i++) ums[i]->connected(); }
-void UsermodManager::loop()              { for (byte i = 0; i < numMods; i++) ums[i]->loop();  }
+void UsermodManager::loop()
+{
+  uint32_t now = millis();
+  for (byte i = 0; i < numMods; i++) if (runsInMainLoop(ums[i])) runLoop(i, now);
+}
+void UsermodManager::resetStats()
+{
+  for (byte i = 0; i < numMods; i++) {
+    stats[i].runs = stats[i].maxUs = 0;
+    stats[i].totalUs = 0;
+  }
+}
+
+// publishers check wantsEvent() first so unused events cost no more than a bit test
+void UsermodManager::dispatchEvent(const um_event_t &ev)
+{
+  uint32_t bit = UM_EVENT_MASK(ev.type);
+  for (byte i = 0; i < numMods; i++) {
+    if (!(stats[i].eventMask & bit)) continue;
+    ums[i]->onEvent(ev);
+    stats[i].wake = true;
+  }
+}
 void UsermodManager::handleOverlayDraw() { for (byte i = 0; i < numMods; i++) ums[i]->handleOverlayDraw(); }
 void UsermodManager::appendConfigData()  { for (byte i = 0; i < numMods; i++) ums[i]->appendConfigData(); }
 bool UsermodManager::handleButton(uint8_t b) {
@@ -17,12 +100,38 @@ bool UsermodManager::handleButton(uint8_t b) {
   return overrideIO;
 }
 bool UsermodManager::getUMData(um_data_t **data, uint8_t mod_id) {
+  if (mod_id > 0) {
+    for (byte i = 0; i < numHandles; i++) {
+      if (handles[i].id != mod_id || !handles[i].published) continue;
+      if (data) *data = handles[i].data;  // published data needs no polling
+      return handles[i].data;
+    }
+  }
   for (byte i = 0; i < numMods; i++) {
     if (mod_id > 0 && ums[i]->getId() != mod_id) continue;  // only get data form requested usermod if provided
     if (ums[i]->getUMData(data)) return true;               // if usermod does provide data return immediately (only one usermod can provide data at one time)
   }
   return false;
 }
+// handles are never removed so consumers may keep the pointer; a handle may be resolved before its provider publishes
+um_handle_t* UsermodManager::getUMHandle(uint8_t mod_id) {
+  for (byte i = 0; i < numHandles; i++) if (handles[i].id == mod_id) return &handles[i];
+  if (mod_id == USERMOD_ID_RESERVED || numHandles >= WLED_MAX_UM_HANDLES) return nullptr;
+  um_handle_t *h = &handles[numHandles++];
+  h->id        = mod_id;
+  h->published = false;
+  h->data      = nullptr;
+  h->version   = 0;
+  return h;
+}
+um_handle_t* UsermodManager::publishUMData(uint8_t mod_id, um_data_t *data) {
+  um_handle_t *h = getUMHandle(mod_id);
+  if (!h) return nullptr;
+  h->data      = data;
+  h->published = true;
+  h->version++;
+  return h;
+}
 void UsermodManager::addToJsonState(JsonObject& obj)    { for (byte i = 0; i < numMods; i++) ums[i]->addToJsonState(obj); }
 void UsermodManager::addToJsonInfo(JsonObject& obj)     { for (byte i = 0; i < numMods; i++) ums[i]->addToJsonInfo(obj); }
 void UsermodManager::readFromJsonState(JsonObject& obj) { for (byte i = 0; i < numMods; i++) ums[i]->readFromJsonState(obj); }
@@ -57,6 +166,7 @@ Usermod* UsermodManager::lookup(uint16_t mod_id) {
 bool UsermodManager::add(Usermod* um)
 {
   if (numMods >= WLED_MAX_USERMODS || um == nullptr) return false;
+  memset(&stats[numMods], 0, sizeof(um_stats_t));
   ums[numMods++] = um;
   return true;
 }
@@ -145,9 +145,68 @@ bool oappendi(int i)
 }
 
 
+// paged output: obuf is the last page, olen its fill (olen -= 2 after oappend() still works as texts that fit are not split)
+static oappend_page_t *oFirst = nullptr, *oLast = nullptr;
+static bool oFailed = false;
+
+static bool oappendNextPage()
+{
+  oappend_page_t *p = (oappend_page_t*)heapMalloc(HEAP_TAG_OTHER, sizeof(oappend_page_t));
+  if (!p) { oFailed = true; return false; }
+  p->next = nullptr;
+  p->len  = 0;
+  if (oLast) { oLast->len = olen; oLast->next = p; }
+  else       oFirst = p;
+  oLast = p;
+  obuf  = p->data;
+  olen  = 0;
+  return true;
+}
+
+bool oappendPagesBegin()
+{
+  oappendPagesFree(oFirst);
+  oFirst = oLast = nullptr;
+  oFailed = false;
+  return oappendNextPage();
+}
+
+oappend_page_t* oappendPagesEnd()
+{
+  oappend_page_t *p = oFirst;
+  if (oLast) oLast->len = olen;
+  oFirst = oLast = nullptr;
+  obuf = nullptr;
+  olen = 0;
+  if (oFailed) { oappendPagesFree(p); p = nullptr; }
+  return p;
+}
+
+void oappendPagesFree(oappend_page_t *p)
+{
+  while (p) {
+    oappend_page_t *n = p->next;
+    heapFree(HEAP_TAG_OTHER, p, sizeof(oappend_page_t));
+    p = n;
+  }
+}
+
 bool oappend(const char* txt)
 {
   uint16_t len = strlen(txt);
+  if (oLast) {
+    if (oFailed) return false;
+    if (olen + len > OAPPEND_PAGE_SIZE && len <= OAPPEND_PAGE_SIZE && !oappendNextPage()) return false;
+    while (len) {
+      if (olen == OAPPEND_PAGE_SIZE && !oappendNextPage()) return false;
+      uint16_t n = min((uint16_t)(OAPPEND_PAGE_SIZE - olen), len);
+      memcpy(obuf + olen, txt, n);
+      olen += n;
+      txt  += n;
+      len  -= n;
+    }
+    return true;
+  }
   if ((obuf == nullptr) || (olen + len >= SETTINGS_STACK_BUF_SIZE)) { // sanity checks
 #ifdef WLED_DEBUG
     DEBUG_PRINT(F("oappend() buffer overflow. Cannot append "));
@@ -197,59 +256,312 @@ bool isAsterisksOnly(const char* str, byte maxLen)
 }
 
 
-//threading/network callback details: https://github.com/Aircoookie/WLED/pull/2336#discussion_r762276994
-bool requestJSONBufferLock(uint8_t module)
+/*
+ * JSON buffer pool
+ * Slot 0 is the global doc (requestJSONBufferLock(), also sets fileDoc), further slots are allocated
+ * at boot depending on PSRAM and free heap and handed out by requestJSONBuffer() to API write paths,
+ * so they do not serialize on the global buffer. Waits, timeouts and longest wait are counted per owner.
+ * The global doc has no storage until it is claimed; it is then allocated (PSRAM if available) large
+ * enough for the request and freed by handleJSONBufferIdle() after WLED_JSON_IDLE_RELEASE ms unused.
+ */
+static JsonDocument     *jsonPool[WLED_JSON_POOL_SIZE] = { &doc };
+static volatile uint8_t  jsonPoolOwner[WLED_JSON_POOL_SIZE] = { 0 };
+#ifdef ARDUINO_ARCH_ESP32
+static TaskHandle_t      jsonPoolTask[WLED_JSON_POOL_SIZE] = { nullptr }; // holder of each slot
+static portMUX_TYPE      jsonPoolMux = portMUX_INITIALIZER_UNLOCKED;
+#define JSON_POOL_ENTER portENTER_CRITICAL(&jsonPoolMux)
+#define JSON_POOL_EXIT  portEXIT_CRITICAL(&jsonPoolMux)
+#else
+#define JSON_POOL_ENTER noInterrupts()
+#define JSON_POOL_EXIT  interrupts()
+#endif
+static uint8_t           jsonPoolSize = 1;
+static json_lock_stats_t jsonLockStats[JSON_LOCK_OWNERS];
+static unsigned long     jsonDocLastUse = 0;
+static volatile uint8_t  jsonQueue = 0, jsonQueuePeak = 0; // requests waiting for a buffer
+static uint32_t          jsonPoolSince[WLED_JSON_POOL_SIZE]; // micros() when claimed (event trace)
+static uint16_t          jsonPoolWait[WLED_JSON_POOL_SIZE];  // ms waited for it
+
+// makes sure global doc can hold a request of len bytes of JSON (0: unknown, full buffer)
+static bool allocJSONDoc(size_t len)
 {
-  unsigned long now = millis();
+  size_t want = len ? constrain(8*len, (size_t)JSON_BUFFER_MIN_SIZE, (size_t)JSON_BUFFER_SIZE) : JSON_BUFFER_SIZE; // zero-copy parsing: ~8 bytes of pool per input byte worst case
+  if (doc.capacity() >= want) return true;
+  if (doc.capacity()) {
+    heapTrackFree(HEAP_TAG_JSON, doc.capacity());
+    doc = JSONBufferDocument(0); // free first, the new block may need the space
+  }
+  doc = JSONBufferDocument(want);
+  size_t got = doc.capacity();
+  heapTrackAlloc(HEAP_TAG_JSON, got ? got : want, got);
+  if (!got) DEBUG_PRINTF("ERROR: JSON buffer allocation of %u failed!\n", want);
+  return got;
+}
 
-  while (jsonBufferLock && millis()-now < 1000) delay(1); // wait for a second for buffer lock
+// state is applied by one task at a time: pool buffers let requests of several tasks be parsed in parallel, but
+// deserializeState(), deserializeStateFast() and handleSet() change segments, brightness and presets without further locking
+#ifdef ARDUINO_ARCH_ESP32
+static SemaphoreHandle_t stateMutex = nullptr; // recursive, handleSet() may apply JSON state
+#endif
+
+void lockState()
+{
+  #ifdef ARDUINO_ARCH_ESP32
+  if (stateMutex) xSemaphoreTakeRecursive(stateMutex, portMAX_DELAY); // holders do not wait unbounded themselves
+  #endif
+}
 
-  if (millis()-now >= 1000) {
+void unlockState()
+{
+  #ifdef ARDUINO_ARCH_ESP32
+  if (stateMutex) xSemaphoreGiveRecursive(stateMutex);
+  #endif
+}
+
+void initJSONBufferPool()
+{
+  #ifdef ARDUINO_ARCH_ESP32
+  if (!stateMutex) stateMutex = xSemaphoreCreateRecursiveMutex(); // before the server and network tasks are started
+  #endif
+  size_t extra = 0;
+  size_t size = JSON_BUFFER_SIZE;
+  #ifdef ARDUINO_ARCH_ESP32
+    #if defined(BOARD_HAS_PSRAM) && defined(WLED_USE_PSRAM)
+  if (psramFound() && ESP.getFreePsram() > 8*JSON_BUFFER_SIZE) extra = WLED_JSON_POOL_SIZE - 1;
+  else
+    #endif
+  if (ESP.getMaxAllocHeap() > 4*JSON_BUFFER_SIZE) { extra = 1; size = JSON_BUFFER_SIZE/2; } // API requests are rarely large
+  #endif
+  for (size_t i = 0; i < extra && jsonPoolSize < WLED_JSON_POOL_SIZE; i++) {
+    PSRAMDynamicJsonDocument *d = new (std::nothrow) PSRAMDynamicJsonDocument(size);
+    if (!d || !d->capacity()) { delete d; break; }
+    heapTrackAlloc(HEAP_TAG_JSON, size, true); // pool buffers are never released (PSRAM if available)
+    jsonPool[jsonPoolSize++] = d;
+  }
+  DEBUG_PRINTF("JSON buffer pool: %u\n", jsonPoolSize);
+}
+
+// tries to claim global doc (slot 0) or, if anySlot, any free slot (pool slots first)
+static JsonDocument* claimJSONBuffer(uint8_t owner, bool anySlot)
+{
+  JsonDocument *d = nullptr;
+  JSON_POOL_ENTER;
+  for (size_t n = anySlot ? jsonPoolSize : 1, k = 0; k < n; k++) {
+    size_t i = (k + 1) % n; // 1, 2, ..., 0
+    if (jsonPoolOwner[i]) continue;
+    jsonPoolOwner[i] = owner;
+    #ifdef ARDUINO_ARCH_ESP32
+    jsonPoolTask[i] = xTaskGetCurrentTaskHandle();
+    #endif
+    d = jsonPool[i];
+    break;
+  }
+  JSON_POOL_EXIT;
+  return d;
+}
+
+static JsonDocument* waitJSONBuffer(uint8_t module, bool anySlot, unsigned timeout, size_t len)
+{
+  const uint8_t owner = module ? module : 255;
+  json_lock_stats_t &st = jsonLockStats[module < JSON_LOCK_OWNERS ? module : 0];
+  unsigned long now = millis();
+  st.requests++;
+  JsonDocument *d = claimJSONBuffer(owner, anySlot);
+  if (!d) {
+    st.waits++;
+    JSON_POOL_ENTER;
+    if (++jsonQueue > jsonQueuePeak) jsonQueuePeak = jsonQueue;
+    JSON_POOL_EXIT;
+    while (!(d = claimJSONBuffer(owner, anySlot)) && millis()-now < timeout) delay(1);
+    JSON_POOL_ENTER;
+    jsonQueue--;
+    JSON_POOL_EXIT;
+    uint16_t waited = min(millis()-now, 65535UL);
+    if (waited > st.maxWait) st.maxWait = waited;
+  }
+  if (!d) {
+    st.timeouts++;
     DEBUG_PRINT(F("ERROR: Locking JSON buffer failed! ("));
-    DEBUG_PRINT(jsonBufferLock);
+    DEBUG_PRINT(jsonPoolOwner[0]);
     DEBUG_PRINTLN(")");
-    return false; // waiting time-outed
+    return nullptr; // waiting time-outed
+  }
+  if (d == &doc && !allocJSONDoc(len)) {
+    st.timeouts++;
+    #ifdef ARDUINO_ARCH_ESP32
+    jsonPoolTask[0] = nullptr;
+    #endif
+    jsonPoolOwner[0] = 0;
+    return nullptr; // out of memory
   }
-
-  jsonBufferLock = module ? module : 255;
   DEBUG_PRINT(F("JSON buffer locked. ("));
-  DEBUG_PRINT(jsonBufferLock);
+  DEBUG_PRINT(owner);
   DEBUG_PRINTLN(")");
+  for (size_t i = 0; i < jsonPoolSize; i++) if (jsonPool[i] == d) {
+    jsonPoolSince[i] = micros();
+    jsonPoolWait[i] = min(millis()-now, 4095UL);
+    break;
+  }
+  d->clear();
+  return d;
+}
+
+//threading/network callback details: https://github.com/Aircoookie/WLED/pull/2336#discussion_r762276994
+bool requestJSONBufferLock(uint8_t module, size_t size, unsigned timeout)
+{
+  if (!waitJSONBuffer(module, false, timeout, size)) return false; // wait (a second by default) for buffer lock
+  jsonBufferLock = jsonPoolOwner[0];
   fileDoc = &doc;  // used for applying presets (presets.cpp)
-  doc.clear();
   return true;
 }
 
-
 void releaseJSONBufferLock()
 {
   DEBUG_PRINT(F("JSON buffer released. ("));
   DEBUG_PRINT(jsonBufferLock);
   DEBUG_PRINTLN(")");
+  traceEvent(TRACE_JSON, jsonPoolOwner[0], jsonPoolWait[0], jsonPoolSince[0], micros() - jsonPoolSince[0]);
   fileDoc = nullptr;
   jsonBufferLock = 0;
+  jsonDocLastUse = millis();
+  #ifdef ARDUINO_ARCH_ESP32
+  jsonPoolTask[0] = nullptr;
+  #endif
+  jsonPoolOwner[0] = 0;
+}
+
+// frees global doc storage once it was not used for WLED_JSON_IDLE_RELEASE ms (scheduler task)
+void handleJSONBufferIdle()
+{
+  #if WLED_JSON_IDLE_RELEASE > 0
+  if (!doc.capacity() || millis() - jsonDocLastUse < WLED_JSON_IDLE_RELEASE) return;
+  if (!claimJSONBuffer(255, false)) return; // in use
+  heapTrackFree(HEAP_TAG_JSON, doc.capacity());
+  doc = JSONBufferDocument(0);
+  DEBUG_PRINTLN(F("JSON buffer freed (idle)."));
+  #ifdef ARDUINO_ARCH_ESP32
+  jsonPoolTask[0] = nullptr;
+  #endif
+  jsonPoolOwner[0] = 0;
+  #endif
 }
 
+// any free pool document (pool slots first, global doc last), nullptr after timeout (ms)
+JsonDocument* requestJSONBuffer(uint8_t module, unsigned timeout, size_t size)
+{
+  JsonDocument *d = waitJSONBuffer(module, true, timeout, size);
+  if (d == &doc) {
+    jsonBufferLock = jsonPoolOwner[0];
+    fileDoc = &doc;
+  }
+  return d;
+}
+
+void releaseJSONBuffer(JsonDocument *d)
+{
+  if (d == &doc) { releaseJSONBufferLock(); return; }
+  for (size_t i = 1; i < jsonPoolSize; i++) if (jsonPool[i] == d) {
+    traceEvent(TRACE_JSON, jsonPoolOwner[i], jsonPoolWait[i] | (i << 12), jsonPoolSince[i], micros() - jsonPoolSince[i]);
+    DEBUG_PRINT(F("JSON buffer released. ("));
+    DEBUG_PRINT(jsonPoolOwner[i]);
+    DEBUG_PRINTLN(")");
+    #ifdef ARDUINO_ARCH_ESP32
+    jsonPoolTask[i] = nullptr;
+    #endif
+    jsonPoolOwner[i] = 0;
+    return;
+  }
+}
+
+// true if global doc (and fileDoc) is held by the calling task
+bool holdsJSONBufferLock()
+{
+  #ifdef ARDUINO_ARCH_ESP32
+  return jsonPoolOwner[0] && jsonPoolTask[0] == xTaskGetCurrentTaskHandle();
+  #else
+  return jsonPoolOwner[0]; // single threaded
+  #endif
+}
+
+uint8_t getJSONBufferPoolSize() { return jsonPoolSize; }
+uint8_t getJSONBuffersInUse() { uint8_t n = 0; for (size_t i = 0; i < jsonPoolSize; i++) if (jsonPoolOwner[i]) n++; return n; }
+uint8_t getJSONBufferQueue(bool peak) { return peak ? jsonQueuePeak : jsonQueue; }
+const json_lock_stats_t* getJSONLockStats(uint8_t owner) { return owner < JSON_LOCK_OWNERS ? &jsonLockStats[owner] : nullptr; }
+
+
+// section offsets of all effect data strings, built on first use (and again once usermods added effects) so that
+// name, slider and default lookups neither scan nor copy whole PROGMEM strings
+static mode_data_idx_t *modeDataIdx = nullptr;
+static uint8_t  modeDataIdxCount = 0;
+static uint32_t modeDataIdxHash = 0; // of all effect data strings (ETag of effects and fxdata responses)
+
+static bool buildModeDataIndex()
+{
+  const uint8_t count = strip.getModeCount();
+  mode_data_idx_t *idx = (mode_data_idx_t*) heapCalloc(HEAP_TAG_OTHER, count, sizeof(mode_data_idx_t));
+  if (!idx) return false;
+  uint32_t h = FNV1A_SEED;
+  for (size_t i = 0; i < count; i++) {
+    const char *p = strip.getModeData(i);
+    mode_data_idx_t &e = idx[i];
+    size_t n = 0;
+    for (uint8_t c; n < 255 && (c = pgm_read_byte(p + n)); n++) {
+      h = fnv1a(&c, 1, h); // flash strings are read byte wise
+      if (c == '@' && !e.sliders) e.sliders = n+1;
+      else if (c == ';') {
+        if (e.sliders && !e.colors)       e.colors  = n+1;
+        else if (e.colors && !e.palette)  e.palette = n+1;
+        e.defaults = n+1;
+      }
+    }
+    const uint8_t nul = 0;
+    h = fnv1a(&nul, 1, h);
+    e.len = n;
+  }
+  heapFree(HEAP_TAG_OTHER, modeDataIdx, modeDataIdxCount * sizeof(mode_data_idx_t));
+  modeDataIdx = idx;
+  modeDataIdxCount = count;
+  modeDataIdxHash = h ? h : 1;
+  return true;
+}
+
+const mode_data_idx_t *getModeDataIndex(uint8_t mode)
+{
+  if (mode >= strip.getModeCount()) return nullptr;
+  if (modeDataIdxCount != strip.getModeCount() && !buildModeDataIndex()) return nullptr;
+  return &modeDataIdx[mode];
+}
+
+uint32_t getModeDataHash()
+{
+  getModeDataIndex(0); // (re)build if needed
+  return modeDataIdxHash;
+}
+
+// copies characters [from, to) of effect data string into dest (size includes terminating 0), returns length
+size_t copyModeData(uint8_t mode, unsigned from, unsigned to, char *dest, size_t size)
+{
+  const mode_data_idx_t *idx = getModeDataIndex(mode);
+  size_t n = 0;
+  if (idx && size) {
+    to = MIN(to, idx->len);
+    if (to > from) {
+      n = MIN(to - from, size - 1);
+      memcpy_P(dest, strip.getModeData(mode) + from, n);
+    }
+    dest[n] = '\0';
+  }
+  return n;
+}
 
 // extracts effect mode (or palette) name from names serialized string
 // caller must provide large enough buffer for name (including SR extensions)!
 uint8_t extractModeName(uint8_t mode, const char *src, char *dest, uint8_t maxLen)
 {
   if (src == JSON_mode_names || src == nullptr) {
-    if (mode < strip.getModeCount()) {
-      char lineBuffer[256];
-      //strcpy_P(lineBuffer, (const char*)pgm_read_dword(&(WS2812FX::_modeData[mode])));
-      strncpy_P(lineBuffer, strip.getModeData(mode), sizeof(lineBuffer)/sizeof(char)-1);
-      lineBuffer[sizeof(lineBuffer)/sizeof(char)-1] = '\0'; // terminate string
-      size_t len = strlen(lineBuffer);
-      size_t j = 0;
-      for (; j < maxLen && j < len; j++) {
-        if (lineBuffer[j] == '\0' || lineBuffer[j] == '@') break;
-        dest[j] = lineBuffer[j];
-      }
-      dest[j] = 0; // terminate string
-      return strlen(dest);
-    } else return 0;
+    const mode_data_idx_t *idx = getModeDataIndex(mode);
+    if (!idx) return 0;
+    return copyModeData(mode, 0, idx->sliders ? idx->sliders-1 : idx->len, dest, maxLen+1);
   }
 
   if (src == JSON_palette_names && mode > GRADIENT_PALETTE_COUNT) {
@@ -294,95 +606,77 @@ uint8_t extractModeSlider(uint8_t mode, uint8_t slider, char *dest, uint8_t maxL
 {
   dest[0] = '\0'; // start by clearing buffer
 
-  if (mode < strip.getModeCount()) {
-    String lineBuffer = FPSTR(strip.getModeData(mode));
-    if (lineBuffer.length() > 0) {
-      int16_t start = lineBuffer.indexOf('@');
-      int16_t stop  = lineBuffer.indexOf(';', start);
-      if (start>0 && stop>0) {
-        String names = lineBuffer.substring(start, stop); // include @
-        int16_t nameBegin = 1, nameEnd, nameDefault;
-        if (slider < 10) {
-          for (size_t i=0; i<=slider; i++) {
-            const char *tmpstr;
-            dest[0] = '\0'; //clear dest buffer
-            if (nameBegin == 0) break; // there are no more names
-            nameEnd = names.indexOf(',', nameBegin);
-            if (i == slider) {
-              nameDefault = names.indexOf('=', nameBegin); // find default value
-              if (nameDefault > 0 && var && ((nameEnd>0 && nameDefault<nameEnd) || nameEnd<0)) {
-                *var = (uint8_t)atoi(names.substring(nameDefault+1).c_str());
-              }
-              if (names.charAt(nameBegin) == '!') {
-                switch (slider) {
-                  case  0: tmpstr = PSTR("FX Speed");     break;
-                  case  1: tmpstr = PSTR("FX Intensity"); break;
-                  case  2: tmpstr = PSTR("FX Custom 1");  break;
-                  case  3: tmpstr = PSTR("FX Custom 2");  break;
-                  case  4: tmpstr = PSTR("FX Custom 3");  break;
-                  default: tmpstr = PSTR("FX Custom");    break;
-                }
-                strncpy_P(dest, tmpstr, maxLen); // copy the name into buffer (replacing previous)
-                dest[maxLen-1] = '\0';
-              } else {
-                if (nameEnd<0) tmpstr = names.substring(nameBegin).c_str(); // did not find ",", last name?
-                else           tmpstr = names.substring(nameBegin, nameEnd).c_str();
-                strlcpy(dest, tmpstr, maxLen); // copy the name into buffer (replacing previous)
-              }
-            }
-            nameBegin = nameEnd+1; // next name (if "," is not found it will be 0)
-          } // next slider
-        } else if (slider == 255) {
-          // palette
-          strlcpy(dest, "pal", maxLen);
-          names = lineBuffer.substring(stop+1); // stop has index of color slot names
-          nameBegin = names.indexOf(';'); // look for palette
-          if (nameBegin >= 0) {
-            nameEnd = names.indexOf(';', nameBegin+1);
-            if (!isdigit(names[nameBegin+1])) nameBegin = names.indexOf('=', nameBegin+1); // look for default value
-            if (nameEnd >= 0 && nameBegin > nameEnd) nameBegin = -1;
-            if (nameBegin >= 0 && var) {
-              *var = (uint8_t)atoi(names.substring(nameBegin+1).c_str());
-            }
-          }
-        }
-        // we have slider name (including default value) in the dest buffer
-        for (size_t i=0; i<strlen(dest); i++) if (dest[i]=='=') { dest[i]='\0'; break; } // truncate default value
-
-      } else {
-        // defaults to just speed and intensity since there is no slider data
+  const mode_data_idx_t *idx = getModeDataIndex(mode);
+  if (!idx) return 0;
+  if (!idx->len) return 0;
+  if (idx->sliders > 1 && idx->colors) {
+    if (slider < 10) {
+      char names[256];
+      copyModeData(mode, idx->sliders, idx->colors-1, names, sizeof(names));
+      const char *name = names;
+      for (size_t i=0; i<slider && name; i++) { // skip to slider name
+        name = strchr(name, ',');
+        if (name) name++;
+      }
+      if (!name) return 0; // there are no more names
+      const char *nameEnd = strchr(name, ',');
+      const size_t nameLen = nameEnd ? nameEnd - name : strlen(name);
+      const char *nameDefault = (const char*)memchr(name, '=', nameLen); // find default value
+      if (nameDefault && var) *var = (uint8_t)atoi(nameDefault+1);
+      if (name[0] == '!') {
+        const char *tmpstr;
         switch (slider) {
-          case 0:  strncpy_P(dest, PSTR("FX Speed"), maxLen); break;
-          case 1:  strncpy_P(dest, PSTR("FX Intensity"), maxLen); break;
+          case  0: tmpstr = PSTR("FX Speed");     break;
+          case  1: tmpstr = PSTR("FX Intensity"); break;
+          case  2: tmpstr = PSTR("FX Custom 1");  break;
+          case  3: tmpstr = PSTR("FX Custom 2");  break;
+          case  4: tmpstr = PSTR("FX Custom 3");  break;
+          default: tmpstr = PSTR("FX Custom");    break;
         }
-        dest[maxLen] = '\0'; // strncpy does not necessarily null terminate string
+        strncpy_P(dest, tmpstr, maxLen); // copy the name into buffer
+        dest[maxLen-1] = '\0';
+      } else {
+        strlcpy(dest, name, MIN(nameLen+1, (size_t)maxLen)); // copy the name into buffer
+      }
+    } else if (slider == 255) {
+      // palette
+      strlcpy(dest, "pal", maxLen);
+      if (idx->palette && var) {
+        char pal[32];
+        copyModeData(mode, idx->palette, idx->len, pal, sizeof(pal));
+        char *palEnd = strchr(pal, ';');
+        if (palEnd) *palEnd = '\0';
+        const char *value = isdigit(pal[0]) ? pal : strchr(pal, '='); // look for default value
+        if (value == pal)  *var = (uint8_t)atoi(value);
+        else if (value)    *var = (uint8_t)atoi(value+1);
       }
     }
-    return strlen(dest);
+    // we have slider name (including default value) in the dest buffer
+    for (size_t i=0; i<strlen(dest); i++) if (dest[i]=='=') { dest[i]='\0'; break; } // truncate default value
+
+  } else {
+    // defaults to just speed and intensity since there is no slider data
+    switch (slider) {
+      case 0:  strncpy_P(dest, PSTR("FX Speed"), maxLen); break;
+      case 1:  strncpy_P(dest, PSTR("FX Intensity"), maxLen); break;
+    }
+    dest[maxLen] = '\0'; // strncpy does not necessarily null terminate string
   }
-  return 0;
+  return strlen(dest);
 }
 
 
 // extracts mode parameter defaults from last section of mode data (e.g. "Juggle@!,Trail;!,!,;!;sx=16,ix=240,1d")
 int16_t extractModeDefaults(uint8_t mode, const char *segVar)
 {
-  if (mode < strip.getModeCount()) {
-    char lineBuffer[256];
-    strncpy_P(lineBuffer, strip.getModeData(mode), sizeof(lineBuffer)/sizeof(char)-1);
-    lineBuffer[sizeof(lineBuffer)/sizeof(char)-1] = '\0'; // terminate string
-    if (lineBuffer[0] != 0) {
-      char* startPtr = strrchr(lineBuffer, ';'); // last ";" in FX data
-      if (!startPtr) return -1;
-
-      char* stopPtr = strstr(startPtr, segVar);
-      if (!stopPtr) return -1;
-
-      stopPtr += strlen(segVar) +1; // skip "="
-      return atoi(stopPtr);
-    }
-  }
-  return -1;
+  const mode_data_idx_t *idx = getModeDataIndex(mode);
+  if (!idx || !idx->defaults) return -1;
+  char defaults[128];
+  copyModeData(mode, idx->defaults, idx->len, defaults, sizeof(defaults));
+  char* stopPtr = strstr(defaults, segVar);
+  if (!stopPtr) return -1;
+  stopPtr += strlen(segVar) +1; // skip "="
+  return atoi(stopPtr);
 }
 
 
@@ -421,46 +715,55 @@ typedef enum UM_SoundSimulations {
   UMS_14_3
 } um_soundSimulations_t;
 
+// simulated values of one simulation type, computed once per frame and shared by all segments using that type
+typedef struct SoundSimulation {
+  float    volumeSmth;
+  uint16_t volumeRaw;
+  uint8_t  fftResult[16];
+  uint8_t  samplePeak;
+  float    FFT_MajorPeak;
+  float    my_magnitude;
+  uint8_t  maxVol;
+  uint8_t  binNum;
+  uint32_t frame;     // strip frame the values were computed for
+  bool     valid;
+  um_data_t um_data;  // points into this struct
+} sound_sim_t;
+
 um_data_t* simulateSound(uint8_t simulationId)
 {
-  static uint8_t samplePeak;
-  static float   FFT_MajorPeak;
-  static uint8_t maxVol;
-  static uint8_t binNum;
-
-  static float    volumeSmth;
-  static uint16_t volumeRaw;
-  static float    my_magnitude;
-
-  //arrays
-  uint8_t *fftResult;
-
-  static um_data_t* um_data = nullptr;
-
-  if (!um_data) {
-    //claim storage for arrays
-    fftResult = (uint8_t *)malloc(sizeof(uint8_t) * 16);
+  static sound_sim_t *sims[4] = {nullptr};
+  simulationId &= 3;
 
+  sound_sim_t *sim = sims[simulationId];
+  if (!sim) {
+    sim = new sound_sim_t();
     // initialize um_data pointer structure
     // NOTE!!!
     // This may change as AudioReactive usermod may change
-    um_data = new um_data_t;
+    um_data_t *um_data = &sim->um_data;
     um_data->u_size = 8;
     um_data->u_type = new um_types_t[um_data->u_size];
     um_data->u_data = new void*[um_data->u_size];
-    um_data->u_data[0] = &volumeSmth;
-    um_data->u_data[1] = &volumeRaw;
-    um_data->u_data[2] = fftResult;
-    um_data->u_data[3] = &samplePeak;
-    um_data->u_data[4] = &FFT_MajorPeak;
-    um_data->u_data[5] = &my_magnitude;
-    um_data->u_data[6] = &maxVol;
-    um_data->u_data[7] = &binNum;
-  } else {
-    // get arrays from um_data
-    fftResult =  (uint8_t*)um_data->u_data[2];
+    um_data->u_data[0] = &sim->volumeSmth;
+    um_data->u_data[1] = &sim->volumeRaw;
+    um_data->u_data[2] = sim->fftResult;
+    um_data->u_data[3] = &sim->samplePeak;
+    um_data->u_data[4] = &sim->FFT_MajorPeak;
+    um_data->u_data[5] = &sim->my_magnitude;
+    um_data->u_data[6] = &sim->maxVol;
+    um_data->u_data[7] = &sim->binNum;
+    sims[simulationId] = sim;
   }
 
+  // effects of one frame (on either core) see the same values, computing them twice per frame in a race is harmless
+  uint32_t frame = strip.getFrameCount();
+  if (sim->valid && sim->frame == frame) return &sim->um_data;
+  sim->frame = frame;
+  sim->valid = true;
+
+  uint8_t *fftResult = sim->fftResult;
+  float &volumeSmth  = sim->volumeSmth;
   uint32_t ms = millis();
 
   switch (simulationId) {
@@ -515,19 +818,49 @@ um_data_t* simulateSound(uint8_t simulationId)
       break;
   }
 
-  samplePeak    = random8() > 250;
-  FFT_MajorPeak = 21 + (volumeSmth*volumeSmth) / 8.0f; // walk thru full range of 21hz...8200hz
-  maxVol        = 31;  // this gets feedback fro UI
-  binNum        = 8;   // this gets feedback fro UI
-  volumeRaw = volumeSmth;
-  my_magnitude = 10000.0f / 8.0f; //no idea if 10000 is a good value for FFT_Magnitude ???
-  if (volumeSmth < 1 ) my_magnitude = 0.001f;             // noise gate closed - mute
+  sim->samplePeak    = random8() > 250;
+  sim->FFT_MajorPeak = 21 + (volumeSmth*volumeSmth) / 8.0f; // walk thru full range of 21hz...8200hz
+  sim->maxVol        = 31;  // this gets feedback fro UI
+  sim->binNum        = 8;   // this gets feedback fro UI
+  sim->volumeRaw = volumeSmth;
+  sim->my_magnitude = 10000.0f / 8.0f; //no idea if 10000 is a good value for FFT_Magnitude ???
+  if (volumeSmth < 1 ) sim->my_magnitude = 0.001f;             // noise gate closed - mute
 
-  return um_data;
+  return &sim->um_data;
 }
 
 
-// enumerate all ledmapX.json files on FS and extract ledmap names if existing
+// binary ledmap "ledmapN.bin" (all values little endian, see tools/ledmap2bin.py):
+//   "WMAP", uint8 version (1), uint8 flags (bit 0: RLE), uint16 number of entries, uint8 name length, name (not terminated)
+//   raw: uint16 per entry (0xFFFF = no LED)
+//   RLE: records of uint16 value and uint16 run (bits 0-13 length, bits 14-15: 0 same value, 1 ascending, 2 descending)
+// opens ledmap and reads its header, file is positioned at mapping data on success
+bool openLedmapBin(uint8_t n, File &f, uint16_t &count, bool &rle, char *name) {
+  char fileName[33];
+  strcpy_P(fileName, PSTR("/ledmap"));
+  if (n) sprintf(fileName +7, "%d", n);
+  strcat_P(fileName, PSTR(".bin"));
+  if (!WLED_FS.exists(fileName)) return false;
+  f = WLED_FS.open(fileName, "r");
+  if (!f) return false;
+  uint8_t hdr[9];
+  if (f.read(hdr, sizeof(hdr)) != sizeof(hdr) || strncmp_P((const char*)hdr, PSTR("WMAP"), 4) || hdr[4] != 1 || hdr[8] > 32) {
+    DEBUG_PRINT(F("Invalid binary ledmap ")); DEBUG_PRINTLN(fileName);
+    f.close();
+    return false;
+  }
+  rle   = hdr[5] & 0x01;
+  count = hdr[6] | (hdr[7] << 8);
+  if (name) {
+    name[0] = '\0';
+    if (hdr[8] && f.read((uint8_t*)name, hdr[8]) == hdr[8]) name[hdr[8]] = '\0';
+  } else {
+    f.seek(hdr[8], SeekCur);
+  }
+  return true;
+}
+
+// enumerate all ledmapX.json and ledmapX.bin files on FS and extract ledmap names if existing
 void enumerateLedmaps() {
   ledMaps = 1;
   for (size_t i=1; i<WLED_MAX_LEDMAPS; i++) {
@@ -542,11 +875,27 @@ void enumerateLedmaps() {
     }
     #endif
 
+    // binary ledmap takes precedence (its name is in the header, no JSON parsing needed)
+    File f;
+    uint16_t count;
+    bool rle;
+    char name[33];
+    if (openLedmapBin(i, f, count, rle, name)) {
+      f.close();
+      ledMaps |= 1 << i;
+      #ifndef ESP8266
+      if (!name[0]) snprintf_P(name, 32, PSTR("ledmap%d.bin"), i);
+      ledmapNames[i-1] = new char[strlen(name)+1];
+      if (ledmapNames[i-1]) strcpy(ledmapNames[i-1], name);
+      #endif
+      continue;
+    }
+
     if (isFile) {
       ledMaps |= 1 << i;
 
       #ifndef ESP8266
-      if (requestJSONBufferLock(21)) {
+      if (requestJSONBufferLock(JSON_LOCK_LEDMAP_ENUM)) {
         if (readObjectFromFile(fileName, nullptr, &doc)) {
           size_t len = 0;
           if (!doc["n"].isNull()) {
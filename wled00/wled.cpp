@@ -32,103 +32,58 @@ void WLED::reset()
   ESP.restart();
 }
 
-void WLED::loop()
-{
-  #ifdef WLED_DEBUG
-  static unsigned long lastRun = 0;
-  unsigned long        loopMillis = millis();
-  size_t               loopDelay = loopMillis - lastRun;
-  if (lastRun == 0) loopDelay=0; // startup - don't have valid data from last run.
-  if (loopDelay > 2) DEBUG_PRINTF("Loop delayed more than %ums.\n", loopDelay);
-  static unsigned long maxLoopMillis = 0;
-  static size_t        avgLoopMillis = 0;
-  static unsigned long maxUsermodMillis = 0;
-  static size_t        avgUsermodMillis = 0;
-  static unsigned long maxStripMillis = 0;
-  static size_t        avgStripMillis = 0;
-  unsigned long        stripMillis;
-  #endif
+/*
+ * Subsystems run by the scheduler (scheduler.cpp) from loop(), registered in registerLoopTasks()
+ */
+static int8_t taskStrip = -1, taskUsermods = -1;
 
-  handleTime();
-  #ifndef WLED_DISABLE_INFRARED
-  handleIR();        // 2nd call to function needed for ESP32 to return valid results -- should be good for ESP8266, too
-  #endif
-  handleConnection();
-  #ifndef WLED_DISABLE_ESPNOW
-  handleRemote();
-  #endif
-  handleSerial();
-  handleImprovWifiScan();
-  handleNotifications();
-  handleTransitions();
-#ifdef WLED_ENABLE_DMX
-  handleDMX();
-#endif
-  userLoop();
+static void loopConnection()  { WLED::instance().handleConnection(); }
+static void loopStatusLED()   { WLED::instance().handleStatusLED(); }
+static void loopUsermods()    { userLoop(); usermods.loop(); }
 
-  #ifdef WLED_DEBUG
-  unsigned long usermodMillis = millis();
-  #endif
-  usermods.loop();
-  #ifdef WLED_DEBUG
-  usermodMillis = millis() - usermodMillis;
-  avgUsermodMillis += usermodMillis;
-  if (usermodMillis > maxUsermodMillis) maxUsermodMillis = usermodMillis;
-  #endif
+static void loopCloseFile()
+{
+  if (doCloseFile) closeFile();
+}
 
-  yield();
-  handleIO();
-  #ifndef WLED_DISABLE_INFRARED
-  handleIR();
-  #endif
-  #ifndef WLED_DISABLE_ALEXA
-  handleAlexa();
-  #endif
+static void loopDNS()
+{
+  if (apActive) dnsServer.processNextRequest();
+}
 
-  if (doCloseFile) {
-    closeFile();
-    yield();
-  }
+#ifndef WLED_DISABLE_OTA
+static void loopOTA()
+{
+  if (WLED_CONNECTED && aOtaEnabled && !otaLock && correctPIN) ArduinoOTA.handle();
+}
+#endif
 
-  #ifdef WLED_DEBUG
-  stripMillis = millis();
+static void loopStrip()
+{
+  if (!offMode || strip.isOffRefreshRequired())
+    strip.service();
+  #ifdef ESP8266
+  else if (!noWifiSleep && !realtimeProfile)
+    delay(1); //required to make sure ESP enters modem sleep (see #1184)
   #endif
-  if (!realtimeMode || realtimeOverride || (realtimeMode && useMainSegmentOnly))  // block stuff if WARLS/Adalight is enabled
-  {
-    if (apActive) dnsServer.processNextRequest();
-    #ifndef WLED_DISABLE_OTA
-    if (WLED_CONNECTED && aOtaEnabled && !otaLock && correctPIN) ArduinoOTA.handle();
-    #endif
-    handleNightlight();
-    handlePlaylist();
-    yield();
-
-    #ifndef WLED_DISABLE_HUESYNC
-    handleHue();
-    yield();
-    #endif
-
-    handlePresets();
-    yield();
-
-    if (!offMode || strip.isOffRefreshRequired())
-      strip.service();
-    #ifdef ESP8266
-    else if (!noWifiSleep)
-      delay(1); //required to make sure ESP enters modem sleep (see #1184)
-    #endif
+  if (!firstLightMs && briT) firstLightMs = millis();
+  static uint32_t lastShowSeen = 0;
+  if (strip.getLastShow() != lastShowSeen && usermods.wantsEvent(UM_EVENT_FRAME)) {
+    um_event_t ev = {UM_EVENT_FRAME, CALL_MODE_NO_NOTIFY};
+    ev.frame.fps = strip.getFps();
+    ev.frame.time = strip.getLastShow();
+    usermods.dispatchEvent(ev);
   }
-  #ifdef WLED_DEBUG
-  stripMillis = millis() - stripMillis;
-  avgStripMillis += stripMillis;
-  if (stripMillis > maxStripMillis) maxStripMillis = stripMillis;
-  #endif
+  lastShowSeen = strip.getLastShow();
+}
 
-  yield();
 #ifdef ESP8266
-  MDNS.update();
+static void loopMDNS()        { MDNS.update(); }
 #endif
 
+// MQTT reconnect, node list refresh and millis() rollover
+static void loopReconnect()
+{
   //millis() rolls over every 50 days
   if (lastMqttReconnectAttempt > millis()) {
     rolloverMillis++;
@@ -145,51 +100,153 @@ void WLED::loop()
     // refresh WLED nodes list
     refreshNodeList();
     if (nodeBroadcastEnabled) sendSysInfoUDP();
-    yield();
   }
+}
 
-  // 15min PIN time-out
+// 15min PIN time-out
+static void loopPinTimeout()
+{
   if (strlen(settingsPIN)>0 && correctPIN && millis() - lastEditTime > PIN_TIMEOUT) {
     correctPIN = false;
     createEditHandler(false);
   }
+}
 
-  //LED settings have been saved, re-init busses
+//LED settings have been saved, re-init busses
+static void loopBusInit()
+{
   //This code block causes severe FPS drop on ESP32 with the original "if (busConfigs[0] != nullptr)" conditional. Investigate!
   if (doInitBusses) {
     doInitBusses = false;
     DEBUG_PRINTLN(F("Re-init busses."));
     bool aligned = strip.checkSegmentAlignment(); //see if old segments match old bus(ses)
-    busses.removeAll();
-    uint32_t mem = 0, globalBufMem = 0;
-    uint16_t maxlen = 0;
+    strip.waitForOutput(); // output task may still be sending last frame
+    BusConfig *cfgs[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES];
+    uint8_t numCfgs = 0;
+    uint32_t mem = 0;
     for (uint8_t i = 0; i < WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES; i++) {
       if (busConfigs[i] == nullptr) break;
-      mem += BusManager::memUsage(*busConfigs[i]);
-      if (useGlobalLedBuffer && busConfigs[i]->start + busConfigs[i]->count > maxlen) {
-          maxlen = busConfigs[i]->start + busConfigs[i]->count;
-          globalBufMem = maxlen * 4;
-      }
-      if (mem + globalBufMem <= MAX_LED_MEMORY) {
-        busses.add(*busConfigs[i]);
+      mem += BusManager::memUsage(*busConfigs[i], numCfgs); // as the bus number it gets if it fits
+      if (mem <= MAX_LED_MEMORY) {
+        cfgs[numCfgs++] = busConfigs[i];
       }
+    }
+    // unchanged busses keep running (and their buffers), segments are only rebuilt if the layout changed
+    bool relayout;
+    int created = busses.reconfigure(cfgs, numCfgs, relayout);
+    for (uint8_t i = 0; i < WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES && busConfigs[i] != nullptr; i++) {
       delete busConfigs[i]; busConfigs[i] = nullptr;
     }
-    strip.finalizeInit(); // also loads default ledmap if present
-    if (aligned) strip.makeAutoSegments();
-    else strip.fixInvalidSegments();
+    if (created || relayout) strip.finalizeInit(); // also loads default ledmap if present
+    if (relayout) {
+      if (aligned) strip.makeAutoSegments();
+      else strip.fixInvalidSegments();
+    }
     doSerializeConfig = true;
   }
   if (loadLedmap >= 0) {
     if (!strip.deserializeMap(loadLedmap) && strip.isMatrix && loadLedmap == 0) strip.setUpMatrix();
     loadLedmap = -1;
   }
-  yield();
-  if (doSerializeConfig) serializeConfig();
+}
+
+// collect config changes arriving in quick succession (UI, automation) into a single write
+static void loopConfigSave()
+{
+  static unsigned long configDirtyTime = 0;
+  if (doSerializeConfig) {
+    if (!configDirtyTime) configDirtyTime = millis() | 1;
+    if (doReboot || millis() - configDirtyTime > CONFIG_SAVE_DELAY) serializeConfig();
+    if (!doSerializeConfig) configDirtyTime = 0;
+  }
+}
 
-  yield();
-  handleWs();
-  handleStatusLED();
+static void handlePinEvents()
+{
+  pinManager.handleEvents();
+}
+
+// order of registration is the order of execution within a loop iteration
+static void registerLoopTasks()
+{
+  schedAddTask("pinev",   handlePinEvents, 0, TASK_PRIO_HIGH); // sensor edges captured by ISR
+  schedAddTask("time",    handleTime);
+  #ifndef WLED_DISABLE_INFRARED
+  schedAddTask("ir",      handleIR, 0, TASK_PRIO_HIGH); // 2nd call to function needed for ESP32 to return valid results -- should be good for ESP8266, too
+  #endif
+  schedAddTask("conn",    loopConnection);
+  #ifndef WLED_DISABLE_ESPNOW
+  schedAddTask("espnow",  handleRemote, 0, TASK_PRIO_HIGH);
+  #endif
+  schedAddTask("serial",  handleSerial, 0, TASK_PRIO_HIGH);
+  schedAddTask("improv",  handleImprovWifiScan);
+  schedAddTask("notify",  handleNotifications, 0, TASK_PRIO_HIGH);
+  schedAddTask("trans",   handleTransitions, 0, TASK_PRIO_HIGH);
+  #ifdef WLED_ENABLE_DMX
+  schedAddTask("dmx",     handleDMX, 0, TASK_PRIO_HIGH);
+  #endif
+  #ifdef WLED_ENABLE_DMX_INPUT
+  schedAddTask("dmxin",   handleDMXInput, 0, TASK_PRIO_HIGH);
+  #endif
+  #ifdef WLED_ENABLE_FSEQ
+  schedAddTask("fseq",    handleFseq, 0, TASK_PRIO_HIGH);
+  #endif
+  taskUsermods =
+  schedAddTask("um",      loopUsermods, 0, TASK_PRIO_NORMAL, 0, TASK_YIELD);
+  schedAddTask("io",      handleIO, 0, TASK_PRIO_HIGH);
+  schedAddTask("adc",     sampleAnalogButtons, 20, TASK_PRIO_IDLE, 2000); // analog buttons, sampled between frames
+  #ifndef WLED_DISABLE_INFRARED
+  schedAddTask("ir2",     handleIR, 0, TASK_PRIO_HIGH);
+  #endif
+  #ifndef WLED_DISABLE_ALEXA
+  schedAddTask("alexa",   handleAlexa);
+  #endif
+  schedAddTask("close",   loopCloseFile, 0, TASK_PRIO_NORMAL, 0, TASK_YIELD);
+  // blocked while WARLS/Adalight etc. is active
+  schedAddTask("dns",     loopDNS, 0, TASK_PRIO_NORMAL, 0, TASK_NO_REALTIME);
+  #ifndef WLED_DISABLE_OTA
+  schedAddTask("ota",     loopOTA, 0, TASK_PRIO_NORMAL, 0, TASK_NO_REALTIME);
+  #endif
+  schedAddTask("nl",      handleNightlight, 0, TASK_PRIO_HIGH, 0, TASK_NO_REALTIME);
+  schedAddTask("pl",      handlePlaylist, 0, TASK_PRIO_HIGH, 0, TASK_NO_REALTIME | TASK_YIELD);
+  #ifndef WLED_DISABLE_HUESYNC
+  schedAddTask("hue",     handleHue, 0, TASK_PRIO_NORMAL, 0, TASK_NO_REALTIME | TASK_YIELD);
+  #endif
+  schedAddTask("presets", handlePresets, 0, TASK_PRIO_HIGH, 0, TASK_NO_REALTIME);
+  schedAddTask("jnl",     handleFileJournal, 250, TASK_PRIO_IDLE, 50000, TASK_NO_REALTIME);
+  #ifndef WLED_DISABLE_FS_STATS
+  schedAddTask("fsbench", handleFSBenchmark, 500, TASK_PRIO_IDLE, 65535, TASK_NO_REALTIME);
+  #endif
+  taskStrip =
+  schedAddTask("strip",   loopStrip, 0, TASK_PRIO_HIGH, 0, TASK_NO_REALTIME | TASK_YIELD);
+  schedAddTask("boot",    handleBootFrame, 250, TASK_PRIO_IDLE, 20000);
+  #ifdef ESP8266
+  schedAddTask("mdns",    loopMDNS);
+  #endif
+  schedAddTask("reconn",  loopReconnect, 1000, TASK_PRIO_IDLE, 20000, TASK_YIELD);
+  schedAddTask("pin",     loopPinTimeout, 1000, TASK_PRIO_IDLE, 1000);
+  schedAddTask("heap",    handleHeapMonitor, 1000, TASK_PRIO_IDLE, 200);
+  schedAddTask("json",    handleJSONBufferIdle, 1000, TASK_PRIO_IDLE, 200);
+  schedAddTask("bus",     loopBusInit, 0, TASK_PRIO_NORMAL, 0, TASK_YIELD);
+  schedAddTask("cfg",     loopConfigSave, 0, TASK_PRIO_NORMAL, 0, TASK_YIELD);
+  schedAddTask("ws",      handleWs);
+  schedAddTask("led",     loopStatusLED);
+}
+
+void WLED::loop()
+{
+  uint32_t loopStartUs = micros(); // loop timing for /metrics (always collected)
+  #ifdef WLED_DEBUG
+  static unsigned long lastRun = 0;
+  unsigned long        loopMillis = millis();
+  size_t               loopDelay = loopMillis - lastRun;
+  if (lastRun == 0) loopDelay=0; // startup - don't have valid data from last run.
+  if (loopDelay > 2) DEBUG_PRINTF("Loop delayed more than %ums.\n", loopDelay);
+  static unsigned long maxLoopMillis = 0;
+  static size_t        avgLoopMillis = 0;
+  #endif
+
+  schedRun(); // all subsystems, see registerLoopTasks()
 
   toki.resetTick();
 
@@ -209,13 +266,20 @@ void WLED::loop()
   if (doReboot && (!doInitBusses || !doSerializeConfig)) // if busses have to be inited & saved, wait until next iteration
     reset();
 
+  const sched_task_t *stripTask = getSchedTask(taskStrip), *umTask = getSchedTask(taskUsermods);
+  addLoopStats(micros() - loopStartUs, stripTask ? stripTask->lastUs : 0, umTask ? umTask->lastUs : 0);
+  traceEvent(TRACE_LOOP, 0, 0, loopStartUs, micros() - loopStartUs);
+  handleIdle();
+
 // DEBUG serial logging (every 30s)
 #ifdef WLED_DEBUG
   loopMillis = millis() - loopMillis;
   if (loopMillis > 30) {
     DEBUG_PRINTF("Loop took %lums.\n", loopMillis);
-    DEBUG_PRINTF("Usermods took %lums.\n", usermodMillis);
-    DEBUG_PRINTF("Strip took %lums.\n", stripMillis);
+    for (uint8_t i = 0; i < getSchedTaskCount(); i++) {
+      const sched_task_t *t = getSchedTask(i);
+      if (t->lastUs > 10000) DEBUG_PRINTF("%s took %lums.\n", t->name, t->lastUs/1000);
+    }
   }
   avgLoopMillis += loopMillis;
   if (loopMillis > maxLoopMillis) maxLoopMillis = loopMillis;
@@ -242,16 +306,15 @@ void WLED::loop()
     if (loops > 0) { // avoid division by zero
       DEBUG_PRINT(F("Loops/sec: "));       DEBUG_PRINTLN(loops / 30);
       DEBUG_PRINT(F("Loop time[ms]: "));   DEBUG_PRINT(avgLoopMillis/loops); DEBUG_PRINT("/");DEBUG_PRINTLN(maxLoopMillis);
-      DEBUG_PRINT(F("UM time[ms]: "));     DEBUG_PRINT(avgUsermodMillis/loops); DEBUG_PRINT("/");DEBUG_PRINTLN(maxUsermodMillis);
-      DEBUG_PRINT(F("Strip time[ms]: "));  DEBUG_PRINT(avgStripMillis/loops); DEBUG_PRINT("/"); DEBUG_PRINTLN(maxStripMillis);
+    }
+    // per task: average/maximum run time [us], runs, idle runs postponed
+    for (uint8_t i = 0; i < getSchedTaskCount(); i++) {
+      const sched_task_t *t = getSchedTask(i);
+      if (t->runs) DEBUG_PRINTF("%-8s %lu/%lu us, %lu runs, %lu deferred\n", t->name, (unsigned long)(t->totalUs/t->runs), t->maxUs, t->runs, t->deferred);
     }
     strip.printSize();
     loops = 0;
     maxLoopMillis = 0;
-    maxUsermodMillis = 0;
-    maxStripMillis = 0;
-    avgUsermodMillis = 0;
-    avgStripMillis = 0;
     debugTime = millis();
   }
   loops++;
@@ -297,6 +360,9 @@ void WLED::setup()
   #ifdef ARDUINO_ARCH_ESP32
   pinMode(hardwareRX, INPUT_PULLDOWN); delay(1);        // suppress noise in case RX pin is floating (at low noise energy) - see issue #3128
   #endif
+  #ifdef WLED_ENABLE_ADALIGHT
+  Serial.setRxBufferSize(WLED_SERIAL_RX_BUFFER); // must be set before begin()
+  #endif
   Serial.begin(115200);
   #if !ARDUINO_USB_CDC_ON_BOOT
   Serial.setTimeout(50);  // this causes troubles on new MCUs that have a "virtual" USB Serial (HWCDC)
@@ -408,9 +474,9 @@ pinManager.allocateMultiplePins(pins, sizeof(pins)/sizeof(managed_pin_type), Pin
   if (!fsinit) {
     DEBUGFS_PRINTLN(F("FS failed!"));
     errorFlag = ERR_FS_BEGIN;
-  }
+  } else recoverFS(); // finish file replacements interrupted by power loss
 #ifdef WLED_ADD_EEPROM_SUPPORT
-  else deEEP();
+  if (fsinit) deEEP();
 #else
   initPresetsFile();
 #endif
@@ -443,6 +509,8 @@ pinManager.allocateMultiplePins(pins, sizeof(pins)/sizeof(managed_pin_type), Pin
   usermods.setup();
   DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
 
+  initJSONBufferPool(); // after LED and usermod buffers are allocated
+
   if (strcmp(clientSSID, DEFAULT_CLIENT_SSID) == 0)
     showWelcomePage = true;
   WiFi.persistent(false);
@@ -489,6 +557,9 @@ pinManager.allocateMultiplePins(pins, sizeof(pins)/sizeof(managed_pin_type), Pin
 #ifdef WLED_ENABLE_DMX
   initDMX();
 #endif
+#ifdef WLED_ENABLE_DMX_INPUT
+  initDMXInput();
+#endif
 
 #ifdef WLED_ENABLE_ADALIGHT
   if (Serial.available() > 0 && Serial.peek() == 'I') handleImprovPacket();
@@ -499,6 +570,8 @@ pinManager.allocateMultiplePins(pins, sizeof(pins)/sizeof(managed_pin_type), Pin
   initServer();
   DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
 
+  registerLoopTasks();
+
   enableWatchdog();
 
   #if defined(ARDUINO_ARCH_ESP32) && defined(WLED_DISABLE_BROWNOUT_DET)
@@ -511,7 +584,7 @@ void WLED::beginStrip()
   // Initialize NeoPixel Strip and button
   strip.finalizeInit(); // busses created during deserializeConfig()
   strip.makeAutoSegments();
-  strip.setBrightness(0);
+  if (!showBootFrame()) strip.setBrightness(0); // light up with the stored boot frame right away if possible
   strip.setShowCallback(handleOverlayDraw);
 
   if (turnOnAtBoot) {
@@ -563,7 +636,7 @@ void WLED::initAP(bool resetAP)
     if (udpPort2 > 0 && udpPort2 != ntpLocalPort && udpPort2 != udpPort && udpPort2 != udpRgbPort) {
       udp2Connected = notifier2Udp.begin(udpPort2);
     }
-    e131.begin(false, e131Port, e131Universe, E131_MAX_UNIVERSE_COUNT);
+    e131.begin(false, e131Port, e131Universe);
     ddp.begin(false, DDP_DEFAULT_PORT);
 
     dnsServer.setErrorReplyCode(DNSReplyCode::NoError);
@@ -693,6 +766,7 @@ void WLED::initConnection()
   }
 
   lastReconnectAttempt = millis();
+  if (!wifiFastFailed) wifiConnectStart = lastReconnectAttempt; // a fallback scan continues the cycle
 
   if (!WLED_WIFI_CONFIGURED) {
     DEBUG_PRINTLN(F("No connection configured."));
@@ -722,15 +796,17 @@ void WLED::initConnection()
   WiFi.hostname(hostname);
 #endif
 
-  WiFi.begin(clientSSID, clientPass);
+  wifiFastConnect = !wifiFastFailed && beginFastConnect();
+  wifiFastFailed = false;
+  if (!wifiFastConnect) WiFi.begin(clientSSID, clientPass);
 #ifdef ARDUINO_ARCH_ESP32
   #if defined(LOLIN_WIFI_FIX) && (defined(ARDUINO_ARCH_ESP32C3) || defined(ARDUINO_ARCH_ESP32S2) || defined(ARDUINO_ARCH_ESP32S3))
   WiFi.setTxPower(WIFI_POWER_8_5dBm);
   #endif
-  WiFi.setSleep(!noWifiSleep);
+  WiFi.setSleep(!(noWifiSleep || realtimeProfile));
   WiFi.setHostname(hostname);
 #else
-  wifi_set_sleep_type((noWifiSleep) ? NONE_SLEEP_T : MODEM_SLEEP_T);
+  wifi_set_sleep_type((noWifiSleep || realtimeProfile) ? NONE_SLEEP_T : MODEM_SLEEP_T);
 #endif
 }
 
@@ -782,7 +858,7 @@ void WLED::initInterfaces()
   if (ntpEnabled)
     ntpConnected = ntpUdp.begin(ntpLocalPort);
 
-  e131.begin(e131Multicast, e131Port, e131Universe, E131_MAX_UNIVERSE_COUNT);
+  e131.begin(e131Multicast, e131Port, e131Universe, MIN(e131UniverseCount(), 255)); // multicast groups of used universes only
   ddp.begin(false, DDP_DEFAULT_PORT);
   reconnectHue();
 #ifndef WLED_DISABLE_MQTT
@@ -858,6 +934,12 @@ void WLED::handleConnection()
       interfacesInited = false;
       initConnection();
     }
+    if (wifiFastConnect && !stac && now - lastReconnectAttempt > WLED_FAST_CONNECT_TIMEOUT && WLED_WIFI_CONFIGURED) {
+      DEBUG_PRINTLN(F("Fast connect failed, scanning."));
+      wifiFastFailed = true;
+      initConnection();
+      return;
+    }
     //send improv failed 6 seconds after second init attempt (24 sec. after provisioning)
     if (improvActive > 2 && now - lastReconnectAttempt > 6000) {
       sendImprovStateResponse(0x03, true);
@@ -876,6 +958,11 @@ void WLED::handleConnection()
     DEBUG_PRINTLN("");
     DEBUG_PRINT(F("Connected! IP address: "));
     DEBUG_PRINTLN(Network.localIP());
+    wifiConnectTime = MIN(now - wifiConnectStart, 65535UL);
+    wifiLastFast = wifiFastConnect;
+    if (wasConnected) wifiReconnects++;
+    DEBUG_PRINTF("Connection took %u ms%s.\n", wifiConnectTime, wifiLastFast ? " (fast)" : "");
+    saveFastConnect();
     if (improvActive) {
       if (improvError == 3) sendImprovStateResponse(0x00, true);
       sendImprovStateResponse(0x04);
@@ -36,6 +36,8 @@
   #undef WLED_ENABLE_ADALIGHT      // disable has priority over enable
 #endif
 //#define WLED_ENABLE_DMX          // uses 3.5kb (use LEDPIN other than 2)
+//#define WLED_ENABLE_DMX_INPUT    // wired DMX512 input via RS-485 transceiver (ESP32 only, pins in sync settings)
+//#define WLED_ENABLE_FSEQ         // xLights/FPP .fseq sequence playback from LittleFS or SD card ("fseq" in JSON state)
 #define WLED_ENABLE_JSONLIVE     // peek LED output via /json/live (WS binary peek is always enabled)
 #ifndef WLED_DISABLE_LOXONE
   #define WLED_ENABLE_LOXONE       // uses 1.2kb
@@ -47,6 +49,7 @@
 //#define WLED_DISABLE_ESPNOW      // Removes dependence on esp now 
 
 #define WLED_ENABLE_FS_EDITOR      // enable /edit page for editing FS content. Will also be disabled with OTA lock
+//#define WLED_ENABLE_PRESETS_BIN    // store presets as MessagePack records in presets.bin, presets.json is exported on demand
 
 // to toggle usb serial debug (un)comment the following line
 //#define WLED_DEBUG
@@ -173,6 +176,27 @@ using PSRAMDynamicJsonDocument = BasicJsonDocument<PSRAM_Allocator>;
 #define PSRAMDynamicJsonDocument DynamicJsonDocument
 #endif
 
+// global doc storage: allocated on demand (PSRAM if available) and released when idle (util.cpp)
+struct JSONBuffer_Allocator {
+  void* allocate(size_t size) {
+    if (!size) return nullptr; // empty doc owns no memory
+    #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM) && defined(WLED_USE_PSRAM)
+    if (psramFound()) return ps_malloc(size);
+    #endif
+    return malloc(size);
+  }
+  void* reallocate(void* ptr, size_t new_size) {
+    #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM) && defined(WLED_USE_PSRAM)
+    if (psramFound()) return ps_realloc(ptr, new_size);
+    #endif
+    return realloc(ptr, new_size);
+  }
+  void deallocate(void* pointer) {
+    free(pointer);
+  }
+};
+using JSONBufferDocument = BasicJsonDocument<JSONBuffer_Allocator>;
+
 #include "const.h"
 #include "fcn_declare.h"
 #include "NodeStruct.h"
@@ -316,6 +340,7 @@ WLED_GLOBAL bool noWifiSleep _INIT(true);                          // disabling
 WLED_GLOBAL bool noWifiSleep _INIT(false);
 #endif
 WLED_GLOBAL bool force802_3g _INIT(false);
+WLED_GLOBAL bool realtimeProfile _INIT(false);                     // low latency realtime input: no modem sleep, queued UDP packets handled in bursts
 
 #ifdef WLED_USE_ETHERNET
   #ifdef WLED_ETH_DEFAULT                                          // default ethernet board type if specified
@@ -394,6 +419,8 @@ WLED_GLOBAL bool notifyAlexa  _INIT(false);                       // send notifi
 WLED_GLOBAL bool notifyMacro  _INIT(false);                       // send notification for macro
 WLED_GLOBAL bool notifyHue    _INIT(true);                        // send notification if Hue light changes
 WLED_GLOBAL uint8_t udpNumRetries _INIT(0);                       // Number of times a UDP sync message is retransmitted. Increase to increase reliability
+WLED_GLOBAL bool    udpDeltaNotify _INIT(false);                   // send only changed bytes of sync messages (receivers must support it)
+WLED_GLOBAL byte    clockSyncMode _INIT(CLOCK_SYNC_OFF);           // cluster clock sync of effect timebase: off, follower or leader
 
 WLED_GLOBAL bool alexaEnabled _INIT(false);                       // enable device discovery by Amazon Echo
 WLED_GLOBAL char alexaInvocationName[33] _INIT("Light");          // speech control name of device. Choose something voice-to-text can understand
@@ -401,6 +428,9 @@ WLED_GLOBAL byte alexaNumPresets _INIT(0);                        // number of p
 
 WLED_GLOBAL uint16_t realtimeTimeoutMs _INIT(2500);               // ms timeout of realtime mode before returning to normal mode
 WLED_GLOBAL int arlsOffset _INIT(0);                              // realtime LED offset
+WLED_GLOBAL rt_route_t realtimeRoutes[WLED_MAX_RT_ROUTES];        // realtime stream ranges routed into segments, others keep running effects
+WLED_GLOBAL byte realtimeRouteCount _INIT(0);                     // 0 = realtime data maps linearly onto the strip (or main segment)
+WLED_GLOBAL bool realtimeFade _INIT(false);                       // live segments (main segment only or routes) fade in/out over transitionDelay
 WLED_GLOBAL bool receiveDirect _INIT(true);                       // receive UDP realtime
 WLED_GLOBAL bool arlsDisableGammaCorrection _INIT(true);          // activate if gamma correction is handled by the source
 WLED_GLOBAL bool arlsForceMaxBri _INIT(false);                    // enable to force max brightness if source has very dark colors that would be black
@@ -413,14 +443,38 @@ WLED_GLOBAL bool arlsForceMaxBri _INIT(false);                    // enable to f
  #endif
 WLED_GLOBAL uint16_t e131ProxyUniverse _INIT(0);                  // output this E1.31 (sACN) / ArtNet universe via MAX485 (0 = disabled)
 #endif
+#ifdef WLED_ENABLE_DMX_INPUT
+ #ifndef ARDUINO_ARCH_ESP32
+  #error "DMX input requires ESP32."
+ #endif
+ #ifndef DMX_INPUT_RX_PIN
+  #define DMX_INPUT_RX_PIN -1
+ #endif
+ #ifndef DMX_INPUT_EN_PIN
+  #define DMX_INPUT_EN_PIN -1
+ #endif
+WLED_GLOBAL int8_t dmxInputRxPin _INIT(DMX_INPUT_RX_PIN);          // RS-485 receiver output (RO), -1 = DMX input disabled
+WLED_GLOBAL int8_t dmxInputEnPin _INIT(DMX_INPUT_EN_PIN);          // transceiver DE/RE, held low to receive (-1 = not connected)
+#endif
 WLED_GLOBAL uint16_t e131Universe _INIT(1);                       // settings for E1.31 (sACN) protocol (only DMX_MODE_MULTIPLE_* can span over consecutive universes)
 WLED_GLOBAL uint16_t e131Port _INIT(5568);                        // DMX in port. E1.31 default is 5568, Art-Net is 6454
 WLED_GLOBAL byte e131Priority _INIT(0);                           // E1.31 port priority (if != 0 priority handling is active)
+WLED_GLOBAL uint16_t netOutUniverse _INIT(1);                     // first universe sent by E1.31 network busses
+WLED_GLOBAL byte e131OutPriority _INIT(100);                       // E1.31 priority of network bus output (0-200)
+WLED_GLOBAL uint16_t netOutPacing _INIT(0);                       // delay after each network bus packet (us)
+WLED_GLOBAL uint16_t netOutChannels _INIT(0);                     // DMX channels per universe sent by network busses (0 = 510 for RGB, 512 for RGBW)
+WLED_GLOBAL byte artnetOutNet _INIT(0);                            // Art-Net network bus output port address: net (0-127)
+WLED_GLOBAL byte artnetOutSubnet _INIT(0);                         // subnet (0-15)
+WLED_GLOBAL byte artnetOutUniverse _INIT(0);                       // and universe (0-15) of first packet
+WLED_GLOBAL bool artnetOutSync _INIT(true);                        // send ArtSync after each Art-Net frame
 WLED_GLOBAL E131Priority highPriority _INIT(3);                   // E1.31 highest priority tracking, init = timeout in seconds
 WLED_GLOBAL byte DMXMode _INIT(DMX_MODE_MULTIPLE_RGB);            // DMX mode (s.a.)
 WLED_GLOBAL uint16_t DMXAddress _INIT(1);                         // DMX start address of fixture, a.k.a. first Channel [for E1.31 (sACN) protocol]
 WLED_GLOBAL uint16_t DMXSegmentSpacing _INIT(0);                  // Number of void/unused channels between each segments DMX channels
-WLED_GLOBAL byte e131LastSequenceNumber[E131_MAX_UNIVERSE_COUNT]; // to detect packet loss
+WLED_GLOBAL byte *e131LastSequenceNumber _INIT(nullptr);           // to detect packet loss, one per universe
+WLED_GLOBAL uint16_t e131Universes _INIT(0);                       // number of universes tracked (from DMX mode and LED count)
+WLED_GLOBAL uint16_t e131FrameTimeout _INIT(E131_FRAME_TIMEOUT);     // ms an incomplete (or unsynchronized) frame is held before it is shown anyway
+WLED_GLOBAL uint16_t ddpPresentationDelay _INIT(0);                 // ms added to DDP timecodes before a frame is presented (requires NTP or UDP synced time)
 WLED_GLOBAL bool e131Multicast _INIT(false);                      // multicast or unicast
 WLED_GLOBAL bool e131SkipOutOfSequence _INIT(false);              // freeze instead of flickering
 WLED_GLOBAL uint16_t pollReplyCount _INIT(0);                     // count number of replies for ArtPoll node report
@@ -465,6 +519,7 @@ WLED_GLOBAL uint16_t serialBaud _INIT(1152); // serial baud rate, multiply by 10
 
 #ifndef WLED_DISABLE_ESPNOW
 WLED_GLOBAL bool enable_espnow_remote _INIT(false);
+WLED_GLOBAL bool espNowSync _INIT(false);              // send sync notifications and frame clock beacons via ESP-NOW broadcast instead of UDP
 WLED_GLOBAL char linked_remote[13]   _INIT("");
 WLED_GLOBAL char last_signal_src[13]   _INIT("");
 #endif
@@ -521,6 +576,12 @@ WLED_GLOBAL bool forceReconnect _INIT(false);
 WLED_GLOBAL unsigned long lastReconnectAttempt _INIT(0);
 WLED_GLOBAL bool interfacesInited _INIT(false);
 WLED_GLOBAL bool wasConnected _INIT(false);
+WLED_GLOBAL bool wifiFastConnect _INIT(false);          // current attempt goes to the cached access point (no scan)
+WLED_GLOBAL bool wifiFastFailed _INIT(false);           // skip the cached access point on the next attempt
+WLED_GLOBAL bool wifiLastFast _INIT(false);             // last connection was made by fast connect
+WLED_GLOBAL unsigned long wifiConnectStart _INIT(0);    // start of the current connection cycle (fast attempt and fallback)
+WLED_GLOBAL uint16_t wifiConnectTime _INIT(0);          // ms the last connection took
+WLED_GLOBAL uint16_t wifiReconnects _INIT(0);           // connections made after the first one
 
 // color
 WLED_GLOBAL byte lastRandomIndex _INIT(0);        // used to save last random color so the new one is not the same
@@ -531,8 +592,8 @@ WLED_GLOBAL bool          modeBlending            _INIT(true);    // enable effe
 WLED_GLOBAL bool          transitionActive        _INIT(false);
 WLED_GLOBAL uint16_t      transitionDelay         _INIT(750);     // global transition duration
 WLED_GLOBAL uint16_t      transitionDelayDefault  _INIT(750);     // default transition time (stored in cfg.json)
+WLED_GLOBAL uint16_t      stateCoalesceInterval   _INIT(50);      // ms, state changes closer than this emit notifications/interface updates/transitions only once (0 = off)
 WLED_GLOBAL unsigned long transitionStartTime;
-WLED_GLOBAL float         tperLast                _INIT(0.0f);    // crossfade transition progress, 0.0f - 1.0f
 WLED_GLOBAL bool          jsonTransitionOnce      _INIT(false);   // flag to override transitionDelay (playlist, JSON API: "live" & "seg":{"i"} & "tt")
 WLED_GLOBAL uint8_t       randomPaletteChangeTime _INIT(5);       // amount of time [s] between random palette changes (min: 1s, max: 255s)
 
@@ -551,6 +612,7 @@ WLED_GLOBAL bool offMode             _INIT(!turnOnAtBoot);
 WLED_GLOBAL byte bri                 _INIT(briS);          // global brightness (set)
 WLED_GLOBAL byte briOld              _INIT(0);             // global brightness while in transition loop (previous iteration)
 WLED_GLOBAL byte briT                _INIT(0);             // global brightness during transition
+WLED_GLOBAL uint32_t firstLightMs   _INIT(0);             // time to first light (millis() when LEDs were first lit after boot)
 WLED_GLOBAL byte briLast             _INIT(128);           // brightness before turned off. Used for toggle function
 WLED_GLOBAL byte whiteLast           _INIT(128);           // white channel before turned off. Used for toggle function
 
@@ -579,6 +641,7 @@ WLED_GLOBAL bool stateChanged _INIT(false);
 
 // network
 WLED_GLOBAL bool udpConnected _INIT(false), udp2Connected _INIT(false), udpRgbConnected _INIT(false);
+WLED_GLOBAL uint32_t udpPacketsIn _INIT(0), udpPacketsOut _INIT(0); // notifier/sync/raw RGB received, all WLED UDP sent (for /metrics)
 
 // ui style
 WLED_GLOBAL bool showWelcomePage _INIT(false);
@@ -754,7 +817,7 @@ WLED_GLOBAL int8_t spi_sclk  _INIT(SPISCLKPIN);
 #endif
 
 // global ArduinoJson buffer
-WLED_GLOBAL StaticJsonDocument<JSON_BUFFER_SIZE> doc;
+WLED_GLOBAL JSONBufferDocument doc _INIT_N(((0))); // no storage until requestJSONBufferLock()/requestJSONBuffer()
 WLED_GLOBAL volatile uint8_t jsonBufferLock _INIT(0);
 
 // enable additional debug output
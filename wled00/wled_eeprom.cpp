@@ -370,7 +370,7 @@ void deEEP() {
 
   DEBUG_PRINTLN(F("Preset file not found, attempting to load from EEPROM"));
   DEBUGFS_PRINTLN(F("Allocating saving buffer for dEEP"));
-  if (!requestJSONBufferLock(8)) return;
+  if (!requestJSONBufferLock(JSON_LOCK_EEPROM)) return;
 
   JsonObject sObj = doc.to<JsonObject>();
   sObj.createNestedObject("0");
@@ -7,6 +7,7 @@
  */
 
 #include <Arduino.h> //PI constant
+#include "const.h"    //WLED_HOT()
 
 //#define WLED_DEBUG_MATH
 
@@ -137,3 +138,79 @@ float fmod_t(float num, float denom) {
   #endif
   return res;
 }
+
+/*
+ * Fixed point math (no FPU on ESP8266 and ESP32-C3)
+ * angles are 16 bit: 65536 = 2*PI (same as FastLED sin16()), results are Q15 (32767 = 1.0)
+ */
+
+// first quadrant of sine, 256 steps (+ end point) in Q15
+static const int16_t WLED_HOT(sinQuarter) sinQuarter[257] PROGMEM = {
+      0,   201,   402,   603,   804,  1005,  1206,  1407,  1608,  1809,  2009,  2210,  2410,  2611,  2811,  3012,
+   3212,  3412,  3612,  3811,  4011,  4210,  4410,  4609,  4808,  5007,  5205,  5404,  5602,  5800,  5998,  6195,
+   6393,  6590,  6786,  6983,  7179,  7375,  7571,  7767,  7962,  8157,  8351,  8545,  8739,  8933,  9126,  9319,
+   9512,  9704,  9896, 10087, 10278, 10469, 10659, 10849, 11039, 11228, 11417, 11605, 11793, 11980, 12167, 12353,
+  12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828, 14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269,
+  15446, 15623, 15800, 15976, 16151, 16325, 16499, 16673, 16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+  18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357, 19519, 19680, 19841, 20000, 20159, 20317, 20475, 20631,
+  20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856, 22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027,
+  23170, 23311, 23452, 23592, 23731, 23870, 24007, 24143, 24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+  25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198, 26319, 26438, 26556, 26674, 26790, 26905, 27019, 27133,
+  27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001, 28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803,
+  28898, 28992, 29085, 29177, 29268, 29358, 29447, 29534, 29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+  30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783, 30852, 30919, 30985, 31050, 31113, 31176, 31237, 31297,
+  31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736, 31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098,
+  32137, 32176, 32213, 32250, 32285, 32318, 32351, 32382, 32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+  32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717, 32728, 32737, 32745, 32752, 32757, 32761, 32765, 32766,
+  32767
+};
+
+int16_t WLED_HOT(sin16_t) sin16_t(uint16_t theta) {
+  uint16_t q = theta >> 14;          // quadrant
+  uint16_t x = theta & 0x3FFF;       // position in quadrant (14 bit)
+  if (q & 1) x = 0x4000 - x;         // 2nd & 4th quadrant run backwards
+  uint16_t i = x >> 6;               // table index (8 bit)
+  int16_t  f = x & 0x3F;             // interpolation fraction (6 bit)
+  int32_t  a = (int16_t)pgm_read_word(&sinQuarter[i]);
+  int32_t  res = i < 256 ? a + ((((int16_t)pgm_read_word(&sinQuarter[i+1]) - a) * f) >> 6) : a;
+  return (q & 2) ? -res : res;
+}
+
+int16_t WLED_HOT(cos16_t) cos16_t(uint16_t theta) {
+  return sin16_t(theta + 16384);
+}
+
+// returns angle of vector (x,y) as 16 bit angle (0-65535), max error is about 0.25 degrees
+uint16_t atan2_16t(int32_t y, int32_t x) {
+  if (x == 0 && y == 0) return 0;
+  uint32_t ax = x < 0 ? -x : x;
+  uint32_t ay = y < 0 ? -y : y;
+  bool swap = ay > ax;               // reduce to 1st octant (ratio <= 1)
+  uint32_t num = swap ? ax : ay;
+  uint32_t den = swap ? ay : ax;
+  while (num > 0xFFFF) { num >>= 1; den >>= 1; } // keep num << 15 within 32 bit
+  int32_t z = (num << 15) / den;     // Q15 ratio 0-1
+  // atan(z) ~ z*PI/4 + 0.273*z*(1-z) (in radians), scaled to 16 bit angle: 8192*z + 2847*z*(1-z)
+  int32_t a = (z >> 2) + ((2847 * ((z * (32768 - z)) >> 15)) >> 15);
+  if (swap)  a = 16384 - a;          // 2nd octant
+  if (x < 0) a = 32768 - a;          // 2nd & 3rd quadrant
+  if (y < 0) a = 65536 - a;          // 3rd & 4th quadrant
+  return a;
+}
+
+// integer square root (floor) of 32 bit value
+uint16_t sqrt32_t(uint32_t x) {
+  uint32_t res = 0;
+  uint32_t bit = 1UL << 30;
+  while (bit > x) bit >>= 2;
+  while (bit) {
+    if (x >= res + bit) {
+      x  -= res + bit;
+      res = (res >> 1) + bit;
+    } else {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+  return res;
+}
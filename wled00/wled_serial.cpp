@@ -11,17 +11,35 @@ enum class AdaState {
   Header_CountHi,
   Header_CountLo,
   Header_CountCheck,
-  Data_Red,
-  Data_Green,
-  Data_Blue,
+  Data_Pixels,
   TPM2_Header_Type,
   TPM2_Header_CountHi,
   TPM2_Header_CountLo,
+  Stream_Fps,
+  Stream_Step,
 };
 
+// pixel data is read from the UART RX buffer in blocks of up to this size
+#ifdef ESP8266
+#define SERIAL_RX_CHUNK 96
+#else
+#define SERIAL_RX_CHUNK 192
+#endif
+
 uint16_t currentBaud = 1152; //default baudrate 115200 (divided by 100)
 bool continuousSendLED = false;
 uint32_t lastUpdate = 0;
+// binary continuous streaming ('B' <max fps> <step>), sent once per shown frame
+static bool streamBinary = false;
+static uint8_t streamMaxFps = 0;    // 0 = every frame
+static uint8_t streamStep = 1;      // send every n-th LED
+static uint32_t streamLastFrame = 0;
+static unsigned long streamLastSent = 0;
+static uint32_t serialRxBytes = 0;  // bytes received (Adalight/TPM2 frames and commands)
+static uint32_t serialRxErrors = 0; // bad header checksums, unsupported TPM2 packets and stray bytes outside of frames
+
+uint32_t getSerialRxBytes()  { return serialRxBytes; }
+uint32_t getSerialRxErrors() { return serialRxErrors; }
 
 void updateBaudRate(uint32_t rate){
   uint16_t rate100 = rate/100;
@@ -67,6 +85,33 @@ void sendBytes(){
   }
 }
 
+// LED data as binary frame: "WLS", version (1), frame counter (16 bit), number of LEDs sent (16 bit),
+// step (every n-th LED), brightness, RGB data (white added to RGB), XOR checksum of RGB data. 16 bit values are big endian.
+void sendBinaryFrame(uint32_t frame, uint8_t step) {
+  if (pinManager.isPinAllocated(hardwareTX) && pinManager.getPinOwner(hardwareTX) != PinOwner::DebugOut) return;
+  uint16_t used = strip.getLengthTotal();
+  uint16_t n = (used + step - 1) / step;
+  uint8_t buf[SERIAL_RX_CHUNK];
+  buf[0] = 'W'; buf[1] = 'L'; buf[2] = 'S'; buf[3] = 1;
+  buf[4] = (frame >> 8) & 0xFF; buf[5] = frame & 0xFF;
+  buf[6] = highByte(n); buf[7] = lowByte(n);
+  buf[8] = step;
+  buf[9] = strip.getBrightness();
+  Serial.write(buf, 10);
+  uint8_t check = 0;
+  size_t pos = 0;
+  for (uint16_t i = 0; i < used; i += step) {
+    uint32_t c = strip.getPixelColor(i);
+    buf[pos++] = qadd8(W(c), R(c));
+    buf[pos++] = qadd8(W(c), G(c));
+    buf[pos++] = qadd8(W(c), B(c));
+    check ^= buf[pos-3] ^ buf[pos-2] ^ buf[pos-1];
+    if (pos > sizeof(buf) - 3) { Serial.write(buf, pos); pos = 0; }
+  }
+  buf[pos++] = check;
+  Serial.write(buf, pos);
+}
+
 void handleSerial()
 {
   if (pinManager.isPinAllocated(hardwareRX)) return;
@@ -77,13 +122,43 @@ void handleSerial()
   static uint16_t count = 0;
   static uint16_t pixel = 0;
   static byte check = 0x00;
-  static byte red   = 0x00;
-  static byte green = 0x00;
+  static byte px[3];          // pixel split across two reads
+  static uint8_t pxLen = 0;
 
   while (Serial.available() > 0)
   {
     yield();
+    if (state == AdaState::Data_Pixels) {
+      // bulk read pixel data, never beyond the end of the frame so the next header is parsed byte by byte
+      uint8_t buf[SERIAL_RX_CHUNK];
+      size_t want = MIN((size_t)Serial.available(), (size_t)count*3 - pxLen);
+      size_t n = Serial.readBytes(buf, MIN(want, sizeof(buf)));
+      serialRxBytes += n;
+      continuousSendLED = false; // received data disables Continuous Serial Streaming
+      size_t i = 0;
+      while (i < n) {
+        if (pxLen || n - i < 3) {
+          px[pxLen++] = buf[i++];
+          if (pxLen < 3) continue;
+          pxLen = 0;
+          if (!realtimeOverride) setRealtimePixels(pixel, 1, px, 3);
+          pixel++; count--;
+          continue;
+        }
+        uint16_t k = MIN((n - i) / 3, (size_t)count);
+        if (!realtimeOverride) setRealtimePixels(pixel, k, buf + i, 3);
+        pixel += k; count -= k; i += k*3;
+      }
+      if (!count) {
+        if (!realtimeOverride) strip.show();
+        realtimeStatsShown();
+        state = AdaState::Header_A;
+      }
+      continue;
+    }
+
     byte next = Serial.peek();
+    serialRxBytes++;
     switch (state) {
       case AdaState::Header_A:
         if (next == 'A') state = AdaState::Header_d;
@@ -108,40 +183,44 @@ void handleSerial()
         } else if (next == 'l') {sendJSON(); // Send LED data as JSON Array
         } else if (next == 'L') {sendBytes(); // Send LED data as TPM2 Data Packet
 
-        } else if (next == 'o') {continuousSendLED = false; // Disable Continuous Serial Streaming
+        } else if (next == 'o') {continuousSendLED = false; streamBinary = false; // Disable Continuous Serial Streaming
         } else if (next == 'O') {continuousSendLED = true; // Enable Continuous Serial Streaming
+        } else if (next == 'B') {state = AdaState::Stream_Fps; // Enable binary Continuous Serial Streaming, followed by max fps and step
 
         } else if (next == '{') { //JSON API
           bool verboseResponse = false;
-          if (!requestJSONBufferLock(16)) return;
+          JsonDocument *pdoc = requestJSONBuffer(JSON_LOCK_SERIAL); // any free buffer of the pool
+          if (!pdoc) return;
           Serial.setTimeout(100);
-          DeserializationError error = deserializeJson(doc, Serial);
+          DeserializationError error = deserializeJson(*pdoc, Serial);
           if (error) {
-            releaseJSONBufferLock();
+            releaseJSONBuffer(pdoc);
             return;
           }
-          verboseResponse = deserializeState(doc.as<JsonObject>());
+          verboseResponse = deserializeState(pdoc->as<JsonObject>());
           //only send response if TX pin is unused for other purposes
           if (verboseResponse && (!pinManager.isPinAllocated(hardwareTX) || pinManager.getPinOwner(hardwareTX) == PinOwner::DebugOut)) {
-            doc.clear();
-            JsonObject state = doc.createNestedObject("state");
+            pdoc->clear();
+            JsonObject state = pdoc->createNestedObject("state");
             serializeState(state);
-            JsonObject info  = doc.createNestedObject("info");
+            JsonObject info  = pdoc->createNestedObject("info");
             serializeInfo(info);
 
-            serializeJson(doc, Serial);
+            serializeJson(*pdoc, Serial);
             Serial.println();
           }
-          releaseJSONBufferLock();
+          releaseJSONBuffer(pdoc);
+        } else {
+          serialRxErrors++; // stray byte
         }
         break;
       case AdaState::Header_d:
         if (next == 'd') state = AdaState::Header_a;
-        else             state = AdaState::Header_A;
+        else           { state = AdaState::Header_A; serialRxErrors++; }
         break;
       case AdaState::Header_a:
         if (next == 'a') state = AdaState::Header_CountHi;
-        else             state = AdaState::Header_A;
+        else           { state = AdaState::Header_A; serialRxErrors++; }
         break;
       case AdaState::Header_CountHi:
         pixel = 0;
@@ -155,13 +234,20 @@ void handleSerial()
         state = AdaState::Header_CountCheck;
         break;
       case AdaState::Header_CountCheck:
-        if (check == next) state = AdaState::Data_Red;
-        else               state = AdaState::Header_A;
+        if (check == next) {
+          state = AdaState::Data_Pixels;
+          pxLen = 0;
+          realtimeLock(realtimeTimeoutMs, REALTIME_MODE_ADALIGHT);
+        } else {
+          state = AdaState::Header_A;
+          serialRxErrors++;
+        }
         break;
       case AdaState::TPM2_Header_Type:
         state = AdaState::Header_A; //(unsupported) TPM2 command or invalid type
         if (next == 0xDA) state = AdaState::TPM2_Header_CountHi; //TPM2 data
         else if (next == 0xAA) Serial.write(0xAC); //TPM2 ping
+        else serialRxErrors++;
         break;
       case AdaState::TPM2_Header_CountHi:
         pixel = 0;
@@ -170,30 +256,25 @@ void handleSerial()
         break;
       case AdaState::TPM2_Header_CountLo:
         count += next /3;
-        state = AdaState::Data_Red;
+        state = count ? AdaState::Data_Pixels : AdaState::Header_A;
+        pxLen = 0;
+        if (count) realtimeLock(realtimeTimeoutMs, REALTIME_MODE_ADALIGHT);
         break;
-      case AdaState::Data_Red:
-        red   = next;
-        state = AdaState::Data_Green;
+      case AdaState::Stream_Fps:
+        streamMaxFps = next;
+        state = AdaState::Stream_Step;
         break;
-      case AdaState::Data_Green:
-        green = next;
-        state = AdaState::Data_Blue;
+      case AdaState::Stream_Step:
+        streamStep = next ? next : 1;
+        streamBinary = true;
+        streamLastFrame = strip.getFrameCount() - 1; // send current frame right away
+        state = AdaState::Header_A;
         break;
-      case AdaState::Data_Blue:
-        byte blue  = next;
-        if (!realtimeOverride) setRealtimePixel(pixel++, red, green, blue, 0);
-        if (--count > 0) state = AdaState::Data_Red;
-        else {
-          realtimeLock(realtimeTimeoutMs, REALTIME_MODE_ADALIGHT);
-
-          if (!realtimeOverride) strip.show();
-          state = AdaState::Header_A;
-        }
+      default:
         break;
     }
 
-    // All other received bytes will disable Continuous Serial Streaming
+    // All other received bytes will disable Continuous Serial Streaming (binary streaming is only stopped by 'o')
     if (continuousSendLED && next != 'O'){
       continuousSendLED = false;
       }
@@ -207,4 +288,12 @@ void handleSerial()
     sendBytes();
     lastUpdate = strip.getLastShow();
   }
+
+  // binary streaming: once per shown frame, at most streamMaxFps (skipped frames show as gaps in the frame counter)
+  uint32_t frame = strip.getFrameCount();
+  if (streamBinary && frame != streamLastFrame && (!streamMaxFps || millis() - streamLastSent >= 1000U / streamMaxFps)) {
+    sendBinaryFrame(frame, streamStep);
+    streamLastFrame = frame;
+    streamLastSent = millis();
+  }
 }
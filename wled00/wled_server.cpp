@@ -1,4 +1,5 @@
 #include "wled.h"
+#include <memory>
 
 #include "html_ui.h"
 #ifdef WLED_ENABLE_SIMPLE_UI
@@ -18,8 +19,6 @@
  * Integrated HTTP web server page declarations
  */
 
-bool handleIfNoneMatchCacheHeader(AsyncWebServerRequest* request);
-void setStaticContentCacheHeaders(AsyncWebServerResponse *response);
 
 // define flash strings once (saves flash memory)
 static const char s_redirecting[] PROGMEM = "Redirecting...";
@@ -52,7 +51,13 @@ void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t
     request->_tempFile = WLED_FS.open(finalname, "w");
     DEBUG_PRINT(F("Uploading "));
     DEBUG_PRINTLN(finalname);
-    if (finalname.equals("/presets.json")) presetsModifiedTime = toki.second();
+    if (finalname.equals("/presets.json")) {
+      presetsModifiedTime = toki.second();
+      invalidateFileIndex();
+      discardFileJournal();
+      invalidatePresetCache();
+    }
+    if (finalname.equals(F("/ir.json"))) invalidateIRTable();
   }
   if (len) {
     request->_tempFile.write(data,len);
@@ -63,7 +68,10 @@ void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t
       doReboot = true;
       request->send(200, "text/plain", F("Configuration restore successful.\nRebooting..."));
     } else {
-      if (filename.indexOf(F("palette")) >= 0 && filename.indexOf(F(".json")) >= 0) strip.loadCustomPalettes();
+      if (filename.indexOf(F("palette")) >= 0 && filename.indexOf(F(".json")) >= 0) strip.loadCustomPalettes(true);
+      #ifdef WLED_ENABLE_PRESETS_BIN
+      if (filename.indexOf(F("presets.json")) >= 0) requestPresetsImport();
+      #endif
       request->send(200, "text/plain", F("File Uploaded!"));
     }
     cacheInvalidate++;
@@ -108,8 +116,64 @@ bool captivePortal(AsyncWebServerRequest *request)
   return false;
 }
 
+/*
+ * Admission control: requests are classified by URL once their headers are in and counted until the connection
+ * is closed. A class at its limit is answered 503 (Retry-After) before any work is done, UI requests also yield
+ * to control requests and are refused under heap pressure. Realtime data is never refused, WebSocket upgrades
+ * are left to ws.cpp (broadcasts degrade to state-only before clients are dropped).
+ * Requests that are admitted queue for the JSON buffer with a class deadline (WLED_ADM_WAIT_UI).
+ */
+static adm_stats_t admStats[ADM_CLASSES] = {0}; // updated from the AsyncTCP task only
+
+static uint8_t requestClass(AsyncWebServerRequest *request)
+{
+  const String& url = request->url();
+  bool get = request->method() == HTTP_GET;
+  if (url.startsWith(F("/ws"))) return ADM_CLASSES;
+  if (url.startsWith(F("/json"))) {
+    if (!get) return url.indexOf(F("leds")) > 0 ? ADM_CLASS_RT : ADM_CLASS_CTRL;
+    if (url.length() <= 6 || url.indexOf(F("state")) > 0 || url.indexOf(F("si")) > 0 || url.indexOf(F("info")) > 0) return ADM_CLASS_CTRL;
+    return ADM_CLASS_UI;
+  }
+  if (!get || url.startsWith(F("/win")) || url.startsWith(F("/update")) || url.startsWith(F("/reset"))) return ADM_CLASS_CTRL;
+  return ADM_CLASS_UI;
+}
+
+static bool admit(uint8_t cls)
+{
+  adm_stats_t &st = admStats[cls];
+  bool ok = true;
+  if (cls == ADM_CLASS_CTRL) ok = st.inFlight < WLED_ADM_MAX_CTRL;
+  else if (cls == ADM_CLASS_UI) ok = st.inFlight < WLED_ADM_MAX_UI && admStats[ADM_CLASS_CTRL].inFlight < (WLED_ADM_MAX_CTRL+1)/2 && getHeapStats().warn == HEAP_WARN_OK;
+  if (!ok) { st.rejected++; return false; }
+  st.admitted++;
+  if (++st.inFlight > st.peak) st.peak = st.inFlight;
+  return true;
+}
+
+// first handler of the server, only claims requests it refuses
+class AdmissionHandler : public AsyncWebHandler {
+  public:
+    bool canHandle(AsyncWebServerRequest *request) override {
+      uint8_t cls = requestClass(request);
+      if (cls >= ADM_CLASSES) return false;
+      if (!admit(cls)) return true;
+      request->onDisconnect([cls](){ if (admStats[cls].inFlight) admStats[cls].inFlight--; });
+      return false;
+    }
+    void handleRequest(AsyncWebServerRequest *request) override {
+      AsyncWebServerResponse *response = request->beginResponse(503, "application/json", F("{\"error\":3}"));
+      response->addHeader(F("Retry-After"), "1");
+      request->send(response);
+    }
+};
+
+const adm_stats_t* getAdmissionStats(uint8_t cls) { return cls < ADM_CLASSES ? &admStats[cls] : nullptr; }
+
 void initServer()
 {
+  server.addHandler(new AdmissionHandler()); // must be first
+
   //CORS compatiblity
   DefaultHeaders::Instance().addHeader(F("Access-Control-Allow-Origin"), "*");
   DefaultHeaders::Instance().addHeader(F("Access-Control-Allow-Methods"), "*");
@@ -173,23 +237,54 @@ void initServer()
     serveJson(request);
   });
 
+  // raw per-LED data, registered before the JSON handler which would claim /json/... URLs
+  server.on(SET_F("/json/leds"), HTTP_POST, serveLedsUpload, nullptr, handleLedsUpload);
+
   AsyncCallbackJsonWebHandler* handler = new AsyncCallbackJsonWebHandler(F("/json"), [](AsyncWebServerRequest *request) {
     bool verboseResponse = false;
     bool isConfig = false;
 
-    if (!requestJSONBufferLock(14)) return;
+    const String& url = request->url();
+    isConfig = url.indexOf("cfg") > -1;
+    bool isMemPlan = url.indexOf("mem") > -1;
+    // small scalar state commands (sliders) do not need a JSON buffer
+    if (!isConfig && !isMemPlan && deserializeStateFast((const char*)request->_tempObject, request->contentLength(), verboseResponse)) {
+      if (verboseResponse) {
+        lastInterfaceUpdate = millis(); // prevent WS update until cooldown
+        interfaceUpdateCallMode = CALL_MODE_WS_SEND; // schedule WS update
+        serveJson(request); return;
+      }
+      request->send(200, "application/json", F("{\"success\":true}"));
+      return;
+    }
+
+    JsonDocument *pdoc = requestJSONBuffer(JSON_LOCK_HTTP_POST, 1000, request->contentLength()); // any free buffer of the pool
+    if (!pdoc) {
+      request->send(503, "application/json", F("{\"error\":3}"));
+      return;
+    }
 
-    DeserializationError error = deserializeJson(doc, (uint8_t*)(request->_tempObject));
-    JsonObject root = doc.as<JsonObject>();
+    DeserializationError error = deserializeJson(*pdoc, (uint8_t*)(request->_tempObject));
+    JsonObject root = pdoc->as<JsonObject>();
     if (error || root.isNull()) {
-      releaseJSONBufferLock();
+      releaseJSONBuffer(pdoc);
       request->send(400, "application/json", F("{\"error\":9}")); // ERR_JSON
       return;
     }
     if (root.containsKey("pin")) checkSettingsPIN(root["pin"].as<const char*>());
 
-    const String& url = request->url();
-    isConfig = url.indexOf("cfg") > -1;
+    if (isMemPlan) { // LED configuration is only evaluated, answer from the same buffer
+      bus_mem_t plan[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES];
+      uint8_t n = planBusMemory(root["ins"], root[F("ld")] | useGlobalLedBuffer, plan);
+      pdoc->clear();
+      serializeMemPlan(pdoc->to<JsonObject>(), plan, n);
+      String out;
+      serializeJson(*pdoc, out);
+      releaseJSONBuffer(pdoc);
+      request->send(200, "application/json", out);
+      return;
+    }
+
     if (!isConfig) {
       /*
       #ifdef WLED_DEBUG
@@ -202,12 +297,12 @@ void initServer()
     } else {
       if (!correctPIN && strlen(settingsPIN)>0) {
         request->send(401, "application/json", F("{\"error\":1}")); // ERR_DENIED
-        releaseJSONBufferLock();
+        releaseJSONBuffer(pdoc);
         return;
       }
       verboseResponse = deserializeConfig(root); //use verboseResponse to determine whether cfg change should be saved immediately
     }
-    releaseJSONBufferLock();
+    releaseJSONBuffer(pdoc);
 
     if (verboseResponse) {
       if (!isConfig) {
@@ -234,6 +329,10 @@ void initServer()
     request->send(200, "text/plain", (String)ESP.getFreeHeap());
   });
 
+#ifndef WLED_DISABLE_METRICS
+  server.on(SET_F("/metrics"), HTTP_GET, serveMetrics);
+#endif
+
 #ifdef WLED_ENABLE_USERMOD_PAGE
   server.on("/u", HTTP_GET, [](AsyncWebServerRequest *request){
     if (handleIfNoneMatchCacheHeader(request)) return;
@@ -253,6 +352,17 @@ void initServer()
                       size_t len, bool final) {handleUpload(request, filename, index, data, len, final);}
   );
 
+  server.on(SET_F("/backup"), HTTP_GET, serveBackup);
+  server.on(SET_F("/backup"), HTTP_POST, [](AsyncWebServerRequest *request) {},
+        [](AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) {
+          if (!correctPIN) {
+            if (final) request->send(401, "text/plain", FPSTR(s_unlock_cfg));
+            return;
+          }
+          handleBackupUpload(request, filename, index, data, len, final);
+        }
+  );
+
 #ifdef WLED_ENABLE_SIMPLE_UI
   server.on(SET_F("/simple.htm"), HTTP_GET, [](AsyncWebServerRequest *request){
     if (handleFileRead(request, "/simple.htm")) return;
@@ -298,7 +408,7 @@ void initServer()
       serveMessage(request, 401, F("Access Denied"), FPSTR(s_unlock_ota), 254);
       return;
     }
-    if (Update.hasError()) {
+    if (getOTAStats().state != OTA_DONE) {
       serveMessage(request, 500, F("Update failed!"), F("Please check your file and retry!"), 254);
     } else {
       serveMessage(request, 200, F("Update successful!"), F("Rebooting..."), 131);
@@ -311,17 +421,11 @@ void initServer()
       WLED::instance().disableWatchdog();
       usermods.onUpdateBegin(true); // notify usermods that update is about to begin (some may require task de-init)
       lastEditTime = millis(); // make sure PIN does not lock during update
-      #ifdef ESP8266
-      Update.runAsync(true);
-      #endif
-      Update.begin((ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000);
+      otaStreamBegin(request->contentLength()); // LEDs keep running, flash is written in paced chunks
     }
-    if(!Update.hasError()) Update.write(data, len);
+    otaStreamWrite(data, len);
     if(final){
-      if(Update.end(true)){
-        DEBUG_PRINTLN(F("Update Success"));
-      } else {
-        DEBUG_PRINTLN(F("Update Failed"));
+      if (!otaStreamEnd()) {
         usermods.onUpdateBegin(false); // notify usermods that update has failed (some may require task init)
         WLED::instance().enableWatchdog();
       }
@@ -415,19 +519,29 @@ void initServer()
   });
 }
 
-bool handleIfNoneMatchCacheHeader(AsyncWebServerRequest* request)
+// ETag of static content: firmware version, cache invalidation counter and (for generated content) a hash of its source
+static void generateEtag(char *etag, uint32_t contentTag)
+{
+  if (contentTag) sprintf_P(etag, PSTR("%8d-%02x-%08x"), VERSION, cacheInvalidate, contentTag);
+  else            sprintf_P(etag, PSTR("%8d-%02x"), VERSION, cacheInvalidate);
+}
+
+bool handleIfNoneMatchCacheHeader(AsyncWebServerRequest* request, uint32_t contentTag)
 {
   AsyncWebHeader* header = request->getHeader("If-None-Match");
-  if (header && header->value() == String(VERSION)) {
+  if (!header) return false;
+  char etag[24];
+  generateEtag(etag, contentTag);
+  if (header->value() == etag) {
     request->send(304);
     return true;
   }
   return false;
 }
 
-void setStaticContentCacheHeaders(AsyncWebServerResponse *response)
+void setStaticContentCacheHeaders(AsyncWebServerResponse *response, uint32_t contentTag)
 {
-  char tmp[12];
+  char tmp[24];
   // https://medium.com/@codebyamir/a-web-developers-guide-to-browser-caching-cc41f3b73e7c
   #ifndef WLED_DEBUG
   //this header name is misleading, "no-cache" will not disable cache,
@@ -436,7 +550,7 @@ void setStaticContentCacheHeaders(AsyncWebServerResponse *response)
   #else
   response->addHeader(F("Cache-Control"),"no-store,max-age=0"); // prevent caching if debug build
   #endif
-  sprintf_P(tmp, PSTR("%8d-%02x"), VERSION, cacheInvalidate);
+  generateEtag(tmp, contentTag);
   response->addHeader(F("ETag"), tmp);
 }
 
@@ -527,27 +641,55 @@ String dmxProcessor(const String& var)
 #endif
 
 
+// settings JS is generated at once into a chain of small pages (no size limit, no large buffer)
+// and sent as chunked response, each page is freed as soon as it is sent
+struct SettingsJSStream {
+  oappend_page_t *page = nullptr;
+  uint16_t pos = 0;
+  ~SettingsJSStream() { oappendPagesFree(page); }
+};
+
 void serveSettingsJS(AsyncWebServerRequest* request)
 {
-  char buf[SETTINGS_STACK_BUF_SIZE+37];
-  buf[0] = 0;
   byte subPage = request->arg(F("p")).toInt();
   if (subPage > 10) {
-    strcpy_P(buf, PSTR("alert('Settings for this request are not implemented.');"));
-    request->send(501, "application/javascript", buf);
+    request->send_P(501, "application/javascript", PSTR("alert('Settings for this request are not implemented.');"));
     return;
   }
   if (subPage > 0 && !correctPIN && strlen(settingsPIN)>0) {
-    strcpy_P(buf, PSTR("alert('PIN incorrect.');"));
-    request->send(401, "application/javascript", buf);
+    request->send_P(401, "application/javascript", PSTR("alert('PIN incorrect.');"));
     return;
   }
-  strcat_P(buf,PSTR("function GetV(){var d=document;"));
-  getSettingsJS(subPage, buf+strlen(buf));  // this may overflow by 35bytes!!!
-  strcat_P(buf,PSTR("}"));
-  
+  std::shared_ptr<SettingsJSStream> st = std::make_shared<SettingsJSStream>();
+  if (oappendPagesBegin()) {
+    oappend(SET_F("function GetV(){var d=document;"));
+    getSettingsJS(subPage);
+    oappend(SET_F("}"));
+  }
+  st->page = oappendPagesEnd();
+  if (!st->page) {
+    request->send(503);
+    return;
+  }
+
   AsyncWebServerResponse *response;
-  response = request->beginResponse(200, "application/javascript", buf);
+  response = request->beginChunkedResponse(F("application/javascript"), [st](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+    size_t written = 0;
+    while (st->page && written < maxLen) {
+      size_t n = min((size_t)(st->page->len - st->pos), maxLen - written);
+      memcpy(buffer + written, st->page->data + st->pos, n);
+      st->pos += n;
+      written += n;
+      if (st->pos >= st->page->len) {
+        oappend_page_t *next = st->page->next;
+        st->page->next = nullptr;
+        oappendPagesFree(st->page);
+        st->page = next;
+        st->pos = 0;
+      }
+    }
+    return written;
+  });
   response->addHeader(F("Cache-Control"),"no-store");
   response->addHeader(F("Expires"),"0");
   request->send(response);
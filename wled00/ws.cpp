@@ -5,11 +5,315 @@
  */
 #ifdef WLED_ENABLE_WEBSOCKETS
 
-uint16_t wsLiveClientId = 0;
 unsigned long wsLastLiveTime = 0;
+uint16_t wsRtStatsClientId = 0;
+unsigned long wsLastRtStatsTime = 0;
 //uint8_t* wsFrameBuffer = nullptr;
 
 #define WS_LIVE_INTERVAL 40
+#define WS_LIVE_MAX_INTERVAL 1000
+#define WS_RTSTATS_INTERVAL 1000
+
+// message buffers are released by AsyncWebSocket once sent to all clients, which gives no notice: their bytes are
+// counted as held until the send queues of all clients were empty once (checked by releaseWsBuffers())
+static size_t wsBufferBytes = 0;
+#ifdef ARDUINO_ARCH_ESP32
+static portMUX_TYPE wsBufferMux = portMUX_INITIALIZER_UNLOCKED; // buffers are also made from network callbacks
+#define WS_BUFFER_LOCK()   portENTER_CRITICAL(&wsBufferMux)
+#define WS_BUFFER_UNLOCK() portEXIT_CRITICAL(&wsBufferMux)
+#else
+#define WS_BUFFER_LOCK()
+#define WS_BUFFER_UNLOCK()
+#endif
+
+static AsyncWebSocketMessageBuffer* makeWsBuffer(size_t len)
+{
+  AsyncWebSocketMessageBuffer *buffer = ws.makeBuffer(len);
+  heapTrackAlloc(HEAP_TAG_WS, len, buffer);
+  if (buffer) {
+    WS_BUFFER_LOCK();
+    wsBufferBytes += len;
+    WS_BUFFER_UNLOCK();
+  }
+  return buffer;
+}
+
+static void releaseWsBuffers()
+{
+  const size_t len = wsBufferBytes; // buffers made meanwhile stay counted
+  if (!len) return;
+  for (auto c : ws.getClients()) if (c->queueLength() > 0) return; // messages still hold buffers
+  WS_BUFFER_LOCK();
+  wsBufferBytes -= len;
+  WS_BUFFER_UNLOCK();
+  heapTrackFree(HEAP_TAG_WS, len);
+}
+
+/*
+ * Live LED view ({"lv":true}), up to WS_MAX_LIVE_CLIENTS viewers
+ * Each frame is encoded once per format and the buffer shared by all viewers that are due.
+ * Viewers with a non-empty send queue skip frames and their interval grows, it shrinks again when they keep up.
+ * Formats (binary, first byte 'L'):
+ *  version 1: 1D raw RGB, version 2: 2D raw RGB with 8 bit w, h (downsampled to MAX_LIVE_LEDS_WS)
+ *  version 3: 16 bit w, h (big endian, h = 1 for 1D) followed by RLE compressed RGB ({"lv":true,"rle":true})
+ *             control byte c < 128: c+1 literal pixels follow, c >= 128: the next pixel repeats c-127 times
+ *             full resolution on boards with PSRAM if requested ({"lv":true,"rle":true,"full":true})
+ */
+#define WS_MAX_LIVE_CLIENTS 4
+#ifdef ESP8266
+#define MAX_LIVE_LEDS_WS 256U
+#else
+#define MAX_LIVE_LEDS_WS 1024U
+#endif
+
+#define LIVE_FMT_RAW      0
+#define LIVE_FMT_RLE      1
+#define LIVE_FMT_RLE_FULL 2
+#define LIVE_FMT_COUNT    3
+
+typedef struct {
+  uint32_t id;       // 0 = unused
+  uint8_t  format;
+  uint16_t interval; // ms, adapted to the client's send queue
+  unsigned long last;
+} ws_live_client_t;
+
+static ws_live_client_t wsLive[WS_MAX_LIVE_CLIENTS] = {0};
+
+/*
+ * State patch subscriptions ({"sub":1})
+ * Subscribed clients get a full state+info snapshot once and afterwards only {"patch":{...}} messages
+ * containing the changed top level state keys and the changed segment objects (with their "id").
+ * A new full snapshot is sent if segments were added/removed or their light capabilities changed.
+ * All subscribers share one baseline of value hashes; clients that may have missed a patch are resynced.
+ */
+#define WS_MAX_SUBSCRIBERS 8
+#define WS_PATCH_KEYS 24
+
+static uint32_t wsSubClientId[WS_MAX_SUBSCRIBERS] = {0};
+static bool     wsSubResync[WS_MAX_SUBSCRIBERS]; // needs full snapshot with next broadcast
+
+static struct {
+  uint32_t key[WS_PATCH_KEYS]; // hash of top level state key name
+  uint32_t val[WS_PATCH_KEYS]; // hash of its serialized value
+  uint32_t seg[MAX_NUM_SEGMENTS]; // hash of serialized segment object, 0 = not active
+  uint8_t  lc[MAX_NUM_SEGMENTS];
+  uint8_t  keys;
+  bool     valid;
+} wsBase;
+
+// out of memory for a WS message: broadcasts drop to state-only (no info) for WLED_WS_DEGRADE_HOLD ms first,
+// only if that does not help all clients are disconnected to release their queues
+static ws_load_stats_t wsLoad = {0, 0, false};
+static unsigned long   wsLoadSince = 0;
+
+// FNV-1a over serialized JSON without allocating a string
+class JsonHashPrint : public Print {
+  public:
+    uint32_t h = FNV1A_SEED;
+    size_t write(uint8_t c) override { h = fnv1a(&c, 1, h); return 1; }
+    size_t write(const uint8_t *buf, size_t len) override { h = fnv1a(buf, len, h); return len; }
+};
+
+static uint32_t hashJson(JsonVariantConst v)
+{
+  JsonHashPrint hp;
+  serializeJson(v, hp);
+  return hp.h | 1; // never 0
+}
+
+static uint32_t hashKey(const char *k)
+{
+  return fnv1a(k, strlen(k));
+}
+
+static int findSubscriber(uint32_t id)
+{
+  for (size_t i = 0; i < WS_MAX_SUBSCRIBERS; i++) if (id && wsSubClientId[i] == id) return i;
+  return -1;
+}
+
+static void setSubscription(uint32_t id, uint8_t level)
+{
+  int i = findSubscriber(id);
+  if (level == 0) {
+    if (i >= 0) wsSubClientId[i] = 0;
+    return;
+  }
+  for (size_t j = 0; i < 0 && j < WS_MAX_SUBSCRIBERS; j++) if (!wsSubClientId[j]) i = j;
+  if (i < 0) return; // table full, client stays on full broadcasts
+  wsSubClientId[i] = id;
+  wsSubResync[i] = false; // full snapshot is sent as reply to the subscription
+  wsBase.valid = false;   // baseline is not maintained without subscribers and may be older than the snapshot
+}
+
+/*
+ * MessagePack encoding of state/info messages ({"enc":1}, {"enc":0} back to JSON text)
+ * Clients that opted in get the same messages (full snapshots, patches) as binary frames encoded as MessagePack
+ * (a map, so the first byte is 0x80-0x8F or 0xDE/0xDF and never the 'L' of live view frames); smaller than
+ * JSON text and no number formatting on the device. Replies like {"success":true} stay JSON text.
+ * The bundled ArduinoJson comes without MessagePack serializer, MsgPackWriter below serializes documents using
+ * ArduinoJson's visitor interface (as serializeJson() does). Raw JSON created with serialized() (segment "col")
+ * is converted if it only consists of arrays and unsigned integers, otherwise sent as string.
+ */
+#define WS_MAX_BIN_CLIENTS 8
+
+static uint32_t wsBinClientId[WS_MAX_BIN_CLIENTS] = {0};
+
+template <typename TWriter>
+class MsgPackWriter : public ARDUINOJSON_NAMESPACE::Visitor<size_t> {
+  public:
+    static const bool producesText = false;
+    MsgPackWriter(TWriter writer) : _writer(writer), _bytes(0) {}
+
+    size_t visitArray(const ARDUINOJSON_NAMESPACE::CollectionData &array) {
+      writeHeader(array.size(), 0x90, 0xDC);
+      for (ARDUINOJSON_NAMESPACE::VariantSlot *slot = array.head(); slot; slot = slot->next()) slot->data()->accept(*this);
+      return _bytes;
+    }
+    size_t visitObject(const ARDUINOJSON_NAMESPACE::CollectionData &object) {
+      writeHeader(object.size(), 0x80, 0xDE);
+      for (ARDUINOJSON_NAMESPACE::VariantSlot *slot = object.head(); slot; slot = slot->next()) {
+        visitString(slot->key());
+        slot->data()->accept(*this);
+      }
+      return _bytes;
+    }
+    size_t visitFloat(ARDUINOJSON_NAMESPACE::Float value) {
+      float f = value;
+      if (f == value) { write(0xCA); writeBE(&f, 4); }
+      else { double d = value; write(0xCB); writeBE(&d, 8); }
+      return _bytes;
+    }
+    size_t visitString(const char *s) {
+      size_t n = strlen(s);
+      if (n < 32) write(0xA0 | n);
+      else if (n <= 0xFF) { write(0xD9); write(n); }
+      else if (n <= 0xFFFF) { write(0xDA); write16(n); }
+      else { write(0xDB); write32(n); }
+      write((const uint8_t*)s, n);
+      return _bytes;
+    }
+    size_t visitRawJson(const char *data, size_t n) {
+      const char *p = data, *end = data + n;
+      if (rawValid(p, end) && p == end) { p = data; rawWrite(p, end); }
+      else { // not convertible, as string
+        if (n < 32) write(0xA0 | n); else if (n <= 0xFF) { write(0xD9); write(n); } else { write(0xDA); write16(n); }
+        write((const uint8_t*)data, n);
+      }
+      return _bytes;
+    }
+    size_t visitSignedInteger(ARDUINOJSON_NAMESPACE::Integer value) {
+      if (value >= 0) return visitUnsignedInteger(value);
+      if (value >= -32) write(0xE0 | (value & 0x1F));
+      else if (value >= -128) { write(0xD0); write(uint8_t(value)); }
+      else if (value >= -32768) { write(0xD1); write16(value); }
+      else { write(0xD2); write32(value); } // Integer is 32 bit (no ARDUINOJSON_USE_LONG_LONG)
+      return _bytes;
+    }
+    size_t visitUnsignedInteger(ARDUINOJSON_NAMESPACE::UInt value) {
+      if (value < 128) write(value);
+      else if (value <= 0xFF) { write(0xCC); write(value); }
+      else if (value <= 0xFFFF) { write(0xCD); write16(value); }
+      else { write(0xCE); write32(value); }
+      return _bytes;
+    }
+    size_t visitBoolean(bool value) { write(value ? 0xC3 : 0xC2); return _bytes; }
+    size_t visitNull() { write(0xC0); return _bytes; }
+
+  private:
+    TWriter _writer;
+    size_t  _bytes;
+
+    void write(uint8_t c) { _bytes += _writer.write(c); }
+    void write(const uint8_t *s, size_t n) { _bytes += _writer.write(s, n); }
+    void write16(uint16_t v) { write(v >> 8); write(v & 0xFF); }
+    void write32(uint32_t v) { write16(v >> 16); write16(v & 0xFFFF); }
+    void writeBE(const void *v, size_t n) { for (size_t i = n; i > 0; i--) write(((const uint8_t*)v)[i-1]); } // little endian CPUs
+    void writeHeader(size_t n, uint8_t fix, uint8_t code) {
+      if (n < 16) write(fix | n);
+      else if (n <= 0xFFFF) { write(code); write16(n); }
+      else { write(code + 1); write32(n); }
+    }
+    // raw JSON value consisting of arrays and unsigned integers only, p is advanced past it
+    static bool rawValid(const char *&p, const char *end) {
+      if (p < end && *p == '[') {
+        if (++p < end && *p == ']') { p++; return true; }
+        while (p < end) {
+          if (!rawValid(p, end)) return false;
+          if (p < end && *p == ']') { p++; return true; }
+          if (p >= end || *p++ != ',') return false;
+        }
+        return false;
+      }
+      const char *s = p;
+      while (p < end && *p >= '0' && *p <= '9') p++;
+      return p > s && p - s < 10;
+    }
+    void rawWrite(const char *&p, const char *end) {
+      if (*p == '[') {
+        size_t n = 0;
+        unsigned depth = 0;
+        for (const char *q = p + 1; q < end; q++) { // count elements on this level
+          if (*q == '[') depth++;
+          else if (*q == ']') { if (!depth--) break; }
+          else if (*q == ',' && !depth) n++;
+        }
+        if (p[1] != ']') n++;
+        writeHeader(n, 0x90, 0xDC);
+        p++;
+        while (*p != ']') { rawWrite(p, end); if (*p == ',') p++; }
+        p++;
+        return;
+      }
+      uint32_t v = 0;
+      while (p < end && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+      visitUnsignedInteger(v);
+    }
+};
+
+static bool isBinClient(uint32_t id)
+{
+  for (size_t i = 0; i < WS_MAX_BIN_CLIENTS; i++) if (id && wsBinClientId[i] == id) return true;
+  return false;
+}
+
+static void setBinClient(uint32_t id, bool on)
+{
+  int free = -1;
+  for (size_t i = 0; i < WS_MAX_BIN_CLIENTS; i++) {
+    if (wsBinClientId[i] == id) { if (!on) wsBinClientId[i] = 0; return; }
+    if (!wsBinClientId[i] && free < 0) free = i;
+  }
+  if (on && free >= 0) wsBinClientId[free] = id; // table full: client stays on JSON text
+}
+
+static bool liveFullAllowed()
+{
+  #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM)
+  return psramFound(); // full resolution frames of large setups are only affordable with PSRAM
+  #else
+  return false;
+  #endif
+}
+
+static void setLiveClient(uint32_t id, bool on, uint8_t format = LIVE_FMT_RAW)
+{
+  ws_live_client_t *free = nullptr;
+  for (size_t i = 0; i < WS_MAX_LIVE_CLIENTS; i++) {
+    if (wsLive[i].id == id) { free = &wsLive[i]; break; }
+    if (!wsLive[i].id && !free) free = &wsLive[i];
+  }
+  if (!free) return; // all viewer slots in use
+  if (!on) {
+    if (free->id == id) free->id = 0;
+    return;
+  }
+  free->id = id;
+  free->format = format;
+  free->interval = WS_LIVE_INTERVAL;
+  free->last = 0;
+}
 
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len)
 {
@@ -19,13 +323,27 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
     sendDataWs(client);
   } else if(type == WS_EVT_DISCONNECT){
     //client disconnected
-    if (client->id() == wsLiveClientId) wsLiveClientId = 0;
+    setLiveClient(client->id(), false);
+    if (client->id() == wsRtStatsClientId) wsRtStatsClientId = 0;
+    setSubscription(client->id(), 0);
+    setBinClient(client->id(), false);
     DEBUG_PRINTLN(F("WS client disconnected."));
   } else if(type == WS_EVT_DATA){
     // data packet
     AwsFrameInfo * info = (AwsFrameInfo*)arg;
     if(info->final && info->index == 0 && info->len == len){
       // the whole message is in a single frame and we got all of its data (max. 1450 bytes)
+      if(info->opcode == WS_BINARY)
+      {
+        // realtime pixel data as DDP packet (10 byte header, 4 more with timecode flag): same path as DDP over UDP
+        if (!receiveDirect || len < 10 || len > sizeof(e131_packet_t)) return;
+        e131_packet_t *p = reinterpret_cast<e131_packet_t*>(data);
+        size_t hdr = (p->flags & DDP_TIMECODE_FLAG) ? 14 : 10;
+        if (len < hdr + htons(p->dataLen)) return; // truncated
+        realtimeIP = client->remoteIP();
+        handleDDPPacket(p);
+        return;
+      }
       if(info->opcode == WS_TEXT)
       {
         if (len > 0 && len < 10 && data[0] == 'p') {
@@ -36,23 +354,39 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
         }
 
         bool verboseResponse = false;
-        if (!requestJSONBufferLock(11)) return;
+        if (deserializeStateFast((const char*)data, len, verboseResponse)) { // small scalar state commands (sliders)
+          if (!interfaceUpdateCallMode) {
+            if (verboseResponse) sendDataWs(client);
+            else client->text(F("{\"success\":true}"));
+          }
+          return;
+        }
+        JsonDocument *pdoc = requestJSONBuffer(JSON_LOCK_WS_RECEIVE, 1000, len); // any free buffer of the pool
+        if (!pdoc) return;
 
-        DeserializationError error = deserializeJson(doc, data, len);
-        JsonObject root = doc.as<JsonObject>();
+        DeserializationError error = deserializeJson(*pdoc, data, len);
+        JsonObject root = pdoc->as<JsonObject>();
         if (error || root.isNull()) {
-          releaseJSONBufferLock();
+          releaseJSONBuffer(pdoc);
           return;
         }
         if (root["v"] && root.size() == 1) {
           //if the received value is just "{"v":true}", send only to this client
           verboseResponse = true;
         } else if (root.containsKey("lv")) {
-          wsLiveClientId = root["lv"] ? client->id() : 0;
+          uint8_t format = LIVE_FMT_RAW;
+          if (root["rle"]) format = root["full"] && liveFullAllowed() ? LIVE_FMT_RLE_FULL : LIVE_FMT_RLE;
+          setLiveClient(client->id(), root["lv"], format);
+        } else if (root.containsKey("rts")) {
+          wsRtStatsClientId = root["rts"] ? client->id() : 0; // realtime input statistics stream
+        } else if (root.containsKey("sub") || root.containsKey("enc")) {
+          if (root.containsKey("enc")) setBinClient(client->id(), root["enc"] | 0); // 0: JSON text, 1: MessagePack
+          if (root.containsKey("sub")) setSubscription(client->id(), root["sub"] | 0); // 0: full state+info broadcasts, 1: state patches
+          verboseResponse = true; // new baseline for the client
         } else {
           verboseResponse = deserializeState(root);
         }
-        releaseJSONBufferLock(); // will clean fileDoc
+        releaseJSONBuffer(pdoc); // will clean fileDoc if global doc was used
 
         if (!interfaceUpdateCallMode) { // individual client response only needed if no WS broadcast soon
           if (verboseResponse) {
@@ -96,19 +430,10 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
   }
 }
 
-void sendDataWs(AsyncWebSocketClient * client)
+// measures and serializes doc into a new WS buffer, handles out of memory (JSON buffer lock must be held)
+static AsyncWebSocketMessageBuffer * makeJsonBufferWs(bool msgPack = false)
 {
-  if (!ws.count()) return;
-  AsyncWebSocketMessageBuffer * buffer;
-
-  if (!requestJSONBufferLock(12)) return;
-
-  JsonObject state = doc.createNestedObject("state");
-  serializeState(state);
-  JsonObject info  = doc.createNestedObject("info");
-  serializeInfo(info);
-
-  size_t len = measureJson(doc);
+  size_t len = msgPack ? ARDUINOJSON_NAMESPACE::measure<MsgPackWriter>(doc) : measureJson(doc);
   DEBUG_PRINTF("JSON buffer size: %u for WS request (%u).\n", doc.memoryUsage(), len);
 
   size_t heap1 = ESP.getFreeHeap();
@@ -116,10 +441,10 @@ void sendDataWs(AsyncWebSocketClient * client)
   #ifdef ESP8266
   if (len>heap1) {
     DEBUG_PRINTLN(F("Out of memory (WS)!"));
-    return;
+    return nullptr;
   }
   #endif
-  buffer = ws.makeBuffer(len); // will not allocate correct memory sometimes on ESP8266
+  AsyncWebSocketMessageBuffer * buffer = makeWsBuffer(len); // will not allocate correct memory sometimes on ESP8266
   #ifdef ESP8266
   size_t heap2 = ESP.getFreeHeap();
   DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
@@ -127,49 +452,193 @@ void sendDataWs(AsyncWebSocketClient * client)
   size_t heap2 = 0; // ESP32 variants do not have the same issue and will work without checking heap allocation
   #endif
   if (!buffer || heap1-heap2<len) {
-    releaseJSONBufferLock();
     DEBUG_PRINTLN(F("WS buffer allocation failed."));
-    ws.closeAll(1013); //code 1013 = temporary overload, try again later
-    ws.cleanupClients(0); //disconnect all clients to release memory
+    wsLoadSince = millis();
+    if (!wsLoad.stateOnly) {
+      wsLoad.stateOnly = true;
+      wsLoad.degraded++;
+      for (size_t i = 0; i < WS_MAX_SUBSCRIBERS; i++) wsSubResync[i] = (wsSubClientId[i] != 0); // missed this message
+    } else {
+      wsLoad.closes++;
+      ws.closeAll(1013); //code 1013 = temporary overload, try again later
+      ws.cleanupClients(0); //disconnect all clients to release memory
+    }
     ws._cleanBuffers();
-    return; //out of memory
+    return nullptr; //out of memory
   }
+  if (msgPack) ARDUINOJSON_NAMESPACE::serialize<MsgPackWriter>(doc, buffer->get(), len);
+  else serializeJson(doc, (char *)buffer->get(), len);
+  return buffer;
+}
 
-  buffer->lock();
-  serializeJson(doc, (char *)buffer->get(), len);
-
-  DEBUG_PRINT(F("Sending WS data "));
-  if (client) {
-    client->text(buffer);
-    DEBUG_PRINTLN(F("to a single client."));
-  } else {
-    ws.textAll(buffer);
-    DEBUG_PRINTLN(F("to multiple clients."));
+// sends doc to a client in the encoding it asked for, each encoding is serialized once and shared (buffers are
+// locked, caller unlocks them); false if out of memory
+static bool sendDocWs(AsyncWebSocketClient *c, AsyncWebSocketMessageBuffer *buf[2])
+{
+  bool bin = isBinClient(c->id());
+  if (!buf[bin]) {
+    buf[bin] = makeJsonBufferWs(bin);
+    if (!buf[bin]) return false;
+    buf[bin]->lock();
   }
-  buffer->unlock();
+  if (bin) c->binary(buf[bin]);
+  else     c->text(buf[bin]);
+  return true;
+}
+
+static void releaseDocWs(AsyncWebSocketMessageBuffer *buf[2])
+{
+  for (size_t i = 0; i < 2; i++) if (buf[i]) buf[i]->unlock();
   ws._cleanBuffers();
+}
+
+// compares state against the subscriber baseline, fills patch with changed keys/segments and updates the baseline
+// returns false if a full snapshot is needed (first run, segments added/removed or capabilities changed)
+static bool buildStatePatch(JsonObject state, JsonObject patch)
+{
+  bool full = !wsBase.valid;
+  uint32_t key[WS_PATCH_KEYS], val[WS_PATCH_KEYS];
+  uint8_t keys = 0;
+  for (JsonPair kv : state) {
+    if (!strcmp(kv.key().c_str(), "seg")) continue;
+    uint32_t k = hashKey(kv.key().c_str());
+    uint32_t v = hashJson(kv.value());
+    bool changed = true;
+    for (size_t i = 0; i < wsBase.keys; i++) if (wsBase.key[i] == k) { changed = (wsBase.val[i] != v); break; }
+    if (changed) patch[kv.key()] = kv.value();
+    if (keys < WS_PATCH_KEYS) { key[keys] = k; val[keys] = v; keys++; } // keys beyond are always sent
+  }
+  memcpy(wsBase.key, key, keys * sizeof(uint32_t));
+  memcpy(wsBase.val, val, keys * sizeof(uint32_t));
+  wsBase.keys = keys;
+
+  uint32_t seg[MAX_NUM_SEGMENTS] = {0};
+  for (JsonObject s : state["seg"].as<JsonArray>()) {
+    unsigned id = s["id"];
+    if (id < MAX_NUM_SEGMENTS) seg[id] = hashJson(s);
+  }
+  JsonArray pseg;
+  for (size_t id = 0; id < MAX_NUM_SEGMENTS; id++) {
+    uint8_t lc = seg[id] && id < strip.getSegmentsNum() ? strip.getSegment(id).getLightCapabilities() : 0;
+    if (!seg[id] != !wsBase.seg[id] || lc != wsBase.lc[id]) full = true; // segment added/removed, info.leds.seglc outdated
+    else if (seg[id] != wsBase.seg[id]) {
+      if (pseg.isNull()) pseg = patch.createNestedArray("seg");
+      for (JsonObject s : state["seg"].as<JsonArray>()) if (s["id"] == id) { pseg.add(s); break; }
+    }
+    wsBase.seg[id] = seg[id];
+    wsBase.lc[id] = lc;
+  }
+  wsBase.valid = true;
+  return !full;
+}
+
+static void sendStateWs(AsyncWebSocketClient * client)
+{
+  if (!requestJSONBufferLock(JSON_LOCK_WS_SEND)) return;
+
+  JsonObject state = doc.createNestedObject("state");
+  serializeState(state);
+
+  // broadcast: find out who needs a full snapshot and who can do with a patch
+  bool needFull = (client != nullptr), needPatch = false;
+  if (!client) {
+    for (auto c : ws.getClients()) {
+      if (c->status() != WS_CONNECTED) continue;
+      int i = findSubscriber(c->id());
+      if (i < 0 || wsSubResync[i]) needFull = true;
+      else needPatch = true;
+    }
+  }
+  bool anySubscriber = false;
+  for (size_t i = 0; i < WS_MAX_SUBSCRIBERS; i++) anySubscriber |= (wsSubClientId[i] != 0);
+
+  JsonObject patch;
+  if (anySubscriber && !client) {
+    // baseline is only advanced by broadcasts; single client replies are full snapshots anyway
+    JsonObject p = doc.createNestedObject("patch");
+    if (!buildStatePatch(state, p)) {
+      for (size_t i = 0; i < WS_MAX_SUBSCRIBERS; i++) wsSubResync[i] = (wsSubClientId[i] != 0);
+      needFull |= needPatch;
+      needPatch = false;
+    } else patch = p;
+    doc.remove("patch"); // not part of a full snapshot, re-added below if needed
+  }
+
+  if (needFull) {
+    if (!wsLoad.stateOnly) {
+      JsonObject info  = doc.createNestedObject("info");
+      serializeInfo(info);
+    }
+    AsyncWebSocketMessageBuffer *buf[2] = {nullptr, nullptr}; // JSON text, MessagePack
+    DEBUG_PRINT(F("Sending WS data "));
+    if (client) {
+      if (!sendDocWs(client, buf)) {
+        releaseJSONBufferLock();
+        return;
+      }
+      DEBUG_PRINTLN(F("to a single client."));
+    } else {
+      for (auto c : ws.getClients()) {
+        if (c->status() != WS_CONNECTED) continue;
+        int i = findSubscriber(c->id());
+        if (i >= 0 && !wsSubResync[i]) continue; // gets a patch
+        if (!sendDocWs(c, buf)) {
+          releaseDocWs(buf);
+          releaseJSONBufferLock();
+          return;
+        }
+        if (i >= 0) wsSubResync[i] = false;
+      }
+      DEBUG_PRINTLN(F("to multiple clients."));
+    }
+    releaseDocWs(buf);
+  }
+
+  if (needPatch && !patch.isNull() && patch.size()) {
+    // detached objects stay valid until the document is cleared
+    doc.remove("state");
+    doc.remove("info");
+    doc.createNestedObject("patch").set(patch);
+    AsyncWebSocketMessageBuffer *buf[2] = {nullptr, nullptr};
+    for (auto c : ws.getClients()) {
+      if (c->status() != WS_CONNECTED) continue;
+      int i = findSubscriber(c->id());
+      if (i < 0 || wsSubResync[i]) continue;
+      if (c->queueIsFull()) wsSubResync[i] = true; // patch would be dropped, baseline lost
+      else if (!sendDocWs(c, buf)) break;
+    }
+    DEBUG_PRINTLN(F("Sent WS state patch."));
+    releaseDocWs(buf);
+  }
 
   releaseJSONBufferLock();
 }
 
-bool sendLiveLedsWs(uint32_t wsClient)
+void sendDataWs(AsyncWebSocketClient * client)
 {
-  AsyncWebSocketClient * wsc = ws.client(wsClient);
-  if (!wsc || wsc->queueLength() > 0) return false; //only send if queue free
+  if (!ws.count()) return;
+  uint32_t start = micros();
+  sendStateWs(client);
+  traceEvent(TRACE_WS, client ? 1 : ws.count(), 0, start, micros() - start);
+}
+
+static inline void liveRGB(uint32_t c, uint8_t *rgb)
+{
+  uint8_t w = W(c);
+  rgb[0] = scale8(qadd8(w, R(c)), strip.getBrightness()); //R, add white channel to RGB channels as a simple RGBW -> RGB map
+  rgb[1] = scale8(qadd8(w, G(c)), strip.getBrightness()); //G
+  rgb[2] = scale8(qadd8(w, B(c)), strip.getBrightness()); //B
+}
 
+// legacy version 1/2 frame, returns its size; buffer may be nullptr to only get the size
+static size_t encodeLiveRaw(uint8_t *buffer)
+{
   size_t used = strip.getLengthTotal();
-#ifdef ESP8266
-  const size_t MAX_LIVE_LEDS_WS = 256U;
-#else
-  const size_t MAX_LIVE_LEDS_WS = 1024U;
-#endif
   size_t n = ((used -1)/MAX_LIVE_LEDS_WS) +1; //only serve every n'th LED if count over MAX_LIVE_LEDS_WS
   size_t pos = (strip.isMatrix ? 4 : 2);  // start of data
   size_t bufSize = pos + (used/n)*3;
+  if (!buffer) return bufSize;
 
-  AsyncWebSocketMessageBuffer * wsBuf = ws.makeBuffer(bufSize);
-  if (!wsBuf) return false; //out of memory
-  uint8_t* buffer = wsBuf->get();
   buffer[0] = 'L';
   buffer[1] = 1; //version
 
@@ -198,22 +667,132 @@ bool sendLiveLedsWs(uint32_t wsClient)
       if ((i/Segment::maxWidth)%(skipLines+1)) i += Segment::maxWidth * skipLines;
     }
 #endif
-    uint32_t c = strip.getPixelColor(i);
-    uint8_t r = R(c);
-    uint8_t g = G(c);
-    uint8_t b = B(c);
-    uint8_t w = W(c);
-    buffer[pos++] = scale8(qadd8(w, r), strip.getBrightness()); //R, add white channel to RGB channels as a simple RGBW -> RGB map
-    buffer[pos++] = scale8(qadd8(w, g), strip.getBrightness()); //G
-    buffer[pos++] = scale8(qadd8(w, b), strip.getBrightness()); //B
+    liveRGB(strip.getPixelColor(i), buffer + pos);
+    pos += 3;
+  }
+  return bufSize;
+}
+
+// version 3 frame (see above), returns its size; buffer may be nullptr to only get the size
+static size_t encodeLiveRLE(uint8_t *buffer, bool full)
+{
+  size_t width = strip.getLengthTotal(), height = 1, step = 1;
+#ifndef WLED_DISABLE_2D
+  if (strip.isMatrix) {
+    width = Segment::maxWidth;
+    height = Segment::maxHeight;
+  }
+#endif
+  if (!full) while (((width+step-1)/step) * ((height+step-1)/step) > MAX_LIVE_LEDS_WS) step++; // keep aspect ratio
+  size_t w = (width+step-1)/step, h = (height+step-1)/step;
+  if (w > 0xFFFF || h > 0xFFFF) return 0;
+
+  if (buffer) {
+    buffer[0] = 'L';
+    buffer[1] = 3; //version
+    buffer[2] = w >> 8; buffer[3] = w & 0xFF;
+    buffer[4] = h >> 8; buffer[5] = h & 0xFF;
   }
+  size_t pos = 6;
+  size_t litPos = 0, litLen = 0; // open literal block
+  uint8_t cur[3], px[3];
+  size_t run = 0;
 
-  wsc->binary(wsBuf);
+  // emits the pending run: as run record if 2 or more pixels, otherwise appended to a literal block
+  auto flush = [&]() {
+    if (run >= 2) {
+      if (buffer) { buffer[pos] = 0x80 | (run-1); memcpy(buffer+pos+1, cur, 3); }
+      pos += 4;
+      litLen = 0;
+    } else if (run == 1) {
+      if (!litLen || litLen == 128) { litPos = pos++; litLen = 0; }
+      if (buffer) { memcpy(buffer+pos, cur, 3); buffer[litPos] = litLen; }
+      pos += 3;
+      litLen++;
+    }
+    run = 0;
+  };
+
+  for (size_t y = 0; y < height; y += step) {
+    for (size_t x = 0; x < width; x += step) {
+      liveRGB(strip.getPixelColor(y*width + x), px);
+      if (run && run < 128 && !memcmp(px, cur, 3)) { run++; continue; }
+      flush();
+      memcpy(cur, px, 3);
+      run = 1;
+    }
+  }
+  flush();
+  return pos;
+}
+
+static size_t encodeLiveFrame(uint8_t *buffer, uint8_t format)
+{
+  return format == LIVE_FMT_RAW ? encodeLiveRaw(buffer) : encodeLiveRLE(buffer, format == LIVE_FMT_RLE_FULL);
+}
+
+// sends one frame per format to all viewers that are due
+static void sendLiveLedsWs()
+{
+  bool due[WS_MAX_LIVE_CLIENTS] = {false};
+  bool anyDue[LIVE_FMT_COUNT] = {false};
+  unsigned long now = millis();
+  for (size_t i = 0; i < WS_MAX_LIVE_CLIENTS; i++) {
+    ws_live_client_t &lc = wsLive[i];
+    if (!lc.id || now - lc.last < lc.interval) continue;
+    AsyncWebSocketClient * wsc = ws.client(lc.id);
+    if (!wsc) { lc.id = 0; continue; }
+    lc.last = now;
+    if (wsc->queueLength() > 0) { // client does not keep up, back off
+      lc.interval = min(lc.interval + (lc.interval >> 1), WS_LIVE_MAX_INTERVAL);
+      continue;
+    }
+    if (lc.interval > WS_LIVE_INTERVAL) lc.interval = max(lc.interval - (lc.interval >> 3), WS_LIVE_INTERVAL);
+    due[i] = true;
+    anyDue[lc.format] = true;
+  }
+
+  for (uint8_t f = 0; f < LIVE_FMT_COUNT; f++) {
+    if (!anyDue[f]) continue;
+    size_t len = encodeLiveFrame(nullptr, f);
+    if (!len) continue;
+    AsyncWebSocketMessageBuffer * wsBuf = makeWsBuffer(len);
+    if (!wsBuf) continue; //out of memory
+    encodeLiveFrame(wsBuf->get(), f);
+    wsBuf->lock();
+    for (size_t i = 0; i < WS_MAX_LIVE_CLIENTS; i++) {
+      if (!due[i] || wsLive[i].format != f) continue;
+      AsyncWebSocketClient * wsc = ws.client(wsLive[i].id);
+      if (wsc) wsc->binary(wsBuf);
+    }
+    wsBuf->unlock();
+    ws._cleanBuffers();
+  }
+}
+
+// sends {"rt":{...}} realtime input statistics to a single client
+bool sendRealtimeStatsWs(uint32_t wsClient)
+{
+  AsyncWebSocketClient * wsc = ws.client(wsClient);
+  if (!wsc || wsc->queueLength() > 0) return false; //only send if queue free
+  if (!requestJSONBufferLock(JSON_LOCK_WS_RTSTATS)) return false;
+
+  serializeRealtimeStats(doc.createNestedObject("rt"));
+  size_t len = measureJson(doc);
+  AsyncWebSocketMessageBuffer * buffer = makeWsBuffer(len);
+  if (!buffer) {
+    releaseJSONBufferLock();
+    return false; //out of memory
+  }
+  serializeJson(doc, (char *)buffer->get(), len);
+  releaseJSONBufferLock();
+  wsc->text(buffer);
   return true;
 }
 
 void handleWs()
 {
+  if (wsLoad.stateOnly && millis() - wsLoadSince > WLED_WS_DEGRADE_HOLD && getHeapStats().warn == HEAP_WARN_OK) wsLoad.stateOnly = false;
   if (millis() - wsLastLiveTime > WS_LIVE_INTERVAL)
   {
     #ifdef ESP8266
@@ -221,14 +800,37 @@ void handleWs()
     #else
     ws.cleanupClients();
     #endif
-    bool success = true;
-    if (wsLiveClientId) success = sendLiveLedsWs(wsLiveClientId);
     wsLastLiveTime = millis();
-    if (!success) wsLastLiveTime -= 20; //try again in 20ms if failed due to non-empty WS queue
+    releaseWsBuffers();
   }
+  sendLiveLedsWs(); // every viewer has its own interval
+  if (wsRtStatsClientId && millis() - wsLastRtStatsTime > WS_RTSTATS_INTERVAL)
+  {
+    wsLastRtStatsTime = millis();
+    if (!sendRealtimeStatsWs(wsRtStatsClientId)) wsLastRtStatsTime -= WS_RTSTATS_INTERVAL - 100;
+  }
+}
+
+uint8_t getWsLiveViewers()
+{
+  uint8_t n = 0;
+  for (size_t i = 0; i < WS_MAX_LIVE_CLIENTS; i++) if (wsLive[i].id) n++;
+  return n;
+}
+
+uint8_t getWsSubscribers()
+{
+  uint8_t n = 0;
+  for (size_t i = 0; i < WS_MAX_SUBSCRIBERS; i++) if (wsSubClientId[i]) n++;
+  return n;
 }
 
+const ws_load_stats_t* getWsLoadStats() { return &wsLoad; }
+
 #else
 void handleWs() {}
 void sendDataWs(AsyncWebSocketClient * client) {}
+uint8_t getWsLiveViewers() { return 0; }
+uint8_t getWsSubscribers() { return 0; }
+const ws_load_stats_t* getWsLoadStats() { static const ws_load_stats_t none = {0, 0, false}; return &none; }
 #endif
\ No newline at end of file
@@ -131,7 +131,7 @@ void appendGPIOinfo() {
     oappend(","); oappend(itoa(spi_sclk,nS,10));
   }
   // usermod pin reservations will become unnecessary when settings pages will read cfg.json directly
-  if (requestJSONBufferLock(6)) {
+  if (requestJSONBufferLock(JSON_LOCK_XML)) {
     // if we can't allocate JSON buffer ignore usermod pins
     JsonObject mods = doc.createNestedObject(F("um"));
     usermods.addToConfig(mods);
@@ -226,13 +226,12 @@ void appendGPIOinfo() {
 }
 
 //get values for settings form in javascript
-void getSettingsJS(byte subPage, char* dest)
+//(output goes wherever oappend() currently writes to, see serveSettingsJS())
+void getSettingsJS(byte subPage)
 {
   //0: menu 1: wifi 2: leds 3: ui 4: sync 5: time 6: sec
   DEBUG_PRINT(F("settings resp"));
   DEBUG_PRINTLN(subPage);
-  obuf = dest;
-  olen = 0;
 
   if (subPage <0 || subPage >10) return;
 
@@ -279,6 +278,7 @@ void getSettingsJS(byte subPage, char* dest)
     sappend('v',SET_F("AC"),apChannel);
     sappend('c',SET_F("FG"),force802_3g);
     sappend('c',SET_F("WS"),noWifiSleep);
+    sappend('c',SET_F("RTP"),realtimeProfile);
 
     #ifndef WLED_DISABLE_ESPNOW
     sappend('c',SET_F("RE"),enable_espnow_remote);
@@ -355,6 +355,7 @@ void getSettingsJS(byte subPage, char* dest)
     sappend('c',SET_F("CR"),cctFromRgb);
     sappend('v',SET_F("CB"),strip.cctBlending);
     sappend('v',SET_F("FR"),strip.getTargetFps());
+    sappend('c',SET_F("DI"),Bus::getDithering());
     sappend('v',SET_F("AW"),Bus::getGlobalAWMode());
     sappend('c',SET_F("LD"),useGlobalLedBuffer);
 
@@ -372,6 +373,7 @@ void getSettingsJS(byte subPage, char* dest)
       char aw[4] = "AW"; aw[2] = 48+s; aw[3] = 0; //auto white mode
       char wo[4] = "WO"; wo[2] = 48+s; wo[3] = 0; //swap channels
       char sp[4] = "SP"; sp[2] = 48+s; sp[3] = 0; //bus clock speed
+      char ma[4] = "MA"; ma[2] = 48+s; ma[3] = 0; //current limit of bus' own power supply
       oappend(SET_F("addLEDs(1);"));
       uint8_t pins[5];
       uint8_t nPins = bus->getPins(pins);
@@ -388,6 +390,7 @@ void getSettingsJS(byte subPage, char* dest)
       sappend('c',rf,bus->isOffRefreshRequired());
       sappend('v',aw,bus->getAutoWhiteMode());
       sappend('v',wo,bus->getColorOrder() >> 4);
+      sappend('v',ma,bus->getMaxCurrent());
       uint16_t speed = bus->getFrequency();
       if (bus->getType() > TYPE_ONOFF && bus->getType() < 48) {
         switch (speed) {
@@ -446,6 +449,7 @@ void getSettingsJS(byte subPage, char* dest)
     sappend('v',SET_F("TD"),transitionDelayDefault);
     sappend('c',SET_F("PF"),strip.paletteFade);
     sappend('v',SET_F("TP"),randomPaletteChangeTime);
+    sappend('v',SET_F("TC"),stateCoalesceInterval);
     sappend('v',SET_F("BF"),briMultiplier);
     sappend('v',SET_F("TB"),nightlightTargetBri);
     sappend('v',SET_F("TL"),nightlightDelayMinsDefault);
@@ -496,12 +500,20 @@ void getSettingsJS(byte subPage, char* dest)
     sappend('c',SET_F("SH"),notifyHue);
     sappend('c',SET_F("SM"),notifyMacro);
     sappend('v',SET_F("UR"),udpNumRetries);
+    sappend('c',SET_F("ND"),udpDeltaNotify);
+    sappend('i',SET_F("CK"),clockSyncMode);
+    #ifndef WLED_DISABLE_ESPNOW
+    sappend('c',SET_F("EN"),espNowSync);
+    #else
+    oappend(SET_F("gId('espn').style.display='none';"));
+    #endif
 
     sappend('c',SET_F("NL"),nodeListEnabled);
     sappend('c',SET_F("NB"),nodeBroadcastEnabled);
 
     sappend('c',SET_F("RD"),receiveDirect);
     sappend('c',SET_F("MO"),useMainSegmentOnly);
+    sappend('c',SET_F("LF"),realtimeFade);
     sappend('v',SET_F("EP"),e131Port);
     sappend('c',SET_F("ES"),e131SkipOutOfSequence);
     sappend('c',SET_F("EM"),e131Multicast);
@@ -509,7 +521,23 @@ void getSettingsJS(byte subPage, char* dest)
     sappend('v',SET_F("DA"),DMXAddress);
     sappend('v',SET_F("XX"),DMXSegmentSpacing);
     sappend('v',SET_F("PY"),e131Priority);
+    sappend('v',SET_F("FT"),e131FrameTimeout);
+    sappend('v',SET_F("DY"),ddpPresentationDelay);
     sappend('v',SET_F("DM"),DMXMode);
+    #ifdef WLED_ENABLE_DMX_INPUT
+    sappend('v',SET_F("IDR"),dmxInputRxPin);
+    sappend('v',SET_F("IDE"),dmxInputEnPin);
+    #else
+    oappend(SET_F("gId('dmxin').style.display='none';"));
+    #endif
+    sappend('v',SET_F("OU"),netOutUniverse);
+    sappend('v',SET_F("OP"),e131OutPriority);
+    sappend('v',SET_F("OG"),netOutPacing);
+    sappend('v',SET_F("OC"),netOutChannels);
+    sappend('v',SET_F("AN"),artnetOutNet);
+    sappend('v',SET_F("AS"),artnetOutSubnet);
+    sappend('v',SET_F("AU"),artnetOutUniverse);
+    sappend('c',SET_F("AY"),artnetOutSync);
     sappend('v',SET_F("ET"),realtimeTimeoutMs);
     sappend('c',SET_F("FB"),arlsForceMaxBri);
     sappend('c',SET_F("RG"),arlsDisableGammaCorrection);
@@ -754,6 +782,12 @@ void getSettingsJS(byte subPage, char* dest)
         pO[l] = 'Y'; sappend('v',pO,strip.panel[i].yOffset);
         pO[l] = 'W'; sappend('v',pO,strip.panel[i].width);
         pO[l] = 'H'; sappend('v',pO,strip.panel[i].height);
+        pO[l] = 'C'; sappend('v',pO,strip.panel[i].canvas);
+        if (strip.panel[i].ip[0]) {
+          char ip[16];
+          sprintf_P(ip, PSTR("%u.%u.%u.%u"), strip.panel[i].ip[0], strip.panel[i].ip[1], strip.panel[i].ip[2], strip.panel[i].ip[3]);
+          pO[l] = 'I'; sappends('s',pO,ip);
+        }
       }
     }
     #else